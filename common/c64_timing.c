@@ -0,0 +1,377 @@
+/*
+ * C64 Interrupt Timing
+ * Minimal CIA1/CIA2 timer and VIC-II raster model for SID playback
+ *
+ * Timers are not decremented per cycle: a running timer only stores the
+ * cycle of its next underflow, and its visible value is derived from that
+ * when the CPU reads it.
+ */
+
+#include "c64_timing.h"
+#include <string.h>
+
+/* KERNAL jiffy timer values (60 Hz IRQ) */
+#define CIA_JIFFY_PAL  0x4025
+#define CIA_JIFFY_NTSC 0x4295
+
+/* Control register bits */
+#define CR_START     0x01
+#define CR_ONESHOT   0x08
+#define CR_LOAD      0x10
+
+// ============================================================================
+// CIA
+// ============================================================================
+
+/* Timer counts system clock cycles (not CNT or timer A underflows) */
+static inline bool cia_counts_cycles(const C64Cia* cia, int n) {
+    if (n == 0) return (cia->cr[0] & 0x20) == 0;
+    return (cia->cr[1] & 0x60) == 0;
+}
+
+/* Timer B counts timer A underflows */
+static inline bool cia_b_counts_a(const C64Cia* cia) {
+    return (cia->cr[1] & 0x40) != 0;
+}
+
+static uint16_t cia_timer_value(const C64Cia* cia, int n, uint64_t now) {
+    if (cia->underflow[n] == C64_TIMING_NEVER) return cia->counter[n];
+    if (cia->underflow[n] <= now) return 0;
+
+    uint64_t remaining = cia->underflow[n] - now - 1;
+    return (uint16_t)(remaining > 0xFFFF ? 0xFFFF : remaining);
+}
+
+static void cia_schedule(C64Cia* cia, int n, uint64_t now) {
+    if ((cia->cr[n] & CR_START) && cia_counts_cycles(cia, n)) {
+        cia->underflow[n] = now + cia->counter[n] + 1;
+    } else {
+        cia->underflow[n] = C64_TIMING_NEVER;
+    }
+}
+
+/* Freeze the running count into counter[] */
+static void cia_sync(C64Cia* cia, int n, uint64_t now) {
+    cia->counter[n] = cia_timer_value(cia, n, now);
+    cia->underflow[n] = C64_TIMING_NEVER;
+}
+
+static inline bool cia_irq(const C64Cia* cia) {
+    return (cia->icr_flags & cia->icr_mask & 0x1F) != 0;
+}
+
+/* Timer B in underflow-counting mode takes `count` timer A underflows */
+static bool cia_b_count(C64Cia* cia, uint64_t count) {
+    if (!(cia->cr[1] & CR_START)) return false;
+
+    if (cia->counter[1] >= count) {
+        cia->counter[1] -= (uint16_t)count;
+        return false;
+    }
+
+    count -= (uint64_t)cia->counter[1] + 1;
+    if (cia->cr[1] & CR_ONESHOT) {
+        cia->cr[1] &= (uint8_t)~CR_START;
+        cia->counter[1] = cia->latch[1];
+    } else {
+        cia->counter[1] = (uint16_t)(cia->latch[1] - count % ((uint64_t)cia->latch[1] + 1));
+    }
+    return true;
+}
+
+/* Fire due underflows; returns a 2-bit mask (timer A, timer B) */
+static uint32_t cia_advance(C64Cia* cia, uint64_t now) {
+    uint32_t fired = 0;
+
+    for (int n = 0; n < 2; n++) {
+        if (cia->underflow[n] > now) continue;
+
+        uint64_t count = 1;
+        if (cia->cr[n] & CR_ONESHOT) {
+            cia->cr[n] &= (uint8_t)~CR_START;
+            cia->counter[n] = cia->latch[n];
+            cia->underflow[n] = C64_TIMING_NEVER;
+        } else {
+            uint64_t period = (uint64_t)cia->latch[n] + 1;
+            count = (now - cia->underflow[n]) / period + 1;
+            cia->underflow[n] += count * period;
+        }
+
+        cia->icr_flags |= (uint8_t)(1 << n);
+        fired |= 1u << n;
+
+        if (n == 0 && cia_b_counts_a(cia) && cia_b_count(cia, count)) {
+            cia->icr_flags |= 0x02;
+            fired |= 0x02;
+        }
+    }
+
+    return fired;
+}
+
+static uint8_t cia_read(C64Cia* cia, int index, uint8_t reg, uint64_t now) {
+    switch (reg) {
+        case 0x00:
+        case 0x01:
+            /* No keys pressed, no joystick */
+            return index == 0 ? 0xFF : cia->regs[reg];
+        case 0x04: return (uint8_t)(cia_timer_value(cia, 0, now) & 0xFF);
+        case 0x05: return (uint8_t)(cia_timer_value(cia, 0, now) >> 8);
+        case 0x06: return (uint8_t)(cia_timer_value(cia, 1, now) & 0xFF);
+        case 0x07: return (uint8_t)(cia_timer_value(cia, 1, now) >> 8);
+        case 0x0D: {
+            /* Reading acknowledges all pending sources */
+            uint8_t value = cia->icr_flags | (cia_irq(cia) ? 0x80 : 0x00);
+            cia->icr_flags = 0;
+            return value;
+        }
+        case 0x0E: return cia->cr[0];
+        case 0x0F: return cia->cr[1];
+        default:   return cia->regs[reg];
+    }
+}
+
+static void cia_write(C64Cia* cia, uint8_t reg, uint8_t value, uint64_t now) {
+    cia->regs[reg] = value;
+
+    switch (reg) {
+        case 0x04:
+        case 0x06: {
+            int n = (reg - 0x04) >> 1;
+            cia->latch[n] = (uint16_t)((cia->latch[n] & 0xFF00) | value);
+            break;
+        }
+        case 0x05:
+        case 0x07: {
+            /* The high byte loads a stopped timer */
+            int n = (reg - 0x05) >> 1;
+            cia->latch[n] = (uint16_t)((cia->latch[n] & 0x00FF) | (value << 8));
+            if (!(cia->cr[n] & CR_START)) {
+                cia->counter[n] = cia->latch[n];
+            }
+            break;
+        }
+        case 0x0D:
+            if (value & 0x80) {
+                cia->icr_mask |= value & 0x1F;
+            } else {
+                cia->icr_mask &= (uint8_t)~(value & 0x1F);
+            }
+            break;
+        case 0x0E:
+        case 0x0F: {
+            int n = reg - 0x0E;
+            cia_sync(cia, n, now);
+            if (value & CR_LOAD) {
+                cia->counter[n] = cia->latch[n];
+            }
+            cia->cr[n] = value & (uint8_t)~CR_LOAD;
+            cia_schedule(cia, n, now);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+// ============================================================================
+// VIC-II raster
+// ============================================================================
+
+static inline uint64_t vic_frame_cycles(const C64Vic* vic) {
+    return (uint64_t)vic->cycles_per_line * (uint64_t)vic->lines;
+}
+
+static inline int vic_line(const C64Vic* vic, uint64_t now) {
+    uint64_t offset = now >= vic->frame_start ? now - vic->frame_start : 0;
+    return (int)((offset / (uint64_t)vic->cycles_per_line) % (uint64_t)vic->lines);
+}
+
+static void vic_schedule(C64Vic* vic, uint64_t now) {
+    if (vic->raster_compare >= vic->lines) {
+        vic->next_raster = C64_TIMING_NEVER;
+        return;
+    }
+
+    uint64_t frame = vic_frame_cycles(vic);
+    uint64_t match = vic->frame_start + (uint64_t)vic->raster_compare * (uint64_t)vic->cycles_per_line;
+    if (match <= now) {
+        match += ((now - match) / frame + 1) * frame;
+    }
+    vic->next_raster = match;
+}
+
+static uint8_t vic_read(const C64Vic* vic, uint8_t reg, uint64_t now) {
+    switch (reg) {
+        case 0x11: {
+            int line = vic_line(vic, now);
+            return (uint8_t)((vic->regs[0x11] & 0x7F) | ((line & 0x100) ? 0x80 : 0x00));
+        }
+        case 0x12: return (uint8_t)(vic_line(vic, now) & 0xFF);
+        case 0x19: {
+            bool irq = (vic->irq_flags & vic->irq_mask) != 0;
+            return (uint8_t)(vic->irq_flags | 0x70 | (irq ? 0x80 : 0x00));
+        }
+        case 0x1A: return (uint8_t)(vic->irq_mask | 0xF0);
+        default:   return vic->regs[reg];
+    }
+}
+
+static void vic_write(C64Vic* vic, uint8_t reg, uint8_t value, uint64_t now) {
+    vic->regs[reg] = value;
+
+    switch (reg) {
+        case 0x11:
+            vic->raster_compare = (uint16_t)((vic->raster_compare & 0xFF) | ((value & 0x80) << 1));
+            vic_schedule(vic, now);
+            break;
+        case 0x12:
+            vic->raster_compare = (uint16_t)((vic->raster_compare & 0x100) | value);
+            vic_schedule(vic, now);
+            break;
+        case 0x19:
+            /* Writing 1 acknowledges */
+            vic->irq_flags &= (uint8_t)~(value & 0x0F);
+            break;
+        case 0x1A:
+            vic->irq_mask = value & 0x0F;
+            break;
+        default:
+            break;
+    }
+}
+
+// ============================================================================
+// Scheduler
+// ============================================================================
+
+static void update_next_event(C64Timing* t) {
+    uint64_t next = t->vic.frame_start + vic_frame_cycles(&t->vic);
+    if (t->vic.next_raster < next) next = t->vic.next_raster;
+
+    for (int c = 0; c < 2; c++) {
+        for (int n = 0; n < 2; n++) {
+            if (t->cia[c].underflow[n] < next) next = t->cia[c].underflow[n];
+        }
+    }
+
+    t->next_event = next;
+}
+
+/* CIA2 drives the edge-triggered NMI line */
+static void update_nmi(C64Timing* t) {
+    bool line = cia_irq(&t->cia[1]);
+    if (line && !t->nmi_line) {
+        t->nmi_pending = true;
+    }
+    t->nmi_line = line;
+}
+
+void c64_timing_reset(C64Timing* t, bool pal, uint64_t now) {
+    memset(t, 0, sizeof(C64Timing));
+
+    t->vic.cycles_per_line = pal ? 63 : 65;
+    t->vic.lines = pal ? 312 : 263;
+    t->vic.frame_start = now;
+    t->vic.regs[0x11] = 0x1B;
+    vic_schedule(&t->vic, now);
+
+    for (int c = 0; c < 2; c++) {
+        C64Cia* cia = &t->cia[c];
+        cia->latch[0] = cia->latch[1] = 0xFFFF;
+        cia->counter[0] = cia->counter[1] = 0xFFFF;
+        cia->underflow[0] = cia->underflow[1] = C64_TIMING_NEVER;
+    }
+
+    /* KERNAL jiffy IRQ */
+    C64Cia* cia1 = &t->cia[0];
+    cia1->latch[0] = cia1->counter[0] = pal ? CIA_JIFFY_PAL : CIA_JIFFY_NTSC;
+    cia1->cr[0] = CR_START;
+    cia1->icr_mask = 0x01;
+    cia_schedule(cia1, 0, now);
+
+    update_next_event(t);
+}
+
+uint8_t c64_timing_read(C64Timing* t, uint16_t addr, uint64_t now) {
+    uint8_t page = (uint8_t)(addr >> 8);
+
+    if (page == 0xDC || page == 0xDD) {
+        int index = page - 0xDC;
+        uint8_t value = cia_read(&t->cia[index], index, addr & 0x0F, now);
+        if (index == 1) update_nmi(t);
+        return value;
+    }
+
+    if (page >= 0xD0 && page <= 0xD3) {
+        return vic_read(&t->vic, addr & 0x3F, now);
+    }
+
+    return 0xFF;
+}
+
+void c64_timing_write(C64Timing* t, uint16_t addr, uint8_t value, uint64_t now) {
+    uint8_t page = (uint8_t)(addr >> 8);
+
+    if (page == 0xDC || page == 0xDD) {
+        int index = page - 0xDC;
+        cia_write(&t->cia[index], addr & 0x0F, value, now);
+        if (index == 1) update_nmi(t);
+    } else if (page >= 0xD0 && page <= 0xD3) {
+        vic_write(&t->vic, addr & 0x3F, value, now);
+    } else {
+        return;
+    }
+
+    update_next_event(t);
+}
+
+uint32_t c64_timing_advance(C64Timing* t, uint64_t now) {
+    if (now < t->next_event) return 0;
+
+    uint32_t events = cia_advance(&t->cia[0], now);
+    events |= cia_advance(&t->cia[1], now) << 2;
+    update_nmi(t);
+
+    C64Vic* vic = &t->vic;
+    uint64_t frame = vic_frame_cycles(vic);
+    if (now >= vic->frame_start + frame) {
+        vic->frame_start += ((now - vic->frame_start) / frame) * frame;
+        events |= C64_EVENT_FRAME;
+    }
+    if (vic->next_raster <= now) {
+        vic->irq_flags |= 0x01;
+        vic_schedule(vic, now);
+        events |= C64_EVENT_RASTER;
+    }
+
+    update_next_event(t);
+    return events;
+}
+
+bool c64_timing_irq(const C64Timing* t) {
+    return cia_irq(&t->cia[0]) || (t->vic.irq_flags & t->vic.irq_mask) != 0;
+}
+
+bool c64_timing_take_nmi(C64Timing* t) {
+    bool pending = t->nmi_pending;
+    t->nmi_pending = false;
+    return pending;
+}
+
+uint32_t c64_timing_timer_a_period(const C64Timing* t, int cia) {
+    const C64Cia* c = &t->cia[cia & 1];
+    if (!(c->cr[0] & CR_START) || !cia_counts_cycles(c, 0)) return 0;
+
+    return (uint32_t)c->latch[0] + 1;
+}
+
+void c64_timing_start_timer_a(C64Timing* t, int cia, uint64_t now) {
+    C64Cia* c = &t->cia[cia & 1];
+    if (c->cr[0] & CR_START) return;
+
+    c->counter[0] = c->latch[0];
+    c->cr[0] = (uint8_t)((c->cr[0] | CR_START) & ~(CR_ONESHOT | 0x20));
+    cia_schedule(c, 0, now);
+    update_next_event(t);
+}
@@ -0,0 +1,131 @@
+/*
+ * C64 Interrupt Timing
+ * Minimal CIA1/CIA2 timer and VIC-II raster model for SID playback
+ *
+ * Only what music players rely on: the two 16-bit timers of each CIA
+ * (continuous/one-shot, timer B counting cycles or timer A underflows),
+ * the interrupt control registers, and the VIC raster counter with its
+ * raster-compare interrupt. CIA1 and the VIC drive IRQ, CIA2 drives NMI.
+ *
+ * Nothing is clocked per cycle. Every source keeps the absolute CPU cycle
+ * of its next event; c64_timing_next_event() tells the caller how far the
+ * CPU may run before anything can happen, and c64_timing_advance() fires
+ * whatever is due. A 4x multispeed tune therefore costs four events per
+ * frame, not a check on every instruction.
+ *
+ * Copyright (C) 2024
+ * SPDX-License-Identifier: ISC
+ */
+
+#ifndef C64_TIMING_H
+#define C64_TIMING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* No event scheduled */
+#define C64_TIMING_NEVER UINT64_MAX
+
+/* Event bits returned by c64_timing_advance() */
+#define C64_EVENT_CIA1_TA  0x01   /* CIA1 timer A underflow */
+#define C64_EVENT_CIA1_TB  0x02   /* CIA1 timer B underflow */
+#define C64_EVENT_CIA2_TA  0x04   /* CIA2 timer A underflow */
+#define C64_EVENT_CIA2_TB  0x08   /* CIA2 timer B underflow */
+#define C64_EVENT_RASTER   0x10   /* Raster line matched the compare register */
+#define C64_EVENT_FRAME    0x20   /* Raster wrapped to line 0 (vertical blank) */
+
+/* One CIA 6526 (timers and interrupt control only) */
+typedef struct {
+    uint8_t regs[16];       /* Last written values (ports, TOD, SDR) */
+    uint16_t latch[2];      /* Timer A/B reload values */
+    uint16_t counter[2];    /* Timer value while stopped or counting underflows */
+    uint64_t underflow[2];  /* Absolute cycle of the next underflow */
+    uint8_t cr[2];          /* Control registers A/B */
+    uint8_t icr_mask;       /* Enabled interrupt sources */
+    uint8_t icr_flags;      /* Latched interrupt sources */
+} C64Cia;
+
+/* VIC-II raster counter and interrupt registers */
+typedef struct {
+    uint8_t regs[64];       /* Last written values */
+    int cycles_per_line;    /* 63 (PAL) / 65 (NTSC) */
+    int lines;              /* 312 (PAL) / 263 (NTSC) */
+    uint64_t frame_start;   /* Absolute cycle of the current frame's line 0 */
+    uint16_t raster_compare;
+    uint64_t next_raster;   /* Absolute cycle of the next compare match */
+    uint8_t irq_mask;
+    uint8_t irq_flags;
+} C64Vic;
+
+typedef struct {
+    C64Cia cia[2];          /* [0] = CIA1 ($DC00, IRQ), [1] = CIA2 ($DD00, NMI) */
+    C64Vic vic;
+    uint64_t next_event;    /* Earliest scheduled event of all sources */
+    bool nmi_line;          /* CIA2 interrupt output */
+    bool nmi_pending;       /* NMI edge not yet taken */
+} C64Timing;
+
+/**
+ * Reset to the state the KERNAL leaves behind: CIA1 timer A running
+ * continuously with the 60 Hz jiffy value and its IRQ enabled, raster
+ * interrupt off.
+ * @param pal true for PAL (312 x 63 cycles), false for NTSC (263 x 65)
+ * @param now Current CPU cycle
+ */
+void c64_timing_reset(C64Timing* t, bool pal, uint64_t now);
+
+/**
+ * Read a VIC ($D000-$D3FF) or CIA ($DC00-$DDFF) register
+ * Reading a CIA interrupt control register acknowledges its interrupts.
+ */
+uint8_t c64_timing_read(C64Timing* t, uint16_t addr, uint64_t now);
+
+/**
+ * Write a VIC ($D000-$D3FF) or CIA ($DC00-$DDFF) register
+ */
+void c64_timing_write(C64Timing* t, uint16_t addr, uint8_t value, uint64_t now);
+
+/**
+ * Fire every event scheduled at or before a cycle
+ * @return C64_EVENT_* bits of the sources that fired
+ */
+uint32_t c64_timing_advance(C64Timing* t, uint64_t now);
+
+/**
+ * Absolute cycle of the next scheduled event (C64_TIMING_NEVER if none)
+ */
+static inline uint64_t c64_timing_next_event(const C64Timing* t) {
+    return t->next_event;
+}
+
+/**
+ * Level of the IRQ line (CIA1 or VIC interrupt pending and enabled)
+ */
+bool c64_timing_irq(const C64Timing* t);
+
+/**
+ * Take a pending NMI edge from CIA2
+ * @return true once per edge
+ */
+bool c64_timing_take_nmi(C64Timing* t);
+
+/**
+ * Period in cycles of a CIA timer A (latch + 1), 0 if it is stopped
+ * @param cia 0 = CIA1, 1 = CIA2
+ */
+uint32_t c64_timing_timer_a_period(const C64Timing* t, int cia);
+
+/**
+ * Start a stopped CIA timer A in continuous mode from its latch
+ */
+void c64_timing_start_timer_a(C64Timing* t, int cia, uint64_t now);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // C64_TIMING_H
@@ -1,21 +1,201 @@
 /*
  * MOS 6502 CPU Emulator
  * Minimal implementation for music player use
+ *
+ * Reentrant (all state in CPU6502Context), table-timed NMOS core with the
+ * stable undocumented opcodes. Memory goes straight to the RAM pointer
+ * except for pages marked as I/O.
  */
 
 #include "cpu_6502.h"
 #include <string.h>
 #include <stdio.h>
 
+// ============================================================================
+// Tables
+// ============================================================================
+
+/* Base cycles per opcode (NMOS 6502, including undocumented opcodes).
+ * Page-crossing and branch penalties are added during execution. */
+static const uint8_t cycle_table[256] = {
+/*       0  1  2  3  4  5  6  7  8  9  A  B  C  D  E  F */
+/* 0 */  7, 6, 2, 8, 3, 3, 5, 5, 3, 2, 2, 2, 4, 4, 6, 6,
+/* 1 */  2, 5, 2, 8, 4, 4, 6, 6, 2, 4, 2, 7, 4, 4, 7, 7,
+/* 2 */  6, 6, 2, 8, 3, 3, 5, 5, 4, 2, 2, 2, 4, 4, 6, 6,
+/* 3 */  2, 5, 2, 8, 4, 4, 6, 6, 2, 4, 2, 7, 4, 4, 7, 7,
+/* 4 */  6, 6, 2, 8, 3, 3, 5, 5, 3, 2, 2, 2, 3, 4, 6, 6,
+/* 5 */  2, 5, 2, 8, 4, 4, 6, 6, 2, 4, 2, 7, 4, 4, 7, 7,
+/* 6 */  6, 6, 2, 8, 3, 3, 5, 5, 4, 2, 2, 2, 5, 4, 6, 6,
+/* 7 */  2, 5, 2, 8, 4, 4, 6, 6, 2, 4, 2, 7, 4, 4, 7, 7,
+/* 8 */  2, 6, 2, 6, 3, 3, 3, 3, 2, 2, 2, 2, 4, 4, 4, 4,
+/* 9 */  2, 6, 2, 6, 4, 4, 4, 4, 2, 5, 2, 5, 5, 5, 5, 5,
+/* A */  2, 6, 2, 6, 3, 3, 3, 3, 2, 2, 2, 2, 4, 4, 4, 4,
+/* B */  2, 5, 2, 5, 4, 4, 4, 4, 2, 4, 2, 4, 4, 4, 4, 4,
+/* C */  2, 6, 2, 8, 3, 3, 5, 5, 2, 2, 2, 2, 4, 4, 6, 6,
+/* D */  2, 5, 2, 8, 4, 4, 6, 6, 2, 4, 2, 7, 4, 4, 7, 7,
+/* E */  2, 6, 2, 8, 3, 3, 5, 5, 2, 2, 2, 2, 4, 4, 6, 6,
+/* F */  2, 5, 2, 8, 4, 4, 6, 6, 2, 4, 2, 7, 4, 4, 7, 7,
+};
+
+// ============================================================================
+// Memory Access
+// ============================================================================
+
+/* Outside the execution loop (stack helpers) */
+static inline uint8_t rd(CPU6502Context* ctx, uint16_t addr) {
+    return ctx->io_page[addr >> 8] ? ctx->read(ctx->userdata, addr) : ctx->ram[addr];
+}
+
+static inline void wr(CPU6502Context* ctx, uint16_t addr, uint8_t value) {
+    if (ctx->io_page[addr >> 8]) {
+        ctx->write(ctx->userdata, addr, value);
+    } else {
+        ctx->ram[addr] = value;
+    }
+}
+
+/* Inside the execution loop the registers and cycle counter are locals
+ * (stores through the RAM pointer would otherwise force them back to
+ * memory); the counter is published to the context before each callback
+ * so I/O handlers see the current cycle. */
+static inline uint8_t bus_read(CPU6502Context* ctx, const uint8_t* ram, uint64_t clock, uint16_t addr) {
+    if (ctx->io_page[addr >> 8]) {
+        ctx->cycles = clock;
+        return ctx->read(ctx->userdata, addr);
+    }
+    return ram[addr];
+}
+
+static inline void bus_write(CPU6502Context* ctx, uint8_t* ram, uint64_t clock, uint16_t addr, uint8_t value) {
+    if (ctx->io_page[addr >> 8]) {
+        ctx->cycles = clock;
+        ctx->write(ctx->userdata, addr, value);
+    } else {
+        ram[addr] = value;
+    }
+}
+
+/* Read-modify-write: the NMOS part writes the unmodified value back
+ * before the result, which is how "ASL $D019" acknowledges raster IRQs */
+static inline void bus_modify(CPU6502Context* ctx, uint8_t* ram, uint64_t clock, uint16_t addr,
+                              uint8_t old_value, uint8_t value) {
+    if (ctx->io_page[addr >> 8]) {
+        ctx->cycles = clock;
+        ctx->write(ctx->userdata, addr, old_value);
+        ctx->write(ctx->userdata, addr, value);
+    } else {
+        ram[addr] = value;
+    }
+}
+
 // ============================================================================
 // Helper Functions
 // ============================================================================
 
-static void cpu_set_nz(CPU6502* cpu, uint8_t value) {
+static inline void cpu_set_nz(CPU6502* cpu, uint8_t value) {
     cpu->flag_z = (value == 0);
     cpu->flag_n = (value & 0x80) != 0;
 }
 
+static inline uint8_t pack_flags(const CPU6502* cpu, bool brk) {
+    return (uint8_t)((cpu->flag_n << 7) | (cpu->flag_v << 6) | 0x20 | (brk ? 0x10 : 0) |
+                     (cpu->flag_d << 3) | (cpu->flag_i << 2) | (cpu->flag_z << 1) | cpu->flag_c);
+}
+
+static inline void unpack_flags(CPU6502* cpu, uint8_t p) {
+    cpu->p = p;
+    cpu->flag_n = (p >> 7) & 1;
+    cpu->flag_v = (p >> 6) & 1;
+    cpu->flag_b = (p >> 4) & 1;
+    cpu->flag_d = (p >> 3) & 1;
+    cpu->flag_i = (p >> 2) & 1;
+    cpu->flag_z = (p >> 1) & 1;
+    cpu->flag_c = p & 1;
+}
+
+static inline void op_adc(CPU6502* cpu, uint8_t value) {
+    if (cpu->flag_d) {
+        /* NMOS decimal mode: N and V from the intermediate, Z from binary */
+        unsigned tmp = (cpu->a & 0x0F) + (value & 0x0F) + cpu->flag_c;
+        if (tmp > 0x09) tmp += 0x06;
+        tmp = (tmp <= 0x0F) ? (tmp & 0x0F) + (cpu->a & 0xF0) + (value & 0xF0)
+                            : (tmp & 0x0F) + (cpu->a & 0xF0) + (value & 0xF0) + 0x10;
+        cpu->flag_z = ((cpu->a + value + cpu->flag_c) & 0xFF) == 0;
+        cpu->flag_n = (tmp & 0x80) != 0;
+        cpu->flag_v = ((cpu->a ^ tmp) & 0x80) && !((cpu->a ^ value) & 0x80);
+        if ((tmp & 0x1F0) > 0x90) tmp += 0x60;
+        cpu->flag_c = (tmp & 0xFF0) > 0xF0;
+        cpu->a = tmp & 0xFF;
+        return;
+    }
+
+    uint16_t result = cpu->a + value + cpu->flag_c;
+    cpu->flag_c = result > 0xFF;
+    cpu->flag_v = ((cpu->a ^ result) & (value ^ result) & 0x80) != 0;
+    cpu->a = result & 0xFF;
+    cpu_set_nz(cpu, cpu->a);
+}
+
+static inline void op_sbc(CPU6502* cpu, uint8_t value) {
+    uint16_t result = cpu->a - value - (1 - cpu->flag_c);
+    const uint8_t a = cpu->a;
+
+    cpu->flag_v = ((a ^ value) & (a ^ result) & 0x80) != 0;
+    cpu_set_nz(cpu, result & 0xFF);
+
+    if (cpu->flag_d) {
+        unsigned tmp = (a & 0x0F) - (value & 0x0F) - (1 - cpu->flag_c);
+        tmp = (tmp & 0x10) ? ((tmp - 6) & 0x0F) | ((a & 0xF0) - (value & 0xF0) - 0x10)
+                           : (tmp & 0x0F) | ((a & 0xF0) - (value & 0xF0));
+        if (tmp & 0x100) tmp -= 0x60;
+        cpu->a = tmp & 0xFF;
+    } else {
+        cpu->a = result & 0xFF;
+    }
+    cpu->flag_c = result < 0x100;
+}
+
+static inline void op_cmp(CPU6502* cpu, uint8_t reg, uint8_t value) {
+    cpu->flag_c = reg >= value;
+    cpu_set_nz(cpu, (uint8_t)(reg - value));
+}
+
+static inline void op_bit(CPU6502* cpu, uint8_t value) {
+    cpu->flag_z = (cpu->a & value) == 0;
+    cpu->flag_n = (value & 0x80) != 0;
+    cpu->flag_v = (value & 0x40) != 0;
+}
+
+static inline uint8_t op_asl(CPU6502* cpu, uint8_t value) {
+    cpu->flag_c = value >> 7;
+    value <<= 1;
+    cpu_set_nz(cpu, value);
+    return value;
+}
+
+static inline uint8_t op_lsr(CPU6502* cpu, uint8_t value) {
+    cpu->flag_c = value & 1;
+    value >>= 1;
+    cpu_set_nz(cpu, value);
+    return value;
+}
+
+static inline uint8_t op_rol(CPU6502* cpu, uint8_t value) {
+    const uint8_t carry = cpu->flag_c;
+    cpu->flag_c = value >> 7;
+    value = (uint8_t)((value << 1) | carry);
+    cpu_set_nz(cpu, value);
+    return value;
+}
+
+static inline uint8_t op_ror(CPU6502* cpu, uint8_t value) {
+    const uint8_t carry = cpu->flag_c;
+    cpu->flag_c = value & 1;
+    value = (uint8_t)((value >> 1) | (carry << 7));
+    cpu_set_nz(cpu, value);
+    return value;
+}
+
 // ============================================================================
 // Lifecycle
 // ============================================================================
@@ -27,15 +207,33 @@ void cpu_init(CPU6502Context* ctx, void* userdata,
     ctx->read = read_func;
     ctx->write = write_func;
 
-    /* Initialize CPU state */
-    ctx->cpu.sp = 0xFF;
-    ctx->cpu.p = 0x04;  /* IRQ disable */
+    /* No RAM attached yet: every page goes through the callbacks */
+    memset(ctx->io_page, 1, sizeof(ctx->io_page));
+    ctx->trap_pc = -1;
+
+    cpu_reset(ctx);
 }
 
 void cpu_reset(CPU6502Context* ctx) {
     memset(&ctx->cpu, 0, sizeof(CPU6502));
     ctx->cpu.sp = 0xFF;
-    ctx->cpu.p = 0x04;  /* IRQ disable */
+    unpack_flags(&ctx->cpu, 0x24);  /* IRQ disable */
+    ctx->jammed = false;
+}
+
+void cpu_set_memory(CPU6502Context* ctx, uint8_t* ram) {
+    ctx->ram = ram;
+    memset(ctx->io_page, ram ? 0 : 1, sizeof(ctx->io_page));
+}
+
+void cpu_set_io_page(CPU6502Context* ctx, uint8_t page, bool io) {
+    if (!ctx->ram) return;  /* Everything is I/O without direct RAM */
+
+    ctx->io_page[page] = io ? 1 : 0;
+}
+
+void cpu_set_trap(CPU6502Context* ctx, int32_t addr) {
+    ctx->trap_pc = (addr >= 0 && addr <= 0xFFFF) ? addr : -1;
 }
 
 // ============================================================================
@@ -43,1036 +241,548 @@ void cpu_reset(CPU6502Context* ctx) {
 // ============================================================================
 
 void cpu_push(CPU6502Context* ctx, uint8_t value) {
-    ctx->write(ctx->userdata, 0x0100 + ctx->cpu.sp, value);
+    wr(ctx, 0x0100 + ctx->cpu.sp, value);
     ctx->cpu.sp--;
 }
 
 uint8_t cpu_pull(CPU6502Context* ctx) {
     ctx->cpu.sp++;
-    return ctx->read(ctx->userdata, 0x0100 + ctx->cpu.sp);
+    return rd(ctx, 0x0100 + ctx->cpu.sp);
 }
 
 // ============================================================================
 // Instruction Execution
 // ============================================================================
 
-int cpu_step(CPU6502Context* ctx) {
-    CPU6502* cpu = &ctx->cpu;
-    uint16_t pc_start = cpu->pc;
-    uint8_t opcode = ctx->read(ctx->userdata, cpu->pc++);
-    int cycles = 2;  /* Most instructions are 2+ cycles */
-
-    static int unknown_count = 0;
-    static int instr_count = 0;
-    bool is_unknown = false;
+/* Operand fetch and effective address helpers (use ctx, cpu, addr, cycles) */
+#define RD(a)       bus_read(ctx, ram, *clock, (a))
+#define WR(a, v)    bus_write(ctx, ram, *clock, (a), (v))
+#define FETCH()     RD(cpu->pc++)
+#define FETCH16()   (tmp16 = FETCH(), (uint16_t)(tmp16 | (FETCH() << 8)))
+#define PUSH(v)     WR(0x0100 + cpu->sp--, (v))
+#define PULL()      RD(0x0100 + ++cpu->sp)
+
+#define ZP()        (addr = FETCH())
+#define ZPX()       (addr = (uint8_t)(FETCH() + cpu->x))
+#define ZPY()       (addr = (uint8_t)(FETCH() + cpu->y))
+#define ABS()       (addr = FETCH16())
+#define ABSX()      (addr = (uint16_t)(FETCH16() + cpu->x))
+#define ABSY()      (addr = (uint16_t)(FETCH16() + cpu->y))
+#define IZX()       do { uint8_t zp = (uint8_t)(FETCH() + cpu->x); \
+                         addr = (uint16_t)(RD(zp) | (RD((uint8_t)(zp + 1)) << 8)); } while (0)
+#define IZY()       do { uint8_t zp = FETCH(); \
+                         addr = (uint16_t)((RD(zp) | (RD((uint8_t)(zp + 1)) << 8)) + cpu->y); } while (0)
+
+/* Read variants add a cycle when indexing crosses a page */
+#define ABSX_R()    do { uint16_t base = FETCH16(); addr = (uint16_t)(base + cpu->x); \
+                         cycles += ((base ^ addr) >> 8) & 1; } while (0)
+#define ABSY_R()    do { uint16_t base = FETCH16(); addr = (uint16_t)(base + cpu->y); \
+                         cycles += ((base ^ addr) >> 8) & 1; } while (0)
+#define IZY_R()     do { uint8_t zp = FETCH(); \
+                         uint16_t base = (uint16_t)(RD(zp) | (RD((uint8_t)(zp + 1)) << 8)); \
+                         addr = (uint16_t)(base + cpu->y); \
+                         cycles += ((base ^ addr) >> 8) & 1; } while (0)
+
+#define BRANCH(cond) do { int8_t rel = (int8_t)FETCH(); \
+                         if (cond) { uint16_t target = (uint16_t)(cpu->pc + rel); \
+                             cycles += 1 + (((cpu->pc ^ target) >> 8) & 1); \
+                             cpu->pc = target; } } while (0)
+
+/* Read-modify-write: value = OP(value), written back */
+#define MODIFY(a, old, v) bus_modify(ctx, ram, *clock, (a), (old), (v))
+#define RMW(op)     do { uint8_t old = RD(addr); MODIFY(addr, old, op(cpu, old)); } while (0)
+
+/* Inlined into the run loop so the register file stays in registers */
+#if defined(__GNUC__)
+#define CPU_ALWAYS_INLINE static inline __attribute__((always_inline))
+#else
+#define CPU_ALWAYS_INLINE static inline
+#endif
+
+CPU_ALWAYS_INLINE int execute(CPU6502Context* ctx, CPU6502* cpu, uint64_t* clock) {
+    uint8_t* const ram = ctx->ram;
+    const uint16_t pc_start = cpu->pc;
+    const uint8_t opcode = RD(cpu->pc++);
+    int cycles = cycle_table[opcode];
+    uint16_t addr;
+    uint16_t tmp16;
+
+    /* Writes happen on the last cycle of an instruction */
+    *clock += cycles;
 
     switch (opcode) {
         /* ADC - Add with Carry */
-        case 0x65: /* Zero Page */ {
-            uint8_t value = ctx->read(ctx->userdata, ctx->read(ctx->userdata, cpu->pc++));
-            uint16_t result = cpu->a + value + cpu->flag_c;
-            cpu->flag_c = result > 0xFF;
-            cpu->flag_v = ((cpu->a ^ result) & (value ^ result) & 0x80) != 0;
-            cpu->a = result & 0xFF;
-            cpu_set_nz(cpu, cpu->a);
-            cycles = 3;
-            break;
-        }
-        case 0x69: { /* Immediate */
-            uint8_t value = ctx->read(ctx->userdata, cpu->pc++);
-            uint16_t result = cpu->a + value + cpu->flag_c;
-            cpu->flag_c = result > 0xFF;
-            cpu->flag_v = ((cpu->a ^ result) & (value ^ result) & 0x80) != 0;
-            cpu->a = result & 0xFF;
-            cpu_set_nz(cpu, cpu->a);
-            break;
-        }
-        case 0x6D: { /* Absolute */
-            uint16_t addr = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint8_t value = ctx->read(ctx->userdata, addr);
-            uint16_t result = cpu->a + value + cpu->flag_c;
-            cpu->flag_c = result > 0xFF;
-            cpu->flag_v = ((cpu->a ^ result) & (value ^ result) & 0x80) != 0;
-            cpu->a = result & 0xFF;
-            cpu_set_nz(cpu, cpu->a);
-            cycles = 4;
-            break;
-        }
-        case 0x79: { /* Absolute,Y */
-            uint16_t base = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint16_t addr = base + cpu->y;
-            uint8_t value = ctx->read(ctx->userdata, addr);
-            uint16_t result = cpu->a + value + cpu->flag_c;
-            cpu->flag_c = result > 0xFF;
-            cpu->flag_v = ((cpu->a ^ result) & (value ^ result) & 0x80) != 0;
-            cpu->a = result & 0xFF;
-            cpu_set_nz(cpu, cpu->a);
-            cycles = 4;
-            break;
-        }
-        case 0x7D: { /* Absolute,X */
-            uint16_t base = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint16_t addr = base + cpu->x;
-            uint8_t value = ctx->read(ctx->userdata, addr);
-            uint16_t result = cpu->a + value + cpu->flag_c;
-            cpu->flag_c = result > 0xFF;
-            cpu->flag_v = ((cpu->a ^ result) & (value ^ result) & 0x80) != 0;
-            cpu->a = result & 0xFF;
-            cpu_set_nz(cpu, cpu->a);
-            cycles = 4;
-            break;
-        }
+        case 0x69: op_adc(cpu, FETCH()); break;
+        case 0x65: ZP();     op_adc(cpu, RD(addr)); break;
+        case 0x75: ZPX();    op_adc(cpu, RD(addr)); break;
+        case 0x6D: ABS();    op_adc(cpu, RD(addr)); break;
+        case 0x7D: ABSX_R(); op_adc(cpu, RD(addr)); break;
+        case 0x79: ABSY_R(); op_adc(cpu, RD(addr)); break;
+        case 0x61: IZX();    op_adc(cpu, RD(addr)); break;
+        case 0x71: IZY_R();  op_adc(cpu, RD(addr)); break;
 
         /* AND - Logical AND */
-        case 0x25: /* Zero Page */
-            cpu->a &= ctx->read(ctx->userdata, ctx->read(ctx->userdata, cpu->pc++));
-            cpu_set_nz(cpu, cpu->a);
-            cycles = 3;
-            break;
-        case 0x29: { /* Immediate */
-            uint8_t value = ctx->read(ctx->userdata, cpu->pc++);
-            cpu->a &= value;
-            cpu_set_nz(cpu, cpu->a);
-            break;
-        }
-        case 0x2D: { /* Absolute */
-            uint16_t addr = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            cpu->a &= ctx->read(ctx->userdata, addr);
-            cpu_set_nz(cpu, cpu->a);
-            cycles = 4;
-            break;
-        }
-        case 0x39: { /* Absolute,Y */
-            uint16_t base = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint16_t addr = base + cpu->y;
-            cpu->a &= ctx->read(ctx->userdata, addr);
-            cpu_set_nz(cpu, cpu->a);
-            cycles = 4;
-            break;
-        }
-        case 0x3D: { /* Absolute,X */
-            uint16_t base = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint16_t addr = base + cpu->x;
-            cpu->a &= ctx->read(ctx->userdata, addr);
-            cpu_set_nz(cpu, cpu->a);
-            cycles = 4;
-            break;
-        }
-
-        /* BCC - Branch if Carry Clear */
-        case 0x90: {
-            int8_t offset = (int8_t)ctx->read(ctx->userdata, cpu->pc++);
-            if (!cpu->flag_c) {
-                cpu->pc += offset;
-                cycles = 3;
-            }
-            break;
-        }
-
-        /* BCS - Branch if Carry Set */
-        case 0xB0: {
-            int8_t offset = (int8_t)ctx->read(ctx->userdata, cpu->pc++);
-            if (cpu->flag_c) {
-                cpu->pc += offset;
-                cycles = 3;
-            }
-            break;
-        }
-
-        /* BEQ - Branch if Equal (Z set) */
-        case 0xF0: {
-            int8_t offset = (int8_t)ctx->read(ctx->userdata, cpu->pc++);
-            if (cpu->flag_z) {
-                cpu->pc += offset;
-                cycles = 3;
-            }
-            break;
-        }
-
-        /* BIT - Test Bits */
-        case 0x24: /* Zero Page */ {
-            uint8_t value = ctx->read(ctx->userdata, ctx->read(ctx->userdata, cpu->pc++));
-            cpu->flag_z = (cpu->a & value) == 0;
-            cpu->flag_n = (value & 0x80) != 0;
-            cpu->flag_v = (value & 0x40) != 0;
-            cycles = 3;
-            break;
-        }
-        case 0x2C: { /* Absolute */
-            uint16_t addr = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint8_t value = ctx->read(ctx->userdata, addr);
-            cpu->flag_z = (cpu->a & value) == 0;
-            cpu->flag_n = (value & 0x80) != 0;
-            cpu->flag_v = (value & 0x40) != 0;
-            cycles = 4;
-            break;
-        }
-
-        /* BMI - Branch if Minus (N set) */
-        case 0x30: {
-            int8_t offset = (int8_t)ctx->read(ctx->userdata, cpu->pc++);
-            if (cpu->flag_n) {
-                cpu->pc += offset;
-                cycles = 3;
-            }
-            break;
-        }
-
-        /* BNE - Branch if Not Equal (Z clear) */
-        case 0xD0: {
-            int8_t offset = (int8_t)ctx->read(ctx->userdata, cpu->pc++);
-            if (!cpu->flag_z) {
-                cpu->pc += offset;
-                cycles = 3;
-            }
-            break;
-        }
-
-        /* BPL - Branch if Plus (N clear) */
-        case 0x10: {
-            int8_t offset = (int8_t)ctx->read(ctx->userdata, cpu->pc++);
-            if (!cpu->flag_n) {
-                cpu->pc += offset;
-                cycles = 3;
-            }
-            break;
-        }
-
-        /* BVC - Branch if Overflow Clear */
-        case 0x50: {
-            int8_t offset = (int8_t)ctx->read(ctx->userdata, cpu->pc++);
-            if (!cpu->flag_v) {
-                cpu->pc += offset;
-                cycles = 3;
-            }
-            break;
-        }
-
-        /* BVS - Branch if Overflow Set */
-        case 0x70: {
-            int8_t offset = (int8_t)ctx->read(ctx->userdata, cpu->pc++);
-            if (cpu->flag_v) {
-                cpu->pc += offset;
-                cycles = 3;
-            }
-            break;
-        }
+        case 0x29: cpu->a &= FETCH(); cpu_set_nz(cpu, cpu->a); break;
+        case 0x25: ZP();     cpu->a &= RD(addr); cpu_set_nz(cpu, cpu->a); break;
+        case 0x35: ZPX();    cpu->a &= RD(addr); cpu_set_nz(cpu, cpu->a); break;
+        case 0x2D: ABS();    cpu->a &= RD(addr); cpu_set_nz(cpu, cpu->a); break;
+        case 0x3D: ABSX_R(); cpu->a &= RD(addr); cpu_set_nz(cpu, cpu->a); break;
+        case 0x39: ABSY_R(); cpu->a &= RD(addr); cpu_set_nz(cpu, cpu->a); break;
+        case 0x21: IZX();    cpu->a &= RD(addr); cpu_set_nz(cpu, cpu->a); break;
+        case 0x31: IZY_R();  cpu->a &= RD(addr); cpu_set_nz(cpu, cpu->a); break;
 
         /* ASL - Arithmetic Shift Left */
-        case 0x0A: /* Accumulator */
-            cpu->flag_c = (cpu->a & 0x80) != 0;
-            cpu->a <<= 1;
-            cpu_set_nz(cpu, cpu->a);
-            break;
-        case 0x06: { /* Zero Page */
-            uint8_t zp = ctx->read(ctx->userdata, cpu->pc++);
-            uint8_t value = ctx->read(ctx->userdata, zp);
-            cpu->flag_c = (value & 0x80) != 0;
-            value <<= 1;
-            ctx->write(ctx->userdata, zp, value);
-            cpu_set_nz(cpu, value);
-            cycles = 5;
-            break;
-        }
-        case 0x0E: { /* Absolute */
-            uint16_t addr = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint8_t value = ctx->read(ctx->userdata, addr);
-            cpu->flag_c = (value & 0x80) != 0;
-            value <<= 1;
-            ctx->write(ctx->userdata, addr, value);
-            cpu_set_nz(cpu, value);
-            cycles = 6;
-            break;
-        }
-        case 0x1E: { /* Absolute,X */
-            uint16_t base = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint16_t addr = base + cpu->x;
-            uint8_t value = ctx->read(ctx->userdata, addr);
-            cpu->flag_c = (value & 0x80) != 0;
-            value <<= 1;
-            ctx->write(ctx->userdata, addr, value);
-            cpu_set_nz(cpu, value);
-            cycles = 7;
-            break;
-        }
+        case 0x0A: cpu->a = op_asl(cpu, cpu->a); break;
+        case 0x06: ZP();   RMW(op_asl); break;
+        case 0x16: ZPX();  RMW(op_asl); break;
+        case 0x0E: ABS();  RMW(op_asl); break;
+        case 0x1E: ABSX(); RMW(op_asl); break;
+
+        /* Branches */
+        case 0x90: BRANCH(!cpu->flag_c); break;  /* BCC */
+        case 0xB0: BRANCH(cpu->flag_c); break;   /* BCS */
+        case 0xF0: BRANCH(cpu->flag_z); break;   /* BEQ */
+        case 0xD0: BRANCH(!cpu->flag_z); break;  /* BNE */
+        case 0x30: BRANCH(cpu->flag_n); break;   /* BMI */
+        case 0x10: BRANCH(!cpu->flag_n); break;  /* BPL */
+        case 0x50: BRANCH(!cpu->flag_v); break;  /* BVC */
+        case 0x70: BRANCH(cpu->flag_v); break;   /* BVS */
 
-        /* CLC - Clear Carry */
-        case 0x18:
-            cpu->flag_c = 0;
+        /* BIT - Test Bits */
+        case 0x24: ZP();  op_bit(cpu, RD(addr)); break;
+        case 0x2C: ABS(); op_bit(cpu, RD(addr)); break;
+
+        /* BRK - Force Interrupt */
+        case 0x00:
+            cpu->pc++;
+            PUSH(cpu->pc >> 8);
+            PUSH(cpu->pc & 0xFF);
+            PUSH(pack_flags(cpu, true));
+            cpu->flag_i = 1;
+            cpu->pc = (uint16_t)(RD(0xFFFE) | (RD(0xFFFF) << 8));
             break;
 
-        /* CLD - Clear Decimal */
-        case 0xD8:
-            cpu->flag_d = 0;
-            break;
-
-        /* CLI - Clear Interrupt Disable */
-        case 0x58:
-            cpu->flag_i = 0;
-            break;
+        /* Flag instructions */
+        case 0x18: cpu->flag_c = 0; break;  /* CLC */
+        case 0x38: cpu->flag_c = 1; break;  /* SEC */
+        case 0x58: cpu->flag_i = 0; break;  /* CLI */
+        case 0x78: cpu->flag_i = 1; break;  /* SEI */
+        case 0xB8: cpu->flag_v = 0; break;  /* CLV */
+        case 0xD8: cpu->flag_d = 0; break;  /* CLD */
+        case 0xF8: cpu->flag_d = 1; break;  /* SED */
 
         /* CMP - Compare Accumulator */
-        case 0xC5: { /* Zero Page */
-            uint8_t value = ctx->read(ctx->userdata, ctx->read(ctx->userdata, cpu->pc++));
-            uint16_t result = cpu->a - value;
-            cpu->flag_c = cpu->a >= value;
-            cpu_set_nz(cpu, result & 0xFF);
-            cycles = 3;
-            break;
-        }
-        case 0xC9: { /* Immediate */
-            uint8_t value = ctx->read(ctx->userdata, cpu->pc++);
-            uint16_t result = cpu->a - value;
-            cpu->flag_c = cpu->a >= value;
-            cpu_set_nz(cpu, result & 0xFF);
-            break;
-        }
-        case 0xCD: { /* Absolute */
-            uint16_t addr = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint8_t value = ctx->read(ctx->userdata, addr);
-            uint16_t result = cpu->a - value;
-            cpu->flag_c = cpu->a >= value;
-            cpu_set_nz(cpu, result & 0xFF);
-            cycles = 4;
-            break;
-        }
-        case 0xD9: { /* Absolute,Y */
-            uint16_t base = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint16_t addr = base + cpu->y;
-            uint8_t value = ctx->read(ctx->userdata, addr);
-            uint16_t result = cpu->a - value;
-            cpu->flag_c = cpu->a >= value;
-            cpu_set_nz(cpu, result & 0xFF);
-            cycles = 4;
-            break;
-        }
-        case 0xDD: { /* Absolute,X */
-            uint16_t base = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint16_t addr = base + cpu->x;
-            uint8_t value = ctx->read(ctx->userdata, addr);
-            uint16_t result = cpu->a - value;
-            cpu->flag_c = cpu->a >= value;
-            cpu_set_nz(cpu, result & 0xFF);
-            cycles = 4;
-            break;
-        }
-
-        /* CPX - Compare X */
-        case 0xE0: { /* Immediate */
-            uint8_t value = ctx->read(ctx->userdata, cpu->pc++);
-            uint16_t result = cpu->x - value;
-            cpu->flag_c = cpu->x >= value;
-            cpu_set_nz(cpu, result & 0xFF);
-            break;
-        }
-        case 0xEC: { /* Absolute */
-            uint16_t addr = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint8_t value = ctx->read(ctx->userdata, addr);
-            uint16_t result = cpu->x - value;
-            cpu->flag_c = cpu->x >= value;
-            cpu_set_nz(cpu, result & 0xFF);
-            cycles = 4;
-            break;
-        }
-
-        /* CPY - Compare Y */
-        case 0xC0: { /* Immediate */
-            uint8_t value = ctx->read(ctx->userdata, cpu->pc++);
-            uint16_t result = cpu->y - value;
-            cpu->flag_c = cpu->y >= value;
-            cpu_set_nz(cpu, result & 0xFF);
-            break;
-        }
-        case 0xCC: { /* Absolute */
-            uint16_t addr = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint8_t value = ctx->read(ctx->userdata, addr);
-            uint16_t result = cpu->y - value;
-            cpu->flag_c = cpu->y >= value;
-            cpu_set_nz(cpu, result & 0xFF);
-            cycles = 4;
-            break;
-        }
+        case 0xC9: op_cmp(cpu, cpu->a, FETCH()); break;
+        case 0xC5: ZP();     op_cmp(cpu, cpu->a, RD(addr)); break;
+        case 0xD5: ZPX();    op_cmp(cpu, cpu->a, RD(addr)); break;
+        case 0xCD: ABS();    op_cmp(cpu, cpu->a, RD(addr)); break;
+        case 0xDD: ABSX_R(); op_cmp(cpu, cpu->a, RD(addr)); break;
+        case 0xD9: ABSY_R(); op_cmp(cpu, cpu->a, RD(addr)); break;
+        case 0xC1: IZX();    op_cmp(cpu, cpu->a, RD(addr)); break;
+        case 0xD1: IZY_R();  op_cmp(cpu, cpu->a, RD(addr)); break;
+
+        /* CPX / CPY - Compare X / Y */
+        case 0xE0: op_cmp(cpu, cpu->x, FETCH()); break;
+        case 0xE4: ZP();  op_cmp(cpu, cpu->x, RD(addr)); break;
+        case 0xEC: ABS(); op_cmp(cpu, cpu->x, RD(addr)); break;
+        case 0xC0: op_cmp(cpu, cpu->y, FETCH()); break;
+        case 0xC4: ZP();  op_cmp(cpu, cpu->y, RD(addr)); break;
+        case 0xCC: ABS(); op_cmp(cpu, cpu->y, RD(addr)); break;
 
         /* DEC - Decrement Memory */
-        case 0xC6: /* Zero Page */ {
-            uint8_t zp = ctx->read(ctx->userdata, cpu->pc++);
-            uint8_t value = ctx->read(ctx->userdata, zp) - 1;
-            ctx->write(ctx->userdata, zp, value);
-            cpu_set_nz(cpu, value);
-            cycles = 5;
-            break;
-        }
-        case 0xCE: { /* Absolute */
-            uint16_t addr = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint8_t value = ctx->read(ctx->userdata, addr) - 1;
-            ctx->write(ctx->userdata, addr, value);
-            cpu_set_nz(cpu, value);
-            cycles = 6;
-            break;
-        }
-        case 0xDE: { /* Absolute,X */
-            uint16_t base = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint16_t addr = base + cpu->x;
-            uint8_t value = ctx->read(ctx->userdata, addr) - 1;
-            ctx->write(ctx->userdata, addr, value);
-            cpu_set_nz(cpu, value);
-            cycles = 7;
-            break;
-        }
+        case 0xC6: ZP();   { uint8_t old = RD(addr), v = (uint8_t)(old - 1); MODIFY(addr, old, v); cpu_set_nz(cpu, v); } break;
+        case 0xD6: ZPX();  { uint8_t old = RD(addr), v = (uint8_t)(old - 1); MODIFY(addr, old, v); cpu_set_nz(cpu, v); } break;
+        case 0xCE: ABS();  { uint8_t old = RD(addr), v = (uint8_t)(old - 1); MODIFY(addr, old, v); cpu_set_nz(cpu, v); } break;
+        case 0xDE: ABSX(); { uint8_t old = RD(addr), v = (uint8_t)(old - 1); MODIFY(addr, old, v); cpu_set_nz(cpu, v); } break;
 
-        /* DEX - Decrement X */
-        case 0xCA:
-            cpu->x--;
-            cpu_set_nz(cpu, cpu->x);
-            break;
+        /* DEX / DEY / INX / INY */
+        case 0xCA: cpu->x--; cpu_set_nz(cpu, cpu->x); break;
+        case 0x88: cpu->y--; cpu_set_nz(cpu, cpu->y); break;
+        case 0xE8: cpu->x++; cpu_set_nz(cpu, cpu->x); break;
+        case 0xC8: cpu->y++; cpu_set_nz(cpu, cpu->y); break;
 
-        /* DEY - Decrement Y */
-        case 0x88:
-            cpu->y--;
-            cpu_set_nz(cpu, cpu->y);
-            break;
+        /* EOR - Exclusive OR */
+        case 0x49: cpu->a ^= FETCH(); cpu_set_nz(cpu, cpu->a); break;
+        case 0x45: ZP();     cpu->a ^= RD(addr); cpu_set_nz(cpu, cpu->a); break;
+        case 0x55: ZPX();    cpu->a ^= RD(addr); cpu_set_nz(cpu, cpu->a); break;
+        case 0x4D: ABS();    cpu->a ^= RD(addr); cpu_set_nz(cpu, cpu->a); break;
+        case 0x5D: ABSX_R(); cpu->a ^= RD(addr); cpu_set_nz(cpu, cpu->a); break;
+        case 0x59: ABSY_R(); cpu->a ^= RD(addr); cpu_set_nz(cpu, cpu->a); break;
+        case 0x41: IZX();    cpu->a ^= RD(addr); cpu_set_nz(cpu, cpu->a); break;
+        case 0x51: IZY_R();  cpu->a ^= RD(addr); cpu_set_nz(cpu, cpu->a); break;
 
         /* INC - Increment Memory */
-        case 0xE6: /* Zero Page */ {
-            uint8_t zp = ctx->read(ctx->userdata, cpu->pc++);
-            uint8_t value = ctx->read(ctx->userdata, zp) + 1;
-            ctx->write(ctx->userdata, zp, value);
-            cpu_set_nz(cpu, value);
-            cycles = 5;
-            break;
-        }
-        case 0xEE: { /* Absolute */
-            uint16_t addr = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint8_t value = ctx->read(ctx->userdata, addr) + 1;
-            ctx->write(ctx->userdata, addr, value);
-            cpu_set_nz(cpu, value);
-            cycles = 6;
-            break;
-        }
-        case 0xFE: { /* Absolute,X */
-            uint16_t base = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint16_t addr = base + cpu->x;
-            uint8_t value = ctx->read(ctx->userdata, addr) + 1;
-            ctx->write(ctx->userdata, addr, value);
-            cpu_set_nz(cpu, value);
-            cycles = 7;
-            break;
-        }
-
-        /* INX - Increment X */
-        case 0xE8:
-            cpu->x++;
-            cpu_set_nz(cpu, cpu->x);
-            break;
-
-        /* INY - Increment Y */
-        case 0xC8:
-            cpu->y++;
-            cpu_set_nz(cpu, cpu->y);
-            break;
+        case 0xE6: ZP();   { uint8_t old = RD(addr), v = (uint8_t)(old + 1); MODIFY(addr, old, v); cpu_set_nz(cpu, v); } break;
+        case 0xF6: ZPX();  { uint8_t old = RD(addr), v = (uint8_t)(old + 1); MODIFY(addr, old, v); cpu_set_nz(cpu, v); } break;
+        case 0xEE: ABS();  { uint8_t old = RD(addr), v = (uint8_t)(old + 1); MODIFY(addr, old, v); cpu_set_nz(cpu, v); } break;
+        case 0xFE: ABSX(); { uint8_t old = RD(addr), v = (uint8_t)(old + 1); MODIFY(addr, old, v); cpu_set_nz(cpu, v); } break;
 
         /* JMP - Jump */
-        case 0x4C: { /* Absolute */
-            uint16_t addr = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            cpu->pc = addr;
-            cycles = 3;
-            break;
-        }
-        case 0x6C: { /* Indirect */
-            uint16_t ptr = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            /* Handle 6502 page boundary bug */
-            uint16_t addr;
-            if ((ptr & 0xFF) == 0xFF) {
-                addr = ctx->read(ctx->userdata, ptr) | (ctx->read(ctx->userdata, ptr & 0xFF00) << 8);
-            } else {
-                addr = ctx->read(ctx->userdata, ptr) | (ctx->read(ctx->userdata, ptr + 1) << 8);
-            }
-            cpu->pc = addr;
-            cycles = 5;
+        case 0x4C: addr = FETCH16(); cpu->pc = addr; break;
+        case 0x6C: {
+            /* Indirect, with the 6502 page boundary bug */
+            uint16_t ptr = FETCH16();
+            uint16_t hi = (uint16_t)((ptr & 0xFF00) | ((ptr + 1) & 0x00FF));
+            cpu->pc = (uint16_t)(RD(ptr) | (RD(hi) << 8));
             break;
         }
 
         /* JSR - Jump to Subroutine */
         case 0x20: {
-            uint16_t addr = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint16_t ret_addr = cpu->pc - 1;
-            cpu_push(ctx, (ret_addr >> 8) & 0xFF);
-            cpu_push(ctx, ret_addr & 0xFF);
-            cpu->pc = addr;
-            cycles = 6;
+            uint16_t target = FETCH16();
+            uint16_t ret_addr = (uint16_t)(cpu->pc - 1);
+            PUSH(ret_addr >> 8);
+            PUSH(ret_addr & 0xFF);
+            cpu->pc = target;
             break;
         }
 
         /* LDA - Load Accumulator */
-        case 0xA5: /* Zero Page */
-            cpu->a = ctx->read(ctx->userdata, ctx->read(ctx->userdata, cpu->pc++));
-            cpu_set_nz(cpu, cpu->a);
-            cycles = 3;
-            break;
-        case 0xA9: /* Immediate */
-            cpu->a = ctx->read(ctx->userdata, cpu->pc++);
-            cpu_set_nz(cpu, cpu->a);
-            break;
-        case 0xAD: { /* Absolute */
-            uint16_t addr = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            cpu->a = ctx->read(ctx->userdata, addr);
-            cpu_set_nz(cpu, cpu->a);
-            cycles = 4;
-            break;
-        }
-        case 0xB9: { /* Absolute,Y */
-            uint16_t base = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint16_t addr = base + cpu->y;
-            cpu->a = ctx->read(ctx->userdata, addr);
-            cpu_set_nz(cpu, cpu->a);
-            cycles = 4;
-            break;
-        }
-        case 0xB1: { /* (Indirect),Y */
-            uint8_t zp = ctx->read(ctx->userdata, cpu->pc++);
-            uint16_t base = ctx->read(ctx->userdata, zp) | (ctx->read(ctx->userdata, (zp + 1) & 0xFF) << 8);
-            uint16_t addr = base + cpu->y;
-            cpu->a = ctx->read(ctx->userdata, addr);
-            cpu_set_nz(cpu, cpu->a);
-            cycles = 5;
-            break;
-        }
-        case 0xBD: { /* Absolute,X */
-            uint16_t base = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint16_t addr = base + cpu->x;
-            cpu->a = ctx->read(ctx->userdata, addr);
-            cpu_set_nz(cpu, cpu->a);
-            cycles = 4;
-            break;
-        }
+        case 0xA9: cpu->a = FETCH(); cpu_set_nz(cpu, cpu->a); break;
+        case 0xA5: ZP();     cpu->a = RD(addr); cpu_set_nz(cpu, cpu->a); break;
+        case 0xB5: ZPX();    cpu->a = RD(addr); cpu_set_nz(cpu, cpu->a); break;
+        case 0xAD: ABS();    cpu->a = RD(addr); cpu_set_nz(cpu, cpu->a); break;
+        case 0xBD: ABSX_R(); cpu->a = RD(addr); cpu_set_nz(cpu, cpu->a); break;
+        case 0xB9: ABSY_R(); cpu->a = RD(addr); cpu_set_nz(cpu, cpu->a); break;
+        case 0xA1: IZX();    cpu->a = RD(addr); cpu_set_nz(cpu, cpu->a); break;
+        case 0xB1: IZY_R();  cpu->a = RD(addr); cpu_set_nz(cpu, cpu->a); break;
 
         /* LDX - Load X */
-        case 0xA2: /* Immediate */
-            cpu->x = ctx->read(ctx->userdata, cpu->pc++);
-            cpu_set_nz(cpu, cpu->x);
-            break;
-        case 0xA6: /* Zero Page */
-            cpu->x = ctx->read(ctx->userdata, ctx->read(ctx->userdata, cpu->pc++));
-            cpu_set_nz(cpu, cpu->x);
-            cycles = 3;
-            break;
-        case 0xAE: { /* Absolute */
-            uint16_t addr = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            cpu->x = ctx->read(ctx->userdata, addr);
-            cpu_set_nz(cpu, cpu->x);
-            cycles = 4;
-            break;
-        }
-        case 0xBE: { /* Absolute,Y */
-            uint16_t base = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint16_t addr = base + cpu->y;
-            cpu->x = ctx->read(ctx->userdata, addr);
-            cpu_set_nz(cpu, cpu->x);
-            cycles = 4;
-            break;
-        }
+        case 0xA2: cpu->x = FETCH(); cpu_set_nz(cpu, cpu->x); break;
+        case 0xA6: ZP();     cpu->x = RD(addr); cpu_set_nz(cpu, cpu->x); break;
+        case 0xB6: ZPY();    cpu->x = RD(addr); cpu_set_nz(cpu, cpu->x); break;
+        case 0xAE: ABS();    cpu->x = RD(addr); cpu_set_nz(cpu, cpu->x); break;
+        case 0xBE: ABSY_R(); cpu->x = RD(addr); cpu_set_nz(cpu, cpu->x); break;
 
         /* LDY - Load Y */
-        case 0xA0: /* Immediate */
-            cpu->y = ctx->read(ctx->userdata, cpu->pc++);
-            cpu_set_nz(cpu, cpu->y);
-            break;
-        case 0xA4: /* Zero Page */
-            cpu->y = ctx->read(ctx->userdata, ctx->read(ctx->userdata, cpu->pc++));
-            cpu_set_nz(cpu, cpu->y);
-            cycles = 3;
-            break;
-        case 0xAC: { /* Absolute */
-            uint16_t addr = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            cpu->y = ctx->read(ctx->userdata, addr);
-            cpu_set_nz(cpu, cpu->y);
-            cycles = 4;
-            break;
-        }
-        case 0xBC: { /* Absolute,X */
-            uint16_t base = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint16_t addr = base + cpu->x;
-            cpu->y = ctx->read(ctx->userdata, addr);
-            cpu_set_nz(cpu, cpu->y);
-            cycles = 4;
-            break;
-        }
+        case 0xA0: cpu->y = FETCH(); cpu_set_nz(cpu, cpu->y); break;
+        case 0xA4: ZP();     cpu->y = RD(addr); cpu_set_nz(cpu, cpu->y); break;
+        case 0xB4: ZPX();    cpu->y = RD(addr); cpu_set_nz(cpu, cpu->y); break;
+        case 0xAC: ABS();    cpu->y = RD(addr); cpu_set_nz(cpu, cpu->y); break;
+        case 0xBC: ABSX_R(); cpu->y = RD(addr); cpu_set_nz(cpu, cpu->y); break;
 
         /* LSR - Logical Shift Right */
-        case 0x4A: /* Accumulator */
-            cpu->flag_c = cpu->a & 0x01;
-            cpu->a >>= 1;
-            cpu_set_nz(cpu, cpu->a);
-            break;
-
-        /* NOP - No Operation */
-        case 0xEA:
-            break;
-
-        /* ORA - Logical OR */
-        case 0x05: /* Zero Page */
-            cpu->a |= ctx->read(ctx->userdata, ctx->read(ctx->userdata, cpu->pc++));
-            cpu_set_nz(cpu, cpu->a);
-            cycles = 3;
-            break;
-        case 0x09: { /* Immediate */
-            uint8_t value = ctx->read(ctx->userdata, cpu->pc++);
-            cpu->a |= value;
-            cpu_set_nz(cpu, cpu->a);
-            break;
-        }
-        case 0x0D: { /* Absolute */
-            uint16_t addr = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            cpu->a |= ctx->read(ctx->userdata, addr);
-            cpu_set_nz(cpu, cpu->a);
-            cycles = 4;
-            break;
-        }
-        case 0x11: { /* (Indirect),Y */
-            uint8_t zp = ctx->read(ctx->userdata, cpu->pc++);
-            uint16_t base = ctx->read(ctx->userdata, zp) | (ctx->read(ctx->userdata, (zp + 1) & 0xFF) << 8);
-            uint16_t addr = base + cpu->y;
-            cpu->a |= ctx->read(ctx->userdata, addr);
-            cpu_set_nz(cpu, cpu->a);
-            cycles = 5;
-            break;
-        }
-        case 0x19: { /* Absolute,Y */
-            uint16_t base = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint16_t addr = base + cpu->y;
-            cpu->a |= ctx->read(ctx->userdata, addr);
-            cpu_set_nz(cpu, cpu->a);
-            cycles = 4;
-            break;
-        }
-
-        /* PHA - Push Accumulator */
-        case 0x48:
-            cpu_push(ctx, cpu->a);
-            cycles = 3;
-            break;
-
-        /* PLA - Pull Accumulator */
-        case 0x68:
-            cpu->a = cpu_pull(ctx);
-            cpu_set_nz(cpu, cpu->a);
-            cycles = 4;
-            break;
+        case 0x4A: cpu->a = op_lsr(cpu, cpu->a); break;
+        case 0x46: ZP();   RMW(op_lsr); break;
+        case 0x56: ZPX();  RMW(op_lsr); break;
+        case 0x4E: ABS();  RMW(op_lsr); break;
+        case 0x5E: ABSX(); RMW(op_lsr); break;
+
+        /* NOP */
+        case 0xEA: break;
+
+        /* ORA - Logical Inclusive OR */
+        case 0x09: cpu->a |= FETCH(); cpu_set_nz(cpu, cpu->a); break;
+        case 0x05: ZP();     cpu->a |= RD(addr); cpu_set_nz(cpu, cpu->a); break;
+        case 0x15: ZPX();    cpu->a |= RD(addr); cpu_set_nz(cpu, cpu->a); break;
+        case 0x0D: ABS();    cpu->a |= RD(addr); cpu_set_nz(cpu, cpu->a); break;
+        case 0x1D: ABSX_R(); cpu->a |= RD(addr); cpu_set_nz(cpu, cpu->a); break;
+        case 0x19: ABSY_R(); cpu->a |= RD(addr); cpu_set_nz(cpu, cpu->a); break;
+        case 0x01: IZX();    cpu->a |= RD(addr); cpu_set_nz(cpu, cpu->a); break;
+        case 0x11: IZY_R();  cpu->a |= RD(addr); cpu_set_nz(cpu, cpu->a); break;
+
+        /* Stack */
+        case 0x48: PUSH(cpu->a); break;                                  /* PHA */
+        case 0x08: PUSH(pack_flags(cpu, true)); break;                   /* PHP */
+        case 0x68: cpu->a = PULL(); cpu_set_nz(cpu, cpu->a); break;        /* PLA */
+        case 0x28: unpack_flags(cpu, PULL()); break;                       /* PLP */
+
+        /* ROL / ROR - Rotate */
+        case 0x2A: cpu->a = op_rol(cpu, cpu->a); break;
+        case 0x26: ZP();   RMW(op_rol); break;
+        case 0x36: ZPX();  RMW(op_rol); break;
+        case 0x2E: ABS();  RMW(op_rol); break;
+        case 0x3E: ABSX(); RMW(op_rol); break;
+        case 0x6A: cpu->a = op_ror(cpu, cpu->a); break;
+        case 0x66: ZP();   RMW(op_ror); break;
+        case 0x76: ZPX();  RMW(op_ror); break;
+        case 0x6E: ABS();  RMW(op_ror); break;
+        case 0x7E: ABSX(); RMW(op_ror); break;
 
         /* RTI - Return from Interrupt */
-        case 0x40:
-            cpu->p = cpu_pull(ctx);
-            cpu->pc = cpu_pull(ctx) | (cpu_pull(ctx) << 8);
-            cycles = 6;
-            break;
-
-        /* ROR - Rotate Right */
-        case 0x6A: { /* Accumulator */
-            uint8_t old_carry = cpu->flag_c;
-            cpu->flag_c = cpu->a & 0x01;
-            cpu->a = (cpu->a >> 1) | (old_carry << 7);
-            cpu_set_nz(cpu, cpu->a);
-            break;
-        }
-        case 0x66: { /* Zero Page */
-            uint8_t zp = ctx->read(ctx->userdata, cpu->pc++);
-            uint8_t value = ctx->read(ctx->userdata, zp);
-            uint8_t old_carry = cpu->flag_c;
-            cpu->flag_c = value & 0x01;
-            value = (value >> 1) | (old_carry << 7);
-            ctx->write(ctx->userdata, zp, value);
-            cpu_set_nz(cpu, value);
-            cycles = 5;
-            break;
-        }
-        case 0x6E: { /* Absolute */
-            uint16_t addr = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint8_t value = ctx->read(ctx->userdata, addr);
-            uint8_t old_carry = cpu->flag_c;
-            cpu->flag_c = value & 0x01;
-            value = (value >> 1) | (old_carry << 7);
-            ctx->write(ctx->userdata, addr, value);
-            cpu_set_nz(cpu, value);
-            cycles = 6;
-            break;
-        }
-        case 0x7E: { /* Absolute,X */
-            uint16_t base = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint16_t addr = base + cpu->x;
-            uint8_t value = ctx->read(ctx->userdata, addr);
-            uint8_t old_carry = cpu->flag_c;
-            cpu->flag_c = value & 0x01;
-            value = (value >> 1) | (old_carry << 7);
-            ctx->write(ctx->userdata, addr, value);
-            cpu_set_nz(cpu, value);
-            cycles = 7;
-            break;
-        }
-
-        /* ROL - Rotate Left */
-        case 0x2A: { /* Accumulator */
-            uint8_t old_carry = cpu->flag_c;
-            cpu->flag_c = (cpu->a & 0x80) != 0;
-            cpu->a = (cpu->a << 1) | old_carry;
-            cpu_set_nz(cpu, cpu->a);
-            break;
-        }
-        case 0x26: { /* Zero Page */
-            uint8_t zp = ctx->read(ctx->userdata, cpu->pc++);
-            uint8_t value = ctx->read(ctx->userdata, zp);
-            uint8_t old_carry = cpu->flag_c;
-            cpu->flag_c = (value & 0x80) != 0;
-            value = (value << 1) | old_carry;
-            ctx->write(ctx->userdata, zp, value);
-            cpu_set_nz(cpu, value);
-            cycles = 5;
-            break;
-        }
-        case 0x2E: { /* Absolute */
-            uint16_t addr = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint8_t value = ctx->read(ctx->userdata, addr);
-            uint8_t old_carry = cpu->flag_c;
-            cpu->flag_c = (value & 0x80) != 0;
-            value = (value << 1) | old_carry;
-            ctx->write(ctx->userdata, addr, value);
-            cpu_set_nz(cpu, value);
-            cycles = 6;
-            break;
-        }
-        case 0x36: { /* Zero Page,X */
-            uint8_t zp = (ctx->read(ctx->userdata, cpu->pc++) + cpu->x) & 0xFF;
-            uint8_t value = ctx->read(ctx->userdata, zp);
-            uint8_t old_carry = cpu->flag_c;
-            cpu->flag_c = (value & 0x80) != 0;
-            value = (value << 1) | old_carry;
-            ctx->write(ctx->userdata, zp, value);
-            cpu_set_nz(cpu, value);
-            cycles = 6;
-            break;
-        }
-        case 0x3E: { /* Absolute,X */
-            uint16_t base = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint16_t addr = base + cpu->x;
-            uint8_t value = ctx->read(ctx->userdata, addr);
-            uint8_t old_carry = cpu->flag_c;
-            cpu->flag_c = (value & 0x80) != 0;
-            value = (value << 1) | old_carry;
-            ctx->write(ctx->userdata, addr, value);
-            cpu_set_nz(cpu, value);
-            cycles = 7;
+        case 0x40: {
+            unpack_flags(cpu, PULL());
+            uint8_t lo = PULL();
+            cpu->pc = (uint16_t)(lo | (PULL() << 8));
             break;
         }
 
         /* RTS - Return from Subroutine */
-        case 0x60:
-            cpu->pc = (cpu_pull(ctx) | (cpu_pull(ctx) << 8)) + 1;
-            cycles = 6;
-            break;
-
-        /* SBC - Subtract with Carry */
-        case 0xE5: { /* Zero Page */
-            uint8_t value = ctx->read(ctx->userdata, ctx->read(ctx->userdata, cpu->pc++));
-            uint16_t result = cpu->a - value - (1 - cpu->flag_c);
-            cpu->flag_c = result < 0x100;
-            cpu->flag_v = ((cpu->a ^ value) & (cpu->a ^ result) & 0x80) != 0;
-            cpu->a = result & 0xFF;
-            cpu_set_nz(cpu, cpu->a);
-            cycles = 3;
-            break;
-        }
-        case 0xE9: { /* Immediate */
-            uint8_t value = ctx->read(ctx->userdata, cpu->pc++);
-            uint16_t result = cpu->a - value - (1 - cpu->flag_c);
-            cpu->flag_c = result < 0x100;
-            cpu->flag_v = ((cpu->a ^ value) & (cpu->a ^ result) & 0x80) != 0;
-            cpu->a = result & 0xFF;
-            cpu_set_nz(cpu, cpu->a);
-            break;
-        }
-        case 0xED: { /* Absolute */
-            uint16_t addr = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint8_t value = ctx->read(ctx->userdata, addr);
-            uint16_t result = cpu->a - value - (1 - cpu->flag_c);
-            cpu->flag_c = result < 0x100;
-            cpu->flag_v = ((cpu->a ^ value) & (cpu->a ^ result) & 0x80) != 0;
-            cpu->a = result & 0xFF;
-            cpu_set_nz(cpu, cpu->a);
-            cycles = 4;
-            break;
-        }
-        case 0xF9: { /* Absolute,Y */
-            uint16_t base = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint16_t addr = base + cpu->y;
-            uint8_t value = ctx->read(ctx->userdata, addr);
-            uint16_t result = cpu->a - value - (1 - cpu->flag_c);
-            cpu->flag_c = result < 0x100;
-            cpu->flag_v = ((cpu->a ^ value) & (cpu->a ^ result) & 0x80) != 0;
-            cpu->a = result & 0xFF;
-            cpu_set_nz(cpu, cpu->a);
-            cycles = 4;
-            break;
-        }
-        case 0xF1: { /* (Indirect),Y */
-            uint8_t zp = ctx->read(ctx->userdata, cpu->pc++);
-            uint16_t base = ctx->read(ctx->userdata, zp) | (ctx->read(ctx->userdata, (zp + 1) & 0xFF) << 8);
-            uint16_t addr = base + cpu->y;
-            uint8_t value = ctx->read(ctx->userdata, addr);
-            uint16_t result = cpu->a - value - (1 - cpu->flag_c);
-            cpu->flag_c = result < 0x100;
-            cpu->flag_v = ((cpu->a ^ value) & (cpu->a ^ result) & 0x80) != 0;
-            cpu->a = result & 0xFF;
-            cpu_set_nz(cpu, cpu->a);
-            cycles = 5;
-            break;
-        }
-        case 0xFD: { /* Absolute,X */
-            uint16_t base = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint16_t addr = base + cpu->x;
-            uint8_t value = ctx->read(ctx->userdata, addr);
-            uint16_t result = cpu->a - value - (1 - cpu->flag_c);
-            cpu->flag_c = result < 0x100;
-            cpu->flag_v = ((cpu->a ^ value) & (cpu->a ^ result) & 0x80) != 0;
-            cpu->a = result & 0xFF;
-            cpu_set_nz(cpu, cpu->a);
-            cycles = 4;
+        case 0x60: {
+            uint8_t lo = PULL();
+            cpu->pc = (uint16_t)((lo | (PULL() << 8)) + 1);
             break;
         }
 
-        /* SEC - Set Carry */
-        case 0x38:
-            cpu->flag_c = 1;
-            break;
-
-        /* SED - Set Decimal */
-        case 0xF8:
-            cpu->flag_d = 1;
-            break;
-
-        /* SEI - Set Interrupt Disable */
-        case 0x78:
-            cpu->flag_i = 1;
-            break;
+        /* SBC - Subtract with Carry (0xEB is the undocumented twin) */
+        case 0xE9: case 0xEB: op_sbc(cpu, FETCH()); break;
+        case 0xE5: ZP();     op_sbc(cpu, RD(addr)); break;
+        case 0xF5: ZPX();    op_sbc(cpu, RD(addr)); break;
+        case 0xED: ABS();    op_sbc(cpu, RD(addr)); break;
+        case 0xFD: ABSX_R(); op_sbc(cpu, RD(addr)); break;
+        case 0xF9: ABSY_R(); op_sbc(cpu, RD(addr)); break;
+        case 0xE1: IZX();    op_sbc(cpu, RD(addr)); break;
+        case 0xF1: IZY_R();  op_sbc(cpu, RD(addr)); break;
 
         /* STA - Store Accumulator */
-        case 0x85: /* Zero Page */
-            ctx->write(ctx->userdata, ctx->read(ctx->userdata, cpu->pc++), cpu->a);
-            cycles = 3;
-            break;
-        case 0x95: /* Zero Page,X */
-            ctx->write(ctx->userdata, (ctx->read(ctx->userdata, cpu->pc++) + cpu->x) & 0xFF, cpu->a);
-            cycles = 4;
-            break;
-        case 0x8D: { /* Absolute */
-            uint16_t addr = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            ctx->write(ctx->userdata, addr, cpu->a);
-            cycles = 4;
-            break;
-        }
-        case 0x91: { /* (Indirect),Y */
-            uint8_t zp = ctx->read(ctx->userdata, cpu->pc++);
-            uint16_t base = ctx->read(ctx->userdata, zp) | (ctx->read(ctx->userdata, (zp + 1) & 0xFF) << 8);
-            uint16_t addr = base + cpu->y;
-            ctx->write(ctx->userdata, addr, cpu->a);
-            cycles = 6;
-            break;
-        }
-        case 0x99: { /* Absolute,Y */
-            uint16_t base = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint16_t addr = base + cpu->y;
-            ctx->write(ctx->userdata, addr, cpu->a);
-            cycles = 5;
+        case 0x85: ZP();   WR(addr, cpu->a); break;
+        case 0x95: ZPX();  WR(addr, cpu->a); break;
+        case 0x8D: ABS();  WR(addr, cpu->a); break;
+        case 0x9D: ABSX(); WR(addr, cpu->a); break;
+        case 0x99: ABSY(); WR(addr, cpu->a); break;
+        case 0x81: IZX();  WR(addr, cpu->a); break;
+        case 0x91: IZY();  WR(addr, cpu->a); break;
+
+        /* STX / STY - Store X / Y */
+        case 0x86: ZP();  WR(addr, cpu->x); break;
+        case 0x96: ZPY(); WR(addr, cpu->x); break;
+        case 0x8E: ABS(); WR(addr, cpu->x); break;
+        case 0x84: ZP();  WR(addr, cpu->y); break;
+        case 0x94: ZPX(); WR(addr, cpu->y); break;
+        case 0x8C: ABS(); WR(addr, cpu->y); break;
+
+        /* Transfers */
+        case 0xAA: cpu->x = cpu->a; cpu_set_nz(cpu, cpu->x); break;   /* TAX */
+        case 0xA8: cpu->y = cpu->a; cpu_set_nz(cpu, cpu->y); break;   /* TAY */
+        case 0xBA: cpu->x = cpu->sp; cpu_set_nz(cpu, cpu->x); break;  /* TSX */
+        case 0x8A: cpu->a = cpu->x; cpu_set_nz(cpu, cpu->a); break;   /* TXA */
+        case 0x9A: cpu->sp = cpu->x; break;                           /* TXS */
+        case 0x98: cpu->a = cpu->y; cpu_set_nz(cpu, cpu->a); break;   /* TYA */
+
+        /* ===== Undocumented opcodes (stable ones used by players) ===== */
+
+        /* NOPs with operands */
+        case 0x1A: case 0x3A: case 0x5A: case 0x7A: case 0xDA: case 0xFA:
+            break;
+        case 0x80: case 0x82: case 0x89: case 0xC2: case 0xE2:
+            cpu->pc++;
+            break;
+        case 0x04: case 0x44: case 0x64: ZP(); (void)RD(addr); break;
+        case 0x14: case 0x34: case 0x54: case 0x74: case 0xD4: case 0xF4: ZPX(); (void)RD(addr); break;
+        case 0x0C: ABS(); (void)RD(addr); break;
+        case 0x1C: case 0x3C: case 0x5C: case 0x7C: case 0xDC: case 0xFC: ABSX_R(); (void)RD(addr); break;
+
+        /* LAX - LDA + LDX */
+        case 0xA7: ZP();    cpu->a = cpu->x = RD(addr); cpu_set_nz(cpu, cpu->a); break;
+        case 0xB7: ZPY();   cpu->a = cpu->x = RD(addr); cpu_set_nz(cpu, cpu->a); break;
+        case 0xAF: ABS();   cpu->a = cpu->x = RD(addr); cpu_set_nz(cpu, cpu->a); break;
+        case 0xBF: ABSY_R(); cpu->a = cpu->x = RD(addr); cpu_set_nz(cpu, cpu->a); break;
+        case 0xA3: IZX();   cpu->a = cpu->x = RD(addr); cpu_set_nz(cpu, cpu->a); break;
+        case 0xB3: IZY_R(); cpu->a = cpu->x = RD(addr); cpu_set_nz(cpu, cpu->a); break;
+        case 0xAB: cpu->a = cpu->x = (uint8_t)((cpu->a | 0xEE) & FETCH()); cpu_set_nz(cpu, cpu->a); break;
+
+        /* SAX - store A & X */
+        case 0x87: ZP();  WR(addr, cpu->a & cpu->x); break;
+        case 0x97: ZPY(); WR(addr, cpu->a & cpu->x); break;
+        case 0x8F: ABS(); WR(addr, cpu->a & cpu->x); break;
+        case 0x83: IZX(); WR(addr, cpu->a & cpu->x); break;
+
+        /* SLO - ASL + ORA */
+        case 0x07: ZP();   goto slo;
+        case 0x17: ZPX();  goto slo;
+        case 0x0F: ABS();  goto slo;
+        case 0x1F: ABSX(); goto slo;
+        case 0x1B: ABSY(); goto slo;
+        case 0x03: IZX();  goto slo;
+        case 0x13: IZY();
+        slo: {
+            uint8_t old = RD(addr), v = op_asl(cpu, old);
+            MODIFY(addr, old, v);
+            cpu->a |= v;
+            cpu_set_nz(cpu, cpu->a);
+            break;
+        }
+
+        /* RLA - ROL + AND */
+        case 0x27: ZP();   goto rla;
+        case 0x37: ZPX();  goto rla;
+        case 0x2F: ABS();  goto rla;
+        case 0x3F: ABSX(); goto rla;
+        case 0x3B: ABSY(); goto rla;
+        case 0x23: IZX();  goto rla;
+        case 0x33: IZY();
+        rla: {
+            uint8_t old = RD(addr), v = op_rol(cpu, old);
+            MODIFY(addr, old, v);
+            cpu->a &= v;
+            cpu_set_nz(cpu, cpu->a);
+            break;
+        }
+
+        /* SRE - LSR + EOR */
+        case 0x47: ZP();   goto sre;
+        case 0x57: ZPX();  goto sre;
+        case 0x4F: ABS();  goto sre;
+        case 0x5F: ABSX(); goto sre;
+        case 0x5B: ABSY(); goto sre;
+        case 0x43: IZX();  goto sre;
+        case 0x53: IZY();
+        sre: {
+            uint8_t old = RD(addr), v = op_lsr(cpu, old);
+            MODIFY(addr, old, v);
+            cpu->a ^= v;
+            cpu_set_nz(cpu, cpu->a);
+            break;
+        }
+
+        /* RRA - ROR + ADC */
+        case 0x67: ZP();   goto rra;
+        case 0x77: ZPX();  goto rra;
+        case 0x6F: ABS();  goto rra;
+        case 0x7F: ABSX(); goto rra;
+        case 0x7B: ABSY(); goto rra;
+        case 0x63: IZX();  goto rra;
+        case 0x73: IZY();
+        rra: {
+            uint8_t old = RD(addr), v = op_ror(cpu, old);
+            MODIFY(addr, old, v);
+            op_adc(cpu, v);
+            break;
+        }
+
+        /* DCP - DEC + CMP */
+        case 0xC7: ZP();   goto dcp;
+        case 0xD7: ZPX();  goto dcp;
+        case 0xCF: ABS();  goto dcp;
+        case 0xDF: ABSX(); goto dcp;
+        case 0xDB: ABSY(); goto dcp;
+        case 0xC3: IZX();  goto dcp;
+        case 0xD3: IZY();
+        dcp: {
+            uint8_t old = RD(addr), v = (uint8_t)(old - 1);
+            MODIFY(addr, old, v);
+            op_cmp(cpu, cpu->a, v);
+            break;
+        }
+
+        /* ISC - INC + SBC */
+        case 0xE7: ZP();   goto isc;
+        case 0xF7: ZPX();  goto isc;
+        case 0xEF: ABS();  goto isc;
+        case 0xFF: ABSX(); goto isc;
+        case 0xFB: ABSY(); goto isc;
+        case 0xE3: IZX();  goto isc;
+        case 0xF3: IZY();
+        isc: {
+            uint8_t old = RD(addr), v = (uint8_t)(old + 1);
+            MODIFY(addr, old, v);
+            op_sbc(cpu, v);
+            break;
+        }
+
+        /* Immediate combinations */
+        case 0x0B: case 0x2B:  /* ANC */
+            cpu->a &= FETCH();
+            cpu_set_nz(cpu, cpu->a);
+            cpu->flag_c = cpu->flag_n;
+            break;
+        case 0x4B:  /* ALR */
+            cpu->a = op_lsr(cpu, cpu->a & FETCH());
+            break;
+        case 0x6B: {  /* ARR */
+            cpu->a = (uint8_t)(((cpu->a & FETCH()) >> 1) | (cpu->flag_c << 7));
+            cpu_set_nz(cpu, cpu->a);
+            cpu->flag_c = (cpu->a >> 6) & 1;
+            cpu->flag_v = ((cpu->a >> 6) ^ (cpu->a >> 5)) & 1;
             break;
         }
-        case 0x9D: { /* Absolute,X */
-            uint16_t base = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint16_t addr = base + cpu->x;
-            ctx->write(ctx->userdata, addr, cpu->a);
-            cycles = 5;
+        case 0xCB: {  /* SBX: X = (A & X) - imm */
+            uint8_t v = FETCH();
+            uint8_t ax = cpu->a & cpu->x;
+            cpu->flag_c = ax >= v;
+            cpu->x = (uint8_t)(ax - v);
+            cpu_set_nz(cpu, cpu->x);
             break;
         }
-
-        /* STX - Store X */
-        case 0x86: /* Zero Page */
-            ctx->write(ctx->userdata, ctx->read(ctx->userdata, cpu->pc++), cpu->x);
-            cycles = 3;
-            break;
-        case 0x8E: { /* Absolute */
-            uint16_t addr = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            ctx->write(ctx->userdata, addr, cpu->x);
-            cycles = 4;
+        case 0x8B:  /* XAA (unstable, common approximation) */
+            cpu->a = (uint8_t)((cpu->a | 0xEE) & cpu->x & FETCH());
+            cpu_set_nz(cpu, cpu->a);
             break;
-        }
 
-        /* STY - Store Y */
-        case 0x84: /* Zero Page */
-            ctx->write(ctx->userdata, ctx->read(ctx->userdata, cpu->pc++), cpu->y);
-            cycles = 3;
+        /* Stores ANDed with the address high byte + 1 */
+        case 0x9F: ABSY(); WR(addr, cpu->a & cpu->x & (uint8_t)((addr >> 8) + 1)); break;  /* SHA */
+        case 0x93: IZY();  WR(addr, cpu->a & cpu->x & (uint8_t)((addr >> 8) + 1)); break;  /* SHA */
+        case 0x9E: ABSY(); WR(addr, cpu->x & (uint8_t)((addr >> 8) + 1)); break;           /* SHX */
+        case 0x9C: ABSX(); WR(addr, cpu->y & (uint8_t)((addr >> 8) + 1)); break;           /* SHY */
+        case 0x9B:                                                                         /* TAS */
+            ABSY();
+            cpu->sp = cpu->a & cpu->x;
+            WR(addr, cpu->sp & (uint8_t)((addr >> 8) + 1));
             break;
-        case 0x8C: { /* Absolute */
-            uint16_t addr = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            ctx->write(ctx->userdata, addr, cpu->y);
-            cycles = 4;
+        case 0xBB:                                                                         /* LAS */
+            ABSY_R();
+            cpu->a = cpu->x = cpu->sp = RD(addr) & cpu->sp;
+            cpu_set_nz(cpu, cpu->a);
             break;
-        }
 
-        /* TAX - Transfer A to X */
-        case 0xAA:
-            cpu->x = cpu->a;
-            cpu_set_nz(cpu, cpu->x);
+        /* JAM/KIL - the CPU locks up */
+        default:
+            cpu->pc = pc_start;
+            ctx->jammed = true;
+            if (ctx->unknown_count < 20) {
+                fprintf(stderr, "CPU jammed by opcode $%02X at $%04X (A=%02X X=%02X Y=%02X)\n",
+                        opcode, pc_start, cpu->a, cpu->x, cpu->y);
+                ctx->unknown_count++;
+            }
             break;
+    }
 
-        /* TAY - Transfer A to Y */
-        case 0xA8:
-            cpu->y = cpu->a;
-            cpu_set_nz(cpu, cpu->y);
-            break;
+    /* Page-cross and branch penalties */
+    *clock += cycles - cycle_table[opcode];
 
-        /* TXA - Transfer X to A */
-        case 0x8A:
-            cpu->a = cpu->x;
-            cpu_set_nz(cpu, cpu->a);
-            break;
+    return cycles;
+}
 
-        /* TYA - Transfer Y to A */
-        case 0x98:
-            cpu->a = cpu->y;
-            cpu_set_nz(cpu, cpu->a);
-            break;
+int cpu_step(CPU6502Context* ctx) {
+    CPU6502 cpu = ctx->cpu;
+    uint64_t clock = ctx->cycles;
 
-        /* EOR - Exclusive OR */
-        case 0x49: /* Immediate */
-            cpu->a ^= ctx->read(ctx->userdata, cpu->pc++);
-            cpu_set_nz(cpu, cpu->a);
-            break;
+    int cycles = execute(ctx, &cpu, &clock);
 
-        /* LSR - Logical Shift Right */
-        case 0x4E: { /* Absolute */
-            uint16_t addr = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint8_t value = ctx->read(ctx->userdata, addr);
-            cpu->flag_c = value & 0x01;
-            value >>= 1;
-            ctx->write(ctx->userdata, addr, value);
-            cpu_set_nz(cpu, value);
-            cycles = 6;
-            break;
-        }
-        case 0x5E: { /* Absolute,X */
-            uint16_t base = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint16_t addr = base + cpu->x;
-            uint8_t value = ctx->read(ctx->userdata, addr);
-            cpu->flag_c = value & 0x01;
-            value >>= 1;
-            ctx->write(ctx->userdata, addr, value);
-            cpu_set_nz(cpu, value);
-            cycles = 7;
-            break;
-        }
+    ctx->cpu = cpu;
+    ctx->cycles = clock;
+    return cycles;
+}
 
-        /* Illegal/undocumented opcodes - implement as close approximations */
-        /* Many SID files use these! */
-
-        /* SLO (ASL + ORA) - (Indirect,X) */
-        case 0x03: {
-            uint8_t zp = (ctx->read(ctx->userdata, cpu->pc++) + cpu->x) & 0xFF;
-            uint16_t addr = ctx->read(ctx->userdata, zp) | (ctx->read(ctx->userdata, (zp + 1) & 0xFF) << 8);
-            uint8_t value = ctx->read(ctx->userdata, addr);
-            cpu->flag_c = (value & 0x80) != 0;
-            value <<= 1;
-            ctx->write(ctx->userdata, addr, value);
-            cpu->a |= value;
-            cpu_set_nz(cpu, cpu->a);
-            cycles = 8;
-            break;
-        }
+int cpu_run(CPU6502Context* ctx, int cycles) {
+    CPU6502 cpu = ctx->cpu;
+    uint64_t clock = ctx->cycles;
+    const uint64_t start = clock;
+    const uint64_t target = start + (uint64_t)(cycles > 0 ? cycles : 0);
+    const int32_t trap = ctx->trap_pc;
 
-        /* RLA (ROL + AND) - Zero Page,X */
-        case 0x37: {
-            uint8_t zp = (ctx->read(ctx->userdata, cpu->pc++) + cpu->x) & 0xFF;
-            uint8_t value = ctx->read(ctx->userdata, zp);
-            uint8_t old_carry = cpu->flag_c;
-            cpu->flag_c = (value & 0x80) != 0;
-            value = (value << 1) | old_carry;
-            ctx->write(ctx->userdata, zp, value);
-            cpu->a &= value;
-            cpu_set_nz(cpu, cpu->a);
-            cycles = 6;
-            break;
-        }
+    while (clock < target && !ctx->jammed) {
+        execute(ctx, &cpu, &clock);
+        if ((int32_t)cpu.pc == trap) break;
+    }
 
-        /* SRE (LSR + EOR) - (Indirect),Y */
-        case 0x53: {
-            uint8_t zp = ctx->read(ctx->userdata, cpu->pc++);
-            uint16_t base = ctx->read(ctx->userdata, zp) | (ctx->read(ctx->userdata, (zp + 1) & 0xFF) << 8);
-            uint16_t addr = base + cpu->y;
-            uint8_t value = ctx->read(ctx->userdata, addr);
-            cpu->flag_c = value & 0x01;
-            value >>= 1;
-            ctx->write(ctx->userdata, addr, value);
-            cpu->a ^= value;
-            cpu_set_nz(cpu, cpu->a);
-            cycles = 8;
-            break;
-        }
+    ctx->cpu = cpu;
+    ctx->cycles = clock;
+    return (int)(clock - start);
+}
 
-        /* DEC Accumulator (illegal NOP) */
-        case 0x3A:
-            /* On real 6502, this is a NOP */
-            cycles = 2;
-            break;
+/* Push PC and status, then jump through an interrupt vector */
+static void interrupt(CPU6502Context* ctx, uint16_t vector) {
+    CPU6502* cpu = &ctx->cpu;
 
-        /* NOP - Zero Page,X (illegal) */
-        case 0x74:
-            cpu->pc++;  /* Skip zero page operand */
-            cycles = 4;
-            break;
+    ctx->cycles += 7;
+    cpu_push(ctx, (uint8_t)(cpu->pc >> 8));
+    cpu_push(ctx, (uint8_t)(cpu->pc & 0xFF));
+    cpu_push(ctx, pack_flags(cpu, false));
+    cpu->flag_i = 1;
+    cpu->pc = (uint16_t)(rd(ctx, vector) | (rd(ctx, (uint16_t)(vector + 1)) << 8));
+    ctx->jammed = false;
+}
 
-        /* ISC (INC + SBC) - Absolute,X */
-        case 0xFF: {
-            uint16_t base = ctx->read(ctx->userdata, cpu->pc++) | (ctx->read(ctx->userdata, cpu->pc++) << 8);
-            uint16_t addr = base + cpu->x;
-            uint8_t value = ctx->read(ctx->userdata, addr) + 1;
-            ctx->write(ctx->userdata, addr, value);
-            /* Then SBC */
-            uint16_t result = cpu->a - value - (1 - cpu->flag_c);
-            cpu->flag_c = result < 0x100;
-            cpu->flag_v = ((cpu->a ^ value) & (cpu->a ^ result) & 0x80) != 0;
-            cpu->a = result & 0xFF;
-            cpu_set_nz(cpu, cpu->a);
-            cycles = 7;
-            break;
-        }
+bool cpu_irq(CPU6502Context* ctx) {
+    if (ctx->cpu.flag_i || ctx->jammed) return false;
 
-        /* Unknown/unimplemented instruction - treat as NOP */
-        default:
-            is_unknown = true;
-            if (unknown_count < 20) {
-                fprintf(stderr, "Unknown opcode $%02X at $%04X (A=%02X X=%02X Y=%02X)\n",
-                        opcode, pc_start, cpu->a, cpu->x, cpu->y);
-                unknown_count++;
-            }
-            /* Try to skip operand bytes based on opcode pattern */
-            /* This is a rough heuristic */
-            switch (opcode & 0x1F) {
-                case 0x19: case 0x1D: case 0x1E:  /* Absolute,X/Y or Absolute */
-                case 0x0D: case 0x0E: case 0x0C:
-                    cpu->pc += 2;
-                    break;
-                case 0x11: case 0x01:  /* (Indirect),Y or (Indirect,X) */
-                case 0x05: case 0x06:  /* Zero Page */
-                case 0x15: case 0x16:  /* Zero Page,X/Y */
-                    cpu->pc += 1;
-                    break;
-                default:
-                    /* Immediate or implied - no operand or 1 byte */
-                    if ((opcode & 0x0F) == 0x09) {
-                        cpu->pc += 1;  /* Immediate */
-                    }
-                    break;
-            }
-            break;
-    }
+    interrupt(ctx, 0xFFFE);
+    return true;
+}
 
-    instr_count++;
+void cpu_nmi(CPU6502Context* ctx) {
+    if (ctx->jammed) return;
 
-    return cycles;
+    interrupt(ctx, 0xFFFA);
 }
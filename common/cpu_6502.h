@@ -39,12 +39,27 @@ typedef struct {
 typedef uint8_t (*cpu_read_func)(void* userdata, uint16_t addr);
 typedef void (*cpu_write_func)(void* userdata, uint16_t addr, uint8_t value);
 
-/* CPU context with memory callbacks */
+/* CPU context with memory callbacks
+ *
+ * All state lives here (no statics), so separate contexts can run on
+ * separate threads. With cpu_set_memory() the core reads and writes RAM
+ * directly and only calls read/write for pages marked as I/O; without it
+ * every access goes through the callbacks.
+ */
 typedef struct {
     CPU6502 cpu;
     void* userdata;
     cpu_read_func read;
     cpu_write_func write;
+
+    uint8_t* ram;           /* Direct 64 KB RAM, or NULL */
+    uint8_t io_page[256];   /* Per 256-byte page: 1 = use callbacks */
+
+    uint64_t cycles;        /* Total cycles; during an instruction this is
+                             * its last cycle + 1 (write timing) */
+    int32_t trap_pc;        /* cpu_run() stops when PC reaches this, -1 = off */
+    bool jammed;            /* A JAM/KIL opcode halted the CPU */
+    int unknown_count;      /* Reported unknown opcodes (rate-limits the log) */
 } CPU6502Context;
 
 // ============================================================================
@@ -67,6 +82,26 @@ void cpu_init(CPU6502Context* ctx, void* userdata,
  */
 void cpu_reset(CPU6502Context* ctx);
 
+/**
+ * Attach direct RAM (fast path). All pages become RAM pages; mark I/O
+ * pages with cpu_set_io_page() to route them to the callbacks.
+ * @param ram 64 KB buffer owned by the caller (NULL = callbacks only)
+ */
+void cpu_set_memory(CPU6502Context* ctx, uint8_t* ram);
+
+/**
+ * Route a 256-byte page to the read/write callbacks
+ * @param page Page number (e.g. 0xD4 for the SID)
+ * @param io true = callbacks, false = direct RAM
+ */
+void cpu_set_io_page(CPU6502Context* ctx, uint8_t page, bool io);
+
+/**
+ * Stop cpu_run() when PC reaches an address (e.g. a fake return address)
+ * @param addr Address 0x0000-0xFFFF, or -1 to disable
+ */
+void cpu_set_trap(CPU6502Context* ctx, int32_t addr);
+
 // ============================================================================
 // Execution
 // ============================================================================
@@ -78,6 +113,27 @@ void cpu_reset(CPU6502Context* ctx);
  */
 int cpu_step(CPU6502Context* ctx);
 
+/**
+ * Execute instructions for a cycle budget
+ * Stops early when PC reaches the trap address or the CPU jams.
+ * @param ctx CPU context
+ * @param cycles Cycle budget (the last instruction may overshoot it)
+ * @return Number of cycles consumed
+ */
+int cpu_run(CPU6502Context* ctx, int cycles);
+
+/**
+ * Take a maskable interrupt (IRQ) through the vector at $FFFE
+ * Ignored while the I flag is set.
+ * @return true if the interrupt was taken (7 cycles consumed)
+ */
+bool cpu_irq(CPU6502Context* ctx);
+
+/**
+ * Take a non-maskable interrupt (NMI) through the vector at $FFFA
+ */
+void cpu_nmi(CPU6502Context* ctx);
+
 // ============================================================================
 // Stack Operations
 // ============================================================================
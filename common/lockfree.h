@@ -0,0 +1,147 @@
+/*
+ * Lock-free primitives shared by the real-time players
+ *
+ * - LOAD_ACQUIRE / STORE_RELEASE: the acquire/release pairs everything here
+ *   is built on (GCC/Clang __atomic builtins)
+ * - MpscQueue: bounded multi-producer, single-consumer queue (Vyukov). Any
+ *   thread pushes control commands, the audio thread pops them without
+ *   locks or allocation
+ * - Seqlock: one writer publishes a struct, readers copy it and retry if
+ *   the copy overlapped a write (the audio thread never waits on a reader)
+ *
+ * Header-only; the caller owns all storage.
+ *
+ * Copyright (C) 2024
+ * SPDX-License-Identifier: ISC
+ */
+
+#ifndef LOCKFREE_H
+#define LOCKFREE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LOAD_ACQUIRE(x) __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(x, v) __atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+
+// ============================================================================
+// Bounded MPSC queue
+// ============================================================================
+
+/*
+ * Each cell has a sequence number that says whose turn it is: it equals
+ * the queue position while the cell is free for the producer at that
+ * position, position + 1 once filled, and position + capacity after the
+ * consumer has emptied it for the next lap. Producers claim positions with
+ * a CAS; the single consumer needs no read-modify-write at all.
+ */
+typedef struct {
+    uint32_t* sequence;     // capacity entries
+    unsigned char* items;   // capacity * item_size bytes
+    size_t item_size;
+    uint32_t capacity;
+    uint32_t enqueue_pos;   // Next position a producer claims
+    uint32_t dequeue_pos;   // Next position the consumer reads
+} MpscQueue;
+
+/**
+ * Set up a queue over caller-owned arrays (not thread-safe; call before
+ * any producer or the consumer runs)
+ * @param sequence Array of 'capacity' sequence numbers
+ * @param items Array of 'capacity' elements of 'item_size' bytes
+ */
+static inline void mpsc_queue_init(MpscQueue* queue, uint32_t* sequence, void* items,
+                                   size_t item_size, uint32_t capacity) {
+    queue->sequence = sequence;
+    queue->items = (unsigned char*)items;
+    queue->item_size = item_size;
+    queue->capacity = capacity;
+    queue->enqueue_pos = 0;
+    queue->dequeue_pos = 0;
+    for (uint32_t i = 0; i < capacity; i++) {
+        queue->sequence[i] = i;
+    }
+}
+
+/**
+ * Copy an item into the queue (any thread)
+ * @return false if the queue is full
+ */
+static inline bool mpsc_queue_push(MpscQueue* queue, const void* item) {
+    uint32_t pos = __atomic_load_n(&queue->enqueue_pos, __ATOMIC_RELAXED);
+
+    for (;;) {
+        uint32_t index = pos % queue->capacity;
+        int32_t diff = (int32_t)(LOAD_ACQUIRE(queue->sequence[index]) - pos);
+
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&queue->enqueue_pos, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                memcpy(queue->items + index * queue->item_size, item, queue->item_size);
+                STORE_RELEASE(queue->sequence[index], pos + 1);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = __atomic_load_n(&queue->enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/**
+ * Copy the oldest item out of the queue (consumer thread only)
+ * @return false if the queue is empty, or the oldest cell is still being filled
+ */
+static inline bool mpsc_queue_pop(MpscQueue* queue, void* item) {
+    uint32_t pos = queue->dequeue_pos;
+    uint32_t index = pos % queue->capacity;
+    if (LOAD_ACQUIRE(queue->sequence[index]) != pos + 1) return false;
+
+    memcpy(item, queue->items + index * queue->item_size, queue->item_size);
+    STORE_RELEASE(queue->sequence[index], pos + queue->capacity);
+    queue->dequeue_pos = pos + 1;
+    return true;
+}
+
+// ============================================================================
+// Seqlock
+// ============================================================================
+
+/*
+ * The version is odd while a write is in progress. The writer brackets its
+ * plain stores with seqlock_write_begin/end; a reader takes the version
+ * with seqlock_read_begin (retry if odd), copies, and keeps the copy only
+ * if seqlock_read_valid() says no write overlapped it.
+ */
+static inline uint32_t seqlock_write_begin(uint32_t* version) {
+    uint32_t v = __atomic_load_n(version, __ATOMIC_RELAXED);
+    __atomic_store_n(version, v + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    return v;
+}
+
+static inline void seqlock_write_end(uint32_t* version, uint32_t begin) {
+    __atomic_store_n(version, begin + 2, __ATOMIC_RELEASE);
+}
+
+static inline uint32_t seqlock_read_begin(const uint32_t* version) {
+    return __atomic_load_n(version, __ATOMIC_ACQUIRE);
+}
+
+static inline bool seqlock_read_valid(const uint32_t* version, uint32_t begin) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return !(begin & 1) && __atomic_load_n(version, __ATOMIC_RELAXED) == begin;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LOCKFREE_H
@@ -0,0 +1,257 @@
+/*
+ * Memory-Mapped Module Files
+ *
+ * Open mappings are kept in a small linked list keyed by file identity.
+ * Opening and mapping happen outside the lock; the list is only touched to
+ * look up, insert and unlink, so a slow disk never stalls another thread.
+ */
+
+#include "mapped_file.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif !defined(__EMSCRIPTEN__)
+#define MAPPED_FILE_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/* Identifies one version of one file */
+typedef struct {
+    uint64_t device;
+    uint64_t inode;
+    uint64_t size;
+    uint64_t mtime;
+} FileKey;
+
+struct MappedFile {
+    FileKey key;
+    const uint8_t* data;
+    size_t size;
+    int refcount;               /* Guarded by g_files_lock */
+#if defined(_WIN32)
+    HANDLE mapping;
+#endif
+    MappedFile* next;
+};
+
+static MappedFile* g_files = NULL;
+static int g_files_lock = 0;
+
+static void files_lock(void) {
+    while (__atomic_exchange_n(&g_files_lock, 1, __ATOMIC_ACQUIRE)) {
+        // Spin; held only for a list walk
+    }
+}
+
+static void files_unlock(void) {
+    __atomic_store_n(&g_files_lock, 0, __ATOMIC_RELEASE);
+}
+
+static bool key_equal(const FileKey* a, const FileKey* b) {
+    return a->device == b->device && a->inode == b->inode &&
+           a->size == b->size && a->mtime == b->mtime;
+}
+
+// Caller holds the lock
+static MappedFile* find_and_ref(const FileKey* key) {
+    for (MappedFile* f = g_files; f; f = f->next) {
+        if (key_equal(&f->key, key)) {
+            f->refcount++;
+            return f;
+        }
+    }
+    return NULL;
+}
+
+// ============================================================================
+// Platform mapping
+// ============================================================================
+
+#if defined(MAPPED_FILE_MMAP)
+
+static bool platform_map(const char* path, MappedFile* file, FileKey* key) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    key->device = (uint64_t)st.st_dev;
+    key->inode = (uint64_t)st.st_ino;
+    key->size = (uint64_t)st.st_size;
+    key->mtime = (uint64_t)st.st_mtime;
+
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // The mapping keeps its own reference to the file
+    if (data == MAP_FAILED) return false;
+
+    file->data = (const uint8_t*)data;
+    file->size = (size_t)st.st_size;
+    return true;
+}
+
+static void platform_unmap(MappedFile* file) {
+    munmap((void*)file->data, file->size);
+}
+
+#elif defined(_WIN32)
+
+static bool platform_map(const char* path, MappedFile* file, FileKey* key) {
+    HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                                NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+
+    BY_HANDLE_FILE_INFORMATION info;
+    if (!GetFileInformationByHandle(handle, &info)) {
+        CloseHandle(handle);
+        return false;
+    }
+    uint64_t size = ((uint64_t)info.nFileSizeHigh << 32) | info.nFileSizeLow;
+    if (size == 0 || size > (uint64_t)SIZE_MAX) {
+        CloseHandle(handle);
+        return false;
+    }
+    key->device = info.dwVolumeSerialNumber;
+    key->inode = ((uint64_t)info.nFileIndexHigh << 32) | info.nFileIndexLow;
+    key->size = size;
+    key->mtime = ((uint64_t)info.ftLastWriteTime.dwHighDateTime << 32) |
+                 info.ftLastWriteTime.dwLowDateTime;
+
+    HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(handle);  // The mapping keeps the file open
+    if (!mapping) return false;
+
+    void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!data) {
+        CloseHandle(mapping);
+        return false;
+    }
+
+    file->mapping = mapping;
+    file->data = (const uint8_t*)data;
+    file->size = (size_t)size;
+    return true;
+}
+
+static void platform_unmap(MappedFile* file) {
+    UnmapViewOfFile(file->data);
+    CloseHandle(file->mapping);
+}
+
+#else
+
+// No mmap: read the file. There is no inode to go by, so two opens only
+// share when they use the same path string.
+static bool platform_map(const char* path, MappedFile* file, FileKey* key) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (size <= 0) {
+        fclose(f);
+        return false;
+    }
+
+    uint8_t* data = (uint8_t*)malloc((size_t)size);
+    if (!data || fread(data, 1, (size_t)size, f) != (size_t)size) {
+        free(data);
+        fclose(f);
+        return false;
+    }
+    fclose(f);
+
+    uint64_t hash = 14695981039346656037ull;  // FNV-1a of the path
+    for (const char* p = path; *p; p++) {
+        hash = (hash ^ (uint8_t)*p) * 1099511628211ull;
+    }
+    key->device = 0;
+    key->inode = hash;
+    key->size = (uint64_t)size;
+    key->mtime = 0;
+
+    file->data = data;
+    file->size = (size_t)size;
+    return true;
+}
+
+static void platform_unmap(MappedFile* file) {
+    free((void*)file->data);
+}
+
+#endif
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+MappedFile* mapped_file_open(const char* path) {
+    if (!path) return NULL;
+
+    MappedFile* file = (MappedFile*)calloc(1, sizeof(MappedFile));
+    if (!file) return NULL;
+
+    FileKey key;
+    if (!platform_map(path, file, &key)) {
+        free(file);
+        return NULL;
+    }
+    file->key = key;
+    file->refcount = 1;
+
+    // Share an existing mapping of the same file. The new one is dropped
+    // unread; mmap is lazy, so that costs no I/O.
+    files_lock();
+    MappedFile* existing = find_and_ref(&key);
+    if (!existing) {
+        file->next = g_files;
+        g_files = file;
+    }
+    files_unlock();
+
+    if (existing) {
+        platform_unmap(file);
+        free(file);
+        return existing;
+    }
+    return file;
+}
+
+void mapped_file_release(MappedFile* file) {
+    if (!file) return;
+
+    files_lock();
+    bool last = (--file->refcount == 0);
+    if (last) {
+        for (MappedFile** link = &g_files; *link; link = &(*link)->next) {
+            if (*link == file) {
+                *link = file->next;
+                break;
+            }
+        }
+    }
+    files_unlock();
+
+    if (last) {
+        platform_unmap(file);
+        free(file);
+    }
+}
+
+const uint8_t* mapped_file_data(const MappedFile* file) {
+    return file ? file->data : NULL;
+}
+
+size_t mapped_file_size(const MappedFile* file) {
+    return file ? file->size : 0;
+}
@@ -0,0 +1,50 @@
+/*
+ * Memory-Mapped Module Files
+ * Read-only file mappings shared between everyone who opens the same file
+ *
+ * Players that support in-place loading (mod_player_load_in_place,
+ * med_player_load_in_place) reference sample and pattern data directly in
+ * the mapping instead of copying it, so a file is paged in on demand and
+ * two decks playing the same module share its memory. Opening a file that
+ * is already mapped (same device/inode, size and modification time) returns
+ * the existing mapping with its reference count raised.
+ *
+ * The mapping must outlive every player that loaded from it. The file must
+ * not be truncated or rewritten in place while mapped; replacing it (new
+ * inode) is safe and gives later opens a fresh mapping.
+ *
+ * Where mmap is unavailable (WebAssembly) the file is read into memory
+ * instead, with the same sharing rules.
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: ISC
+ */
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct MappedFile MappedFile;
+
+/* Map a file read-only. Returns NULL if it cannot be opened, is empty, or
+ * mapping fails. Thread-safe. */
+MappedFile* mapped_file_open(const char* path);
+
+/* Drop a reference; the mapping is removed when the last one goes. NULL is
+ * ignored. Thread-safe. */
+void mapped_file_release(MappedFile* file);
+
+const uint8_t* mapped_file_data(const MappedFile* file);
+size_t mapped_file_size(const MappedFile* file);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MAPPED_FILE_H */
@@ -10,7 +10,7 @@
  */
 
 #include "fx_amiga_filter.h"
-#include "fx_math_compat.h"
+#include "fx_math.h"
 #include <stdlib.h>
 #include <string.h>
 
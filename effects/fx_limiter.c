@@ -5,6 +5,7 @@
 
 #include "fx_limiter.h"
 #include "windows_compat.h"
+#include "fx_math.h"
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
@@ -32,11 +33,11 @@ struct FXLimiter {
 };
 
 static inline float db_to_lin(float db) {
-    return powf(10.0f, db / 20.0f);
+    return fx_db_to_lin(db);
 }
 
 static inline float lin_to_db(float x) {
-    return 20.0f * log10f(fmaxf(x, 1e-6f));
+    return fx_lin_to_db(fmaxf(x, 1e-6f));
 }
 
 FXLimiter* fx_limiter_create(void)
@@ -109,7 +110,7 @@ void fx_limiter_process_frame(FXLimiter* fx, float* L, float* R, int sr)
     // Smooth release to avoid crackling
     fx->releaseSmoothed += 0.001f * (fx->release - fx->releaseSmoothed);
     float releaseMs = 20.0f + fx->releaseSmoothed * 980.0f;
-    float releaseCoeff = expf(-1.0f / (sr * (releaseMs / 1000.0f)));
+    float releaseCoeff = fx_exp(-1.0f / (sr * (releaseMs / 1000.0f)));
 
     // Envelope: instant attack, smooth release
     if (target < fx->envelope)
@@ -0,0 +1,322 @@
+/*
+ * Regroove Fast Math
+ *
+ * Header-only approximations of the libm functions used in audio hot paths.
+ * Every function comes in two accuracy tiers:
+ *
+ *   fx_xxx_fast()  ~1e-4 relative error, cheapest (modulation, envelopes)
+ *   fx_xxx()       ~1e-6 relative error, close to float precision (audio)
+ *
+ * Polynomials are least-squares/minimax fits, evaluated branch-free (clamps
+ * are selects and floor goes through an int conversion), so the *_block()
+ * variants auto-vectorize (SSE2/NEON/WASM SIMD) at -O3 with default float
+ * flags. Where a result depends on a compare, both sides are computed and
+ * picked with fx_selectf(): GCC will not if-convert "c ? a - x : x" unless
+ * -fno-trapping-math says the subtraction may run speculatively.
+ *
+ * Define FX_MATH_USE_LIBM to route everything to libm (reference builds).
+ * tools/fx_math_bench measures accuracy against libm and throughput.
+ *
+ * Also carries the MinGW static-link workaround for tan()/tanf().
+ */
+
+#ifndef FX_MATH_H
+#define FX_MATH_H
+
+#include <stdint.h>
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// MinGW with -static flag has issues linking some math functions
+// Implement them using functions that do link properly
+#if defined(_WIN32) && defined(__MINGW32__)
+
+// tan() doesn't link properly with -static, but sin() and cos() do
+static inline double fx_tan(double x) {
+    return sin(x) / cos(x);
+}
+
+static inline float fx_tanf(float x) {
+    return sinf(x) / cosf(x);
+}
+
+#define tan fx_tan
+#define tanf fx_tanf
+
+#endif // _WIN32 && __MINGW32__
+
+#define FX_LOG2_E      1.44269504089f   // log2(e)
+#define FX_LN_2        0.69314718056f   // ln(2)
+#define FX_LOG2_10_20  0.16609640474f   // log2(10) / 20: dB -> exponent of 2
+#define FX_DB_LOG2     6.02059991328f   // 20 * log10(2): exponent of 2 -> dB
+#define FX_TWO_PI      6.28318530718f
+
+typedef union {
+    float f;
+    int32_t i;
+} fx_float_bits;
+
+// ============================================================================
+// exp2 / exp / pow
+// ============================================================================
+
+// c ? a : b as integer masking, so the float math feeding a and b stays
+// unconditional and the loop can vectorize
+static inline float fx_selectf(int c, float a, float b)
+{
+    fx_float_bits ua, ub;
+    ua.f = a;
+    ub.f = b;
+    const int32_t mask = -(int32_t)(c != 0);
+    ua.i = (ua.i & mask) | (ub.i & ~mask);
+    return ua.f;
+}
+
+// Clamp as two selects (fminf/fmaxf are libm calls without -ffast-math)
+static inline float fx_clampf(float x, float lo, float hi)
+{
+    x = fx_selectf(x < lo, lo, x);
+    return fx_selectf(x > hi, hi, x);
+}
+
+// floor() through an int conversion: vectorizes with plain SSE2/NEON,
+// unlike floorf(). Valid for |x| < 2^31.
+static inline int32_t fx_floor_int(float x)
+{
+    const int32_t i = (int32_t)x;
+    return i - (x < (float)i);
+}
+
+// 2^x for x in [-126, 126]; integer part goes straight into the exponent
+static inline float fx_exp2(float x)
+{
+#ifdef FX_MATH_USE_LIBM
+    return exp2f(x);
+#else
+    x = fx_clampf(x, -126.0f, 126.0f);
+    const int32_t xi = fx_floor_int(x);
+    const float f = x - (float)xi;
+    fx_float_bits u;
+    u.f = 1.0f + f * (0.693151312f + f * (0.24016445f + f * (0.0557999143f
+               + f * (0.00901702905f + f * 0.00186713053f))));
+    u.i += (int32_t)((uint32_t)xi << 23);  // xi may be negative
+    return u.f;
+#endif
+}
+
+static inline float fx_exp2_fast(float x)
+{
+#ifdef FX_MATH_USE_LIBM
+    return exp2f(x);
+#else
+    x = fx_clampf(x, -126.0f, 126.0f);
+    const int32_t xi = fx_floor_int(x);
+    const float f = x - (float)xi;
+    fx_float_bits u;
+    u.f = 1.0f + f * (0.695116802f + f * (0.227644953f + f * 0.0770670638f));
+    u.i += (int32_t)((uint32_t)xi << 23);  // xi may be negative
+    return u.f;
+#endif
+}
+
+static inline float fx_exp(float x)      { return fx_exp2(x * FX_LOG2_E); }
+static inline float fx_exp_fast(float x) { return fx_exp2_fast(x * FX_LOG2_E); }
+
+// ============================================================================
+// log2 / log
+// ============================================================================
+
+// log2(x) for x > 0 (returns about -127 for x <= 0).
+// Mantissa is centred on 1 (in [sqrt(1/2), sqrt(2))) and evaluated as
+// 2*atanh((m-1)/(m+1)), an odd series in s that converges quickly.
+static inline float fx_log2(float x)
+{
+#ifdef FX_MATH_USE_LIBM
+    return log2f(x);
+#else
+    fx_float_bits u;
+    u.f = fx_selectf(x > 1e-38f, x, 1e-38f);
+    // Offset by sqrt(1/2) so the mantissa lands in [0.7071, 1.4142)
+    const int32_t bits = u.i - 0x3F3504F3;
+    const int32_t e = bits >> 23;
+    u.i = (bits & 0x007FFFFF) + 0x3F3504F3;
+    const float s = (u.f - 1.0f) / (u.f + 1.0f);
+    const float s2 = s * s;
+    const float ln = 2.0f * s * (1.0f + s2 * (0.33333333f + s2 * (0.2f + s2 * (0.14285714f + s2 * 0.11111111f))));
+    return (float)e + ln * FX_LOG2_E;
+#endif
+}
+
+static inline float fx_log2_fast(float x)
+{
+#ifdef FX_MATH_USE_LIBM
+    return log2f(x);
+#else
+    fx_float_bits u;
+    u.f = fx_selectf(x > 1e-38f, x, 1e-38f);
+    const int32_t bits = u.i - 0x3F3504F3;
+    const int32_t e = bits >> 23;
+    u.i = (bits & 0x007FFFFF) + 0x3F3504F3;
+    const float s = (u.f - 1.0f) / (u.f + 1.0f);
+    const float s2 = s * s;
+    const float ln = 2.0f * s * (1.0f + s2 * (0.33333333f + s2 * 0.2f));
+    return (float)e + ln * FX_LOG2_E;
+#endif
+}
+
+static inline float fx_log(float x)      { return fx_log2(x) * FX_LN_2; }
+static inline float fx_log_fast(float x) { return fx_log2_fast(x) * FX_LN_2; }
+
+// x^y for x > 0 (0 for x <= 0, as used for envelope curves)
+static inline float fx_pow(float x, float y)
+{
+    return fx_selectf(x > 0.0f, fx_exp2(y * fx_log2(x)), 0.0f);
+}
+
+static inline float fx_pow_fast(float x, float y)
+{
+    return fx_selectf(x > 0.0f, fx_exp2_fast(y * fx_log2_fast(x)), 0.0f);
+}
+
+// ============================================================================
+// sin / cos
+// ============================================================================
+
+// sin(2*pi*x) with x in turns (|x| < 2^31). Oscillators keep their phase in
+// turns, so this saves the multiply and the range reduction is exact.
+static inline float fx_sin_turns(float x)
+{
+#ifdef FX_MATH_USE_LIBM
+    return sinf(FX_TWO_PI * x);
+#else
+    float r = x - (float)fx_floor_int(x + 0.5f);  // [-0.5, 0.5)
+    r = fx_selectf(r > 0.25f, 0.5f - r, r);       // Fold to [-0.25, 0.25]
+    r = fx_selectf(r < -0.25f, -0.5f - r, r);
+    const float t = r * FX_TWO_PI;
+    const float t2 = t * t;
+    return t * (0.999999977f + t2 * (-0.166666476f + t2 * (0.00833289988f
+             + t2 * (-0.000198009005f + t2 * 2.5904933e-6f))));
+#endif
+}
+
+static inline float fx_sin_turns_fast(float x)
+{
+#ifdef FX_MATH_USE_LIBM
+    return sinf(FX_TWO_PI * x);
+#else
+    float r = x - (float)fx_floor_int(x + 0.5f);
+    r = fx_selectf(r > 0.25f, 0.5f - r, r);
+    r = fx_selectf(r < -0.25f, -0.5f - r, r);
+    const float t = r * FX_TWO_PI;
+    const float t2 = t * t;
+    return t * (0.999696786f + t2 * (-0.165673097f + t2 * 0.00751438255f));
+#endif
+}
+
+static inline float fx_cos_turns(float x)      { return fx_sin_turns(x + 0.25f); }
+static inline float fx_cos_turns_fast(float x) { return fx_sin_turns_fast(x + 0.25f); }
+
+// Radian versions
+static inline float fx_sin(float x)      { return fx_sin_turns(x * (1.0f / FX_TWO_PI)); }
+static inline float fx_sin_fast(float x) { return fx_sin_turns_fast(x * (1.0f / FX_TWO_PI)); }
+static inline float fx_cos(float x)      { return fx_cos_turns(x * (1.0f / FX_TWO_PI)); }
+static inline float fx_cos_fast(float x) { return fx_cos_turns_fast(x * (1.0f / FX_TWO_PI)); }
+
+// ============================================================================
+// tanh / soft clip
+// ============================================================================
+
+// tanh(|x|) = (1 - e^-2|x|) / (1 + e^-2|x|), sign restored afterwards
+static inline float fx_tanh(float x)
+{
+#ifdef FX_MATH_USE_LIBM
+    return tanhf(x);
+#else
+    const float e = fx_exp2(-2.0f * FX_LOG2_E * fabsf(x));  // e^-2|x| in (0, 1]
+    return copysignf((1.0f - e) / (1.0f + e), x);
+#endif
+}
+
+// Rational (Pade 7/6) approximation, clamped where it reaches +/-1
+static inline float fx_tanh_fast(float x)
+{
+#ifdef FX_MATH_USE_LIBM
+    return tanhf(x);
+#else
+    x = fx_clampf(x, -4.97f, 4.97f);
+    const float x2 = x * x;
+    const float y = x * (135135.0f + x2 * (17325.0f + x2 * (378.0f + x2)))
+                  / (135135.0f + x2 * (62370.0f + x2 * (3150.0f + x2 * 28.0f)));
+    return fx_clampf(y, -1.0f, 1.0f);
+#endif
+}
+
+// Cubic soft clipper: 1.5x - 0.5x^3 on [-1, 1], hard +/-1 beyond.
+// Unity slope at 0 is 1.5, so it is louder than tanh for small signals.
+static inline float fx_softclip(float x)
+{
+    x = fx_clampf(x, -1.0f, 1.0f);
+    return x * (1.5f - 0.5f * x * x);
+}
+
+// ============================================================================
+// Decibels
+// ============================================================================
+
+static inline float fx_db_to_lin(float db)      { return fx_exp2(db * FX_LOG2_10_20); }
+static inline float fx_db_to_lin_fast(float db) { return fx_exp2_fast(db * FX_LOG2_10_20); }
+static inline float fx_lin_to_db(float x)       { return fx_log2(x) * FX_DB_LOG2; }
+static inline float fx_lin_to_db_fast(float x)  { return fx_log2_fast(x) * FX_DB_LOG2; }
+
+// ============================================================================
+// Block variants (auto-vectorized; in and out may alias)
+// ============================================================================
+
+static inline void fx_exp2_block(const float* in, float* out, int n)
+{
+    for (int i = 0; i < n; i++) out[i] = fx_exp2(in[i]);
+}
+
+static inline void fx_exp2_fast_block(const float* in, float* out, int n)
+{
+    for (int i = 0; i < n; i++) out[i] = fx_exp2_fast(in[i]);
+}
+
+static inline void fx_sin_turns_block(const float* in, float* out, int n)
+{
+    for (int i = 0; i < n; i++) out[i] = fx_sin_turns(in[i]);
+}
+
+static inline void fx_sin_turns_fast_block(const float* in, float* out, int n)
+{
+    for (int i = 0; i < n; i++) out[i] = fx_sin_turns_fast(in[i]);
+}
+
+static inline void fx_tanh_block(const float* in, float* out, int n)
+{
+    for (int i = 0; i < n; i++) out[i] = fx_tanh(in[i]);
+}
+
+static inline void fx_tanh_fast_block(const float* in, float* out, int n)
+{
+    for (int i = 0; i < n; i++) out[i] = fx_tanh_fast(in[i]);
+}
+
+static inline void fx_softclip_block(const float* in, float* out, int n)
+{
+    for (int i = 0; i < n; i++) out[i] = fx_softclip(in[i]);
+}
+
+static inline void fx_db_to_lin_block(const float* in, float* out, int n)
+{
+    for (int i = 0; i < n; i++) out[i] = fx_db_to_lin(in[i]);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FX_MATH_H
@@ -11,7 +11,7 @@
 
 #include "fx_paula_blep.h"
 #include "fx_paula_blep_tables.h"
-#include "fx_math_compat.h"
+#include "fx_math.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
@@ -112,7 +112,7 @@ void fx_paula_blep_input_sample(FXPaulaBlep* fx, int16_t sample) {
     // Detect level change (create new BLEP when output changes)
     if (sample != fx->global_output_level) {
         // Add new BLEP at age 0
-        fx->first_blep = (fx->first_blep - 1) % MAX_BLEPS;
+        fx->first_blep = (uint16_t)((fx->first_blep + MAX_BLEPS - 1) % MAX_BLEPS);
         if (fx->active_bleps < MAX_BLEPS) {
             fx->active_bleps++;
         }
@@ -127,21 +127,22 @@ int fx_paula_blep_output_sample(FXPaulaBlep* fx) {
     if (!fx) return 0;
 
     // Start with current output level (scaled by 2^17)
-    int output = fx->global_output_level * 131072;
+    // 64-bit sum: a full-scale level times 2^17 already fills an int
+    int64_t output = (int64_t)fx->global_output_level * 131072;
 
     // Accumulate all active BLEPs
     uint32_t last_blep = fx->first_blep + fx->active_bleps;
     for (uint32_t i = fx->first_blep; i != last_blep; i++) {
         const Blep* blep = &fx->blep_state[i % MAX_BLEPS];
         if (blep->age < BLEP_SIZE) {
-            output -= fx->blep_table[blep->age] * blep->level;
+            output -= (int64_t)fx->blep_table[blep->age] * blep->level;
         }
     }
 
     // Scale down (compensate for 2^17 scale and 2^2 for bit depth)
     output /= (131072 / 4);
 
-    return output;
+    return (int)output;
 }
 
 void fx_paula_blep_clock(FXPaulaBlep* fx, int cycles) {
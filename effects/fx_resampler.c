@@ -12,7 +12,7 @@
  */
 
 #include "fx_resampler.h"
-#include "fx_math_compat.h"
+#include "fx_math.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
@@ -103,8 +103,8 @@ static int table_initialized = 0;
 #endif
 
 // Sinc configuration (from OpenMPT Resampler.h)
-#define SINC_WIDTH 8
-#define SINC_PHASES_BITS 12
+#define SINC_WIDTH FX_RESAMPLER_SINC_WIDTH
+#define SINC_PHASES_BITS FX_RESAMPLER_SINC_PHASES_BITS
 #define SINC_PHASES (1 << SINC_PHASES_BITS)  // 4096 phases
 #define SINC_MASK (SINC_PHASES - 1)
 
@@ -177,6 +177,23 @@ static void init_cubic_table(void) {
     table_initialized = 1;
 }
 
+const float* fx_resampler_get_cubic_table(void) {
+    init_cubic_table();
+    return FastSincTablef;
+}
+
+const float* fx_resampler_get_sinc_table(float ratio) {
+    init_cubic_table();
+
+    // Select appropriate polyphase table based on resampling ratio
+    if (ratio > 1.5f) {
+        return gDownsample2x;       // 2x downsample
+    } else if (ratio > 1.2f) {
+        return gDownsample13x;      // 1.33x downsample
+    }
+    return gKaiserSinc;             // Normal/upsample
+}
+
 // ============================================================================
 // Interpolation Functions
 // ============================================================================
@@ -224,15 +241,7 @@ static inline float interpolate_sinc8(const float* input, double position, int c
     int idx = (int)position;
     float fract = (float)(position - idx);
 
-    // Select appropriate polyphase table based on resampling ratio
-    const float* sinc_table;
-    if (rate > 1.5f) {
-        sinc_table = gDownsample2x;       // 2x downsample
-    } else if (rate > 1.2f) {
-        sinc_table = gDownsample13x;      // 1.33x downsample
-    } else {
-        sinc_table = gKaiserSinc;         // Normal/upsample
-    }
+    const float* sinc_table = fx_resampler_get_sinc_table(rate);
 
     // Calculate phase (4096 phases)
     uint32_t phase = (uint32_t)(fract * (float)SINC_PHASES);
@@ -55,6 +55,18 @@ float fx_resampler_get_rate(FXResampler* fx);
 int fx_resampler_get_required_input_frames(int output_frames, float rate);
 const char* fx_resampler_get_mode_name(ResamplerMode mode);
 
+// Shared interpolation tables (for modules that resample their own output)
+#define FX_RESAMPLER_CUBIC_PHASES_BITS 8
+#define FX_RESAMPLER_SINC_WIDTH 8
+#define FX_RESAMPLER_SINC_PHASES_BITS 12
+
+// 4-tap cubic spline (FastSinc) table, [phase * 4 + tap], taps -1..+2
+const float* fx_resampler_get_cubic_table(void);
+
+// 8-tap table for an input/output rate ratio (> 1 = downsampling).
+// Layout is [phase * 8 + tap], taps covering input samples -3..+4.
+const float* fx_resampler_get_sinc_table(float ratio);
+
 // ============================================================================
 // Generic Parameter Interface (for wrapper use)
 // ============================================================================
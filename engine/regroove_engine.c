@@ -1,4 +1,5 @@
 #include "regroove_engine.h"
+#include "../common/lockfree.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -29,7 +30,16 @@ typedef enum {
     RG_CMD_SET_CHANNEL_VOLUME,
     RG_CMD_SET_CHANNEL_PANNING,
     RG_CMD_QUEUE_CHANNEL_MUTE,      // Queued mute toggle
-    RG_CMD_QUEUE_CHANNEL_SOLO       // Queued solo toggle
+    RG_CMD_QUEUE_CHANNEL_SOLO,      // Queued solo toggle
+    RG_CMD_SET_POSITION_ROW,
+    RG_CMD_CLEAR_PENDING_JUMP,
+    RG_CMD_SET_LOOP_START_HERE,
+    RG_CMD_SET_LOOP_END_HERE,
+    RG_CMD_SET_INTERPOLATION_FILTER,
+    RG_CMD_SET_STEREO_SEPARATION,
+    RG_CMD_SET_DITHER,
+    RG_CMD_SET_AMIGA_RESAMPLER,
+    RG_CMD_SET_AMIGA_FILTER_TYPE
 } RegrooveCommandType;
 
 typedef struct {
@@ -41,7 +51,50 @@ typedef struct {
     int arg4;    // For loop range (end_row)
 } RegrooveCommand;
 
-#define RG_MAX_COMMANDS 8
+#define RG_MAX_COMMANDS 64  // Power of two
+
+typedef struct {
+    int muted;
+    int pending_muted;
+    int queued_action;
+    double volume;
+    double panning;
+} RegrooveChannelState;
+
+// Everything the getters report besides the channels
+typedef struct {
+    RegrooveState state;
+    int custom_loop_rows;
+    int full_loop_rows;
+    int loop_start_order;
+    int loop_start_row;
+    int loop_end_order;
+    int loop_end_row;
+    int has_pending_mute_changes;
+    int queued_order;
+    int interpolation_filter;
+    int stereo_separation;
+    int dither;
+    int amiga_resampler;
+    int amiga_filter_type;
+} RegroovePublishedState;
+
+// Buffers a block renders to: one of the output formats
+typedef struct {
+    int16_t* s16;               // Interleaved int16
+    float* interleaved;         // Interleaved float
+    float* left;                // Planar float
+    float* right;
+} RegrooveOutput;
+
+// State published by the audio thread after every block, so getters called
+// from other threads never touch libopenmpt or fields the audio thread is
+// changing. The version is odd while it is being written (seqlock).
+typedef struct {
+    uint32_t version;
+    RegroovePublishedState published;
+    RegrooveChannelState* channels;
+} RegrooveSnapshot;
 
 struct Regroove {
     openmpt_module_ext* modext;
@@ -63,13 +116,17 @@ struct Regroove {
     double* channel_pannings;  // 0.0 = full left, 0.5 = center, 1.0 = full right
 
     int num_orders;
+    int num_patterns;
     int pattern_mode;
     int loop_pattern;
     int loop_order;
 
-    RegrooveCommand command_queue[RG_MAX_COMMANDS];
-    int command_queue_head;
-    int command_queue_tail;
+    MpscQueue command_queue;           // Any thread pushes, the audio thread pops
+    uint32_t command_sequence[RG_MAX_COMMANDS];
+    RegrooveCommand command_items[RG_MAX_COMMANDS];
+    unsigned int dropped_commands;     // Commands that found the queue full
+
+    RegrooveSnapshot snapshot;
 
     int queued_order;
     int queued_row;
@@ -143,6 +200,78 @@ static void reapply_pannings(struct Regroove* g) {
     }
 }
 
+// Apply a render setting command to one module
+static void apply_render_setting(openmpt_module* mod, RegrooveCommandType type, int value) {
+    const char* amiga_filter_names[] = {"auto", "a500", "a1200", "unfiltered"};
+    switch (type) {
+        case RG_CMD_SET_INTERPOLATION_FILTER:
+            // OPENMPT_MODULE_RENDER_INTERPOLATIONFILTER_LENGTH = 3
+            openmpt_module_set_render_param(mod, 3, value);
+            break;
+        case RG_CMD_SET_STEREO_SEPARATION:
+            // OPENMPT_MODULE_RENDER_STEREOSEPARATION_PERCENT = 2
+            openmpt_module_set_render_param(mod, 2, value);
+            break;
+        case RG_CMD_SET_DITHER:
+            openmpt_module_ctl_set_integer(mod, "dither", value);
+            break;
+        case RG_CMD_SET_AMIGA_RESAMPLER:
+            openmpt_module_ctl_set_boolean(mod, "render.resampler.emulate_amiga", value);
+            break;
+        case RG_CMD_SET_AMIGA_FILTER_TYPE:
+            if (value >= 0 && value <= 3) {
+                openmpt_module_ctl_set_text(mod, "render.resampler.emulate_amiga_type", amiga_filter_names[value]);
+            }
+            break;
+        default: break;
+    }
+}
+
+// Settings the module renders with
+static void apply_render_settings(struct Regroove* g, openmpt_module* mod) {
+    apply_render_setting(mod, RG_CMD_SET_INTERPOLATION_FILTER, g->interpolation_filter);
+    apply_render_setting(mod, RG_CMD_SET_STEREO_SEPARATION, g->stereo_separation);
+
+    // Set master gain boost (OPENMPT_MODULE_RENDER_MASTERGAIN_MILLIBEL = 1)
+    // +6 dB = 600 millibels (modest boost to compensate for libopenmpt's soft output)
+    openmpt_module_set_render_param(mod, 1, 600);
+
+    apply_render_setting(mod, RG_CMD_SET_DITHER, g->dither);
+    apply_render_setting(mod, RG_CMD_SET_AMIGA_RESAMPLER, g->amiga_resampler);
+    apply_render_setting(mod, RG_CMD_SET_AMIGA_FILTER_TYPE, g->amiga_filter_type);
+
+    // Disable automatic looping - we'll handle it manually for cleaner loop points
+    openmpt_module_set_repeat_count(mod, 0);
+}
+
+// Store a render setting command's value and apply it (audio thread)
+static void set_render_setting(struct Regroove* g, RegrooveCommandType type, int value) {
+    switch (type) {
+        case RG_CMD_SET_INTERPOLATION_FILTER: g->interpolation_filter = value; break;
+        case RG_CMD_SET_STEREO_SEPARATION: g->stereo_separation = value; break;
+        case RG_CMD_SET_DITHER: g->dither = value; break;
+        case RG_CMD_SET_AMIGA_RESAMPLER: g->amiga_resampler = value; break;
+        case RG_CMD_SET_AMIGA_FILTER_TYPE: g->amiga_filter_type = value; break;
+        default: return;
+    }
+    apply_render_setting(g->mod, type, value);
+}
+
+// Render frames in the output's format. Returns the frames rendered.
+static int read_output(struct Regroove* g, const RegrooveOutput* out, int frames) {
+    int32_t rate = (int32_t)(g->samplerate * g->pitch_factor);
+    size_t count;
+
+    if (out->s16) {
+        count = openmpt_module_read_interleaved_stereo(g->mod, rate, frames, out->s16);
+    } else if (out->interleaved) {
+        count = openmpt_module_read_interleaved_float_stereo(g->mod, rate, frames, out->interleaved);
+    } else {
+        count = openmpt_module_read_float_stereo(g->mod, rate, frames, out->left, out->right);
+    }
+    return (int)count;
+}
+
 static void apply_pending_mute_changes(struct Regroove* g) {
     if (!g->has_pending_mute_changes || !g->pending_mute_states) return;
 
@@ -167,47 +296,107 @@ static void apply_pending_mute_changes(struct Regroove* g) {
     }
 }
 
-static void enqueue_command(struct Regroove* g, RegrooveCommandType type, int arg1, int arg2) {
-    int next_tail = (g->command_queue_tail + 1) % RG_MAX_COMMANDS;
-    if (next_tail != g->command_queue_head) {
-        g->command_queue[g->command_queue_tail].type = type;
-        g->command_queue[g->command_queue_tail].arg1 = arg1;
-        g->command_queue[g->command_queue_tail].arg2 = arg2;
-        g->command_queue[g->command_queue_tail].dval = 0.0;
-        g->command_queue[g->command_queue_tail].arg3 = 0;
-        g->command_queue[g->command_queue_tail].arg4 = 0;
-        g->command_queue_tail = next_tail;
+// Push a command from any thread. Commands that find the queue full are
+// dropped and counted.
+static void push_command(struct Regroove* g, const RegrooveCommand* command) {
+    if (!mpsc_queue_push(&g->command_queue, command)) {
+        __atomic_add_fetch(&g->dropped_commands, 1, __ATOMIC_RELAXED);
     }
 }
+
+static void enqueue_command(struct Regroove* g, RegrooveCommandType type, int arg1, int arg2) {
+    RegrooveCommand command = { type, arg1, arg2, 0.0, 0, 0 };
+    push_command(g, &command);
+}
 static void enqueue_command_d(struct Regroove* g, RegrooveCommandType type, int arg1, double dval) {
-    int next_tail = (g->command_queue_tail + 1) % RG_MAX_COMMANDS;
-    if (next_tail != g->command_queue_head) {
-        g->command_queue[g->command_queue_tail].type = type;
-        g->command_queue[g->command_queue_tail].arg1 = arg1;
-        g->command_queue[g->command_queue_tail].arg2 = 0;
-        g->command_queue[g->command_queue_tail].dval = dval;
-        g->command_queue[g->command_queue_tail].arg3 = 0;
-        g->command_queue[g->command_queue_tail].arg4 = 0;
-        g->command_queue_tail = next_tail;
-    }
+    RegrooveCommand command = { type, arg1, 0, dval, 0, 0 };
+    push_command(g, &command);
 }
 static void enqueue_command_range(struct Regroove* g, RegrooveCommandType type,
                                    int start_order, int start_row, int end_order, int end_row) {
-    int next_tail = (g->command_queue_tail + 1) % RG_MAX_COMMANDS;
-    if (next_tail != g->command_queue_head) {
-        g->command_queue[g->command_queue_tail].type = type;
-        g->command_queue[g->command_queue_tail].arg1 = start_order;
-        g->command_queue[g->command_queue_tail].arg2 = start_row;
-        g->command_queue[g->command_queue_tail].arg3 = end_order;
-        g->command_queue[g->command_queue_tail].arg4 = end_row;
-        g->command_queue[g->command_queue_tail].dval = 0.0;
-        g->command_queue_tail = next_tail;
+    RegrooveCommand command = { type, start_order, start_row, 0.0, end_order, end_row };
+    push_command(g, &command);
+}
+
+// Publish the state the getters report (audio thread only)
+static void publish_state(struct Regroove* g) {
+    RegroovePublishedState p;
+    p.state.order = openmpt_module_get_current_order(g->mod);
+    p.state.pattern = openmpt_module_get_current_pattern(g->mod);
+    p.state.row = openmpt_module_get_current_row(g->mod);
+    p.state.speed = openmpt_module_get_current_speed(g->mod);
+    // Use tempo2 instead of estimated_bpm to get the actual tempo value
+    // estimated_bpm accounts for speed (ticks/row) which makes MIDI Clock timing wrong
+    // MIDI Clock should represent the musical tempo, not the effective playback speed
+    p.state.bpm = openmpt_module_get_current_tempo2(g->mod);
+    p.state.pitch = g->pitch_factor;
+    p.state.pattern_mode = g->pattern_mode;
+    p.state.loop_state = g->loop_range_enabled;
+    p.state.queued_jump_type = g->queued_jump_type;
+    p.custom_loop_rows = g->custom_loop_rows;
+    p.full_loop_rows = g->full_loop_rows;
+    p.loop_start_order = g->loop_start_order;
+    p.loop_start_row = g->loop_start_row;
+    p.loop_end_order = g->loop_end_order;
+    p.loop_end_row = g->loop_end_row;
+    p.has_pending_mute_changes = g->has_pending_mute_changes;
+    // In pattern mode, queued order is stored in pending_pattern_mode_order
+    p.queued_order = (g->pattern_mode && g->queued_jump_type > 0) ? g->pending_pattern_mode_order
+                                                                  : g->queued_order;
+    p.interpolation_filter = g->interpolation_filter;
+    p.stereo_separation = g->stereo_separation;
+    p.dither = g->dither;
+    p.amiga_resampler = g->amiga_resampler;
+    p.amiga_filter_type = g->amiga_filter_type;
+
+    RegrooveSnapshot* s = &g->snapshot;
+    uint32_t version = seqlock_write_begin(&s->version);
+
+    s->published = p;
+    for (int ch = 0; ch < g->num_channels; ++ch) {
+        RegrooveChannelState* c = &s->channels[ch];
+        c->muted = g->mute_states[ch];
+        c->pending_muted = g->pending_mute_states ? g->pending_mute_states[ch] : g->mute_states[ch];
+        c->queued_action = g->queued_action_per_channel ? g->queued_action_per_channel[ch] : 0;
+        c->volume = g->channel_volumes[ch];
+        c->panning = g->channel_pannings[ch];
     }
+
+    seqlock_write_end(&s->version, version);
+}
+
+// Copy the published state (any thread), and channel `ch` if `channel` is set
+static void read_state(const Regroove* g, RegroovePublishedState* published,
+                       int ch, RegrooveChannelState* channel) {
+    const RegrooveSnapshot* s = &g->snapshot;
+    for (;;) {
+        uint32_t version = seqlock_read_begin(&s->version);
+        if (version & 1) continue;
+
+        *published = s->published;
+        if (channel) *channel = s->channels[ch];
+
+        if (seqlock_read_valid(&s->version, version)) return;
+    }
+}
+
+static RegroovePublishedState published_state(const Regroove* g) {
+    RegroovePublishedState published;
+    read_state(g, &published, 0, NULL);
+    return published;
+}
+
+static RegrooveChannelState published_channel(const Regroove* g, int ch) {
+    RegroovePublishedState published;
+    RegrooveChannelState channel;
+    read_state(g, &published, ch, &channel);
+    return channel;
 }
 
 static void process_commands(struct Regroove* g) {
-    while (g->command_queue_head != g->command_queue_tail) {
-        RegrooveCommand* cmd = &g->command_queue[g->command_queue_head];
+    RegrooveCommand command;
+    while (mpsc_queue_pop(&g->command_queue, &command)) {
+        RegrooveCommand* cmd = &command;
         switch (cmd->type) {
             case RG_CMD_TOGGLE_CHANNEL_MUTE:
                 if (cmd->arg1 >= 0 && cmd->arg1 < g->num_channels) {
@@ -361,9 +550,13 @@ static void process_commands(struct Regroove* g) {
                 break;
             }
             case RG_CMD_JUMP_TO_PATTERN: {
-                int pattern_index = cmd->arg1;
+                int pattern_index = cmd->arg1;  // -1 = pattern at the order in arg2
                 int target_order = cmd->arg2; // arg2 now carries explicit order, or -1 to search
 
+                if (pattern_index < 0) {
+                    pattern_index = openmpt_module_get_order_pattern(g->mod, target_order);
+                }
+
                 // If order not specified, find first order that contains this pattern
                 if (target_order == -1) {
                     for (int i = 0; i < g->num_orders; ++i) {
@@ -534,9 +727,41 @@ static void process_commands(struct Regroove* g) {
                     g->has_pending_mute_changes = 1;
                 }
                 break;
+            case RG_CMD_SET_POSITION_ROW: {
+                int current_order = openmpt_module_get_current_order(g->mod);
+                int current_pattern = openmpt_module_get_current_pattern(g->mod);
+                int num_rows = openmpt_module_get_pattern_num_rows(g->mod, current_pattern);
+                int row = cmd->arg1;
+
+                // Validate row
+                if (row >= num_rows) row = num_rows - 1;
+                if (row < 0) row = 0;
+                openmpt_module_set_position_order_row(g->mod, current_order, row);
+                break;
+            }
+            case RG_CMD_CLEAR_PENDING_JUMP:
+                // Clear pending jump state without affecting pattern mode
+                g->pending_pattern_mode_order = -1;
+                g->queued_jump_type = 0;
+                g->has_queued_jump = 0;
+                break;
+            case RG_CMD_SET_LOOP_START_HERE:
+                g->loop_start_order = openmpt_module_get_current_order(g->mod);
+                g->loop_start_row = openmpt_module_get_current_row(g->mod);
+                break;
+            case RG_CMD_SET_LOOP_END_HERE:
+                g->loop_end_order = openmpt_module_get_current_order(g->mod);
+                g->loop_end_row = openmpt_module_get_current_row(g->mod);
+                break;
+            case RG_CMD_SET_INTERPOLATION_FILTER:
+            case RG_CMD_SET_STEREO_SEPARATION:
+            case RG_CMD_SET_DITHER:
+            case RG_CMD_SET_AMIGA_RESAMPLER:
+            case RG_CMD_SET_AMIGA_FILTER_TYPE:
+                set_render_setting(g, cmd->type, cmd->arg1);
+                break;
             default: break;
         }
-        g->command_queue_head = (g->command_queue_head + 1) % RG_MAX_COMMANDS;
     }
 }
 
@@ -576,8 +801,12 @@ Regroove *regroove_create(const char *filename, double samplerate) {
     g->mod = openmpt_module_ext_get_module(g->modext);
     if (!g->mod) { openmpt_module_ext_destroy(g->modext); free(g); return NULL; }
     g->num_orders = openmpt_module_get_num_orders(g->mod);
+    g->num_patterns = openmpt_module_get_num_patterns(g->mod);
     g->num_channels = openmpt_module_get_num_channels(g->mod);
 
+    mpsc_queue_init(&g->command_queue, g->command_sequence, g->command_items,
+                    sizeof(RegrooveCommand), RG_MAX_COMMANDS);
+
     g->mute_states = (int*)calloc(g->num_channels, sizeof(int));
     g->channel_volumes = (double*)calloc(g->num_channels, sizeof(double));
     g->channel_pannings = (double*)calloc(g->num_channels, sizeof(double));
@@ -616,30 +845,8 @@ Regroove *regroove_create(const char *filename, double samplerate) {
         }
     }
 
-    // Set interpolation filter (OPENMPT_MODULE_RENDER_INTERPOLATIONFILTER_LENGTH = 3)
-    openmpt_module_set_render_param(g->mod, 3, g->interpolation_filter);
-
-    // Set stereo separation (OPENMPT_MODULE_RENDER_STEREOSEPARATION_PERCENT = 2)
-    openmpt_module_set_render_param(g->mod, 2, g->stereo_separation);
-
-    // Set master gain boost (OPENMPT_MODULE_RENDER_MASTERGAIN_MILLIBEL = 1)
-    // +6 dB = 600 millibels (modest boost to compensate for libopenmpt's soft output)
-    openmpt_module_set_render_param(g->mod, 1, 600);
-
-    // Set dither
-    openmpt_module_ctl_set_integer(g->mod, "dither", g->dither);
-
-    // Set Amiga resampler (only affects 4-channel Amiga modules)
-    openmpt_module_ctl_set_boolean(g->mod, "render.resampler.emulate_amiga", g->amiga_resampler);
-
-    // Set Amiga filter type
-    const char* amiga_filter_names[] = {"auto", "a500", "a1200", "unfiltered"};
-    if (g->amiga_filter_type >= 0 && g->amiga_filter_type <= 3) {
-        openmpt_module_ctl_set_text(g->mod, "render.resampler.emulate_amiga_type", amiga_filter_names[g->amiga_filter_type]);
-    }
-
-    // Disable automatic looping - we'll handle it manually for cleaner loop points
-    openmpt_module_set_repeat_count(g->mod, 0);
+    // Interpolation, stereo separation, gain, dither, Amiga emulation, no looping
+    apply_render_settings(g, g->mod);
 
     g->loop_order = openmpt_module_get_current_order(g->mod);
     g->loop_pattern = openmpt_module_get_current_pattern(g->mod);
@@ -674,6 +881,11 @@ Regroove *regroove_create(const char *filename, double samplerate) {
     g->last_playback_order = -1;
     g->last_playback_row = -1;
 
+    g->snapshot.channels = (RegrooveChannelState*)calloc(g->num_channels > 0 ? g->num_channels : 1,
+                                                         sizeof(RegrooveChannelState));
+    if (!g->snapshot.channels) { regroove_destroy(g); return NULL; }
+    publish_state(g);
+
     return g;
 }
 
@@ -685,6 +897,7 @@ void regroove_destroy(Regroove *g) {
     if (g->interactive2) free(g->interactive2);
     if (g->pending_mute_states) free(g->pending_mute_states);
     if (g->queued_action_per_channel) free(g->queued_action_per_channel);
+    if (g->snapshot.channels) free(g->snapshot.channels);
     free(g);
 }
 
@@ -698,7 +911,7 @@ void regroove_set_callbacks(Regroove *g, struct RegrooveCallbacks *cb) {
     g->callback_userdata = cb->userdata;
 }
 
-int regroove_render_audio(Regroove* g, int16_t* buffer, int frames) {
+static int render_block(Regroove* g, const RegrooveOutput* out, int frames) {
     process_commands(g);
 
     // Note: Queued jumps are now handled at pattern boundaries in song playback mode
@@ -708,8 +921,7 @@ int regroove_render_audio(Regroove* g, int16_t* buffer, int frames) {
     int prev_order_before = openmpt_module_get_current_order(g->mod);
     int prev_row_before = openmpt_module_get_current_row(g->mod);
 
-    int count = openmpt_module_read_interleaved_stereo(
-        g->mod, g->samplerate * g->pitch_factor, frames, buffer);
+    int count = read_output(g, out, frames);
 
     // Get position AFTER rendering
     int cur_order = openmpt_module_get_current_order(g->mod);
@@ -764,8 +976,7 @@ int regroove_render_audio(Regroove* g, int16_t* buffer, int frames) {
             reapply_pannings(g);
         }
         // Re-render a clean buffer from pattern start
-        count = openmpt_module_read_interleaved_stereo(
-            g->mod, g->samplerate * g->pitch_factor, frames, buffer);
+        count = read_output(g, out, frames);
         cur_order = g->loop_order;
         cur_pattern = openmpt_module_get_current_pattern(g->mod);
         cur_row = openmpt_module_get_current_row(g->mod);
@@ -875,8 +1086,7 @@ int regroove_render_audio(Regroove* g, int16_t* buffer, int frames) {
                         reapply_pannings(g);
                     }
                     // Re-render a clean buffer from the new pattern start to avoid glitches
-                    count = openmpt_module_read_interleaved_stereo(
-                        g->mod, g->samplerate * g->pitch_factor, frames, buffer);
+                    count = read_output(g, out, frames);
                     cur_order = g->loop_order;
                     cur_pattern = g->loop_pattern;
                     cur_row = openmpt_module_get_current_row(g->mod);
@@ -1104,10 +1314,32 @@ int regroove_render_audio(Regroove* g, int16_t* buffer, int frames) {
     return count;
 }
 
+int regroove_render_audio(Regroove* g, int16_t* buffer, int frames) {
+    RegrooveOutput out = { buffer, NULL, NULL, NULL };
+    int count = render_block(g, &out, frames);
+    publish_state(g);
+    return count;
+}
+
+int regroove_render_audio_float(Regroove* g, float* buffer, int frames) {
+    RegrooveOutput out = { NULL, buffer, NULL, NULL };
+    int count = render_block(g, &out, frames);
+    publish_state(g);
+    return count;
+}
+
+int regroove_render_audio_planar(Regroove* g, float* left, float* right, int frames) {
+    RegrooveOutput out = { NULL, NULL, left, right };
+    int count = render_block(g, &out, frames);
+    publish_state(g);
+    return count;
+}
+
 // --- API functions ---
 
 void regroove_process_commands(Regroove *g) {
     process_commands(g);
+    publish_state(g);
 }
 
 void regroove_pattern_mode(Regroove* g, int on) {
@@ -1126,48 +1358,30 @@ void regroove_queue_order(Regroove* g, int order) {
 }
 void regroove_queue_pattern(Regroove* g, int pattern) {
     if (!g || !g->mod) return;
-    int num_patterns = openmpt_module_get_num_patterns(g->mod);
-    if (pattern >= 0 && pattern < num_patterns) {
+    if (pattern >= 0 && pattern < g->num_patterns) {
         enqueue_command(g, RG_CMD_QUEUE_PATTERN, pattern, 0);
     }
 }
 void regroove_jump_to_order(Regroove* g, int order) {
     if (order >= 0 && order < g->num_orders) {
         // Immediate jump - use JUMP_TO_PATTERN command which jumps immediately
-        int target_order = order;
-        int target_pattern = openmpt_module_get_order_pattern(g->mod, target_order);
-        enqueue_command(g, RG_CMD_JUMP_TO_PATTERN, target_pattern, target_order);
+        enqueue_command(g, RG_CMD_JUMP_TO_PATTERN, -1, order);  // -1 = pattern at order
     }
 }
 void regroove_jump_to_pattern(Regroove* g, int pattern) {
     if (!g || !g->mod) return;
-    // Get total number of patterns to validate input
-    int num_patterns = openmpt_module_get_num_patterns(g->mod);
-    if (pattern >= 0 && pattern < num_patterns) {
+    if (pattern >= 0 && pattern < g->num_patterns) {
         enqueue_command(g, RG_CMD_JUMP_TO_PATTERN, pattern, -1); // -1 = auto-find order
     }
 }
 void regroove_set_position_row(Regroove* g, int row) {
     if (!g || !g->mod) return;
-
-    // Get current order and pattern
-    int current_order = openmpt_module_get_current_order(g->mod);
-    int current_pattern = openmpt_module_get_current_pattern(g->mod);
-    int num_rows = openmpt_module_get_pattern_num_rows(g->mod, current_pattern);
-
-    // Validate row
-    if (row < 0) row = 0;
-    if (row >= num_rows) row = num_rows - 1;
-
-    // Set position immediately (not queued)
-    openmpt_module_set_position_order_row(g->mod, current_order, row);
+    // Set position at the start of the next block (not queued to a boundary)
+    enqueue_command(g, RG_CMD_SET_POSITION_ROW, row, 0);
 }
 void regroove_clear_pending_jump(Regroove* g) {
     if (!g) return;
-    // Clear pending jump state without affecting pattern mode
-    g->pending_pattern_mode_order = -1;
-    g->queued_jump_type = 0;
-    g->has_queued_jump = 0;
+    enqueue_command(g, RG_CMD_CLEAR_PENDING_JUMP, 0, 0);
 }
 // Loop range system
 void regroove_set_loop_range(Regroove* g, int start_order, int start_row, int end_order, int end_row) {
@@ -1175,20 +1389,17 @@ void regroove_set_loop_range(Regroove* g, int start_order, int start_row, int en
 }
 void regroove_get_loop_range(const Regroove* g, int *start_order, int *start_row, int *end_order, int *end_row) {
     if (!g) return;
-    if (start_order) *start_order = g->loop_start_order;
-    if (start_row) *start_row = g->loop_start_row;
-    if (end_order) *end_order = g->loop_end_order;
-    if (end_row) *end_row = g->loop_end_row;
+    RegroovePublishedState p = published_state(g);
+    if (start_order) *start_order = p.loop_start_order;
+    if (start_row) *start_row = p.loop_start_row;
+    if (end_order) *end_order = p.loop_end_order;
+    if (end_row) *end_row = p.loop_end_row;
 }
 void regroove_set_loop_start_here(Regroove* g) {
-    int cur_order = openmpt_module_get_current_order(g->mod);
-    int cur_row = openmpt_module_get_current_row(g->mod);
-    enqueue_command_range(g, RG_CMD_SET_LOOP_RANGE, cur_order, cur_row, g->loop_end_order, g->loop_end_row);
+    enqueue_command(g, RG_CMD_SET_LOOP_START_HERE, 0, 0);
 }
 void regroove_set_loop_end_here(Regroove* g) {
-    int cur_order = openmpt_module_get_current_order(g->mod);
-    int cur_row = openmpt_module_get_current_row(g->mod);
-    enqueue_command_range(g, RG_CMD_SET_LOOP_RANGE, g->loop_start_order, g->loop_start_row, cur_order, cur_row);
+    enqueue_command(g, RG_CMD_SET_LOOP_END_HERE, 0, 0);
 }
 void regroove_trigger_loop(Regroove* g) {
     enqueue_command(g, RG_CMD_TRIGGER_LOOP, 0, 0);
@@ -1197,7 +1408,7 @@ void regroove_play_to_loop(Regroove* g) {
     enqueue_command(g, RG_CMD_PLAY_TO_LOOP, 0, 0);
 }
 int regroove_get_loop_state(const Regroove* g) {
-    return g ? g->loop_range_enabled : 0;
+    return g ? published_state(g).state.loop_state : 0;
 }
 
 void regroove_retrigger_pattern(Regroove* g) {
@@ -1209,7 +1420,6 @@ void regroove_set_custom_loop_rows(Regroove* g, int rows) {
 
 void regroove_toggle_channel_mute(Regroove *g, int ch) {
     enqueue_command(g, RG_CMD_TOGGLE_CHANNEL_MUTE, ch, 0);
-    process_commands(g);
 }
 
 void regroove_queue_channel_mute(Regroove *g, int ch) {
@@ -1230,7 +1440,7 @@ void regroove_set_channel_volume(Regroove *g, int ch, double vol) {
 
 double regroove_get_channel_volume(const Regroove* g, int ch) {
     if (!g || ch < 0 || ch >= g->num_channels) return 0.0;
-    return g->channel_volumes[ch];
+    return published_channel(g, ch).volume;
 }
 
 void regroove_set_channel_panning(Regroove *g, int ch, double pan) {
@@ -1239,7 +1449,7 @@ void regroove_set_channel_panning(Regroove *g, int ch, double pan) {
 
 double regroove_get_channel_panning(const Regroove* g, int ch) {
     if (!g || ch < 0 || ch >= g->num_channels) return 0.5;
-    return g->channel_pannings[ch];
+    return published_channel(g, ch).panning;
 }
 
 void regroove_mute_all(Regroove* g) {
@@ -1256,14 +1466,12 @@ void regroove_set_interpolation_filter(Regroove* g, int filter) {
     if (!g || !g->mod) return;
     // Validate filter value: 0, 1, 2, or 4
     if (filter != 0 && filter != 1 && filter != 2 && filter != 4) return;
-    g->interpolation_filter = filter;
-    // OPENMPT_MODULE_RENDER_INTERPOLATIONFILTER_LENGTH = 3
-    openmpt_module_set_render_param(g->mod, 3, filter);
+    enqueue_command(g, RG_CMD_SET_INTERPOLATION_FILTER, filter, 0);
 }
 
 int regroove_get_interpolation_filter(const Regroove* g) {
     if (!g) return 1;  // Default to linear
-    return g->interpolation_filter;
+    return published_state(g).interpolation_filter;
 }
 
 void regroove_set_stereo_separation(Regroove* g, int separation) {
@@ -1271,126 +1479,118 @@ void regroove_set_stereo_separation(Regroove* g, int separation) {
     // Clamp to valid range 0-200
     if (separation < 0) separation = 0;
     if (separation > 200) separation = 200;
-    g->stereo_separation = separation;
-    // OPENMPT_MODULE_RENDER_STEREOSEPARATION_PERCENT = 2
-    openmpt_module_set_render_param(g->mod, 2, separation);
+    enqueue_command(g, RG_CMD_SET_STEREO_SEPARATION, separation, 0);
 }
 
 int regroove_get_stereo_separation(const Regroove* g) {
     if (!g) return 100;  // Default
-    return g->stereo_separation;
+    return published_state(g).stereo_separation;
 }
 
 void regroove_set_dither(Regroove* g, int dither) {
     if (!g || !g->mod) return;
     // Validate dither value: 0-3
     if (dither < 0 || dither > 3) return;
-    g->dither = dither;
-    openmpt_module_ctl_set_integer(g->mod, "dither", dither);
+    enqueue_command(g, RG_CMD_SET_DITHER, dither, 0);
 }
 
 int regroove_get_dither(const Regroove* g) {
     if (!g) return 1;  // Default to library default
-    return g->dither;
+    return published_state(g).dither;
 }
 
 void regroove_set_amiga_resampler(Regroove* g, int enabled) {
     if (!g || !g->mod) return;
-    g->amiga_resampler = enabled ? 1 : 0;
-    openmpt_module_ctl_set_boolean(g->mod, "render.resampler.emulate_amiga", enabled);
+    enqueue_command(g, RG_CMD_SET_AMIGA_RESAMPLER, enabled ? 1 : 0, 0);
 }
 
 int regroove_get_amiga_resampler(const Regroove* g) {
     if (!g) return 0;  // Default to disabled
-    return g->amiga_resampler;
+    return published_state(g).amiga_resampler;
 }
 
 void regroove_set_amiga_filter_type(Regroove* g, int filter_type) {
     if (!g || !g->mod) return;
     // Validate filter type: 0-3
     if (filter_type < 0 || filter_type > 3) return;
-    g->amiga_filter_type = filter_type;
-    const char* amiga_filter_names[] = {"auto", "a500", "a1200", "unfiltered"};
-    openmpt_module_ctl_set_text(g->mod, "render.resampler.emulate_amiga_type", amiga_filter_names[filter_type]);
+    enqueue_command(g, RG_CMD_SET_AMIGA_FILTER_TYPE, filter_type, 0);
 }
 
 int regroove_get_amiga_filter_type(const Regroove* g) {
     if (!g) return 0;  // Default to auto
-    return g->amiga_filter_type;
+    return published_state(g).amiga_filter_type;
 }
 
 // --- Info getters ---
+// Playback state comes from the snapshot the audio thread publishes after
+// every block (see publish_state), so these are safe to call from any thread.
 int regroove_get_num_orders(const Regroove* g) { return g->num_orders; }
-int regroove_get_num_patterns(const Regroove* g) {
-    if (!g || !g->mod) return 0;
-    return openmpt_module_get_num_patterns(g->mod);
-}
+int regroove_get_num_patterns(const Regroove* g) { return g ? g->num_patterns : 0; }
 int regroove_get_order_pattern(const Regroove* g, int order) {
     if (!g || !g->mod) return -1;
     return openmpt_module_get_order_pattern(g->mod, order);
 }
-int regroove_get_current_order(const Regroove* g) { return openmpt_module_get_current_order(g->mod); }
-int regroove_get_current_pattern(const Regroove* g) { return openmpt_module_get_current_pattern(g->mod); }
-int regroove_get_current_row(const Regroove* g) { return openmpt_module_get_current_row(g->mod); }
+int regroove_get_current_order(const Regroove* g) { return published_state(g).state.order; }
+int regroove_get_current_pattern(const Regroove* g) { return published_state(g).state.pattern; }
+int regroove_get_current_row(const Regroove* g) { return published_state(g).state.row; }
 int regroove_get_num_channels(const Regroove* g) { return g ? g->num_channels : 0; }
-double regroove_get_pitch(const Regroove* g) { return g ? g->pitch_factor : 1.0; }
+double regroove_get_pitch(const Regroove* g) { return g ? published_state(g).state.pitch : 1.0; }
 int regroove_is_channel_muted(const Regroove* g, int ch) {
     if (!g || ch < 0 || ch >= g->num_channels) return 0;
-    return g->mute_states[ch];
+    return published_channel(g, ch).muted;
 }
 int regroove_has_pending_mute_changes(const Regroove *g) {
-    return g ? g->has_pending_mute_changes : 0;
+    return g ? published_state(g).has_pending_mute_changes : 0;
 }
 int regroove_get_pending_channel_mute(const Regroove *g, int ch) {
     if (!g || ch < 0 || ch >= g->num_channels) return 0;
-    if (!g->pending_mute_states) return g->mute_states[ch];  // No pending changes, return current state
-    return g->pending_mute_states[ch];
+    return published_channel(g, ch).pending_muted;  // Current state if no changes are pending
 }
 int regroove_get_queued_action_for_channel(const Regroove *g, int ch) {
-    if (!g || ch < 0 || ch >= g->num_channels || !g->queued_action_per_channel) return 0;
-    return g->queued_action_per_channel[ch];
+    if (!g || ch < 0 || ch >= g->num_channels) return 0;
+    return published_channel(g, ch).queued_action;
 }
 int regroove_get_queued_jump_type(const Regroove *g) {
-    return g ? g->queued_jump_type : 0;
+    return g ? published_state(g).state.queued_jump_type : 0;
 }
 int regroove_get_queued_order(const Regroove *g) {
-    if (!g) return -1;
-    // In pattern mode, queued order is stored in pending_pattern_mode_order
-    if (g->pattern_mode && g->queued_jump_type > 0) {
-        return g->pending_pattern_mode_order;
-    }
-    return g->queued_order;
+    return g ? published_state(g).queued_order : -1;
 }
-int regroove_get_pattern_mode(const Regroove* g) { return g->pattern_mode; }
-int regroove_get_custom_loop_rows(const Regroove* g) { return g->custom_loop_rows; }
-int regroove_get_full_pattern_rows(const Regroove* g) { return g->full_loop_rows; }
+int regroove_get_pattern_mode(const Regroove* g) { return published_state(g).state.pattern_mode; }
+int regroove_get_custom_loop_rows(const Regroove* g) { return published_state(g).custom_loop_rows; }
+int regroove_get_full_pattern_rows(const Regroove* g) { return published_state(g).full_loop_rows; }
 int regroove_get_pattern_num_rows(const Regroove* g, int pattern) {
     if (!g || !g->mod) return 0;
     return openmpt_module_get_pattern_num_rows(g->mod, pattern);
 }
 double regroove_get_current_bpm(const Regroove* g) {
     if (!g || !g->mod) return 0.0;
-    // Use tempo2 instead of estimated_bpm to get the actual tempo value
-    // estimated_bpm accounts for speed (ticks/row) which makes MIDI Clock timing wrong
-    // MIDI Clock should represent the musical tempo, not the effective playback speed
-    return openmpt_module_get_current_tempo2(g->mod);
+    return published_state(g).state.bpm;
 }
 
 double regroove_get_effective_bpm(const Regroove* g) {
     if (!g || !g->mod) return 0.0;
-    // Get the base BPM from the module
-    double base_bpm = openmpt_module_get_current_tempo2(g->mod);
+    RegrooveState state = published_state(g).state;
     // Apply pitch adjustment: effective_bpm = base_bpm / pitch
     // (Higher pitch = faster playback = lower effective BPM)
-    if (g->pitch_factor > 0.0) {
-        return base_bpm / g->pitch_factor;
+    if (state.pitch > 0.0) {
+        return state.bpm / state.pitch;
     }
-    return base_bpm;
+    return state.bpm;
 }
 
 int regroove_get_current_speed(const Regroove* g) {
     if (!g || !g->mod) return 6;  // Default to 6 ticks/row
-    return openmpt_module_get_current_speed(g->mod);
+    return published_state(g).state.speed;
+}
+
+void regroove_get_state(const Regroove *g, RegrooveState *state) {
+    if (!g || !state) return;
+    *state = published_state(g).state;
+}
+
+unsigned int regroove_get_dropped_commands(const Regroove *g) {
+    return g ? __atomic_load_n(&g->dropped_commands, __ATOMIC_RELAXED) : 0;
 }
 
 int regroove_get_pattern_cell(const Regroove *g, int pattern, int row, int channel, char *buffer, size_t buffer_size) {
@@ -24,6 +24,19 @@ typedef enum {
     RG_PATTERN_MODE_SINGLE = 1   // Loop current pattern indefinitely
 } RegroovePatternMode;
 
+// Playback state as of the last rendered block (see regroove_get_state)
+typedef struct {
+    int order;
+    int pattern;
+    int row;
+    int speed;              // Ticks per row
+    double bpm;             // Module BPM (before pitch adjustment)
+    double pitch;
+    int pattern_mode;
+    int loop_state;         // RegrooveLoopState
+    int queued_jump_type;   // 0=none, 1=next, 2=prev, 3=order, 4=pattern
+} RegrooveState;
+
 // --- Optional UI callback types ---
 typedef void (*RegrooveOrderCallback)(int order, int pattern, void *userdata);
 typedef void (*RegrooveRowCallback)(int order, int row, void *userdata);
@@ -57,9 +70,21 @@ void regroove_destroy(Regroove *g);
 void regroove_set_callbacks(Regroove *g, struct RegrooveCallbacks *cb);
 
 // Rendering
-int regroove_render_audio(Regroove *g, int16_t *buffer, int frames);
+// Runs queued commands, renders, then publishes the playback state the
+// getters report. Call from one (audio) thread.
+// Returns the number of frames rendered (less than frames at the song end)
+int regroove_render_audio(Regroove *g, int16_t *buffer, int frames);          // Interleaved stereo int16
+int regroove_render_audio_float(Regroove *g, float *buffer, int frames);      // Interleaved stereo float
+int regroove_render_audio_planar(Regroove *g, float *left, float *right, int frames);
+// The float versions are not dithered and keep libopenmpt's headroom
+// (samples may exceed -1.0..1.0).
 
 // User commands (to be called from main loop or UI)
+// Commands go through a lock-free queue that any number of threads may push
+// to, and take effect at the start of the next rendered block. Commands that
+// find the queue full are dropped (see regroove_get_dropped_commands).
+// regroove_process_commands() runs them right away; only call it from the
+// thread that renders, or while nothing renders.
 void regroove_process_commands(Regroove *g);
 void regroove_pattern_mode(Regroove *g, int on);
 void regroove_queue_next_order(Regroove *g);
@@ -95,6 +120,9 @@ double regroove_get_channel_panning(const Regroove* g, int ch);
 
 void regroove_set_pitch(Regroove *g, double pitch);
 
+// Render settings are queued like the controls above; the getters report
+// them once the audio thread has applied them (after the next block)
+
 // Interpolation filter control
 // filter: 0 = none, 1 = linear, 2 = cubic, 4 = FIR (high quality)
 void regroove_set_interpolation_filter(Regroove *g, int filter);
@@ -119,6 +147,9 @@ void regroove_set_amiga_filter_type(Regroove *g, int filter_type);
 int regroove_get_amiga_filter_type(const Regroove *g);
 
 // State queries
+// Playback state, mutes and volumes are read from the state published after
+// each rendered block, so they can be called from any thread and reflect
+// commands once a block has run them.
 int regroove_get_num_orders(const Regroove *g);
 int regroove_get_num_patterns(const Regroove *g);
 int regroove_get_order_pattern(const Regroove *g, int order);
@@ -141,6 +172,12 @@ double regroove_get_current_bpm(const Regroove *g);  // Get module's base BPM (b
 double regroove_get_effective_bpm(const Regroove *g);  // Get effective playback BPM (after pitch adjustment)
 int regroove_get_current_speed(const Regroove *g);  // Get current speed (ticks per row)
 
+// Consistent copy of the playback state as of the last rendered block
+void regroove_get_state(const Regroove *g, RegrooveState *state);
+
+// Commands dropped because the command queue was full
+unsigned int regroove_get_dropped_commands(const Regroove *g);
+
 // Get formatted pattern cell data (note, instrument, volume, effects)
 // Returns 0 on success, -1 on error
 // buffer should be at least 32 bytes
@@ -167,8 +204,10 @@ const char* regroove_get_sample_name(const Regroove *g, int index);
 // Unified position getter (compatible with regroove_controller API)
 static inline void regroove_get_position(const Regroove *g, int *order, int *row) {
     if (!g) return;
-    if (order) *order = regroove_get_current_order(g);
-    if (row) *row = regroove_get_current_row(g);
+    RegrooveState state;
+    regroove_get_state(g, &state);
+    if (order) *order = state.order;
+    if (row) *row = state.row;
 }
 
 // Unified immediate jump (compatible with regroove_controller API)
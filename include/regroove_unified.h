@@ -224,6 +224,8 @@ static inline uint16_t rg_get_current_row(const RegrooveHandle* h) {
  * - regroove_controller_get_sequencer() - access underlying sequencer
  * - Extended callback system (on_loop_state_change, on_command_executed, etc.)
  * - regroove_controller_clear_queue() - clear queued commands
+ * - regroove_controller_schedule() / poll_report() - quantized commands from
+ *   any thread, with scheduled/executed sample times reported back
  *
  * When using the unified API, only use the common subset documented above.
  * For implementation-specific features, use the native API directly.
@@ -18,6 +18,7 @@ UCSRC += /rfx/data/rg1piano/sample_data.c
 # Path to synth components
 UCSRC += /rfx/synth/synth_sample_player.c
 UCSRC += /rfx/synth/synth_modal_piano.c
+UCSRC += /rfx/synth/synth_modal_bank.c
 
 # C++ sources
 UCXXSRC = unit.cc
@@ -12,6 +12,8 @@
 #include "ahx_player.h"
 #include "../synth/ahx_synth_core.h"
 #include "../synth/ahx_plist.h"
+#include "../synth/ahx_waves.h"
+#include "../effects/fx_paula_blep.h"
 #include "tracker_modulator.h"
 #include "tracker_sequence.h"
 #include "tracker_voice.h"
@@ -29,6 +31,9 @@
 #define MAX(a, b) (((a) > (b)) ? (a) : (b))
 #define CLAMP(x, low, high) (((x) > (high)) ? (high) : (((x) < (low)) ? (low) : (x)))
 
+// Frames per voice block summed into the bus by tracker_voice_mix_blocks()
+#define AHX_MIX_BLOCK 256
+
 // Forward declarations
 typedef struct AhxPListEntry AhxPListEntry;
 typedef struct AhxPList AhxPList;
@@ -38,7 +43,6 @@ typedef struct AhxPosition AhxPosition;
 typedef struct AhxStep AhxStep;
 typedef struct AhxSong AhxSong;
 typedef struct AhxVoice AhxVoice;
-typedef struct AhxWaves AhxWaves;
 
 // Forward declarations for callbacks
 static void ahx_on_frame(void* user_data, uint8_t frame);
@@ -134,7 +138,7 @@ struct AhxVoice {
     AhxPList* PerfList;
     int NoteDelayWait, NoteDelayOn, NoteCutWait, NoteCutOn;
     int16_t* AudioPointer;
-    int16_t* AudioSource;
+    const int16_t* AudioSource;
     int AudioPeriod, AudioVolume;
     int16_t SquareTempBuffer[0x80];
 
@@ -145,20 +149,10 @@ struct AhxVoice {
     int WNRandom;
 };
 
-struct AhxWaves {
-    int16_t LowPasses[(0xfc+0xfc+0x80*0x1f+0x80+3*0x280)*31];
-    int16_t Triangle04[0x04], Triangle08[0x08], Triangle10[0x10], Triangle20[0x20], Triangle40[0x40], Triangle80[0x80];
-    int16_t Sawtooth04[0x04], Sawtooth08[0x08], Sawtooth10[0x10], Sawtooth20[0x20], Sawtooth40[0x40], Sawtooth80[0x80];
-    int16_t Squares[0x80*0x20];
-    int16_t WhiteNoiseBig[0x280*3];
-    int16_t HighPasses[(0xfc+0xfc+0x80*0x1f+0x80+3*0x280)*31];
-};
-
 struct AhxPlayer {
     AhxSong Song;
     AhxVoice Voices[4];
-    AhxWaves* Waves;
-    int OurWaves;
+    const AhxWaves* Waves;  // Shared, read-only (ahx_waves_acquire)
 
     // Pattern sequencer (NEW - handles timing/position/flow control)
     PatternSequencer* sequencer;
@@ -170,7 +164,7 @@ struct AhxPlayer {
     int PosNr, PosJump;
     int NoteNr, PosJumpNote;
     int PlayingTime;
-    int16_t* WaveformTab[4];
+    const int16_t* WaveformTab[4];
 
     // Mixing state
     int VolumeTable[65][256];  // Kept for compatibility but not used in HVL mode
@@ -197,6 +191,13 @@ struct AhxPlayer {
 
     // Sample rate for delta calculation
     int current_sample_rate;
+
+    // Waveform interpolation
+    TrackerInterpolation interpolation;
+
+    // Paula BLEP output (one per voice, all NULL when off)
+    FXPaulaBlep* paula[4];
+    uint32_t paula_clock_acc;  // Paula clocks left over, in 1/sample_rate units
 };
 
 // Vibrato table (from AHX.cpp line 30)
@@ -219,130 +220,6 @@ static const int PeriodTable[61] = {
     0x008F, 0x0087, 0x007F, 0x0078, 0x0071
 };
 
-// White noise table (from AHX.cpp line 61)
-static const unsigned char WhiteNoiseBig[] = {
-    0x7f,0x7f,0xa8,0xe2,0x78,0x3e,0x2c,0x92,0x52,0xd5,0x80,0x80,0xab,0x80,0x7f,0x37,
-    0x7f,0x7f,0x15,0x3b,0xbc,0x66,0xf3,0x7f,0x80,0x80,0x80,0x80,0x42,0xe5,0xf8,0x80,
-    0x7f,0x7f,0x26,0x7f,0x80,0x97,0x80,0x5f,0xa7,0x7f,0x80,0x80,0x80,0x7f,0x7f,0x7f,
-    0xce,0x79,0x8c,0x80,0x4a,0x7f,0x80,0x16,0x7f,0x7f,0x80,0x80,0x09,0xf1,0x80,0x95,
-    0x78,0x78,0x7f,0xb8,0xe2,0x52,0x7f,0x08,0x93,0x7f,0x7f,0x80,0xfb,0xa8,0x44,0xe5,
-    0xca,0x09,0x7f,0x80,0x7f,0x80,0xcb,0x80,0x7f,0xf7,0x80,0x80,0xb7,0x7f,0x5b,0x80,
-    0x3b,0x14,0xcf,0x80,0x7f,0x80,0x16,0x1f,0x67,0xa1,0x62,0x71,0x71,0xa7,0x7f,0x44,
-    0x41,0x80,0x7f,0xcd,0x41,0x43,0x4b,0xf3,0x80,0xc7,0xdf,0xdf,0xd5,0x27,0x1f,0x1f,
-    0x9f,0x36,0x24,0x73,0x71,0x7f,0x80,0x7f,0x79,0x42,0x7f,0x7f,0x80,0x80,0x80,0x2e,
-    0x22,0x7f,0xf2,0x46,0x80,0x80,0xb4,0xd2,0x35,0x2e,0x80,0x8f,0xb5,0xbc,0x80,0x38,
-    0xf2,0x7f,0x10,0x2d,0x7f,0x7f,0x26,0x91,0x7f,0xf0,0x7f,0xdf,0x2b,0x7f,0x80,0x3e,
-    0x7f,0x7f,0x80,0x80,0xab,0xae,0x7f,0xca,0x80,0x80,0xf3,0xba,0x34,0x80,0x80,0x7f,
-    0x7f,0x80,0x3e,0x66,0x80,0x17,0x80,0xab,0x80,0x09,0xf3,0x7f,0x29,0x80,0xc4,0x7f,
-    0x80,0xd3,0x7f,0xba,0x80,0x7f,0x80,0x9d,0x7f,0x80,0x38,0x80,0x7f,0x7f,0x7f,0x69,
-    0x7f,0x7f,0x15,0x4f,0x80,0x7c,0x8c,0x1b,0x7f,0x7f,0x80,0x80,0x70,0x2b,0x80,0x7f,
-    0x5a,0xc1,0x7f,0x80,0x7f,0x45,0xbb,0x80,0x7f,0xf7,0xce,0x80,0x80,0x80,0xda,0x9d,
-    0x7f,0x80,0x7f,0xba,0xe2,0x02,0x80,0x95,0xba,0x80,0xfa,0xfe,0x80,0xb4,0x80,0x80,
-    0x88,0x7f,0x7f,0x12,0x80,0x80,0x0e,0x9b,0x80,0x80,0x4f,0xc9,0x2b,0x80,0x77,0xb5,
-    0x7f,0x51,0x7f,0x7f,0x7f,0x7f,0x80,0x7f,0xf1,0x80,0x31,0xe6,0x80,0x7f,0x80,0xa5,
-    0x80,0x7f,0xca,0x7f,0x25,0x80,0x92,0xb4,0x7f,0x80,0x97,0x7f,0x7f,0x94,0x20,0x1b,
-    0x3b,0x7f,0xee,0xca,0x80,0x80,0x42,0x80,0x80,0xa3,0x80,0xc5,0xf1,0x80,0x7f,0x7f,
-    0x7f,0x51,0xaf,0x7f,0x35,0x42,0x80,0x7f,0xf1,0x80,0xc5,0x7f,0x7f,0x7f,0x80,0x28,
-    0x7f,0xb3,0x2c,0x2c,0xea,0x7f,0x7f,0x80,0x7f,0x21,0xa9,0x7f,0x34,0x7f,0xae,0x1e,
-    0xc5,0xbf,0xae,0x7f,0x8b,0x37,0x7f,0x0d,0x80,0x73,0x23,0xbb,0x80,0x80,0xc6,0x80,
-    0xb6,0x80,0x7f,0x80,0x80,0x7f,0x7f,0x80,0x21,0x7f,0x20,0x45,0xa7,0xca,0x7f,0x80,
-    0x80,0x80,0x3d,0x7f,0x15,0x45,0xf3,0xd8,0x8b,0x9b,0xce,0x55,0x80,0x80,0x7f,0xbd,
-    0xce,0x7f,0x36,0x80,0x7f,0xbf,0x62,0x23,0x07,0x25,0xf1,0xca,0x59,0x7f,0xaa,0x7f,
-    0x7f,0x47,0x93,0x80,0x1b,0x21,0x80,0x9b,0xca,0x80,0x2d,0x80,0x98,0x7f,0x7f,0x7f,
-    0xee,0x80,0x80,0x80,0x7f,0x20,0x3b,0x80,0x3c,0x22,0xcf,0x7f,0x80,0x80,0x59,0x9d,
-    0x7f,0x2a,0x7f,0x80,0x7c,0x80,0xd3,0x21,0x80,0xa7,0x7f,0x7f,0x80,0x09,0x3d,0x7f,
-    0x7f,0xae,0x80,0xa7,0x80,0x7f,0x73,0x05,0x3d,0x80,0x7f,0x7f,0x7f,0x26,0x3b,0x7f,
-    0xf6,0x80,0x7f,0x5e,0x47,0xdf,0x80,0x7c,0x36,0x36,0x7f,0xff,0xbc,0xbc,0xbc,0x7f,
-    0x7f,0x7f,0x80,0x80,0x4d,0x21,0x7f,0x7f,0x7f,0x41,0x4d,0x80,0x7f,0x7f,0x80,0xc0,
-    0xaf,0x2c,0x7f,0x17,0x35,0x80,0x80,0x7f,0xf0,0x3c,0x12,0x87,0x7f,0x80,0x80,0x13,
-    0x73,0x2d,0x3e,0x80,0x7f,0x80,0xa6,0xd8,0x19,0x80,0x7f,0x27,0x80,0x7f,0x80,0x7f,
-    0x80,0x7f,0x23,0x80,0x4d,0x80,0x7f,0x7f,0x89,0x7f,0x80,0xb5,0x4a,0x17,0xaf,0x88,
-    0x95,0x80,0x70,0x77,0x97,0x7f,0x80,0x80,0x22,0x9b,0x02,0x2f,0x80,0x80,0x98,0x7f,
-    0x7f,0x12,0x2d,0x28,0xce,0xaf,0x90,0x58,0xe9,0x1a,0x71,0x2f,0x5c,0x7f,0x80,0x7f,
-    0x7f,0x80,0x7f,0x47,0xcd,0xaf,0x2c,0x06,0x80,0x2f,0x80,0xe8,0x80,0x2e,0x58,0x11,
-    0xd7,0xad,0x58,0x43,0x17,0x9f,0x70,0xc3,0x80,0x70,0x19,0xc3,0x37,0x2e,0x42,0x80,
-    0x2c,0xbc,0x80,0x7f,0x7f,0x7f,0x10,0x45,0x2d,0x3e,0x3e,0x90,0x80,0xa6,0xd8,0x5b,
-    0x80,0x7f,0x27,0x80,0x7f,0x80,0x33,0x80,0x75,0x80,0x7f,0x7f,0x94,0x80,0x21,0xf1,
-    0x7f,0xee,0x7f,0xae,0xf6,0xae,0x80,0x41,0x80,0xa5,0x7f,0x40,0x7f,0x8a,0x3d,0x12,
-    0xdd,0x7f,0x9e,0x7f,0x92,0x36,0x66,0x19,0x80,0x80,0xa7,0xa0,0x90,0x80,0x5f,0x23,
-    0x57,0x80,0x31,0x80,0x2d,0x36,0xa0,0xd2,0x8f,0xd9,0x3f,0x80,0x3e,0x80,0x29,0xd8,
-    0xad,0x7f,0x7f,0x51,0xbb,0x70,0xcb,0xb5,0xdc,0x3d,0xc2,0xb7,0x7f,0xba,0x80,0x3e,
-    0x80,0x7f,0x3b,0x44,0x80,0xa6,0x7f,0x80,0x80,0x7c,0x80,0x61,0x7f,0xca,0x7f,0x7f,
-    0x80,0xff,0x34,0x7f,0x46,0x05,0x7f,0x24,0x7f,0x7f,0x7f,0x7f,0xbc,0x7f,0x7f,0x7f,
-    0x80,0x7f,0x15,0x7f,0xce,0xe5,0x7f,0x80,0x7f,0xbd,0x58,0x85,0x33,0x7f,0x7e,0x80,
-    0x80,0x80,0x7f,0x7f,0x80,0x7f,0xf7,0x32,0x94,0x40,0x73,0x7f,0x7f,0xee,0xdc,0x7f,
-    0x24,0x7f,0x7f,0xba,0xc6,0x27,0x21,0x95,0x80,0x3d,0xa4,0x80,0x7f,0x7f,0x80,0x7f,
-    0x7f,0x94,0x7f,0x7f,0x94,0x80,0x61,0x7f,0x80,0x7f,0x7f,0x79,0x80,0x42,0x7f,0xbe,
-    0x80,0x80,0xc2,0x43,0xf7,0xac,0xac,0x80,0x7f,0x7f,0x7f,0x80,0x14,0x7f,0x15,0x7f,
-    0xc2,0x1d,0x7f,0x80,0x7f,0xbb,0x80,0x80,0x80,0x80,0xb6,0x7f,0x7f,0x44,0x7f,0x09,
-    0x07,0x80,0x7f,0x80,0x7f,0x7f,0x96,0x7f,0xce,0x80,0x80,0x61,0x65,0x80,0x2d,0x4a,
-    0x7f,0x7f,0x80,0x7f,0x46,0x80,0x7f,0xaa,0x44,0x80,0xcb,0x89,0x7f,0x80,0x7f,0x80,
-    0x7f,0x8e,0x9f,0x80,0xc3,0x43,0x71,0x99,0x80,0x7f,0x47,0x41,0xaf,0x80,0x3b,0xb6,
-    0x7f,0x72,0x80,0xd1,0x80,0x7f,0x44,0x80,0x2f,0x7f,0x7f,0x42,0x80,0x7f,0xf0,0x7f,
-    0x45,0x7f,0x80,0x7f,0x80,0xc0,0xaf,0x7f,0x9c,0x1e,0x35,0x7f,0xca,0x65,0xf1,0x3c,
-    0x92,0xb4,0xa0,0x80,0x7f,0x7f,0x0f,0xd7,0x73,0x80,0x0e,0x80,0x7f,0x80,0x7c,0xca,
-    0xc7,0xad,0x80,0x80,0x3d,0x9e,0xf0,0x82,0x8d,0xd9,0x19,0x7f,0x93,0x7f,0x80,0x80,
-    0x80,0x98,0x80,0x80,0x7f,0x3b,0x28,0xce,0x09,0x7f,0x5e,0xe9,0x80,0x80,0x7f,0x45,
-    0x80,0xfa,0x7f,0x7f,0x80,0x7f,0x80,0x7f,0x7f,0x11,0x80,0xb4,0x2c,0x80,0x13,0x7f,
-    0x80,0x80,0xc5,0x7f,0x7f,0xee,0x82,0x80,0x80,0x41,0x80,0x11,0x7f,0x80,0xc1,0x7f,
-    0xad,0x7f,0x7f,0x7f,0x81,0xf1,0x80,0x31,0xa0,0x80,0x7f,0x7f,0x25,0x57,0x7f,0xc4,
-    0x80,0x2d,0x36,0x7f,0xbd,0x80,0xd9,0x7f,0xbb,0x7f,0x80,0x2f,0x7f,0x36,0x80,0x3e,
-    0x58,0x80,0x80,0x41,0x5f,0x80,0x22,0x80,0x80,0xcc,0x7f,0x7f,0x24,0xc5,0x29,0xe6,
-    0xc4,0x7f,0x80,0xd1,0x80,0x3a,0x0c,0xa1,0x80,0xb7,0x7f,0xbe,0x80,0x14,0x95,0x80,
-    0xf3,0x7f,0x89,0x80,0xc1,0x7f,0x80,0x7f,0x7f,0xa8,0x1e,0xc3,0x43,0x21,0x80,0x80,
-    0x7f,0x47,0xcd,0x7b,0x80,0x3b,0x80,0x7f,0x25,0x80,0xd1,0x27,0x89,0x7f,0x80,0x28,
-    0xa4,0x90,0x7f,0x59,0x7f,0x24,0x7f,0xb1,0x5c,0x7f,0xbf,0x7f,0x7f,0x80,0x16,0x80,
-    0xdb,0x80,0x7f,0x80,0x7f,0x7f,0xf5,0xb2,0x7f,0x7f,0x80,0x7f,0x0f,0x80,0x80,0x80,
-    0x77,0x80,0x2e,0x80,0x3c,0xa0,0x7f,0x2b,0x7f,0x68,0x80,0xc0,0x7f,0x7f,0x7f,0x10,
-    0xb5,0x7f,0xca,0x11,0x91,0x80,0x95,0x7f,0x7f,0x7f,0x7f,0x80,0x80,0xcb,0x80,0x7f,
-    0x81,0x7f,0xac,0xaa,0x7f,0x7f,0x80,0x93,0x3a,0xc0,0x80,0x80,0x98,0x52,0x80,0x7f,
-    0xe1,0xa8,0xdc,0x85,0xb3,0x76,0x7f,0xba,0x80,0x7f,0xa3,0x80,0xb4,0x80,0xc6,0x21,
-    0x7f,0x0f,0x7f,0x7f,0x80,0x09,0x7f,0x7f,0x7f,0xa1,0xf8,0x7f,0xa3,0x7f,0x26,0x80,
-    0xc3,0x80,0x41,0x2b,0x7f,0x7f,0x80,0xc1,0x55,0x7f,0x7f,0x7f,0xaf,0x80,0x80,0x80,
-    0x31,0x80,0x7f,0x7f,0xbf,0x52,0x39,0x66,0x73,0xf7,0x5c,0xe9,0x80,0x7f,0x7f,0x42,
-    0x55,0x80,0x80,0x92,0x7f,0x7f,0x80,0x97,0x7f,0x15,0x80,0x23,0x1b,0xbb,0x9a,0x80,
-    0x80,0x80,0xb6,0x28,0xbe,0x80,0x7f,0x0f,0xeb,0xf0,0x80,0x5f,0xc9,0x21,0x6b,0x7f,
-    0x4c,0x80,0x7f,0xad,0xc4,0xc1,0x7f,0x96,0x7f,0x7f,0xaf,0x7f,0xe1,0x9e,0x80,0x7f,
-    0xb3,0xf6,0x80,0x80,0x80,0x80,0xab,0xf0,0x80,0x80,0xfa,0x3a,0x7f,0x80,0x80,0x89,
-    0x7f,0x08,0x7f,0x80,0x7f,0x80,0xfa,0x44,0x8f,0x09,0x7f,0x80,0x7f,0x80,0x80,0x22,
-    0x9b,0x7f,0xb8,0x80,0x7f,0x7f,0x80,0x7f,0x15,0x2d,0x7f,0x7f,0x7f,0x95,0x58,0x93,
-    0x7f,0xf0,0xe2,0xdc,0x7f,0x15,0x7f,0x80,0x7f,0x81,0x7f,0xf2,0x94,0x80,0x80,0x7f,
-    0x80,0x7f,0xce,0x80,0x80,0x80,0x80,0x80,0x9b,0x80,0x3f,0xa2,0x80,0x98,0x02,0x7f,
-    0x20,0x29,0xa8,0x78,0x7f,0x44,0x69,0x11,0x7f,0xca,0x41,0x4d,0x17,0x7f,0x7f,0x80,
-    0x80,0x70,0xf7,0x7f,0xfc,0x80,0x80,0x7f,0xce,0x7f,0x80,0x80,0x4a,0x1d,0x80,0x4d,
-    0x7f,0x80,0x7f,0xf2,0x80,0xfe,0x80,0x80,0xec,0x62,0x7f,0x7f,0xff,0x80,0xcb,0x80,
-    0x7f,0x80,0xc0,0x7f,0x80,0x4e,0x21,0x35,0x0c,0xaf,0xb2,0x7f,0x80,0x3e,0xf0,0x96,
-    0xac,0x7f,0x2b,0xea,0x80,0x80,0x80,0x80,0xa0,0x7f,0x44,0x7f,0x7f,0x6d,0xc7,0x7f,
-    0x24,0x80,0x2a,0x7f,0x80,0x3c,0x80,0xec,0x7f,0x80,0xe8,0x80,0xa4,0x2a,0x3e,0x56,
-    0x80,0x80,0xd3,0xdb,0xb5,0xc0,0x80,0x7f,0xaf,0x14,0x35,0x80,0x38,0x7f,0x96,0x7f,
-    0x7f,0x68,0x7f,0x7f,0x41,0x7f,0x44,0x7f,0x80,0xc7,0xc7,0x80,0x80,0x80,0x14,0x80,
-    0x7f,0x7f,0xdc,0x1d,0x7f,0x7f,0x7f,0xbf,0x80,0x5c,0x80,0x77,0xf7,0xc0,0xc1,0x80,
-    0x23,0x59,0x80,0x80,0x7f,0xad,0xdc,0x7f,0x8a,0x89,0x7f,0xba,0x7f,0x7f,0x80,0xa9,
-    0x80,0x80,0x7f,0x4b,0x91,0x7f,0x4c,0x7f,0x44,0xaf,0x7f,0x7f,0x80,0x7f,0x7f,0xb8,
-    0x80,0x3c,0x7f,0x3b,0x7f,0x80,0xe8,0x80,0x7f,0x7a,0x2c,0x56,0x80,0x7f,0x80,0xe8,
-    0x7f,0x7f,0x17,0x3f,0x7f,0xd8,0x05,0x73,0xdf,0x2d,0xb4,0x80,0x7f,0x95,0x80,0x8c,
-    0x7f,0x7f,0xe3,0x80,0x09,0x25,0x7f,0x7f,0x7f,0x7f,0xaa,0x7f,0x15,0xc3,0xaf,0xba,
-    0x80,0x80,0x2c,0xf0,0xba,0x7f,0x7f,0x68,0x7f,0x7f,0x7f,0x17,0x4f,0x85,0x80,0x80,
-    0x70,0x7f,0x9b,0x62,0x2d,0x80,0x80,0x9b,0x80,0x80,0x95,0x80,0x98,0x7f,0xf7,0x7f,
-    0x36,0x80,0x80,0x80,0x7f,0x27,0x80,0x7f,0xca,0x27,0x80,0x0e,0x80,0x3a,0x80,0x80,
-    0x31,0xf0,0x7f,0x94,0xb2,0x52,0x7f,0x80,0x80,0x88,0x5d,0x05,0xa3,0x14,0x91,0x80,
-    0xcc,0x7f,0x80,0x7f,0x7f,0x80,0x80,0x7f,0x80,0x7f,0x7f,0x4c,0x7f,0xf6,0x7f,0x7f,
-    0x80,0xa4,0x7f,0x7f,0x95,0x7f,0x24,0x7f,0xf7,0x62,0x7f,0x80,0x21,0x7f,0x44,0x7f,
-    0x43,0x4d,0xcb,0x80,0x7f,0x80,0xc0,0x80,0x7f,0x7f,0x12,0x35,0x24,0x4b,0x93,0x90,
-    0x80,0x80,0xc7,0x2b,0x80,0x3b,0x08,0x7f,0x5e,0x7f,0x51,0x80,0xa1,0xb2,0x80,0x7f,
-    0xae,0x80,0x7f,0x5a,0x4b,0xf7,0x80,0x80,0xc2,0x7f,0x80,0x80,0x92,0x34,0x80,0x95,
-    0xac,0x80,0xa7,0x7f,0x7f,0x11,0x3b,0x3c,0x7f,0x80,0x7f,0x80,0xe8,0x66,0x7f,0x7f,
-    0x17,0xd7,0xa3,0x3a,0x80,0x70,0x80,0x80,0x7f,0x7f,0x80,0x80,0x80,0x5c,0x2d,0x80,
-    0x17,0x7f,0x7f,0x80,0x38,0x80,0xab,0x7f,0x0f,0x80,0x7f,0x80,0x80,0xc8,0xf1,0xaa,
-    0x7f,0x7f,0x80,0x7f,0x7f,0x80,0x4f,0xa7,0xc4,0x80,0x02,0x37,0x80,0x3d,0x80,0x7f,
-    0x7f,0xb8,0x7f,0x80,0x2f,0x14,0x13,0x80,0x38,0x80,0x7f,0xf0,0x7f,0x68,0x7f,0x59,
-    0xe9,0x2a,0xce,0x7b,0x5c,0x80,0xec,0x7f,0x7f,0x7f,0xf8,0x80,0x80,0x88,0x2d,0x7f,
-    0x43,0x13,0x91,0xd8,0x80,0xc4,0x7f,0x3b,0x7f,0x80,0x80,0xcb,0x80,0x80,0x80,0x7f,
-    0xac,0x7f,0x26,0x7f,0x80,0x80,0xd9,0x27,0x1b,0x7f,0x7a,0x34,0x7f,0x80,0x7f,0x7f,
-    0x7f,0x0c,0x7f,0x7f,0x7f,0x80,0x7f,0x80,0x17,0x80,0x6e,0x80,0x76,0x80,0x80,0x5f,
-    0xa1,0xa0,0x9e,0x7f,0x4d,0x55,0xd5,0x19,0x7f,0x7f,0x7f,0x80,0x13,0xe7,0x2c,0x2c
-};
-
 // Stereo panning positions (HVL)
 static const int stereopan_left[]  = { 128,  96,  64,  32,   0 };
 static const int stereopan_right[] = { 128, 160, 193, 225, 255 };
@@ -351,12 +228,6 @@ static const int stereopan_right[] = { 128, 160, 193, 225, 255 };
 static void voice_init(AhxVoice* voice);
 static void voice_calc_adsr(AhxVoice* voice);
 static void gen_panning_tables(AhxPlayer* player);
-static void waves_generate(AhxWaves* waves);
-static void waves_generate_triangle(int16_t* buffer, int len);
-static void waves_generate_square(int16_t* buffer);
-static void waves_generate_sawtooth(int16_t* buffer, int len);
-static void waves_generate_white_noise(int16_t* buffer, int len);
-static void waves_generate_filter_waveforms(int16_t* buffer, int16_t* low, int16_t* high);
 static void player_process_step(AhxPlayer* player, int v);
 static void player_process_frame(AhxPlayer* player, int v);
 static void player_set_audio(AhxPlayer* player, int v);
@@ -440,119 +311,6 @@ static void voice_calc_adsr(AhxVoice* voice) {
     voice->ADSR.rVolume = temp_voice.ADSR.rVolume;
 }
 
-// Wave generation functions
-static inline void clip_float(float* x) {
-    if (*x > 32767.f) { *x = 32767.f; return; }  // 16-bit range
-    if (*x < -32768.f) { *x = -32768.f; return; }
-}
-
-static void waves_generate_filter_waveforms(int16_t* buffer, int16_t* low, int16_t* high) {
-    int length_table[] = { 3, 7, 0xf, 0x1f, 0x3f, 0x7f, 3, 7, 0xf, 0x1f, 0x3f, 0x7f,
-        0x7f,0x7f,0x7f,0x7f,0x7f,0x7f,0x7f,0x7f,0x7f,0x7f,0x7f,0x7f,0x7f,0x7f,0x7f,0x7f,0x7f,0x7f,0x7f,0x7f,
-        0x7f,0x7f,0x7f,0x7f,0x7f,0x7f,0x7f,0x7f,0x7f,0x7f,0x7f,0x7f,
-        (0x280*3)-1
-    };
-
-    for (int temp = 0, freq = 8; temp < 31; temp++, freq += 3) {
-        int16_t* a0 = buffer;
-        for (int waves = 0; waves < 6+6+0x20+1; waves++) {
-            float fre = (float)freq * 1.25f / 100.f;
-            float high_val, mid = 0.f, low_val = 0.f;
-            for (int i = 0; i <= length_table[waves]; i++) {
-                high_val = a0[i] - mid - low_val;
-                clip_float(&high_val);
-                mid += high_val * fre;
-                clip_float(&mid);
-                low_val += mid * fre;
-                clip_float(&low_val);
-            }
-            for (int i = 0; i <= length_table[waves]; i++) {
-                high_val = a0[i] - mid - low_val;
-                clip_float(&high_val);
-                mid += high_val * fre;
-                clip_float(&mid);
-                low_val += mid * fre;
-                clip_float(&low_val);
-                *low++ = (int16_t)low_val;  // 16-bit output
-                *high++ = (int16_t)high_val;
-            }
-            a0 += length_table[waves] + 1;
-        }
-    }
-}
-
-static void waves_generate_triangle(int16_t* buffer, int len) {
-    int d2 = len;
-    int d5 = d2 >> 2;
-    int d1 = 32768 / d5;  // 16-bit range: 256x larger than 8-bit
-    int d4 = -(d2 >> 1);
-    int16_t* edi = buffer;
-    int eax = 0;
-
-    for (int ecx = 0; ecx < d5; ecx++) {
-        *edi++ = eax;
-        eax += d1;
-    }
-    *edi++ = 0x7fff;  // Max positive 16-bit
-    if (d5 != 1) {
-        eax = 32768;
-        for (int ecx = 0; ecx < d5-1; ecx++) {
-            eax -= d1;
-            *edi++ = eax;
-        }
-    }
-    int16_t* esi = edi + d4;
-    for (int ecx = 0; ecx < d5*2; ecx++) {
-        *edi++ = *esi++;
-        if (edi[-1] == 0x7fff) edi[-1] = -32768;  // Flip peak to negative
-        else edi[-1] = -edi[-1];
-    }
-}
-
-static void waves_generate_square(int16_t* buffer) {
-    int16_t* edi = buffer;
-    for (int ebx = 1; ebx <= 0x20; ebx++) {
-        for (int ecx = 0; ecx < (0x40-ebx)*2; ecx++) *edi++ = -32768;  // Min 16-bit
-        for (int ecx = 0; ecx < ebx*2; ecx++) *edi++ = 0x7fff;  // Max 16-bit
-    }
-}
-
-static void waves_generate_sawtooth(int16_t* buffer, int len) {
-    int16_t* edi = buffer;
-    int ebx = 65536 / (len-1);  // 16-bit range: 65536 total values
-    int eax = -32768;
-    for (int ecx = 0; ecx < len; ecx++) {
-        *edi++ = eax;
-        eax += ebx;
-    }
-}
-
-static void waves_generate_white_noise(int16_t* buffer, int len) {
-    // Scale 8-bit noise table to 16-bit (multiply by 256)
-    for (int i = 0; i < len; i++) {
-        int8_t sample8 = (int8_t)WhiteNoiseBig[i];  // Convert to signed
-        buffer[i] = sample8 * 256;  // Scale to 16-bit range
-    }
-}
-
-static void waves_generate(AhxWaves* waves) {
-    waves_generate_sawtooth(waves->Sawtooth04, 0x04);
-    waves_generate_sawtooth(waves->Sawtooth08, 0x08);
-    waves_generate_sawtooth(waves->Sawtooth10, 0x10);
-    waves_generate_sawtooth(waves->Sawtooth20, 0x20);
-    waves_generate_sawtooth(waves->Sawtooth40, 0x40);
-    waves_generate_sawtooth(waves->Sawtooth80, 0x80);
-    waves_generate_triangle(waves->Triangle04, 0x04);
-    waves_generate_triangle(waves->Triangle08, 0x08);
-    waves_generate_triangle(waves->Triangle10, 0x10);
-    waves_generate_triangle(waves->Triangle20, 0x20);
-    waves_generate_triangle(waves->Triangle40, 0x40);
-    waves_generate_triangle(waves->Triangle80, 0x80);
-    waves_generate_square(waves->Squares);
-    waves_generate_white_noise(waves->WhiteNoiseBig, 0x280*3);
-    waves_generate_filter_waveforms(waves->Triangle04, waves->LowPasses, waves->HighPasses);
-}
-
 // Initialize volume table
 static void init_volume_table(AhxPlayer* player, float boost) {
     for (int i = 0; i < 65; i++) {
@@ -1175,7 +933,7 @@ static void player_process_frame(AhxPlayer* player, int v) {
 
     // Calculate square waveform
     if (player->Voices[v].Waveform == 3-1 || player->Voices[v].PlantSquare) {
-        int16_t* square_ptr = &player->Waves->Squares[(player->Voices[v].FilterPos-0x20) *
+        const int16_t* square_ptr = &player->Waves->Squares[(player->Voices[v].FilterPos-0x20) *
             (0xfc+0xfc+0x80*0x1f+0x80+0x280*3)];
         int x = player->Voices[v].SquarePos << (5 - player->Voices[v].WaveLength);
 
@@ -1202,7 +960,7 @@ static void player_process_frame(AhxPlayer* player, int v) {
     if (player->Voices[v].Waveform == 4-1) player->Voices[v].NewWaveform = 1;
 
     if (player->Voices[v].NewWaveform) {
-        int16_t* audio_source = player->WaveformTab[player->Voices[v].Waveform];
+        const int16_t* audio_source = player->WaveformTab[player->Voices[v].Waveform];
 
         if (player->Voices[v].Waveform != 3-1) {
             audio_source += (player->Voices[v].FilterPos-0x20) * (0xfc+0xfc+0x80*0x1f+0x80+0x280*3);
@@ -1477,25 +1235,85 @@ static void player_play_irq(AhxPlayer* player) {
     }
 }
 
+// Paula output - render one voice through its BLEP, stepping the DAC level
+// exactly at the Paula clock where the voice fetches its next sample (no
+// resampling filter, like the real chip). The level carries the voice
+// volume, so volume changes are band-limited as well. Output is scaled like
+// tracker_voice_render_mono() times VoiceVolume / 64. Positions advance the
+// same way as the nearest-sample path, so switching modes is seamless.
+// Returns the Paula clock remainder after the span.
+static uint32_t render_voice_paula(AhxPlayer* player, int v, float* out, int frames,
+                                   uint32_t clock_acc, int sample_rate) {
+    AhxVoice* voice = &player->Voices[v];
+    TrackerVoice* tv = &voice->voice_playback;
+    FXPaulaBlep* blep = player->paula[v];
+    const int16_t* wave = (const int16_t*)tv->waveform;
+    const uint64_t length = tv->length >> 16;
+    const uint32_t delta = tv->delta;
+    const int volume = voice->VoiceVolume;
+    uint64_t pos = tv->sample_pos;
+
+    // Levels stay within 15 bits (fx_paula_blep scales them by 2^17)
+    bool playing = wave && length > 0 && (pos >> 16) < length;
+    fx_paula_blep_input_sample(blep, playing ? (int16_t)((wave[pos >> 16] * volume) >> 7) : 0);
+
+    for (int i = 0; i < frames; i++) {
+        clock_acc += AMIGA_PAULA_PAL_CLK;
+        uint32_t cycles = clock_acc / (uint32_t)sample_rate;
+        clock_acc -= cycles * (uint32_t)sample_rate;
+
+        uint32_t elapsed = 0;
+        uint32_t left = playing ? delta : 0;
+        while (left > 0) {
+            uint32_t to_next = 0x10000 - (uint32_t)(pos & 0xFFFF);
+            if (to_next > left) {
+                pos += left;
+                break;
+            }
+            pos += to_next;
+            left -= to_next;
+
+            // Next sample fetch, at its share of this output sample's clocks
+            uint32_t at = (uint32_t)((uint64_t)(delta - left) * cycles / delta);
+            fx_paula_blep_clock(blep, (int)(at - elapsed));
+            elapsed = at;
+
+            if (pos >= tv->loop_end && tv->loop_enabled) {
+                uint64_t loop_len = tv->loop_end - tv->loop_start;
+                pos = loop_len > 0 ? tv->loop_start + (pos - tv->loop_end) % loop_len : tv->loop_start;
+            }
+            if ((pos >> 16) >= length) {
+                playing = false;
+                fx_paula_blep_input_sample(blep, 0);
+                break;
+            }
+            fx_paula_blep_input_sample(blep, (int16_t)((wave[pos >> 16] * volume) >> 7));
+        }
+
+        fx_paula_blep_clock(blep, (int)(cycles - elapsed));
+        out[i] = (float)fx_paula_blep_output_sample(blep) * (1.0f / 65536.0f);
+    }
+
+    tv->sample_pos = pos;
+    return clock_acc;
+}
+
 // Public API implementations
 AhxPlayer* ahx_player_create(void) {
     AhxPlayer* player = calloc(1, sizeof(AhxPlayer));
     if (!player) return NULL;
 
-    // Create waveforms
-    player->Waves = malloc(sizeof(AhxWaves));
+    // Waveform tables are shared by all players and synths
+    player->Waves = ahx_waves_acquire();
     if (!player->Waves) {
         free(player);
         return NULL;
     }
 
-    waves_generate(player->Waves);
-    player->OurWaves = 1;
-
     // Create pattern sequencer
     player->sequencer = pattern_sequencer_create();
     if (!player->sequencer) {
-        free(player->Waves);
+        ahx_waves_release(player->Waves);
         free(player);
         return NULL;
     }
@@ -1553,8 +1371,10 @@ void ahx_player_destroy(AhxPlayer* player) {
         free(player->Song.Instruments);
     }
 
-    if (player->OurWaves && player->Waves) {
-        free(player->Waves);
+    ahx_waves_release(player->Waves);
+
+    for (int v = 0; v < 4; v++) {
+        fx_paula_blep_destroy(player->paula[v]);
     }
 
     // Destroy pattern sequencer
@@ -1644,6 +1464,24 @@ void ahx_player_get_position(const AhxPlayer* player, uint16_t* position, uint16
     if (row) *row = player->NoteNr;
 }
 
+void ahx_player_set_position(AhxPlayer* player, uint16_t position, uint16_t row) {
+    if (!player || position >= player->Song.PositionNr || row >= player->Song.TrackLength) return;
+
+    // Next IRQ sets up the tracks of the new position and plays the step
+    player->PosNr = position;
+    player->NoteNr = row;
+    player->PosJump = 0;
+    player->PosJumpNote = 0;
+    player->PatternBreak = 0;
+    player->GetNewPosition = 1;
+    player->StepWaitFrames = 0;
+    player->frame_counter = 0;
+
+    if (player->sequencer) {
+        pattern_sequencer_set_position(player->sequencer, position, row);
+    }
+}
+
 uint16_t ahx_player_get_song_length(const AhxPlayer* player) {
     if (!player) return 0;
     return player->Song.PositionNr;
@@ -1686,39 +1524,91 @@ void ahx_player_process_channels(AhxPlayer* player,
             chunk_samples = player->frame_counter;
         }
 
-        // Render chunk with current waveforms using TrackerVoice (same as synth core)
-        for (int i = 0; i < chunk_samples; i++) {
-            size_t out_idx = output_pos + i;
-            float a = 0.0f, b = 0.0f;
+        // Render chunk with current waveforms: each voice into its own block
+        // (its channel output when there is one), then all of them into the
+        // bus in one pass
+        float* chunk_left = left + output_pos;
+        float* chunk_right = right + output_pos;
+        float* channel_out[4];
+        float voice_gain[4], pan_l[4], pan_r[4];
+        uint32_t clock_acc[4];
+        int active[4];
+        int num_active = 0;
+
+        for (int v = 0; v < 4; v++) {
+            channel_out[v] = (channel_outputs && channel_outputs[v]) ? channel_outputs[v] + output_pos : NULL;
+
+            if (player->channel_muted[v] || !player->Voices[v].TrackOn) {
+                if (channel_out[v]) memset(channel_out[v], 0, chunk_samples * sizeof(float));
+                if (player->paula[v]) {
+                    // Let the filter settle while the voice is silent
+                    fx_paula_blep_input_sample(player->paula[v], 0);
+                    fx_paula_blep_clock(player->paula[v], 2048);
+                }
+                continue;
+            }
 
-            for (int v = 0; v < 4; v++) {
-                if (player->channel_muted[v] || !player->Voices[v].TrackOn) continue;
+            if (player->paula[v]) {
+                // Paula output: the voice volume is part of the DAC level
+                voice_gain[v] = 0.5f;
+            } else {
+                // Reduce per-voice output to 50% to prevent clipping when mixing 4 voices
+                voice_gain[v] = (player->Voices[v].VoiceVolume / 64.0f) * 0.5f;
+            }
 
-                // Use TrackerVoice to get raw sample (without volume/panning applied)
-                int32_t sample = tracker_voice_get_sample(&player->Voices[v].voice_playback);
+            // Apply panning (values are 0-255)
+            pan_l[v] = voice_gain[v] * player->Voices[v].PanMultLeft / 255.0f;
+            pan_r[v] = voice_gain[v] * player->Voices[v].PanMultRight / 255.0f;
 
-                // Convert to float and apply volume
-                // Reduce per-voice output to 50% to prevent clipping when mixing 4 voices
-                float sample_f = sample / 32768.0f;
-                float vol = (player->Voices[v].VoiceVolume / 64.0f) * 0.5f;
+            // Every voice starts from the same point of the Paula clock
+            clock_acc[v] = player->paula_clock_acc;
+            active[num_active++] = v;
+        }
+
+        float scratch[4][AHX_MIX_BLOCK];
+        for (int done = 0; done < chunk_samples; ) {
+            int n = chunk_samples - done;
+            if (n > AHX_MIX_BLOCK) n = AHX_MIX_BLOCK;
+
+            const float* blocks[4];
+            float gains_l[4], gains_r[4];
+            for (int a = 0; a < num_active; a++) {
+                int v = active[a];
+                float* voice_out = channel_out[v] ? channel_out[v] + done : scratch[a];
 
-                // Apply panning (values are 0-255)
-                float pan_l = player->Voices[v].PanMultLeft / 255.0f;
-                float pan_r = player->Voices[v].PanMultRight / 255.0f;
+                if (player->paula[v]) {
+                    clock_acc[v] = render_voice_paula(player, v, voice_out, n, clock_acc[v], sample_rate);
+                } else {
+                    tracker_voice_render_mono(&player->Voices[v].voice_playback, player->interpolation,
+                                              voice_out, (uint32_t)n);
+                }
+                blocks[a] = voice_out;
+                gains_l[a] = pan_l[v];
+                gains_r[a] = pan_r[v];
+            }
 
-                a += sample_f * vol * pan_l;
-                b += sample_f * vol * pan_r;
+            tracker_voice_mix_blocks(chunk_left + done, chunk_right + done, blocks,
+                                     gains_l, gains_r, num_active, (uint32_t)n);
 
-                // Write to individual channel output if buffer provided
-                if (channel_outputs && channel_outputs[v]) {
-                    channel_outputs[v][out_idx] = sample_f * vol;
+            // Channel outputs keep the voice at its level in the mix
+            for (int a = 0; a < num_active; a++) {
+                int v = active[a];
+                if (!channel_out[v]) continue;
+                for (int i = 0; i < n; i++) {
+                    channel_out[v][done + i] *= voice_gain[v];
                 }
             }
+            done += n;
+        }
+
+        player->paula_clock_acc = (uint32_t)(((uint64_t)player->paula_clock_acc +
+            (uint64_t)chunk_samples * AMIGA_PAULA_PAL_CLK) % (uint32_t)sample_rate);
 
-            // Apply mixgain and clamp
-            float gain = player->mixgain / 256.0f;
-            left[out_idx] = CLAMP(a * gain, -1.0f, 1.0f);
-            right[out_idx] = CLAMP(b * gain, -1.0f, 1.0f);
+        // Apply mixgain and clamp
+        float gain = player->mixgain / 256.0f;
+        for (int i = 0; i < chunk_samples; i++) {
+            chunk_left[i] = CLAMP(chunk_left[i] * gain, -1.0f, 1.0f);
+            chunk_right[i] = CLAMP(chunk_right[i] * gain, -1.0f, 1.0f);
         }
 
         // Advance counters
@@ -1750,6 +1640,44 @@ void ahx_player_set_boost(AhxPlayer* player, float boost) {
 void ahx_player_set_oversampling(AhxPlayer* player, bool enabled) {
     if (!player) return;
     player->Oversampling = enabled ? 1 : 0;
+    player->interpolation = enabled ? TRACKER_INTERP_LINEAR : TRACKER_INTERP_NONE;
+}
+
+bool ahx_player_set_paula_output(AhxPlayer* player, bool enabled, PaulaMode mode) {
+    if (!player) return false;
+
+    if (!enabled) {
+        for (int v = 0; v < 4; v++) {
+            fx_paula_blep_destroy(player->paula[v]);
+            player->paula[v] = NULL;
+        }
+        return true;
+    }
+
+    for (int v = 0; v < 4; v++) {
+        if (!player->paula[v]) {
+            player->paula[v] = fx_paula_blep_create();
+            if (!player->paula[v]) {
+                ahx_player_set_paula_output(player, false, mode);
+                return false;
+            }
+        }
+        fx_paula_blep_set_mode(player->paula[v], mode);
+    }
+    return true;
+}
+
+bool ahx_player_get_paula_output(const AhxPlayer* player) {
+    return player && player->paula[0];
+}
+
+void ahx_player_set_interpolation(AhxPlayer* player, TrackerInterpolation interp) {
+    if (!player || (unsigned)interp >= TRACKER_INTERP_NUM_MODES) return;
+    player->interpolation = interp;
+}
+
+TrackerInterpolation ahx_player_get_interpolation(const AhxPlayer* player) {
+    return player ? player->interpolation : TRACKER_INTERP_NONE;
 }
 
 void ahx_player_set_disable_looping(AhxPlayer* player, bool disable) {
@@ -1766,3 +1694,205 @@ void ahx_player_set_loop_range(AhxPlayer* player, uint16_t start, uint16_t end)
 PatternSequencer* ahx_player_get_sequencer(AhxPlayer* player) {
     return player ? player->sequencer : NULL;
 }
+
+uint32_t ahx_player_fast_forward(AhxPlayer* player, uint32_t rows, int sample_rate,
+                                 uint64_t* frames) {
+    if (frames) *frames = 0;
+    if (!player || !player->Playing) return 0;
+
+    // Rows passed on the way are not reported
+    AhxPositionCallback callback = player->position_callback;
+    player->position_callback = NULL;
+
+    // Same frame timing as ahx_player_process_channels(), without mixing
+    player->current_sample_rate = sample_rate;
+    int samples_per_frame = sample_rate / 50 / player->Song.SpeedMultiplier;
+
+    uint32_t passed = 0;
+    while (player->Playing) {
+        if (player->frame_counter <= 0) {
+            // This IRQ plays the next step
+            if (player->StepWaitFrames <= 0) {
+                if (passed == rows) break;
+                passed++;
+            }
+            player_play_irq(player);
+            player->frame_counter = samples_per_frame;
+        }
+
+        int chunk_samples = player->frame_counter;
+        for (int v = 0; v < 4; v++) {
+            if (player->channel_muted[v] || !player->Voices[v].TrackOn) continue;
+            tracker_voice_skip(&player->Voices[v].voice_playback, (uint32_t)chunk_samples);
+        }
+        player->frame_counter -= chunk_samples;
+        if (frames) *frames += (uint64_t)chunk_samples;
+    }
+
+    player->position_callback = callback;
+    return passed;
+}
+
+// Playback state snapshot
+// Voices are stored as they are (they hold their own wave buffers). Pointers
+// are replaced by instrument numbers and by offsets into the wave tables or
+// a voice's square buffer, so the snapshot is valid for any player that has
+// the same song loaded.
+#define AHX_STATE_MAGIC 0x53584841U  // "AHXS"
+#define AHX_WAVE_NONE (-1)
+
+typedef struct {
+    uint32_t magic;
+    uint32_t size;
+    AhxVoice voices[4];
+    int32_t instrument[4];
+    int32_t audio_source[4];
+    bool voice_buffer[4];       // voice_playback plays the voice's VoiceBuffer
+    int32_t square_tab;
+    int StepWaitFrames, GetNewPosition, SongEndReached, TimingValue;
+    int PatternBreak;
+    int MainVolume;
+    int Playing, Tempo;
+    int PosNr, PosJump;
+    int NoteNr, PosJumpNote;
+    int PlayingTime;
+    int frame_counter;
+    uint16_t last_position;
+    uint16_t last_row;
+    PatternSequencerState sequencer;
+} AhxPlayerState;
+
+// Wave pointer -> offset in the wave tables (>= 0), square buffer of a voice
+// (<= -2) or AHX_WAVE_NONE
+static int32_t wave_ref_encode(const AhxPlayer* player, const int16_t* ptr) {
+    if (!ptr) return AHX_WAVE_NONE;
+
+    const int16_t* waves = (const int16_t*)player->Waves;
+    if (waves && ptr >= waves && ptr < waves + sizeof(AhxWaves) / sizeof(int16_t)) {
+        return (int32_t)(ptr - waves);
+    }
+
+    for (int v = 0; v < 4; v++) {
+        const int16_t* square = player->Voices[v].SquareTempBuffer;
+        if (ptr >= square && ptr < square + 0x80) {
+            return -2 - (int32_t)(v * 0x80 + (ptr - square));
+        }
+    }
+
+    return AHX_WAVE_NONE;
+}
+
+static const int16_t* wave_ref_decode(const AhxPlayer* player, int32_t ref) {
+    if (ref >= 0) {
+        if (!player->Waves || (size_t)ref >= sizeof(AhxWaves) / sizeof(int16_t)) return NULL;
+        return (const int16_t*)player->Waves + ref;
+    }
+    if (ref <= -2 && ref > -2 - 4 * 0x80) {
+        int32_t index = -2 - ref;
+        return &player->Voices[index / 0x80].SquareTempBuffer[index % 0x80];
+    }
+    return NULL;
+}
+
+size_t ahx_player_get_state_size(const AhxPlayer* player) {
+    (void)player;
+    return sizeof(AhxPlayerState);
+}
+
+bool ahx_player_save_state(const AhxPlayer* player, void* buffer, size_t size) {
+    if (!player || !buffer || size < sizeof(AhxPlayerState)) return false;
+
+    AhxPlayerState* state = (AhxPlayerState*)buffer;
+    memset(state, 0, sizeof(*state));
+    state->magic = AHX_STATE_MAGIC;
+    state->size = sizeof(AhxPlayerState);
+
+    for (int v = 0; v < 4; v++) {
+        const AhxVoice* voice = &player->Voices[v];
+        AhxVoice* saved = &state->voices[v];
+
+        *saved = *voice;
+        saved->Instrument = NULL;
+        saved->PerfList = NULL;
+        saved->plist_seq.entries = NULL;
+        saved->AudioPointer = NULL;
+        saved->AudioSource = NULL;
+        saved->voice_playback.waveform = NULL;
+
+        state->instrument[v] = voice->Instrument ? (int32_t)(voice->Instrument - player->Song.Instruments) : -1;
+        state->audio_source[v] = wave_ref_encode(player, voice->AudioSource);
+        state->voice_buffer[v] = voice->voice_playback.waveform != NULL;
+    }
+    state->square_tab = wave_ref_encode(player, player->WaveformTab[2]);
+
+    state->StepWaitFrames = player->StepWaitFrames;
+    state->GetNewPosition = player->GetNewPosition;
+    state->SongEndReached = player->SongEndReached;
+    state->TimingValue = player->TimingValue;
+    state->PatternBreak = player->PatternBreak;
+    state->MainVolume = player->MainVolume;
+    state->Playing = player->Playing;
+    state->Tempo = player->Tempo;
+    state->PosNr = player->PosNr;
+    state->PosJump = player->PosJump;
+    state->NoteNr = player->NoteNr;
+    state->PosJumpNote = player->PosJumpNote;
+    state->PlayingTime = player->PlayingTime;
+    state->frame_counter = player->frame_counter;
+    state->last_position = player->last_position;
+    state->last_row = player->last_row;
+    pattern_sequencer_save_state(player->sequencer, &state->sequencer);
+
+    return true;
+}
+
+bool ahx_player_restore_state(AhxPlayer* player, const void* buffer, size_t size) {
+    if (!player || !buffer || size < sizeof(AhxPlayerState)) return false;
+
+    const AhxPlayerState* state = (const AhxPlayerState*)buffer;
+    if (state->magic != AHX_STATE_MAGIC || state->size != sizeof(AhxPlayerState)) return false;
+
+    for (int v = 0; v < 4; v++) {
+        if (state->instrument[v] > player->Song.InstrumentNr) return false;
+    }
+
+    // Paula filter state is not part of the snapshot; start it from silence
+    for (int v = 0; v < 4; v++) {
+        if (player->paula[v]) fx_paula_blep_reset(player->paula[v]);
+    }
+
+    for (int v = 0; v < 4; v++) {
+        AhxVoice* voice = &player->Voices[v];
+
+        *voice = state->voices[v];
+
+        if (state->instrument[v] >= 0 && player->Song.Instruments) {
+            voice->Instrument = &player->Song.Instruments[state->instrument[v]];
+            voice->PerfList = &voice->Instrument->PList;
+            voice->plist_seq.entries = (TrackerSequenceEntry*)voice->Instrument->PList.Entries;
+        }
+        voice->AudioSource = wave_ref_decode(player, state->audio_source[v]);
+        voice->voice_playback.waveform = state->voice_buffer[v] ? voice->VoiceBuffer : NULL;
+    }
+    player->WaveformTab[2] = wave_ref_decode(player, state->square_tab);
+
+    player->StepWaitFrames = state->StepWaitFrames;
+    player->GetNewPosition = state->GetNewPosition;
+    player->SongEndReached = state->SongEndReached;
+    player->TimingValue = state->TimingValue;
+    player->PatternBreak = state->PatternBreak;
+    player->MainVolume = state->MainVolume;
+    player->Playing = state->Playing;
+    player->Tempo = state->Tempo;
+    player->PosNr = state->PosNr;
+    player->PosJump = state->PosJump;
+    player->NoteNr = state->NoteNr;
+    player->PosJumpNote = state->PosJumpNote;
+    player->PlayingTime = state->PlayingTime;
+    player->frame_counter = state->frame_counter;
+    player->last_position = state->last_position;
+    player->last_row = state->last_row;
+    pattern_sequencer_restore_state(player->sequencer, &state->sequencer);
+
+    return true;
+}
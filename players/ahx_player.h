@@ -16,6 +16,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include "tracker_voice.h"
+#include "../effects/fx_paula_blep.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -68,6 +70,9 @@ void ahx_player_set_position_callback(AhxPlayer* player, AhxPositionCallback cal
 // Get current playback position
 void ahx_player_get_position(const AhxPlayer* player, uint16_t* position, uint16_t* row);
 
+// Jump to a position and row (the step is played on the next frame)
+void ahx_player_set_position(AhxPlayer* player, uint16_t position, uint16_t row);
+
 // Get song length (number of positions in play sequence)
 uint16_t ahx_player_get_song_length(const AhxPlayer* player);
 
@@ -104,9 +109,20 @@ bool ahx_player_get_channel_mute(const AhxPlayer* player, uint8_t channel);
 // Set master volume boost (default 1.0)
 void ahx_player_set_boost(AhxPlayer* player, float boost);
 
-// Enable/disable oversampling (interpolation)
+// Enable/disable oversampling (linear interpolation)
 void ahx_player_set_oversampling(AhxPlayer* player, bool enabled);
 
+// Set waveform interpolation (default TRACKER_INTERP_NONE)
+void ahx_player_set_interpolation(AhxPlayer* player, TrackerInterpolation interp);
+TrackerInterpolation ahx_player_get_interpolation(const AhxPlayer* player);
+
+// Paula output: each voice steps its DAC level at the exact Paula clock and
+// is band-limited with the fx_paula_blep filter model (mode). Overrides the
+// interpolation while enabled. Off by default. Allocates, so call it outside
+// the audio thread. Returns false if out of memory (output stays off).
+bool ahx_player_set_paula_output(AhxPlayer* player, bool enabled, PaulaMode mode);
+bool ahx_player_get_paula_output(const AhxPlayer* player);
+
 // Disable looping (for rendering to file)
 void ahx_player_set_disable_looping(AhxPlayer* player, bool disable);
 
@@ -121,6 +137,34 @@ void ahx_player_set_loop_range(AhxPlayer* player, uint16_t start, uint16_t end);
  */
 struct PatternSequencer* ahx_player_get_sequencer(AhxPlayer* player);
 
+/**
+ * Playback state snapshot
+ * Holds everything the song changes while it plays: position and timing,
+ * and the full voice state (PList position, ADSR, vibrato, filter and
+ * square modulation, wave buffers). Mute, loop range and interpolation are
+ * not part of it. Instruments and waves are stored by number/offset, so a
+ * snapshot can be restored into any player that has the same song loaded.
+ * The data is only valid for the same build (host byte order) and timing
+ * is in samples at the rate it was taken.
+ * @param buffer At least ahx_player_get_state_size() bytes
+ * @return false if the buffer is too small or does not hold an AHX snapshot
+ */
+size_t ahx_player_get_state_size(const AhxPlayer* player);
+bool ahx_player_save_state(const AhxPlayer* player, void* buffer, size_t size);
+bool ahx_player_restore_state(AhxPlayer* player, const void* buffer, size_t size);
+
+/**
+ * Advance playback without rendering audio (for seeking)
+ * Runs frames and wave positions exactly as ahx_player_process() would and
+ * stops right before the frame that plays a step, after passing `rows`
+ * steps. With rows = 0 it stops before the next step. The position
+ * callback is not called on the way.
+ * @param frames Receives the number of frames advanced (may be NULL)
+ * @return Number of steps passed (less than requested if the song ended)
+ */
+uint32_t ahx_player_fast_forward(AhxPlayer* player, uint32_t rows, int sample_rate,
+                                 uint64_t* frames);
+
 #ifdef __cplusplus
 }
 #endif
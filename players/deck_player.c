@@ -1,17 +1,31 @@
 /*
  * Unified Deck Player Implementation
- * Manages MOD/MED/AHX/SID players with automatic format detection
+ * Manages MOD/MED/AHX/SID/XM/S3M/IT players with automatic format detection
  */
 
+#if defined(DECK_PLAYER_THREADS) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L  // nanosleep
+#endif
+
 #include "deck_player.h"
 #include "mod_player.h"
 #include "mmd_player.h"
 #include "ahx_player.h"
 #include "sid_player.h"
+#include "xmit_player.h"
 #include "pattern_sequencer.h"
+#include "../common/mapped_file.h"
+#include "../common/lockfree.h"
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef DECK_PLAYER_THREADS
+#include <pthread.h>
+#include <time.h>
+
+typedef struct DeckLookahead DeckLookahead;
+#endif
+
 struct DeckPlayer {
     // Active player type
     DeckPlayerType type;
@@ -21,21 +35,117 @@ struct DeckPlayer {
     MedPlayer* med_player;
     AhxPlayer* ahx_player;
     SidPlayer* sid_player;
+    XmitPlayer* xmit_player;    // XM, S3M and IT
 
     // Position callback state
     DeckPlayerPositionCallback position_callback;
     void* position_callback_userdata;
 
     // Channel/voice mute states (shared across all player types)
-    // MOD/AHX: 4 channels, SID: 3 voices
-    bool channel_muted[4];
+    // MOD/AHX: 4 channels, MED/XM/S3M/IT: up to 64, SID: 3 voices
+    bool channel_muted[DECK_PLAYER_MAX_CHANNELS];
+
+    // Loop controls as last applied to the player
+    uint16_t loop_start;
+    uint16_t loop_end;
+    bool loop_range_set;
+    bool looping_disabled;
+
+    // Seek index for the loaded file (owned, may be NULL)
+    DeckSeekIndex* seek_index;
+    uint32_t data_hash;
+    bool data_hash_valid;   // Hash of a mapped file is taken on first use
+
+    // Mapping the loaded song plays from in place (one reference, may be NULL)
+    MappedFile* file;
+
+#ifdef DECK_PLAYER_THREADS
+    // Background rendering (NULL when off, see deck_player_set_lookahead)
+    DeckLookahead* lookahead;
+#endif
 };
 
+// Position of a row in the song's timeline (first time it is played)
+typedef struct {
+    uint16_t order;
+    uint16_t row;
+    uint32_t timeline_row;   // Rows played before it, from the song start
+} DeckSeekEntry;
+
+struct DeckSeekIndex {
+    DeckPlayerType type;
+    uint32_t data_hash;
+    int sample_rate;
+
+    // Sorted by order and row
+    DeckSeekEntry* entries;
+    uint32_t num_entries;
+
+    // Snapshot at every rows_per_keyframe-th timeline row, and the frame
+    // (from the song start, at sample_rate) it was taken at
+    uint16_t rows_per_keyframe;
+    size_t keyframe_size;
+    uint32_t num_keyframes;
+    uint8_t* keyframes;
+    uint64_t* keyframe_frames;
+
+    // Frames scanned, and whether the scan stopped at the song end (rather
+    // than where the song starts repeating itself)
+    uint64_t length;
+    bool song_ended;
+};
+
+// Scan stops after this many rows per order (song that never ends)
+#define DECK_SEEK_MAX_ROWS_PER_ORDER 4096
+
 // Forward declarations for internal callbacks
 static void mod_position_callback(uint8_t order, uint8_t pattern, uint16_t row, void* user_data);
 static void med_position_callback(uint8_t order, uint8_t pattern, uint16_t row, void* user_data);
 static void ahx_position_callback(uint8_t subsong, uint16_t position, uint16_t row, void* user_data);
 static void sid_position_callback(uint8_t subsong, uint32_t time_ms, void* user_data);
+static void xmit_position_callback(uint16_t order, uint16_t pattern, uint16_t row, void* user_data);
+static bool deck_seek(DeckPlayer* player, uint8_t order, uint16_t row);
+
+// Control calls the look-ahead worker applies at a frame
+typedef enum {
+    DECK_COMMAND_START,
+    DECK_COMMAND_STOP,
+    DECK_COMMAND_POSITION,         // a = order, b = row
+    DECK_COMMAND_BPM,              // a = BPM
+    DECK_COMMAND_LOOP_RANGE,       // a = start order, b = end order
+    DECK_COMMAND_DISABLE_LOOPING,  // a = disable
+    DECK_COMMAND_MUTE              // a = channel, b = muted
+} DeckCommandType;
+
+// What the listener hears, reported while the look-ahead is on
+typedef struct {
+    uint8_t order;
+    uint16_t pattern;
+    uint16_t row;
+    uint16_t bpm;
+    bool playing;
+} DeckAudible;
+
+// Look-ahead hooks; without DECK_PLAYER_THREADS they do nothing and the
+// public calls act on the players directly
+static bool lookahead_command(DeckPlayer* player, DeckCommandType type, uint16_t a, uint16_t b);
+static bool lookahead_audible(const DeckPlayer* player, DeckAudible* audible);
+static bool lookahead_pause(const DeckPlayer* player, bool sync);
+static void lookahead_resume(const DeckPlayer* player, bool paused, bool rerender);
+static void lookahead_discard(const DeckPlayer* player);
+static bool lookahead_capture_position(DeckPlayer* player, uint8_t order, uint16_t pattern, uint16_t row);
+static bool lookahead_process(DeckPlayer* player, float* left, float* right, float* channel_outputs[4],
+                              size_t num_samples, int sample_rate);
+static void lookahead_stop(DeckPlayer* player);
+
+// FNV-1a, to tell whether a seek index belongs to the loaded file
+static uint32_t hash_data(const uint8_t* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
 
 DeckPlayer* deck_player_create(void) {
     DeckPlayer* player = calloc(1, sizeof(DeckPlayer));
@@ -46,8 +156,10 @@ DeckPlayer* deck_player_create(void) {
     player->med_player = med_player_create();
     player->ahx_player = ahx_player_create();
     player->sid_player = sid_player_create();
+    player->xmit_player = xmit_player_create();
 
-    if (!player->mod_player || !player->med_player || !player->ahx_player || !player->sid_player) {
+    if (!player->mod_player || !player->med_player || !player->ahx_player || !player->sid_player ||
+        !player->xmit_player) {
         deck_player_destroy(player);
         return NULL;
     }
@@ -60,27 +172,37 @@ DeckPlayer* deck_player_create(void) {
 void deck_player_destroy(DeckPlayer* player) {
     if (!player) return;
 
+    lookahead_stop(player);
+
     if (player->mod_player) mod_player_destroy(player->mod_player);
     if (player->med_player) med_player_destroy(player->med_player);
     if (player->ahx_player) ahx_player_destroy(player->ahx_player);
     if (player->sid_player) sid_player_destroy(player->sid_player);
+    if (player->xmit_player) xmit_player_destroy(player->xmit_player);
+    deck_seek_index_destroy(player->seek_index);
+    mapped_file_release(player->file);
 
     free(player);
 }
 
-bool deck_player_load(DeckPlayer* player, const uint8_t* data, size_t size) {
-    if (!player || !data || size == 0) return false;
-
+// in_place: data outlives the loaded song, so MOD/MED reference it instead
+// of copying. AHX, SID and XM/S3M/IT always copy (songs are decoded, SID
+// data goes into emulated RAM).
+static bool load_data(DeckPlayer* player, const uint8_t* data, size_t size, bool in_place) {
     // Reset state
     player->type = DECK_PLAYER_NONE;
     memset(player->channel_muted, 0, sizeof(player->channel_muted));
+    player->loop_range_set = false;
+    deck_seek_index_destroy(player->seek_index);
+    player->seek_index = NULL;
 
     // Try each player in order until one succeeds
     bool success = false;
 
     // Try MOD first (most common)
     if (mod_player_detect(data, size)) {
-        success = mod_player_load(player->mod_player, data, size);
+        success = in_place ? mod_player_load_in_place(player->mod_player, data, size)
+                           : mod_player_load(player->mod_player, data, size);
         if (success) {
             player->type = DECK_PLAYER_MOD;
             mod_player_set_position_callback(player->mod_player, mod_position_callback, player);
@@ -88,7 +210,8 @@ bool deck_player_load(DeckPlayer* player, const uint8_t* data, size_t size) {
     }
     // Try MED
     else if (med_player_detect(data, size)) {
-        success = med_player_load(player->med_player, data, size);
+        success = in_place ? med_player_load_in_place(player->med_player, data, size)
+                           : med_player_load(player->med_player, data, size);
         if (success) {
             player->type = DECK_PLAYER_MED;
             med_player_set_position_callback(player->med_player, med_position_callback, player);
@@ -110,31 +233,73 @@ bool deck_player_load(DeckPlayer* player, const uint8_t* data, size_t size) {
             sid_player_set_position_callback(player->sid_player, sid_position_callback, player);
         }
     }
+    // Try XM/S3M/IT
+    else if (xmit_player_detect(data, size) != XMIT_FORMAT_NONE) {
+        success = xmit_player_load(player->xmit_player, data, size);
+        if (success) {
+            switch (xmit_player_get_format(player->xmit_player)) {
+                case XMIT_FORMAT_XM: player->type = DECK_PLAYER_XM; break;
+                case XMIT_FORMAT_S3M: player->type = DECK_PLAYER_S3M; break;
+                default: player->type = DECK_PLAYER_IT; break;
+            }
+            xmit_player_set_position_callback(player->xmit_player, xmit_position_callback, player);
+        }
+    }
 
     // Reset channel/voice mutes on all players
     if (success) {
-        if (player->type == DECK_PLAYER_SID) {
-            // SID has 3 voices
-            for (int i = 0; i < 3; i++) {
-                sid_player_set_voice_mute(player->sid_player, i, false);
-            }
-        } else {
-            // MOD/MED/AHX have 4 channels
-            for (int i = 0; i < 4; i++) {
-                if (player->type == DECK_PLAYER_MOD) {
-                    mod_player_set_channel_mute(player->mod_player, i, false);
-                } else if (player->type == DECK_PLAYER_MED) {
-                    med_player_set_channel_mute(player->med_player, i, false);
-                } else if (player->type == DECK_PLAYER_AHX) {
-                    ahx_player_set_channel_mute(player->ahx_player, i, false);
-                }
-            }
+        uint8_t num_channels = deck_player_get_num_channels(player);
+        for (uint8_t i = 0; i < num_channels; i++) {
+            deck_player_set_channel_mute(player, i, false);
         }
     }
 
     return success;
 }
 
+bool deck_player_load(DeckPlayer* player, const uint8_t* data, size_t size) {
+    if (!player || !data || size == 0) return false;
+
+    bool paused = lookahead_pause(player, false);
+    lookahead_discard(player);
+    bool success = load_data(player, data, size, false);
+    player->data_hash = hash_data(data, size);
+    player->data_hash_valid = true;
+
+    // The previous song may have played from a mapping
+    mapped_file_release(player->file);
+    player->file = NULL;
+    lookahead_resume(player, paused, true);
+    return success;
+}
+
+bool deck_player_load_file(DeckPlayer* player, const char* path) {
+    if (!player || !path) return false;
+
+    MappedFile* file = mapped_file_open(path);
+    if (!file) return false;
+
+    bool paused = lookahead_pause(player, false);
+    lookahead_discard(player);
+    bool success = load_data(player, mapped_file_data(file), mapped_file_size(file), true);
+    player->data_hash_valid = false;
+
+    // Keep the new mapping until the next load; the old one is done with
+    mapped_file_release(player->file);
+    player->file = file;
+    lookahead_resume(player, paused, true);
+    return success;
+}
+
+// Hashing touches every page of a mapped file, so it waits for a seek index
+static uint32_t deck_data_hash(DeckPlayer* player) {
+    if (!player->data_hash_valid && player->file) {
+        player->data_hash = hash_data(mapped_file_data(player->file), mapped_file_size(player->file));
+        player->data_hash_valid = true;
+    }
+    return player->data_hash;
+}
+
 DeckPlayerType deck_player_get_type(const DeckPlayer* player) {
     if (!player) return DECK_PLAYER_NONE;
     return player->type;
@@ -148,6 +313,9 @@ const char* deck_player_get_type_name(const DeckPlayer* player) {
         case DECK_PLAYER_MED: return "OctaMED";
         case DECK_PLAYER_AHX: return "AHX/HVL";
         case DECK_PLAYER_SID: return "Commodore 64 SID";
+        case DECK_PLAYER_XM: return "FastTracker 2 XM";
+        case DECK_PLAYER_S3M: return "Scream Tracker 3 S3M";
+        case DECK_PLAYER_IT: return "Impulse Tracker IT";
         default: return "None";
     }
 }
@@ -164,12 +332,16 @@ const char* deck_player_get_title(const DeckPlayer* player) {
             return ahx_player_get_title(player->ahx_player);
         case DECK_PLAYER_SID:
             return sid_player_get_title(player->sid_player);
+        case DECK_PLAYER_XM:
+        case DECK_PLAYER_S3M:
+        case DECK_PLAYER_IT:
+            return xmit_player_get_title(player->xmit_player);
         default:
             return NULL;
     }
 }
 
-void deck_player_start(DeckPlayer* player) {
+static void deck_start(DeckPlayer* player) {
     if (!player) return;
 
     switch (player->type) {
@@ -185,12 +357,22 @@ void deck_player_start(DeckPlayer* player) {
         case DECK_PLAYER_SID:
             sid_player_start(player->sid_player);
             break;
+        case DECK_PLAYER_XM:
+        case DECK_PLAYER_S3M:
+        case DECK_PLAYER_IT:
+            xmit_player_start(player->xmit_player);
+            break;
         default:
             break;
     }
 }
 
-void deck_player_stop(DeckPlayer* player) {
+void deck_player_start(DeckPlayer* player) {
+    if (!player || lookahead_command(player, DECK_COMMAND_START, 0, 0)) return;
+    deck_start(player);
+}
+
+static void deck_stop(DeckPlayer* player) {
     if (!player) return;
 
     switch (player->type) {
@@ -206,12 +388,22 @@ void deck_player_stop(DeckPlayer* player) {
         case DECK_PLAYER_SID:
             sid_player_stop(player->sid_player);
             break;
+        case DECK_PLAYER_XM:
+        case DECK_PLAYER_S3M:
+        case DECK_PLAYER_IT:
+            xmit_player_stop(player->xmit_player);
+            break;
         default:
             break;
     }
 }
 
-bool deck_player_is_playing(const DeckPlayer* player) {
+void deck_player_stop(DeckPlayer* player) {
+    if (!player || lookahead_command(player, DECK_COMMAND_STOP, 0, 0)) return;
+    deck_stop(player);
+}
+
+static bool deck_is_playing(const DeckPlayer* player) {
     if (!player) return false;
 
     switch (player->type) {
@@ -223,18 +415,30 @@ bool deck_player_is_playing(const DeckPlayer* player) {
             return ahx_player_is_playing(player->ahx_player);
         case DECK_PLAYER_SID:
             return sid_player_is_playing(player->sid_player);
+        case DECK_PLAYER_XM:
+        case DECK_PLAYER_S3M:
+        case DECK_PLAYER_IT:
+            return xmit_player_is_playing(player->xmit_player);
         default:
             return false;
     }
 }
 
+bool deck_player_is_playing(const DeckPlayer* player) {
+    if (!player) return false;
+
+    DeckAudible audible;
+    if (lookahead_audible(player, &audible)) return audible.playing;
+    return deck_is_playing(player);
+}
+
 void deck_player_set_position_callback(DeckPlayer* player, DeckPlayerPositionCallback callback, void* user_data) {
     if (!player) return;
     player->position_callback = callback;
     player->position_callback_userdata = user_data;
 }
 
-void deck_player_get_position(const DeckPlayer* player, uint8_t* order, uint16_t* pattern, uint16_t* row) {
+static void deck_get_position(const DeckPlayer* player, uint8_t* order, uint16_t* pattern, uint16_t* row) {
     if (!player) return;
 
     switch (player->type) {
@@ -256,6 +460,12 @@ void deck_player_get_position(const DeckPlayer* player, uint8_t* order, uint16_t
             ahx_player_get_position(player->ahx_player, pattern, row);
             if (order) *order = 0;  // AHX doesn't expose subsong in position
             break;
+        case DECK_PLAYER_XM:
+        case DECK_PLAYER_S3M:
+        case DECK_PLAYER_IT:
+            xmit_player_get_position(player->xmit_player, NULL, pattern, row);
+            if (order) *order = 0;  // Like MOD/MED, only the pattern is reported
+            break;
         default:
             if (order) *order = 0;
             if (pattern) *pattern = 0;
@@ -264,9 +474,25 @@ void deck_player_get_position(const DeckPlayer* player, uint8_t* order, uint16_t
     }
 }
 
-void deck_player_set_position(DeckPlayer* player, uint8_t order, uint16_t row) {
+void deck_player_get_position(const DeckPlayer* player, uint8_t* order, uint16_t* pattern, uint16_t* row) {
+    if (!player) return;
+
+    DeckAudible audible;
+    if (lookahead_audible(player, &audible)) {
+        if (order) *order = audible.order;
+        if (pattern) *pattern = audible.pattern;
+        if (row) *row = audible.row;
+        return;
+    }
+    deck_get_position(player, order, pattern, row);
+}
+
+static void deck_set_position(DeckPlayer* player, uint8_t order, uint16_t row) {
     if (!player) return;
 
+    // Rebuild the full state from the seek index when possible
+    if (deck_seek(player, order, row)) return;
+
     switch (player->type) {
         case DECK_PLAYER_MOD:
             mod_player_set_position(player->mod_player, order, row);
@@ -275,13 +501,129 @@ void deck_player_set_position(DeckPlayer* player, uint8_t order, uint16_t row) {
             med_player_set_position(player->med_player, order, row);
             break;
         case DECK_PLAYER_AHX:
-            // AHX doesn't have set_position API
+            ahx_player_set_position(player->ahx_player, order, row);
+            break;
+        case DECK_PLAYER_XM:
+        case DECK_PLAYER_S3M:
+        case DECK_PLAYER_IT:
+            xmit_player_set_position(player->xmit_player, order, row);
             break;
         default:
             break;
     }
 }
 
+void deck_player_set_position(DeckPlayer* player, uint8_t order, uint16_t row) {
+    if (!player || lookahead_command(player, DECK_COMMAND_POSITION, order, row)) return;
+    deck_set_position(player, order, row);
+}
+
+size_t deck_player_get_state_size(const DeckPlayer* player) {
+    if (!player) return 0;
+
+    switch (player->type) {
+        case DECK_PLAYER_MOD:
+            return mod_player_get_state_size(player->mod_player);
+        case DECK_PLAYER_MED:
+            return med_player_get_state_size(player->med_player);
+        case DECK_PLAYER_AHX:
+            return ahx_player_get_state_size(player->ahx_player);
+        case DECK_PLAYER_XM:
+        case DECK_PLAYER_S3M:
+        case DECK_PLAYER_IT:
+            return xmit_player_get_state_size(player->xmit_player);
+        default:
+            return 0;
+    }
+}
+
+static bool deck_save_state(const DeckPlayer* player, void* buffer, size_t size) {
+    if (!player) return false;
+
+    switch (player->type) {
+        case DECK_PLAYER_MOD:
+            return mod_player_save_state(player->mod_player, buffer, size);
+        case DECK_PLAYER_MED:
+            return med_player_save_state(player->med_player, buffer, size);
+        case DECK_PLAYER_AHX:
+            return ahx_player_save_state(player->ahx_player, buffer, size);
+        case DECK_PLAYER_XM:
+        case DECK_PLAYER_S3M:
+        case DECK_PLAYER_IT:
+            return xmit_player_save_state(player->xmit_player, buffer, size);
+        default:
+            return false;
+    }
+}
+
+bool deck_player_save_state(const DeckPlayer* player, void* buffer, size_t size) {
+    if (!player) return false;
+
+    // Taken at the frame being heard
+    bool paused = lookahead_pause(player, true);
+    bool saved = deck_save_state(player, buffer, size);
+    lookahead_resume(player, paused, true);
+    return saved;
+}
+
+static bool deck_restore_state(DeckPlayer* player, const void* buffer, size_t size) {
+    if (!player) return false;
+
+    switch (player->type) {
+        case DECK_PLAYER_MOD:
+            return mod_player_restore_state(player->mod_player, buffer, size);
+        case DECK_PLAYER_MED:
+            return med_player_restore_state(player->med_player, buffer, size);
+        case DECK_PLAYER_AHX:
+            return ahx_player_restore_state(player->ahx_player, buffer, size);
+        case DECK_PLAYER_XM:
+        case DECK_PLAYER_S3M:
+        case DECK_PLAYER_IT:
+            return xmit_player_restore_state(player->xmit_player, buffer, size);
+        default:
+            return false;
+    }
+}
+
+bool deck_player_restore_state(DeckPlayer* player, const void* buffer, size_t size) {
+    if (!player) return false;
+
+    bool paused = lookahead_pause(player, false);
+    bool restored = deck_restore_state(player, buffer, size);
+    lookahead_resume(player, paused, restored);
+    return restored;
+}
+
+static uint32_t deck_fast_forward(DeckPlayer* player, uint32_t rows, int sample_rate,
+                                  uint64_t* frames) {
+    if (frames) *frames = 0;
+    if (!player) return 0;
+
+    switch (player->type) {
+        case DECK_PLAYER_MOD:
+            return mod_player_fast_forward(player->mod_player, rows, (uint32_t)sample_rate, frames);
+        case DECK_PLAYER_MED:
+            return med_player_fast_forward(player->med_player, rows, (float)sample_rate, frames);
+        case DECK_PLAYER_AHX:
+            return ahx_player_fast_forward(player->ahx_player, rows, sample_rate, frames);
+        case DECK_PLAYER_XM:
+        case DECK_PLAYER_S3M:
+        case DECK_PLAYER_IT:
+            return xmit_player_fast_forward(player->xmit_player, rows, (uint32_t)sample_rate, frames);
+        default:
+            return 0;
+    }
+}
+
+uint32_t deck_player_fast_forward(DeckPlayer* player, uint32_t rows, int sample_rate) {
+    if (!player) return 0;
+
+    bool paused = lookahead_pause(player, true);
+    uint32_t passed = deck_fast_forward(player, rows, sample_rate, NULL);
+    lookahead_resume(player, paused, true);
+    return passed;
+}
+
 uint8_t deck_player_get_song_length(const DeckPlayer* player) {
     if (!player) return 0;
 
@@ -292,6 +634,14 @@ uint8_t deck_player_get_song_length(const DeckPlayer* player) {
             return med_player_get_song_length(player->med_player);
         case DECK_PLAYER_AHX:
             return ahx_player_get_song_length(player->ahx_player);
+        case DECK_PLAYER_XM:
+        case DECK_PLAYER_S3M:
+        case DECK_PLAYER_IT:
+        {
+            // The deck counts orders in 8 bits
+            uint16_t length = xmit_player_get_song_length(player->xmit_player);
+            return length > 255 ? 255 : (uint8_t)length;
+        }
         default:
             return 0;
     }
@@ -307,12 +657,18 @@ uint8_t deck_player_get_num_channels(const DeckPlayer* player) {
             return med_player_get_num_channels(player->med_player);
         case DECK_PLAYER_AHX:
             return 4;  // AHX is always 4 channels
+        case DECK_PLAYER_SID:
+            return 3;  // SID voices (first chip)
+        case DECK_PLAYER_XM:
+        case DECK_PLAYER_S3M:
+        case DECK_PLAYER_IT:
+            return xmit_player_get_num_channels(player->xmit_player);
         default:
             return 0;
     }
 }
 
-uint16_t deck_player_get_bpm(const DeckPlayer* player) {
+static uint16_t deck_get_bpm(const DeckPlayer* player) {
     if (!player) return 125;
 
     switch (player->type) {
@@ -322,12 +678,24 @@ uint16_t deck_player_get_bpm(const DeckPlayer* player) {
             return med_player_get_bpm(player->med_player);
         case DECK_PLAYER_AHX:
             return 125;  // AHX doesn't expose BPM (uses CIA tempo)
+        case DECK_PLAYER_XM:
+        case DECK_PLAYER_S3M:
+        case DECK_PLAYER_IT:
+            return xmit_player_get_bpm(player->xmit_player);
         default:
             return 125;
     }
 }
 
-void deck_player_set_bpm(DeckPlayer* player, uint16_t bpm) {
+uint16_t deck_player_get_bpm(const DeckPlayer* player) {
+    if (!player) return 125;
+
+    DeckAudible audible;
+    if (lookahead_audible(player, &audible)) return audible.bpm;
+    return deck_get_bpm(player);
+}
+
+static void deck_set_bpm(DeckPlayer* player, uint16_t bpm) {
     if (!player) return;
 
     switch (player->type) {
@@ -341,14 +709,28 @@ void deck_player_set_bpm(DeckPlayer* player, uint16_t bpm) {
         case DECK_PLAYER_AHX:
             // AHX doesn't support BPM changes
             break;
+        case DECK_PLAYER_XM:
+        case DECK_PLAYER_S3M:
+        case DECK_PLAYER_IT:
+            xmit_player_set_bpm(player->xmit_player, bpm);
+            break;
         default:
             break;
     }
 }
 
-void deck_player_set_loop_range(DeckPlayer* player, uint16_t start_order, uint16_t end_order) {
+void deck_player_set_bpm(DeckPlayer* player, uint16_t bpm) {
+    if (!player || lookahead_command(player, DECK_COMMAND_BPM, bpm, 0)) return;
+    deck_set_bpm(player, bpm);
+}
+
+static void deck_set_loop_range(DeckPlayer* player, uint16_t start_order, uint16_t end_order) {
     if (!player) return;
 
+    player->loop_start = start_order;
+    player->loop_end = end_order;
+    player->loop_range_set = true;
+
     switch (player->type) {
         case DECK_PLAYER_MOD:
             mod_player_set_loop_range(player->mod_player, start_order, end_order);
@@ -359,14 +741,26 @@ void deck_player_set_loop_range(DeckPlayer* player, uint16_t start_order, uint16
         case DECK_PLAYER_AHX:
             ahx_player_set_loop_range(player->ahx_player, start_order, end_order);
             break;
+        case DECK_PLAYER_XM:
+        case DECK_PLAYER_S3M:
+        case DECK_PLAYER_IT:
+            xmit_player_set_loop_range(player->xmit_player, start_order, end_order);
+            break;
         default:
             break;
     }
 }
 
-void deck_player_set_disable_looping(DeckPlayer* player, bool disable) {
+void deck_player_set_loop_range(DeckPlayer* player, uint16_t start_order, uint16_t end_order) {
+    if (!player || lookahead_command(player, DECK_COMMAND_LOOP_RANGE, start_order, end_order)) return;
+    deck_set_loop_range(player, start_order, end_order);
+}
+
+static void deck_set_disable_looping(DeckPlayer* player, bool disable) {
     if (!player) return;
 
+    player->looping_disabled = disable;
+
     switch (player->type) {
         case DECK_PLAYER_MOD:
             mod_player_set_disable_looping(player->mod_player, disable);
@@ -377,20 +771,22 @@ void deck_player_set_disable_looping(DeckPlayer* player, bool disable) {
         case DECK_PLAYER_AHX:
             ahx_player_set_disable_looping(player->ahx_player, disable);
             break;
+        case DECK_PLAYER_XM:
+        case DECK_PLAYER_S3M:
+        case DECK_PLAYER_IT:
+            xmit_player_set_disable_looping(player->xmit_player, disable);
+            break;
         default:
             break;
     }
 }
 
-void deck_player_set_channel_mute(DeckPlayer* player, uint8_t channel, bool muted) {
-    if (!player) return;
-
-    // SID has 3 voices, others have 4 channels
-    uint8_t max_channels = (player->type == DECK_PLAYER_SID) ? 3 : 4;
-    if (channel >= max_channels) return;
-
-    player->channel_muted[channel] = muted;
+void deck_player_set_disable_looping(DeckPlayer* player, bool disable) {
+    if (!player || lookahead_command(player, DECK_COMMAND_DISABLE_LOOPING, disable, 0)) return;
+    deck_set_disable_looping(player, disable);
+}
 
+static void deck_set_channel_mute(DeckPlayer* player, uint8_t channel, bool muted) {
     switch (player->type) {
         case DECK_PLAYER_MOD:
             mod_player_set_channel_mute(player->mod_player, channel, muted);
@@ -404,24 +800,37 @@ void deck_player_set_channel_mute(DeckPlayer* player, uint8_t channel, bool mute
         case DECK_PLAYER_SID:
             sid_player_set_voice_mute(player->sid_player, channel, muted);
             break;
+        case DECK_PLAYER_XM:
+        case DECK_PLAYER_S3M:
+        case DECK_PLAYER_IT:
+            xmit_player_set_channel_mute(player->xmit_player, channel, muted);
+            break;
         default:
             break;
     }
 }
 
+void deck_player_set_channel_mute(DeckPlayer* player, uint8_t channel, bool muted) {
+    if (!player) return;
+
+    if (channel >= deck_player_get_num_channels(player) || channel >= DECK_PLAYER_MAX_CHANNELS) return;
+
+    player->channel_muted[channel] = muted;
+    if (lookahead_command(player, DECK_COMMAND_MUTE, channel, muted)) return;
+    deck_set_channel_mute(player, channel, muted);
+}
+
 bool deck_player_get_channel_mute(const DeckPlayer* player, uint8_t channel) {
-    if (!player || channel >= 4) return false;
+    if (!player || channel >= DECK_PLAYER_MAX_CHANNELS) return false;
     return player->channel_muted[channel];
 }
 
-void deck_player_process_channels(DeckPlayer* player,
-                                   float* left,
-                                   float* right,
-                                   float* channel_outputs[4],
-                                   size_t num_samples,
-                                   int sample_rate) {
-    if (!player || !left || !right) return;
-
+static void deck_render(DeckPlayer* player,
+                        float* left,
+                        float* right,
+                        float* channel_outputs[4],
+                        size_t num_samples,
+                        int sample_rate) {
     // Clear outputs
     memset(left, 0, num_samples * sizeof(float));
     memset(right, 0, num_samples * sizeof(float));
@@ -451,27 +860,52 @@ void deck_player_process_channels(DeckPlayer* player,
                                   num_samples, sample_rate);
             }
             break;
+        case DECK_PLAYER_XM:
+        case DECK_PLAYER_S3M:
+        case DECK_PLAYER_IT:
+            xmit_player_process_channels(player->xmit_player, left, right,
+                                         channel_outputs, 4, num_samples, sample_rate);
+            break;
         default:
             break;
     }
 }
 
+void deck_player_process_channels(DeckPlayer* player,
+                                   float* left,
+                                   float* right,
+                                   float* channel_outputs[4],
+                                   size_t num_samples,
+                                   int sample_rate) {
+    if (!player || !left || !right) return;
+
+    if (lookahead_process(player, left, right, channel_outputs, num_samples, sample_rate)) return;
+    deck_render(player, left, right, channel_outputs, num_samples, sample_rate);
+}
+
 void deck_player_process(DeckPlayer* player, float* left, float* right, size_t num_samples, int sample_rate) {
     deck_player_process_channels(player, left, right, NULL, num_samples, sample_rate);
 }
 
+// Forward a row start to the user callback (the look-ahead reports it when
+// the row is heard)
+static void report_position(DeckPlayer* player, uint8_t order, uint16_t pattern, uint16_t row) {
+    if (lookahead_capture_position(player, order, pattern, row)) return;
+    player->position_callback(order, pattern, row, player->position_callback_userdata);
+}
+
 // Internal position callbacks that forward to user callback
 static void mod_position_callback(uint8_t order, uint8_t pattern, uint16_t row, void* user_data) {
     DeckPlayer* player = (DeckPlayer*)user_data;
     if (player && player->position_callback) {
-        player->position_callback(order, pattern, row, player->position_callback_userdata);
+        report_position(player, order, pattern, row);
     }
 }
 
 static void med_position_callback(uint8_t order, uint8_t pattern, uint16_t row, void* user_data) {
     DeckPlayer* player = (DeckPlayer*)user_data;
     if (player && player->position_callback) {
-        player->position_callback(order, pattern, row, player->position_callback_userdata);
+        report_position(player, order, pattern, row);
     }
 }
 
@@ -480,7 +914,7 @@ static void ahx_position_callback(uint8_t subsong, uint16_t position, uint16_t r
     if (player && player->position_callback) {
         // For AHX: position = sequence position (should be ORDER), subsong not used
         // Remap: order=position, pattern=0 (AHX doesn't have separate patterns)
-        player->position_callback(position, 0, row, player->position_callback_userdata);
+        report_position(player, position, 0, row);
     }
 }
 
@@ -490,7 +924,14 @@ static void sid_position_callback(uint8_t subsong, uint32_t time_ms, void* user_
         // SID uses time_ms instead of row - convert to compatible format
         // Use time_ms/1000 as "row" for compatibility
         uint16_t seconds = time_ms / 1000;
-        player->position_callback(subsong, 0, seconds, player->position_callback_userdata);
+        report_position(player, subsong, 0, seconds);
+    }
+}
+
+static void xmit_position_callback(uint16_t order, uint16_t pattern, uint16_t row, void* user_data) {
+    DeckPlayer* player = (DeckPlayer*)user_data;
+    if (player && player->position_callback) {
+        report_position(player, (uint8_t)order, pattern, row);
     }
 }
 
@@ -504,7 +945,907 @@ PatternSequencer* deck_player_get_sequencer(DeckPlayer* player) {
             return med_player_get_sequencer(player->med_player);
         case DECK_PLAYER_AHX:
             return ahx_player_get_sequencer(player->ahx_player);
+        case DECK_PLAYER_XM:
+        case DECK_PLAYER_S3M:
+        case DECK_PLAYER_IT:
+            return xmit_player_get_sequencer(player->xmit_player);
         default:
             return NULL;
     }
 }
+
+// Seek index
+// The scan plays the song once from the start, stopping when it ends or
+// jumps back into an order it already played (the song loop). Each row is
+// looked up by the first time it is played.
+
+static int compare_positions(const void* a, const void* b) {
+    const DeckSeekEntry* x = (const DeckSeekEntry*)a;
+    const DeckSeekEntry* y = (const DeckSeekEntry*)b;
+    if (x->order != y->order) return x->order < y->order ? -1 : 1;
+    if (x->row != y->row) return x->row < y->row ? -1 : 1;
+    return 0;
+}
+
+static int compare_entries(const void* a, const void* b) {
+    int result = compare_positions(a, b);
+    if (result != 0) return result;
+
+    const DeckSeekEntry* x = (const DeckSeekEntry*)a;
+    const DeckSeekEntry* y = (const DeckSeekEntry*)b;
+    if (x->timeline_row != y->timeline_row) return x->timeline_row < y->timeline_row ? -1 : 1;
+    return 0;
+}
+
+// Order and row about to be played (the player is at a row start)
+static void row_start_position(DeckPlayer* player, uint16_t* order, uint16_t* row) {
+    if (player->type == DECK_PLAYER_AHX) {
+        ahx_player_get_position(player->ahx_player, order, row);
+        return;
+    }
+
+    uint16_t pattern;
+    pattern_sequencer_get_position(deck_player_get_sequencer(player), order, &pattern, row);
+}
+
+static bool add_entry(DeckSeekIndex* index, uint32_t* capacity, uint16_t order, uint16_t row,
+                      uint32_t timeline_row) {
+    if (index->num_entries == *capacity) {
+        uint32_t new_capacity = *capacity ? *capacity * 2 : 256;
+        DeckSeekEntry* entries = realloc(index->entries, new_capacity * sizeof(DeckSeekEntry));
+        if (!entries) return false;
+        index->entries = entries;
+        *capacity = new_capacity;
+    }
+
+    DeckSeekEntry* entry = &index->entries[index->num_entries++];
+    entry->order = order;
+    entry->row = row;
+    entry->timeline_row = timeline_row;
+    return true;
+}
+
+static bool add_keyframe(DeckSeekIndex* index, uint32_t* capacity, const DeckPlayer* scan,
+                         uint64_t frame) {
+    if (index->num_keyframes == *capacity) {
+        uint32_t new_capacity = *capacity ? *capacity * 2 : 16;
+        uint8_t* keyframes = realloc(index->keyframes, new_capacity * index->keyframe_size);
+        if (!keyframes) return false;
+        index->keyframes = keyframes;
+
+        uint64_t* keyframe_frames = realloc(index->keyframe_frames, new_capacity * sizeof(uint64_t));
+        if (!keyframe_frames) return false;
+        index->keyframe_frames = keyframe_frames;
+        *capacity = new_capacity;
+    }
+
+    uint8_t* keyframe = index->keyframes + index->num_keyframes * index->keyframe_size;
+    if (!deck_player_save_state(scan, keyframe, index->keyframe_size)) return false;
+    index->keyframe_frames[index->num_keyframes] = frame;
+    index->num_keyframes++;
+    return true;
+}
+
+DeckSeekIndex* deck_seek_index_build(const uint8_t* data, size_t size,
+                                     uint16_t rows_per_keyframe, int sample_rate) {
+    if (!data || size == 0 || sample_rate <= 0) return NULL;
+    if (rows_per_keyframe == 0) rows_per_keyframe = DECK_PLAYER_DEFAULT_KEYFRAME_ROWS;
+
+    DeckPlayer* scan = deck_player_create();
+    DeckSeekIndex* index = calloc(1, sizeof(DeckSeekIndex));
+    uint8_t* visited = calloc(65536 / 8, 1);  // Orders played so far
+
+    // The scan deck is gone before data, so nothing needs copying
+    bool ok = scan && index && visited && load_data(scan, data, size, true) &&
+              scan->type != DECK_PLAYER_NONE && scan->type != DECK_PLAYER_SID;
+
+    if (ok) {
+        index->type = scan->type;
+        index->data_hash = hash_data(data, size);
+        index->sample_rate = sample_rate;
+        index->rows_per_keyframe = rows_per_keyframe;
+        index->keyframe_size = deck_player_get_state_size(scan);
+
+        deck_player_set_disable_looping(scan, true);
+        deck_player_start(scan);
+
+        uint64_t frames;
+        deck_fast_forward(scan, 0, sample_rate, &frames);
+        index->length = frames;
+
+        uint8_t song_length = deck_player_get_song_length(scan);
+        uint32_t max_rows = (song_length ? song_length : 1) * (uint32_t)DECK_SEEK_MAX_ROWS_PER_ORDER;
+        uint32_t entry_capacity = 0;
+        uint32_t keyframe_capacity = 0;
+        uint32_t prev_order = UINT32_MAX;
+
+        for (uint32_t timeline_row = 0; timeline_row < max_rows && deck_player_is_playing(scan); timeline_row++) {
+            uint16_t order, row;
+            row_start_position(scan, &order, &row);
+
+            if (order != prev_order) {
+                if (visited[order >> 3] & (1u << (order & 7))) break;
+                visited[order >> 3] |= (uint8_t)(1u << (order & 7));
+                prev_order = order;
+            }
+
+            if (!add_entry(index, &entry_capacity, order, row, timeline_row) ||
+                (timeline_row % rows_per_keyframe == 0 &&
+                 !add_keyframe(index, &keyframe_capacity, scan, index->length))) {
+                ok = false;
+                break;
+            }
+
+            deck_fast_forward(scan, 1, sample_rate, &frames);
+            index->length += frames;
+        }
+        index->song_ended = !deck_player_is_playing(scan);
+    }
+
+    if (ok && index->num_entries > 0) {
+        // Sort for lookup, keeping only the first visit of each row
+        qsort(index->entries, index->num_entries, sizeof(DeckSeekEntry), compare_entries);
+
+        uint32_t count = 0;
+        for (uint32_t i = 0; i < index->num_entries; i++) {
+            if (count == 0 || compare_positions(&index->entries[i], &index->entries[count - 1]) != 0) {
+                index->entries[count++] = index->entries[i];
+            }
+        }
+        index->num_entries = count;
+    } else {
+        ok = false;
+    }
+
+    free(visited);
+    deck_player_destroy(scan);
+
+    if (!ok) {
+        deck_seek_index_destroy(index);
+        return NULL;
+    }
+    return index;
+}
+
+void deck_seek_index_destroy(DeckSeekIndex* index) {
+    if (!index) return;
+    free(index->entries);
+    free(index->keyframes);
+    free(index->keyframe_frames);
+    free(index);
+}
+
+uint32_t deck_seek_index_get_num_keyframes(const DeckSeekIndex* index) {
+    return index ? index->num_keyframes : 0;
+}
+
+uint64_t deck_seek_index_get_keyframe_frame(const DeckSeekIndex* index, uint32_t keyframe) {
+    if (!index || keyframe >= index->num_keyframes) return 0;
+    return index->keyframe_frames[keyframe];
+}
+
+uint64_t deck_seek_index_get_length(const DeckSeekIndex* index, bool* song_ended) {
+    if (song_ended) *song_ended = index && index->song_ended;
+    return index ? index->length : 0;
+}
+
+bool deck_player_set_seek_index(DeckPlayer* player, DeckSeekIndex* index) {
+    if (!player || (index && (index->type != player->type || index->data_hash != deck_data_hash(player)))) {
+        deck_seek_index_destroy(index);
+        return false;
+    }
+
+    // The worker may be seeking with the current one
+    bool paused = lookahead_pause(player, false);
+    deck_seek_index_destroy(player->seek_index);
+    player->seek_index = index;
+    lookahead_resume(player, paused, false);
+    return true;
+}
+
+// Restore the keyframe before the row and play silently up to it
+static bool deck_seek(DeckPlayer* player, uint8_t order, uint16_t row) {
+    const DeckSeekIndex* index = player->seek_index;
+    if (!index || index->type != player->type || !deck_is_playing(player)) return false;
+
+    DeckSeekEntry key = { order, row, 0 };
+    const DeckSeekEntry* entry = bsearch(&key, index->entries, index->num_entries,
+                                         sizeof(DeckSeekEntry), compare_positions);
+    if (!entry) return false;
+
+    uint32_t keyframe = entry->timeline_row / index->rows_per_keyframe;
+    if (keyframe >= index->num_keyframes) return false;
+
+    if (!deck_restore_state(player, index->keyframes + keyframe * index->keyframe_size,
+                            index->keyframe_size)) {
+        return false;
+    }
+
+    deck_fast_forward(player, entry->timeline_row - keyframe * index->rows_per_keyframe,
+                      index->sample_rate, NULL);
+    return true;
+}
+
+bool deck_player_restore_keyframe(DeckPlayer* player, const DeckSeekIndex* index, uint32_t keyframe) {
+    if (!player || !index || keyframe >= index->num_keyframes ||
+        index->type != player->type || index->data_hash != deck_data_hash(player)) {
+        return false;
+    }
+
+    bool paused = lookahead_pause(player, false);
+    bool restored = deck_restore_state(player, index->keyframes + keyframe * index->keyframe_size,
+                                       index->keyframe_size);
+    lookahead_resume(player, paused, restored);
+    return restored;
+}
+
+// Look-ahead rendering
+// A worker renders the deck in blocks of DECK_LOOKAHEAD_BLOCK frames into a
+// ring that process() copies from, block n of the output always going to
+// slot n % num_slots. Control calls are queued with the frame process() is
+// at; the worker goes back to the snapshot it took at the start of the block
+// holding that frame and renders on from there with the call applied at its
+// frame, writing over the blocks it had rendered. Until a block is replaced,
+// process() keeps playing the old one. Slots are written under a sequence
+// count, so process() never waits on a lock.
+
+#ifdef DECK_PLAYER_THREADS
+
+#define DECK_LOOKAHEAD_BLOCK 256          // Frames per block
+#define DECK_LOOKAHEAD_MAX_MS 2000
+#define DECK_LOOKAHEAD_COMMANDS 256       // Control calls queued for the worker
+#define DECK_LOOKAHEAD_LOG 1024           // Control calls kept for re-rendering
+#define DECK_LOOKAHEAD_ROWS 8             // Row starts kept per block
+#define DECK_LOOKAHEAD_READ_TRIES 64      // Reads of a slot being written before giving up
+#define DECK_LOOKAHEAD_POLL_NS 500000     // Sleep while there is nothing to do
+
+typedef struct {
+    uint8_t type;           // DeckCommandType
+    uint16_t a;
+    uint16_t b;
+    uint64_t frame;         // Output frame it takes effect at
+} DeckCommand;
+
+// User controls, which player snapshots do not hold
+typedef struct {
+    uint64_t muted;         // Bit per channel
+    uint16_t loop_start;
+    uint16_t loop_end;
+    bool loop_range_set;
+    bool looping_disabled;
+} DeckControls;
+
+// Player state at the start of a block
+typedef struct {
+    uint64_t index;         // Block it was taken for, UINT64_MAX = none
+    DeckControls controls;
+    uint8_t* state;
+} DeckBlockState;
+
+typedef struct {
+    uint16_t offset;        // Frame in the block
+    uint8_t order;
+    uint16_t pattern;
+    uint16_t row;
+} DeckRow;
+
+typedef struct {
+    uint64_t index;         // Output frame / DECK_LOOKAHEAD_BLOCK, UINT64_MAX = none
+    uint64_t audible;       // Packed DeckAudible at the end of the block
+    uint8_t num_rows;
+    DeckRow rows[DECK_LOOKAHEAD_ROWS];
+} DeckBlockInfo;
+
+typedef struct {
+    DeckBlockInfo info;
+    float audio[6][DECK_LOOKAHEAD_BLOCK];  // Left, right and the 4 channel outputs
+} DeckBlock;
+
+typedef struct {
+    uint32_t version;       // Odd while the worker writes the block
+    DeckBlock block;
+} DeckSlot;
+
+struct DeckLookahead {
+    int sample_rate;
+    uint32_t lookahead_ms;
+    uint64_t lookahead_frames;
+    pthread_t thread;
+
+    DeckSlot* slots;
+    uint32_t num_slots;
+
+    // Shared between the threads (atomic access)
+    uint64_t consumed_frame;    // Frames output by process()
+    uint64_t audible;           // Packed DeckAudible of the block being played
+    uint32_t underruns;
+    uint32_t command_head;      // Written by control calls
+    uint32_t command_tail;      // Written by the worker
+    DeckCommand commands[DECK_LOOKAHEAD_COMMANDS];
+    int pause_request;
+    int paused;
+    int quit;
+
+    // Control calls
+    int pause_depth;
+    bool pause_sync;            // Bring the player to the frame being heard
+    bool pause_rerender;
+
+    // process()
+    uint64_t frame;
+
+    // Worker
+    uint64_t render_frame;      // Next frame to render
+    bool worker_paused;
+    bool rewind;                // Snapshots allow re-rendering (all but SID)
+    DeckControls controls;      // As applied to the player
+    DeckCommand log[DECK_LOOKAHEAD_LOG];  // Sorted by frame
+    uint32_t log_count;
+    uint32_t log_next;          // First call not applied yet
+    DeckBlockState* states;     // Block n at n % num_states
+    uint32_t num_states;
+    uint8_t* state_data;
+    size_t state_size;
+    DeckBlock current;          // Block being rendered
+    bool capture;               // Row starts go to the current block
+};
+
+static void lookahead_sleep(void) {
+    struct timespec delay = { 0, DECK_LOOKAHEAD_POLL_NS };
+    nanosleep(&delay, NULL);
+}
+
+static uint64_t pack_audible(const DeckAudible* audible) {
+    return (uint64_t)audible->order | (uint64_t)audible->pattern << 8 | (uint64_t)audible->row << 24 |
+           (uint64_t)audible->bpm << 40 | (uint64_t)audible->playing << 56;
+}
+
+static DeckAudible unpack_audible(uint64_t packed) {
+    DeckAudible audible;
+    audible.order = (uint8_t)packed;
+    audible.pattern = (uint16_t)(packed >> 8);
+    audible.row = (uint16_t)(packed >> 24);
+    audible.bpm = (uint16_t)(packed >> 40);
+    audible.playing = (packed >> 56) & 1;
+    return audible;
+}
+
+static DeckAudible deck_audible(const DeckPlayer* player) {
+    DeckAudible audible;
+    deck_get_position(player, &audible.order, &audible.pattern, &audible.row);
+    audible.bpm = deck_get_bpm(player);
+    audible.playing = deck_is_playing(player);
+    return audible;
+}
+
+static void apply_controls(DeckPlayer* player, const DeckControls* controls) {
+    uint8_t num_channels = deck_player_get_num_channels(player);
+    for (uint8_t i = 0; i < num_channels && i < DECK_PLAYER_MAX_CHANNELS; i++) {
+        deck_set_channel_mute(player, i, (controls->muted >> i) & 1);
+    }
+    if (controls->loop_range_set) {
+        deck_set_loop_range(player, controls->loop_start, controls->loop_end);
+    }
+    deck_set_disable_looping(player, controls->looping_disabled);
+    player->lookahead->controls = *controls;
+}
+
+static void lookahead_apply(DeckPlayer* player, const DeckCommand* command) {
+    DeckControls* controls = &player->lookahead->controls;
+
+    switch (command->type) {
+        case DECK_COMMAND_START:
+            deck_start(player);
+            break;
+        case DECK_COMMAND_STOP:
+            deck_stop(player);
+            break;
+        case DECK_COMMAND_POSITION:
+            deck_set_position(player, (uint8_t)command->a, command->b);
+            break;
+        case DECK_COMMAND_BPM:
+            deck_set_bpm(player, command->a);
+            break;
+        case DECK_COMMAND_LOOP_RANGE:
+            deck_set_loop_range(player, command->a, command->b);
+            controls->loop_start = command->a;
+            controls->loop_end = command->b;
+            controls->loop_range_set = true;
+            break;
+        case DECK_COMMAND_DISABLE_LOOPING:
+            deck_set_disable_looping(player, command->a != 0);
+            controls->looping_disabled = command->a != 0;
+            break;
+        case DECK_COMMAND_MUTE:
+            deck_set_channel_mute(player, (uint8_t)command->a, command->b != 0);
+            if (command->b) {
+                controls->muted |= (uint64_t)1 << command->a;
+            } else {
+                controls->muted &= ~((uint64_t)1 << command->a);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+// Drop applied calls older than every snapshot (never rendered again); with
+// `full`, make room even if one has to go early
+static void lookahead_trim_log(DeckLookahead* lookahead, bool full) {
+    uint64_t oldest = UINT64_MAX;
+    for (uint32_t i = 0; i < lookahead->num_states; i++) {
+        if (lookahead->states[i].index < oldest) oldest = lookahead->states[i].index;
+    }
+    uint64_t oldest_frame = oldest == UINT64_MAX ? UINT64_MAX : oldest * DECK_LOOKAHEAD_BLOCK;
+
+    uint32_t drop = 0;
+    while (drop < lookahead->log_next && lookahead->log[drop].frame < oldest_frame) drop++;
+    if (drop == 0 && full && lookahead->log_next > 0) drop = 1;
+    if (drop == 0) return;
+
+    memmove(lookahead->log, lookahead->log + drop, (lookahead->log_count - drop) * sizeof(DeckCommand));
+    lookahead->log_count -= drop;
+    lookahead->log_next -= drop;
+}
+
+// Copy the current block to its slot, unless process() is past it
+static void lookahead_publish(DeckLookahead* lookahead) {
+    const DeckBlock* block = &lookahead->current;
+    if (block->info.index < LOAD_ACQUIRE(lookahead->consumed_frame) / DECK_LOOKAHEAD_BLOCK) return;
+
+    DeckSlot* slot = &lookahead->slots[block->info.index % lookahead->num_slots];
+    uint32_t version = seqlock_write_begin(&slot->version);
+    slot->block = *block;
+    seqlock_write_end(&slot->version, version);
+}
+
+// Render from render_frame up to `end` or the end of its block, applying
+// logged calls at their frames. The block is published once complete.
+static void lookahead_render_to(DeckPlayer* player, uint64_t end) {
+    DeckLookahead* lookahead = player->lookahead;
+    DeckBlock* block = &lookahead->current;
+    uint64_t index = lookahead->render_frame / DECK_LOOKAHEAD_BLOCK;
+    uint64_t block_end = (index + 1) * DECK_LOOKAHEAD_BLOCK;
+    if (end > block_end) end = block_end;
+
+    if (lookahead->render_frame % DECK_LOOKAHEAD_BLOCK == 0) {
+        if (lookahead->rewind) {
+            DeckBlockState* state = &lookahead->states[index % lookahead->num_states];
+            bool saved = deck_save_state(player, state->state, lookahead->state_size);
+            state->index = saved ? index : UINT64_MAX;
+            state->controls = lookahead->controls;
+        }
+        block->info.num_rows = 0;
+    }
+    block->info.index = index;
+
+    lookahead->capture = true;
+    while (lookahead->render_frame < end) {
+        while (lookahead->log_next < lookahead->log_count &&
+               lookahead->log[lookahead->log_next].frame <= lookahead->render_frame) {
+            lookahead_apply(player, &lookahead->log[lookahead->log_next++]);
+        }
+
+        uint64_t count = end - lookahead->render_frame;
+        if (lookahead->log_next < lookahead->log_count) {
+            uint64_t next = lookahead->log[lookahead->log_next].frame - lookahead->render_frame;
+            if (next < count) count = next;
+        }
+
+        size_t offset = (size_t)(lookahead->render_frame % DECK_LOOKAHEAD_BLOCK);
+        float* channels[4] = { block->audio[2] + offset, block->audio[3] + offset,
+                               block->audio[4] + offset, block->audio[5] + offset };
+        deck_render(player, block->audio[0] + offset, block->audio[1] + offset, channels, (size_t)count,
+                    lookahead->sample_rate);
+        lookahead->render_frame += count;
+    }
+    lookahead->capture = false;
+
+    if (lookahead->render_frame == block_end) {
+        DeckAudible audible = deck_audible(player);
+        block->info.audible = pack_audible(&audible);
+        lookahead_publish(lookahead);
+        lookahead_trim_log(lookahead, false);
+    }
+}
+
+// Go back to the start of the block holding a frame already rendered.
+// Returns false if the frame is not behind the worker or the block has no
+// snapshot.
+static bool lookahead_rewind(DeckPlayer* player, uint64_t frame) {
+    DeckLookahead* lookahead = player->lookahead;
+    if (!lookahead->rewind || frame >= lookahead->render_frame) return false;
+
+    uint64_t index = frame / DECK_LOOKAHEAD_BLOCK;
+    DeckBlockState* state = &lookahead->states[index % lookahead->num_states];
+    if (state->index != index || !deck_restore_state(player, state->state, lookahead->state_size)) return false;
+    apply_controls(player, &state->controls);
+
+    // Calls from the block on are applied again
+    uint64_t start = index * DECK_LOOKAHEAD_BLOCK;
+    lookahead->log_next = 0;
+    while (lookahead->log_next < lookahead->log_count && lookahead->log[lookahead->log_next].frame < start) {
+        lookahead->log_next++;
+    }
+    lookahead->render_frame = start;
+    return true;
+}
+
+static void lookahead_take_commands(DeckPlayer* player) {
+    DeckLookahead* lookahead = player->lookahead;
+    uint32_t head = LOAD_ACQUIRE(lookahead->command_head);
+    uint32_t tail = lookahead->command_tail;
+    if (tail == head) return;
+
+    uint64_t first = lookahead->commands[tail % DECK_LOOKAHEAD_COMMANDS].frame;
+    for (; tail != head; tail++) {
+        if (lookahead->log_count == DECK_LOOKAHEAD_LOG) {
+            lookahead_trim_log(lookahead, true);
+            if (lookahead->log_count == DECK_LOOKAHEAD_LOG) break;  // Taken once some are applied
+        }
+        lookahead->log[lookahead->log_count++] = lookahead->commands[tail % DECK_LOOKAHEAD_COMMANDS];
+    }
+    STORE_RELEASE(lookahead->command_tail, tail);
+
+    // Calls at frames not rendered yet are applied when rendering gets there
+    lookahead_rewind(player, first);
+}
+
+static void* lookahead_worker(void* arg) {
+    DeckPlayer* player = (DeckPlayer*)arg;
+    DeckLookahead* lookahead = player->lookahead;
+
+    while (!LOAD_ACQUIRE(lookahead->quit)) {
+        // Calls made before a pause are applied before it
+        bool pause = LOAD_ACQUIRE(lookahead->pause_request);
+        lookahead_take_commands(player);
+
+        if (pause) {
+            if (!lookahead->worker_paused) {
+                if (lookahead->pause_sync) {
+                    uint64_t consumed = LOAD_ACQUIRE(lookahead->consumed_frame);
+                    lookahead_rewind(player, consumed);
+                    while (lookahead->render_frame < consumed) lookahead_render_to(player, consumed);
+                }
+                while (lookahead->log_next < lookahead->log_count) {
+                    lookahead_apply(player, &lookahead->log[lookahead->log_next++]);
+                }
+                lookahead->worker_paused = true;
+                STORE_RELEASE(lookahead->paused, 1);
+            }
+            lookahead_sleep();
+            continue;
+        }
+        if (lookahead->worker_paused) {
+            lookahead->worker_paused = false;
+            STORE_RELEASE(lookahead->paused, 0);
+        }
+
+        uint64_t consumed = LOAD_ACQUIRE(lookahead->consumed_frame);
+        if (lookahead->render_frame < consumed + lookahead->lookahead_frames &&
+            lookahead->render_frame / DECK_LOOKAHEAD_BLOCK < consumed / DECK_LOOKAHEAD_BLOCK + lookahead->num_slots) {
+            lookahead_render_to(player, UINT64_MAX);
+        } else {
+            lookahead_sleep();
+        }
+    }
+    return NULL;
+}
+
+// Set the worker up for the loaded song, rendering from the frame being
+// heard (the worker is paused or not started)
+static void lookahead_prepare(const DeckPlayer* player) {
+    DeckLookahead* lookahead = player->lookahead;
+
+    size_t state_size = deck_player_get_state_size(player);
+    if (state_size != lookahead->state_size) {
+        free(lookahead->state_data);
+        lookahead->state_data = state_size ? malloc(state_size * lookahead->num_states) : NULL;
+        lookahead->state_size = lookahead->state_data ? state_size : 0;
+    }
+    for (uint32_t i = 0; i < lookahead->num_states; i++) {
+        lookahead->states[i].index = UINT64_MAX;
+        lookahead->states[i].state = lookahead->state_data + i * lookahead->state_size;
+    }
+    lookahead->rewind = lookahead->state_size > 0;
+
+    DeckControls controls = { 0 };
+    for (int i = 0; i < DECK_PLAYER_MAX_CHANNELS; i++) {
+        if (player->channel_muted[i]) controls.muted |= (uint64_t)1 << i;
+    }
+    controls.loop_start = player->loop_start;
+    controls.loop_end = player->loop_end;
+    controls.loop_range_set = player->loop_range_set;
+    controls.looping_disabled = player->looping_disabled;
+    lookahead->controls = controls;
+
+    lookahead->log_count = 0;
+    lookahead->log_next = 0;
+    lookahead->render_frame = LOAD_ACQUIRE(lookahead->consumed_frame);
+    lookahead->current.info.num_rows = 0;
+}
+
+static void lookahead_free(DeckLookahead* lookahead) {
+    free(lookahead->slots);
+    free(lookahead->states);
+    free(lookahead->state_data);
+    free(lookahead);
+}
+
+static bool lookahead_start(DeckPlayer* player, uint32_t lookahead_ms, int sample_rate) {
+    DeckLookahead* lookahead = calloc(1, sizeof(DeckLookahead));
+    if (!lookahead) return false;
+
+    if (lookahead_ms > DECK_LOOKAHEAD_MAX_MS) lookahead_ms = DECK_LOOKAHEAD_MAX_MS;
+    lookahead->sample_rate = sample_rate;
+    lookahead->lookahead_ms = lookahead_ms;
+    lookahead->lookahead_frames = (uint64_t)sample_rate * lookahead_ms / 1000;
+
+    // The blocks ahead, the one being played and the one being rendered
+    lookahead->num_slots = (uint32_t)((lookahead->lookahead_frames + DECK_LOOKAHEAD_BLOCK - 1) /
+                                      DECK_LOOKAHEAD_BLOCK) + 2;
+    lookahead->num_states = lookahead->num_slots + 2;
+    lookahead->slots = calloc(lookahead->num_slots, sizeof(DeckSlot));
+    lookahead->states = calloc(lookahead->num_states, sizeof(DeckBlockState));
+    if (!lookahead->slots || !lookahead->states) {
+        lookahead_free(lookahead);
+        return false;
+    }
+    for (uint32_t i = 0; i < lookahead->num_slots; i++) {
+        lookahead->slots[i].block.info.index = UINT64_MAX;
+    }
+
+    DeckAudible audible = deck_audible(player);
+    lookahead->audible = pack_audible(&audible);
+
+    player->lookahead = lookahead;
+    lookahead_prepare(player);
+
+    // Have the look-ahead ready for the first process() call
+    while (lookahead->render_frame < lookahead->lookahead_frames) {
+        lookahead_render_to(player, UINT64_MAX);
+    }
+
+    if (pthread_create(&lookahead->thread, NULL, lookahead_worker, player) != 0) {
+        player->lookahead = NULL;
+        lookahead_free(lookahead);
+        return false;
+    }
+    return true;
+}
+
+// Stop the worker, leaving the player at the frame being heard
+static void lookahead_stop(DeckPlayer* player) {
+    DeckLookahead* lookahead = player->lookahead;
+    if (!lookahead) return;
+
+    lookahead_pause(player, true);
+    STORE_RELEASE(lookahead->quit, 1);
+    pthread_join(lookahead->thread, NULL);
+
+    player->lookahead = NULL;
+    lookahead_free(lookahead);
+}
+
+static bool lookahead_command(DeckPlayer* player, DeckCommandType type, uint16_t a, uint16_t b) {
+    DeckLookahead* lookahead = player->lookahead;
+    if (!lookahead || lookahead->pause_depth > 0) return false;
+
+    uint32_t head = lookahead->command_head;
+    while (head - LOAD_ACQUIRE(lookahead->command_tail) >= DECK_LOOKAHEAD_COMMANDS) {
+        lookahead_sleep();
+    }
+
+    // The worker re-renders from the frame being heard. SID tunes cannot go
+    // back, so there the call takes effect after the blocks already rendered.
+    DeckCommand* command = &lookahead->commands[head % DECK_LOOKAHEAD_COMMANDS];
+    command->type = (uint8_t)type;
+    command->a = a;
+    command->b = b;
+    command->frame = LOAD_ACQUIRE(lookahead->consumed_frame);
+    STORE_RELEASE(lookahead->command_head, head + 1);
+    return true;
+}
+
+static bool lookahead_audible(const DeckPlayer* player, DeckAudible* audible) {
+    if (!player->lookahead) return false;
+    *audible = unpack_audible(LOAD_ACQUIRE(player->lookahead->audible));
+    return true;
+}
+
+// Hand the player over to the calling thread until lookahead_resume()
+static bool lookahead_pause(const DeckPlayer* player, bool sync) {
+    DeckLookahead* lookahead = player->lookahead;
+    if (!lookahead) return false;
+
+    if (lookahead->pause_depth++ == 0) {
+        lookahead->pause_sync = sync;
+        STORE_RELEASE(lookahead->pause_request, 1);
+        while (!LOAD_ACQUIRE(lookahead->paused)) lookahead_sleep();
+    }
+    return true;
+}
+
+// rerender: the call changed the player, so the blocks ahead are replaced
+static void lookahead_resume(const DeckPlayer* player, bool paused, bool rerender) {
+    DeckLookahead* lookahead = player->lookahead;
+    if (!paused) return;
+
+    lookahead->pause_rerender |= rerender;
+    if (--lookahead->pause_depth > 0) return;
+
+    if (lookahead->pause_rerender) lookahead_prepare(player);
+    lookahead->pause_rerender = false;
+    STORE_RELEASE(lookahead->pause_request, 0);
+    while (LOAD_ACQUIRE(lookahead->paused)) lookahead_sleep();
+}
+
+// Drop the blocks rendered ahead (the worker is paused): they belong to the
+// previous song, so process() plays silence until the worker has rendered
+// the new one rather than finishing the old one
+static void lookahead_discard(const DeckPlayer* player) {
+    DeckLookahead* lookahead = player->lookahead;
+    if (!lookahead || lookahead->pause_depth == 0) return;
+
+    for (uint32_t i = 0; i < lookahead->num_slots; i++) {
+        DeckSlot* slot = &lookahead->slots[i];
+        uint32_t version = seqlock_write_begin(&slot->version);
+        slot->block.info.index = UINT64_MAX;
+        seqlock_write_end(&slot->version, version);
+    }
+}
+
+static bool lookahead_capture_position(DeckPlayer* player, uint8_t order, uint16_t pattern, uint16_t row) {
+    DeckLookahead* lookahead = player->lookahead;
+    if (!lookahead) return false;
+
+    DeckBlockInfo* info = &lookahead->current.info;
+    if (lookahead->capture && info->num_rows < DECK_LOOKAHEAD_ROWS) {
+        DeckRow* entry = &info->rows[info->num_rows++];
+        entry->offset = (uint16_t)(lookahead->render_frame % DECK_LOOKAHEAD_BLOCK);
+        entry->order = order;
+        entry->pattern = pattern;
+        entry->row = row;
+    }
+    return true;
+}
+
+// Copy frames of a block from its slot. Returns false if the slot holds
+// another block or the worker kept writing it.
+static bool lookahead_read(const DeckSlot* slot, uint64_t index, size_t offset, size_t count,
+                           float* outputs[6], DeckBlockInfo* info) {
+    for (int attempt = 0; attempt < DECK_LOOKAHEAD_READ_TRIES; attempt++) {
+        uint32_t version = seqlock_read_begin(&slot->version);
+        if (version & 1) continue;
+
+        *info = slot->block.info;
+        if (info->index == index) {
+            for (int i = 0; i < 6; i++) {
+                if (outputs[i]) memcpy(outputs[i], slot->block.audio[i] + offset, count * sizeof(float));
+            }
+        }
+
+        if (seqlock_read_valid(&slot->version, version)) return info->index == index;
+    }
+    return false;
+}
+
+static bool lookahead_process(DeckPlayer* player, float* left, float* right, float* channel_outputs[4],
+                              size_t num_samples, int sample_rate) {
+    DeckLookahead* lookahead = player->lookahead;
+    if (!lookahead) return false;
+
+    if (sample_rate != lookahead->sample_rate) {
+        // Rendered for another rate. Restarting the worker here would join
+        // and create a thread on the audio thread, so stay silent until the
+        // host calls deck_player_set_lookahead() with the new rate.
+        memset(left, 0, num_samples * sizeof(float));
+        memset(right, 0, num_samples * sizeof(float));
+        for (int c = 0; c < 4; c++) {
+            if (channel_outputs && channel_outputs[c]) memset(channel_outputs[c], 0, num_samples * sizeof(float));
+        }
+        return true;
+    }
+
+    size_t done = 0;
+    bool underrun = false;
+    while (done < num_samples) {
+        uint64_t index = lookahead->frame / DECK_LOOKAHEAD_BLOCK;
+        size_t offset = (size_t)(lookahead->frame % DECK_LOOKAHEAD_BLOCK);
+        size_t count = num_samples - done;
+        if (DECK_LOOKAHEAD_BLOCK - offset < count) count = DECK_LOOKAHEAD_BLOCK - offset;
+
+        float* outputs[6] = { left + done, right + done, NULL, NULL, NULL, NULL };
+        for (int c = 0; c < 4; c++) {
+            if (channel_outputs && channel_outputs[c]) outputs[2 + c] = channel_outputs[c] + done;
+        }
+
+        DeckBlockInfo info;
+        if (lookahead_read(&lookahead->slots[index % lookahead->num_slots], index, offset, count, outputs, &info)) {
+            for (uint8_t i = 0; i < info.num_rows && player->position_callback; i++) {
+                const DeckRow* row = &info.rows[i];
+                if (row->offset >= offset && row->offset < offset + count) {
+                    player->position_callback(row->order, row->pattern, row->row, player->position_callback_userdata);
+                }
+            }
+            STORE_RELEASE(lookahead->audible, info.audible);
+        } else {
+            // Not rendered in time
+            for (int i = 0; i < 6; i++) {
+                if (outputs[i]) memset(outputs[i], 0, count * sizeof(float));
+            }
+            underrun = true;
+        }
+
+        done += count;
+        lookahead->frame += count;
+    }
+
+    STORE_RELEASE(lookahead->consumed_frame, lookahead->frame);
+    if (underrun) __atomic_add_fetch(&lookahead->underruns, 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+#else
+
+static bool lookahead_command(DeckPlayer* player, DeckCommandType type, uint16_t a, uint16_t b) {
+    (void)player; (void)type; (void)a; (void)b;
+    return false;
+}
+
+static bool lookahead_audible(const DeckPlayer* player, DeckAudible* audible) {
+    (void)player; (void)audible;
+    return false;
+}
+
+static bool lookahead_pause(const DeckPlayer* player, bool sync) {
+    (void)player; (void)sync;
+    return false;
+}
+
+static void lookahead_resume(const DeckPlayer* player, bool paused, bool rerender) {
+    (void)player; (void)paused; (void)rerender;
+}
+
+static void lookahead_discard(const DeckPlayer* player) {
+    (void)player;
+}
+
+static bool lookahead_capture_position(DeckPlayer* player, uint8_t order, uint16_t pattern, uint16_t row) {
+    (void)player; (void)order; (void)pattern; (void)row;
+    return false;
+}
+
+static bool lookahead_process(DeckPlayer* player, float* left, float* right, float* channel_outputs[4],
+                              size_t num_samples, int sample_rate) {
+    (void)player; (void)left; (void)right; (void)channel_outputs; (void)num_samples; (void)sample_rate;
+    return false;
+}
+
+static void lookahead_stop(DeckPlayer* player) {
+    (void)player;
+}
+
+#endif
+
+bool deck_player_set_lookahead(DeckPlayer* player, uint32_t lookahead_ms, int sample_rate) {
+    if (!player) return false;
+
+#ifdef DECK_PLAYER_THREADS
+    lookahead_stop(player);
+    if (lookahead_ms == 0) return true;
+    if (sample_rate <= 0) return false;
+    return lookahead_start(player, lookahead_ms, sample_rate);
+#else
+    (void)sample_rate;
+    return lookahead_ms == 0;
+#endif
+}
+
+uint32_t deck_player_get_lookahead_underruns(const DeckPlayer* player) {
+#ifdef DECK_PLAYER_THREADS
+    if (player && player->lookahead) return LOAD_ACQUIRE(player->lookahead->underruns);
+#endif
+    (void)player;
+    return 0;
+}
@@ -2,7 +2,8 @@
 #define DECK_PLAYER_H
 
 /**
- * Unified Deck Player - Handles MOD/MED/AHX files with automatic format detection
+ * Unified Deck Player - Handles MOD/MED/AHX/SID/XM/S3M/IT files with automatic
+ * format detection
  *
  * This provides a simple unified interface for playing tracker modules,
  * handling format detection and routing to the appropriate player automatically.
@@ -19,15 +20,27 @@ extern "C" {
 // Opaque deck player structure
 typedef struct DeckPlayer DeckPlayer;
 
+// Most channels a deck can mute (MED, XM and IT modules go up to 64)
+#define DECK_PLAYER_MAX_CHANNELS 64
+
 // Player type (read-only, for informational purposes)
 typedef enum {
     DECK_PLAYER_NONE = 0,
     DECK_PLAYER_MOD,
     DECK_PLAYER_MED,
     DECK_PLAYER_AHX,
-    DECK_PLAYER_SID
+    DECK_PLAYER_SID,
+    DECK_PLAYER_XM,
+    DECK_PLAYER_S3M,
+    DECK_PLAYER_IT
 } DeckPlayerType;
 
+// Opaque seek index (keyframes of the player state, see deck_seek_index_build)
+typedef struct DeckSeekIndex DeckSeekIndex;
+
+// Rows between keyframes when 0 is passed to deck_seek_index_build()
+#define DECK_PLAYER_DEFAULT_KEYFRAME_ROWS 16
+
 // Position callback - unified signature
 // order/subsong, pattern/position, row
 typedef void (*DeckPlayerPositionCallback)(uint8_t order, uint16_t pattern, uint16_t row, void* user_data);
@@ -42,6 +55,14 @@ void deck_player_destroy(DeckPlayer* player);
 // Returns true on success, false on failure
 bool deck_player_load(DeckPlayer* player, const uint8_t* data, size_t size);
 
+// Load a file from disk (auto-detects format)
+// The file is memory-mapped and MOD/MED sample and pattern data are played
+// straight from the mapping, so large modules load without being read in
+// full, and decks playing the same file share its memory. The mapping is
+// held until the next load or deck_player_destroy().
+// Returns true on success, false on failure
+bool deck_player_load_file(DeckPlayer* player, const char* path);
+
 // Get current player type (after loading)
 DeckPlayerType deck_player_get_type(const DeckPlayer* player);
 
@@ -63,11 +84,55 @@ void deck_player_set_position_callback(DeckPlayer* player, DeckPlayerPositionCal
 void deck_player_get_position(const DeckPlayer* player, uint8_t* order, uint16_t* pattern, uint16_t* row);
 
 // Set playback position
+// With a seek index attached (and the deck playing) the full player state at
+// that row is rebuilt from the nearest keyframe, so effect memory, slides and
+// synth scripts sound as if the song had played up to there. Otherwise only
+// the position changes.
 void deck_player_set_position(DeckPlayer* player, uint8_t order, uint16_t row);
 
+// Player state snapshot (all but SID, see the player headers for what it holds)
+// The buffer must hold deck_player_get_state_size() bytes. Returns false for
+// SID, a buffer that is too small, or a snapshot of another song/player type.
+size_t deck_player_get_state_size(const DeckPlayer* player);
+bool deck_player_save_state(const DeckPlayer* player, void* buffer, size_t size);
+bool deck_player_restore_state(DeckPlayer* player, const void* buffer, size_t size);
+
+// Advance playback without rendering to a row start, passing `rows` rows
+// Returns the number of rows passed (less if the song ended)
+uint32_t deck_player_fast_forward(DeckPlayer* player, uint32_t rows, int sample_rate);
+
+// Build a seek index for a file: plays it once silently on a private player
+// (looping disabled) and keeps a state keyframe every rows_per_keyframe rows
+// (0 = DECK_PLAYER_DEFAULT_KEYFRAME_ROWS). Touches no deck, so it can run on a
+// worker thread while a deck plays the same file. Use the rate the deck
+// renders at. Returns NULL for SID files or on failure.
+DeckSeekIndex* deck_seek_index_build(const uint8_t* data, size_t size,
+                                     uint16_t rows_per_keyframe, int sample_rate);
+void deck_seek_index_destroy(DeckSeekIndex* index);
+
+// Keyframes of a seek index, for rendering stretches of a song independently
+// (see tools/stemrender). Restoring keyframe k on a started deck that has the
+// same file loaded and rendering at the index's rate plays the song exactly
+// as from the start, from frame deck_seek_index_get_keyframe_frame(index, k)
+// on. Channel mutes and loop settings stay as they are on the deck. Returns
+// false for an index of another file or a keyframe out of range.
+uint32_t deck_seek_index_get_num_keyframes(const DeckSeekIndex* index);
+uint64_t deck_seek_index_get_keyframe_frame(const DeckSeekIndex* index, uint32_t keyframe);
+bool deck_player_restore_keyframe(DeckPlayer* player, const DeckSeekIndex* index, uint32_t keyframe);
+
+// Frames the index covers. *song_ended (may be NULL) is set if the song ends
+// there; otherwise it goes on to repeat itself (or the scan gave up).
+uint64_t deck_seek_index_get_length(const DeckSeekIndex* index, bool* song_ended);
+
+// Attach a seek index to the deck, which takes ownership of it (also on
+// failure). Call from the thread that drives the deck. Returns false (and
+// destroys the index) if it was built from a different file than the one
+// loaded. Loading a file drops the current index.
+bool deck_player_set_seek_index(DeckPlayer* player, DeckSeekIndex* index);
+
 // Get song info
 uint8_t deck_player_get_song_length(const DeckPlayer* player);
-uint8_t deck_player_get_num_channels(const DeckPlayer* player);
+uint8_t deck_player_get_num_channels(const DeckPlayer* player);  // SID: 3 voices
 uint16_t deck_player_get_bpm(const DeckPlayer* player);
 void deck_player_set_bpm(DeckPlayer* player, uint16_t bpm);
 
@@ -75,7 +140,7 @@ void deck_player_set_bpm(DeckPlayer* player, uint16_t bpm);
 void deck_player_set_loop_range(DeckPlayer* player, uint16_t start_order, uint16_t end_order);
 void deck_player_set_disable_looping(DeckPlayer* player, bool disable);
 
-// Channel muting (channels 0-3, supports up to 4 channels)
+// Channel muting (channels 0 to deck_player_get_num_channels() - 1)
 void deck_player_set_channel_mute(DeckPlayer* player, uint8_t channel, bool muted);
 bool deck_player_get_channel_mute(const DeckPlayer* player, uint8_t channel);
 
@@ -94,6 +159,33 @@ void deck_player_process_channels(DeckPlayer* player,
 // Render audio samples (stereo mix only)
 void deck_player_process(DeckPlayer* player, float* left, float* right, size_t num_samples, int sample_rate);
 
+// Background look-ahead rendering (only when built with DECK_PLAYER_THREADS)
+// A worker thread renders the deck up to lookahead_ms ahead, and process()
+// only copies what it rendered, so the audio callback costs about the same
+// on every call whatever the song does.
+// - Start/stop, position, BPM, loop and mute calls take effect at the frame
+//   process() has reached when they are made: the worker re-renders from
+//   there, and until it has, process() keeps playing the blocks it had. SID
+//   tunes cannot be re-rendered, so there they take effect lookahead_ms late.
+// - Loading, fast forward, saving/restoring state and attaching a seek index
+//   wait for the worker to hand over the player (state is saved at the frame
+//   being heard). Loading drops the blocks rendered for the previous song,
+//   so the new one starts after a short silence instead of late.
+// - is_playing, get_position and get_bpm report what is being heard, and
+//   the position callback is called from process() when the row is heard.
+// - Control calls may come from one thread other than the one calling
+//   process(). Do not use deck_player_get_sequencer() while it is on.
+// Renders at sample_rate; process() at another rate outputs silence until
+// this is called again with the new rate. Call while process() is not
+// running (before processing starts, or from the host's sample-rate change).
+// lookahead_ms = 0 turns it off, leaving the player at the frame being heard.
+// Returns false if thread support is not compiled in or the worker could not
+// be started.
+bool deck_player_set_lookahead(DeckPlayer* player, uint32_t lookahead_ms, int sample_rate);
+
+// Process calls that found the look-ahead behind and output silence
+uint32_t deck_player_get_lookahead_underruns(const DeckPlayer* player);
+
 /**
  * Get underlying PatternSequencer (for advanced control with RegrooveController)
  * WARNING: Do not destroy the returned sequencer - it's owned by the individual player
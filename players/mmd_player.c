@@ -22,6 +22,7 @@
 #include "../synth/synth_envelope.h"
 #include "../synth/synth_lfo.h"
 #include "../synth/wavetable.h"
+#include "../effects/fx_math.h"
 #endif
 
 // Endianness conversion (MMD files are big-endian)
@@ -40,6 +41,7 @@
 #define MMD3_ID 0x4D4D4433  // 'MMD3' (same structure as MMD2, just signals advanced mixing)
 #define MAX_SAMPLES 63
 #define MAX_CHANNELS 64
+#define MED_RENDER_BLOCK 256  // Frames rendered per channel between mixes
 #define MAX_BLOCKS 256
 
 // Instrument flags
@@ -72,6 +74,17 @@
 
 #define MAX_WAVEFORMS 64
 #define MAX_SYNTH_SCRIPT 128
+
+// Precompiled synth script operations (see synth_script_compile)
+#define SYNTH_OP_NOP              0     // No effect (unsupported command or jump)
+#define SYNTH_OP_VALUE            1     // Set volume/waveform to arg
+#define SYNTH_OP_SPEED            2     // Set speed to arg
+#define SYNTH_OP_WAIT             3     // Wait arg ticks
+#define SYNTH_OP_END              4     // Stop the script
+
+// Built-in waveforms (sine, saw, square, triangle) as prebuilt tables
+#define MED_BUILTIN_WAVES 4
+#define MED_BUILTIN_WAVE_LEN 256
 #endif
 
 // Period table for Amiga notes (same as MOD)
@@ -150,6 +163,16 @@ typedef struct {
     uint8_t wave_table[MAX_SYNTH_SCRIPT];
 } __attribute__((packed)) MMDSynthInstr;
 
+// Precompiled synth script step
+// One entry per script byte, so a jump to any byte offset behaves like the
+// byte interpreter did. Parameters are consumed and clamped at load time and
+// jump targets are resolved into next.
+typedef struct {
+    uint8_t op;              // SYNTH_OP_*
+    uint8_t arg;             // Value, speed or wait count
+    uint8_t next;            // Program counter after this step
+} SynthOp;
+
 // Synth script state (runtime)
 typedef struct {
     uint8_t pc;              // Program counter
@@ -161,14 +184,15 @@ typedef struct {
 
 // Synth instrument state (runtime)
 typedef struct {
-    // Waveforms (each is 256 samples)
-    int8_t* waveforms[MAX_WAVEFORMS];
+    // Waveforms converted to float at load time, each with one guard sample
+    // (waveforms[w][len] == waveforms[w][0]) so lookups need no wrap
+    float* waveforms[MAX_WAVEFORMS];
     uint16_t waveform_lengths[MAX_WAVEFORMS];
     uint8_t num_waveforms;
 
-    // Script data (stored as individual bytes in file)
-    uint8_t vol_table[MAX_SYNTH_SCRIPT];
-    uint8_t wave_table[MAX_SYNTH_SCRIPT];
+    // Scripts, precompiled from the byte tables in the file
+    SynthOp vol_ops[MAX_SYNTH_SCRIPT];
+    SynthOp wave_ops[MAX_SYNTH_SCRIPT];
     uint16_t vol_table_len;
     uint16_t wave_table_len;
     uint8_t vol_speed;
@@ -181,6 +205,10 @@ typedef struct {
     SynthScript vol_script;
     SynthScript wave_script;
 
+    // Table selected by current_waveform (see synth_select_waveform)
+    const float* wave;
+    uint16_t wave_len;
+
     // Volume envelope (hold/decay from InstrExt)
     uint8_t hold_time;        // Sustain time in ticks
     uint8_t decay_speed;      // Decay speed (0 = no decay)
@@ -194,7 +222,8 @@ typedef struct {
 
 // Sample data
 typedef struct {
-    int8_t* data;           // Sample data (8-bit signed)
+    const int8_t* data;     // Sample data (8-bit signed)
+    bool data_in_place;     // data points into the file, not owned
     uint32_t length;        // Length in bytes
     uint32_t repeat_start;  // Repeat start in bytes
     uint32_t repeat_length; // Repeat length in bytes
@@ -223,7 +252,7 @@ typedef struct {
 typedef struct {
     uint8_t num_tracks;     // Number of tracks
     uint16_t num_lines;     // Number of lines (rows)
-    MMD2Note* notes;        // Note data [tracks][lines]
+    const MMD2Note* notes;  // Note data [tracks][lines]
 } MedBlock;
 
 // Channel state
@@ -253,8 +282,9 @@ typedef struct {
 
 // Main player structure
 struct MedPlayer {
-    // File data
-    uint8_t* file_data;
+    // File data (the caller's own buffer when loaded in place)
+    const uint8_t* file_data;
+    bool file_in_place;
     size_t file_size;
     uint32_t song_offset;   // Offset to song structure (for reading MMD0sample array)
     uint32_t instr_ext_offset;   // Offset to InstrExt array (from ExpData)
@@ -300,6 +330,17 @@ struct MedPlayer {
     // Position callback
     MedPositionCallback position_callback;
     void* callback_user_data;
+
+    // Sample interpolation
+    TrackerInterpolation interpolation;
+
+#ifdef MMD_SYNTH_SUPPORT
+    // Synth channel output for the current render block
+    float synth_buffer[MAX_CHANNELS][MED_RENDER_BLOCK];
+
+    // Built-in waveforms, with a guard sample like the instrument waveforms
+    float builtin_waves[MED_BUILTIN_WAVES][MED_BUILTIN_WAVE_LEN + 1];
+#endif
 };
 
 // Create player instance
@@ -330,19 +371,13 @@ MedPlayer* med_player_create(void) {
     return player;
 }
 
-// Destroy player instance
-void med_player_destroy(MedPlayer* player) {
-    if (!player) return;
-
-    // Destroy pattern sequencer
-    if (player->sequencer) {
-        pattern_sequencer_destroy(player->sequencer);
-    }
-
+// Free everything the loaded song allocated (data referenced in place
+// belongs to the caller)
+static void free_song_data(MedPlayer* player) {
     // Free sample data
     for (int i = 0; i < MAX_SAMPLES; i++) {
-        if (player->samples[i].data) {
-            free(player->samples[i].data);
+        if (player->samples[i].data && !player->samples[i].data_in_place) {
+            free((void*)player->samples[i].data);
         }
 #ifdef MMD_SYNTH_SUPPORT
         // Free synth data
@@ -356,27 +391,43 @@ void med_player_destroy(MedPlayer* player) {
         }
 #endif
     }
+    memset(player->samples, 0, sizeof(player->samples));
 
     // Free blocks
     if (player->blocks) {
-        for (int i = 0; i < player->num_blocks; i++) {
+        for (int i = 0; i < player->num_blocks && !player->file_in_place; i++) {
             if (player->blocks[i].notes) {
-                free(player->blocks[i].notes);
+                free((void*)player->blocks[i].notes);
             }
         }
         free(player->blocks);
+        player->blocks = NULL;
     }
 
     // Free play sequence
     if (player->play_seq) {
         free(player->play_seq);
+        player->play_seq = NULL;
     }
 
     // Free file data
-    if (player->file_data) {
-        free(player->file_data);
+    if (player->file_data && !player->file_in_place) {
+        free((void*)player->file_data);
+    }
+    player->file_data = NULL;
+    player->file_in_place = false;
+}
+
+// Destroy player instance
+void med_player_destroy(MedPlayer* player) {
+    if (!player) return;
+
+    // Destroy pattern sequencer
+    if (player->sequencer) {
+        pattern_sequencer_destroy(player->sequencer);
     }
 
+    free_song_data(player);
     free(player);
 }
 
@@ -390,10 +441,73 @@ static void synth_script_init(SynthScript* script, uint8_t speed) {
     script->active = true;
 }
 
-// Execute one tick of synth script (byte commands)
+// Precompile a volume or waveform script (byte commands) into SynthOps.
+// Commands that take a parameter consume it here, values are clamped for the
+// table type and jump targets are resolved (an out-of-range JMP just falls
+// through, like before). Unsupported commands become NOPs.
+static void synth_script_compile(const uint8_t* table, uint16_t table_len,
+                                 bool is_volume, SynthOp* ops) {
+    for (uint16_t pc = 0; pc < table_len; pc++) {
+        uint8_t cmd_byte = table[pc];
+        uint8_t param_byte = (pc + 1 < table_len) ? table[pc + 1] : 0;
+        SynthOp* op = &ops[pc];
+
+        op->op = SYNTH_OP_NOP;
+        op->arg = 0;
+        op->next = (uint8_t)(pc + 1);
+
+        switch (cmd_byte) {
+            case SYNTH_CMD_SPD:  // Set speed
+                op->op = SYNTH_OP_SPEED;
+                op->arg = param_byte > 0 ? param_byte : 1;
+                op->next = (uint8_t)(pc + 2);
+                break;
+
+            case SYNTH_CMD_WAI:  // Wait
+                op->op = SYNTH_OP_WAIT;
+                op->arg = param_byte;
+                op->next = (uint8_t)(pc + 2);
+                break;
+
+            case SYNTH_CMD_JMP:  // Jump
+                op->next = (param_byte < table_len) ? param_byte : (uint8_t)(pc + 2);
+                break;
+
+            case SYNTH_CMD_END:  // End
+            case SYNTH_CMD_HLT:  // Halt
+                op->op = SYNTH_OP_END;
+                break;
+
+            default:
+                if (cmd_byte <= 0x7F) {
+                    // Direct value (volume 0-127 or waveform 0-63)
+                    op->op = SYNTH_OP_VALUE;
+                    op->arg = is_volume ? cmd_byte : (cmd_byte < 64 ? cmd_byte : 0);
+                }
+                break;
+        }
+    }
+
+    // Loop guard: a cycle made only of NOPs/jumps can never change the value
+    // again, so the script is stopped as soon as it enters one
+    for (uint16_t pc = 0; pc < table_len; pc++) {
+        uint16_t cur = pc;
+        uint16_t steps = 0;
+        while (cur < table_len && ops[cur].op == SYNTH_OP_NOP && steps <= table_len) {
+            cur = ops[cur].next;
+            steps++;
+        }
+        if (steps > table_len) {
+            ops[pc].op = SYNTH_OP_END;
+            ops[pc].next = (uint8_t)(pc + 1);
+        }
+    }
+}
+
+// Execute one tick of a precompiled synth script
 // Returns: updated value (volume 0-127 or waveform 0-63)
-static uint8_t synth_script_tick(SynthScript* script, const uint8_t* table, uint16_t table_len,
-                                  uint8_t current_value, bool is_volume) {
+static uint8_t synth_script_tick(SynthScript* script, const SynthOp* ops, uint16_t table_len,
+                                  uint8_t current_value) {
     if (!script->active || table_len == 0) {
         return current_value;
     }
@@ -411,53 +525,30 @@ static uint8_t synth_script_tick(SynthScript* script, const uint8_t* table, uint
     }
     script->tick_counter = 0;
 
-    // Execute command
+    // Execute one step
     if (script->pc >= table_len) {
         script->active = false;
         return current_value;
     }
 
-    // Read command byte and optional parameter byte
-    uint8_t cmd_byte = table[script->pc++];
-    uint8_t param_byte = (script->pc < table_len) ? table[script->pc] : 0;
-
-    // Simple implementation - just handle basic commands for now
-    if (cmd_byte >= 0xF0) {
-        switch (cmd_byte) {
-            case SYNTH_CMD_SPD:  // Set speed
-                script->pc++;  // Consume parameter byte
-                script->speed = param_byte;
-                if (script->speed == 0) script->speed = 1;
-                break;
-
-            case SYNTH_CMD_WAI:  // Wait
-                script->pc++;  // Consume parameter byte
-                script->wait_counter = param_byte;
-                break;
-
-            case SYNTH_CMD_JMP:  // Jump
-                script->pc++;  // Consume parameter byte
-                if (param_byte < table_len) {
-                    script->pc = param_byte;
-                }
-                break;
-
-            case SYNTH_CMD_END:  // End
-            case SYNTH_CMD_HLT:  // Halt
-                script->active = false;
-                break;
-
-            default:
-                // Unknown command - skip
-                break;
-        }
-    } else if (cmd_byte <= 0x7F) {
-        // Direct value (volume 0-127 or waveform 0-63)
-        if (is_volume) {
-            current_value = (cmd_byte <= 127) ? cmd_byte : 127;
-        } else {
-            current_value = (cmd_byte < 64) ? cmd_byte : 0;
-        }
+    const SynthOp* op = &ops[script->pc];
+    script->pc = op->next;
+
+    switch (op->op) {
+        case SYNTH_OP_VALUE:
+            current_value = op->arg;
+            break;
+        case SYNTH_OP_SPEED:
+            script->speed = op->arg;
+            break;
+        case SYNTH_OP_WAIT:
+            script->wait_counter = op->arg;
+            break;
+        case SYNTH_OP_END:
+            script->active = false;
+            break;
+        default:
+            break;
     }
 
     return current_value;
@@ -471,7 +562,7 @@ static float builtin_waveform(uint8_t waveform_type, float phase) {
         case 1:  // Square
             return (phase < 0.5f) ? -1.0f : 1.0f;
         case 2:  // Sine
-            return sinf(phase * 2.0f * 3.14159265f);
+            return fx_sin_turns(phase);
         case 3:  // Triangle
             return (phase < 0.5f) ? (phase * 4.0f - 1.0f) : (3.0f - phase * 4.0f);
         default:  // Default to sawtooth
@@ -479,80 +570,84 @@ static float builtin_waveform(uint8_t waveform_type, float phase) {
     }
 }
 
-// Process synth instrument - generate one sample
-static float synth_instrument_process(SynthInstrument* synth, float freq, float sample_rate) {
-    if (!synth) {
-        return 0.0f;
+// Sample the built-in waveforms into the player's tables (once per load)
+static void synth_build_builtin_waves(MedPlayer* player) {
+    for (int type = 0; type < MED_BUILTIN_WAVES; type++) {
+        float* table = player->builtin_waves[type];
+        for (int i = 0; i < MED_BUILTIN_WAVE_LEN; i++) {
+            table[i] = builtin_waveform((uint8_t)type, (float)i / MED_BUILTIN_WAVE_LEN);
+        }
+        table[MED_BUILTIN_WAVE_LEN] = table[0];
     }
+}
 
-    float sample;
+// Pick the table for the synth's current waveform. Called whenever the wave
+// script (or a state restore) may have changed it, not per sample.
+static void synth_select_waveform(const MedPlayer* player, SynthInstrument* synth) {
+    uint8_t builtin_type;
 
-    // Check if using custom waveforms or built-in waveforms
     if (synth->num_waveforms > 0) {
         // Use custom waveforms from file
         uint8_t wf_idx = synth->current_waveform;
 
-        // If requested waveform doesn't exist, find first available one
+        // If requested waveform doesn't exist, use the first available one
         if (wf_idx >= synth->num_waveforms || !synth->waveforms[wf_idx]) {
-            // Search for first valid waveform
-            uint8_t old_idx = wf_idx;
-            wf_idx = 0;
-            for (int i = 0; i < synth->num_waveforms; i++) {
-                if (synth->waveforms[i]) {
-                    wf_idx = i;
-                    break;
-                }
+            for (wf_idx = 0; wf_idx < synth->num_waveforms; wf_idx++) {
+                if (synth->waveforms[wf_idx]) break;
             }
-            // static int fallback_debug = 0;
-            // if (fallback_debug < 3) {
-            //     fprintf(stderr, "WAVEFORM FALLBACK: requested %d, found %d (has_data=%d)\n",
-            //             old_idx, wf_idx, synth->waveforms[wf_idx] != NULL);
-            //     fallback_debug++;
-            // }
         }
 
-        if (wf_idx < synth->num_waveforms && synth->waveforms[wf_idx]) {
-            // Generate sample from current waveform using shared wavetable component
-            int8_t* waveform = synth->waveforms[wf_idx];
-            uint16_t wf_len = synth->waveform_lengths[wf_idx];
-
-            // Set frequency and process
-            wavetable_set_frequency(&synth->wavetable_osc, freq, sample_rate);
-            sample = wavetable_process_int8(&synth->wavetable_osc, waveform, wf_len);
-        } else {
-            // No waveforms available - use built-in saw
-            sample = builtin_waveform(0, wavetable_get_phase(&synth->wavetable_osc));
-            // Manually advance phase for built-in waveforms
-            float phase_inc = freq / sample_rate;
-            synth->wavetable_osc.phase += phase_inc;
-            if (synth->wavetable_osc.phase >= 1.0f) {
-                synth->wavetable_osc.phase -= (int)synth->wavetable_osc.phase;
-            }
+        if (wf_idx < synth->num_waveforms) {
+            synth->wave = synth->waveforms[wf_idx];
+            synth->wave_len = synth->waveform_lengths[wf_idx];
+            return;
         }
+
+        // No waveforms available - use built-in saw
+        builtin_type = 0;
     } else {
-        // Use built-in waveforms
-        // OctaMED built-in waveform IDs: 0 = sine wave
-        uint8_t waveform_type;
-        if (synth->current_waveform == 0) {
-            waveform_type = 2;  // Sine
-        } else if (synth->current_waveform == 1) {
-            waveform_type = 0;  // Sawtooth
-        } else if (synth->current_waveform == 2) {
-            waveform_type = 1;  // Square
-        } else if (synth->current_waveform == 3) {
-            waveform_type = 3;  // Triangle
-        } else {
-            // Default to sine for unknown waveforms
-            waveform_type = 2;
-        }
-        sample = builtin_waveform(waveform_type, wavetable_get_phase(&synth->wavetable_osc));
+        // OctaMED built-in waveform IDs: 0 = sine, 1 = saw, 2 = square,
+        // 3 = triangle (unknown IDs default to sine)
+        static const uint8_t builtin_map[MED_BUILTIN_WAVES] = { 2, 0, 1, 3 };
+        builtin_type = (synth->current_waveform < MED_BUILTIN_WAVES)
+                     ? builtin_map[synth->current_waveform] : 2;
+    }
 
-        // Advance phase for built-in waveforms
-        float phase_inc = freq / sample_rate;
-        synth->wavetable_osc.phase += phase_inc;
-        if (synth->wavetable_osc.phase >= 1.0f) {
-            synth->wavetable_osc.phase -= (int)synth->wavetable_osc.phase;
-        }
+    synth->wave = player->builtin_waves[builtin_type];
+    synth->wave_len = MED_BUILTIN_WAVE_LEN;
+}
+
+// Run one tick of both synth scripts
+static void synth_tick_scripts(const MedPlayer* player, SynthInstrument* synth) {
+    synth->target_volume = synth_script_tick(&synth->vol_script, synth->vol_ops,
+                                             synth->vol_table_len, synth->target_volume);
+    synth->current_waveform = synth_script_tick(&synth->wave_script, synth->wave_ops,
+                                                synth->wave_table_len, synth->current_waveform);
+    synth_select_waveform(player, synth);
+}
+
+// Process synth instrument - generate one sample
+// phase_inc is frequency / sample rate, computed once per render block.
+static float synth_instrument_process(SynthInstrument* synth, float phase_inc) {
+    if (!synth || !synth->wave) {
+        return 0.0f;
+    }
+
+    // Linear interpolation; the guard sample covers the wrap
+    WavetableOscillator* osc = &synth->wavetable_osc;
+    float phase_pos = osc->phase * synth->wave_len;
+    int pos = (int)phase_pos;
+    float frac = phase_pos - (float)pos;
+    if (pos >= synth->wave_len) pos -= synth->wave_len;
+
+    const float* wave = synth->wave;
+    float sample = wave[pos] + (wave[pos + 1] - wave[pos]) * frac;
+
+    // Advance phase
+    osc->phase_increment = phase_inc;
+    osc->phase += phase_inc;
+    if (osc->phase >= 1.0f) {
+        osc->phase -= (int)osc->phase;
     }
 
     // Apply volume (OctaMED synth volumes are 0-127)
@@ -578,14 +673,55 @@ bool med_player_detect(const uint8_t* data, size_t size) {
     return (id == MMD2_ID || id == MMD3_ID);
 }
 
-// Load MMD2 file
-bool med_player_load(MedPlayer* player, const uint8_t* data, size_t size) {
+// Set a sample's PCM. In place, data is referenced in the file whenever it
+// can be played as stored; 16-bit data that needs a byte swap (or sits at an
+// odd address) is converted into a copy.
+static bool set_sample_data(MedPlayer* player, MedSample* sample, const uint8_t* src,
+                            uint32_t length, bool is_16bit, bool swap16) {
+    bool aligned = !is_16bit || ((uintptr_t)src & 1) == 0;
+    if (player->file_in_place && !swap16 && aligned) {
+        sample->data = (const int8_t*)src;
+        sample->data_in_place = true;
+        return true;
+    }
+
+    int8_t* copy = (int8_t*)malloc(length);
+    if (!copy) return false;
+    memcpy(copy, src, length);
+
+    // MMD files are big-endian
+    if (swap16) {
+        int16_t* sample16 = (int16_t*)copy;
+        uint32_t num_samples = length / 2;
+        for (uint32_t s = 0; s < num_samples; s++) {
+            sample16[s] = (int16_t)((uint16_t)src[s * 2] << 8 | src[s * 2 + 1]);
+        }
+    }
+
+    sample->data = copy;
+    sample->data_in_place = false;
+    return true;
+}
+
+static bool load_song(MedPlayer* player, const uint8_t* data, size_t size, bool in_place) {
     if (!player || !data || size < 52) return false;
 
-    // Copy file data
-    player->file_data = (uint8_t*)malloc(size);
-    if (!player->file_data) return false;
-    memcpy(player->file_data, data, size);
+    // Nothing may keep playing the old samples
+    for (int i = 0; i < MAX_CHANNELS; i++) {
+        player->channels[i].sample = NULL;
+    }
+    free_song_data(player);
+
+    if (in_place) {
+        player->file_data = data;
+        player->file_in_place = true;
+    } else {
+        // Copy file data
+        uint8_t* copy = (uint8_t*)malloc(size);
+        if (!copy) return false;
+        memcpy(copy, data, size);
+        player->file_data = copy;
+    }
     player->file_size = size;
 
     const uint8_t* base = player->file_data;
@@ -603,11 +739,14 @@ bool med_player_load(MedPlayer* player, const uint8_t* data, size_t size) {
     if (id != MMD2_ID && id != MMD3_ID) {
         fprintf(stderr, "med_player: Invalid format ID: 0x%08X (expected MMD2 0x%08X or MMD3 0x%08X)\n",
                 id, MMD2_ID, MMD3_ID);
-        free(player->file_data);
-        player->file_data = NULL;
+        free_song_data(player);
         return false;
     }
 
+#ifdef MMD_SYNTH_SUPPORT
+    synth_build_builtin_waves(player);
+#endif
+
     // fprintf(stderr, "med_player: Detected format: %s\n", id == MMD2_ID ? "MMD2" : "MMD3");
     // fprintf(stderr, "med_player: Module length: %u bytes\n", modlen);
 
@@ -804,8 +943,17 @@ bool med_player_load(MedPlayer* player, const uint8_t* data, size_t size) {
         // Note data starts immediately after 8-byte BlockInfo header
         const uint8_t* notes_ptr = block_ptr + 8;
         size_t note_count = numtracks * (lines + 1);
-        player->blocks[i].notes = (MMD2Note*)malloc(note_count * sizeof(MMD2Note));
-        memcpy(player->blocks[i].notes, notes_ptr, note_count * sizeof(MMD2Note));
+        if (notes_ptr + note_count * sizeof(MMD2Note) > base + size) continue;
+
+        // MMD2Note matches the file layout byte for byte
+        if (player->file_in_place) {
+            player->blocks[i].notes = (const MMD2Note*)notes_ptr;
+        } else {
+            MMD2Note* notes = (MMD2Note*)malloc(note_count * sizeof(MMD2Note));
+            if (!notes) continue;
+            memcpy(notes, notes_ptr, note_count * sizeof(MMD2Note));
+            player->blocks[i].notes = notes;
+        }
         blocks_with_data++;
 
         // Debug first few notes in early blocks
@@ -951,17 +1099,11 @@ bool med_player_load(MedPlayer* player, const uint8_t* data, size_t size) {
                     continue;
                 }
 
-                // Copy script tables (stored as individual bytes in file)
+                // Precompile script tables (stored as individual bytes in file)
                 synth->vol_table_len = (vol_table_len <= MAX_SYNTH_SCRIPT) ? vol_table_len : MAX_SYNTH_SCRIPT;
                 synth->wave_table_len = (wave_table_len <= MAX_SYNTH_SCRIPT) ? wave_table_len : MAX_SYNTH_SCRIPT;
-
-                // Read individual bytes from actual file location
-                for (int j = 0; j < synth->vol_table_len; j++) {
-                    synth->vol_table[j] = vol_table_ptr[j];
-                }
-                for (int j = 0; j < synth->wave_table_len; j++) {
-                    synth->wave_table[j] = wave_table_ptr[j];
-                }
+                synth_script_compile(vol_table_ptr, synth->vol_table_len, true, synth->vol_ops);
+                synth_script_compile(wave_table_ptr, synth->wave_table_len, false, synth->wave_ops);
 
                 synth->vol_speed = vol_speed;
                 synth->wave_speed = wave_speed;
@@ -1022,21 +1164,25 @@ bool med_player_load(MedPlayer* player, const uint8_t* data, size_t size) {
                     uint16_t wf_len = wf_len_words * 2;  // Convert to bytes
                     waveform_data += 2;
 
-                    if (waveform_data + wf_len > base + player->file_size) {
+                    if (wf_len == 0 || waveform_data + wf_len > base + player->file_size) {
                         // fprintf(stderr, "med_player:     Waveform %d: out of bounds (needs %u bytes)\n", w, wf_len);
                         continue;
                     }
 
-                    // Allocate and copy waveform
-                    synth->waveforms[w] = (int8_t*)malloc(wf_len);
+                    // Convert waveform to float, plus a guard sample for the wrap
+                    synth->waveforms[w] = (float*)malloc((wf_len + 1) * sizeof(float));
                     if (synth->waveforms[w]) {
-                        memcpy(synth->waveforms[w], waveform_data, wf_len);
+                        for (int k = 0; k < wf_len; k++) {
+                            synth->waveforms[w][k] = (int8_t)waveform_data[k] / 128.0f;
+                        }
+                        synth->waveforms[w][wf_len] = synth->waveforms[w][0];
                         synth->waveform_lengths[w] = wf_len;
                         // fprintf(stderr, "med_player:     Waveform %d: %u bytes (offset 0x%X)\n", w, wf_len, wf_offset);
                     } else {
                         // fprintf(stderr, "med_player:     Waveform %d: malloc failed\n", w);
                     }
                 }
+                synth_select_waveform(player, synth);
 
                 // Read volume from MMD0sample array (like regular samples)
                 const uint8_t* song_base_vol = read_ptr(base, player->song_offset);
@@ -1056,10 +1202,7 @@ bool med_player_load(MedPlayer* player, const uint8_t* data, size_t size) {
                 if (type == INSTR_TYPE_HYBRID && length > 0) {
                     const uint8_t* sample_data = wf_ptr;
                     player->samples[i].length = length;
-                    player->samples[i].data = (int8_t*)malloc(length);
-                    if (player->samples[i].data) {
-                        memcpy(player->samples[i].data, sample_data, length);
-                    }
+                    set_sample_data(player, &player->samples[i], sample_data, length, false, false);
                 }
 
                 samples_loaded++;
@@ -1098,14 +1241,13 @@ bool med_player_load(MedPlayer* player, const uint8_t* data, size_t size) {
                     continue;
                 }
 
-                // Allocate and copy sample data
+                // Reference or copy sample data
                 player->samples[i].length = length;
-                player->samples[i].data = (int8_t*)malloc(length);
-                if (!player->samples[i].data) {
+                if (!set_sample_data(player, &player->samples[i], ext_ptr + 18, length,
+                                     (instr_flags & INSTR_FLAG_16BIT) != 0, false)) {
                     fprintf(stderr, "med_player: ERROR: Failed to allocate %u bytes for sample %d\n", length, i);
                     continue;
                 }
-                memcpy(player->samples[i].data, ext_ptr + 18, length);
 
                 // Read volume from MMD0sample array (like old samples do)
                 const uint8_t* song_base_vol = read_ptr(base, player->song_offset);
@@ -1176,24 +1318,14 @@ bool med_player_load(MedPlayer* player, const uint8_t* data, size_t size) {
                     continue;
                 }
 
-                // Allocate and copy sample data (starts right after InstrHdr)
+                // Sample data starts right after InstrHdr
+                // CRITICAL: Byte-swap 16-bit samples (MMD files are big-endian)
                 player->samples[i].length = actual_length;
-                player->samples[i].data = (int8_t*)malloc(actual_length);
-                if (!player->samples[i].data) {
+                if (!set_sample_data(player, &player->samples[i], instr_ptr + 6, actual_length,
+                                     is_16bit, is_16bit)) {
                     fprintf(stderr, "med_player: ERROR: Failed to allocate %u bytes for sample %d\n", actual_length, i);
                     continue;
                 }
-                memcpy(player->samples[i].data, instr_ptr + 6, actual_length);
-
-                // CRITICAL: Byte-swap 16-bit samples (MMD files are big-endian)
-                if (is_16bit) {
-                    int16_t* sample16 = (int16_t*)player->samples[i].data;
-                    uint32_t num_samples = actual_length / 2;
-                    for (uint32_t s = 0; s < num_samples; s++) {
-                        uint16_t be_val = ((uint8_t*)sample16)[s*2] << 8 | ((uint8_t*)sample16)[s*2+1];
-                        sample16[s] = (int16_t)be_val;
-                    }
-                }
 
                 // For old samples, get repeat/volume info from MMD0sample array at start of song
                 // song_base + 0 to song_base + 503 is the sample array (63 samples * 8 bytes each)
@@ -1256,6 +1388,15 @@ bool med_player_load(MedPlayer* player, const uint8_t* data, size_t size) {
     return true;
 }
 
+// Load MMD2 file
+bool med_player_load(MedPlayer* player, const uint8_t* data, size_t size) {
+    return load_song(player, data, size, false);
+}
+
+bool med_player_load_in_place(MedPlayer* player, const uint8_t* data, size_t size) {
+    return load_song(player, data, size, true);
+}
+
 // Get period for note
 static uint16_t get_note_period(uint8_t note, int8_t finetune) {
     if (note == 0) return 0;
@@ -1391,20 +1532,7 @@ static bool trigger_note(MedPlayer* player, int channel, uint8_t note, uint8_t i
             synth_script_init(&chan->sample->synth->wave_script, chan->sample->synth->wave_speed);
 
             // Execute scripts once to get initial values
-            chan->sample->synth->target_volume = synth_script_tick(
-                &chan->sample->synth->vol_script,
-                chan->sample->synth->vol_table,
-                chan->sample->synth->vol_table_len,
-                chan->sample->synth->target_volume,
-                true
-            );
-            chan->sample->synth->current_waveform = synth_script_tick(
-                &chan->sample->synth->wave_script,
-                chan->sample->synth->wave_table,
-                chan->sample->synth->wave_table_len,
-                chan->sample->synth->current_waveform,
-                false
-            );
+            synth_tick_scripts(player, chan->sample->synth);
 
             // Set current volume to target immediately (no ramp at start)
             chan->sample->synth->current_volume = chan->sample->synth->target_volume;
@@ -1437,7 +1565,7 @@ static void process_tick(MedPlayer* player) {
         // Process new row
         for (int ch = 0; ch < player->num_tracks; ch++) {
             int note_idx = player->current_row * block->num_tracks + ch;
-            MMD2Note* note = &block->notes[note_idx];
+            const MMD2Note* note = &block->notes[note_idx];
             MedChannel* chan = &player->channels[ch];
 
             // Trigger new note if present
@@ -1555,23 +1683,8 @@ static void process_tick(MedPlayer* player) {
         if (chan->sample && chan->sample->is_synth && chan->sample->synth) {
             SynthInstrument* synth = chan->sample->synth;
 
-            // Tick volume script (updates target_volume)
-            synth->target_volume = synth_script_tick(
-                &synth->vol_script,
-                synth->vol_table,
-                synth->vol_table_len,
-                synth->target_volume,
-                true
-            );
-
-            // Tick waveform script
-            synth->current_waveform = synth_script_tick(
-                &synth->wave_script,
-                synth->wave_table,
-                synth->wave_table_len,
-                synth->current_waveform,
-                false
-            );
+            // Tick volume script (updates target_volume) and waveform script
+            synth_tick_scripts(player, synth);
 
             // Update volume envelope (hold/decay)
             if (synth->hold_time > 0 || synth->decay_speed > 0) {
@@ -1695,7 +1808,7 @@ static void mmd_on_row(void* user_data, uint16_t pattern_index,
     // Process all channels for this row
     for (int ch = 0; ch < player->num_tracks; ch++) {
         int note_idx = row * block->num_tracks + ch;
-        MMD2Note* note = &block->notes[note_idx];
+        const MMD2Note* note = &block->notes[note_idx];
         MedChannel* chan = &player->channels[ch];
 
         // Trigger new note if present
@@ -1797,6 +1910,183 @@ bool med_player_is_playing(const MedPlayer* player) {
     return player ? player->playing : false;
 }
 
+// Move a volume toward its target by a ramp step
+static inline float ramp_volume(float current, float target, float step) {
+    if (current < target) {
+        current += step;
+        if (current > target) current = target;
+    } else if (current > target) {
+        current -= step;
+        if (current < target) current = target;
+    }
+    return current;
+}
+
+#ifdef MMD_SYNTH_SUPPORT
+// True if the channel is playing a synth instrument
+static inline bool is_synth_channel(const MedChannel* chan) {
+    return chan->sample && chan->sample->is_synth && chan->sample->synth;
+}
+
+// Run all synth channels for a block, frame by frame and in channel order.
+// Channels playing the same instrument share its oscillator state, so the
+// per-sample interleaving has to be kept; the result is mixed per channel
+// afterwards like any other voice. Muted channels still run so that a shared
+// instrument sounds the same on the channels that are not muted.
+static void render_synths(MedPlayer* player, uint32_t frames, float sample_rate, float ramp_rate) {
+    // Smooth volume interpolation toward target (10ms ramp time)
+    float synth_ramp = 127.0f / (0.010f * sample_rate);
+
+    // Spans never cross a tick, so the period (and the oscillator step) is
+    // fixed for the whole block
+    float phase_inc[MAX_CHANNELS];
+    for (int ch = 0; ch < player->num_tracks; ch++) {
+        const MedChannel* chan = &player->channels[ch];
+        if (!is_synth_channel(chan) || chan->period == 0) continue;
+
+        // For synth instruments, calculate frequency from period using C-2 as reference
+        // C-2 (period 428) = 130.81 Hz (MIDI note 48)
+        // Formula: freq = (130.81 * 428) / period = 55986.68 / period
+        float freq = 55986.68f / (float)chan->period;
+        phase_inc[ch] = freq / sample_rate;
+    }
+
+    for (uint32_t i = 0; i < frames; i++) {
+        for (int ch = 0; ch < player->num_tracks; ch++) {
+            MedChannel* chan = &player->channels[ch];
+            if (!is_synth_channel(chan)) continue;
+
+            SynthInstrument* synth = chan->sample->synth;
+            chan->current_volume = ramp_volume(chan->current_volume, chan->volume, ramp_rate);
+            synth->current_volume = ramp_volume(synth->current_volume, synth->target_volume, synth_ramp);
+
+            if (chan->period == 0) continue;
+
+            float sample = synth_instrument_process(synth, phase_inc[ch]);
+
+            // Apply volume: channel volume * sample volume * track volume * user volume
+            // Channel volume: 0-127 (from pattern commands, smoothly interpolated)
+            // Sample volume: 0-64 (stored in MMD0sample array)
+            // Track volume: 0-127 (stored in trackvols array) - but wait, OctaMED docs say 0-64!
+            // FIXME: Track volume scaling might be wrong
+            float vol = (chan->current_volume / (float)player->max_volume) * (chan->sample->volume / 64.0f) *
+                       (player->track_volumes[ch] / 127.0f) * chan->user_volume;
+
+            player->synth_buffer[ch][i] = sample * vol;
+        }
+    }
+}
+#endif
+
+// Render a span of sample playback for a channel into the stereo bus
+// With no bus (left == NULL) the channel only advances (fast-forward).
+static void render_span(MedPlayer* player, int ch, float* left, float* right,
+                        float* channel_out, uint32_t frames, float sample_rate) {
+    MedChannel* chan = &player->channels[ch];
+
+    // Convert MMD panning (-16 to +16) to normalized panning (-1.0 to 1.0)
+    float pan_normalized = tracker_mixer_mmd_pan_to_normalized(player->track_pans[ch]);
+    float left_gain, right_gain;
+    tracker_mixer_pan_to_gains(pan_normalized, &left_gain, &right_gain);
+
+#ifdef MMD_SYNTH_SUPPORT
+    // Synth output was rendered by render_synths() (no headroom scaling, as before)
+    if (chan->sample->is_synth && chan->sample->synth) {
+        if (chan->period == 0 || !left) return;
+
+        const float* synth_out = player->synth_buffer[ch];
+        for (uint32_t i = 0; i < frames; i++) {
+            left[i] += synth_out[i] * left_gain;
+            right[i] += synth_out[i] * right_gain;
+            if (channel_out) {
+                channel_out[i] = synth_out[i];
+            }
+        }
+        return;
+    }
+#endif
+
+    // Regular sample playback
+    if (!chan->sample->data) return;
+
+    // Set TrackerVoice frequency based on period
+    // MMD uses PAL Amiga clock: freq = 7093789.2 / (period * 2) = 3546894.6 / period
+    // CRITICAL: For 16-bit samples, use HALF clock rate (play slower)
+    if (chan->period > 0) {
+        uint32_t clock_rate = 3546895;
+
+        if (chan->sample->is_16bit) {
+            clock_rate /= 2;  // HALF clock for 16-bit samples (play at half speed)
+        }
+
+        tracker_voice_set_period(&chan->voice_playback, chan->period, clock_rate, (uint32_t)sample_rate);
+    }
+
+    // Sync old position field for compatibility
+    chan->position += chan->increment * frames;
+
+    if (!left) {
+        tracker_voice_skip(&chan->voice_playback, frames);
+        return;
+    }
+
+    // Apply volume: channel volume * sample volume * track volume * user volume
+    // Channel volume: 0-127 (from pattern commands, smoothly interpolated)
+    // Sample volume: 0-64 (stored in MMD0sample array)
+    // Track volume: 0-127 (127 = full volume / no scaling)
+    float vol = (chan->current_volume / (float)player->max_volume) * (chan->sample->volume / 64.0f) *
+               (player->track_volumes[ch] / 127.0f) * chan->user_volume;
+
+    // Half-scale headroom on the bus, as the shared mixer applied before
+    left_gain *= 0.5f * vol;
+    right_gain *= 0.5f * vol;
+
+    if (channel_out) {
+        // Keep the channel signal, then add it to the bus
+        tracker_voice_render_mono(&chan->voice_playback, player->interpolation, channel_out, frames);
+        for (uint32_t i = 0; i < frames; i++) {
+            left[i] += channel_out[i] * left_gain;
+            right[i] += channel_out[i] * right_gain;
+            channel_out[i] *= vol;
+        }
+    } else {
+        tracker_voice_render(&chan->voice_playback, player->interpolation,
+                             left, right, frames, left_gain, right_gain);
+    }
+}
+
+// Render a channel for a block within one tick
+static void render_channel(MedPlayer* player, int ch, float* left, float* right,
+                           float* channel_out, uint32_t frames,
+                           float sample_rate, float ramp_rate) {
+    MedChannel* chan = &player->channels[ch];
+
+    if (channel_out) {
+        memset(channel_out, 0, frames * sizeof(float));
+    }
+    if (!chan->sample || chan->muted) return;
+
+#ifdef MMD_SYNTH_SUPPORT
+    // Volume already ramped per frame by render_synths()
+    if (is_synth_channel(chan)) {
+        render_span(player, ch, left, right, channel_out, frames, sample_rate);
+        return;
+    }
+#endif
+
+    // Smooth volume interpolation toward target volume, one frame at a time
+    // while ramping so the ramp stays per-sample
+    uint32_t i = 0;
+    while (i < frames) {
+        uint32_t span = (chan->current_volume != chan->volume) ? 1 : frames - i;
+        chan->current_volume = ramp_volume(chan->current_volume, chan->volume, ramp_rate);
+
+        render_span(player, ch, left ? left + i : NULL, right ? right + i : NULL,
+                    channel_out ? channel_out + i : NULL, span, sample_rate);
+        i += span;
+    }
+}
+
 // Process audio with per-channel outputs
 void med_player_process_channels(MedPlayer* player,
                                  float* left_out,
@@ -1811,18 +2101,26 @@ void med_player_process_channels(MedPlayer* player,
     float ramp_time = 0.010f;  // 10 milliseconds
     float ramp_rate = player->max_volume / (ramp_time * sample_rate);
 
+    // Channels accumulate into the bus
+    memset(left_out, 0, frames * sizeof(float));
+    memset(right_out, 0, frames * sizeof(float));
+
     // Update timing once per buffer (efficient)
     if (player->playing) {
         pattern_sequencer_update_timing(player->sequencer, sample_rate);
     }
 
-    // CRITICAL: Interleave timing and rendering sample-by-sample
-    // This ensures that per-tick effects (portamento, etc.) are applied
+    // CRITICAL: Interleave timing and rendering tick by tick
+    // Each span starts at a tick (or the buffer start) and ends right before
+    // the next one, so per-tick effects (portamento, etc.) are applied
     // at the exact sample where they should occur, not batched beforehand
-    for (size_t i = 0; i < frames; i++) {
-        // Process timing for THIS SINGLE SAMPLE (optimized - no recalc per sample)
+    size_t i = 0;
+    while (i < frames) {
+        uint32_t span = (uint32_t)(frames - i);
+
+        // Process timing up to the next tick (no recalc per sample)
         if (player->playing) {
-            pattern_sequencer_process_sample(player->sequencer);
+            span = pattern_sequencer_process_span(player->sequencer, span);
 
             // Sync playing state from sequencer (it may have stopped)
             player->playing = pattern_sequencer_is_playing(player->sequencer);
@@ -1830,181 +2128,82 @@ void med_player_process_channels(MedPlayer* player,
 
         // If playback stopped, clear remaining buffer
         if (!player->playing) {
-            left_out[i] = 0.0f;
-            right_out[i] = 0.0f;
             if (channel_outputs) {
                 for (uint8_t c = 0; c < num_channel_outputs; c++) {
                     if (channel_outputs[c]) {
-                        channel_outputs[c][i] = 0.0f;
+                        memset(&channel_outputs[c][i], 0, (frames - i) * sizeof(float));
                     }
                 }
             }
-            continue;
+            break;
         }
 
-        float left = 0.0f;
-        float right = 0.0f;
-
-        // Mix all channels
-        for (int ch = 0; ch < player->num_tracks; ch++) {
-            MedChannel* chan = &player->channels[ch];
-            if (!chan->sample || chan->muted) continue;
-
-            // Smooth volume interpolation toward target volume
-            if (chan->current_volume < chan->volume) {
-                chan->current_volume += ramp_rate;
-                if (chan->current_volume > chan->volume) {
-                    chan->current_volume = chan->volume;
-                }
-            } else if (chan->current_volume > chan->volume) {
-                chan->current_volume -= ramp_rate;
-                if (chan->current_volume < chan->volume) {
-                    chan->current_volume = chan->volume;
-                }
-            }
+        // Mix all channels, in blocks that fit the synth buffer
+        for (uint32_t offset = 0; offset < span; offset += MED_RENDER_BLOCK) {
+            uint32_t block = span - offset;
+            if (block > MED_RENDER_BLOCK) block = MED_RENDER_BLOCK;
+            size_t pos = i + offset;
 
 #ifdef MMD_SYNTH_SUPPORT
-            // Handle synth instruments
-            if (chan->sample->is_synth && chan->sample->synth) {
-                SynthInstrument* synth = chan->sample->synth;
-
-                // Smooth volume interpolation toward target (10ms ramp time)
-                float ramp_rate = 127.0f / (0.010f * sample_rate);
-                if (synth->current_volume < synth->target_volume) {
-                    synth->current_volume += ramp_rate;
-                    if (synth->current_volume > synth->target_volume) {
-                        synth->current_volume = synth->target_volume;
-                    }
-                } else if (synth->current_volume > synth->target_volume) {
-                    synth->current_volume -= ramp_rate;
-                    if (synth->current_volume < synth->target_volume) {
-                        synth->current_volume = synth->target_volume;
-                    }
-                }
-
-                // static int synth_debug_count = 0;
-                // if (synth_debug_count < 5 && chan->period > 0) {
-                //     fprintf(stderr, "SYNTH PROCESS: ch=%d period=%d vol=%d\n",
-                //             ch, chan->period, chan->volume);
-                //     synth_debug_count++;
-                // }
-
-                if (chan->period > 0) {
-                    // For synth instruments, calculate frequency from period using C-2 as reference
-                    // C-2 (period 428) = 130.81 Hz (MIDI note 48)
-                    // Formula: freq = (130.81 * 428) / period = 55986.68 / period
-                    float freq = 55986.68f / (float)chan->period;
-                    float sample = synth_instrument_process(chan->sample->synth, freq, sample_rate);
-
-                    // static int sample_debug_count = 0;
-                    // if (sample_debug_count < 3) {
-                    //     fprintf(stderr, "SYNTH SAMPLE: ch=%d wf=%d synth_vol=%d sample=%.3f freq=%.1f\n",
-                    //             ch, chan->sample->synth->current_waveform,
-                    //             chan->sample->synth->current_volume, sample, freq);
-                    //     sample_debug_count++;
-                    // }
-
-                    // Apply volume: channel volume * sample volume * track volume * user volume
-                    // Channel volume: 0-127 (from pattern commands, smoothly interpolated)
-                    // Sample volume: 0-64 (stored in MMD0sample array)
-                    // Track volume: 0-127 (stored in trackvols array) - but wait, OctaMED docs say 0-64!
-                    // FIXME: Track volume scaling might be wrong
-                    float vol = (chan->current_volume / (float)player->max_volume) * (chan->sample->volume / 64.0f) *
-                               (player->track_volumes[ch] / 127.0f) * chan->user_volume;
-
-                    // Store volume-scaled sample for mixing
-                    float scaled_sample = sample * vol;
-
-                    // Convert MMD panning (-16 to +16) to normalized panning (-1.0 to 1.0)
-                    float pan_normalized = tracker_mixer_mmd_pan_to_normalized(player->track_pans[ch]);
-
-                    // Mix to stereo using shared mixer (no scaling here, apply later)
-                    TrackerMixerChannel mix_ch = {
-                        .sample = scaled_sample,
-                        .panning = pan_normalized,
-                        .enabled = 1
-                    };
-
-                    float ch_left, ch_right;
-                    tracker_mixer_mix_stereo(&mix_ch, 1, &ch_left, &ch_right, 1.0f);
-
-                    left += ch_left;
-                    right += ch_right;
-
-                    // Write to individual channel output if buffer provided
-                    if (channel_outputs && ch < num_channel_outputs && channel_outputs[ch]) {
-                        channel_outputs[ch][i] = scaled_sample;
-                    }
-                }
-                continue;
-            }
+            render_synths(player, block, sample_rate, ramp_rate);
 #endif
 
-            // Regular sample playback
-            if (!chan->sample->data) continue;
-
-            // Set TrackerVoice frequency based on period
-            // MMD uses PAL Amiga clock: freq = 7093789.2 / (period * 2) = 3546894.6 / period
-            // CRITICAL: For 16-bit samples, use HALF clock rate (play slower)
-            if (chan->period > 0) {
-                uint32_t clock_rate = 3546895;
-
-                if (chan->sample->is_16bit) {
-                    clock_rate /= 2;  // HALF clock for 16-bit samples (play at half speed)
-                }
-
-                tracker_voice_set_period(&chan->voice_playback, chan->period, clock_rate, (uint32_t)sample_rate);
+            for (int ch = 0; ch < player->num_tracks; ch++) {
+                float* channel_out = (channel_outputs && ch < num_channel_outputs && channel_outputs[ch])
+                                     ? &channel_outputs[ch][pos] : NULL;
+                render_channel(player, ch, &left_out[pos], &right_out[pos], channel_out, block,
+                               sample_rate, ramp_rate);
             }
+        }
 
-            // Get sample from TrackerVoice (handles both 8-bit and 16-bit, plus looping)
-            int32_t sample_val = tracker_voice_get_sample(&chan->voice_playback);
+        i += span;
+    }
+}
 
-            // Convert to float based on bit depth
-            float sample;
-            if (chan->sample->is_16bit) {
-                sample = sample_val / 32768.0f;
-            } else {
-                sample = sample_val / 128.0f;
-            }
+// Advance playback without mixing (same spans and blocks as
+// med_player_process_channels(), synths still run frame by frame)
+uint32_t med_player_fast_forward(MedPlayer* player, uint32_t rows, float sample_rate,
+                                 uint64_t* frames) {
+    if (frames) *frames = 0;
+    if (!player || !player->playing) return 0;
 
-            // Sync old position field for compatibility
-            chan->position += chan->increment;
+    // Rows passed on the way are not reported
+    MedPositionCallback callback = player->position_callback;
+    player->position_callback = NULL;
 
-            // Apply volume: channel volume * sample volume * track volume * user volume
-            // Channel volume: 0-127 (from pattern commands, smoothly interpolated)
-            // Sample volume: 0-64 (stored in MMD0sample array)
-            // Track volume: 0-127 (127 = full volume / no scaling)
-            float vol = (chan->current_volume / (float)player->max_volume) * (chan->sample->volume / 64.0f) *
-                       (player->track_volumes[ch] / 127.0f) * chan->user_volume;
+    float ramp_time = 0.010f;
+    float ramp_rate = player->max_volume / (ramp_time * sample_rate);
 
-            // Store volume-scaled sample for mixing
-            float scaled_sample = sample * vol;
+    pattern_sequencer_update_timing(player->sequencer, sample_rate);
 
-            // Convert MMD panning (-16 to +16) to normalized panning (-1.0 to 1.0)
-            float pan_normalized = tracker_mixer_mmd_pan_to_normalized(player->track_pans[ch]);
+    uint32_t passed = 0;
+    while (player->playing) {
+        if (pattern_sequencer_is_at_row_start(player->sequencer)) {
+            if (passed == rows) break;
+            passed++;
+        }
 
-            // Mix to stereo using shared mixer
-            TrackerMixerChannel mix_ch = {
-                .sample = scaled_sample,
-                .panning = pan_normalized,
-                .enabled = 1
-            };
+        uint32_t span = pattern_sequencer_process_span(player->sequencer, UINT32_MAX);
+        player->playing = pattern_sequencer_is_playing(player->sequencer);
+        if (!player->playing) break;
+        if (frames) *frames += span;
 
-            float ch_left, ch_right;
-            tracker_mixer_mix_stereo(&mix_ch, 1, &ch_left, &ch_right, 0.5f);
+        for (uint32_t offset = 0; offset < span; offset += MED_RENDER_BLOCK) {
+            uint32_t block = span - offset;
+            if (block > MED_RENDER_BLOCK) block = MED_RENDER_BLOCK;
 
-            left += ch_left;
-            right += ch_right;
+#ifdef MMD_SYNTH_SUPPORT
+            render_synths(player, block, sample_rate, ramp_rate);
+#endif
 
-            // Write to individual channel output if buffer provided
-            if (channel_outputs && ch < num_channel_outputs && channel_outputs[ch]) {
-                channel_outputs[ch][i] = scaled_sample;
+            for (int ch = 0; ch < player->num_tracks; ch++) {
+                render_channel(player, ch, NULL, NULL, NULL, block, sample_rate, ramp_rate);
             }
         }
-
-        left_out[i] = left;
-        right_out[i] = right;
     }
+
+    player->position_callback = callback;
+    return passed;
 }
 
 // Process audio (wrapper for backwards compatibility)
@@ -2098,6 +2297,18 @@ void med_player_set_loop_range(MedPlayer* player, uint16_t start_order, uint16_t
 void med_player_set_disable_looping(MedPlayer* player, bool disable) {
     if (!player) return;
     player->disable_looping = disable;
+    // Playback runs on the sequencer, which stops at the song end when not looping
+    pattern_sequencer_set_looping(player->sequencer, !disable);
+}
+
+// Set sample interpolation
+void med_player_set_interpolation(MedPlayer* player, TrackerInterpolation interp) {
+    if (!player || (unsigned)interp >= TRACKER_INTERP_NUM_MODES) return;
+    player->interpolation = interp;
+}
+
+TrackerInterpolation med_player_get_interpolation(const MedPlayer* player) {
+    return player ? player->interpolation : TRACKER_INTERP_NONE;
 }
 
 uint8_t med_player_get_num_channels(const MedPlayer* player) {
@@ -2108,3 +2319,169 @@ uint8_t med_player_get_num_channels(const MedPlayer* player) {
 PatternSequencer* med_player_get_sequencer(MedPlayer* player) {
     return player ? player->sequencer : NULL;
 }
+
+// Playback state snapshot
+// A fixed header followed by the state of each track. Sample pointers are
+// stored as instrument numbers (0 = none). Synth script and oscillator state
+// lives in the (shared) instrument, so it is saved per instrument.
+#define MED_STATE_MAGIC 0x5344454DU  // "MEDS"
+
+#ifdef MMD_SYNTH_SUPPORT
+typedef struct {
+    uint8_t current_waveform;
+    uint8_t target_volume;
+    float current_volume;
+    SynthScript vol_script;
+    SynthScript wave_script;
+    uint16_t env_counter;
+    float env_volume;
+    WavetableOscillator wavetable_osc;
+} MedSynthState;
+#endif
+
+typedef struct {
+    uint32_t magic;
+    uint32_t size;
+    uint8_t num_tracks;
+    uint16_t current_order;
+    uint16_t current_pattern;
+    uint16_t current_row;
+    uint16_t bpm;
+    uint8_t speed;
+    uint32_t tick;
+    PatternSequencerState sequencer;
+#ifdef MMD_SYNTH_SUPPORT
+    MedSynthState synths[MAX_SAMPLES];
+#endif
+} MedStateHeader;
+
+typedef struct {
+    MedChannel channel;
+    uint8_t sample;
+    uint8_t waveform;
+} MedChannelState;
+
+static uint8_t med_sample_number(const MedPlayer* player, const MedSample* sample) {
+    if (sample < player->samples || sample >= player->samples + MAX_SAMPLES) return 0;
+    return (uint8_t)(sample - player->samples + 1);
+}
+
+static uint8_t med_waveform_number(const MedPlayer* player, const void* waveform) {
+    if (!waveform) return 0;
+    for (int i = 0; i < MAX_SAMPLES; i++) {
+        if (player->samples[i].data == waveform) return (uint8_t)(i + 1);
+    }
+    return 0;
+}
+
+size_t med_player_get_state_size(const MedPlayer* player) {
+    if (!player) return 0;
+    return sizeof(MedStateHeader) + player->num_tracks * sizeof(MedChannelState);
+}
+
+bool med_player_save_state(const MedPlayer* player, void* buffer, size_t size) {
+    if (!player || !player->sequencer || !buffer) return false;
+
+    size_t needed = med_player_get_state_size(player);
+    if (size < needed) return false;
+
+    MedStateHeader* header = (MedStateHeader*)buffer;
+    memset(buffer, 0, needed);
+    header->magic = MED_STATE_MAGIC;
+    header->size = (uint32_t)needed;
+    header->num_tracks = player->num_tracks;
+    header->current_order = player->current_order;
+    header->current_pattern = player->current_pattern;
+    header->current_row = player->current_row;
+    header->bpm = player->bpm;
+    header->speed = player->speed;
+    header->tick = player->tick;
+    pattern_sequencer_save_state(player->sequencer, &header->sequencer);
+
+#ifdef MMD_SYNTH_SUPPORT
+    for (int i = 0; i < MAX_SAMPLES; i++) {
+        const SynthInstrument* synth = player->samples[i].synth;
+        if (!synth) continue;
+
+        MedSynthState* saved = &header->synths[i];
+        saved->current_waveform = synth->current_waveform;
+        saved->target_volume = synth->target_volume;
+        saved->current_volume = synth->current_volume;
+        saved->vol_script = synth->vol_script;
+        saved->wave_script = synth->wave_script;
+        saved->env_counter = synth->env_counter;
+        saved->env_volume = synth->env_volume;
+        saved->wavetable_osc = synth->wavetable_osc;
+    }
+#endif
+
+    MedChannelState* channels = (MedChannelState*)(header + 1);
+    for (int ch = 0; ch < player->num_tracks; ch++) {
+        const MedChannel* chan = &player->channels[ch];
+
+        channels[ch].channel = *chan;
+        channels[ch].channel.sample = NULL;
+        channels[ch].channel.voice_playback.waveform = NULL;
+        channels[ch].sample = med_sample_number(player, chan->sample);
+        channels[ch].waveform = med_waveform_number(player, chan->voice_playback.waveform);
+    }
+
+    return true;
+}
+
+bool med_player_restore_state(MedPlayer* player, const void* buffer, size_t size) {
+    if (!player || !player->sequencer || !buffer || size < sizeof(MedStateHeader)) return false;
+
+    const MedStateHeader* header = (const MedStateHeader*)buffer;
+    if (header->magic != MED_STATE_MAGIC || header->num_tracks != player->num_tracks ||
+        header->size != med_player_get_state_size(player) || size < header->size) {
+        return false;
+    }
+
+    pattern_sequencer_restore_state(player->sequencer, &header->sequencer);
+    player->playing = pattern_sequencer_is_playing(player->sequencer);
+    player->current_order = header->current_order;
+    player->current_pattern = header->current_pattern;
+    player->current_row = header->current_row;
+    player->bpm = header->bpm;
+    player->speed = header->speed;
+    player->tick = header->tick;
+
+#ifdef MMD_SYNTH_SUPPORT
+    for (int i = 0; i < MAX_SAMPLES; i++) {
+        SynthInstrument* synth = player->samples[i].synth;
+        if (!synth) continue;
+
+        const MedSynthState* saved = &header->synths[i];
+        synth->current_waveform = saved->current_waveform;
+        synth->target_volume = saved->target_volume;
+        synth->current_volume = saved->current_volume;
+        synth->vol_script = saved->vol_script;
+        synth->wave_script = saved->wave_script;
+        synth->env_counter = saved->env_counter;
+        synth->env_volume = saved->env_volume;
+        synth->wavetable_osc = saved->wavetable_osc;
+        synth_select_waveform(player, synth);
+    }
+#endif
+
+    const MedChannelState* channels = (const MedChannelState*)(header + 1);
+    for (int ch = 0; ch < player->num_tracks; ch++) {
+        MedChannel* chan = &player->channels[ch];
+
+        // User controls stay as they are
+        bool muted = chan->muted;
+        float user_volume = chan->user_volume;
+
+        *chan = channels[ch].channel;
+        chan->muted = muted;
+        chan->user_volume = user_volume;
+
+        uint8_t s = channels[ch].sample;
+        uint8_t w = channels[ch].waveform;
+        chan->sample = (s > 0 && s <= MAX_SAMPLES) ? &player->samples[s - 1] : NULL;
+        chan->voice_playback.waveform = (w > 0 && w <= MAX_SAMPLES) ? player->samples[w - 1].data : NULL;
+    }
+
+    return true;
+}
@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include "tracker_voice.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -44,6 +45,19 @@ bool med_player_detect(const uint8_t* data, size_t size);
  */
 bool med_player_load(MedPlayer* player, const uint8_t* data, size_t size);
 
+/**
+ * Load an MMD2 file without copying it
+ * Pattern data and 8-bit (and aligned, already native) sample data are read
+ * straight from data, which must stay valid and unchanged until the next
+ * load or med_player_destroy() (e.g. a mapped_file mapping). 16-bit samples
+ * that need byte swapping are converted into a copy.
+ * @param player Player instance
+ * @param data File data
+ * @param size File size in bytes
+ * @return true on success, false on failure
+ */
+bool med_player_load_in_place(MedPlayer* player, const uint8_t* data, size_t size);
+
 /**
  * Start playback
  * @param player Player instance
@@ -192,6 +206,13 @@ void med_player_set_loop_range(MedPlayer* player, uint16_t start_order, uint16_t
  */
 void med_player_set_disable_looping(MedPlayer* player, bool disable);
 
+/**
+ * Set sample interpolation (default TRACKER_INTERP_NONE, as on the Amiga)
+ * Synth instruments are not affected.
+ */
+void med_player_set_interpolation(MedPlayer* player, TrackerInterpolation interp);
+TrackerInterpolation med_player_get_interpolation(const MedPlayer* player);
+
 /**
  * Get number of channels/tracks in loaded song
  * @param player Player instance
@@ -207,6 +228,35 @@ uint8_t med_player_get_num_channels(const MedPlayer* player);
  */
 struct PatternSequencer* med_player_get_sequencer(MedPlayer* player);
 
+/**
+ * Playback state snapshot
+ * Holds everything the song changes while it plays: position and timing,
+ * track state (notes, volume ramps, portamento) with sample positions, and
+ * the running synth scripts and oscillators. User controls (mute, channel
+ * volume, loop range, interpolation) are not part of it.
+ * Instruments are stored by number, so a snapshot can be restored into any
+ * player that has the same file loaded. The data is only valid for the same
+ * build (host byte order) and timing is in samples at the rate it was taken.
+ * @param buffer At least med_player_get_state_size() bytes
+ * @return false if the buffer is too small or does not hold a snapshot of
+ *         this song
+ */
+size_t med_player_get_state_size(const MedPlayer* player);
+bool med_player_save_state(const MedPlayer* player, void* buffer, size_t size);
+bool med_player_restore_state(MedPlayer* player, const void* buffer, size_t size);
+
+/**
+ * Advance playback without rendering audio (for seeking)
+ * Runs ticks, synths and sample positions exactly as med_player_process()
+ * would and stops at a row start (right before the tick that plays the row)
+ * after passing `rows` row starts. With rows = 0 it stops at the next row
+ * start. The position callback is not called for the rows passed.
+ * @param frames Receives the number of frames advanced (may be NULL)
+ * @return Number of rows passed (less than requested if the song ended)
+ */
+uint32_t med_player_fast_forward(MedPlayer* player, uint32_t rows, float sample_rate,
+                                 uint64_t* frames);
+
 #ifdef __cplusplus
 }
 #endif
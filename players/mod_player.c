@@ -12,6 +12,9 @@
 
 #define AMIGA_CLOCK 3546895  // PAL clock rate for period-to-frequency conversion
 
+// Frames per channel block summed into the bus by tracker_voice_mix_blocks()
+#define MOD_MIX_BLOCK 256
+
 // Forward declarations
 static void process_note(ModPlayer* player, uint8_t channel, const ModNote* note);
 static void process_effects(ModPlayer* player, uint8_t channel);
@@ -97,6 +100,8 @@ struct ModPlayer {
     uint8_t song_length;
     uint8_t num_patterns;
     ModNote* patterns;  // Dynamically allocated: [num_patterns][4][64]
+    bool samples_in_place;  // Sample data points into the caller's file data
+    uint32_t sample_rate;   // Rate of the current render (0 = none yet)
 
     // Pattern sequencer (NEW - handles timing/position/flow control)
     PatternSequencer* sequencer;
@@ -138,6 +143,13 @@ struct ModPlayer {
 
     // Channels
     ModChannel channels[MOD_MAX_CHANNELS];
+
+    // Replaced notes fading out (TrackerMixerVoices, only used with a fade time)
+    TrackerVoicePool* fading_notes;
+    uint16_t note_fade_ms;
+
+    // Sample interpolation
+    TrackerInterpolation interpolation;
 };
 
 // Helper: Convert period to frequency
@@ -205,8 +217,9 @@ ModPlayer* mod_player_create(void) {
 
     // Create pattern sequencer
     player->sequencer = pattern_sequencer_create();
-    if (!player->sequencer) {
-        free(player);
+    player->fading_notes = tracker_voice_pool_create(MOD_NOTE_FADE_VOICES, sizeof(TrackerMixerVoice));
+    if (!player->sequencer || !player->fading_notes) {
+        mod_player_destroy(player);
         return NULL;
     }
 
@@ -236,33 +249,48 @@ ModPlayer* mod_player_create(void) {
     return player;
 }
 
-void mod_player_destroy(ModPlayer* player) {
-    if (!player) return;
-
-    // Destroy pattern sequencer
-    if (player->sequencer) {
-        pattern_sequencer_destroy(player->sequencer);
-    }
-
-    // Free sample data
+// Free the previous song's samples and patterns (sample data loaded in
+// place belongs to the caller)
+static void free_song_data(ModPlayer* player) {
     for (int i = 0; i < MOD_MAX_SAMPLES; i++) {
-        if (player->samples[i].data) {
-            free(player->samples[i].data);
+        if (player->samples[i].data && !player->samples_in_place) {
+            free((void*)player->samples[i].data);
         }
+        player->samples[i].data = NULL;
     }
+    player->samples_in_place = false;
 
-    // Free pattern data
     if (player->patterns) {
         free(player->patterns);
+        player->patterns = NULL;
     }
+}
 
+void mod_player_destroy(ModPlayer* player) {
+    if (!player) return;
+
+    // Destroy pattern sequencer
+    if (player->sequencer) {
+        pattern_sequencer_destroy(player->sequencer);
+    }
+    tracker_voice_pool_destroy(player->fading_notes);
+
+    free_song_data(player);
     free(player);
 }
 
-bool mod_player_load(ModPlayer* player, const uint8_t* data, uint32_t size) {
+static bool load_song(ModPlayer* player, const uint8_t* data, uint32_t size, bool in_place) {
     if (!player || !data) return false;
     if (!is_valid_mod(data, size)) return false;
 
+    // Nothing may keep playing the old samples
+    for (int i = 0; i < MOD_MAX_CHANNELS; i++) {
+        player->channels[i].sample = NULL;
+    }
+    tracker_voice_pool_clear(player->fading_notes);
+    free_song_data(player);
+    player->samples_in_place = in_place;
+
     // Parse title
     memcpy(player->title, data, MOD_TITLE_LENGTH);
     player->title[MOD_TITLE_LENGTH] = '\0';
@@ -359,9 +387,15 @@ bool mod_player_load(ModPlayer* player, const uint8_t* data, uint32_t size) {
         uint32_t sample_length_bytes = sample->length * 2;  // Convert words to bytes
 
         if (sample_length_bytes > 0 && offset + sample_length_bytes <= size) {
-            sample->data = (int8_t*)malloc(sample_length_bytes);
-            if (sample->data) {
-                memcpy(sample->data, data + offset, sample_length_bytes);
+            if (in_place) {
+                // 8-bit signed PCM needs no conversion
+                sample->data = (const int8_t*)(data + offset);
+            } else {
+                int8_t* copy = (int8_t*)malloc(sample_length_bytes);
+                if (copy) {
+                    memcpy(copy, data + offset, sample_length_bytes);
+                }
+                sample->data = copy;
             }
             offset += sample_length_bytes;
         }
@@ -401,6 +435,14 @@ bool mod_player_load(ModPlayer* player, const uint8_t* data, uint32_t size) {
     return true;
 }
 
+bool mod_player_load(ModPlayer* player, const uint8_t* data, uint32_t size) {
+    return load_song(player, data, size, false);
+}
+
+bool mod_player_load_in_place(ModPlayer* player, const uint8_t* data, uint32_t size) {
+    return load_song(player, data, size, true);
+}
+
 // Pattern sequencer callbacks
 static void mod_on_tick(void* user_data, uint8_t tick) {
     ModPlayer* player = (ModPlayer*)user_data;
@@ -451,6 +493,7 @@ void mod_player_stop(ModPlayer* player) {
     for (int i = 0; i < MOD_MAX_CHANNELS; i++) {
         player->channels[i].sample = NULL;
     }
+    tracker_voice_pool_clear(player->fading_notes);
 }
 
 bool mod_player_is_playing(const ModPlayer* player) {
@@ -560,6 +603,45 @@ void mod_player_set_disable_looping(ModPlayer* player, bool disable) {
     }
 }
 
+void mod_player_set_interpolation(ModPlayer* player, TrackerInterpolation interp) {
+    if (!player || (unsigned)interp >= TRACKER_INTERP_NUM_MODES) return;
+    player->interpolation = interp;
+}
+
+TrackerInterpolation mod_player_get_interpolation(const ModPlayer* player) {
+    return player ? player->interpolation : TRACKER_INTERP_NONE;
+}
+
+void mod_player_set_note_fade(ModPlayer* player, uint16_t fade_ms) {
+    if (!player) return;
+    player->note_fade_ms = fade_ms;
+}
+
+uint16_t mod_player_get_note_fade(const ModPlayer* player) {
+    return player ? player->note_fade_ms : 0;
+}
+
+// With a note fade time, the note a channel is about to replace moves to the
+// fading notes and plays on there (at its last pitch) while it fades out
+static void fade_out_note(ModPlayer* player, uint8_t channel) {
+    ModChannel* chan = &player->channels[channel];
+    const TrackerVoice* playback = &chan->voice_playback;
+    uint32_t sample_rate = player->sample_rate;
+
+    if (player->note_fade_ms == 0 || sample_rate == 0) return;
+    if (!chan->sample || chan->period == 0 || chan->volume == 0 || !playback->waveform) return;
+    if (!playback->loop_enabled && playback->sample_pos >= playback->length) return;
+
+    TrackerMixerVoice note;
+    note.playback = *playback;
+    note.gain = (float)chan->volume / 64.0f;
+    note.pan = chan->panning;
+    note.fade_step = 0.0f;
+    note.channel = channel;
+    tracker_mixer_voice_fade_out(&note, (uint32_t)((uint64_t)player->note_fade_ms * sample_rate / 1000));
+    tracker_voice_pool_add(player->fading_notes, &note);
+}
+
 // Process note for a channel
 static void process_note(ModPlayer* player, uint8_t channel, const ModNote* note) {
     ModChannel* chan = &player->channels[channel];
@@ -574,6 +656,8 @@ static void process_note(ModPlayer* player, uint8_t channel, const ModNote* note
 
         // Trigger sample if there's a period OR if there's effect 9 (offset retrigger)
         if (note->period > 0 || note->effect == 0x9) {
+            fade_out_note(player, channel);
+
             chan->sample = sample;
             chan->finetune = sample->finetune;
 
@@ -615,6 +699,8 @@ static void process_note(ModPlayer* player, uint8_t channel, const ModNote* note
         // ProTracker: period without sample number = retrigger last sample
         // This must happen BEFORE we process tone portamento
         if (note->sample == 0 && chan->sample != NULL && note->effect != 0x3 && note->effect != 0x5) {
+            fade_out_note(player, channel);
+
             // Retrigger: Use last offset ONLY if it belongs to the current sample
             if (chan->last_sample_offset > 0 && chan->sample == chan->last_sample_with_offset) {
                 uint32_t byte_offset = chan->last_sample_offset * 256;
@@ -924,7 +1010,7 @@ static void process_effects(ModPlayer* player, uint8_t channel) {
                 int16_t vibrato_delta = ((int16_t)vibrato_val * chan->vibrato_depth) / 128;
 
                 // Apply vibrato to period (don't modify base period)
-                // This is applied during rendering in render_channel
+                // This is applied during rendering in prepare_channel
 
                 // Advance vibrato position
                 chan->vibrato_pos += chan->vibrato_speed;
@@ -1031,16 +1117,20 @@ static void process_effects(ModPlayer* player, uint8_t channel) {
     }
 }
 
-// Render one sample for a channel
-static float render_channel(ModChannel* chan, uint32_t sample_rate, ModPlayer* player, uint8_t channel_num) {
+// Set a channel up for a span of frames: period, vibrato and tremolo only
+// change on ticks, so the voice delta and gains are fixed for the span.
+// Returns false if the channel is silent; otherwise the caller renders the
+// voice or, when fast-forwarding, skips it.
+static bool prepare_channel(ModChannel* chan, uint32_t sample_rate, uint32_t frames,
+                            float* volume_out, float* left_gain_out, float* right_gain_out) {
     if (!chan->sample || chan->period == 0 || chan->muted) {
-        return 0.0f;
+        return false;
     }
 
     const ModSample* sample = chan->sample;
 
     if (!sample->data || sample->length == 0) {
-        return 0.0f;
+        return false;
     }
 
     // Calculate playback increment with vibrato
@@ -1067,12 +1157,8 @@ static float render_channel(ModChannel* chan, uint32_t sample_rate, ModPlayer* p
     // Set TrackerVoice frequency/delta based on period
     tracker_voice_set_period(&chan->voice_playback, effective_period, AMIGA_CLOCK, sample_rate);
 
-    // Get sample from TrackerVoice (handles looping automatically)
-    int32_t sample_val = tracker_voice_get_sample(&chan->voice_playback);
-    float output = (float)sample_val / 128.0f;
-
     // Sync old position field for compatibility with effects
-    chan->position += chan->increment;
+    chan->position += chan->increment * frames;
 
     // Apply volume with tremolo
     uint8_t effective_volume = chan->volume;
@@ -1088,10 +1174,78 @@ static float render_channel(ModChannel* chan, uint32_t sample_rate, ModPlayer* p
         effective_volume = (uint8_t)new_volume;
     }
 
-    output *= (float)effective_volume / 64.0f;
-    output *= chan->user_volume;
+    float volume = (float)effective_volume / 64.0f * chan->user_volume;
 
-    return output;
+    // Pan gains with Amiga-style headroom
+    float left_gain, right_gain;
+    tracker_mixer_pan_to_gains(chan->panning, &left_gain, &right_gain);
+    *volume_out = volume;
+    *left_gain_out = left_gain * 0.5f * volume;
+    *right_gain_out = right_gain * 0.5f * volume;
+    return true;
+}
+
+// Render a span of frames for all channels into the stereo bus and the
+// channel outputs. Each channel renders a mono block (into its output when
+// it has one), then the blocks are summed into the bus in one pass, in
+// channel order as adding them one at a time would.
+static void render_channels(ModPlayer* player, uint32_t sample_rate,
+                            float* left, float* right, float* channel_outputs[MOD_MAX_CHANNELS],
+                            uint32_t offset, uint32_t frames) {
+    float* channel_out[MOD_MAX_CHANNELS];
+    float volume[MOD_MAX_CHANNELS], left_gain[MOD_MAX_CHANNELS], right_gain[MOD_MAX_CHANNELS];
+    int active[MOD_MAX_CHANNELS];
+    int num_active = 0;
+
+    for (int c = 0; c < MOD_MAX_CHANNELS; c++) {
+        ModChannel* chan = &player->channels[c];
+        channel_out[c] = (channel_outputs && channel_outputs[c]) ? &channel_outputs[c][offset] : NULL;
+        if (channel_out[c]) {
+            memset(channel_out[c], 0, frames * sizeof(float));
+        }
+
+        if (!prepare_channel(chan, sample_rate, frames, &volume[c], &left_gain[c], &right_gain[c])) {
+            continue;
+        }
+
+        // A finished one-shot adds nothing to the bus
+        const TrackerVoice* voice = &chan->voice_playback;
+        if (!channel_out[c] && (!voice->waveform || (voice->sample_pos >> 16) >= (voice->length >> 16))) {
+            continue;
+        }
+        active[num_active++] = c;
+    }
+
+    float scratch[MOD_MAX_CHANNELS][MOD_MIX_BLOCK];
+    for (uint32_t done = 0; done < frames; ) {
+        uint32_t n = frames - done < MOD_MIX_BLOCK ? frames - done : MOD_MIX_BLOCK;
+
+        const float* blocks[MOD_MAX_CHANNELS];
+        float gains_l[MOD_MAX_CHANNELS], gains_r[MOD_MAX_CHANNELS];
+        for (int a = 0; a < num_active; a++) {
+            int c = active[a];
+            float* voice_out = channel_out[c] ? channel_out[c] + done : scratch[a];
+            tracker_voice_render_mono(&player->channels[c].voice_playback, player->interpolation,
+                                      voice_out, n);
+            blocks[a] = voice_out;
+            gains_l[a] = left_gain[c];
+            gains_r[a] = right_gain[c];
+        }
+
+        tracker_voice_mix_blocks(left + offset + done, right + offset + done, blocks,
+                                 gains_l, gains_r, num_active, n);
+
+        // Channel outputs keep the channel at its volume, without pan and headroom
+        for (int a = 0; a < num_active; a++) {
+            int c = active[a];
+            if (!channel_out[c]) continue;
+            float* out = channel_out[c] + done;
+            for (uint32_t i = 0; i < n; i++) {
+                out[i] *= volume[c];
+            }
+        }
+        done += n;
+    }
 }
 
 void mod_player_process_channels(ModPlayer* player,
@@ -1102,18 +1256,33 @@ void mod_player_process_channels(ModPlayer* player,
                                   uint32_t sample_rate) {
     if (!player || !left || !right) return;
 
+    // Channels accumulate into the bus
+    memset(left, 0, frames * sizeof(float));
+    memset(right, 0, frames * sizeof(float));
+
     // Update timing once per buffer (efficient)
     if (player->playing) {
         pattern_sequencer_update_timing(player->sequencer, sample_rate);
     }
+    player->sample_rate = sample_rate;
+
+    // Fading notes follow their channel's mute and volume
+    float channel_gains[MOD_MAX_CHANNELS];
+    for (uint8_t c = 0; c < MOD_MAX_CHANNELS; c++) {
+        channel_gains[c] = player->channels[c].muted ? 0.0f : player->channels[c].user_volume;
+    }
 
-    // CRITICAL: Interleave timing and rendering sample-by-sample
-    // This ensures that per-tick effects (portamento, vibrato, etc.) are applied
+    // CRITICAL: Interleave timing and rendering tick by tick
+    // Each span starts at a tick (or the buffer start) and ends right before
+    // the next one, so per-tick effects (portamento, vibrato, etc.) are applied
     // at the exact sample where they should occur, not batched beforehand
-    for (uint32_t i = 0; i < frames; i++) {
-        // Process timing for THIS SINGLE SAMPLE (optimized - no recalc per sample)
+    uint32_t i = 0;
+    while (i < frames) {
+        uint32_t span = frames - i;
+
+        // Process timing up to the next tick (no recalc per sample)
         if (player->playing) {
-            pattern_sequencer_process_sample(player->sequencer);
+            span = pattern_sequencer_process_span(player->sequencer, span);
 
             // Sync playing state from sequencer (it may have stopped)
             player->playing = pattern_sequencer_is_playing(player->sequencer);
@@ -1121,36 +1290,23 @@ void mod_player_process_channels(ModPlayer* player,
 
         // If playback stopped, clear remaining buffer
         if (!player->playing) {
-            left[i] = 0.0f;
-            right[i] = 0.0f;
             if (channel_outputs) {
                 for (uint8_t c = 0; c < MOD_MAX_CHANNELS; c++) {
                     if (channel_outputs[c]) {
-                        channel_outputs[c][i] = 0.0f;
+                        memset(&channel_outputs[c][i], 0, (frames - i) * sizeof(float));
                     }
                 }
             }
-            continue;
+            break;
         }
 
-        // Render each channel and optionally write to individual outputs
-        TrackerMixerChannel mix_channels[MOD_MAX_CHANNELS];
-        for (uint8_t c = 0; c < MOD_MAX_CHANNELS; c++) {
-            float channel_sample = render_channel(&player->channels[c], sample_rate, player, c);
-            mix_channels[c].sample = channel_sample;
-            mix_channels[c].panning = player->channels[c].panning;
-            mix_channels[c].enabled = 1;
-
-            // Write to individual channel output if buffer provided
-            if (channel_outputs && channel_outputs[c]) {
-                channel_outputs[c][i] = channel_sample;
-            }
-        }
+        // Render the channels into the bus and optionally their own outputs
+        render_channels(player, sample_rate, left, right, channel_outputs, i, span);
+        tracker_voice_pool_mix(player->fading_notes, player->interpolation, left, right,
+                               channel_outputs, channel_outputs ? MOD_MAX_CHANNELS : 0, i,
+                               channel_gains, MOD_MAX_CHANNELS, 0.5f, span);
 
-        // Mix to stereo using shared mixer
-        tracker_mixer_mix_stereo(mix_channels, MOD_MAX_CHANNELS,
-                                &left[i], &right[i],
-                                0.5f);  // Amiga-style headroom
+        i += span;
     }
 }
 
@@ -1159,6 +1315,168 @@ void mod_player_process(ModPlayer* player, float* left, float* right, uint32_t f
     mod_player_process_channels(player, left, right, NULL, frames, sample_rate);
 }
 
+uint32_t mod_player_fast_forward(ModPlayer* player, uint32_t rows, uint32_t sample_rate,
+                                 uint64_t* frames) {
+    if (frames) *frames = 0;
+    if (!player || !player->playing) return 0;
+
+    // Rows passed on the way are not reported
+    ModPlayerPositionCallback callback = player->position_callback;
+    player->position_callback = NULL;
+
+    pattern_sequencer_update_timing(player->sequencer, sample_rate);
+    player->sample_rate = sample_rate;
+
+    uint32_t passed = 0;
+    while (player->playing) {
+        if (pattern_sequencer_is_at_row_start(player->sequencer)) {
+            if (passed == rows) break;
+            passed++;
+        }
+
+        // Same spans as mod_player_process_channels(), without mixing
+        uint32_t span = pattern_sequencer_process_span(player->sequencer, UINT32_MAX);
+        player->playing = pattern_sequencer_is_playing(player->sequencer);
+        if (!player->playing) break;
+        if (frames) *frames += span;
+
+        for (uint8_t c = 0; c < MOD_MAX_CHANNELS; c++) {
+            ModChannel* chan = &player->channels[c];
+            float volume, left_gain, right_gain;
+            if (prepare_channel(chan, sample_rate, span, &volume, &left_gain, &right_gain)) {
+                tracker_voice_skip(&chan->voice_playback, span);
+            }
+        }
+        tracker_voice_pool_mix(player->fading_notes, player->interpolation, NULL, NULL,
+                               NULL, 0, 0, NULL, 0, 0.5f, span);
+    }
+
+    player->position_callback = callback;
+    return passed;
+}
+
 PatternSequencer* mod_player_get_sequencer(ModPlayer* player) {
     return player ? player->sequencer : NULL;
 }
+
+// Playback state snapshot
+// Channels are stored as they are, with their sample pointers replaced by
+// sample numbers (0 = none) so the snapshot is valid for any player that
+// has the same file loaded.
+#define MOD_STATE_MAGIC 0x53444F4DU  // "MODS"
+
+typedef struct {
+    uint32_t magic;
+    uint32_t size;
+    uint8_t tick;
+    uint8_t speed;
+    uint8_t bpm;
+    PatternSequencerState sequencer;
+    ModChannel channels[MOD_MAX_CHANNELS];
+    uint8_t sample[MOD_MAX_CHANNELS];
+    uint8_t offset_sample[MOD_MAX_CHANNELS];
+    uint8_t waveform[MOD_MAX_CHANNELS];
+    uint8_t num_fading;
+    TrackerMixerVoice fading[MOD_NOTE_FADE_VOICES];   // Oldest first
+    uint8_t fading_waveform[MOD_NOTE_FADE_VOICES];
+} ModPlayerState;
+
+static uint8_t sample_number(const ModPlayer* player, const ModSample* sample) {
+    if (sample < player->samples || sample >= player->samples + MOD_MAX_SAMPLES) return 0;
+    return (uint8_t)(sample - player->samples + 1);
+}
+
+static uint8_t waveform_number(const ModPlayer* player, const void* waveform) {
+    if (!waveform) return 0;
+    for (int i = 0; i < MOD_MAX_SAMPLES; i++) {
+        if (player->samples[i].data == waveform) return (uint8_t)(i + 1);
+    }
+    return 0;
+}
+
+size_t mod_player_get_state_size(const ModPlayer* player) {
+    (void)player;
+    return sizeof(ModPlayerState);
+}
+
+bool mod_player_save_state(const ModPlayer* player, void* buffer, size_t size) {
+    if (!player || !player->sequencer || !buffer || size < sizeof(ModPlayerState)) return false;
+
+    ModPlayerState* state = (ModPlayerState*)buffer;
+    memset(state, 0, sizeof(*state));
+    state->magic = MOD_STATE_MAGIC;
+    state->size = sizeof(ModPlayerState);
+    state->tick = player->tick;
+    state->speed = player->speed;
+    state->bpm = player->bpm;
+    pattern_sequencer_save_state(player->sequencer, &state->sequencer);
+
+    for (int c = 0; c < MOD_MAX_CHANNELS; c++) {
+        const ModChannel* chan = &player->channels[c];
+        ModChannel* saved = &state->channels[c];
+
+        *saved = *chan;
+        saved->sample = NULL;
+        saved->last_sample_with_offset = NULL;
+        saved->voice_playback.waveform = NULL;
+
+        state->sample[c] = sample_number(player, chan->sample);
+        state->offset_sample[c] = sample_number(player, chan->last_sample_with_offset);
+        state->waveform[c] = waveform_number(player, chan->voice_playback.waveform);
+    }
+
+    state->num_fading = (uint8_t)tracker_voice_pool_get_count(player->fading_notes);
+    for (uint8_t i = 0; i < state->num_fading; i++) {
+        const TrackerMixerVoice* note = tracker_voice_pool_get(player->fading_notes, i);
+        state->fading[i] = *note;
+        state->fading[i].playback.waveform = NULL;
+        state->fading_waveform[i] = waveform_number(player, note->playback.waveform);
+    }
+
+    return true;
+}
+
+bool mod_player_restore_state(ModPlayer* player, const void* buffer, size_t size) {
+    if (!player || !player->sequencer || !buffer || size < sizeof(ModPlayerState)) return false;
+
+    const ModPlayerState* state = (const ModPlayerState*)buffer;
+    if (state->magic != MOD_STATE_MAGIC || state->size != sizeof(ModPlayerState)) return false;
+
+    pattern_sequencer_restore_state(player->sequencer, &state->sequencer);
+    player->playing = pattern_sequencer_is_playing(player->sequencer);
+    player->tick = state->tick;
+    player->speed = state->speed;
+    player->bpm = state->bpm;
+
+    for (int c = 0; c < MOD_MAX_CHANNELS; c++) {
+        ModChannel* chan = &player->channels[c];
+
+        // User controls stay as they are
+        bool muted = chan->muted;
+        float user_volume = chan->user_volume;
+
+        *chan = state->channels[c];
+        chan->muted = muted;
+        chan->user_volume = user_volume;
+
+        uint8_t s = state->sample[c];
+        uint8_t o = state->offset_sample[c];
+        uint8_t w = state->waveform[c];
+        chan->sample = (s > 0 && s <= MOD_MAX_SAMPLES) ? &player->samples[s - 1] : NULL;
+        chan->last_sample_with_offset = (o > 0 && o <= MOD_MAX_SAMPLES) ? &player->samples[o - 1] : NULL;
+        chan->voice_playback.waveform = (w > 0 && w <= MOD_MAX_SAMPLES) ? player->samples[w - 1].data : NULL;
+    }
+
+    // Added back in the same order, so they mix and get taken over alike
+    tracker_voice_pool_clear(player->fading_notes);
+    uint8_t num_fading = state->num_fading < MOD_NOTE_FADE_VOICES ? state->num_fading : MOD_NOTE_FADE_VOICES;
+    for (uint8_t i = 0; i < num_fading; i++) {
+        uint8_t w = state->fading_waveform[i];
+        if (w == 0 || w > MOD_MAX_SAMPLES) continue;
+
+        TrackerMixerVoice* note = tracker_voice_pool_add(player->fading_notes, &state->fading[i]);
+        note->playback.waveform = player->samples[w - 1].data;
+    }
+
+    return true;
+}
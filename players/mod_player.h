@@ -7,10 +7,12 @@
  * - Pattern loop control (stay within pattern range)
  * - Per-channel mute, volume, and panning
  * - Support for common MOD effects
+ * - Optional note fades: replaced notes fade out instead of being cut
  */
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "tracker_voice.h"
 
 #ifdef __cplusplus
@@ -23,6 +25,7 @@ extern "C" {
 #define MOD_PATTERN_ROWS 64
 #define MOD_TITLE_LENGTH 20
 #define MOD_SAMPLE_NAME_LENGTH 22
+#define MOD_NOTE_FADE_VOICES 16     // Replaced notes that can fade out at once
 
 typedef struct ModPlayer ModPlayer;
 
@@ -45,7 +48,7 @@ typedef struct {
     uint8_t volume;           // Default volume (0-64)
     uint32_t repeat_start;    // Loop start in words
     uint32_t repeat_length;   // Loop length in words
-    int8_t* data;             // Sample data (8-bit signed)
+    const int8_t* data;       // Sample data (8-bit signed)
 } ModSample;
 
 /**
@@ -129,6 +132,14 @@ bool mod_player_detect(const uint8_t* data, uint32_t size);
  */
 bool mod_player_load(ModPlayer* player, const uint8_t* data, uint32_t size);
 
+/**
+ * Load a MOD file without copying its sample data
+ * Samples are played straight from data, which must stay valid and unchanged
+ * until the next load or mod_player_destroy() (e.g. a mapped_file mapping).
+ * Patterns are still decoded into the player.
+ */
+bool mod_player_load_in_place(ModPlayer* player, const uint8_t* data, uint32_t size);
+
 /**
  * Start playback
  */
@@ -243,6 +254,22 @@ uint8_t mod_player_get_song_length(const ModPlayer* player);
  */
 void mod_player_set_disable_looping(ModPlayer* player, bool disable);
 
+/**
+ * Set sample interpolation (default TRACKER_INTERP_NONE, as on the Amiga)
+ */
+void mod_player_set_interpolation(ModPlayer* player, TrackerInterpolation interp);
+TrackerInterpolation mod_player_get_interpolation(const ModPlayer* player);
+
+/**
+ * Set the fade-out time of replaced notes (default 0 = cut, as on the Amiga)
+ * With a fade time, a note that a new note replaces keeps playing on its
+ * own and fades out over fade_ms, like a new note action in XM/IT. Up to
+ * MOD_NOTE_FADE_VOICES notes fade at once; further ones take over the
+ * quietest. Notes already fading are not affected by a change.
+ */
+void mod_player_set_note_fade(ModPlayer* player, uint16_t fade_ms);
+uint16_t mod_player_get_note_fade(const ModPlayer* player);
+
 /**
  * Get underlying PatternSequencer (for advanced control with RegrooveController)
  * WARNING: Do not destroy the returned sequencer - it's owned by the player
@@ -251,6 +278,35 @@ void mod_player_set_disable_looping(ModPlayer* player, bool disable);
  */
 struct PatternSequencer* mod_player_get_sequencer(ModPlayer* player);
 
+/**
+ * Playback state snapshot
+ * Holds everything the song changes while it plays: position and timing,
+ * note and effect state of each channel (effect memory, portamento target,
+ * vibrato/tremolo phase, panning), sample positions and fading notes. User
+ * controls (mute, channel volume, loop range, interpolation, note fade time)
+ * are not part of it.
+ * Samples are stored by number, so a snapshot can be restored into any
+ * player that has the same file loaded. The data is only valid for the same
+ * build (host byte order) and timing is in samples at the rate it was taken.
+ * buffer: At least mod_player_get_state_size() bytes
+ * Returns false if the buffer is too small or does not hold a MOD snapshot
+ */
+size_t mod_player_get_state_size(const ModPlayer* player);
+bool mod_player_save_state(const ModPlayer* player, void* buffer, size_t size);
+bool mod_player_restore_state(ModPlayer* player, const void* buffer, size_t size);
+
+/**
+ * Advance playback without rendering audio (for seeking)
+ * Runs ticks and sample positions exactly as mod_player_process() would and
+ * stops at a row start (right before the tick that plays the row) after
+ * passing `rows` row starts. With rows = 0 it stops at the next row start.
+ * The position callback is not called for the rows passed.
+ * frames (may be NULL) receives the number of frames advanced.
+ * Returns the number of rows passed (less than requested if the song ended)
+ */
+uint32_t mod_player_fast_forward(ModPlayer* player, uint32_t rows, uint32_t sample_rate,
+                                 uint64_t* frames);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,466 @@
+/*
+ * OPL Dump Player - AdLib / OPL2 / OPL3 register log playback
+ * Decodes VGM, DRO and IMF streams into one timed event list and drives
+ * the block-rendering OPL engine between events.
+ */
+
+#include "opl_dump_player.h"
+#include "../synth/synth_opl.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* VGM timing is fixed at 44100 Hz, DRO is in milliseconds */
+#define VGM_RATE 44100
+#define DRO_RATE 1000
+
+/* Output sample rate used until the first process() call */
+#define DEFAULT_SAMPLE_RATE 48000
+
+/* One register write at an absolute source tick */
+typedef struct {
+    uint32_t tick;
+    uint16_t reg;
+    uint8_t value;
+} OplDumpEvent;
+
+struct OplDumpPlayer {
+    SynthOPL* opl;
+
+    /* Decoded stream */
+    OplDumpFormat format;
+    OplDumpEvent* events;
+    size_t num_events;
+    size_t capacity;
+    uint32_t tick_rate;        /* Source ticks per second */
+    uint32_t end_tick;         /* Length of the dump */
+    int64_t loop_event;        /* First event of the loop, -1 = no loop */
+    uint32_t loop_tick;
+    int imf_rate;
+
+    /* Playback state */
+    bool is_playing;
+    bool disable_looping;
+    int sample_rate;
+    size_t event_index;
+    uint64_t tick_offset;      /* Ticks added by completed loops */
+    uint64_t sample_pos;       /* Output samples since start */
+};
+
+static inline uint16_t read_le16(const uint8_t* data) {
+    return (uint16_t)(data[0] | (data[1] << 8));
+}
+
+static inline uint32_t read_le32(const uint8_t* data) {
+    return (uint32_t)data[0] | ((uint32_t)data[1] << 8) |
+           ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+static bool push_event(OplDumpPlayer* player, uint32_t tick, uint16_t reg, uint8_t value) {
+    if (player->num_events == player->capacity) {
+        size_t new_capacity = player->capacity ? player->capacity * 2 : 1024;
+        OplDumpEvent* events = (OplDumpEvent*)realloc(player->events, new_capacity * sizeof(OplDumpEvent));
+        if (!events) return false;
+        player->events = events;
+        player->capacity = new_capacity;
+    }
+
+    OplDumpEvent* ev = &player->events[player->num_events++];
+    ev->tick = tick;
+    ev->reg = reg;
+    ev->value = value;
+    return true;
+}
+
+/* ============================================================================
+ * Format Decoders
+ * ============================================================================ */
+
+static bool decode_vgm(OplDumpPlayer* player, const uint8_t* data, size_t size) {
+    if (size < 0x40) return false;
+
+    const uint32_t version = read_le32(data + 0x08);
+    size_t pos = 0x40;
+    if (version >= 0x150) {
+        uint32_t rel = read_le32(data + 0x34);
+        if (rel) pos = 0x34 + (size_t)rel;
+    }
+
+    size_t loop_pos = 0;
+    if (read_le32(data + 0x1C)) {
+        loop_pos = 0x1C + (size_t)read_le32(data + 0x1C);
+    }
+
+    player->tick_rate = VGM_RATE;
+    uint32_t tick = 0;
+
+    while (pos < size) {
+        if (loop_pos && pos == loop_pos && player->loop_event < 0) {
+            player->loop_event = (int64_t)player->num_events;
+            player->loop_tick = tick;
+        }
+
+        const uint8_t cmd = data[pos];
+
+        if (cmd == 0x66) break;  /* End of sound data */
+
+        if (cmd == 0x5A || cmd == 0x5B || cmd == 0x5C || cmd == 0x5E || cmd == 0x5F) {
+            if (pos + 3 > size) break;
+            const uint16_t bank = (cmd == 0x5F) ? 0x100 : 0;
+            if (!push_event(player, tick, (uint16_t)(bank | data[pos + 1]), data[pos + 2])) return false;
+            pos += 3;
+        } else if (cmd == 0x61) {
+            if (pos + 3 > size) break;
+            tick += read_le16(data + pos + 1);
+            pos += 3;
+        } else if (cmd == 0x62) {
+            tick += 735;
+            pos++;
+        } else if (cmd == 0x63) {
+            tick += 882;
+            pos++;
+        } else if ((cmd & 0xF0) == 0x70) {
+            tick += (cmd & 0x0F) + 1;
+            pos++;
+        } else if ((cmd & 0xF0) == 0x80) {
+            tick += cmd & 0x0F;   /* YM2612 DAC write + wait, data ignored */
+            pos++;
+        } else if (cmd == 0x67) {
+            /* Data block: 0x67 0x66 tt ssssssss */
+            if (pos + 7 > size) break;
+            pos += 7 + (size_t)read_le32(data + pos + 3);
+        } else if (cmd >= 0x30 && cmd <= 0x3F) {
+            pos += 2;
+        } else if ((cmd >= 0x40 && cmd <= 0x4E) || (cmd >= 0x51 && cmd <= 0x5F) || (cmd >= 0xA0 && cmd <= 0xBF)) {
+            pos += 3;  /* Other chips: two operand bytes */
+        } else if (cmd == 0x4F || cmd == 0x50 || cmd == 0x94) {
+            pos += 2;
+        } else if (cmd >= 0xC0 && cmd <= 0xDF) {
+            pos += 4;
+        } else if (cmd >= 0xE0) {
+            pos += 5;
+        } else if (cmd == 0x68) {
+            pos += 12;
+        } else if (cmd == 0x90 || cmd == 0x91 || cmd == 0x95) {
+            pos += 5;
+        } else if (cmd == 0x92) {
+            pos += 6;
+        } else if (cmd == 0x93) {
+            pos += 11;
+        } else {
+            pos++;  /* Unknown single-byte command */
+        }
+    }
+
+    /* Header total sample count is authoritative when present */
+    const uint32_t total = read_le32(data + 0x18);
+    player->end_tick = total > tick ? total : tick;
+    return true;
+}
+
+static bool decode_dro(OplDumpPlayer* player, const uint8_t* data, size_t size) {
+    if (size < 0x1A) return false;
+
+    const uint16_t major = read_le16(data + 0x08);
+    const uint16_t minor = read_le16(data + 0x0A);
+    player->tick_rate = DRO_RATE;
+    uint32_t tick = 0;
+
+    if (major == 2 && minor == 0) {
+        /* DRO v2: code/value pairs with a register codemap */
+        const uint32_t num_pairs = read_le32(data + 0x0C);
+        const uint8_t short_delay = data[0x17];
+        const uint8_t long_delay = data[0x18];
+        const uint8_t codemap_len = data[0x19];
+        size_t pos = 0x1A + codemap_len;
+        if (pos > size || codemap_len > 128) return false;
+        const uint8_t* codemap = data + 0x1A;
+
+        for (uint32_t i = 0; i < num_pairs && pos + 2 <= size; i++, pos += 2) {
+            const uint8_t code = data[pos];
+            const uint8_t value = data[pos + 1];
+
+            if (code == short_delay) {
+                tick += (uint32_t)value + 1;
+            } else if (code == long_delay) {
+                tick += ((uint32_t)value + 1) << 8;
+            } else {
+                if ((code & 0x7F) >= codemap_len) continue;
+                const uint16_t reg = (uint16_t)(codemap[code & 0x7F] | ((code & 0x80) ? 0x100 : 0));
+                if (!push_event(player, tick, reg, value)) return false;
+            }
+        }
+    } else if (major == 0 && minor == 1) {
+        /* DRO v1: byte commands, hardware type is 1 or 4 bytes wide */
+        const uint32_t length = read_le32(data + 0x10);
+        size_t pos = 0x15;
+        if (size >= 0x18 && data[0x15] == 0 && data[0x16] == 0 && data[0x17] == 0) {
+            pos = 0x18;
+        }
+        const size_t end = (pos + length < size) ? pos + length : size;
+        uint16_t bank = 0;
+
+        while (pos < end) {
+            const uint8_t cmd = data[pos++];
+            switch (cmd) {
+            case 0x00:  /* Delay, 1 byte */
+                if (pos >= end) break;
+                tick += (uint32_t)data[pos++] + 1;
+                break;
+            case 0x01:  /* Delay, 2 bytes */
+                if (pos + 2 > end) { pos = end; break; }
+                tick += (uint32_t)read_le16(data + pos) + 1;
+                pos += 2;
+                break;
+            case 0x02:  /* Low chip / bank */
+                bank = 0;
+                break;
+            case 0x03:  /* High chip / bank */
+                bank = 0x100;
+                break;
+            case 0x04:  /* Escape: next byte is a register */
+                if (pos + 2 > end) { pos = end; break; }
+                if (!push_event(player, tick, (uint16_t)(bank | data[pos]), data[pos + 1])) return false;
+                pos += 2;
+                break;
+            default:
+                if (pos >= end) break;
+                if (!push_event(player, tick, (uint16_t)(bank | cmd), data[pos++])) return false;
+                break;
+            }
+        }
+    } else {
+        return false;
+    }
+
+    const uint32_t length_ms = read_le32(data + ((major == 2) ? 0x10 : 0x0C));
+    player->end_tick = length_ms > tick ? length_ms : tick;
+    return true;
+}
+
+static bool decode_imf(OplDumpPlayer* player, const uint8_t* data, size_t size) {
+    if (size < 4) return false;
+
+    /* Type 1 starts with the length of the register data; type 0 is raw */
+    size_t pos = 0;
+    size_t end = size & ~(size_t)3;
+    const uint16_t length = read_le16(data);
+    if (length != 0 && (length & 3) == 0 && (size_t)length + 2 <= size) {
+        pos = 2;
+        end = 2 + length;
+    }
+
+    player->tick_rate = (uint32_t)player->imf_rate;
+    uint32_t tick = 0;
+
+    /* Records: register, value, delay after the write */
+    for (; pos + 4 <= end; pos += 4) {
+        if (!push_event(player, tick, data[pos], data[pos + 1])) return false;
+        tick += read_le16(data + pos + 2);
+    }
+
+    player->end_tick = tick;
+    player->loop_event = 0;
+    player->loop_tick = 0;
+    return true;
+}
+
+/* ============================================================================
+ * Lifecycle
+ * ============================================================================ */
+
+OplDumpPlayer* opl_dump_player_create(void) {
+    OplDumpPlayer* player = (OplDumpPlayer*)calloc(1, sizeof(OplDumpPlayer));
+    if (!player) return NULL;
+
+    player->sample_rate = DEFAULT_SAMPLE_RATE;
+    player->opl = synth_opl_create(player->sample_rate);
+    if (!player->opl) {
+        free(player);
+        return NULL;
+    }
+
+    player->imf_rate = OPL_DUMP_IMF_DEFAULT_RATE;
+    player->loop_event = -1;
+    return player;
+}
+
+void opl_dump_player_destroy(OplDumpPlayer* player) {
+    if (!player) return;
+
+    synth_opl_destroy(player->opl);
+    free(player->events);
+    free(player);
+}
+
+/* ============================================================================
+ * File Loading
+ * ============================================================================ */
+
+OplDumpFormat opl_dump_player_detect(const uint8_t* data, size_t size) {
+    if (!data) return OPL_DUMP_NONE;
+
+    if (size >= 0x40 && memcmp(data, "Vgm ", 4) == 0) {
+        /* Require one of the OPL family clocks (v1.51+ header) */
+        const uint32_t version = read_le32(data + 0x08);
+        if (version < 0x151) return OPL_DUMP_VGM;
+        if (size >= 0x64 && (read_le32(data + 0x50) || read_le32(data + 0x54) ||
+                             read_le32(data + 0x58) || read_le32(data + 0x5C))) {
+            return OPL_DUMP_VGM;
+        }
+        return OPL_DUMP_NONE;
+    }
+
+    if (size >= 0x1A && memcmp(data, "DBRAWOPL", 8) == 0) {
+        return OPL_DUMP_DRO;
+    }
+
+    return OPL_DUMP_NONE;
+}
+
+bool opl_dump_player_load(OplDumpPlayer* player, const uint8_t* data, size_t size) {
+    if (!player || !data) return false;
+
+    opl_dump_player_stop(player);
+    player->num_events = 0;
+    player->loop_event = -1;
+    player->loop_tick = 0;
+    player->end_tick = 0;
+    player->format = OPL_DUMP_NONE;
+
+    OplDumpFormat format = opl_dump_player_detect(data, size);
+    bool ok;
+    switch (format) {
+    case OPL_DUMP_VGM:
+        ok = decode_vgm(player, data, size);
+        break;
+    case OPL_DUMP_DRO:
+        ok = decode_dro(player, data, size);
+        break;
+    default:
+        format = OPL_DUMP_IMF;
+        ok = decode_imf(player, data, size);
+        break;
+    }
+
+    if (!ok || player->num_events == 0 || player->tick_rate == 0) {
+        player->num_events = 0;
+        return false;
+    }
+
+    player->format = format;
+    return true;
+}
+
+void opl_dump_player_set_imf_rate(OplDumpPlayer* player, int rate_hz) {
+    if (player && rate_hz > 0) player->imf_rate = rate_hz;
+}
+
+OplDumpFormat opl_dump_player_get_format(const OplDumpPlayer* player) {
+    return player ? player->format : OPL_DUMP_NONE;
+}
+
+/* ============================================================================
+ * Playback Control
+ * ============================================================================ */
+
+void opl_dump_player_start(OplDumpPlayer* player) {
+    if (!player || player->num_events == 0) return;
+
+    synth_opl_reset(player->opl);
+    player->event_index = 0;
+    player->tick_offset = 0;
+    player->sample_pos = 0;
+    player->is_playing = true;
+}
+
+void opl_dump_player_stop(OplDumpPlayer* player) {
+    if (!player) return;
+    player->is_playing = false;
+}
+
+bool opl_dump_player_is_playing(const OplDumpPlayer* player) {
+    return player && player->is_playing;
+}
+
+void opl_dump_player_set_disable_looping(OplDumpPlayer* player, bool disable) {
+    if (player) player->disable_looping = disable;
+}
+
+uint32_t opl_dump_player_get_time_ms(const OplDumpPlayer* player) {
+    if (!player || player->sample_rate <= 0) return 0;
+    return (uint32_t)(player->sample_pos * 1000 / (uint64_t)player->sample_rate);
+}
+
+uint32_t opl_dump_player_get_duration_ms(const OplDumpPlayer* player) {
+    if (!player || player->tick_rate == 0) return 0;
+    return (uint32_t)((uint64_t)player->end_tick * 1000 / player->tick_rate);
+}
+
+/* ============================================================================
+ * Audio Rendering
+ * ============================================================================ */
+
+/* First output sample at or after an absolute source tick */
+static inline uint64_t tick_to_sample(const OplDumpPlayer* player, uint64_t tick) {
+    return (tick * (uint64_t)player->sample_rate + player->tick_rate - 1) / player->tick_rate;
+}
+
+void opl_dump_player_process(OplDumpPlayer* player,
+                             float* left,
+                             float* right,
+                             size_t num_samples,
+                             int sample_rate) {
+    if (!player || !left || !right) return;
+
+    if (!player->is_playing) {
+        memset(left, 0, num_samples * sizeof(float));
+        memset(right, 0, num_samples * sizeof(float));
+        return;
+    }
+
+    if (sample_rate > 0 && sample_rate != player->sample_rate) {
+        player->sample_pos = player->sample_pos * (uint64_t)sample_rate / (uint64_t)player->sample_rate;
+        player->sample_rate = sample_rate;
+        synth_opl_set_sample_rate(player->opl, sample_rate);
+    }
+
+    size_t pos = 0;
+    while (pos < num_samples) {
+        /* Apply every write due at the current sample */
+        uint64_t next_sample;
+        for (;;) {
+            if (player->event_index >= player->num_events) {
+                const uint64_t end = tick_to_sample(player, player->tick_offset + player->end_tick);
+                if (player->sample_pos < end) {
+                    next_sample = end;
+                    break;
+                }
+                if (player->disable_looping || player->loop_event < 0 ||
+                    player->end_tick <= player->loop_tick) {
+                    player->is_playing = false;
+                    memset(left + pos, 0, (num_samples - pos) * sizeof(float));
+                    memset(right + pos, 0, (num_samples - pos) * sizeof(float));
+                    return;
+                }
+                player->tick_offset += player->end_tick - player->loop_tick;
+                player->event_index = (size_t)player->loop_event;
+                continue;
+            }
+
+            const OplDumpEvent* ev = &player->events[player->event_index];
+            next_sample = tick_to_sample(player, player->tick_offset + ev->tick);
+            if (next_sample > player->sample_pos) break;
+
+            synth_opl_write(player->opl, ev->reg, ev->value);
+            player->event_index++;
+        }
+
+        /* Render up to the next write in one block */
+        uint64_t span = next_sample - player->sample_pos;
+        if (span > num_samples - pos) span = num_samples - pos;
+
+        synth_opl_render(player->opl, left + pos, right + pos, (int)span);
+        pos += (size_t)span;
+        player->sample_pos += span;
+    }
+}
@@ -0,0 +1,142 @@
+#ifndef OPL_DUMP_PLAYER_H
+#define OPL_DUMP_PLAYER_H
+
+/**
+ * OPL Dump Player - AdLib / OPL2 / OPL3 register log playback
+ *
+ * Features:
+ * - VGM (YM3812, YM3526, Y8950 and YMF262 commands)
+ * - DOSBox DRO v1 and v2
+ * - id Software IMF (type 0 and type 1)
+ * - Streams are decoded into a flat event list at load time
+ * - Audio between register writes is rendered in whole blocks, so offline
+ *   rendering runs many times faster than real time
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Opaque player structure */
+typedef struct OplDumpPlayer OplDumpPlayer;
+
+typedef enum {
+    OPL_DUMP_NONE = 0,
+    OPL_DUMP_VGM,
+    OPL_DUMP_DRO,
+    OPL_DUMP_IMF
+} OplDumpFormat;
+
+/* Default IMF tick rate (Commander Keen; Wolfenstein 3D uses 700 Hz) */
+#define OPL_DUMP_IMF_DEFAULT_RATE 560
+
+/* ============================================================================
+ * Lifecycle
+ * ============================================================================ */
+
+/**
+ * Create a new OPL dump player instance
+ * @return New player instance or NULL on failure
+ */
+OplDumpPlayer* opl_dump_player_create(void);
+
+/**
+ * Destroy player instance and free resources
+ */
+void opl_dump_player_destroy(OplDumpPlayer* player);
+
+/* ============================================================================
+ * File Loading
+ * ============================================================================ */
+
+/**
+ * Identify a register dump by its header
+ * IMF has no header and is never detected; opl_dump_player_load() falls
+ * back to it when the data is not VGM or DRO.
+ * @return Detected format or OPL_DUMP_NONE
+ */
+OplDumpFormat opl_dump_player_detect(const uint8_t* data, size_t size);
+
+/**
+ * Load a register dump from memory (the data is decoded, not referenced)
+ * @return true on success, false on failure
+ */
+bool opl_dump_player_load(OplDumpPlayer* player, const uint8_t* data, size_t size);
+
+/**
+ * Set the IMF tick rate in Hz (applies to the next IMF load)
+ */
+void opl_dump_player_set_imf_rate(OplDumpPlayer* player, int rate_hz);
+
+/**
+ * Get the format of the loaded dump
+ */
+OplDumpFormat opl_dump_player_get_format(const OplDumpPlayer* player);
+
+/* ============================================================================
+ * Playback Control
+ * ============================================================================ */
+
+/**
+ * Start playback from the beginning (resets the chip)
+ */
+void opl_dump_player_start(OplDumpPlayer* player);
+
+/**
+ * Stop playback
+ */
+void opl_dump_player_stop(OplDumpPlayer* player);
+
+/**
+ * Check if player is currently playing
+ * @return true if playing, false otherwise
+ */
+bool opl_dump_player_is_playing(const OplDumpPlayer* player);
+
+/**
+ * Disable looping (for rendering to file)
+ * @param disable true to disable looping, false to enable
+ */
+void opl_dump_player_set_disable_looping(OplDumpPlayer* player, bool disable);
+
+/* ============================================================================
+ * Playback Position
+ * ============================================================================ */
+
+/**
+ * Get current playback time in milliseconds
+ */
+uint32_t opl_dump_player_get_time_ms(const OplDumpPlayer* player);
+
+/**
+ * Get length of the dump (without loops) in milliseconds
+ */
+uint32_t opl_dump_player_get_duration_ms(const OplDumpPlayer* player);
+
+/* ============================================================================
+ * Audio Rendering
+ * ============================================================================ */
+
+/**
+ * Render stereo audio samples (silence when stopped)
+ * @param player Player instance
+ * @param left Left channel output buffer
+ * @param right Right channel output buffer
+ * @param num_samples Number of samples to render
+ * @param sample_rate Output sample rate (typically 48000)
+ */
+void opl_dump_player_process(OplDumpPlayer* player,
+                             float* left,
+                             float* right,
+                             size_t num_samples,
+                             int sample_rate);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPL_DUMP_PLAYER_H */
@@ -5,12 +5,15 @@
 #include "pattern_sequencer.h"
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 
 struct PatternSequencer {
     // Song structure
     uint16_t* pattern_order;     // Array of pattern numbers (owned)
     uint16_t order_length;       // Length of pattern_order
     uint16_t rows_per_pattern;   // Rows per pattern
+    uint16_t* pattern_rows;      // Rows of each pattern number (owned, NULL = all rows_per_pattern)
+    uint16_t num_pattern_rows;   // Entries in pattern_rows
 
     // Timing mode
     PatternSequencerMode mode;   // Tick-based (MOD/MMD) or frame-based (AHX)
@@ -80,6 +83,7 @@ void pattern_sequencer_destroy(PatternSequencer* seq) {
     if (seq->pattern_order) {
         free(seq->pattern_order);
     }
+    free(seq->pattern_rows);
 
     free(seq);
 }
@@ -128,6 +132,11 @@ void pattern_sequencer_set_song(PatternSequencer* seq,
 
     seq->rows_per_pattern = rows_per_pattern;
 
+    // Patterns are all the same length until told otherwise
+    free(seq->pattern_rows);
+    seq->pattern_rows = NULL;
+    seq->num_pattern_rows = 0;
+
     // Reset position
     seq->current_pattern_index = 0;
     seq->current_row = 0;
@@ -138,6 +147,41 @@ void pattern_sequencer_set_song(PatternSequencer* seq,
     seq->loop_end = order_length > 0 ? order_length - 1 : 0;
 }
 
+// Set per-pattern row counts
+void pattern_sequencer_set_pattern_rows(PatternSequencer* seq,
+                                        const uint16_t* rows,
+                                        uint16_t num_patterns) {
+    if (!seq) return;
+
+    free(seq->pattern_rows);
+    seq->pattern_rows = NULL;
+    seq->num_pattern_rows = 0;
+
+    if (rows && num_patterns > 0) {
+        seq->pattern_rows = (uint16_t*)malloc(num_patterns * sizeof(uint16_t));
+        if (seq->pattern_rows) {
+            memcpy(seq->pattern_rows, rows, num_patterns * sizeof(uint16_t));
+            seq->num_pattern_rows = num_patterns;
+        }
+    }
+}
+
+// Rows in the pattern played at an order index
+static uint16_t rows_at(const PatternSequencer* seq, uint16_t pattern_index) {
+    if (seq->pattern_rows && seq->pattern_order && pattern_index < seq->order_length) {
+        uint16_t pattern_num = seq->pattern_order[pattern_index];
+        if (pattern_num < seq->num_pattern_rows && seq->pattern_rows[pattern_num] > 0) {
+            return seq->pattern_rows[pattern_num];
+        }
+    }
+    return seq->rows_per_pattern;
+}
+
+uint16_t pattern_sequencer_get_pattern_rows(const PatternSequencer* seq, uint16_t pattern_index) {
+    if (!seq) return 0;
+    return rows_at(seq, pattern_index);
+}
+
 // Start playback
 void pattern_sequencer_start(PatternSequencer* seq) {
     if (!seq) return;
@@ -189,7 +233,6 @@ void pattern_sequencer_set_bpm(PatternSequencer* seq, uint8_t bpm) {
 void pattern_sequencer_set_speed(PatternSequencer* seq, uint8_t speed) {
     if (!seq) return;
     if (speed < 1) speed = 1;
-    if (speed > 31) speed = 31;
     seq->speed = speed;
 }
 
@@ -371,133 +414,78 @@ void pattern_sequencer_process(PatternSequencer* seq,
     // NOTE: This will be recalculated mid-buffer if BPM changes (see pattern_sequencer_set_bpm)
     recalculate_timing(seq, sample_rate);
 
-    for (uint32_t frame = 0; frame < frames; frame++) {
-        // Check if it's time for a tick
-        if (seq->sample_accumulator >= seq->samples_per_tick) {
-            seq->sample_accumulator -= seq->samples_per_tick;
-
-            // Handle pattern loop jump
-            if (seq->pattern_loop_pending) {
-                seq->pattern_loop_pending = false;
-                seq->current_row = seq->pattern_loop_row;
-                seq->tick = 0;
-                // Don't continue to normal row advance
-                goto tick_done;
-            }
-
-            // Tick callback (called every tick)
-            if (seq->callbacks.on_tick) {
-                seq->callbacks.on_tick(seq->user_data, seq->tick);
-            }
-
-            seq->tick++;
-
-            // Check if it's time to advance to next row
-            if (seq->tick >= seq->speed) {
-                seq->tick = 0;
-
-                // Handle pattern delay
-                if (seq->pattern_delay > 0) {
-                    seq->pattern_delay--;
-                    seq->in_pattern_delay = true;
-                    // Process same row again, but don't trigger on_row
-                    goto tick_done;
-                }
-                seq->in_pattern_delay = false;
-
-                // Row callback (called when advancing to new row)
-                if (seq->callbacks.on_row && seq->pattern_order) {
-                    uint16_t pattern_num = seq->pattern_order[seq->current_pattern_index];
-                    seq->callbacks.on_row(seq->user_data,
-                                         seq->current_pattern_index,
-                                         pattern_num,
-                                         seq->current_row);
-                }
+    // Step from tick to tick instead of sample by sample
+    while (frames > 0 && seq->playing) {
+        frames -= pattern_sequencer_process_span(seq, frames);
+    }
+}
 
-                // Handle pending jump (B or D effect)
-                if (seq->jump_pending) {
-                    seq->jump_pending = false;
+// Update timing (call once per buffer for efficiency)
+void pattern_sequencer_update_timing(PatternSequencer* seq, uint32_t sample_rate) {
+    if (!seq) return;
+    recalculate_timing(seq, sample_rate);
+}
 
-                    // Clamp to valid range
-                    if (seq->jump_to_pattern >= seq->order_length) {
-                        seq->jump_to_pattern = 0;
-                    }
+// Advance the sample accumulator by 1.0 up to max_steps times while it is below
+// limit, landing on exactly the value the same number of single-sample
+// increments would give. Above 1.0 the additions are exact until the sum
+// crosses a power of two, so whole runs within one binade are taken at once.
+static uint32_t advance_accumulator(double* accumulator, double limit, uint32_t max_steps) {
+    double acc = *accumulator;
+    uint32_t steps = 0;
+
+    while (steps < max_steps && acc < limit) {
+        if (acc >= 1.0) {
+            int exponent;
+            frexp(acc, &exponent);
+            double top = ldexp(1.0, exponent);
+
+            // Longest run that stays below the next power of two (both
+            // differences are exact since the operands are within 2x)
+            double run = ceil(top - acc) - 1.0;
+            if (limit < top) {
+                double needed = ceil(limit - acc);
+                if (needed < run) run = needed;
+            }
+            if (run > (double)(max_steps - steps)) run = (double)(max_steps - steps);
 
-                    seq->current_pattern_index = seq->jump_to_pattern;
-                    seq->current_row = seq->jump_to_row;
+            if (run >= 1.0) {
+                acc += run;
+                steps += (uint32_t)run;
+                continue;
+            }
+        }
 
-                    // Clear pattern loop on jump
-                    seq->pattern_loop_row = 0;
-                    seq->pattern_loop_count = 0;
+        acc += 1.0;
+        steps++;
+    }
 
-                    // Trigger pattern change callback
-                    if (seq->callbacks.on_pattern_change && seq->pattern_order) {
-                        uint16_t pattern_num = seq->pattern_order[seq->current_pattern_index];
-                        seq->callbacks.on_pattern_change(seq->user_data,
-                                                         seq->current_pattern_index,
-                                                         pattern_num);
-                    }
-                } else {
-                    // Normal row advance
-                    seq->current_row++;
-
-                    // Check if we've reached end of pattern
-                    if (seq->current_row >= seq->rows_per_pattern) {
-                        seq->current_row = 0;
-                        seq->current_pattern_index++;
-
-                        // Clear pattern loop when advancing to new pattern
-                        seq->pattern_loop_row = 0;
-                        seq->pattern_loop_count = 0;
-
-                        // Check if we've reached end of song order
-                        if (seq->current_pattern_index > seq->loop_end) {
-                            // Song ended
-                            bool should_continue = true;
-
-                            if (seq->callbacks.on_song_end) {
-                                should_continue = seq->callbacks.on_song_end(seq->user_data);
-                            }
-
-                            if (should_continue && seq->looping_enabled) {
-                                // Loop back to start
-                                seq->current_pattern_index = seq->loop_start;
-                            } else {
-                                // Stop playback
-                                seq->playing = false;
-                                return;
-                            }
-                        }
+    *accumulator = acc;
+    return steps;
+}
 
-                        // Trigger pattern change callback
-                        if (seq->callbacks.on_pattern_change && seq->pattern_order) {
-                            uint16_t pattern_num = seq->pattern_order[seq->current_pattern_index];
-                            seq->callbacks.on_pattern_change(seq->user_data,
-                                                             seq->current_pattern_index,
-                                                             pattern_num);
-                        }
-                    }
-                }
-            }
+// Samples before the next tick
+uint32_t pattern_sequencer_get_samples_until_tick(const PatternSequencer* seq) {
+    if (!seq || !seq->playing || !seq->pattern_order || seq->order_length == 0) {
+        return UINT32_MAX;
+    }
 
-tick_done:
-            (void)0; // Empty statement for label
-        }
+    double acc = seq->sample_accumulator;
+    return advance_accumulator(&acc, seq->samples_per_tick, UINT32_MAX);
+}
 
-        // Increment sample accumulator AFTER tick processing
-        // This matches the original MOD player timing and prevents systematic drift
-        seq->sample_accumulator += 1.0;
+// Process a run of samples up to the next tick
+uint32_t pattern_sequencer_process_span(PatternSequencer* seq, uint32_t max_frames) {
+    if (max_frames == 0) return 0;
+    if (!seq || !seq->playing || !seq->pattern_order || seq->order_length == 0) {
+        return max_frames;
     }
 
-    // Update last position
-    seq->last_pattern_index = seq->current_pattern_index;
-    seq->last_row = seq->current_row;
-}
+    // The first sample may run a tick; the rest of the span cannot
+    pattern_sequencer_process_sample(seq);
+    if (!seq->playing) return 1;
 
-// Update timing (call once per buffer for efficiency)
-void pattern_sequencer_update_timing(PatternSequencer* seq, uint32_t sample_rate) {
-    if (!seq) return;
-    recalculate_timing(seq, sample_rate);
+    return 1 + advance_accumulator(&seq->sample_accumulator, seq->samples_per_tick, max_frames - 1);
 }
 
 // Process a single sample (optimized for per-sample loops)
@@ -560,6 +548,11 @@ void pattern_sequencer_process_sample(PatternSequencer* seq) {
                 seq->current_pattern_index = seq->jump_to_pattern;
                 seq->current_row = seq->jump_to_row;
 
+                // Breaking to a row past the end of a shorter pattern starts it
+                if (seq->current_row >= rows_at(seq, seq->current_pattern_index)) {
+                    seq->current_row = 0;
+                }
+
                 // Clear pattern loop on jump
                 seq->pattern_loop_row = 0;
                 seq->pattern_loop_count = 0;
@@ -576,7 +569,7 @@ void pattern_sequencer_process_sample(PatternSequencer* seq) {
                 seq->current_row++;
 
                 // Check if we've reached end of pattern
-                if (seq->current_row >= seq->rows_per_pattern) {
+                if (seq->current_row >= rows_at(seq, seq->current_pattern_index)) {
                     seq->current_row = 0;
                     seq->current_pattern_index++;
 
@@ -625,3 +618,73 @@ tick_done:
     seq->last_pattern_index = seq->current_pattern_index;
     seq->last_row = seq->current_row;
 }
+
+// Save playback state
+void pattern_sequencer_save_state(const PatternSequencer* seq, PatternSequencerState* state) {
+    if (!seq || !state) return;
+
+    memset(state, 0, sizeof(*state));
+    state->playing = seq->playing;
+    state->current_pattern_index = seq->current_pattern_index;
+    state->current_row = seq->current_row;
+    state->rows_per_pattern = seq->rows_per_pattern;
+    state->tick = seq->tick;
+    state->speed = seq->speed;
+    state->bpm = seq->bpm;
+    state->samples_per_tick = seq->samples_per_tick;
+    state->sample_accumulator = seq->sample_accumulator;
+    state->pattern_loop_row = seq->pattern_loop_row;
+    state->pattern_loop_count = seq->pattern_loop_count;
+    state->pattern_loop_target = seq->pattern_loop_target;
+    state->pattern_loop_pending = seq->pattern_loop_pending;
+    state->pattern_delay = seq->pattern_delay;
+    state->in_pattern_delay = seq->in_pattern_delay;
+    state->jump_pending = seq->jump_pending;
+    state->jump_to_pattern = seq->jump_to_pattern;
+    state->jump_to_row = seq->jump_to_row;
+    state->last_pattern_index = seq->last_pattern_index;
+    state->last_row = seq->last_row;
+}
+
+// Restore playback state
+void pattern_sequencer_restore_state(PatternSequencer* seq, const PatternSequencerState* state) {
+    if (!seq || !state) return;
+
+    seq->playing = state->playing;
+    seq->current_pattern_index = state->current_pattern_index;
+    seq->current_row = state->current_row;
+    seq->rows_per_pattern = state->rows_per_pattern;
+    seq->tick = state->tick;
+    seq->speed = state->speed;
+    seq->bpm = state->bpm;
+    seq->samples_per_tick = state->samples_per_tick;
+    seq->sample_accumulator = state->sample_accumulator;
+    seq->pattern_loop_row = state->pattern_loop_row;
+    seq->pattern_loop_count = state->pattern_loop_count;
+    seq->pattern_loop_target = state->pattern_loop_target;
+    seq->pattern_loop_pending = state->pattern_loop_pending;
+    seq->pattern_delay = state->pattern_delay;
+    seq->in_pattern_delay = state->in_pattern_delay;
+    seq->jump_pending = state->jump_pending;
+    seq->jump_to_pattern = state->jump_to_pattern;
+    seq->jump_to_row = state->jump_to_row;
+    seq->last_pattern_index = state->last_pattern_index;
+    seq->last_row = state->last_row;
+
+    // Keep the position valid if the song structure differs
+    if (seq->current_pattern_index >= seq->order_length) {
+        seq->current_pattern_index = 0;
+    }
+}
+
+// Next sample fires on_row
+bool pattern_sequencer_is_at_row_start(const PatternSequencer* seq) {
+    if (!seq || !seq->playing || !seq->pattern_order || seq->order_length == 0) {
+        return false;
+    }
+
+    return seq->sample_accumulator >= seq->samples_per_tick &&
+           !seq->pattern_loop_pending &&
+           seq->tick + 1 >= seq->speed &&
+           seq->pattern_delay == 0;
+}
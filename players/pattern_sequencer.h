@@ -84,6 +84,34 @@ typedef struct {
 
 } PatternSequencerCallbacks;
 
+/**
+ * Playback state (position, timing, pending flow effects)
+ * Plain data for player state snapshots. Song structure, callbacks, timing
+ * mode and the loop range are not part of it.
+ */
+typedef struct {
+    bool playing;
+    uint16_t current_pattern_index;
+    uint16_t current_row;
+    uint16_t rows_per_pattern;
+    uint8_t tick;
+    uint8_t speed;
+    uint8_t bpm;
+    double samples_per_tick;
+    double sample_accumulator;
+    uint16_t pattern_loop_row;
+    uint8_t pattern_loop_count;
+    uint8_t pattern_loop_target;
+    bool pattern_loop_pending;
+    uint8_t pattern_delay;
+    bool in_pattern_delay;
+    bool jump_pending;
+    uint16_t jump_to_pattern;
+    uint16_t jump_to_row;
+    uint16_t last_pattern_index;
+    uint16_t last_row;
+} PatternSequencerState;
+
 /**
  * Create a new pattern sequencer
  * Returns NULL on allocation failure
@@ -125,6 +153,22 @@ void pattern_sequencer_set_song(PatternSequencer* seq,
                                 uint16_t order_length,
                                 uint16_t rows_per_pattern);
 
+/**
+ * Set the length of each pattern (XM/IT patterns vary in length)
+ * Call after pattern_sequencer_set_song(), which resets them.
+ * @param rows Rows per pattern number (copied internally); patterns past
+ *             num_patterns or with 0 rows use rows_per_pattern
+ * @param num_patterns Number of entries in rows (0 or NULL to clear)
+ */
+void pattern_sequencer_set_pattern_rows(PatternSequencer* seq,
+                                        const uint16_t* rows,
+                                        uint16_t num_patterns);
+
+/**
+ * Get the number of rows of the pattern at an order index
+ */
+uint16_t pattern_sequencer_get_pattern_rows(const PatternSequencer* seq, uint16_t pattern_index);
+
 /**
  * Start playback from beginning
  */
@@ -149,7 +193,7 @@ void pattern_sequencer_set_bpm(PatternSequencer* seq, uint8_t bpm);
 
 /**
  * Set speed (ticks per row)
- * Standard range: 1-31, default 6
+ * Range: 1-255 (MOD/MED use 1-31), default 6
  * Does NOT affect tick duration, only how many ticks before advancing row
  */
 void pattern_sequencer_set_speed(PatternSequencer* seq, uint8_t speed);
@@ -286,6 +330,47 @@ void pattern_sequencer_update_timing(PatternSequencer* seq, uint32_t sample_rate
  */
 void pattern_sequencer_process_sample(PatternSequencer* seq);
 
+/**
+ * Number of samples that can be processed before the next tick fires
+ * (0 = the next sample runs a tick). Uses the timing from the last
+ * pattern_sequencer_update_timing() call. Returns UINT32_MAX when stopped.
+ */
+uint32_t pattern_sequencer_get_samples_until_tick(const PatternSequencer* seq);
+
+/**
+ * Process timing for a span of samples that contains at most one tick,
+ * at its start (for block rendering)
+ *
+ * Equivalent to calling pattern_sequencer_process_sample() once per frame,
+ * but stops right before the next tick so the caller can render the returned
+ * number of frames with the current channel state in one go:
+ *
+ *     while (i < frames) {
+ *         uint32_t n = pattern_sequencer_process_span(seq, frames - i);
+ *         render(i, n);
+ *         i += n;
+ *     }
+ *
+ * @param max_frames Maximum number of frames to advance
+ * @return Frames advanced (1..max_frames). Returns 1 if playback stopped on
+ *         the first frame, max_frames if the sequencer is not playing.
+ */
+uint32_t pattern_sequencer_process_span(PatternSequencer* seq, uint32_t max_frames);
+
+/**
+ * Copy the playback state out of / back into a sequencer
+ * Restoring does not trigger any callbacks.
+ */
+void pattern_sequencer_save_state(const PatternSequencer* seq, PatternSequencerState* state);
+void pattern_sequencer_restore_state(PatternSequencer* seq, const PatternSequencerState* state);
+
+/**
+ * Check if the next sample runs the tick that starts a new row (on_row)
+ * Assumes the on_tick callback of that tick does not change speed or
+ * pattern delay. Uses the timing from the last update_timing() call.
+ */
+bool pattern_sequencer_is_at_row_start(const PatternSequencer* seq);
+
 #ifdef __cplusplus
 }
 #endif
@@ -4,23 +4,33 @@
  * Provides advanced features on top of PatternSequencer:
  * - Row-precise loop control with arming/triggering
  * - Command queuing for pattern-boundary execution
+ * - Sample-accurate command scheduling through a lock-free MPSC queue
  * - Pattern mode (single pattern looping)
  * - Channel mute/solo with queuing
  */
 
 #include "regroove_controller.h"
+#include "../common/lockfree.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
-#define MAX_QUEUED_COMMANDS 16
+#define MAX_QUEUED_COMMANDS 64    // Power of two
+#define MAX_PENDING_COMMANDS 64
+#define MAX_COMMAND_REPORTS 64
 #define MAX_CHANNELS 64
+#define DEFAULT_ROWS_PER_BEAT 4
 
 // Queued command structure
 typedef struct {
     RegrooveCommandType type;
     uint16_t param1;  // order for jump, channel for mute/solo
     uint16_t param2;  // row for jump
+    RegrooveQuantize quantize;
+    uint64_t target;     // rows for RG_QUANTIZE_ROWS, sample time for RG_QUANTIZE_SAMPLE
+    uint32_t id;         // 0 = clear the commands queued before it
+    uint64_t submitted;
+    uint64_t scheduled;
 } QueuedCommand;
 
 // Internal structure
@@ -35,10 +45,26 @@ struct RegrooveController {
     uint16_t loop_end_order;
     uint16_t loop_end_row;
 
-    // Command queue
-    QueuedCommand command_queue[MAX_QUEUED_COMMANDS];
-    uint8_t queue_size;
+    // Command queue (any thread pushes, process() pops)
+    MpscQueue commands;
+    uint32_t command_sequence[MAX_QUEUED_COMMANDS];
+    QueuedCommand command_items[MAX_QUEUED_COMMANDS];
+    uint32_t next_command_id;
+    uint32_t dropped_commands;
+
+    // Commands waiting for their target (audio thread)
+    QueuedCommand pending[MAX_PENDING_COMMANDS];
+    uint8_t num_pending;
     bool execute_on_pattern_boundary;
+    uint16_t rows_per_beat;
+
+    // Reports of executed commands (process() pushes, the UI polls)
+    RegrooveCommandReport reports[MAX_COMMAND_REPORTS];
+    uint32_t report_head;
+    uint32_t report_tail;
+
+    // Samples processed (written by process(), read anywhere)
+    uint64_t sample_time;
 
     // Pattern mode
     RegroovePatternMode pattern_mode;
@@ -52,7 +78,6 @@ struct RegrooveController {
     // Current position tracking
     uint16_t current_order;
     uint16_t current_row;
-    uint16_t last_order;  // For detecting pattern boundaries
 
     // Callbacks
     RegrooveControllerCallbacks callbacks;
@@ -82,8 +107,11 @@ RegrooveController* regroove_controller_create(PatternSequencer* sequencer) {
     ctrl->sequencer = sequencer;
     ctrl->loop_state = RG_LOOP_OFF;
     ctrl->pattern_mode = RG_PATTERN_MODE_OFF;
-    ctrl->queue_size = 0;
+    ctrl->num_pending = 0;
     ctrl->execute_on_pattern_boundary = true;
+    ctrl->rows_per_beat = DEFAULT_ROWS_PER_BEAT;
+    mpsc_queue_init(&ctrl->commands, ctrl->command_sequence, ctrl->command_items,
+                    sizeof(QueuedCommand), MAX_QUEUED_COMMANDS);
     ctrl->any_solo_active = false;
 
     // Get original callbacks from sequencer (if any)
@@ -144,72 +172,112 @@ static void rg_on_tick(void* user_data, uint8_t tick) {
     }
 }
 
-static void execute_queued_commands(RegrooveController* ctrl) {
-    for (uint8_t i = 0; i < ctrl->queue_size; i++) {
-        QueuedCommand* cmd = &ctrl->command_queue[i];
+// Jump from a command. At a row start the position is changed before the
+// tick that plays the row, so the target row plays at this very sample;
+// elsewhere it works like an immediate jump.
+static void command_jump(RegrooveController* ctrl, uint16_t order, uint16_t row, bool at_row_start) {
+    if (!at_row_start) {
+        pattern_sequencer_set_position(ctrl->sequencer, order, row);
+        ctrl->current_order = order;
+        ctrl->current_row = row;
+        return;
+    }
 
-        switch (cmd->type) {
-            case RG_CMD_JUMP_TO_ORDER:
-                pattern_sequencer_set_position(ctrl->sequencer, cmd->param1, cmd->param2);
-                ctrl->current_order = cmd->param1;
-                ctrl->current_row = cmd->param2;
-                break;
+    if (order >= pattern_sequencer_get_song_length(ctrl->sequencer)) return;
+    if (row >= pattern_sequencer_get_pattern_rows(ctrl->sequencer, order)) row = 0;
 
-            case RG_CMD_NEXT_ORDER: {
-                uint16_t song_length = pattern_sequencer_get_song_length(ctrl->sequencer);
-                uint16_t next_order = (ctrl->current_order + 1) % song_length;
-                pattern_sequencer_set_position(ctrl->sequencer, next_order, 0);
-                ctrl->current_order = next_order;
-                ctrl->current_row = 0;
-                break;
-            }
+    PatternSequencerState state;
+    pattern_sequencer_save_state(ctrl->sequencer, &state);
+    state.current_pattern_index = order;
+    state.current_row = row;
+    state.pattern_loop_row = 0;
+    state.pattern_loop_count = 0;
+    state.jump_pending = false;
+    pattern_sequencer_restore_state(ctrl->sequencer, &state);
+}
 
-            case RG_CMD_PREV_ORDER: {
-                uint16_t song_length = pattern_sequencer_get_song_length(ctrl->sequencer);
-                uint16_t prev_order = (ctrl->current_order == 0) ? (song_length - 1) : (ctrl->current_order - 1);
-                pattern_sequencer_set_position(ctrl->sequencer, prev_order, 0);
-                ctrl->current_order = prev_order;
-                ctrl->current_row = 0;
-                break;
-            }
+// Jump to the loop start and activate looping
+static void start_loop(RegrooveController* ctrl, bool at_row_start) {
+    command_jump(ctrl, ctrl->loop_start_order, ctrl->loop_start_row, at_row_start);
 
-            case RG_CMD_RETRIGGER_PATTERN:
-                pattern_sequencer_set_position(ctrl->sequencer, ctrl->current_order, 0);
-                ctrl->current_row = 0;
-                break;
+    RegrooveLoopState old_state = ctrl->loop_state;
+    ctrl->loop_state = RG_LOOP_ACTIVE;
 
-            case RG_CMD_TOGGLE_CHANNEL_MUTE:
-                if (cmd->param1 < MAX_CHANNELS) {
-                    ctrl->channel_muted[cmd->param1] = !ctrl->channel_muted[cmd->param1];
-                }
-                break;
+    if (ctrl->callbacks.on_loop_state_change) {
+        ctrl->callbacks.on_loop_state_change(ctrl->callback_user_data, old_state, RG_LOOP_ACTIVE);
+    }
+    if (ctrl->callbacks.on_loop_trigger) {
+        ctrl->callbacks.on_loop_trigger(ctrl->callback_user_data, ctrl->loop_start_order, ctrl->loop_start_row);
+    }
+}
 
-            case RG_CMD_SET_CHANNEL_SOLO:
-                if (cmd->param1 < MAX_CHANNELS) {
-                    ctrl->channel_solo[cmd->param1] = cmd->param2;
-                    // Update any_solo_active flag
-                    ctrl->any_solo_active = false;
-                    for (int ch = 0; ch < MAX_CHANNELS; ch++) {
-                        if (ctrl->channel_solo[ch]) {
-                            ctrl->any_solo_active = true;
-                            break;
-                        }
-                    }
-                }
-                break;
+static void execute_command(RegrooveController* ctrl, const QueuedCommand* cmd, bool at_row_start) {
+    // The order playing, or at a row start the one about to play
+    uint16_t order = ctrl->current_order;
+    if (at_row_start) {
+        uint16_t pattern, row;
+        pattern_sequencer_get_position(ctrl->sequencer, &order, &pattern, &row);
+    }
 
-            default:
-                break;
+    switch (cmd->type) {
+        case RG_CMD_JUMP_TO_ORDER:
+            command_jump(ctrl, cmd->param1, cmd->param2, at_row_start);
+            break;
+
+        case RG_CMD_NEXT_ORDER: {
+            uint16_t song_length = pattern_sequencer_get_song_length(ctrl->sequencer);
+            if (song_length == 0) break;
+            command_jump(ctrl, (order + 1) % song_length, 0, at_row_start);
+            break;
         }
 
-        // Callback for command execution
-        if (ctrl->callbacks.on_command_executed) {
-            ctrl->callbacks.on_command_executed(ctrl->callback_user_data, cmd->type);
+        case RG_CMD_PREV_ORDER: {
+            uint16_t song_length = pattern_sequencer_get_song_length(ctrl->sequencer);
+            if (song_length == 0) break;
+            command_jump(ctrl, (order == 0) ? (song_length - 1) : (order - 1), 0, at_row_start);
+            break;
         }
+
+        case RG_CMD_RETRIGGER_PATTERN:
+            command_jump(ctrl, order, 0, at_row_start);
+            break;
+
+        case RG_CMD_TOGGLE_CHANNEL_MUTE:
+            if (cmd->param1 < MAX_CHANNELS) {
+                ctrl->channel_muted[cmd->param1] = !ctrl->channel_muted[cmd->param1];
+            }
+            break;
+
+        case RG_CMD_SET_CHANNEL_SOLO:
+            if (cmd->param1 < MAX_CHANNELS) {
+                ctrl->channel_solo[cmd->param1] = cmd->param2;
+                // Update any_solo_active flag
+                ctrl->any_solo_active = false;
+                for (int ch = 0; ch < MAX_CHANNELS; ch++) {
+                    if (ctrl->channel_solo[ch]) {
+                        ctrl->any_solo_active = true;
+                        break;
+                    }
+                }
+            }
+            break;
+
+        case RG_CMD_TRIGGER_LOOP:
+            start_loop(ctrl, at_row_start);
+            break;
+
+        case RG_CMD_DISABLE_LOOP:
+            regroove_controller_disable_loop(ctrl);
+            break;
+
+        default:
+            break;
     }
 
-    // Clear queue
-    ctrl->queue_size = 0;
+    // Callback for command execution
+    if (ctrl->callbacks.on_command_executed) {
+        ctrl->callbacks.on_command_executed(ctrl->callback_user_data, cmd->type);
+    }
 }
 
 static void rg_on_row(void* user_data, uint16_t pattern_index, uint16_t pattern_number, uint16_t row) {
@@ -219,17 +287,6 @@ static void rg_on_row(void* user_data, uint16_t pattern_index, uint16_t pattern_
     ctrl->current_order = pattern_index;
     ctrl->current_row = row;
 
-    // Detect pattern boundary (order changed)
-    bool pattern_boundary = (pattern_index != ctrl->last_order);
-    if (pattern_boundary) {
-        ctrl->last_order = pattern_index;
-
-        // Execute queued commands on pattern boundary
-        if (ctrl->execute_on_pattern_boundary && ctrl->queue_size > 0) {
-            execute_queued_commands(ctrl);
-        }
-    }
-
     // Handle pattern mode
     if (ctrl->pattern_mode == RG_PATTERN_MODE_SINGLE) {
         // Lock to current pattern - check if we've moved to a different order
@@ -305,6 +362,210 @@ static bool rg_on_song_end(void* user_data) {
     return true;  // Default: continue looping
 }
 
+// ============================================================================
+// Command Scheduling
+// ============================================================================
+
+static void report_command(RegrooveController* ctrl, const QueuedCommand* cmd, uint64_t executed) {
+    uint32_t head = ctrl->report_head;
+    if (head - LOAD_ACQUIRE(ctrl->report_tail) >= MAX_COMMAND_REPORTS) return;  // Not polled
+
+    RegrooveCommandReport* report = &ctrl->reports[head % MAX_COMMAND_REPORTS];
+    report->id = cmd->id;
+    report->type = cmd->type;
+    report->submitted = cmd->submitted;
+    report->scheduled = cmd->scheduled;
+    report->executed = executed;
+    STORE_RELEASE(ctrl->report_head, head + 1);
+}
+
+// Sample time a musical target is expected at, from the current tempo
+static uint64_t estimate_target(const RegrooveController* ctrl, const QueuedCommand* cmd) {
+    PatternSequencer* seq = ctrl->sequencer;
+    uint32_t until_tick = pattern_sequencer_get_samples_until_tick(seq);
+    if (until_tick == UINT32_MAX) return RG_SAMPLE_TIME_NONE;
+
+    PatternSequencerState state;
+    pattern_sequencer_save_state(seq, &state);
+
+    // Up to the next row start, then whole rows
+    double samples = until_tick;
+    if (state.tick + 1 < state.speed) {
+        samples += (state.speed - 1 - state.tick) * state.samples_per_tick;
+    }
+
+    uint64_t rows = 0;
+    uint16_t row = state.current_row;
+    switch (cmd->quantize) {
+        case RG_QUANTIZE_ROWS:
+            rows = cmd->target > 1 ? cmd->target - 1 : 0;
+            break;
+        case RG_QUANTIZE_BEAT:
+            rows = (ctrl->rows_per_beat - row % ctrl->rows_per_beat) % ctrl->rows_per_beat;
+            break;
+        case RG_QUANTIZE_PATTERN:
+            if (row > 0) rows = pattern_sequencer_get_pattern_rows(seq, state.current_pattern_index) - row;
+            break;
+        default:
+            break;
+    }
+    samples += (double)rows * state.speed * state.samples_per_tick;
+
+    return ctrl->sample_time + (uint64_t)(samples + 0.5);
+}
+
+// Move commands from the queue to the pending list
+static void take_commands(RegrooveController* ctrl) {
+    QueuedCommand command;
+
+    while (ctrl->num_pending < MAX_PENDING_COMMANDS && mpsc_queue_pop(&ctrl->commands, &command)) {
+        if (command.id == 0) {
+            // Clear marker
+            for (uint8_t i = 0; i < ctrl->num_pending; i++) {
+                report_command(ctrl, &ctrl->pending[i], RG_SAMPLE_TIME_NONE);
+            }
+            ctrl->num_pending = 0;
+            continue;
+        }
+
+        switch (command.quantize) {
+            case RG_QUANTIZE_NOW:
+                command.scheduled = ctrl->sample_time;
+                break;
+            case RG_QUANTIZE_SAMPLE:
+                command.scheduled = command.target;
+                break;
+            default:
+                command.scheduled = estimate_target(ctrl, &command);
+                break;
+        }
+        ctrl->pending[ctrl->num_pending++] = command;
+    }
+}
+
+// Run the pending commands due at the current sample
+// A jump changes the row about to play, so after one the rest are checked
+// again against the new row (row counts only step once per row start).
+static void run_due_commands(RegrooveController* ctrl) {
+    bool first_pass = true;
+    bool executed = true;
+
+    while (executed && ctrl->num_pending > 0) {
+        // Musical targets are checked right before the tick that starts a row
+        bool row_start = pattern_sequencer_is_at_row_start(ctrl->sequencer);
+        bool beat = false;
+        bool pattern_boundary = false;
+        if (row_start) {
+            uint16_t order, pattern, row;
+            pattern_sequencer_get_position(ctrl->sequencer, &order, &pattern, &row);
+            beat = row % ctrl->rows_per_beat == 0;
+            pattern_boundary = row == 0 || order != ctrl->current_order;
+        }
+
+        uint8_t kept = 0;
+        executed = false;
+        for (uint8_t i = 0; i < ctrl->num_pending; i++) {
+            QueuedCommand* cmd = &ctrl->pending[i];
+            bool due;
+
+            switch (cmd->quantize) {
+                case RG_QUANTIZE_ROW:
+                    due = row_start;
+                    break;
+                case RG_QUANTIZE_ROWS:
+                    due = row_start && cmd->target <= 1;
+                    if (row_start && !due && first_pass) cmd->target--;
+                    break;
+                case RG_QUANTIZE_BEAT:
+                    due = beat;
+                    break;
+                case RG_QUANTIZE_PATTERN:
+                    due = pattern_boundary && ctrl->execute_on_pattern_boundary;
+                    break;
+                case RG_QUANTIZE_SAMPLE:
+                    due = cmd->target <= ctrl->sample_time;
+                    break;
+                default:
+                    due = true;
+                    break;
+            }
+
+            if (due) {
+                execute_command(ctrl, cmd, row_start);
+                report_command(ctrl, cmd, ctrl->sample_time);
+                executed = true;
+            } else {
+                ctrl->pending[kept++] = *cmd;
+            }
+        }
+        ctrl->num_pending = kept;
+        first_pass = false;
+    }
+}
+
+static uint64_t next_sample_target(const RegrooveController* ctrl) {
+    uint64_t next = UINT64_MAX;
+    for (uint8_t i = 0; i < ctrl->num_pending; i++) {
+        const QueuedCommand* cmd = &ctrl->pending[i];
+        if (cmd->quantize == RG_QUANTIZE_SAMPLE && cmd->target < next) next = cmd->target;
+    }
+    return next;
+}
+
+uint32_t regroove_controller_schedule(RegrooveController* controller,
+                                      RegrooveCommandType type,
+                                      uint16_t param1, uint16_t param2,
+                                      RegrooveQuantize quantize, uint64_t target) {
+    if (!controller) return 0;
+
+    QueuedCommand command = { 0 };
+    command.type = type;
+    command.param1 = param1;
+    command.param2 = param2;
+    command.quantize = quantize;
+    command.target = target;
+    command.submitted = LOAD_ACQUIRE(controller->sample_time);
+
+    // Id 0 marks a clear
+    command.id = __atomic_add_fetch(&controller->next_command_id, 1, __ATOMIC_RELAXED);
+    if (command.id == 0) command.id = __atomic_add_fetch(&controller->next_command_id, 1, __ATOMIC_RELAXED);
+
+    if (!mpsc_queue_push(&controller->commands, &command)) {
+        __atomic_add_fetch(&controller->dropped_commands, 1, __ATOMIC_RELAXED);
+        return 0;
+    }
+    return command.id;
+}
+
+bool regroove_controller_poll_report(RegrooveController* controller,
+                                     RegrooveCommandReport* report) {
+    if (!controller || !report) return false;
+
+    uint32_t tail = controller->report_tail;
+    if (tail == LOAD_ACQUIRE(controller->report_head)) return false;
+
+    *report = controller->reports[tail % MAX_COMMAND_REPORTS];
+    STORE_RELEASE(controller->report_tail, tail + 1);
+    return true;
+}
+
+uint64_t regroove_controller_get_sample_time(const RegrooveController* controller) {
+    return controller ? LOAD_ACQUIRE(controller->sample_time) : 0;
+}
+
+uint32_t regroove_controller_get_dropped_commands(const RegrooveController* controller) {
+    return controller ? __atomic_load_n(&controller->dropped_commands, __ATOMIC_RELAXED) : 0;
+}
+
+void regroove_controller_set_rows_per_beat(RegrooveController* controller, uint16_t rows) {
+    if (!controller || rows == 0) return;
+    controller->rows_per_beat = rows;
+}
+
+uint16_t regroove_controller_get_rows_per_beat(const RegrooveController* controller) {
+    return controller ? controller->rows_per_beat : DEFAULT_ROWS_PER_BEAT;
+}
+
 // ============================================================================
 // Process Function
 // ============================================================================
@@ -314,8 +575,26 @@ void regroove_controller_process(RegrooveController* controller,
                                 double sample_rate) {
     if (!controller || !controller->sequencer) return;
 
-    // Delegate to wrapped sequencer (our callbacks will be called)
-    pattern_sequencer_process(controller->sequencer, frames, sample_rate);
+    PatternSequencer* seq = controller->sequencer;
+
+    // Timing for the spans and row start checks below
+    pattern_sequencer_update_timing(seq, (uint32_t)sample_rate);
+    take_commands(controller);
+
+    // Step from tick to tick like pattern_sequencer_process() (our callbacks
+    // will be called), also stopping at commands due at a sample time
+    uint32_t done = 0;
+    while (done < frames) {
+        run_due_commands(controller);
+
+        uint32_t count = frames - done;
+        uint64_t next = next_sample_target(controller);
+        if (next - controller->sample_time < count) count = (uint32_t)(next - controller->sample_time);
+
+        count = pattern_sequencer_process_span(seq, count);
+        done += count;
+        STORE_RELEASE(controller->sample_time, controller->sample_time + count);
+    }
 }
 
 // ============================================================================
@@ -362,24 +641,7 @@ void regroove_controller_trigger_loop(RegrooveController* controller) {
     if (!controller) return;
 
     // Jump to loop start immediately
-    pattern_sequencer_set_position(controller->sequencer,
-                                   controller->loop_start_order,
-                                   controller->loop_start_row);
-    controller->current_order = controller->loop_start_order;
-    controller->current_row = controller->loop_start_row;
-
-    // Activate loop
-    RegrooveLoopState old_state = controller->loop_state;
-    controller->loop_state = RG_LOOP_ACTIVE;
-
-    if (controller->callbacks.on_loop_state_change) {
-        controller->callbacks.on_loop_state_change(controller->callback_user_data, old_state, RG_LOOP_ACTIVE);
-    }
-    if (controller->callbacks.on_loop_trigger) {
-        controller->callbacks.on_loop_trigger(controller->callback_user_data,
-                                             controller->loop_start_order,
-                                             controller->loop_start_row);
-    }
+    start_loop(controller, false);
 }
 
 void regroove_controller_disable_loop(RegrooveController* controller) {
@@ -403,12 +665,7 @@ RegrooveLoopState regroove_controller_get_loop_state(const RegrooveController* c
 
 static void queue_command(RegrooveController* controller, RegrooveCommandType type,
                          uint16_t param1, uint16_t param2) {
-    if (!controller || controller->queue_size >= MAX_QUEUED_COMMANDS) return;
-
-    QueuedCommand* cmd = &controller->command_queue[controller->queue_size++];
-    cmd->type = type;
-    cmd->param1 = param1;
-    cmd->param2 = param2;
+    regroove_controller_schedule(controller, type, param1, param2, RG_QUANTIZE_PATTERN, 0);
 }
 
 void regroove_controller_queue_jump(RegrooveController* controller,
@@ -439,7 +696,13 @@ void regroove_controller_jump_immediate(RegrooveController* controller,
 
 void regroove_controller_clear_queue(RegrooveController* controller) {
     if (!controller) return;
-    controller->queue_size = 0;
+
+    // Commands queued before the marker are dropped when process() takes it
+    QueuedCommand clear = { 0 };
+    clear.submitted = LOAD_ACQUIRE(controller->sample_time);
+    if (!mpsc_queue_push(&controller->commands, &clear)) {
+        __atomic_add_fetch(&controller->dropped_commands, 1, __ATOMIC_RELAXED);
+    }
 }
 
 // ============================================================================
@@ -548,11 +811,7 @@ uint16_t regroove_controller_get_song_length(const RegrooveController* controlle
 
 uint16_t regroove_controller_get_rows_per_pattern(const RegrooveController* controller, uint16_t order) {
     if (!controller || !controller->sequencer) return 0;
-    // PatternSequencer doesn't expose rows per pattern for individual orders
-    // This would need to be added or queried from the player
-    // For now, return the default rows_per_pattern
-    // TODO: Add API to pattern_sequencer to query this
-    return 64; // Default assumption
+    return pattern_sequencer_get_pattern_rows(controller->sequencer, order);
 }
 
 uint16_t regroove_controller_get_num_channels(const RegrooveController* controller) {
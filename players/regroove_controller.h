@@ -7,6 +7,8 @@
  * This layer wraps PatternSequencer to add advanced features like:
  * - Row-precise loop control with arming/triggering
  * - Command queuing (executes on pattern boundaries)
+ * - Sample-accurate command scheduling from any thread (next row, beat,
+ *   pattern or an absolute sample time), with timestamps reported back
  * - Pattern mode (loop single pattern)
  * - Channel mute/solo queuing
  * - Extended callbacks
@@ -58,9 +60,35 @@ typedef enum {
     RG_CMD_PREV_ORDER,           // Jump to previous order
     RG_CMD_RETRIGGER_PATTERN,    // Jump to start of current pattern
     RG_CMD_TOGGLE_CHANNEL_MUTE,  // Toggle channel mute
-    RG_CMD_SET_CHANNEL_SOLO      // Set channel solo
+    RG_CMD_SET_CHANNEL_SOLO,     // Set channel solo
+    RG_CMD_TRIGGER_LOOP,         // Jump to loop start and activate looping
+    RG_CMD_DISABLE_LOOP          // Stop looping
 } RegrooveCommandType;
 
+// When a scheduled command executes
+typedef enum {
+    RG_QUANTIZE_NOW = 0,         // First sample of the next process() call
+    RG_QUANTIZE_ROW,             // Next row start
+    RG_QUANTIZE_ROWS,            // Start of the Nth row from now (target = N)
+    RG_QUANTIZE_BEAT,            // Next row start on a beat (see set_rows_per_beat)
+    RG_QUANTIZE_PATTERN,         // First row of the next pattern
+    RG_QUANTIZE_SAMPLE           // Absolute sample time (target, see get_sample_time)
+} RegrooveQuantize;
+
+// Sample time of a command that never executed
+#define RG_SAMPLE_TIME_NONE UINT64_MAX
+
+// Timestamps of a scheduled command, in samples processed by the controller
+typedef struct {
+    uint32_t id;                 // As returned by regroove_controller_schedule()
+    RegrooveCommandType type;
+    uint64_t submitted;          // Sample time when it was queued
+    uint64_t scheduled;          // Sample time it was due at when process() took it
+                                 // (estimated from the tempo for musical targets,
+                                 // RG_SAMPLE_TIME_NONE while stopped)
+    uint64_t executed;           // Sample time it ran at (RG_SAMPLE_TIME_NONE if cleared)
+} RegrooveCommandReport;
+
 // Extended callbacks (in addition to PatternSequencer callbacks)
 typedef struct {
     // Called when loop state changes
@@ -110,6 +138,9 @@ void regroove_controller_set_callbacks(RegrooveController* controller,
 /**
  * Process timing and execute queued commands
  * This should be called instead of pattern_sequencer_process()
+ * Scheduled commands run at their exact sample: the block is split there,
+ * and commands due at a row start run right before the tick that plays the
+ * row (so a jump plays its target row at that sample).
  */
 void regroove_controller_process(RegrooveController* controller,
                                 uint32_t frames,
@@ -158,6 +189,54 @@ void regroove_controller_disable_loop(RegrooveController* controller);
  */
 RegrooveLoopState regroove_controller_get_loop_state(const RegrooveController* controller);
 
+// ============================================================================
+// Scheduled Commands
+// ============================================================================
+//
+// regroove_controller_schedule(), the queue_* functions and clear_queue()
+// may be called from any number of threads while another calls
+// regroove_controller_process(): they only push to a lock-free queue that
+// process() drains. Reports are polled from one thread. The other functions
+// act on the controller directly and belong on the audio thread.
+
+/**
+ * Schedule a command
+ * @param param1 Order for jumps, channel for mute/solo
+ * @param param2 Row for jumps, solo state for RG_CMD_SET_CHANNEL_SOLO
+ * @param target Rows for RG_QUANTIZE_ROWS, sample time for RG_QUANTIZE_SAMPLE
+ *               (a time already passed runs at the next process() call)
+ * @return Command id for the report, or 0 if the queue was full (the
+ *         command is dropped and counted)
+ */
+uint32_t regroove_controller_schedule(RegrooveController* controller,
+                                      RegrooveCommandType type,
+                                      uint16_t param1, uint16_t param2,
+                                      RegrooveQuantize quantize, uint64_t target);
+
+/**
+ * Take the next report of an executed (or cleared) command
+ * Returns false if there is none. Reports are dropped if they are not
+ * polled (the queue holds 64).
+ */
+bool regroove_controller_poll_report(RegrooveController* controller,
+                                     RegrooveCommandReport* report);
+
+/**
+ * Samples processed so far (the sample time process() is at)
+ */
+uint64_t regroove_controller_get_sample_time(const RegrooveController* controller);
+
+/**
+ * Commands dropped because the queue was full
+ */
+uint32_t regroove_controller_get_dropped_commands(const RegrooveController* controller);
+
+/**
+ * Rows per beat for RG_QUANTIZE_BEAT (default 4)
+ */
+void regroove_controller_set_rows_per_beat(RegrooveController* controller, uint16_t rows);
+uint16_t regroove_controller_get_rows_per_beat(const RegrooveController* controller);
+
 // ============================================================================
 // Queued Commands (execute on pattern boundary)
 // ============================================================================
@@ -190,7 +269,8 @@ void regroove_controller_jump_immediate(RegrooveController* controller,
                                        uint16_t order, uint16_t row);
 
 /**
- * Clear all queued commands
+ * Clear all queued commands (those not executed yet are reported with
+ * executed = RG_SAMPLE_TIME_NONE)
  */
 void regroove_controller_clear_queue(RegrooveController* controller);
 
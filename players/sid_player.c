@@ -6,12 +6,17 @@
 #include "sid_player.h"
 #include "../synth/synth_sid.h"
 #include "../common/cpu_6502.h"
+#include "../common/c64_timing.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <stdbool.h>
 #include <math.h>
 
+#ifdef SID_PLAYER_THREADS
+#include <pthread.h>
+#endif
+
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
@@ -27,9 +32,59 @@
 /* Memory size (64KB) */
 #define MEMORY_SIZE 0x10000
 
-/* Maximum number of CPU cycles per frame to prevent infinite loops */
+/* Maximum number of CPU cycles per init/play call to prevent infinite loops */
 #define MAX_CYCLES_PER_FRAME 100000
 
+/* While an IRQ is pending but masked (handler running), the CPU runs in
+ * slices this short so the IRQ is taken soon after CLI/RTI */
+#define IRQ_POLL_CYCLES 64
+
+/* Fake return address of init/play calls (RTS lands on $0000) */
+#define RETURN_TRAP 0x0000
+
+/* CPU clock (Hz), used to place register writes within a frame */
+#define PAL_CPU_CLOCK 985248.0
+#define NTSC_CPU_CLOCK 1022727.0
+
+/* Up to three SIDs (PSID v3 2SID, v4 3SID) */
+#define SID_MAX_CHIPS 3
+
+/* SID register write queue size per chip (power of two) */
+#define SID_WRITE_QUEUE_SIZE 2048
+
+/* The CPU stops running ahead when a queue has less room than this */
+#define SID_QUEUE_HEADROOM 512
+
+/* Longest CPU slice between queue checks (at most ~512 writes) */
+#define MAX_SLICE_CYCLES 2048
+
+/* Frames emulated ahead and then rendered per chip in one go */
+#define SID_MIX_BLOCK 4096
+
+/* Frames rendered per synth call (interleaved stereo scratch buffer) */
+#define SID_RENDER_CHUNK 256
+
+/* SID register write, timestamped with its absolute CPU cycle */
+typedef struct {
+    uint64_t cycle;
+    uint8_t reg;
+    uint8_t value;
+} SidWriteEvent;
+
+/* One SID chip: its synth, register file and write queue. A chip only
+ * touches its own state while rendering, so chips can render in parallel. */
+typedef struct {
+    SynthSID* synth;
+    uint16_t base;             /* $D400, or the address from the v3/v4 header */
+    float gain_left;           /* Stereo placement */
+    float gain_right;
+    uint8_t regs[32];          /* Register cache (reads, debug) */
+    SidWriteEvent queue[SID_WRITE_QUEUE_SIZE];
+    uint32_t queue_head;       /* Next event to apply */
+    uint32_t queue_tail;       /* Next free slot */
+    float out[SID_MIX_BLOCK];  /* Mono output of the current block */
+} SidChip;
+
 /* PSID file header structure */
 typedef struct {
     char magic[4];           /* 'PSID' or 'RSID' */
@@ -47,13 +102,15 @@ typedef struct {
     uint16_t flags;          /* Play flags (PSID v2+) */
     uint8_t start_page;      /* Relocation start page (PSID v2+) */
     uint8_t page_length;     /* Relocation page length (PSID v2+) */
-    uint16_t reserved;       /* Reserved */
+    uint8_t second_sid;      /* Second SID address $Dxx0 >> 4 (PSID v3+) */
+    uint8_t third_sid;       /* Third SID address $Dxx0 >> 4 (PSID v4+) */
 } __attribute__((packed)) PsidHeader;
 
 /* Player state */
 struct SidPlayer {
-    /* SID synthesizer */
-    SynthSID* synth;
+    /* SID chips */
+    SidChip chips[SID_MAX_CHIPS];
+    int num_chips;
 
     /* CPU and memory */
     CPU6502Context cpu_ctx;
@@ -72,11 +129,22 @@ struct SidPlayer {
     uint8_t start_song;
 
     /* Timing */
-    uint32_t speed_flags;      /* Speed bits for each song */
-    bool is_pal;               /* Current song PAL (50Hz) or NTSC (60Hz) */
-    double frame_counter;      /* Sample accumulator for timing */
+    uint32_t speed_flags;      /* Speed bits for each song (1 = CIA, 0 = VBI) */
+    bool is_pal;               /* PAL (985 kHz, 50Hz) or NTSC (1.02 MHz, 60Hz) machine */
+    bool use_cia;              /* Play calls follow CIA1 timer A instead of the VBI */
+    bool irq_driven;           /* No play address: the tune runs on real interrupts */
+    bool is_rsid;
+    uint8_t bank;              /* $01 value for init/play calls */
     uint32_t time_ms;          /* Playback time in milliseconds */
 
+    /* CIA/VIC interrupt sources, clocked by the CPU cycle counter */
+    C64Timing timing;
+    double audio_cycle;        /* CPU cycle at the current output sample */
+    uint64_t start_cycle;      /* CPU cycle at playback start */
+    bool in_play;              /* A play call has not returned yet */
+    uint64_t play_start;       /* CPU cycle of the current play call */
+    uint8_t play_sp;           /* Stack pointer before the play call */
+
     /* Playback state */
     bool playing;
     bool disable_looping;
@@ -87,8 +155,27 @@ struct SidPlayer {
     SidPositionCallback position_callback;
     void* callback_user_data;
 
-    /* SID register cache (for change detection) */
-    uint8_t sid_regs[32];
+    /* Register writes are queued per chip and applied at their cycle */
+    bool queue_writes;         /* Set while the CPU runs ahead of the audio */
+
+#ifdef SID_PLAYER_THREADS
+    /* Chips 1..n render on workers; chip 0 on the calling thread */
+    bool render_threads;       /* Requested by sid_player_set_render_threads() */
+    int num_workers;
+    pthread_t workers[SID_MAX_CHIPS];
+    pthread_mutex_t job_lock;
+    pthread_cond_t job_start;
+    pthread_cond_t job_done;
+    uint32_t job_id;           /* Incremented per block */
+    int jobs_pending;
+    bool workers_quit;
+    double job_cycle;          /* Block parameters */
+    size_t job_frames;
+    double job_cycles_per_sample;
+    int job_sample_rate;
+#endif
+
+    /* Gate tracking (for change detection) */
     uint8_t prev_gate[3];      /* Previous gate state for each voice */
     uint16_t base_frequency[3]; /* Base frequency when gate triggered (for pitch bend) */
 
@@ -116,12 +203,41 @@ static inline uint32_t read_be32(const uint8_t* data) {
 /* Forward declaration */
 static void handle_sid_voice_control(SidPlayer* player, uint8_t voice, uint8_t value);
 
+/* I/O is visible at $D000-$DFFF unless banked out through $01 */
+static inline bool io_visible(const SidPlayer* player) {
+    uint8_t port = player->memory[0x01];
+    return (port & 0x04) && (port & 0x03);
+}
+
+/* Chip decoding an address; a lone SID is mirrored through $D400-$D7FF */
+static inline int chip_at(const SidPlayer* player, uint16_t addr) {
+    if (player->num_chips == 1) {
+        return (addr >= SID_BASE && addr < 0xD800) ? 0 : -1;
+    }
+
+    uint16_t base = addr & 0xFFE0;
+    for (int c = 0; c < player->num_chips; c++) {
+        if (player->chips[c].base == base) return c;
+    }
+    return -1;
+}
+
 /* Memory access callbacks for CPU emulator */
 static uint8_t cpu_mem_read(void* userdata, uint16_t addr) {
     SidPlayer* player = (SidPlayer*)userdata;
+    if (!io_visible(player)) {
+        return player->memory[addr];
+    }
+
     /* SID registers (read mostly return 0 or noise) */
-    if (addr >= SID_BASE && addr < SID_BASE + 0x20) {
-        return player->sid_regs[addr - SID_BASE];
+    int chip = chip_at(player, addr);
+    if (chip >= 0) {
+        return player->chips[chip].regs[addr & 0x1F];
+    }
+
+    /* VIC raster and CIA timers */
+    if (addr < SID_BASE || addr >= 0xDC00) {
+        return c64_timing_read(&player->timing, addr, player->cpu_ctx.cycles);
     }
     return player->memory[addr];
 }
@@ -132,14 +248,36 @@ static uint8_t mem_read(SidPlayer* player, uint16_t addr) {
 }
 
 static void mem_write(SidPlayer* player, uint16_t addr, uint8_t value) {
-    /* SID register writes */
-    if (addr >= SID_BASE && addr < SID_BASE + 0x20) {
-        uint8_t reg = addr - SID_BASE;
-        player->sid_regs[reg] = value;
+    if (!io_visible(player)) {
+        player->memory[addr] = value;
+        return;
+    }
+
+    /* VIC raster and CIA timers */
+    if (addr < SID_BASE || addr >= 0xDC00) {
+        c64_timing_write(&player->timing, addr, value, player->cpu_ctx.cycles);
+        return;
+    }
 
-        /* Route to synth via hardware register interface */
-        if (player->synth) {
-            synth_sid_write_register(player->synth, reg, value);
+    /* SID register writes */
+    int chip_index = chip_at(player, addr);
+    if (chip_index >= 0) {
+        SidChip* chip = &player->chips[chip_index];
+        uint8_t reg = addr & 0x1F;
+        chip->regs[reg] = value;
+
+        /* Route to synth via hardware register interface. Writes made
+         * while the CPU runs ahead are queued and land at their sample
+         * position. */
+        if (player->queue_writes &&
+            chip->queue_tail - chip->queue_head < SID_WRITE_QUEUE_SIZE) {
+            SidWriteEvent* ev = &chip->queue[chip->queue_tail & (SID_WRITE_QUEUE_SIZE - 1)];
+            ev->cycle = player->cpu_ctx.cycles - 1;
+            ev->reg = reg;
+            ev->value = value;
+            chip->queue_tail++;
+        } else if (chip->synth) {
+            synth_sid_write_register(chip->synth, reg, value);
         }
 
         /* Debug output for SID register writes */
@@ -158,8 +296,10 @@ static void mem_write(SidPlayer* player, uint16_t addr, uint8_t value) {
                 uint32_t seconds = (time_ms / 1000) % 60;
                 uint32_t millis = time_ms % 1000;
 
-                fprintf(stderr, "[%02u:%02u.%03u] %10s = $%02X",
-                        minutes, seconds, millis, reg_names[reg], value);
+                fprintf(stderr, "[%02u:%02u.%03u] %s%10s = $%02X",
+                        minutes, seconds, millis,
+                        chip_index == 1 ? "SID2 " : (chip_index == 2 ? "SID3 " : ""),
+                        reg_names[reg], value);
 
                 /* Decode important registers */
                 if (reg == 4 || reg == 11 || reg == 18) {  /* Control registers */
@@ -178,7 +318,7 @@ static void mem_write(SidPlayer* player, uint16_t addr, uint8_t value) {
                     /* Show frequency for this voice */
                     uint8_t freq_lo = voice * 7;
                     uint8_t freq_hi = voice * 7 + 1;
-                    uint16_t freq = (player->sid_regs[freq_hi] << 8) | player->sid_regs[freq_lo];
+                    uint16_t freq = (chip->regs[freq_hi] << 8) | chip->regs[freq_lo];
                     if (freq > 0) {
                         float hz = freq * 0.0596f;
                         fprintf(stderr, " freq=%uHz", (uint32_t)hz);
@@ -221,14 +361,14 @@ static void handle_sid_voice_control(SidPlayer* player, uint8_t voice, uint8_t v
     if (waveform & 0x40) sid_waveform |= SID_WAVE_PULSE;
     if (waveform & 0x80) sid_waveform |= SID_WAVE_NOISE;
 
-    synth_sid_set_waveform(player->synth, voice, sid_waveform);
+    synth_sid_set_waveform(player->chips[0].synth, voice, sid_waveform);
 
     /* TEST bit (resets oscillator) */
-    synth_sid_set_test(player->synth, voice, (value & 0x08) != 0);
+    synth_sid_set_test(player->chips[0].synth, voice, (value & 0x08) != 0);
 
     /* Sync and ring modulation */
-    synth_sid_set_sync(player->synth, voice, (value & 0x02) != 0);
-    synth_sid_set_ring_mod(player->synth, voice, (value & 0x04) != 0);
+    synth_sid_set_sync(player->chips[0].synth, voice, (value & 0x02) != 0);
+    synth_sid_set_ring_mod(player->chips[0].synth, voice, (value & 0x04) != 0);
 
     /* Handle gate bit transitions */
     uint8_t new_gate = (value & 0x01);
@@ -237,14 +377,14 @@ static void handle_sid_voice_control(SidPlayer* player, uint8_t voice, uint8_t v
 
     if (new_gate && !old_gate) {
         /* Gate 0->1 transition: trigger note on */
-        uint16_t freq = (player->sid_regs[freq_hi_reg] << 8) | player->sid_regs[freq_lo_reg];
+        uint16_t freq = (player->chips[0].regs[freq_hi_reg] << 8) | player->chips[0].regs[freq_lo_reg];
 
         if (freq > 0) {
             /* Store base frequency for pitch bend calculations */
             player->base_frequency[voice] = freq;
 
             /* Reset pitch bend to 0 for new note */
-            synth_sid_set_pitch_bend(player->synth, voice, 0.0f);
+            synth_sid_set_pitch_bend(player->chips[0].synth, voice, 0.0f);
 
             /* Convert SID frequency to Hz */
             /* PAL C64: SID clock = 985248 Hz, formula: Hz = freq * clock / 16777216 */
@@ -257,13 +397,13 @@ static void handle_sid_voice_control(SidPlayer* player, uint8_t voice, uint8_t v
                 uint8_t note = (uint8_t)(note_f + 0.5f);  /* Round */
 
                 if (note > 0 && note < 128) {
-                    synth_sid_note_on(player->synth, voice, note, 100);
+                    synth_sid_note_on(player->chips[0].synth, voice, note, 100);
                 }
             }
         }
     } else if (!new_gate && old_gate) {
         /* Gate 1->0 transition: trigger note off */
-        synth_sid_note_off(player->synth, voice);
+        synth_sid_note_off(player->chips[0].synth, voice);
         /* Clear base frequency when note ends */
         player->base_frequency[voice] = 0;
     }
@@ -271,6 +411,171 @@ static void handle_sid_voice_control(SidPlayer* player, uint8_t voice, uint8_t v
 
 
 
+/* ============================================================================
+ * Chip Rendering
+ * ============================================================================ */
+
+/* Apply queued register writes */
+static void flush_writes(SidChip* chip, uint64_t up_to_cycle) {
+    while (chip->queue_head != chip->queue_tail) {
+        const SidWriteEvent* ev = &chip->queue[chip->queue_head & (SID_WRITE_QUEUE_SIZE - 1)];
+        if (ev->cycle > up_to_cycle) break;
+        synth_sid_write_register(chip->synth, ev->reg, ev->value);
+        chip->queue_head++;
+    }
+}
+
+/* Render one chip's block into chip->out, in spans that end at its queued
+ * register writes */
+static void render_chip(SidChip* chip, double start_cycle, size_t frames,
+                        double cycles_per_sample, int sample_rate) {
+    float stereo[SID_RENDER_CHUNK * 2];
+    double cycle = start_cycle;
+    size_t done = 0;
+
+    while (done < frames) {
+        flush_writes(chip, (uint64_t)cycle);
+
+        size_t span = frames - done;
+        if (span > SID_RENDER_CHUNK) span = SID_RENDER_CHUNK;
+        if (chip->queue_head != chip->queue_tail) {
+            const SidWriteEvent* ev = &chip->queue[chip->queue_head & (SID_WRITE_QUEUE_SIZE - 1)];
+            double until_event = ((double)ev->cycle - cycle) / cycles_per_sample;
+            size_t to_event = (until_event > 1.0) ? (size_t)ceil(until_event) : 1;
+            if (to_event < span) span = to_event;
+        }
+
+        synth_sid_process_f32(chip->synth, stereo, (int)span, sample_rate);
+
+        for (size_t i = 0; i < span; i++) {
+            chip->out[done + i] = stereo[i * 2];
+        }
+
+        done += span;
+        cycle += (double)span * cycles_per_sample;
+    }
+}
+
+#ifdef SID_PLAYER_THREADS
+typedef struct {
+    SidPlayer* player;
+    int chip;
+    uint32_t job_id;           /* Last job before the worker started */
+} SidWorkerArgs;
+
+/* Worker: renders one chip per block, woken by job_id changes */
+static void* chip_worker(void* arg) {
+    SidWorkerArgs args = *(SidWorkerArgs*)arg;
+    SidPlayer* player = args.player;
+    free(arg);
+
+    pthread_mutex_lock(&player->job_lock);
+    uint32_t seen = args.job_id;
+    for (;;) {
+        while (!player->workers_quit && player->job_id == seen) {
+            pthread_cond_wait(&player->job_start, &player->job_lock);
+        }
+        if (player->workers_quit) break;
+
+        seen = player->job_id;
+        double cycle = player->job_cycle;
+        size_t frames = player->job_frames;
+        double cycles_per_sample = player->job_cycles_per_sample;
+        int sample_rate = player->job_sample_rate;
+        pthread_mutex_unlock(&player->job_lock);
+
+        render_chip(&player->chips[args.chip], cycle, frames, cycles_per_sample, sample_rate);
+
+        pthread_mutex_lock(&player->job_lock);
+        if (--player->jobs_pending == 0) {
+            pthread_cond_signal(&player->job_done);
+        }
+    }
+    pthread_mutex_unlock(&player->job_lock);
+    return NULL;
+}
+
+static void stop_workers(SidPlayer* player) {
+    if (player->num_workers == 0) return;
+
+    pthread_mutex_lock(&player->job_lock);
+    player->workers_quit = true;
+    pthread_cond_broadcast(&player->job_start);
+    pthread_mutex_unlock(&player->job_lock);
+
+    for (int i = 0; i < player->num_workers; i++) {
+        pthread_join(player->workers[i], NULL);
+    }
+    player->num_workers = 0;
+}
+
+/* One worker per chip beyond the first */
+static bool start_workers(SidPlayer* player) {
+    player->workers_quit = false;
+    player->jobs_pending = 0;
+
+    for (int c = 1; c < player->num_chips; c++) {
+        SidWorkerArgs* args = (SidWorkerArgs*)malloc(sizeof(SidWorkerArgs));
+        if (!args) break;
+        args->player = player;
+        args->chip = c;
+        args->job_id = player->job_id;
+        if (pthread_create(&player->workers[player->num_workers], NULL, chip_worker, args) != 0) {
+            free(args);
+            break;
+        }
+        player->num_workers++;
+    }
+
+    if (player->num_workers != player->num_chips - 1) {
+        /* Partial start: render serially instead */
+        stop_workers(player);
+        return false;
+    }
+    return true;
+}
+#endif
+
+/* Render all chips for one block */
+static void render_chips(SidPlayer* player, double start_cycle, size_t frames,
+                         double cycles_per_sample, int sample_rate) {
+#ifdef SID_PLAYER_THREADS
+    if (player->render_threads && player->num_chips > 1) {
+        if (player->num_workers != player->num_chips - 1) {
+            stop_workers(player);
+            if (!start_workers(player)) {
+                player->render_threads = false;
+            }
+        }
+    }
+
+    if (player->render_threads && player->num_workers > 0) {
+        pthread_mutex_lock(&player->job_lock);
+        player->job_cycle = start_cycle;
+        player->job_frames = frames;
+        player->job_cycles_per_sample = cycles_per_sample;
+        player->job_sample_rate = sample_rate;
+        player->jobs_pending = player->num_workers;
+        player->job_id++;
+        pthread_cond_broadcast(&player->job_start);
+        pthread_mutex_unlock(&player->job_lock);
+
+        render_chip(&player->chips[0], start_cycle, frames, cycles_per_sample, sample_rate);
+
+        pthread_mutex_lock(&player->job_lock);
+        while (player->jobs_pending > 0) {
+            pthread_cond_wait(&player->job_done, &player->job_lock);
+        }
+        pthread_mutex_unlock(&player->job_lock);
+        return;
+    }
+#endif
+
+    for (int c = 0; c < player->num_chips; c++) {
+        render_chip(&player->chips[c], start_cycle, frames, cycles_per_sample, sample_rate);
+    }
+}
+
 /* ============================================================================
  * Lifecycle
  * ============================================================================ */
@@ -279,15 +584,37 @@ SidPlayer* sid_player_create(void) {
     SidPlayer* player = (SidPlayer*)calloc(1, sizeof(SidPlayer));
     if (!player) return NULL;
 
-    player->synth = synth_sid_create(48000);
-    if (!player->synth) {
+    player->chips[0].synth = synth_sid_create(48000);
+    if (!player->chips[0].synth) {
         free(player);
         return NULL;
     }
+    player->chips[0].base = SID_BASE;
+    player->chips[0].gain_left = player->chips[0].gain_right = 1.0f;
+    player->num_chips = 1;
+
+#ifdef SID_PLAYER_THREADS
+    pthread_mutex_init(&player->job_lock, NULL);
+    pthread_cond_init(&player->job_start, NULL);
+    pthread_cond_init(&player->job_done, NULL);
+#endif
 
     /* Initialize CPU emulator with memory callbacks */
     cpu_init(&player->cpu_ctx, player, cpu_mem_read, cpu_mem_write);
 
+    /* RAM is accessed directly; only the VIC, SID ($D400-$D7FF and
+     * $DE00-$DFFF for extra chips) and CIA pages go through callbacks */
+    cpu_set_memory(&player->cpu_ctx, player->memory);
+    for (int page = 0xD0; page <= 0xD7; page++) {
+        cpu_set_io_page(&player->cpu_ctx, (uint8_t)page, true);
+    }
+    for (int page = 0xDC; page <= 0xDF; page++) {
+        cpu_set_io_page(&player->cpu_ctx, (uint8_t)page, true);
+    }
+
+    /* Init and play routines return to the fake address $FFFF + 1 */
+    cpu_set_trap(&player->cpu_ctx, RETURN_TRAP);
+
     player->boost = 1.0f;
     player->is_pal = true;  /* Default to PAL */
 
@@ -297,8 +624,17 @@ SidPlayer* sid_player_create(void) {
 void sid_player_destroy(SidPlayer* player) {
     if (!player) return;
 
-    if (player->synth) {
-        synth_sid_destroy(player->synth);
+#ifdef SID_PLAYER_THREADS
+    stop_workers(player);
+    pthread_cond_destroy(&player->job_start);
+    pthread_cond_destroy(&player->job_done);
+    pthread_mutex_destroy(&player->job_lock);
+#endif
+
+    for (int c = 0; c < SID_MAX_CHIPS; c++) {
+        if (player->chips[c].synth) {
+            synth_sid_destroy(player->chips[c].synth);
+        }
     }
 
     free(player);
@@ -314,6 +650,47 @@ bool sid_player_detect(const uint8_t* data, size_t size) {
     return (memcmp(data, "PSID", 4) == 0 || memcmp(data, "RSID", 4) == 0);
 }
 
+/* Decode a v3/v4 extra SID address byte; 0 if absent or invalid */
+static uint16_t extra_sid_address(uint8_t value) {
+    /* Even values in $42-$7F ($D420-$D7E0) or $E0-$FE ($DE00-$DFE0) */
+    if (value & 0x01) return 0;
+    if ((value >= 0x42 && value <= 0x7E) || (value >= 0xE0 && value <= 0xFE)) {
+        return (uint16_t)(0xD000 | (value << 4));
+    }
+    return 0;
+}
+
+/* Configure chips 1 and 2 and their stereo placement (left to right) */
+static void setup_chips(SidPlayer* player, uint16_t second, uint16_t third) {
+    uint16_t bases[SID_MAX_CHIPS] = { SID_BASE, second, third };
+    int count = 1;
+
+    for (int c = 1; c < SID_MAX_CHIPS; c++) {
+        if (bases[c] == 0 || bases[c] == SID_BASE) continue;
+
+        SidChip* chip = &player->chips[count];
+        if (!chip->synth) {
+            chip->synth = synth_sid_create(48000);
+            if (!chip->synth) break;
+        }
+        chip->base = bases[c];
+        count++;
+    }
+    player->num_chips = count;
+
+    /* Pan positions 0..1, gains normalised so a centred chip is full scale */
+    static const float pans[SID_MAX_CHIPS][SID_MAX_CHIPS] = {
+        { 0.5f },
+        { 0.25f, 0.75f },
+        { 0.25f, 0.5f, 0.75f }
+    };
+    for (int c = 0; c < count; c++) {
+        float pan = pans[count - 1][c];
+        player->chips[c].gain_left = fminf(1.0f, 2.0f * (1.0f - pan));
+        player->chips[c].gain_right = fminf(1.0f, 2.0f * pan);
+    }
+}
+
 bool sid_player_load(SidPlayer* player, const uint8_t* data, size_t size) {
     if (!player || !data || size < sizeof(PsidHeader)) {
         return false;
@@ -333,6 +710,9 @@ bool sid_player_load(SidPlayer* player, const uint8_t* data, size_t size) {
     uint16_t num_songs = read_be16((const uint8_t*)&hdr->songs);
     uint16_t start_song = read_be16((const uint8_t*)&hdr->start_song);
     uint32_t speed = read_be32((const uint8_t*)&hdr->speed);
+    uint16_t flags = version >= 2 ? read_be16((const uint8_t*)&hdr->flags) : 0;
+    uint16_t second_sid = version >= 3 ? extra_sid_address(hdr->second_sid) : 0;
+    uint16_t third_sid = version >= 4 ? extra_sid_address(hdr->third_sid) : 0;
 
     /* Copy song info */
     memcpy(player->title, hdr->name, 32);
@@ -371,27 +751,43 @@ bool sid_player_load(SidPlayer* player, const uint8_t* data, size_t size) {
     player->num_songs = num_songs > 0 ? num_songs : 1;
     player->start_song = start_song > 0 ? start_song - 1 : 0;  /* Convert to 0-based */
     player->current_song = player->start_song;
-    player->speed_flags = speed;
-
-    /* Determine if current song is PAL or NTSC
-     * Speed flag convention:
-     * - Bit set (1) = PAL (50Hz) - European C64
-     * - Bit clear (0) = NTSC (60Hz) - American C64
-     * - All bits 0 = Unspecified, default to PAL (most common)
-     */
-    if (speed == 0) {
-        /* No speed specified - default to PAL (most C64 games are European) */
-        player->is_pal = true;
+    setup_chips(player, second_sid, third_sid);
+
+    player->is_rsid = memcmp(hdr->magic, "RSID", 4) == 0;
+    player->speed_flags = player->is_rsid ? 0 : speed;
+    player->irq_driven = player->is_rsid || play_addr == 0;
+
+    /* Video standard from the v2 flags (bits 2-3: 01 = PAL, 10 = NTSC,
+     * 11 = either); unknown defaults to PAL (most tunes are European) */
+    player->is_pal = ((flags >> 2) & 0x03) != 0x02;
+
+    /* Speed bit per song: 0 = vertical blank, 1 = CIA1 timer A */
+    uint8_t bit = player->current_song < 31 ? player->current_song : 31;
+    player->use_cia = (player->speed_flags >> bit) & 1;
+
+    /* $01 for init/play: KERNAL ROM is banked out when the tune needs
+     * the RAM below it */
+    uint16_t highest = load_addr + song_size > 0 ? (uint16_t)(load_addr + song_size - 1) : 0;
+    if (highest >= 0xE000 || init_addr >= 0xE000 || play_addr >= 0xE000) {
+        player->bank = 0x35;
+    } else if (highest >= 0xA000 || init_addr >= 0xA000 || play_addr >= 0xA000) {
+        player->bank = 0x36;
     } else {
-        /* Check bit for this subsong */
-        player->is_pal = (speed & (1 << player->current_song)) != 0;
+        player->bank = 0x37;
     }
 
     /* Debug output for timing mode */
-    fprintf(stderr, "SID Timing: %s (speed flag: 0x%08X, subsong: %d)%s\n",
-            player->is_pal ? "PAL (50Hz)" : "NTSC (60Hz)",
-            speed, player->current_song,
-            speed == 0 ? " [defaulted to PAL]" : "");
+    fprintf(stderr, "SID Timing: %s, %s (speed flag: 0x%08X, subsong: %d)\n",
+            player->is_pal ? "PAL" : "NTSC",
+            player->irq_driven ? "IRQ-driven" : (player->use_cia ? "CIA timer" : "VBI"),
+            speed, player->current_song);
+    if (player->num_chips > 1) {
+        fprintf(stderr, "SID Chips: %d ($D400", player->num_chips);
+        for (int c = 1; c < player->num_chips; c++) {
+            fprintf(stderr, ", $%04X", player->chips[c].base);
+        }
+        fprintf(stderr, ")\n");
+    }
 
     /* Initialize gate tracking */
     memset(player->prev_gate, 0, sizeof(player->prev_gate));
@@ -403,6 +799,56 @@ bool sid_player_load(SidPlayer* player, const uint8_t* data, size_t size) {
  * Playback Control
  * ============================================================================ */
 
+/* True if the loaded tune does not occupy [start, end] */
+static bool range_free(const SidPlayer* player, uint16_t start, uint16_t end) {
+    return end < player->load_address || start >= player->load_end;
+}
+
+static void poke_bytes(SidPlayer* player, uint16_t addr, const uint8_t* bytes, size_t count) {
+    memcpy(player->memory + addr, bytes, count);
+}
+
+/* Minimal KERNAL interrupt path where the tune leaves room for it:
+ * hardware vectors, the register-saving IRQ entry that jumps through
+ * $0314, and the $EA31/$EA81 exits that acknowledge CIA1 and RTI. */
+static void install_kernal_stubs(SidPlayer* player) {
+    static const uint8_t irq_entry[] = { 0x48, 0x8A, 0x48, 0x98, 0x48, 0x6C, 0x14, 0x03 };
+    static const uint8_t irq_exit[] = { 0xAD, 0x0D, 0xDC, 0x68, 0xA8, 0x68, 0xAA, 0x68, 0x40 };
+    static const uint8_t nmi_entry[] = { 0x78, 0x6C, 0x18, 0x03, 0x40 };
+    static const uint8_t jmp_exit[] = { 0x4C, 0x7E, 0xEA };
+
+    if (range_free(player, 0xEA31, 0xEA89)) {
+        poke_bytes(player, 0xEA31, jmp_exit, sizeof(jmp_exit));   /* $EA31: JMP $EA7E */
+        poke_bytes(player, 0xEA7E, irq_exit, sizeof(irq_exit));   /* LDA $DC0D, PLA... RTI */
+    }
+    if (range_free(player, 0xFE43, 0xFE47)) {
+        poke_bytes(player, 0xFE43, nmi_entry, sizeof(nmi_entry)); /* SEI, JMP ($0318); $FE47: RTI */
+    }
+    if (range_free(player, 0xFF48, 0xFF4F)) {
+        poke_bytes(player, 0xFF48, irq_entry, sizeof(irq_entry)); /* PHA TXA PHA TYA PHA JMP ($0314) */
+    }
+    if (range_free(player, 0xFFFA, 0xFFFF)) {
+        static const uint8_t vectors[] = { 0x43, 0xFE, 0x00, 0x00, 0x48, 0xFF };
+        poke_bytes(player, 0xFFFA, vectors, sizeof(vectors));
+    }
+    if (range_free(player, 0x0314, 0x0319)) {
+        static const uint8_t soft_vectors[] = { 0x31, 0xEA, 0x66, 0xFE, 0x47, 0xFE };
+        poke_bytes(player, 0x0314, soft_vectors, sizeof(soft_vectors));
+    }
+    if (range_free(player, 0x0000, 0x0001)) {
+        player->memory[0x00] = 0x2F;
+        player->memory[0x01] = player->bank;
+    }
+}
+
+/* JSR to a routine that returns to the trap address */
+static void call_routine(SidPlayer* player, uint16_t addr) {
+    uint16_t ret = (uint16_t)(RETURN_TRAP - 1);
+    cpu_push(&player->cpu_ctx, (uint8_t)(ret >> 8));
+    cpu_push(&player->cpu_ctx, (uint8_t)(ret & 0xFF));
+    player->cpu_ctx.cpu.pc = addr;
+}
+
 void sid_player_start(SidPlayer* player) {
     if (!player || player->playing) return;
 
@@ -412,28 +858,36 @@ void sid_player_start(SidPlayer* player) {
             player->init_address, player->play_address, player->current_song);
     #endif
 
-    /* Reset CPU */
+    /* Reset CPU and the interrupt sources */
     cpu_reset(&player->cpu_ctx);
+    player->cpu_ctx.cycles = 0;
+    c64_timing_reset(&player->timing, player->is_pal, 0);
+    install_kernal_stubs(player);
+
+    /* Reset SID chip; init writes go straight to it. Oscillators run at a
+     * fraction of the machine clock and are decimated to the output rate. */
+    for (int c = 0; c < player->num_chips; c++) {
+        SidChip* chip = &player->chips[c];
+        synth_sid_reset(chip->synth);
+        synth_sid_set_chip_clock(chip->synth, player->is_pal ? SYNTH_SID_CLOCK_PAL
+                                                             : SYNTH_SID_CLOCK_NTSC);
+        memset(chip->regs, 0, sizeof(chip->regs));
+        chip->queue_head = chip->queue_tail = 0;
+    }
+    player->queue_writes = false;
+    memset(player->prev_gate, 0, sizeof(player->prev_gate));
 
     /* Call init routine */
-    /* Setup for JSR to init routine */
-    player->cpu_ctx.cpu.pc = player->init_address;
     player->cpu_ctx.cpu.a = player->current_song;
+    call_routine(player, player->init_address);
 
-    /* Execute init routine (with cycle limit) */
+    /* Run until RTS, a JMP-to-self main loop or the cycle limit */
     int total_cycles = 0;
-    /* Push fake return address */
-    cpu_push(&player->cpu_ctx, 0xFF);
-    cpu_push(&player->cpu_ctx, 0xFF);
-
-    /* Run until RTS or cycle limit */
     while (total_cycles < MAX_CYCLES_PER_FRAME) {
         uint16_t pc_before = player->cpu_ctx.cpu.pc;
-        int cycles = cpu_step(&player->cpu_ctx);
-        total_cycles += cycles;
+        total_cycles += cpu_step(&player->cpu_ctx);
 
-        /* Check if returned (RTS to 0xFFFF will wrap) */
-        if (player->cpu_ctx.cpu.pc == 0x0000 || player->cpu_ctx.cpu.pc == 0xFFFF) {
+        if (player->cpu_ctx.cpu.pc == RETURN_TRAP || player->cpu_ctx.jammed) {
             break;
         }
 
@@ -447,38 +901,36 @@ void sid_player_start(SidPlayer* player) {
         fprintf(stderr, "Warning: Init hit cycle limit\n");
     }
 
-    player->playing = true;
-    player->frame_counter = 0;
-    player->time_ms = 0;
-
-    /* Reset SID chip */
-    synth_sid_reset(player->synth);
-    memset(player->sid_regs, 0, sizeof(player->sid_regs));
-    memset(player->prev_gate, 0, sizeof(player->prev_gate));
-
-    /* If play address is 0, check for IRQ vector */
-    if (player->play_address == 0) {
-        /* Check CIA1 IRQ vector at $0314/$0315 or $FFFE/$FFFF */
-        uint16_t irq_vector = player->memory[0x0314] | (player->memory[0x0315] << 8);
-        if (irq_vector != 0 && irq_vector >= player->load_address && irq_vector < player->load_end) {
-            player->play_address = irq_vector;
-        } else {
-            /* Try hardware IRQ vector */
-            irq_vector = player->memory[0xFFFE] | (player->memory[0xFFFF] << 8);
-            if (irq_vector != 0 && irq_vector >= player->load_address && irq_vector < player->load_end) {
-                player->play_address = irq_vector;
-            } else {
-                fprintf(stderr, "WARNING: No valid play address found!\n");
-            }
+    if (player->irq_driven) {
+        /* Whatever init left running is the main loop; interrupts on */
+        player->cpu_ctx.cpu.flag_i = 0;
+    } else {
+        /* The play driver idles at the trap between calls */
+        player->cpu_ctx.cpu.pc = RETURN_TRAP;
+        player->cpu_ctx.cpu.flag_i = 1;
+
+        /* CIA-timed tunes play at the rate init programmed into timer A;
+         * restart it if init stopped it */
+        if (player->use_cia) {
+            c64_timing_start_timer_a(&player->timing, 0, player->cpu_ctx.cycles);
         }
     }
+    player->cpu_ctx.jammed = false;
+    player->in_play = false;
+
+    player->start_cycle = player->cpu_ctx.cycles;
+    player->audio_cycle = (double)player->cpu_ctx.cycles;
+    player->time_ms = 0;
+    player->playing = true;
 }
 
 void sid_player_stop(SidPlayer* player) {
     if (!player) return;
 
     player->playing = false;
-    synth_sid_all_notes_off(player->synth);
+    for (int c = 0; c < player->num_chips; c++) {
+        synth_sid_all_notes_off(player->chips[c].synth);
+    }
 }
 
 bool sid_player_is_playing(const SidPlayer* player) {
@@ -498,7 +950,7 @@ void sid_player_set_subsong(SidPlayer* player, uint8_t subsong) {
     }
 
     player->current_song = subsong;
-    player->is_pal = (player->speed_flags & (1 << subsong)) != 0;
+    player->use_cia = (player->speed_flags >> (subsong < 31 ? subsong : 31)) & 1;
 
     if (was_playing) {
         sid_player_start(player);
@@ -525,6 +977,10 @@ const char* sid_player_get_copyright(const SidPlayer* player) {
     return player ? player->copyright : NULL;
 }
 
+int sid_player_get_num_chips(const SidPlayer* player) {
+    return player ? player->num_chips : 0;
+}
+
 /* ============================================================================
  * Playback Position
  * ============================================================================ */
@@ -554,6 +1010,112 @@ void sid_player_process(SidPlayer* player,
     sid_player_process_voices(player, left, right, NULL, num_samples, sample_rate);
 }
 
+/* PSID driver: JSR to the play routine unless the last call is still running */
+static void start_play_call(SidPlayer* player) {
+    if (player->in_play) return;
+
+    player->memory[0x01] = player->bank;
+    player->play_sp = player->cpu_ctx.cpu.sp;
+    player->play_start = player->cpu_ctx.cycles;
+    player->in_play = true;
+    call_routine(player, player->play_address);
+}
+
+/* Called once per video frame */
+static void frame_tick(SidPlayer* player) {
+    player->time_ms = (uint32_t)((double)(player->cpu_ctx.cycles - player->start_cycle) * 1000.0 /
+                                 (player->is_pal ? PAL_CPU_CLOCK : NTSC_CPU_CLOCK));
+
+    if (player->position_callback) {
+        player->position_callback(player->current_song,
+                                 player->time_ms,
+                                 player->callback_user_data);
+    }
+}
+
+/* The CPU has nothing to do until the next interrupt: it sits at the
+ * return trap or in a JMP-to-self main loop */
+static bool cpu_idle(const SidPlayer* player) {
+    uint16_t pc = player->cpu_ctx.cpu.pc;
+    if (pc == RETURN_TRAP || player->cpu_ctx.jammed) return true;
+
+    const uint8_t* m = player->memory;
+    return m[pc] == 0x4C && m[(uint16_t)(pc + 1)] == (pc & 0xFF) && m[(uint16_t)(pc + 2)] == (pc >> 8);
+}
+
+/* A write queue is close to full: the CPU must wait for the audio */
+static bool queues_full(const SidPlayer* player) {
+    for (int c = 0; c < player->num_chips; c++) {
+        const SidChip* chip = &player->chips[c];
+        if (chip->queue_tail - chip->queue_head > SID_WRITE_QUEUE_SIZE - SID_QUEUE_HEADROOM) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Run the machine up to a cycle. The CPU only runs until the next timer
+ * or raster event, then interrupts are delivered; idle stretches are
+ * skipped outright, so cost scales with the number of events, not cycles.
+ * SID writes are queued with their cycle. Stops early if a queue fills. */
+static void run_until(SidPlayer* player, uint64_t target) {
+    CPU6502Context* ctx = &player->cpu_ctx;
+
+    player->queue_writes = true;
+    while (ctx->cycles < target && !queues_full(player)) {
+        uint32_t events = c64_timing_advance(&player->timing, ctx->cycles);
+
+        if (events & C64_EVENT_FRAME) {
+            frame_tick(player);
+        }
+
+        if (player->irq_driven) {
+            if (c64_timing_take_nmi(&player->timing)) {
+                cpu_nmi(ctx);
+            }
+            if (c64_timing_irq(&player->timing)) {
+                cpu_irq(ctx);
+            }
+        } else if (events & (player->use_cia ? C64_EVENT_CIA1_TA : C64_EVENT_FRAME)) {
+            start_play_call(player);
+        }
+
+        uint64_t next = c64_timing_next_event(&player->timing);
+        if (next > target) next = target;
+        if (next <= ctx->cycles) continue;
+
+        if (cpu_idle(player)) {
+            ctx->cycles = next;
+            continue;
+        }
+
+        if (next - ctx->cycles > MAX_SLICE_CYCLES) {
+            next = ctx->cycles + MAX_SLICE_CYCLES;
+        }
+
+        /* IRQ held off by the I flag: check again soon */
+        if (player->irq_driven && c64_timing_irq(&player->timing) &&
+            next - ctx->cycles > IRQ_POLL_CYCLES) {
+            next = ctx->cycles + IRQ_POLL_CYCLES;
+        }
+
+        cpu_run(ctx, (int)(next - ctx->cycles));
+
+        if (player->in_play) {
+            if (ctx->cpu.pc == RETURN_TRAP) {
+                player->in_play = false;
+            } else if (ctx->jammed || ctx->cycles - player->play_start > MAX_CYCLES_PER_FRAME) {
+                /* Runaway play routine: abandon the call */
+                ctx->cpu.pc = RETURN_TRAP;
+                ctx->cpu.sp = player->play_sp;
+                ctx->jammed = false;
+                player->in_play = false;
+            }
+        }
+    }
+    player->queue_writes = false;
+}
+
 void sid_player_process_voices(SidPlayer* player,
                                float* left,
                                float* right,
@@ -578,64 +1140,37 @@ void sid_player_process_voices(SidPlayer* player,
         return;
     }
 
-    /* Calculate frame rate (PAL = 50Hz, NTSC = 60Hz) */
-    double frame_rate = player->is_pal ? 50.0 : 60.0;
-    double samples_per_frame = sample_rate / frame_rate;
-
-    for (size_t i = 0; i < num_samples; i++) {
-        /* Call play routine at frame rate */
-        if (player->frame_counter >= samples_per_frame) {
-            player->frame_counter -= samples_per_frame;
-
-            /* Setup CPU for play routine call */
-            player->cpu_ctx.cpu.pc = player->play_address;
-
-            /* Push fake return address */
-            uint8_t saved_sp = player->cpu_ctx.cpu.sp;
-            cpu_push(&player->cpu_ctx, 0xFF);
-            cpu_push(&player->cpu_ctx, 0xFF);
-
-            /* Execute play routine */
-            int total_cycles = 0;
-            while (total_cycles < MAX_CYCLES_PER_FRAME) {
-                int cycles = cpu_step(&player->cpu_ctx);
-                total_cycles += cycles;
-
-                /* Check if returned */
-                if (player->cpu_ctx.cpu.pc == 0x0000 || player->cpu_ctx.cpu.pc == 0xFFFF) {
-                    break;
-                }
-
-                /* Restore SP if it looks stuck */
-                if (player->cpu_ctx.cpu.sp < saved_sp - 10) {
-                    player->cpu_ctx.cpu.sp = saved_sp;
-                    break;
-                }
-            }
+    double cycles_per_sample = (player->is_pal ? PAL_CPU_CLOCK : NTSC_CPU_CLOCK) / sample_rate;
+    size_t pos = 0;
+
+    while (pos < num_samples) {
+        size_t frames = num_samples - pos;
+        if (frames > SID_MIX_BLOCK) frames = SID_MIX_BLOCK;
+
+        /* Emulate up to the end of the block; if the write queues filled
+         * first, render only as far as the CPU got */
+        uint64_t target = (uint64_t)(player->audio_cycle + (double)frames * cycles_per_sample);
+        run_until(player, target);
+        if (player->cpu_ctx.cycles < target) {
+            double reached = ((double)player->cpu_ctx.cycles - player->audio_cycle) / cycles_per_sample;
+            size_t reached_frames = reached > 1.0 ? (size_t)reached : 1;
+            if (reached_frames < frames) frames = reached_frames;
+        }
 
-            /* Update time */
-            player->time_ms += (uint32_t)(1000.0 / frame_rate);
+        render_chips(player, player->audio_cycle, frames, cycles_per_sample, sample_rate);
 
-            /* Call position callback */
-            if (player->position_callback) {
-                player->position_callback(player->current_song,
-                                         player->time_ms,
-                                         player->callback_user_data);
+        for (int c = 0; c < player->num_chips; c++) {
+            const SidChip* chip = &player->chips[c];
+            float gain_left = chip->gain_left * player->boost;
+            float gain_right = chip->gain_right * player->boost;
+            for (size_t i = 0; i < frames; i++) {
+                left[pos + i] += chip->out[i] * gain_left;
+                right[pos + i] += chip->out[i] * gain_right;
             }
         }
 
-        /* Increment sample accumulator AFTER frame processing */
-        player->frame_counter += 1.0;
-
-        /* Generate one sample from SID chip */
-        float stereo[2];
-        synth_sid_process_f32(player->synth, stereo, 1, sample_rate);
-
-        /* Apply voice muting */
-        float sample = stereo[0] * player->boost;
-
-        left[i] = sample;
-        right[i] = sample;
+        player->audio_cycle += (double)frames * cycles_per_sample;
+        pos += frames;
     }
 }
 
@@ -673,6 +1208,21 @@ bool sid_player_is_pal(const SidPlayer* player) {
     return player->is_pal;
 }
 
+bool sid_player_set_render_threads(SidPlayer* player, bool enable) {
+    if (!player) return false;
+
+#ifdef SID_PLAYER_THREADS
+    player->render_threads = enable;
+    if (!enable) {
+        stop_workers(player);
+    }
+    return true;
+#else
+    (void)enable;
+    return false;
+#endif
+}
+
 void sid_player_set_debug_output(SidPlayer* player, bool enabled) {
     if (!player) return;
     player->debug_enabled = enabled;
@@ -686,6 +1236,8 @@ void sid_player_set_debug_output(SidPlayer* player, bool enabled) {
 void sid_player_print_state(SidPlayer* player) {
     if (!player) return;
 
+    const uint8_t* regs = player->chips[0].regs;
+
     uint32_t time_ms = player->time_ms;
     uint32_t minutes = time_ms / 60000;
     uint32_t seconds = (time_ms / 1000) % 60;
@@ -700,11 +1252,11 @@ void sid_player_print_state(SidPlayer* player) {
         fprintf(stderr, "VOICE %d:\n", voice + 1);
 
         uint8_t base = voice * 7;
-        uint16_t freq = (player->sid_regs[base + 1] << 8) | player->sid_regs[base];
-        uint16_t pw = (player->sid_regs[base + 3] << 8) | player->sid_regs[base + 2];
-        uint8_t ctrl = player->sid_regs[base + 4];
-        uint8_t ad = player->sid_regs[base + 5];
-        uint8_t sr = player->sid_regs[base + 6];
+        uint16_t freq = (regs[base + 1] << 8) | regs[base];
+        uint16_t pw = (regs[base + 3] << 8) | regs[base + 2];
+        uint8_t ctrl = regs[base + 4];
+        uint8_t ad = regs[base + 5];
+        uint8_t sr = regs[base + 6];
 
         float hz = freq * 0.0596f;
         fprintf(stderr, "  Frequency: $%04X (%u Hz)\n", freq, (uint32_t)hz);
@@ -724,9 +1276,9 @@ void sid_player_print_state(SidPlayer* player) {
     }
 
     fprintf(stderr, "FILTER:\n");
-    uint16_t fc = ((player->sid_regs[22] & 0x07) << 8) | player->sid_regs[21];
-    uint8_t res_filt = player->sid_regs[23];
-    uint8_t mode_vol = player->sid_regs[24];
+    uint16_t fc = ((regs[22] & 0x07) << 8) | regs[21];
+    uint8_t res_filt = regs[23];
+    uint8_t mode_vol = regs[24];
 
     fprintf(stderr, "  Cutoff: $%03X\n", fc);
     fprintf(stderr, "  Resonance: %d\n", (res_filt >> 4) & 0xF);
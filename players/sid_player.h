@@ -8,8 +8,11 @@
  * - PSID/RSID file playback
  * - Multiple subsong support
  * - Minimal 6502 emulation for player code
- * - 3-voice SID chip emulation
+ * - 3-voice SID chip emulation, up to three chips (PSID v3/v4 2SID/3SID)
+ *   placed across the stereo field
  * - PAL/NTSC timing support
+ * - CIA timer and VIC raster interrupts (multispeed, IRQ-driven RSID,
+ *   NMI digis), scheduled by CPU cycle
  * - Per-voice mute control
  * - Per-voice output for external processing
  */
@@ -88,6 +91,11 @@ bool sid_player_is_playing(const SidPlayer* player);
  * Song Information
  * ============================================================================ */
 
+/**
+ * Number of SID chips the loaded tune uses (1-3)
+ */
+int sid_player_get_num_chips(const SidPlayer* player);
+
 /**
  * Set subsong to play (0-based index)
  * @param subsong Subsong number (0 to num_subsongs-1)
@@ -212,6 +220,8 @@ void sid_player_set_disable_looping(SidPlayer* player, bool disable);
 
 /**
  * Force PAL or NTSC timing mode (overrides file header detection)
+ * Sets the CPU clock and the video frame rate; takes effect on the next
+ * sid_player_start().
  * @param is_pal true for PAL (50Hz), false for NTSC (60Hz)
  */
 void sid_player_set_pal_mode(SidPlayer* player, bool is_pal);
@@ -222,6 +232,15 @@ void sid_player_set_pal_mode(SidPlayer* player, bool is_pal);
  */
 bool sid_player_is_pal(const SidPlayer* player);
 
+/**
+ * Render each extra SID chip on its own worker thread (offline export)
+ * The CPU fills per-chip write queues for a block, then the chips render
+ * the block in parallel. Only available when built with SID_PLAYER_THREADS.
+ * @param enable true to use worker threads for 2SID/3SID tunes
+ * @return false if thread support is not compiled in
+ */
+bool sid_player_set_render_threads(SidPlayer* player, bool enable);
+
 /* ============================================================================
  * Debug/Analysis
  * ============================================================================ */
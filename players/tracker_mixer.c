@@ -3,6 +3,21 @@
  */
 
 #include "tracker_mixer.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Frames rendered at a time when a voice needs its mono signal
+#define TRACKER_MIXER_BLOCK 256
+
+struct TrackerVoicePool {
+    uint8_t* voices;            // capacity * voice_size bytes
+    size_t voice_size;
+    uint16_t capacity;
+    uint16_t* active;           // Slots of playing voices, oldest first
+    uint16_t num_active;
+    uint16_t* free_slots;       // Free list
+    uint16_t num_free;
+};
 
 void tracker_mixer_mix_stereo(const TrackerMixerChannel* channels,
                                uint32_t num_channels,
@@ -58,3 +73,214 @@ float tracker_mixer_mmd_pan_to_normalized(int8_t mmd_pan) {
     // Convert to -1.0 to 1.0
     return (float)mmd_pan / 16.0f;
 }
+
+void tracker_mixer_voice_fade_out(TrackerMixerVoice* voice, uint32_t frames) {
+    if (!voice) return;
+
+    if (frames == 0 || voice->gain <= 0.0f) {
+        // Ends on the next render
+        voice->gain = 0.0f;
+        voice->fade_step = 1.0f;
+        return;
+    }
+    voice->fade_step = voice->gain / (float)frames;
+}
+
+void tracker_mixer_render_voice(TrackerMixerVoice* voice,
+                                TrackerInterpolation interp,
+                                float* left,
+                                float* right,
+                                float* channel_out,
+                                float channel_gain,
+                                float scaling,
+                                uint32_t frames) {
+    const float gain = voice->gain;
+    const float step = voice->fade_step;
+
+    // The gain after the block is the same whether it is rendered or skipped
+    float end_gain = gain;
+    if (step > 0.0f) {
+        end_gain = gain - step * (float)frames;
+        if (end_gain < 0.0f) end_gain = 0.0f;
+    }
+
+    float volume = gain * channel_gain;
+    if (!left || !right || volume <= 0.0f) {
+        tracker_voice_skip(&voice->playback, frames);
+        voice->gain = end_gain;
+        return;
+    }
+
+    float left_gain, right_gain;
+    tracker_mixer_pan_to_gains(voice->pan, &left_gain, &right_gain);
+    left_gain *= scaling;
+    right_gain *= scaling;
+
+    if (step <= 0.0f && !channel_out) {
+        // Steady voice straight into the bus
+        tracker_voice_render(&voice->playback, interp, left, right, frames,
+                             left_gain * volume, right_gain * volume);
+        return;
+    }
+
+    float block[TRACKER_MIXER_BLOCK];
+    for (uint32_t done = 0; done < frames; ) {
+        uint32_t n = frames - done < TRACKER_MIXER_BLOCK ? frames - done : TRACKER_MIXER_BLOCK;
+        tracker_voice_render_mono(&voice->playback, interp, block, n);
+
+        if (step > 0.0f) {
+            // Ramp down frame by frame
+            for (uint32_t i = 0; i < n; i++) {
+                float g = gain - step * (float)(done + i + 1);
+                block[i] *= (g > 0.0f ? g : 0.0f) * channel_gain;
+            }
+        } else {
+            for (uint32_t i = 0; i < n; i++) {
+                block[i] *= volume;
+            }
+        }
+
+        float* l = left + done;
+        float* r = right + done;
+        for (uint32_t i = 0; i < n; i++) {
+            l[i] += block[i] * left_gain;
+            r[i] += block[i] * right_gain;
+        }
+        if (channel_out) {
+            float* out = channel_out + done;
+            for (uint32_t i = 0; i < n; i++) {
+                out[i] += block[i];
+            }
+        }
+        done += n;
+    }
+    voice->gain = end_gain;
+}
+
+static TrackerMixerVoice* pool_voice(const TrackerVoicePool* pool, uint16_t slot) {
+    return (TrackerMixerVoice*)(pool->voices + (size_t)slot * pool->voice_size);
+}
+
+TrackerVoicePool* tracker_voice_pool_create(uint16_t capacity, size_t voice_size) {
+    if (capacity == 0 || voice_size < sizeof(TrackerMixerVoice)) return NULL;
+
+    TrackerVoicePool* pool = (TrackerVoicePool*)calloc(1, sizeof(TrackerVoicePool));
+    if (!pool) return NULL;
+
+    pool->voices = (uint8_t*)calloc(capacity, voice_size);
+    pool->active = (uint16_t*)malloc(capacity * sizeof(uint16_t));
+    pool->free_slots = (uint16_t*)malloc(capacity * sizeof(uint16_t));
+    if (!pool->voices || !pool->active || !pool->free_slots) {
+        tracker_voice_pool_destroy(pool);
+        return NULL;
+    }
+
+    pool->voice_size = voice_size;
+    pool->capacity = capacity;
+    tracker_voice_pool_clear(pool);
+    return pool;
+}
+
+void tracker_voice_pool_destroy(TrackerVoicePool* pool) {
+    if (!pool) return;
+    free(pool->voices);
+    free(pool->active);
+    free(pool->free_slots);
+    free(pool);
+}
+
+void tracker_voice_pool_clear(TrackerVoicePool* pool) {
+    if (!pool) return;
+
+    // Lowest slots are handed out first
+    pool->num_active = 0;
+    pool->num_free = pool->capacity;
+    for (uint16_t i = 0; i < pool->capacity; i++) {
+        pool->free_slots[i] = (uint16_t)(pool->capacity - 1 - i);
+    }
+}
+
+TrackerMixerVoice* tracker_voice_pool_add(TrackerVoicePool* pool, const void* voice) {
+    if (!pool || !voice) return NULL;
+
+    uint16_t slot;
+    if (pool->num_free > 0) {
+        slot = pool->free_slots[--pool->num_free];
+    } else {
+        // Take over the quietest voice; the list is oldest first, so the
+        // oldest wins a tie
+        uint16_t quietest = 0;
+        for (uint16_t i = 1; i < pool->num_active; i++) {
+            if (pool_voice(pool, pool->active[i])->gain < pool_voice(pool, pool->active[quietest])->gain) {
+                quietest = i;
+            }
+        }
+        slot = pool->active[quietest];
+        memmove(&pool->active[quietest], &pool->active[quietest + 1],
+                (size_t)(pool->num_active - quietest - 1) * sizeof(uint16_t));
+        pool->num_active--;
+    }
+
+    TrackerMixerVoice* added = pool_voice(pool, slot);
+    memcpy(added, voice, pool->voice_size);
+    pool->active[pool->num_active++] = slot;
+    return added;
+}
+
+uint16_t tracker_voice_pool_get_count(const TrackerVoicePool* pool) {
+    return pool ? pool->num_active : 0;
+}
+
+TrackerMixerVoice* tracker_voice_pool_get(const TrackerVoicePool* pool, uint16_t index) {
+    if (!pool || index >= pool->num_active) return NULL;
+    return pool_voice(pool, pool->active[index]);
+}
+
+void tracker_voice_pool_remove(TrackerVoicePool* pool, uint16_t index) {
+    if (!pool || index >= pool->num_active) return;
+
+    pool->free_slots[pool->num_free++] = pool->active[index];
+    memmove(&pool->active[index], &pool->active[index + 1],
+            (size_t)(pool->num_active - index - 1) * sizeof(uint16_t));
+    pool->num_active--;
+}
+
+void tracker_voice_pool_mix(TrackerVoicePool* pool,
+                            TrackerInterpolation interp,
+                            float* left,
+                            float* right,
+                            float** channel_outputs,
+                            uint8_t num_channel_outputs,
+                            uint32_t offset,
+                            const float* channel_gains,
+                            uint8_t num_channel_gains,
+                            float scaling,
+                            uint32_t frames) {
+    if (!pool) return;
+
+    bool mixing = left && right;
+    uint16_t i = 0;
+    while (i < pool->num_active) {
+        TrackerMixerVoice* voice = pool_voice(pool, pool->active[i]);
+        uint8_t c = voice->channel;
+        float channel_gain = (channel_gains && c < num_channel_gains) ? channel_gains[c] : 1.0f;
+        float* channel_out = (mixing && channel_outputs && c < num_channel_outputs && channel_outputs[c])
+                             ? channel_outputs[c] + offset : NULL;
+
+        tracker_mixer_render_voice(voice, interp,
+                                   mixing ? left + offset : NULL,
+                                   mixing ? right + offset : NULL,
+                                   channel_out, channel_gain, scaling, frames);
+
+        // Drop voices that can no longer be heard
+        const TrackerVoice* playback = &voice->playback;
+        bool ended = !playback->waveform ||
+                     (!playback->loop_enabled && playback->sample_pos >= playback->length) ||
+                     (voice->fade_step > 0.0f && voice->gain <= 0.0f);
+        if (ended) {
+            tracker_voice_pool_remove(pool, i);
+        } else {
+            i++;
+        }
+    }
+}
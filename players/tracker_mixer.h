@@ -1,7 +1,9 @@
 /*
  * Tracker Mixer - Shared stereo mixing for tracker-based players
  *
- * Provides common stereo mixing functionality for MOD, MMD, and AHX players.
+ * Provides common stereo mixing functionality for MOD, MMD, and AHX players,
+ * and the virtual voice pool that keeps notes playing after their channel has
+ * moved on (XM/IT new note actions, MOD note fades).
  *
  * All three players use a frame-based approach:
  * - Effects can change parameters every sample (vibrato, tremolo)
@@ -13,6 +15,8 @@
 #pragma once
 
 #include <stdint.h>
+#include <stddef.h>
+#include "tracker_voice.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -59,6 +63,131 @@ void tracker_mixer_pan_to_gains(float pan, float* left_gain, float* right_gain);
  */
 float tracker_mixer_mmd_pan_to_normalized(int8_t mmd_pan);
 
+/**
+ * Mixer voice - a playing sample with its final gain and panning
+ *
+ * Players that keep more state per voice (envelopes, fadeout) make this the
+ * first member of their own voice struct.
+ */
+typedef struct {
+    TrackerVoice playback;
+    float gain;             // Volume before panning (0.0 = silent, still advances)
+    float pan;              // -1.0 = hard left, 0.0 = center, 1.0 = hard right
+    float fade_step;        // Gain taken off per frame while fading out (0 = not fading)
+    uint8_t channel;        // Channel that played the note (mute, volume, output)
+} TrackerMixerVoice;
+
+/**
+ * Start a linear fade from the voice's current gain to silence
+ *
+ * @param voice Voice to fade
+ * @param frames Length of the fade in frames (0 = silence at once)
+ */
+void tracker_mixer_voice_fade_out(TrackerMixerVoice* voice, uint32_t frames);
+
+/**
+ * Render a voice and add it to a stereo bus
+ *
+ * Fading voices ramp down frame by frame and end up with a gain of 0.
+ *
+ * @param voice Voice to render
+ * @param interp Sample interpolation
+ * @param left Left bus (added to), or NULL to only advance the voice
+ * @param right Right bus (added to)
+ * @param channel_out Mono output the voice is added to at its volume,
+ *                    before panning and scaling (can be NULL)
+ * @param channel_gain Extra gain for the voice's channel (0.0 = muted)
+ * @param scaling Gain applied to the bus only (e.g. 0.5f for Amiga-style headroom)
+ * @param frames Number of frames
+ */
+void tracker_mixer_render_voice(TrackerMixerVoice* voice,
+                                TrackerInterpolation interp,
+                                float* left,
+                                float* right,
+                                float* channel_out,
+                                float channel_gain,
+                                float scaling,
+                                uint32_t frames);
+
+/**
+ * Virtual voice pool
+ *
+ * A fixed number of voices is allocated up front. Free voices sit on a free
+ * list and playing ones in a dense list (oldest first), so mixing and
+ * per-tick updates only touch voices that are playing and an empty pool
+ * costs nothing. When every voice is in use, adding one takes over the
+ * quietest (the oldest of equally quiet ones).
+ *
+ * Voices are voice_size bytes, starting with a TrackerMixerVoice.
+ * Nothing is allocated after tracker_voice_pool_create().
+ */
+typedef struct TrackerVoicePool TrackerVoicePool;
+
+/**
+ * Create a pool
+ *
+ * @param capacity Most voices playing at once (1 to 65535)
+ * @param voice_size Size of one voice (at least sizeof(TrackerMixerVoice))
+ * @return New pool, or NULL on allocation failure
+ */
+TrackerVoicePool* tracker_voice_pool_create(uint16_t capacity, size_t voice_size);
+
+/**
+ * Destroy a pool
+ */
+void tracker_voice_pool_destroy(TrackerVoicePool* pool);
+
+/**
+ * Stop every voice
+ */
+void tracker_voice_pool_clear(TrackerVoicePool* pool);
+
+/**
+ * Add a voice, copying voice_size bytes from voice
+ *
+ * @return The voice in the pool (newest, so last in the list)
+ */
+TrackerMixerVoice* tracker_voice_pool_add(TrackerVoicePool* pool, const void* voice);
+
+/**
+ * Number of voices playing
+ */
+uint16_t tracker_voice_pool_get_count(const TrackerVoicePool* pool);
+
+/**
+ * Get a playing voice (index 0 is the oldest, index < count)
+ */
+TrackerMixerVoice* tracker_voice_pool_get(const TrackerVoicePool* pool, uint16_t index);
+
+/**
+ * Stop a playing voice
+ * Later voices move down one index, so loops that remove voices should walk
+ * the list from the end.
+ */
+void tracker_voice_pool_remove(TrackerVoicePool* pool, uint16_t index);
+
+/**
+ * Render every playing voice into a stereo bus (see tracker_mixer_render_voice)
+ * Voices whose sample has ended or whose fade has reached silence are removed.
+ *
+ * @param channel_outputs Mono output per channel (array and entries can be NULL)
+ * @param num_channel_outputs Number of entries in channel_outputs
+ * @param offset Frame offset into the bus and channel outputs
+ * @param channel_gains Gain per channel (NULL = 1.0 for all)
+ * @param num_channel_gains Number of entries in channel_gains (others get 1.0)
+ */
+void tracker_voice_pool_mix(TrackerVoicePool* pool,
+                            TrackerInterpolation interp,
+                            float* left,
+                            float* right,
+                            float** channel_outputs,
+                            uint8_t num_channel_outputs,
+                            uint32_t offset,
+                            const float* channel_gains,
+                            uint8_t num_channel_gains,
+                            float scaling,
+                            uint32_t frames);
+
 #ifdef __cplusplus
 }
 #endif
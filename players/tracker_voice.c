@@ -3,13 +3,35 @@
  */
 
 #include "tracker_voice.h"
+#include "../effects/fx_resampler.h"
 #include <string.h>
 #include <stdio.h>
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define TRACKER_VOICE_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define TRACKER_VOICE_NEON
+#endif
+
 // Convert period to frequency (16.16 fixed-point delta)
 #define Period2Delta(period, clock_rate, sample_rate) \
     ((uint32_t)(((uint64_t)(clock_rate) * 65536ULL) / ((period) * (sample_rate))))
 
+// Scratch block for tracker_voice_render()
+#define TRACKER_VOICE_BLOCK 256
+
+// Table phases from the 16-bit position fraction
+#define CUBIC_PHASE_SHIFT (16 - FX_RESAMPLER_CUBIC_PHASES_BITS)
+#define CUBIC_PHASE_MASK ((1 << FX_RESAMPLER_CUBIC_PHASES_BITS) - 1)
+#define SINC_PHASE_SHIFT (16 - FX_RESAMPLER_SINC_PHASES_BITS)
+#define SINC_PHASE_MASK ((1 << FX_RESAMPLER_SINC_PHASES_BITS) - 1)
+
+// Taps read before and after the integer position, per interpolation mode
+static const uint32_t interp_taps_before[TRACKER_INTERP_NUM_MODES] = { 0, 0, 1, 3 };
+static const uint32_t interp_taps_after[TRACKER_INTERP_NUM_MODES] = { 0, 1, 2, 4 };
+
 void tracker_voice_init(TrackerVoice* voice) {
     memset(voice, 0, sizeof(TrackerVoice));
     voice->delta = 1;  // Avoid division by zero
@@ -208,3 +230,333 @@ void tracker_voice_get_stereo_sample(TrackerVoice* voice,
     *out_left = (scaled * voice->pan_left) >> 7;
     *out_right = (scaled * voice->pan_right) >> 7;
 }
+
+// ============================================================================
+// Block Rendering
+// ============================================================================
+
+// Inner loops, one per bit depth. The caller guarantees that every tap of
+// every frame lies inside the waveform, so nothing is checked here.
+#define DEFINE_SPAN_RENDERER(NAME, TYPE, SCALE)                                 \
+static uint64_t NAME(const TYPE* wave, TrackerInterpolation interp,             \
+                     const float* lut, uint64_t pos, uint32_t delta,            \
+                     float* out, uint32_t frames) {                             \
+    switch (interp) {                                                           \
+        case TRACKER_INTERP_LINEAR:                                             \
+            for (uint32_t i = 0; i < frames; i++, pos += delta) {               \
+                const TYPE* s = wave + (pos >> 16);                             \
+                float frac = (float)(pos & 0xFFFF) * (1.0f / 65536.0f);         \
+                out[i] = ((float)s[0] + frac * (float)(s[1] - s[0])) * SCALE;   \
+            }                                                                   \
+            break;                                                              \
+        case TRACKER_INTERP_CUBIC:                                              \
+            for (uint32_t i = 0; i < frames; i++, pos += delta) {               \
+                const TYPE* s = wave + (pos >> 16) - 1;                         \
+                const float* c = lut + ((pos >> CUBIC_PHASE_SHIFT) & CUBIC_PHASE_MASK) * 4; \
+                out[i] = (c[0] * s[0] + c[1] * s[1] + c[2] * s[2] + c[3] * s[3]) * SCALE; \
+            }                                                                   \
+            break;                                                              \
+        case TRACKER_INTERP_SINC:                                               \
+            for (uint32_t i = 0; i < frames; i++, pos += delta) {               \
+                const TYPE* s = wave + (pos >> 16) - 3;                         \
+                const float* c = lut + ((pos >> SINC_PHASE_SHIFT) & SINC_PHASE_MASK) * FX_RESAMPLER_SINC_WIDTH; \
+                float sum = 0.0f;                                               \
+                for (int k = 0; k < FX_RESAMPLER_SINC_WIDTH; k++) {             \
+                    sum += c[k] * s[k];                                         \
+                }                                                               \
+                out[i] = sum * SCALE;                                           \
+            }                                                                   \
+            break;                                                              \
+        default:                                                                \
+            for (uint32_t i = 0; i < frames; i++, pos += delta) {               \
+                out[i] = wave[pos >> 16] * SCALE;                               \
+            }                                                                   \
+            break;                                                              \
+    }                                                                           \
+    return pos;                                                                 \
+}
+
+DEFINE_SPAN_RENDERER(render_span_8, int8_t, (1.0f / 128.0f))
+DEFINE_SPAN_RENDERER(render_span_16, int16_t, (1.0f / 32768.0f))
+
+// One tap that may fall outside the waveform: past the loop end it wraps
+// into the loop (while the read position is inside it), before the start
+// or past the end of the data it is silent
+static float edge_tap(const TrackerVoice* voice, int64_t index, bool wrap) {
+    uint64_t length = voice->length >> 16;
+    if (index < 0) return 0.0f;
+
+    uint64_t i = (uint64_t)index;
+    if (wrap) {
+        uint64_t loop_start = voice->loop_start >> 16;
+        uint64_t loop_end = voice->loop_end >> 16;
+        if (i >= loop_end && loop_end > loop_start) {
+            i = loop_start + (i - loop_end) % (loop_end - loop_start);
+        }
+    }
+    if (i >= length) return 0.0f;
+
+    if (voice->bit_depth == 16) {
+        return ((const int16_t*)voice->waveform)[i] * (1.0f / 32768.0f);
+    }
+    return ((const int8_t*)voice->waveform)[i] * (1.0f / 128.0f);
+}
+
+// One frame whose taps straddle a loop or sample boundary
+static float render_edge(const TrackerVoice* voice, TrackerInterpolation interp,
+                         const float* lut, uint64_t pos) {
+    int64_t idx = (int64_t)(pos >> 16);
+    bool wrap = voice->loop_enabled && pos < voice->loop_end;
+
+    switch (interp) {
+        case TRACKER_INTERP_LINEAR: {
+            float frac = (float)(pos & 0xFFFF) * (1.0f / 65536.0f);
+            float s0 = edge_tap(voice, idx, wrap);
+            return s0 + frac * (edge_tap(voice, idx + 1, wrap) - s0);
+        }
+        case TRACKER_INTERP_CUBIC: {
+            const float* c = lut + ((pos >> CUBIC_PHASE_SHIFT) & CUBIC_PHASE_MASK) * 4;
+            float sum = 0.0f;
+            for (int k = 0; k < 4; k++) {
+                sum += c[k] * edge_tap(voice, idx - 1 + k, wrap);
+            }
+            return sum;
+        }
+        case TRACKER_INTERP_SINC: {
+            const float* c = lut + ((pos >> SINC_PHASE_SHIFT) & SINC_PHASE_MASK) * FX_RESAMPLER_SINC_WIDTH;
+            float sum = 0.0f;
+            for (int k = 0; k < FX_RESAMPLER_SINC_WIDTH; k++) {
+                sum += c[k] * edge_tap(voice, idx - 3 + k, wrap);
+            }
+            return sum;
+        }
+        default:
+            return edge_tap(voice, idx, wrap);
+    }
+}
+
+void tracker_voice_render_mono(TrackerVoice* voice,
+                               TrackerInterpolation interp,
+                               float* out,
+                               uint32_t frames) {
+    uint64_t length = voice->length >> 16;
+    if (!voice->waveform || length == 0) {
+        memset(out, 0, frames * sizeof(float));
+        return;
+    }
+
+    if ((unsigned)interp >= TRACKER_INTERP_NUM_MODES) {
+        interp = TRACKER_INTERP_NONE;
+    }
+
+    const float* lut = NULL;
+    if (interp == TRACKER_INTERP_CUBIC) {
+        lut = fx_resampler_get_cubic_table();
+    } else if (interp == TRACKER_INTERP_SINC) {
+        // Pitched above the output rate, pick a band-limited table
+        lut = fx_resampler_get_sinc_table(voice->delta / 65536.0f);
+    }
+
+    const uint32_t before = interp_taps_before[interp];
+    const uint32_t after = interp_taps_after[interp];
+
+    // Taps can be read directly up to the loop end (looping) or sample end
+    uint64_t end = length;
+    if (voice->loop_enabled && (voice->loop_end >> 16) < end) {
+        end = voice->loop_end >> 16;
+    }
+
+    const uint32_t delta = voice->delta;
+    uint64_t pos = voice->sample_pos;
+    uint32_t done = 0;
+
+    while (done < frames) {
+        uint64_t idx = pos >> 16;
+        if (idx >= length) {
+            break;  // One-shot finished (position stays past the end)
+        }
+
+        // Frames before the tap window reaches the boundary
+        uint32_t n = 0;
+        if (idx >= before && idx + after < end) {
+            n = frames - done;
+            if (delta > 0) {
+                uint64_t limit = (end - after) << 16;
+                uint64_t span = (limit - pos + delta - 1) / delta;
+                if (span < n) n = (uint32_t)span;
+            }
+        }
+
+        if (n > 0) {
+            if (voice->bit_depth == 16) {
+                pos = render_span_16((const int16_t*)voice->waveform, interp, lut,
+                                     pos, delta, out + done, n);
+            } else {
+                pos = render_span_8((const int8_t*)voice->waveform, interp, lut,
+                                    pos, delta, out + done, n);
+            }
+            done += n;
+        } else {
+            out[done++] = render_edge(voice, interp, lut, pos);
+            pos += delta;
+        }
+
+        // Wrap into the loop (same rules as tracker_voice_get_sample)
+        if (pos >= voice->loop_end && voice->loop_enabled) {
+            uint64_t loop_len = voice->loop_end - voice->loop_start;
+            if (loop_len > 0) {
+                pos = voice->loop_start + (pos - voice->loop_end) % loop_len;
+            } else {
+                pos = voice->loop_start;
+            }
+        }
+    }
+
+    if (done < frames) {
+        memset(out + done, 0, (frames - done) * sizeof(float));
+    }
+    voice->sample_pos = pos;
+}
+
+void tracker_voice_mix_blocks(float* left,
+                              float* right,
+                              const float* const* blocks,
+                              const float* left_gains,
+                              const float* right_gains,
+                              int num_blocks,
+                              uint32_t frames) {
+    // Up to four blocks per pass over the bus. Their pointers and gains are
+    // held in locals: read through the caller's arrays they would be
+    // reloaded after every store to the bus, which may alias them.
+    for (int first = 0; first < num_blocks; first += 4) {
+        const int count = num_blocks - first < 4 ? num_blocks - first : 4;
+        const float* src[4];
+        float gain_l[4], gain_r[4];
+        for (int b = 0; b < count; b++) {
+            src[b] = blocks[first + b];
+            gain_l[b] = left_gains[first + b];
+            gain_r[b] = right_gains[first + b];
+        }
+
+        uint32_t i = 0;
+
+        // Four frames per step, the blocks added in order (multiply, then
+        // add, as the scalar loop does)
+#if defined(TRACKER_VOICE_SSE)
+        __m128 vgain_l[4], vgain_r[4];
+        for (int b = 0; b < count; b++) {
+            vgain_l[b] = _mm_set1_ps(gain_l[b]);
+            vgain_r[b] = _mm_set1_ps(gain_r[b]);
+        }
+        for (; i + 4 <= frames; i += 4) {
+            __m128 l = _mm_loadu_ps(left + i);
+            __m128 r = _mm_loadu_ps(right + i);
+            for (int b = 0; b < count; b++) {
+                __m128 s = _mm_loadu_ps(src[b] + i);
+                l = _mm_add_ps(l, _mm_mul_ps(s, vgain_l[b]));
+                r = _mm_add_ps(r, _mm_mul_ps(s, vgain_r[b]));
+            }
+            _mm_storeu_ps(left + i, l);
+            _mm_storeu_ps(right + i, r);
+        }
+#elif defined(TRACKER_VOICE_NEON)
+        for (; i + 4 <= frames; i += 4) {
+            float32x4_t l = vld1q_f32(left + i);
+            float32x4_t r = vld1q_f32(right + i);
+            for (int b = 0; b < count; b++) {
+                float32x4_t s = vld1q_f32(src[b] + i);
+                l = vaddq_f32(l, vmulq_n_f32(s, gain_l[b]));
+                r = vaddq_f32(r, vmulq_n_f32(s, gain_r[b]));
+            }
+            vst1q_f32(left + i, l);
+            vst1q_f32(right + i, r);
+        }
+#endif
+
+        for (; i < frames; i++) {
+            float l = left[i];
+            float r = right[i];
+            for (int b = 0; b < count; b++) {
+                l += src[b][i] * gain_l[b];
+                r += src[b][i] * gain_r[b];
+            }
+            left[i] = l;
+            right[i] = r;
+        }
+    }
+}
+
+void tracker_voice_render(TrackerVoice* voice,
+                          TrackerInterpolation interp,
+                          float* left,
+                          float* right,
+                          uint32_t frames,
+                          float gain_left,
+                          float gain_right) {
+    // Nothing to add once a one-shot sample has ended
+    if (!voice->waveform || (voice->sample_pos >> 16) >= (voice->length >> 16)) {
+        return;
+    }
+
+    float block[TRACKER_VOICE_BLOCK];
+
+    while (frames > 0) {
+        uint32_t n = frames < TRACKER_VOICE_BLOCK ? frames : TRACKER_VOICE_BLOCK;
+        tracker_voice_render_mono(voice, interp, block, n);
+
+        for (uint32_t i = 0; i < n; i++) {
+            left[i] += block[i] * gain_left;
+            right[i] += block[i] * gain_right;
+        }
+
+        left += n;
+        right += n;
+        frames -= n;
+    }
+}
+
+void tracker_voice_skip(TrackerVoice* voice, uint32_t frames) {
+    uint64_t length = voice->length >> 16;
+    if (!voice->waveform || length == 0) {
+        return;
+    }
+
+    // Rendering stops once the integer position reaches the sample end
+    const uint64_t stop = length << 16;
+    const uint64_t delta = voice->delta;
+    uint64_t pos = voice->sample_pos;
+
+    while (frames > 0 && pos < stop) {
+        // Frames until the position reaches the loop end or the sample end
+        uint64_t bound = stop;
+        if (voice->loop_enabled && voice->loop_end < bound) {
+            bound = voice->loop_end;
+        }
+
+        uint64_t n = 1;
+        if (pos < bound) {
+            if (delta == 0) {
+                break;
+            }
+            n = (bound - pos + delta - 1) / delta;
+        }
+        if (n > frames) n = frames;
+
+        pos += n * delta;
+        frames -= (uint32_t)n;
+
+        // Wrap into the loop (same rules as tracker_voice_render_mono)
+        if (pos >= voice->loop_end && voice->loop_enabled) {
+            uint64_t loop_len = voice->loop_end - voice->loop_start;
+            if (loop_len > 0) {
+                pos = voice->loop_start + (pos - voice->loop_end) % loop_len;
+            } else {
+                // Every further frame lands back on the loop start
+                pos = voice->loop_start;
+                break;
+            }
+        }
+    }
+
+    voice->sample_pos = pos;
+}
@@ -17,6 +17,15 @@
 extern "C" {
 #endif
 
+// Interpolation for tracker_voice_render()
+typedef enum {
+    TRACKER_INTERP_NONE = 0,    // Nearest sample (Paula-style, default)
+    TRACKER_INTERP_LINEAR,      // 2-point linear
+    TRACKER_INTERP_CUBIC,       // 4-point cubic spline (FastSinc table)
+    TRACKER_INTERP_SINC,        // 8-point Kaiser sinc, anti-aliased when pitched up
+    TRACKER_INTERP_NUM_MODES
+} TrackerInterpolation;
+
 typedef struct {
     // Fixed-point playback state (16.16)
     uint64_t sample_pos;    // Current position in waveform (uint64_t for long samples)
@@ -140,6 +149,62 @@ void tracker_voice_get_stereo_sample(TrackerVoice* voice,
                                      int32_t* out_left,
                                      int32_t* out_right);
 
+/**
+ * Render a block of normalised samples (-1.0 to 1.0, volume not applied)
+ *
+ * The distance to the next loop or sample boundary is worked out before
+ * each span, so the inner loop (one per bit depth and interpolation mode)
+ * never checks for wrapping. Only the few frames whose taps straddle a
+ * boundary take the slow path. Looping and one-shot behaviour match
+ * tracker_voice_get_sample().
+ * @param out Output buffer (overwritten; silence after a one-shot ends)
+ * @param frames Number of frames to render
+ */
+void tracker_voice_render_mono(TrackerVoice* voice,
+                               TrackerInterpolation interp,
+                               float* out,
+                               uint32_t frames);
+
+/**
+ * Add mono blocks into a stereo bus, each with its own left/right gain
+ * left[i] += blocks[b][i] * left_gains[b] for b = 0 .. num_blocks-1 (right
+ * likewise), one block after the other, so the result is the same as
+ * adding them to the bus one at a time. Four frames per step with SSE or
+ * NEON when the target has them.
+ * Meant for summing several voices: the bus is loaded and stored once per
+ * four blocks instead of once per voice. A single block is no faster than
+ * the plain accumulate loop, which the compiler vectorizes by itself.
+ */
+void tracker_voice_mix_blocks(float* left,
+                              float* right,
+                              const float* const* blocks,
+                              const float* left_gains,
+                              const float* right_gains,
+                              int num_blocks,
+                              uint32_t frames);
+
+/**
+ * Render a block and accumulate it into a stereo bus
+ * @param left Left bus (added to)
+ * @param right Right bus (added to)
+ * @param gain_left Gain applied to the normalised sample for the left bus
+ * @param gain_right Gain applied to the normalised sample for the right bus
+ */
+void tracker_voice_render(TrackerVoice* voice,
+                          TrackerInterpolation interp,
+                          float* left,
+                          float* right,
+                          uint32_t frames,
+                          float gain_left,
+                          float gain_right);
+
+/**
+ * Advance the playback position as rendering the same number of frames
+ * would, without producing any output (for seeking/fast-forward)
+ * @param frames Number of frames to skip
+ */
+void tracker_voice_skip(TrackerVoice* voice, uint32_t frames);
+
 #ifdef __cplusplus
 }
 #endif
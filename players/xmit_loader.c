@@ -0,0 +1,1272 @@
+/*
+ * XM/S3M/IT Loaders
+ *
+ * Each loader converts its format into the common XmitModule layout (see
+ * xmit_module.h). Files are parsed with bounds checks throughout: anything
+ * that points past the end of the data is treated as empty instead of
+ * failing the whole load, as trackers do with truncated files.
+ */
+
+#include "xmit_module.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+static uint16_t read16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t read32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Copy a space/zero padded name
+static void copy_title(char* dst, const uint8_t* src, size_t length) {
+    if (length > XMIT_TITLE_LENGTH) length = XMIT_TITLE_LENGTH;
+    memcpy(dst, src, length);
+    dst[length] = '\0';
+    for (size_t i = 0; i < length; i++) {
+        if (dst[i] != '\0' && (dst[i] < 32 || dst[i] > 126)) dst[i] = ' ';
+    }
+    for (size_t i = length; i > 0 && (dst[i - 1] == ' ' || dst[i - 1] == '\0'); i--) {
+        dst[i - 1] = '\0';
+    }
+}
+
+void xmit_module_free(XmitModule* module) {
+    for (int i = 0; i < XMIT_MAX_PATTERNS; i++) {
+        free(module->patterns[i].cells);
+    }
+    for (uint16_t i = 0; i < module->num_samples; i++) {
+        free((void*)module->samples[i].data);
+    }
+    free(module->samples);
+    free(module->instruments);
+    memset(module, 0, sizeof(*module));
+}
+
+// Common defaults before a loader fills in the module
+static void begin_module(XmitModule* module, XmitFormat format) {
+    xmit_module_free(module);
+    module->format = format;
+    module->initial_speed = 6;
+    module->initial_tempo = 125;
+    module->initial_global_volume = 128;
+    for (int c = 0; c < XMIT_MAX_CHANNELS; c++) {
+        module->channel_pan[c] = 128;
+        module->channel_volume[c] = 64;
+    }
+}
+
+static bool alloc_pattern(XmitPattern* pattern, uint16_t rows, uint8_t num_channels) {
+    pattern->rows = rows;
+    pattern->cells = (XmitCell*)malloc((size_t)rows * num_channels * sizeof(XmitCell));
+    if (!pattern->cells) return false;
+
+    for (size_t i = 0; i < (size_t)rows * num_channels; i++) {
+        XmitCell* cell = &pattern->cells[i];
+        memset(cell, 0, sizeof(*cell));
+        cell->note = XMIT_NOTE_NONE;
+    }
+    return true;
+}
+
+// One instrument per sample, every note playing that sample
+static bool instruments_from_samples(XmitModule* module) {
+    module->num_instruments = module->num_samples;
+    if (module->num_instruments == 0) return true;
+
+    module->instruments = (XmitInstrument*)calloc(module->num_instruments, sizeof(XmitInstrument));
+    if (!module->instruments) return false;
+
+    for (uint16_t i = 0; i < module->num_instruments; i++) {
+        XmitInstrument* ins = &module->instruments[i];
+        for (int n = 0; n < XMIT_NUM_NOTES; n++) {
+            ins->sample[n] = (uint16_t)(i + 1);
+            ins->note[n] = (uint8_t)n;
+        }
+        ins->global_volume = 128;
+        ins->panning = -1;
+    }
+    return true;
+}
+
+// ============================================================================
+// Sample data
+// ============================================================================
+
+// Decode PCM into a new signed mono buffer. Stereo data (all left samples,
+// then all right) is mixed down. Reads at most avail bytes; the rest stays
+// silent.
+static void* decode_pcm(const uint8_t* src, size_t avail, uint32_t length,
+                        bool is_16bit, bool is_signed, bool stereo, bool delta) {
+    size_t bytes = is_16bit ? 2 : 1;
+    void* out = calloc(length ? length : 1, bytes);
+    if (!out) return NULL;
+
+    int channels = stereo ? 2 : 1;
+    for (int ch = 0; ch < channels; ch++) {
+        const uint8_t* in = src + (size_t)ch * length * bytes;
+        size_t start = (size_t)ch * length * bytes;
+        uint32_t count = length;
+        if (start >= avail) break;
+        if ((avail - start) / bytes < count) count = (uint32_t)((avail - start) / bytes);
+
+        int32_t previous = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            int32_t value;
+            if (is_16bit) {
+                uint16_t raw = read16(in + i * 2);
+                if (delta) {
+                    raw = (uint16_t)(raw + previous);
+                    previous = raw;
+                }
+                value = is_signed ? (int16_t)raw : (int32_t)raw - 32768;
+            } else {
+                uint8_t raw = in[i];
+                if (delta) {
+                    raw = (uint8_t)(raw + previous);
+                    previous = raw;
+                }
+                value = is_signed ? (int8_t)raw : (int32_t)raw - 128;
+            }
+
+            if (is_16bit) {
+                int16_t* dst = (int16_t*)out + i;
+                *dst = (int16_t)(ch == 0 ? (stereo ? value / 2 : value) : *dst + value / 2);
+            } else {
+                int8_t* dst = (int8_t*)out + i;
+                *dst = (int8_t)(ch == 0 ? (stereo ? value / 2 : value) : *dst + value / 2);
+            }
+        }
+    }
+    return out;
+}
+
+// LSB-first bit reader for IT compressed samples
+typedef struct {
+    const uint8_t* data;
+    size_t size_bits;
+    size_t position;
+} BitReader;
+
+static uint32_t read_bits(BitReader* reader, int count) {
+    uint32_t value = 0;
+    for (int i = 0; i < count; i++) {
+        size_t bit = reader->position++;
+        value |= (uint32_t)((reader->data[bit >> 3] >> (bit & 7)) & 1) << i;
+    }
+    return value;
+}
+
+// IT 2.14/2.15 compressed samples: blocks of up to 0x8000 8-bit or 0x4000
+// 16-bit samples, each a byte count and a bitstream of variable width deltas
+// (IT 2.15 stores deltas of deltas). Decodes one channel into out and
+// returns the bytes read.
+static size_t decompress_it(const uint8_t* src, size_t avail, void* out, uint32_t length,
+                            bool is_16bit, bool it215, bool mix) {
+    const int max_width = is_16bit ? 17 : 9;
+    const int sample_bits = is_16bit ? 16 : 8;
+    size_t pos = 0;
+    uint32_t done = 0;
+
+    while (done < length && pos + 2 <= avail) {
+        size_t block_size = read16(src + pos);
+        pos += 2;
+        if (block_size > avail - pos) block_size = avail - pos;
+
+        BitReader reader = { src + pos, block_size * 8, 0 };
+        pos += block_size;
+
+        uint32_t block_length = length - done;
+        uint32_t max_block = is_16bit ? 0x4000 : 0x8000;
+        if (block_length > max_block) block_length = max_block;
+
+        int width = max_width;
+        uint32_t d1 = 0, d2 = 0;  // Wrap like the 8/16-bit originals
+        uint32_t n = 0;
+
+        while (n < block_length && reader.position + (size_t)width <= reader.size_bits) {
+            uint32_t value = read_bits(&reader, width);
+
+            if (width < 7) {
+                // Method 1: one marker value, new width in the next bits
+                if (value == (1u << (width - 1))) {
+                    if (reader.position + (is_16bit ? 4 : 3) > reader.size_bits) break;
+                    int new_width = (int)read_bits(&reader, is_16bit ? 4 : 3) + 1;
+                    width = new_width < width ? new_width : new_width + 1;
+                    continue;
+                }
+            } else if (width < max_width) {
+                // Method 2: a range of values at the top encodes the width
+                uint32_t border = (is_16bit ? (0xFFFFu >> (17 - width)) - 8 : (0xFFu >> (9 - width)) - 4);
+                if (value > border && value <= border + (is_16bit ? 16 : 8)) {
+                    int new_width = (int)(value - border);
+                    width = new_width < width ? new_width : new_width + 1;
+                    continue;
+                }
+            } else {
+                // Method 3: top bit set means a width change
+                if (value & (1u << sample_bits)) {
+                    width = (int)((value + 1) & 0xFF);
+                    if (width < 1 || width > max_width) break;
+                    continue;
+                }
+            }
+
+            // Sign-extend the delta
+            int32_t delta;
+            if (width < sample_bits) {
+                int shift = 32 - width;
+                delta = (int32_t)(value << shift) >> shift;
+            } else {
+                delta = is_16bit ? (int16_t)value : (int8_t)value;
+            }
+
+            d1 += (uint32_t)delta;
+            d2 += d1;
+            uint32_t sample = it215 ? d2 : d1;
+
+            if (is_16bit) {
+                int16_t* dst = (int16_t*)out + done + n;
+                int16_t v = (int16_t)sample;
+                *dst = mix ? (int16_t)(*dst + v / 2) : v;
+            } else {
+                int8_t* dst = (int8_t*)out + done + n;
+                int8_t v = (int8_t)sample;
+                *dst = mix ? (int8_t)(*dst + v / 2) : v;
+            }
+            n++;
+        }
+
+        done += block_length;
+    }
+
+    return pos;
+}
+
+// Halve a decoded channel before the second one is mixed in
+static void halve_samples(void* data, uint32_t length, bool is_16bit) {
+    for (uint32_t i = 0; i < length; i++) {
+        if (is_16bit) ((int16_t*)data)[i] /= 2;
+        else ((int8_t*)data)[i] /= 2;
+    }
+}
+
+// Take ownership of decoded data, unrolling a ping-pong loop into a forward
+// one: the loop is followed by its reverse (without the end points), so
+// playing the new loop forwards sounds the same.
+static bool set_sample_data(XmitSample* sample, void* data, bool ping_pong) {
+    if (!data) return false;
+
+    if (sample->loop && ping_pong && sample->loop_end - sample->loop_start > 2) {
+        size_t bytes = sample->is_16bit ? 2 : 1;
+        uint32_t extra = sample->loop_end - sample->loop_start - 2;
+        uint32_t new_length = sample->loop_end + extra;
+
+        uint8_t* unrolled = (uint8_t*)malloc((size_t)new_length * bytes);
+        if (!unrolled) {
+            free(data);
+            return false;
+        }
+        memcpy(unrolled, data, (size_t)sample->loop_end * bytes);
+        for (uint32_t i = 0; i < extra; i++) {
+            memcpy(unrolled + ((size_t)sample->loop_end + i) * bytes,
+                   (uint8_t*)data + ((size_t)sample->loop_end - 2 - i) * bytes, bytes);
+        }
+        free(data);
+        data = unrolled;
+        sample->length = new_length;
+        sample->loop_end = new_length;
+    }
+
+    sample->data = data;
+    return true;
+}
+
+// Clamp loop points to the sample and drop loops that are empty
+// Limit a sample length to the data the file has left, so a forged header
+// cannot make decode_pcm allocate gigabytes
+static uint32_t clamp_sample_length(uint32_t length, size_t avail, bool is_16bit) {
+    size_t max_length = avail / (is_16bit ? 2 : 1);
+    return length > max_length ? (uint32_t)max_length : length;
+}
+
+static void check_loops(XmitSample* sample) {
+    if (sample->loop_end > sample->length) sample->loop_end = sample->length;
+    if (sample->loop_start >= sample->loop_end) sample->loop = false;
+    if (sample->sustain_end > sample->length) sample->sustain_end = sample->length;
+    if (sample->sustain_start >= sample->sustain_end) sample->sustain_loop = false;
+}
+
+// ============================================================================
+// XM (FastTracker 2)
+// ============================================================================
+
+#define XM_HEADER_SIZE 80
+
+bool xmit_detect_xm(const uint8_t* data, size_t size) {
+    return data && size >= XM_HEADER_SIZE && memcmp(data, "Extended Module: ", 17) == 0;
+}
+
+// XM Axy-style slides: if both nibbles are set the up slide wins
+static uint8_t xm_slide_param(uint8_t param) {
+    return (param & 0xF0) ? (param & 0xF0) : param;
+}
+
+static void convert_xm_effect(XmitCell* cell, uint8_t effect, uint8_t param) {
+    uint8_t x = param >> 4;
+    uint8_t y = param & 0x0F;
+
+    cell->effect = XMIT_FX_NONE;
+    cell->param = param;
+
+    switch (effect) {
+        case 0x0: if (param) cell->effect = XMIT_FX_ARPEGGIO; break;
+        case 0x1:
+            cell->effect = XMIT_FX_PORTA_UP;
+            if (param >= 0xE0) cell->param = 0xDF;  // Not a fine slide in XM
+            break;
+        case 0x2:
+            cell->effect = XMIT_FX_PORTA_DOWN;
+            if (param >= 0xE0) cell->param = 0xDF;
+            break;
+        case 0x3: cell->effect = XMIT_FX_TONE_PORTA; break;
+        case 0x4: cell->effect = XMIT_FX_VIBRATO; break;
+        case 0x5:
+            cell->effect = XMIT_FX_PORTA_VOLUME;
+            cell->param = xm_slide_param(param);
+            break;
+        case 0x6:
+            cell->effect = XMIT_FX_VIBRATO_VOLUME;
+            cell->param = xm_slide_param(param);
+            break;
+        case 0x7: cell->effect = XMIT_FX_TREMOLO; break;
+        case 0x8: cell->effect = XMIT_FX_PAN; break;
+        case 0x9: cell->effect = XMIT_FX_OFFSET; break;
+        case 0xA:
+            cell->effect = XMIT_FX_VOLUME_SLIDE;
+            cell->param = xm_slide_param(param);
+            break;
+        case 0xB: cell->effect = XMIT_FX_JUMP; break;
+        case 0xC:
+            cell->effect = XMIT_FX_XM_VOLUME;
+            if (param > 64) cell->param = 64;
+            break;
+        case 0xD:
+            // Row number in BCD
+            cell->effect = XMIT_FX_BREAK;
+            cell->param = (uint8_t)(x * 10 + y);
+            break;
+        case 0xE:
+            switch (x) {
+                case 0x1: if (y) { cell->effect = XMIT_FX_PORTA_UP; cell->param = 0xF0 | y; } break;
+                case 0x2: if (y) { cell->effect = XMIT_FX_PORTA_DOWN; cell->param = 0xF0 | y; } break;
+                case 0x3: cell->effect = XMIT_FX_EXTENDED; cell->param = 0x10 | y; break;
+                case 0x4: cell->effect = XMIT_FX_EXTENDED; cell->param = 0x30 | y; break;
+                case 0x5: cell->effect = XMIT_FX_EXTENDED; cell->param = 0x20 | y; break;
+                case 0x6: cell->effect = XMIT_FX_EXTENDED; cell->param = 0xB0 | y; break;
+                case 0x7: cell->effect = XMIT_FX_EXTENDED; cell->param = 0x40 | y; break;
+                case 0x8: cell->effect = XMIT_FX_EXTENDED; cell->param = 0x80 | y; break;
+                case 0x9: if (y) { cell->effect = XMIT_FX_RETRIGGER; cell->param = y; } break;
+                case 0xA: if (y) { cell->effect = XMIT_FX_VOLUME_SLIDE; cell->param = (uint8_t)((y << 4) | 0x0F); } break;
+                case 0xB: if (y) { cell->effect = XMIT_FX_VOLUME_SLIDE; cell->param = 0xF0 | y; } break;
+                case 0xC: cell->effect = XMIT_FX_EXTENDED; cell->param = 0xC0 | y; break;
+                case 0xD: cell->effect = XMIT_FX_EXTENDED; cell->param = 0xD0 | y; break;
+                case 0xE: cell->effect = XMIT_FX_EXTENDED; cell->param = 0xE0 | y; break;
+                default: break;
+            }
+            break;
+        case 0xF:
+            if (param == 0) break;
+            cell->effect = param < 0x20 ? XMIT_FX_SPEED : XMIT_FX_TEMPO;
+            break;
+        case 16:  // Gxx: global volume 0-64
+            cell->effect = XMIT_FX_GLOBAL_VOLUME;
+            cell->param = (uint8_t)((param > 64 ? 64 : param) * 2);
+            break;
+        case 17:  // Hxy: global volume slide
+            cell->effect = XMIT_FX_GLOBAL_VOLUME_SLIDE;
+            cell->param = xm_slide_param(param);
+            break;
+        case 20: cell->effect = XMIT_FX_XM_KEY_OFF; break;
+        case 21: cell->effect = XMIT_FX_XM_ENV_POSITION; break;
+        case 25:
+            // XM slides right with the high nibble, IT with the low one
+            cell->effect = XMIT_FX_PAN_SLIDE;
+            cell->param = (uint8_t)((y << 4) | x);
+            break;
+        case 27: cell->effect = XMIT_FX_RETRIGGER; break;
+        case 29: cell->effect = XMIT_FX_TREMOR; break;
+        case 33:
+            if (x == 1 && y) { cell->effect = XMIT_FX_PORTA_UP; cell->param = 0xE0 | y; }
+            else if (x == 2 && y) { cell->effect = XMIT_FX_PORTA_DOWN; cell->param = 0xE0 | y; }
+            break;
+        default:
+            break;
+    }
+}
+
+static void convert_xm_volume(XmitCell* cell, uint8_t volume) {
+    uint8_t y = volume & 0x0F;
+
+    cell->volcmd = XMIT_VOL_NONE;
+    cell->volparam = 0;
+
+    if (volume >= 0x10 && volume <= 0x50) {
+        cell->volcmd = XMIT_VOL_SET;
+        cell->volparam = volume - 0x10;
+        return;
+    }
+
+    switch (volume >> 4) {
+        case 0x6: cell->volcmd = XMIT_VOL_SLIDE_DOWN; cell->volparam = y; break;
+        case 0x7: cell->volcmd = XMIT_VOL_SLIDE_UP; cell->volparam = y; break;
+        case 0x8: cell->volcmd = XMIT_VOL_FINE_DOWN; cell->volparam = y; break;
+        case 0x9: cell->volcmd = XMIT_VOL_FINE_UP; cell->volparam = y; break;
+        case 0xA: cell->volcmd = XMIT_VOL_VIBRATO_SPEED; cell->volparam = y; break;
+        case 0xB: cell->volcmd = XMIT_VOL_VIBRATO_DEPTH; cell->volparam = y; break;
+        case 0xC: cell->volcmd = XMIT_VOL_PAN; cell->volparam = (uint8_t)((y * 64 + 7) / 15); break;
+        case 0xD: cell->volcmd = XMIT_VOL_PAN_SLIDE_LEFT; cell->volparam = y; break;
+        case 0xE: cell->volcmd = XMIT_VOL_PAN_SLIDE_RIGHT; cell->volparam = y; break;
+        case 0xF: cell->volcmd = XMIT_VOL_TONE_PORTA; cell->volparam = (uint8_t)(y << 4); break;
+        default: break;
+    }
+}
+
+// Decode one packed XM pattern
+static void decode_xm_pattern(XmitPattern* pattern, const uint8_t* src, size_t size, uint8_t num_channels) {
+    size_t pos = 0;
+
+    for (uint16_t row = 0; row < pattern->rows; row++) {
+        for (uint8_t c = 0; c < num_channels; c++) {
+            if (pos >= size) return;
+
+            uint8_t note = 0, instrument = 0, volume = 0, effect = 0, param = 0;
+            uint8_t what = src[pos];
+
+            if (what & 0x80) {
+                pos++;
+                if ((what & 0x01) && pos < size) note = src[pos++];
+                if ((what & 0x02) && pos < size) instrument = src[pos++];
+                if ((what & 0x04) && pos < size) volume = src[pos++];
+                if ((what & 0x08) && pos < size) effect = src[pos++];
+                if ((what & 0x10) && pos < size) param = src[pos++];
+            } else {
+                if (pos + 5 > size) return;
+                note = src[pos];
+                instrument = src[pos + 1];
+                volume = src[pos + 2];
+                effect = src[pos + 3];
+                param = src[pos + 4];
+                pos += 5;
+            }
+
+            XmitCell* cell = &pattern->cells[row * num_channels + c];
+            if (note >= 1 && note <= 96) cell->note = (uint8_t)(note - 1 + 12);
+            else if (note == 97) cell->note = XMIT_NOTE_OFF;
+            cell->instrument = instrument;
+            convert_xm_volume(cell, volume);
+            convert_xm_effect(cell, effect, param);
+        }
+    }
+}
+
+// XM envelope: 12 points of (tick, value), values 0-64
+static void read_xm_envelope(XmitEnvelope* env, const uint8_t* points, uint8_t num_points,
+                             uint8_t sustain, uint8_t loop_start, uint8_t loop_end,
+                             uint8_t type, bool panning) {
+    memset(env, 0, sizeof(*env));
+    if (num_points > 12) num_points = 12;
+    if (num_points < 2) return;
+
+    for (uint8_t i = 0; i < num_points; i++) {
+        int value = read16(points + i * 4 + 2);
+        if (value > 64) value = 64;
+        env->tick[i] = read16(points + i * 4);
+        env->value[i] = (int8_t)(panning ? value - 32 : value);
+        // Ticks must rise
+        if (i > 0 && env->tick[i] < env->tick[i - 1]) env->tick[i] = env->tick[i - 1];
+    }
+    env->num_points = num_points;
+
+    if (type & 0x01) env->flags |= XMIT_ENV_ENABLED;
+    if ((type & 0x02) && sustain < num_points) {
+        env->flags |= XMIT_ENV_SUSTAIN;
+        env->sustain_start = env->sustain_end = sustain;
+    }
+    if ((type & 0x04) && loop_start <= loop_end && loop_end < num_points) {
+        env->flags |= XMIT_ENV_LOOP;
+        env->loop_start = loop_start;
+        env->loop_end = loop_end;
+    }
+}
+
+static const uint8_t xm_vibrato_types[4] = {
+    XMIT_WAVE_SINE, XMIT_WAVE_SQUARE, XMIT_WAVE_RAMP_DOWN, XMIT_WAVE_RAMP_UP
+};
+
+bool xmit_load_xm(XmitModule* module, const uint8_t* data, size_t size) {
+    if (!xmit_detect_xm(data, size)) return false;
+    if (read16(data + 58) < 0x0104) return false;
+
+    begin_module(module, XMIT_FORMAT_XM);
+    copy_title(module->title, data + 17, 20);
+
+    uint32_t header_size = read32(data + 60);
+    uint16_t song_length = read16(data + 64);
+    uint16_t restart = read16(data + 66);
+    uint16_t channels = read16(data + 68);
+    uint16_t num_patterns = read16(data + 70);
+    uint16_t num_instruments = read16(data + 72);
+    uint16_t flags = read16(data + 74);
+
+    if (channels == 0 || channels > XMIT_MAX_CHANNELS) return false;
+    if (num_patterns > XMIT_MAX_PATTERNS || num_instruments > XMIT_MAX_INSTRUMENTS) return false;
+    if (song_length > XMIT_MAX_ORDERS) song_length = XMIT_MAX_ORDERS;
+
+    // The order table starts at 80 and ends with the header (60 + header_size)
+    if (header_size < XM_HEADER_SIZE - 60) return false;
+    size_t header_end = header_size < size - 60 ? 60 + (size_t)header_size : size;
+    if (song_length > header_end - XM_HEADER_SIZE) song_length = (uint16_t)(header_end - XM_HEADER_SIZE);
+
+    module->num_channels = (uint8_t)channels;
+    module->flags.linear_slides = (flags & 1) != 0;
+    module->flags.key_off_cut = true;
+    module->initial_speed = read16(data + 76) ? (uint8_t)read16(data + 76) : 6;
+    module->initial_tempo = read16(data + 78) >= 32 ? (uint8_t)(read16(data + 78) > 255 ? 255 : read16(data + 78)) : 125;
+
+    for (uint16_t i = 0; i < song_length; i++) {
+        uint8_t pattern = data[80 + i];
+        if (pattern < num_patterns || pattern == 0) {
+            module->orders[module->num_orders++] = pattern;
+        }
+    }
+    module->restart_order = restart < module->num_orders ? restart : 0;
+
+    // Patterns
+    module->num_patterns = num_patterns;
+    size_t offset = 60 + (size_t)header_size;
+    for (uint16_t p = 0; p < num_patterns; p++) {
+        if (offset + 9 > size) break;
+
+        uint32_t pattern_header = read32(data + offset);
+        uint16_t rows = read16(data + offset + 5);
+        uint16_t packed_size = read16(data + offset + 7);
+        if (rows == 0 || rows > XMIT_MAX_ROWS) rows = 64;
+
+        offset += pattern_header;
+        if (!alloc_pattern(&module->patterns[p], rows, module->num_channels)) {
+            xmit_module_free(module);
+            return false;
+        }
+        if (offset < size) {
+            size_t avail = size - offset < packed_size ? size - offset : packed_size;
+            decode_xm_pattern(&module->patterns[p], data + offset, avail, module->num_channels);
+        }
+        offset += packed_size;
+    }
+
+    // Instruments, each followed by its sample headers and sample data
+    module->num_instruments = num_instruments;
+    if (num_instruments > 0) {
+        module->instruments = (XmitInstrument*)calloc(num_instruments, sizeof(XmitInstrument));
+        if (!module->instruments) {
+            xmit_module_free(module);
+            return false;
+        }
+    }
+
+    for (uint16_t i = 0; i < num_instruments; i++) {
+        XmitInstrument* ins = &module->instruments[i];
+        ins->global_volume = 128;
+        ins->panning = -1;
+        for (int n = 0; n < XMIT_NUM_NOTES; n++) ins->note[n] = (uint8_t)n;
+
+        if (offset + 29 > size) continue;
+        const uint8_t* header = data + offset;
+        uint32_t instrument_size = read32(header);
+        uint16_t num_samples = read16(header + 27);
+        if (instrument_size < 29) instrument_size = 29;
+
+        if (num_samples == 0) {
+            offset += instrument_size;
+            continue;
+        }
+        if (offset + 243 > size || num_samples > 16 ||
+            module->num_samples + num_samples > XMIT_MAX_SAMPLES) {
+            break;
+        }
+
+        uint32_t sample_header_size = read32(header + 29);
+        if (sample_header_size < 40) sample_header_size = 40;
+
+        uint16_t first_sample = module->num_samples;
+        for (int n = 0; n < 96; n++) {
+            uint8_t s = header[33 + n];
+            if (s < num_samples) ins->sample[n + 12] = (uint16_t)(first_sample + s + 1);
+        }
+
+        read_xm_envelope(&ins->volume_envelope, header + 129, header[225],
+                         header[227], header[228], header[229], header[233], false);
+        read_xm_envelope(&ins->panning_envelope, header + 177, header[226],
+                         header[230], header[231], header[232], header[234], true);
+        ins->fadeout = (uint32_t)read16(header + 239) * 2;
+
+        uint8_t vibrato_type = header[235] < 4 ? xm_vibrato_types[header[235]] : XMIT_WAVE_SINE;
+        uint8_t vibrato_sweep = header[236];
+        uint8_t vibrato_depth = header[237];
+        uint8_t vibrato_rate = header[238];
+
+        offset += instrument_size;
+
+        XmitSample* samples = (XmitSample*)realloc(module->samples,
+                                                   (module->num_samples + num_samples) * sizeof(XmitSample));
+        if (!samples) {
+            xmit_module_free(module);
+            return false;
+        }
+        module->samples = samples;
+        memset(&samples[first_sample], 0, num_samples * sizeof(XmitSample));
+        module->num_samples += num_samples;
+
+        // Sample headers
+        uint32_t byte_lengths[16];
+        bool ping_pong[16];
+        for (uint16_t s = 0; s < num_samples; s++) {
+            XmitSample* sample = &samples[first_sample + s];
+            byte_lengths[s] = 0;
+            ping_pong[s] = false;
+            if (offset + 40 > size) continue;
+
+            const uint8_t* sh = data + offset;
+            uint32_t length = read32(sh);
+            uint32_t loop_start = read32(sh + 4);
+            uint32_t loop_length = read32(sh + 8);
+            uint8_t type = sh[14];
+
+            sample->is_16bit = (type & 0x10) != 0;
+            uint32_t shift = sample->is_16bit ? 1 : 0;
+            byte_lengths[s] = length;
+            sample->length = length >> shift;
+            sample->loop_start = loop_start >> shift;
+            sample->loop_end = (loop_start + loop_length) >> shift;
+            sample->loop = (type & 0x03) != 0 && loop_length > 0;
+            ping_pong[s] = (type & 0x03) == 2;
+
+            sample->volume = sh[12] > 64 ? 64 : sh[12];
+            sample->global_volume = 64;
+            sample->panning = sh[15];
+
+            // Relative note and finetune (1/128 semitone) fold into c5speed
+            int8_t finetune = (int8_t)sh[13];
+            int8_t relative_note = (int8_t)sh[16];
+            sample->c5speed = (uint32_t)(8363.0 * pow(2.0, (relative_note * 128 + finetune) / 1536.0) + 0.5);
+
+            sample->vibrato_type = vibrato_type;
+            sample->vibrato_sweep = vibrato_sweep;
+            sample->vibrato_depth = vibrato_depth;
+            sample->vibrato_rate = vibrato_rate;
+
+            offset += sample_header_size;
+        }
+
+        // Sample data (delta-encoded)
+        for (uint16_t s = 0; s < num_samples; s++) {
+            XmitSample* sample = &samples[first_sample + s];
+            size_t avail = offset < size ? size - offset : 0;
+            sample->length = clamp_sample_length(sample->length, avail, sample->is_16bit);
+            if (sample->length > 0 && avail > 0) {
+                void* pcm = decode_pcm(data + offset, avail, sample->length,
+                                       sample->is_16bit, true, false, true);
+                check_loops(sample);
+                if (!set_sample_data(sample, pcm, ping_pong[s])) {
+                    sample->length = 0;
+                }
+            } else {
+                sample->length = 0;
+            }
+            offset += byte_lengths[s];
+        }
+    }
+
+    return true;
+}
+
+// ============================================================================
+// S3M (Scream Tracker 3)
+// ============================================================================
+
+bool xmit_detect_s3m(const uint8_t* data, size_t size) {
+    return data && size >= 0x60 && memcmp(data + 0x2C, "SCRM", 4) == 0 && data[0x1D] == 16;
+}
+
+static void decode_s3m_pattern(XmitPattern* pattern, const uint8_t* src, size_t size, uint8_t num_channels) {
+    size_t pos = 0;
+
+    for (uint16_t row = 0; row < pattern->rows && pos < size; row++) {
+        while (pos < size) {
+            uint8_t what = src[pos++];
+            if (what == 0) break;
+
+            uint8_t c = what & 31;
+            uint8_t note = 255, instrument = 0, volume = 255, command = 0, info = 0;
+
+            if (what & 32) {
+                if (pos + 2 > size) return;
+                note = src[pos];
+                instrument = src[pos + 1];
+                pos += 2;
+            }
+            if (what & 64) {
+                if (pos + 1 > size) return;
+                volume = src[pos++];
+            }
+            if (what & 128) {
+                if (pos + 2 > size) return;
+                command = src[pos];
+                info = src[pos + 1];
+                pos += 2;
+            }
+
+            if (c >= num_channels) continue;
+            XmitCell* cell = &pattern->cells[row * num_channels + c];
+
+            if (note == 254) cell->note = XMIT_NOTE_CUT;
+            else if (note < 254 && (note & 0x0F) < 12) cell->note = (uint8_t)((note >> 4) * 12 + (note & 0x0F) + 12);
+            cell->instrument = instrument;
+
+            if (volume <= 64) {
+                cell->volcmd = XMIT_VOL_SET;
+                cell->volparam = volume;
+            }
+
+            if (command >= 1 && command <= 26) {
+                cell->effect = command;
+                cell->param = info;
+                switch (command) {
+                    case XMIT_FX_GLOBAL_VOLUME:
+                        cell->param = (uint8_t)((info > 64 ? 64 : info) * 2);
+                        break;
+                    case XMIT_FX_PAN:
+                        // 0x00-0x80 (0xA4 = surround, played centred)
+                        cell->param = info == 0xA4 ? 0x80 : (uint8_t)(info >= 0x80 ? 0xFF : info * 2);
+                        break;
+                    case XMIT_FX_BREAK:
+                        // Row number in BCD
+                        cell->param = (uint8_t)((info >> 4) * 10 + (info & 0x0F));
+                        break;
+                    case XMIT_FX_TEMPO:
+                        // No tempo slides in S3M
+                        if (info < 0x20) cell->effect = XMIT_FX_NONE;
+                        break;
+                    default:
+                        break;
+                }
+            }
+        }
+    }
+}
+
+bool xmit_load_s3m(XmitModule* module, const uint8_t* data, size_t size) {
+    if (!xmit_detect_s3m(data, size)) return false;
+
+    begin_module(module, XMIT_FORMAT_S3M);
+    copy_title(module->title, data, 28);
+
+    uint16_t num_orders = read16(data + 0x20);
+    uint16_t num_samples = read16(data + 0x22);
+    uint16_t num_patterns = read16(data + 0x24);
+    uint16_t ffi = read16(data + 0x2A);
+    uint8_t master_volume = data[0x33];
+    uint8_t default_pan = data[0x35];
+
+    if (num_patterns > XMIT_MAX_PATTERNS || num_samples > XMIT_MAX_INSTRUMENTS) return false;
+
+    size_t orders_offset = 0x60;
+    size_t samples_offset = orders_offset + num_orders;
+    size_t patterns_offset = samples_offset + (size_t)num_samples * 2;
+    size_t pan_offset = patterns_offset + (size_t)num_patterns * 2;
+    if (pan_offset > size) return false;
+
+    module->flags.shared_effect_memory = true;
+    module->initial_global_volume = (uint8_t)((data[0x30] > 64 ? 64 : data[0x30]) * 2);
+    if (data[0x31] > 0 && data[0x31] < 255) module->initial_speed = data[0x31];
+    if (data[0x32] >= 33) module->initial_tempo = data[0x32];
+
+    // Channels: 0-7 left, 8-15 right, 16+ AdLib (not played), 255 unused
+    bool stereo = (master_volume & 0x80) != 0;
+    for (int c = 0; c < 32; c++) {
+        uint8_t setting = data[0x40 + c];
+        if (setting >= 16) {
+            module->channel_muted[c] = true;
+            continue;
+        }
+        module->num_channels = (uint8_t)(c + 1);
+        module->channel_pan[c] = stereo ? (setting < 8 ? 0x03 : 0x0C) * 256 / 15 : 128;
+
+        if (default_pan == 252 && pan_offset + 32 <= size) {
+            uint8_t pan = data[pan_offset + c];
+            if ((pan & 0x20) && stereo) module->channel_pan[c] = (uint16_t)((pan & 0x0F) * 256 / 15);
+        }
+    }
+    if (module->num_channels == 0) return false;
+
+    // Orders (254 = marker, 255 = end)
+    for (uint16_t i = 0; i < num_orders && module->num_orders < XMIT_MAX_ORDERS; i++) {
+        uint8_t pattern = data[orders_offset + i];
+        if (pattern == 255) break;
+        if (pattern < num_patterns) module->orders[module->num_orders++] = pattern;
+    }
+
+    // Samples
+    if (num_samples > 0) {
+        module->samples = (XmitSample*)calloc(num_samples, sizeof(XmitSample));
+        if (!module->samples) {
+            xmit_module_free(module);
+            return false;
+        }
+    }
+    module->num_samples = num_samples;
+
+    for (uint16_t i = 0; i < num_samples; i++) {
+        XmitSample* sample = &module->samples[i];
+        sample->c5speed = 8363;
+        sample->global_volume = 64;
+        sample->panning = -1;
+
+        size_t offset = (size_t)read16(data + samples_offset + i * 2) * 16;
+        if (offset + 0x50 > size || data[offset] != 1) continue;
+
+        const uint8_t* sh = data + offset;
+        size_t data_offset = (((size_t)sh[0x0D] << 16) | read16(sh + 0x0E)) * 16;
+        uint8_t flags = sh[0x1F];
+
+        sample->length = read32(sh + 0x10);
+        sample->loop_start = read32(sh + 0x14);
+        sample->loop_end = read32(sh + 0x18);
+        sample->loop = (flags & 1) != 0;
+        sample->is_16bit = (flags & 4) != 0;
+        sample->volume = sh[0x1C] > 64 ? 64 : sh[0x1C];
+        if (read32(sh + 0x20) > 0) sample->c5speed = read32(sh + 0x20);
+
+        size_t avail = data_offset < size ? size - data_offset : 0;
+        sample->length = clamp_sample_length(sample->length, avail, sample->is_16bit);
+        if (sh[0x1E] != 0 || sample->length == 0) {
+            sample->length = 0;  // Packed samples were never used
+            continue;
+        }
+
+        void* pcm = decode_pcm(data + data_offset, size - data_offset, sample->length,
+                               sample->is_16bit, ffi == 1, (flags & 2) != 0, false);
+        check_loops(sample);
+        if (!set_sample_data(sample, pcm, false)) sample->length = 0;
+    }
+
+    if (!instruments_from_samples(module)) {
+        xmit_module_free(module);
+        return false;
+    }
+
+    // Patterns (always 64 rows)
+    module->num_patterns = num_patterns;
+    for (uint16_t p = 0; p < num_patterns; p++) {
+        if (!alloc_pattern(&module->patterns[p], 64, module->num_channels)) {
+            xmit_module_free(module);
+            return false;
+        }
+
+        size_t offset = (size_t)read16(data + patterns_offset + p * 2) * 16;
+        if (offset == 0 || offset + 2 > size) continue;
+
+        size_t length = read16(data + offset);
+        size_t avail = size - offset - 2;
+        decode_s3m_pattern(&module->patterns[p], data + offset + 2, length < avail ? length : avail,
+                           module->num_channels);
+    }
+
+    return true;
+}
+
+// ============================================================================
+// IT (Impulse Tracker)
+// ============================================================================
+
+bool xmit_detect_it(const uint8_t* data, size_t size) {
+    return data && size >= 0xC0 && memcmp(data, "IMPM", 4) == 0;
+}
+
+// Volume column: ranges of one byte
+static void convert_it_volume(XmitCell* cell, uint8_t volume) {
+    static const uint8_t porta_speeds[10] = { 0, 1, 4, 8, 16, 32, 64, 96, 128, 255 };
+
+    cell->volcmd = XMIT_VOL_NONE;
+    cell->volparam = 0;
+
+    if (volume <= 64) { cell->volcmd = XMIT_VOL_SET; cell->volparam = volume; }
+    else if (volume <= 74) { cell->volcmd = XMIT_VOL_FINE_UP; cell->volparam = volume - 65; }
+    else if (volume <= 84) { cell->volcmd = XMIT_VOL_FINE_DOWN; cell->volparam = volume - 75; }
+    else if (volume <= 94) { cell->volcmd = XMIT_VOL_SLIDE_UP; cell->volparam = volume - 85; }
+    else if (volume <= 104) { cell->volcmd = XMIT_VOL_SLIDE_DOWN; cell->volparam = volume - 95; }
+    else if (volume <= 114) { cell->volcmd = XMIT_VOL_PORTA_DOWN; cell->volparam = (uint8_t)((volume - 105) * 4); }
+    else if (volume <= 124) { cell->volcmd = XMIT_VOL_PORTA_UP; cell->volparam = (uint8_t)((volume - 115) * 4); }
+    else if (volume >= 128 && volume <= 192) { cell->volcmd = XMIT_VOL_PAN; cell->volparam = volume - 128; }
+    else if (volume >= 193 && volume <= 202) { cell->volcmd = XMIT_VOL_TONE_PORTA; cell->volparam = porta_speeds[volume - 193]; }
+    else if (volume >= 203 && volume <= 212) { cell->volcmd = XMIT_VOL_VIBRATO_DEPTH; cell->volparam = volume - 203; }
+}
+
+// Decode an IT pattern. With no cells it only finds the highest channel used.
+static void decode_it_pattern(const uint8_t* src, size_t size, uint16_t rows,
+                              XmitCell* cells, uint8_t num_channels, uint8_t* max_channel) {
+    uint8_t last_mask[XMIT_MAX_CHANNELS] = { 0 };
+    XmitCell last[XMIT_MAX_CHANNELS];
+    uint8_t last_volume[XMIT_MAX_CHANNELS] = { 0 };
+    memset(last, 0, sizeof(last));
+    size_t pos = 0;
+
+    for (uint16_t row = 0; row < rows && pos < size; row++) {
+        while (pos < size) {
+            uint8_t what = src[pos++];
+            if (what == 0) break;
+
+            uint8_t c = (uint8_t)((what - 1) & 63);
+            uint8_t mask = last_mask[c];
+            if (what & 0x80) {
+                if (pos >= size) return;
+                mask = last_mask[c] = src[pos++];
+            }
+
+            XmitCell* prev = &last[c];
+            XmitCell cell;
+            memset(&cell, 0, sizeof(cell));
+            cell.note = XMIT_NOTE_NONE;
+            bool has_volume = false;
+            uint8_t volume = 0;
+
+            if (mask & 0x01) {
+                if (pos >= size) return;
+                uint8_t note = src[pos++];
+                if (note < XMIT_NUM_NOTES) prev->note = note;
+                else if (note == 255) prev->note = XMIT_NOTE_OFF;
+                else if (note == 254) prev->note = XMIT_NOTE_CUT;
+                else prev->note = XMIT_NOTE_FADE;
+                cell.note = prev->note;
+            }
+            if (mask & 0x02) {
+                if (pos >= size) return;
+                prev->instrument = src[pos++];
+                cell.instrument = prev->instrument;
+            }
+            if (mask & 0x04) {
+                if (pos >= size) return;
+                last_volume[c] = src[pos++];
+                has_volume = true;
+                volume = last_volume[c];
+            }
+            if (mask & 0x08) {
+                if (pos + 2 > size) return;
+                prev->effect = src[pos] <= 26 ? src[pos] : 0;
+                prev->param = src[pos + 1];
+                pos += 2;
+                cell.effect = prev->effect;
+                cell.param = prev->param;
+            }
+            if (mask & 0x10) cell.note = prev->note;
+            if (mask & 0x20) cell.instrument = prev->instrument;
+            if (mask & 0x40) {
+                has_volume = true;
+                volume = last_volume[c];
+            }
+            if (mask & 0x80) {
+                cell.effect = prev->effect;
+                cell.param = prev->param;
+            }
+            if (has_volume) convert_it_volume(&cell, volume);
+
+            if (max_channel && c + 1 > *max_channel) *max_channel = (uint8_t)(c + 1);
+            if (cells && c < num_channels) cells[row * num_channels + c] = cell;
+        }
+    }
+}
+
+// IT envelope: flags, count, loop and sustain points, 25 nodes of (value, tick)
+static void read_it_envelope(XmitEnvelope* env, const uint8_t* src, bool panning) {
+    memset(env, 0, sizeof(*env));
+
+    uint8_t flags = src[0];
+    uint8_t num_points = src[1];
+    if (num_points > XMIT_ENV_POINTS) num_points = XMIT_ENV_POINTS;
+    if (num_points < 1) return;
+
+    for (uint8_t i = 0; i < num_points; i++) {
+        int value = (int8_t)src[6 + i * 3];
+        if (panning) {
+            if (value < -32) value = -32;
+            if (value > 32) value = 32;
+        } else if (value > 64) {
+            value = 64;
+        } else if (value < 0) {
+            value = 0;
+        }
+        env->value[i] = (int8_t)value;
+        env->tick[i] = read16(src + 7 + i * 3);
+        if (i > 0 && env->tick[i] < env->tick[i - 1]) env->tick[i] = env->tick[i - 1];
+    }
+    env->num_points = num_points;
+
+    if (flags & 0x01) env->flags |= XMIT_ENV_ENABLED;
+    if ((flags & 0x02) && src[2] <= src[3] && src[3] < num_points) {
+        env->flags |= XMIT_ENV_LOOP;
+        env->loop_start = src[2];
+        env->loop_end = src[3];
+    }
+    if ((flags & 0x04) && src[4] <= src[5] && src[5] < num_points) {
+        env->flags |= XMIT_ENV_SUSTAIN;
+        env->sustain_start = src[4];
+        env->sustain_end = src[5];
+    }
+}
+
+static void read_it_keyboard(XmitInstrument* ins, const uint8_t* table, uint16_t num_samples) {
+    for (int n = 0; n < XMIT_NUM_NOTES; n++) {
+        uint8_t note = table[n * 2];
+        uint8_t sample = table[n * 2 + 1];
+        ins->note[n] = note < XMIT_NUM_NOTES ? note : (uint8_t)n;
+        ins->sample[n] = sample <= num_samples ? sample : 0;
+    }
+}
+
+// Instruments from IT 2.00 and later
+static void read_it_instrument(XmitInstrument* ins, const uint8_t* ih, uint16_t num_samples) {
+    ins->nna = ih[0x11] <= XMIT_NNA_FADE ? ih[0x11] : XMIT_NNA_CUT;
+    ins->dct = ih[0x12] <= XMIT_DCT_INSTRUMENT ? ih[0x12] : XMIT_DCT_OFF;
+    ins->dca = ih[0x13] <= XMIT_DCA_FADE ? ih[0x13] : XMIT_DCA_CUT;
+    uint32_t fadeout = read16(ih + 0x14);
+    ins->fadeout = fadeout > 1024 ? 65536 : fadeout * 64;
+    ins->global_volume = ih[0x18] > 128 ? 128 : ih[0x18];
+    ins->panning = (ih[0x19] & 0x80) ? -1 : (int16_t)((ih[0x19] > 64 ? 64 : ih[0x19]) * 4);
+
+    read_it_keyboard(ins, ih + 0x40, num_samples);
+    read_it_envelope(&ins->volume_envelope, ih + 0x130, false);
+    read_it_envelope(&ins->panning_envelope, ih + 0x182, true);
+}
+
+// Instruments from IT 1.x: volume envelope only, as (tick, value) pairs
+static void read_it_old_instrument(XmitInstrument* ins, const uint8_t* ih, uint16_t num_samples) {
+    uint8_t flags = ih[0x11];
+    ins->nna = ih[0x1A] <= XMIT_NNA_FADE ? ih[0x1A] : XMIT_NNA_CUT;
+    ins->dct = ih[0x1B] ? XMIT_DCT_NOTE : XMIT_DCT_OFF;
+    ins->dca = XMIT_DCA_CUT;
+    uint32_t fadeout = read16(ih + 0x18);
+    ins->fadeout = fadeout > 512 ? 65536 : fadeout * 128;
+    ins->global_volume = 128;
+    ins->panning = -1;
+
+    read_it_keyboard(ins, ih + 0x40, num_samples);
+
+    XmitEnvelope* env = &ins->volume_envelope;
+    memset(env, 0, sizeof(*env));
+    for (int i = 0; i < XMIT_ENV_POINTS; i++) {
+        uint8_t tick = ih[0x1F8 + i * 2];
+        uint8_t value = ih[0x1F9 + i * 2];
+        if (tick == 0xFF) break;
+        env->tick[i] = tick;
+        env->value[i] = (int8_t)(value > 64 ? 64 : value);
+        if (i > 0 && env->tick[i] < env->tick[i - 1]) env->tick[i] = env->tick[i - 1];
+        env->num_points++;
+    }
+    if ((flags & 0x01) && env->num_points > 0) env->flags |= XMIT_ENV_ENABLED;
+    if ((flags & 0x02) && ih[0x12] <= ih[0x13] && ih[0x13] < env->num_points) {
+        env->flags |= XMIT_ENV_LOOP;
+        env->loop_start = ih[0x12];
+        env->loop_end = ih[0x13];
+    }
+    if ((flags & 0x04) && ih[0x14] <= ih[0x15] && ih[0x15] < env->num_points) {
+        env->flags |= XMIT_ENV_SUSTAIN;
+        env->sustain_start = ih[0x14];
+        env->sustain_end = ih[0x15];
+    }
+}
+
+static void read_it_sample(XmitSample* sample, const uint8_t* data, size_t size, size_t offset) {
+    sample->c5speed = 8363;
+    sample->global_volume = 64;
+    sample->panning = -1;
+
+    if (offset + 0x50 > size || memcmp(data + offset, "IMPS", 4) != 0) return;
+    const uint8_t* sh = data + offset;
+
+    uint8_t flags = sh[0x12];
+    uint8_t convert = sh[0x2E];
+    sample->global_volume = sh[0x11] > 64 ? 64 : sh[0x11];
+    sample->volume = sh[0x13] > 64 ? 64 : sh[0x13];
+    sample->panning = (sh[0x2F] & 0x80) ? (int16_t)(((sh[0x2F] & 0x7F) > 64 ? 64 : (sh[0x2F] & 0x7F)) * 4) : -1;
+    sample->length = read32(sh + 0x30);
+    sample->loop_start = read32(sh + 0x34);
+    sample->loop_end = read32(sh + 0x38);
+    sample->loop = (flags & 0x10) != 0;
+    sample->sustain_start = read32(sh + 0x40);
+    sample->sustain_end = read32(sh + 0x44);
+    sample->sustain_loop = (flags & 0x20) != 0;
+    sample->is_16bit = (flags & 0x02) != 0;
+    if (read32(sh + 0x3C) > 0) sample->c5speed = read32(sh + 0x3C);
+    sample->vibrato_rate = sh[0x4C];
+    sample->vibrato_depth = sh[0x4D];
+    sample->vibrato_sweep = sh[0x4E];
+    sample->vibrato_type = sh[0x4F] <= XMIT_WAVE_RANDOM ? sh[0x4F] : XMIT_WAVE_SINE;
+
+    size_t data_offset = read32(sh + 0x48);
+    bool stereo = (flags & 0x04) != 0;
+    if (!(flags & 0x01) || sample->length == 0 || sample->length > 0x10000000 || data_offset >= size) {
+        sample->length = 0;
+        return;
+    }
+
+    void* pcm;
+    if (flags & 0x08) {
+        pcm = calloc(sample->length, sample->is_16bit ? 2 : 1);
+        if (pcm) {
+            bool it215 = (convert & 0x04) != 0;
+            size_t used = decompress_it(data + data_offset, size - data_offset, pcm,
+                                        sample->length, sample->is_16bit, it215, false);
+            if (stereo && data_offset + used < size) {
+                halve_samples(pcm, sample->length, sample->is_16bit);
+                decompress_it(data + data_offset + used, size - data_offset - used, pcm,
+                              sample->length, sample->is_16bit, it215, true);
+            }
+        }
+    } else {
+        sample->length = clamp_sample_length(sample->length, size - data_offset, sample->is_16bit);
+        pcm = decode_pcm(data + data_offset, size - data_offset, sample->length,
+                         sample->is_16bit, (convert & 0x01) != 0, stereo, (convert & 0x04) != 0);
+    }
+
+    check_loops(sample);
+    if (!set_sample_data(sample, pcm, (flags & 0x40) != 0)) sample->length = 0;
+}
+
+bool xmit_load_it(XmitModule* module, const uint8_t* data, size_t size) {
+    if (!xmit_detect_it(data, size)) return false;
+
+    begin_module(module, XMIT_FORMAT_IT);
+    copy_title(module->title, data + 4, 26);
+
+    uint16_t num_orders = read16(data + 0x20);
+    uint16_t num_instruments = read16(data + 0x22);
+    uint16_t num_samples = read16(data + 0x24);
+    uint16_t num_patterns = read16(data + 0x26);
+    uint16_t compatible = read16(data + 0x2A);
+    uint16_t flags = read16(data + 0x2C);
+
+    if (num_patterns > XMIT_MAX_PATTERNS || num_instruments > XMIT_MAX_INSTRUMENTS ||
+        num_samples > XMIT_MAX_INSTRUMENTS) {
+        return false;
+    }
+
+    size_t instruments_offset = 0xC0 + (size_t)num_orders;
+    size_t samples_offset = instruments_offset + (size_t)num_instruments * 4;
+    size_t patterns_offset = samples_offset + (size_t)num_samples * 4;
+    if (patterns_offset + (size_t)num_patterns * 4 > size) return false;
+
+    module->flags.linear_slides = (flags & 0x08) != 0;
+    module->flags.old_effects = (flags & 0x10) != 0;
+    module->flags.compat_gxx = (flags & 0x20) != 0;
+    module->initial_global_volume = data[0x30] > 128 ? 128 : data[0x30];
+    if (data[0x32] > 0) module->initial_speed = data[0x32];
+    if (data[0x33] >= 32) module->initial_tempo = data[0x33];
+
+    bool stereo = (flags & 0x01) != 0;
+    for (int c = 0; c < XMIT_MAX_CHANNELS; c++) {
+        uint8_t pan = data[0x40 + c];
+        uint8_t volume = data[0x80 + c];
+        module->channel_muted[c] = (pan & 0x80) != 0;
+        pan &= 0x7F;
+        module->channel_pan[c] = (stereo && pan <= 64) ? (uint16_t)(pan * 4) : 128;  // 100 = surround
+        module->channel_volume[c] = volume > 64 ? 64 : volume;
+    }
+
+    // Orders (254 = marker, 255 = end)
+    for (uint16_t i = 0; i < num_orders && module->num_orders < XMIT_MAX_ORDERS; i++) {
+        uint8_t pattern = data[0xC0 + i];
+        if (pattern == 255) break;
+        if (pattern < num_patterns) module->orders[module->num_orders++] = pattern;
+    }
+
+    // Samples
+    if (num_samples > 0) {
+        module->samples = (XmitSample*)calloc(num_samples, sizeof(XmitSample));
+        if (!module->samples) {
+            xmit_module_free(module);
+            return false;
+        }
+    }
+    module->num_samples = num_samples;
+    for (uint16_t i = 0; i < num_samples; i++) {
+        read_it_sample(&module->samples[i], data, size, read32(data + samples_offset + i * 4));
+    }
+
+    // Instruments, or one per sample in sample mode
+    bool ok;
+    if ((flags & 0x04) && num_instruments > 0) {
+        module->num_instruments = num_instruments;
+        module->instruments = (XmitInstrument*)calloc(num_instruments, sizeof(XmitInstrument));
+        ok = module->instruments != NULL;
+
+        for (uint16_t i = 0; ok && i < num_instruments; i++) {
+            XmitInstrument* ins = &module->instruments[i];
+            size_t offset = read32(data + instruments_offset + i * 4);
+            ins->global_volume = 128;
+            ins->panning = -1;
+
+            if (compatible >= 0x200 && offset + 0x226 <= size && memcmp(data + offset, "IMPI", 4) == 0) {
+                read_it_instrument(ins, data + offset, num_samples);
+            } else if (compatible < 0x200 && offset + 0x22A <= size && memcmp(data + offset, "IMPI", 4) == 0) {
+                read_it_old_instrument(ins, data + offset, num_samples);
+            } else {
+                for (int n = 0; n < XMIT_NUM_NOTES; n++) ins->note[n] = (uint8_t)n;
+            }
+        }
+    } else {
+        ok = instruments_from_samples(module);
+    }
+    if (!ok) {
+        xmit_module_free(module);
+        return false;
+    }
+
+    // Channels in use
+    uint8_t max_channel = 1;
+    for (uint16_t p = 0; p < num_patterns; p++) {
+        size_t offset = read32(data + patterns_offset + p * 4);
+        if (offset == 0 || offset + 8 > size) continue;
+        size_t length = read16(data + offset);
+        size_t avail = size - offset - 8;
+        decode_it_pattern(data + offset + 8, length < avail ? length : avail,
+                          read16(data + offset + 2), NULL, 0, &max_channel);
+    }
+    module->num_channels = max_channel;
+
+    // Patterns
+    module->num_patterns = num_patterns;
+    for (uint16_t p = 0; p < num_patterns; p++) {
+        size_t offset = read32(data + patterns_offset + p * 4);
+        uint16_t rows = 64;
+        if (offset != 0 && offset + 8 <= size) {
+            rows = read16(data + offset + 2);
+            if (rows == 0 || rows > XMIT_MAX_ROWS) rows = 64;
+        }
+
+        if (!alloc_pattern(&module->patterns[p], rows, module->num_channels)) {
+            xmit_module_free(module);
+            return false;
+        }
+        if (offset == 0 || offset + 8 > size) continue;
+
+        size_t length = read16(data + offset);
+        size_t avail = size - offset - 8;
+        decode_it_pattern(data + offset + 8, length < avail ? length : avail, rows,
+                          module->patterns[p].cells, module->num_channels, NULL);
+    }
+
+    return true;
+}
@@ -0,0 +1,204 @@
+/*
+ * XM/S3M/IT Module Data (internal to xmit_player.c and xmit_loader.c)
+ *
+ * The three formats are loaded into one Impulse Tracker style layout:
+ * - Notes 0-119 with C-5 = 60 playing a sample at its c5speed
+ * - Effects as IT letters (S3M uses the same ones, XM effects are
+ *   translated), plus a few XM-only effects with their own codes
+ * - A common volume column command set
+ * - Every module has instruments; XM/S3M samples and IT "sample mode"
+ *   files get one instrument per sample
+ * - Samples are 8-bit or 16-bit mono, signed, with ping-pong loops unrolled
+ *   into forward loops
+ */
+
+#ifndef XMIT_MODULE_H
+#define XMIT_MODULE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "xmit_player.h"
+
+#define XMIT_NUM_NOTES 120
+#define XMIT_MAX_ORDERS 256
+#define XMIT_MAX_PATTERNS 256
+#define XMIT_MAX_INSTRUMENTS 255
+#define XMIT_MAX_SAMPLES 4096
+#define XMIT_MAX_ROWS 256
+#define XMIT_ENV_POINTS 25
+
+// Special note values
+#define XMIT_NOTE_NONE 0xFF
+#define XMIT_NOTE_OFF 0xFE     // Release (XM key off, IT ===)
+#define XMIT_NOTE_CUT 0xFD     // Cut (S3M/IT ^^^)
+#define XMIT_NOTE_FADE 0xFC    // Fade out (IT ~~~)
+
+// Effects: IT letters A-Z are 1-26
+enum {
+    XMIT_FX_NONE = 0,
+    XMIT_FX_SPEED = 1,          // Axx
+    XMIT_FX_JUMP,               // Bxx
+    XMIT_FX_BREAK,              // Cxx
+    XMIT_FX_VOLUME_SLIDE,       // Dxy
+    XMIT_FX_PORTA_DOWN,         // Exx
+    XMIT_FX_PORTA_UP,           // Fxx
+    XMIT_FX_TONE_PORTA,         // Gxx
+    XMIT_FX_VIBRATO,            // Hxy
+    XMIT_FX_TREMOR,             // Ixy
+    XMIT_FX_ARPEGGIO,           // Jxy
+    XMIT_FX_VIBRATO_VOLUME,     // Kxy
+    XMIT_FX_PORTA_VOLUME,       // Lxy
+    XMIT_FX_CHANNEL_VOLUME,     // Mxx
+    XMIT_FX_CHANNEL_VOLUME_SLIDE, // Nxy
+    XMIT_FX_OFFSET,             // Oxx
+    XMIT_FX_PAN_SLIDE,          // Pxy
+    XMIT_FX_RETRIGGER,          // Qxy
+    XMIT_FX_TREMOLO,            // Rxy
+    XMIT_FX_EXTENDED,           // Sxy
+    XMIT_FX_TEMPO,              // Txx
+    XMIT_FX_FINE_VIBRATO,       // Uxy
+    XMIT_FX_GLOBAL_VOLUME,      // Vxx
+    XMIT_FX_GLOBAL_VOLUME_SLIDE, // Wxy
+    XMIT_FX_PAN,                // Xxx
+    XMIT_FX_PANBRELLO,          // Yxy
+    XMIT_FX_MIDI,               // Zxx (ignored)
+
+    // XM only
+    XMIT_FX_XM_VOLUME,          // Cxx (0-64)
+    XMIT_FX_XM_KEY_OFF,         // Kxx (release at tick xx)
+    XMIT_FX_XM_ENV_POSITION     // Lxx
+};
+
+// Volume column
+enum {
+    XMIT_VOL_NONE = 0,
+    XMIT_VOL_SET,               // 0-64
+    XMIT_VOL_PAN,               // 0-64
+    XMIT_VOL_SLIDE_UP,
+    XMIT_VOL_SLIDE_DOWN,
+    XMIT_VOL_FINE_UP,
+    XMIT_VOL_FINE_DOWN,
+    XMIT_VOL_PORTA_UP,          // IT: param * 4 like Fxx
+    XMIT_VOL_PORTA_DOWN,
+    XMIT_VOL_TONE_PORTA,        // Param is the Gxx speed
+    XMIT_VOL_VIBRATO_SPEED,
+    XMIT_VOL_VIBRATO_DEPTH,
+    XMIT_VOL_PAN_SLIDE_LEFT,
+    XMIT_VOL_PAN_SLIDE_RIGHT
+};
+
+typedef struct {
+    uint8_t note;           // 0-119, XMIT_NOTE_* or XMIT_NOTE_NONE
+    uint8_t instrument;     // 1-based, 0 = none
+    uint8_t volcmd;         // XMIT_VOL_*
+    uint8_t volparam;
+    uint8_t effect;         // XMIT_FX_*
+    uint8_t param;
+} XmitCell;
+
+typedef struct {
+    uint16_t rows;
+    XmitCell* cells;        // [rows][num_channels], NULL = empty pattern
+} XmitPattern;
+
+// Envelope flags
+#define XMIT_ENV_ENABLED 0x01
+#define XMIT_ENV_LOOP 0x02
+#define XMIT_ENV_SUSTAIN 0x04
+
+typedef struct {
+    uint16_t tick[XMIT_ENV_POINTS];
+    int8_t value[XMIT_ENV_POINTS];  // Volume 0-64, panning -32..32
+    uint8_t num_points;
+    uint8_t flags;
+    uint8_t loop_start, loop_end;
+    uint8_t sustain_start, sustain_end;
+} XmitEnvelope;
+
+// New note actions (IT instrument NNA / S73-S76)
+enum {
+    XMIT_NNA_CUT = 0,
+    XMIT_NNA_CONTINUE,
+    XMIT_NNA_OFF,
+    XMIT_NNA_FADE
+};
+
+// Duplicate check type and action
+enum { XMIT_DCT_OFF = 0, XMIT_DCT_NOTE, XMIT_DCT_SAMPLE, XMIT_DCT_INSTRUMENT };
+enum { XMIT_DCA_CUT = 0, XMIT_DCA_OFF, XMIT_DCA_FADE };
+
+typedef struct {
+    uint16_t sample[XMIT_NUM_NOTES];    // 1-based sample per note, 0 = none
+    uint8_t note[XMIT_NUM_NOTES];       // Note actually played
+    XmitEnvelope volume_envelope;
+    XmitEnvelope panning_envelope;
+    uint32_t fadeout;           // Subtracted from 65536 each tick after release
+    uint8_t global_volume;      // 0-128
+    int16_t panning;            // 0-256 or -1 = not set
+    uint8_t nna, dct, dca;
+} XmitInstrument;
+
+// Auto-vibrato waveforms (IT order, then FT2's ramp up)
+enum { XMIT_WAVE_SINE = 0, XMIT_WAVE_RAMP_DOWN, XMIT_WAVE_SQUARE, XMIT_WAVE_RANDOM, XMIT_WAVE_RAMP_UP };
+
+typedef struct {
+    const void* data;           // int8_t or int16_t (owned)
+    uint32_t length;            // In samples
+    uint32_t loop_start, loop_end;
+    uint32_t sustain_start, sustain_end;
+    bool loop, sustain_loop;
+    bool is_16bit;
+    uint32_t c5speed;           // Hz at C-5
+    uint8_t volume;             // 0-64
+    uint8_t global_volume;      // 0-64
+    int16_t panning;            // 0-256 or -1 = not set
+    uint8_t vibrato_type, vibrato_sweep, vibrato_depth, vibrato_rate;
+} XmitSample;
+
+// Format behaviour switches
+typedef struct {
+    bool linear_slides;         // Linear frequency table (else Amiga periods)
+    bool old_effects;           // IT "old effects" flag
+    bool compat_gxx;            // IT: Gxx does not share memory with E/F
+    bool shared_effect_memory;  // S3M: one last parameter for most effects
+    bool key_off_cut;           // XM: key off without a volume envelope cuts the note
+} XmitFlags;
+
+typedef struct {
+    XmitFormat format;
+    char title[XMIT_TITLE_LENGTH + 1];
+    XmitFlags flags;
+
+    uint8_t num_channels;
+    uint16_t channel_pan[XMIT_MAX_CHANNELS];    // 0-256
+    uint8_t channel_volume[XMIT_MAX_CHANNELS];  // 0-64
+    bool channel_muted[XMIT_MAX_CHANNELS];      // Disabled in the file
+
+    uint16_t orders[XMIT_MAX_ORDERS];
+    uint16_t num_orders;
+    uint16_t restart_order;
+
+    XmitPattern patterns[XMIT_MAX_PATTERNS];
+    uint16_t num_patterns;
+
+    XmitInstrument* instruments;    // [num_instruments]
+    uint16_t num_instruments;
+    XmitSample* samples;            // [num_samples]
+    uint16_t num_samples;
+
+    uint8_t initial_speed;
+    uint8_t initial_tempo;
+    uint8_t initial_global_volume;  // 0-128
+} XmitModule;
+
+// Loaders (xmit_loader.c); each frees the previous contents first
+bool xmit_detect_xm(const uint8_t* data, size_t size);
+bool xmit_detect_s3m(const uint8_t* data, size_t size);
+bool xmit_detect_it(const uint8_t* data, size_t size);
+bool xmit_load_xm(XmitModule* module, const uint8_t* data, size_t size);
+bool xmit_load_s3m(XmitModule* module, const uint8_t* data, size_t size);
+bool xmit_load_it(XmitModule* module, const uint8_t* data, size_t size);
+void xmit_module_free(XmitModule* module);
+
+#endif // XMIT_MODULE_H
@@ -0,0 +1,1692 @@
+#include "xmit_player.h"
+#include "xmit_module.h"
+#include "tracker_mixer.h"
+#include "pattern_sequencer.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Notes moved off their channel by new note actions play on in a pool of
+// virtual voices (as many as Impulse Tracker has)
+#define XMIT_VIRTUAL_VOICES 256
+
+// Amiga periods are stored x4 (C-5 at 8363 Hz = 1712)
+#define XMIT_AMIGA_CLOCK 14317456.0
+
+// Linear periods are in 1/64 semitones (C-5 = 3840)
+#define XMIT_LINEAR_C5 3840
+
+#define XMIT_NO_TICK 0xFF
+
+// Sine for vibrato/tremolo/panbrello (64 steps, -64 to 64)
+static const int8_t sine_table[64] = {
+     0,   6,  12,  19,  24,  30,  36,  41,  45,  49,  53,  56,  59,  61,  63,  64,
+    64,  64,  63,  61,  59,  56,  53,  49,  45,  41,  36,  30,  24,  19,  12,   6,
+     0,  -6, -12, -19, -24, -30, -36, -41, -45, -49, -53, -56, -59, -61, -63, -64,
+   -64, -64, -63, -61, -59, -56, -53, -49, -45, -41, -36, -30, -24, -19, -12,  -6
+};
+
+// Playing sample. Channel c plays in voices[c]; new note actions move the
+// note to a virtual voice in the background pool that plays on by itself.
+typedef struct {
+    TrackerMixerVoice mix;      // Sample, channel and the gain/panning of the last tick
+    bool active;
+    uint8_t note;               // Pattern note (for duplicate checks)
+    uint16_t instrument;        // 1-based
+    uint16_t sample;            // 1-based
+
+    bool released;              // Key off: envelope sustain and sustain loop end
+    bool fading;
+    int32_t fade_volume;        // 0-65536
+    bool volume_env_on;
+    bool panning_env_on;
+    uint16_t volume_env_pos;    // Envelope position in ticks
+    uint16_t panning_env_pos;
+    uint16_t autovib_pos;
+    int32_t autovib_depth;      // 8.8
+
+    // Set by the channel each tick while in the foreground
+    int32_t period;             // Including vibrato
+    int32_t pitch_shift;        // Arpeggio in 1/64 semitones
+    int16_t volume;             // 0-64 including tremolo/tremor
+    int16_t channel_volume;     // 0-64
+    int16_t panning;            // 0-256 including panbrello
+} XmitVoice;
+
+typedef struct {
+    XmitCell cell;              // Row being played
+    uint8_t effect;             // With memory applied
+    uint8_t param;
+
+    uint8_t note;               // Last note (0-119)
+    uint16_t instrument;        // Last instrument (1-based)
+    int32_t period;
+    int32_t target_period;      // Tone portamento
+    int16_t volume;             // 0-64
+    int16_t channel_volume;     // 0-64
+    int16_t panning;            // 0-256
+
+    // Effect memory
+    uint8_t mem_volume_slide;
+    uint8_t mem_channel_volume_slide;
+    uint8_t mem_global_volume_slide;
+    uint8_t mem_porta;          // IT E/F (and G unless compatible Gxx)
+    uint8_t mem_porta_up;       // XM 1xx
+    uint8_t mem_porta_down;     // XM 2xx
+    uint8_t mem_tone_porta;
+    uint8_t mem_offset;
+    uint8_t offset_high;        // SAx
+    uint8_t mem_pan_slide;
+    uint8_t mem_retrigger;
+    uint8_t mem_tremor;
+    uint8_t mem_arpeggio;
+    uint8_t mem_tempo;
+    uint8_t mem_extended;
+    uint8_t mem_shared;         // S3M: one memory for most effects
+
+    // Modulation
+    uint8_t vibrato_pos, vibrato_speed, vibrato_depth, vibrato_wave;
+    bool fine_vibrato;
+    uint8_t tremolo_pos, tremolo_speed, tremolo_depth, tremolo_wave;
+    uint8_t panbrello_pos, panbrello_speed, panbrello_depth, panbrello_wave;
+    int32_t vibrato_offset;     // Period offset
+    int16_t tremolo_offset;
+    int16_t panbrello_offset;
+    int8_t arpeggio;            // Semitones
+    uint8_t tremor_count;
+    bool tremor_off;
+    uint8_t retrigger_count;
+
+    // Tick events this row (XMIT_NO_TICK = none)
+    uint8_t cut_tick;
+    uint8_t delay_tick;
+    uint8_t key_off_tick;
+
+    // Pattern loop (SBx)
+    uint16_t loop_row;
+    uint8_t loop_count;
+
+    uint8_t nna_override;       // 0xFF = instrument's NNA
+
+    // User controls
+    bool muted;
+    float user_volume;
+} XmitChannel;
+
+struct XmitPlayer {
+    XmitModule module;
+
+    // Pattern sequencer (timing, order and pattern flow)
+    PatternSequencer* sequencer;
+
+    // Playback state
+    bool playing;
+    uint16_t row;               // Row being played
+    uint16_t tick;              // Ticks since the row started
+    uint8_t speed;
+    uint8_t tempo;
+    uint8_t global_volume;      // 0-128
+    uint32_t random;
+    uint32_t sample_rate;
+
+    // Sequencer events during the current span
+    bool tick_pending;
+    bool row_started;
+
+    // Flow effects of the current row
+    int32_t jump_order;
+    int32_t break_row;
+    int32_t loop_jump_row;
+
+    // Loop control
+    uint16_t loop_start;
+    uint16_t loop_end;
+    bool disable_looping;
+
+    // Position callback
+    XmitPlayerPositionCallback position_callback;
+    void* callback_user_data;
+
+    XmitChannel channels[XMIT_MAX_CHANNELS];
+    XmitVoice voices[XMIT_MAX_CHANNELS];
+    TrackerVoicePool* background;   // XmitVoices
+
+    TrackerInterpolation interpolation;
+};
+
+// Pattern sequencer callbacks
+static void xmit_on_tick(void* user_data, uint8_t tick);
+static void xmit_on_row(void* user_data, uint16_t pattern_index,
+                        uint16_t pattern_number, uint16_t row);
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static const XmitInstrument* get_instrument(const XmitPlayer* player, uint16_t number) {
+    if (number == 0 || number > player->module.num_instruments) return NULL;
+    return &player->module.instruments[number - 1];
+}
+
+static const XmitSample* get_sample(const XmitPlayer* player, uint16_t number) {
+    if (number == 0 || number > player->module.num_samples) return NULL;
+    const XmitSample* sample = &player->module.samples[number - 1];
+    return (sample->data && sample->length > 0) ? sample : NULL;
+}
+
+static int32_t clamp32(int32_t value, int32_t min, int32_t max) {
+    return value < min ? min : (value > max ? max : value);
+}
+
+static int32_t note_period(const XmitPlayer* player, uint8_t note, uint32_t c5speed) {
+    if (player->module.flags.linear_slides) {
+        return XMIT_LINEAR_C5 - ((int32_t)note - 60) * 64;
+    }
+    if (c5speed == 0) return 0;
+    return (int32_t)(XMIT_AMIGA_CLOCK / (c5speed * pow(2.0, (note - 60) / 12.0)) + 0.5);
+}
+
+// Keep slid periods in a range that still plays
+static int32_t clamp_period(const XmitPlayer* player, int32_t period) {
+    if (player->module.flags.linear_slides) return clamp32(period, 0, XMIT_LINEAR_C5 * 3);
+    return clamp32(period, 28, 0xFFFFF);
+}
+
+static int wave_value(XmitPlayer* player, uint8_t type, uint8_t pos) {
+    pos &= 63;
+    switch (type) {
+        case XMIT_WAVE_RAMP_DOWN: return 64 - pos * 2;
+        case XMIT_WAVE_SQUARE: return pos < 32 ? 64 : -64;
+        case XMIT_WAVE_RANDOM:
+            player->random = player->random * 1103515245u + 12345u;
+            return (int)((player->random >> 16) & 127) - 64;
+        case XMIT_WAVE_RAMP_UP: return pos * 2 - 64;
+        default: return sine_table[pos];
+    }
+}
+
+static void trigger_position_callback(XmitPlayer* player, uint16_t order, uint16_t pattern, uint16_t row) {
+    if (player->position_callback) {
+        player->position_callback(order, pattern, row, player->callback_user_data);
+    }
+}
+
+// ============================================================================
+// Voices
+// ============================================================================
+
+// Select the sustain loop until release, then the normal loop
+static void voice_apply_loop(XmitVoice* voice, const XmitSample* sample) {
+    uint32_t bytes = sample->is_16bit ? 2 : 1;
+    TrackerVoice* playback = &voice->mix.playback;
+
+    if (sample->sustain_loop && !voice->released) {
+        tracker_voice_set_loop(playback, sample->sustain_start * bytes,
+                               (sample->sustain_end - sample->sustain_start) * bytes, 0);
+    } else if (sample->loop) {
+        tracker_voice_set_loop(playback, sample->loop_start * bytes,
+                               (sample->loop_end - sample->loop_start) * bytes, 0);
+    } else {
+        tracker_voice_set_loop(playback, 0, 0, 0);
+    }
+
+    // A position past the new loop end wraps into it
+    if (playback->loop_enabled && playback->sample_pos >= playback->loop_end) {
+        uint64_t loop_length = playback->loop_end - playback->loop_start;
+        playback->sample_pos = playback->loop_start +
+                               (playback->sample_pos - playback->loop_start) % loop_length;
+    }
+}
+
+static void voice_start(XmitPlayer* player, XmitVoice* voice, uint8_t channel,
+                        uint8_t note, uint16_t instrument, uint16_t sample_number) {
+    const XmitSample* sample = get_sample(player, sample_number);
+    const XmitInstrument* ins = get_instrument(player, instrument);
+
+    voice->active = sample != NULL;
+    if (!sample) return;
+
+    voice->mix.channel = channel;
+    voice->note = note;
+    voice->instrument = instrument;
+    voice->sample = sample_number;
+    voice->released = false;
+    voice->fading = false;
+    voice->fade_volume = 65536;
+    voice->volume_env_on = ins && (ins->volume_envelope.flags & XMIT_ENV_ENABLED);
+    voice->panning_env_on = ins && (ins->panning_envelope.flags & XMIT_ENV_ENABLED);
+    voice->volume_env_pos = 0;
+    voice->panning_env_pos = 0;
+    voice->autovib_pos = 0;
+    voice->autovib_depth = 0;
+
+    if (sample->is_16bit) {
+        tracker_voice_set_waveform_16bit(&voice->mix.playback, (const int16_t*)sample->data, sample->length);
+    } else {
+        tracker_voice_set_waveform(&voice->mix.playback, (const int8_t*)sample->data, sample->length);
+    }
+    tracker_voice_reset_position(&voice->mix.playback);
+    voice_apply_loop(voice, sample);
+}
+
+static void voice_release(XmitPlayer* player, XmitVoice* voice) {
+    if (!voice->active || voice->released) return;
+    voice->released = true;
+
+    const XmitSample* sample = get_sample(player, voice->sample);
+    if (sample && sample->sustain_loop) voice_apply_loop(voice, sample);
+
+    // XM fades out from key off; IT fades at once without a volume envelope
+    // or with a looping one, otherwise when the envelope ends
+    const XmitInstrument* ins = get_instrument(player, voice->instrument);
+    if (player->module.format == XMIT_FORMAT_XM) {
+        voice->fading = voice->volume_env_on;
+    } else if (!voice->volume_env_on || !ins || (ins->volume_envelope.flags & XMIT_ENV_LOOP)) {
+        voice->fading = true;
+    }
+}
+
+// Apply a new note / duplicate check action to a voice
+static void voice_note_action(XmitPlayer* player, XmitVoice* voice, uint8_t action) {
+    switch (action) {
+        case XMIT_NNA_CUT: voice->active = false; break;
+        case XMIT_NNA_OFF: voice_release(player, voice); break;
+        case XMIT_NNA_FADE: voice->fading = true; break;
+        default: break;
+    }
+}
+
+static int envelope_value(const XmitEnvelope* env, uint16_t pos) {
+    if (env->num_points == 0) return 0;
+
+    uint8_t last = env->num_points - 1;
+    if (pos >= env->tick[last]) return env->value[last];
+
+    for (uint8_t i = 0; i < last; i++) {
+        if (pos < env->tick[i + 1]) {
+            int t0 = env->tick[i];
+            int t1 = env->tick[i + 1];
+            if (pos <= t0 || t1 == t0) return env->value[i];
+            return env->value[i] + (env->value[i + 1] - env->value[i]) * ((int)pos - t0) / (t1 - t0);
+        }
+    }
+    return env->value[last];
+}
+
+// Advance an envelope by a tick
+// Returns true once it has passed its last point with no loop holding it
+static bool envelope_advance(const XmitEnvelope* env, uint16_t* pos, bool released) {
+    if (env->num_points == 0) return true;
+
+    (*pos)++;
+    bool sustained = (env->flags & XMIT_ENV_SUSTAIN) && !released;
+    if (sustained) {
+        if (*pos > env->tick[env->sustain_end]) *pos = env->tick[env->sustain_start];
+        return false;
+    }
+    if (env->flags & XMIT_ENV_LOOP) {
+        if (*pos > env->tick[env->loop_end]) *pos = env->tick[env->loop_start];
+        return false;
+    }
+
+    uint16_t end = env->tick[env->num_points - 1];
+    if (*pos >= end) {
+        *pos = end;
+        return true;
+    }
+    return false;
+}
+
+static void voice_update_delta(XmitPlayer* player, XmitVoice* voice) {
+    const XmitSample* sample = get_sample(player, voice->sample);
+    if (!sample || player->sample_rate == 0) {
+        tracker_voice_set_delta(&voice->mix.playback, 0);
+        return;
+    }
+
+    // Auto-vibrato, in 1/64 semitones like the pitch shift
+    int32_t shift = voice->pitch_shift;
+    if (sample->vibrato_depth > 0) {
+        int wave = wave_value(player, sample->vibrato_type, (uint8_t)(voice->autovib_pos >> 2));
+        shift += wave * (voice->autovib_depth >> 8) / 64;
+    }
+
+    double frequency;
+    if (player->module.flags.linear_slides) {
+        frequency = sample->c5speed * pow(2.0, (XMIT_LINEAR_C5 - voice->period + shift) / 768.0);
+    } else {
+        if (voice->period <= 0) {
+            tracker_voice_set_delta(&voice->mix.playback, 0);
+            return;
+        }
+        frequency = XMIT_AMIGA_CLOCK / voice->period;
+        if (shift != 0) frequency *= pow(2.0, shift / 768.0);
+    }
+
+    double delta = frequency * 65536.0 / player->sample_rate;
+    if (delta > 4294967295.0) delta = 4294967295.0;
+    tracker_voice_set_delta(&voice->mix.playback, (uint32_t)delta);
+}
+
+// Per-tick voice update: envelopes, fadeout and auto-vibrato, then the final
+// gain, panning and pitch
+static void voice_tick(XmitPlayer* player, XmitVoice* voice) {
+    const XmitInstrument* ins = get_instrument(player, voice->instrument);
+    const XmitSample* sample = get_sample(player, voice->sample);
+    if (!sample) {
+        voice->active = false;
+        return;
+    }
+
+    int volume_env = 64;
+    if (voice->volume_env_on && ins) {
+        volume_env = envelope_value(&ins->volume_envelope, voice->volume_env_pos);
+        bool ended = envelope_advance(&ins->volume_envelope, &voice->volume_env_pos, voice->released);
+        if (ended) {
+            if (volume_env == 0) {
+                voice->active = false;
+                return;
+            }
+            if (voice->released) voice->fading = true;
+        }
+    }
+
+    int panning = voice->panning;
+    if (voice->panning_env_on && ins) {
+        int env = envelope_value(&ins->panning_envelope, voice->panning_env_pos);
+        envelope_advance(&ins->panning_envelope, &voice->panning_env_pos, voice->released);
+        panning += env * (128 - abs(panning - 128)) / 32;
+    }
+
+    if (voice->fading) {
+        if (ins && ins->fadeout > 0) voice->fade_volume -= (int32_t)ins->fadeout;
+        if (voice->fade_volume <= 0) {
+            voice->active = false;
+            return;
+        }
+    }
+
+    if (sample->vibrato_depth > 0) {
+        int32_t full = (int32_t)sample->vibrato_depth << 8;
+        if (sample->vibrato_sweep == 0) {
+            voice->autovib_depth = full;
+        } else if (player->module.format == XMIT_FORMAT_XM) {
+            voice->autovib_depth += full / sample->vibrato_sweep;  // Sweep = ticks to full depth
+        } else {
+            voice->autovib_depth += sample->vibrato_sweep;
+        }
+        if (voice->autovib_depth > full) voice->autovib_depth = full;
+        voice->autovib_pos = (uint16_t)((voice->autovib_pos + sample->vibrato_rate) & 0xFF);
+    }
+
+    float gain = voice->volume / 64.0f;
+    gain *= voice->channel_volume / 64.0f;
+    gain *= volume_env / 64.0f;
+    gain *= voice->fade_volume / 65536.0f;
+    gain *= (ins ? ins->global_volume : 128) / 128.0f;
+    gain *= sample->global_volume / 64.0f;
+    gain *= player->global_volume / 128.0f;
+    voice->mix.gain = gain;
+    voice->mix.pan = (clamp32(panning, 0, 256) - 128) / 128.0f;
+
+    voice_update_delta(player, voice);
+}
+
+static XmitVoice* background_voice(const XmitPlayer* player, uint16_t index) {
+    return (XmitVoice*)tracker_voice_pool_get(player->background, index);
+}
+
+// Drop background voices that have been cut or have ended
+static void remove_stopped_voices(XmitPlayer* player) {
+    for (uint16_t i = tracker_voice_pool_get_count(player->background); i-- > 0; ) {
+        if (!background_voice(player, i)->active) tracker_voice_pool_remove(player->background, i);
+    }
+}
+
+// Before a new note on a channel: duplicate checks against the channel's
+// notes, then the new note action moves the current note to the background
+static void new_note_action(XmitPlayer* player, uint8_t channel, uint8_t note,
+                            uint16_t instrument, uint16_t sample) {
+    XmitChannel* chan = &player->channels[channel];
+    XmitVoice* current = &player->voices[channel];
+    const XmitInstrument* ins = get_instrument(player, instrument);
+
+    if (ins && ins->dct != XMIT_DCT_OFF) {
+        // The channel's background voices, then its current one
+        uint16_t count = tracker_voice_pool_get_count(player->background);
+        for (uint16_t i = 0; i <= count; i++) {
+            XmitVoice* voice = i < count ? background_voice(player, i) : current;
+            if (!voice->active || voice->mix.channel != channel || voice->instrument != instrument) continue;
+
+            bool duplicate = ins->dct == XMIT_DCT_INSTRUMENT ||
+                             (ins->dct == XMIT_DCT_NOTE && voice->note == note) ||
+                             (ins->dct == XMIT_DCT_SAMPLE && voice->sample == sample);
+            if (duplicate) {
+                uint8_t action = ins->dca == XMIT_DCA_OFF ? XMIT_NNA_OFF :
+                                 (ins->dca == XMIT_DCA_FADE ? XMIT_NNA_FADE : XMIT_NNA_CUT);
+                voice_note_action(player, voice, action);
+            }
+        }
+    }
+
+    if (current->active) {
+        const XmitInstrument* old = get_instrument(player, current->instrument);
+        uint8_t nna = chan->nna_override != 0xFF ? chan->nna_override : (old ? old->nna : XMIT_NNA_CUT);
+
+        if (nna != XMIT_NNA_CUT) {
+            XmitVoice* background = (XmitVoice*)tracker_voice_pool_add(player->background, current);
+            voice_note_action(player, background, nna);
+        }
+        current->active = false;
+    }
+    chan->nna_override = 0xFF;
+}
+
+// ============================================================================
+// Row processing
+// ============================================================================
+
+static bool is_tone_porta(const XmitCell* cell) {
+    return cell->effect == XMIT_FX_TONE_PORTA || cell->effect == XMIT_FX_PORTA_VOLUME ||
+           cell->volcmd == XMIT_VOL_TONE_PORTA;
+}
+
+// Volume and panning defaults of the sample a note plays
+static void reset_volume_panning(XmitPlayer* player, XmitChannel* chan,
+                                 const XmitInstrument* ins, const XmitSample* sample) {
+    chan->volume = sample->volume;
+    if (ins && ins->panning >= 0) chan->panning = ins->panning;
+    if (sample->panning >= 0) chan->panning = sample->panning;
+    (void)player;
+}
+
+// Note and instrument columns
+static void process_note(XmitPlayer* player, uint8_t channel, const XmitCell* cell) {
+    XmitChannel* chan = &player->channels[channel];
+    XmitVoice* voice = &player->voices[channel];
+
+    if (cell->instrument) chan->instrument = cell->instrument;
+    const XmitInstrument* ins = get_instrument(player, chan->instrument);
+
+    if (cell->note < XMIT_NUM_NOTES) {
+        if (!ins) return;
+
+        uint8_t note = cell->note;
+        uint16_t sample_number = ins->sample[note];
+        uint8_t played = ins->note[note];
+        const XmitSample* sample = get_sample(player, sample_number);
+
+        // Tone portamento slides the playing note to the new pitch
+        if (is_tone_porta(cell) && voice->active) {
+            const XmitSample* current = get_sample(player, voice->sample);
+            if (current) chan->target_period = note_period(player, played, current->c5speed);
+            chan->note = note;
+            if (cell->instrument && current) {
+                reset_volume_panning(player, chan, get_instrument(player, voice->instrument), current);
+            }
+            return;
+        }
+
+        new_note_action(player, channel, note, chan->instrument, sample_number);
+        if (!sample) return;
+
+        chan->note = note;
+        chan->period = chan->target_period = note_period(player, played, sample->c5speed);
+        if (cell->instrument) reset_volume_panning(player, chan, ins, sample);
+
+        voice_start(player, voice, channel, note, chan->instrument, sample_number);
+
+        if (chan->vibrato_wave < 4) chan->vibrato_pos = 0;
+        if (chan->tremolo_wave < 4) chan->tremolo_pos = 0;
+        chan->tremor_count = 0;
+        chan->tremor_off = false;
+
+        if (cell->effect == XMIT_FX_OFFSET) {
+            uint32_t offset = ((uint32_t)chan->offset_high << 16) | ((uint32_t)chan->mem_offset << 8);
+            if (offset >= sample->length) {
+                // Old effects / XM play from the end, IT ignores the offset
+                if (player->module.flags.old_effects || player->module.format != XMIT_FORMAT_IT) {
+                    offset = sample->length;
+                } else {
+                    offset = 0;
+                }
+            }
+            tracker_voice_set_position(&voice->mix.playback, offset * (sample->is_16bit ? 2 : 1));
+        }
+    } else if (cell->note == XMIT_NOTE_OFF) {
+        voice_release(player, voice);
+        if (player->module.flags.key_off_cut && !voice->volume_env_on) chan->volume = 0;
+    } else if (cell->note == XMIT_NOTE_CUT) {
+        voice->active = false;
+    } else if (cell->note == XMIT_NOTE_FADE) {
+        if (voice->active) voice->fading = true;
+    } else if (cell->instrument && ins && chan->note < XMIT_NUM_NOTES) {
+        // Instrument alone resets the volume (XM: and restarts envelopes)
+        const XmitSample* sample = get_sample(player, ins->sample[chan->note]);
+        if (sample) reset_volume_panning(player, chan, ins, sample);
+
+        if (player->module.format == XMIT_FORMAT_XM && voice->active) {
+            voice->released = false;
+            voice->fading = false;
+            voice->fade_volume = 65536;
+            voice->volume_env_pos = 0;
+            voice->panning_env_pos = 0;
+        }
+    }
+}
+
+// Volume slide Dxy on a 0-max value: Dx0 up, D0y down, DxF/DFy fine
+static int16_t volume_slide(int16_t value, uint8_t param, bool first_tick, int16_t max, int step) {
+    uint8_t x = param >> 4;
+    uint8_t y = param & 0x0F;
+
+    if (y == 0x0F && x != 0) {
+        if (first_tick) value += x * step;
+    } else if (x == 0x0F && y != 0) {
+        if (first_tick) value -= y * step;
+    } else if (!first_tick) {
+        if (y == 0) value += x * step;
+        else if (x == 0) value -= y * step;
+    }
+    return (int16_t)clamp32(value, 0, max);
+}
+
+// Portamento E/F: Fx fine, Ex extra fine, else per tick
+static void porta(XmitPlayer* player, XmitChannel* chan, uint8_t param, bool first_tick, int direction) {
+    int32_t amount = 0;
+    if (param >= 0xF0) {
+        if (first_tick) amount = (param & 0x0F) * 4;
+    } else if (param >= 0xE0) {
+        if (first_tick) amount = param & 0x0F;
+    } else if (!first_tick) {
+        amount = param * 4;
+    }
+    if (amount) chan->period = clamp_period(player, chan->period - direction * amount);
+}
+
+static void tone_porta(XmitPlayer* player, XmitChannel* chan, uint8_t speed) {
+    int32_t step = speed * 4;
+    if (chan->period < chan->target_period) {
+        chan->period = chan->period + step > chan->target_period ? chan->target_period : chan->period + step;
+    } else if (chan->period > chan->target_period) {
+        chan->period = chan->period - step < chan->target_period ? chan->target_period : chan->period - step;
+    }
+    (void)player;
+}
+
+static void vibrato(XmitPlayer* player, XmitChannel* chan) {
+    int depth = chan->vibrato_depth * (chan->fine_vibrato ? 1 : 4);
+    if (player->module.flags.old_effects) depth *= 2;
+    chan->vibrato_offset = wave_value(player, chan->vibrato_wave & 3, chan->vibrato_pos) * depth / 32;
+    chan->vibrato_pos = (uint8_t)((chan->vibrato_pos + chan->vibrato_speed) & 63);
+}
+
+static void pan_slide(XmitPlayer* player, XmitChannel* chan, uint8_t param, bool first_tick) {
+    // Low nibble slides right, high nibble left
+    uint8_t left = param >> 4;
+    uint8_t right = param & 0x0F;
+    int step = player->module.format == XMIT_FORMAT_XM ? 1 : 4;
+    int delta = 0;
+
+    if (left == 0x0F && right != 0) {
+        if (first_tick) delta = right;
+    } else if (right == 0x0F && left != 0) {
+        if (first_tick) delta = -left;
+    } else if (!first_tick) {
+        delta = right ? right : -left;
+    }
+    chan->panning = (int16_t)clamp32(chan->panning + delta * step, 0, 256);
+}
+
+static void retrigger(XmitPlayer* player, uint8_t channel) {
+    XmitChannel* chan = &player->channels[channel];
+    XmitVoice* voice = &player->voices[channel];
+    if (!voice->active) return;
+
+    int volume = chan->volume;
+    switch (chan->param >> 4) {
+        case 0x1: volume -= 1; break;
+        case 0x2: volume -= 2; break;
+        case 0x3: volume -= 4; break;
+        case 0x4: volume -= 8; break;
+        case 0x5: volume -= 16; break;
+        case 0x6: volume = volume * 2 / 3; break;
+        case 0x7: volume /= 2; break;
+        case 0x9: volume += 1; break;
+        case 0xA: volume += 2; break;
+        case 0xB: volume += 4; break;
+        case 0xC: volume += 8; break;
+        case 0xD: volume += 16; break;
+        case 0xE: volume = volume * 3 / 2; break;
+        case 0xF: volume *= 2; break;
+        default: break;
+    }
+    chan->volume = (int16_t)clamp32(volume, 0, 64);
+
+    tracker_voice_reset_position(&voice->mix.playback);
+}
+
+// Resolve effect memory for the row
+static void resolve_effect(XmitPlayer* player, XmitChannel* chan) {
+    const XmitModule* module = &player->module;
+    uint8_t effect = chan->cell.effect;
+    uint8_t param = chan->cell.param;
+
+    if (module->flags.shared_effect_memory) {
+        switch (effect) {
+            case XMIT_FX_VOLUME_SLIDE: case XMIT_FX_PORTA_DOWN: case XMIT_FX_PORTA_UP:
+            case XMIT_FX_TREMOR: case XMIT_FX_ARPEGGIO: case XMIT_FX_VIBRATO_VOLUME:
+            case XMIT_FX_PORTA_VOLUME: case XMIT_FX_RETRIGGER: case XMIT_FX_TREMOLO:
+            case XMIT_FX_EXTENDED:
+                if (param) chan->mem_shared = param;
+                else param = chan->mem_shared;
+                break;
+            default:
+                break;
+        }
+    }
+
+    switch (effect) {
+        case XMIT_FX_VOLUME_SLIDE:
+        case XMIT_FX_VIBRATO_VOLUME:
+        case XMIT_FX_PORTA_VOLUME:
+            if (param) chan->mem_volume_slide = param;
+            else param = chan->mem_volume_slide;
+            break;
+        case XMIT_FX_PORTA_DOWN:
+        case XMIT_FX_PORTA_UP:
+            if (module->format == XMIT_FORMAT_XM) {
+                uint8_t* mem = effect == XMIT_FX_PORTA_UP ? &chan->mem_porta_up : &chan->mem_porta_down;
+                if (param && param < 0xE0) *mem = param;
+                else if (!param) param = *mem;
+            } else {
+                if (param) chan->mem_porta = param;
+                else param = chan->mem_porta;
+                if (!module->flags.compat_gxx) chan->mem_tone_porta = chan->mem_porta;
+            }
+            break;
+        case XMIT_FX_TONE_PORTA:
+            if (param) {
+                chan->mem_tone_porta = param;
+                if (!module->flags.compat_gxx && module->format == XMIT_FORMAT_IT) chan->mem_porta = param;
+            }
+            param = chan->mem_tone_porta;
+            break;
+        case XMIT_FX_TREMOR:
+            if (param) chan->mem_tremor = param;
+            else param = chan->mem_tremor;
+            break;
+        case XMIT_FX_ARPEGGIO:
+            if (param) chan->mem_arpeggio = param;
+            else param = chan->mem_arpeggio;
+            break;
+        case XMIT_FX_CHANNEL_VOLUME_SLIDE:
+            if (param) chan->mem_channel_volume_slide = param;
+            else param = chan->mem_channel_volume_slide;
+            break;
+        case XMIT_FX_OFFSET:
+            if (param) chan->mem_offset = param;
+            break;
+        case XMIT_FX_PAN_SLIDE:
+            if (param) chan->mem_pan_slide = param;
+            else param = chan->mem_pan_slide;
+            break;
+        case XMIT_FX_RETRIGGER:
+            if (param) chan->mem_retrigger = param;
+            else param = chan->mem_retrigger;
+            break;
+        case XMIT_FX_EXTENDED:
+            if (module->format == XMIT_FORMAT_IT) {
+                if (param) chan->mem_extended = param;
+                else param = chan->mem_extended;
+            }
+            break;
+        case XMIT_FX_TEMPO:
+            if (param) chan->mem_tempo = param;
+            else param = chan->mem_tempo;
+            break;
+        case XMIT_FX_GLOBAL_VOLUME_SLIDE:
+            if (param) chan->mem_global_volume_slide = param;
+            else param = chan->mem_global_volume_slide;
+            break;
+        default:
+            break;
+    }
+
+    chan->effect = effect;
+    chan->param = param;
+}
+
+// Volume column on the first tick
+static void volume_column_row(XmitPlayer* player, XmitChannel* chan) {
+    uint8_t param = chan->cell.volparam;
+
+    switch (chan->cell.volcmd) {
+        case XMIT_VOL_SET: chan->volume = param > 64 ? 64 : param; break;
+        case XMIT_VOL_PAN: chan->panning = (int16_t)(param >= 64 ? 256 : param * 4); break;
+        case XMIT_VOL_FINE_UP: chan->volume = (int16_t)clamp32(chan->volume + param, 0, 64); break;
+        case XMIT_VOL_FINE_DOWN: chan->volume = (int16_t)clamp32(chan->volume - param, 0, 64); break;
+        case XMIT_VOL_VIBRATO_SPEED:
+            if (param) chan->vibrato_speed = param;
+            break;
+        case XMIT_VOL_VIBRATO_DEPTH:
+            if (param) chan->vibrato_depth = param;
+            chan->fine_vibrato = false;
+            break;
+        case XMIT_VOL_TONE_PORTA:
+            if (param) {
+                chan->mem_tone_porta = param;
+                if (!player->module.flags.compat_gxx && player->module.format == XMIT_FORMAT_IT) {
+                    chan->mem_porta = param;
+                }
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+// Volume column on the following ticks
+static void volume_column_tick(XmitPlayer* player, XmitChannel* chan) {
+    uint8_t param = chan->cell.volparam;
+
+    switch (chan->cell.volcmd) {
+        case XMIT_VOL_SLIDE_UP: chan->volume = (int16_t)clamp32(chan->volume + param, 0, 64); break;
+        case XMIT_VOL_SLIDE_DOWN: chan->volume = (int16_t)clamp32(chan->volume - param, 0, 64); break;
+        case XMIT_VOL_PORTA_UP: chan->period = clamp_period(player, chan->period - param * 4); break;
+        case XMIT_VOL_PORTA_DOWN: chan->period = clamp_period(player, chan->period + param * 4); break;
+        case XMIT_VOL_TONE_PORTA:
+            // Alongside Gxx the effect column slides
+            if (chan->effect != XMIT_FX_TONE_PORTA && chan->effect != XMIT_FX_PORTA_VOLUME) {
+                tone_porta(player, chan, chan->mem_tone_porta);
+            }
+            break;
+        case XMIT_VOL_VIBRATO_SPEED:
+        case XMIT_VOL_VIBRATO_DEPTH:
+            if (chan->effect != XMIT_FX_VIBRATO && chan->effect != XMIT_FX_FINE_VIBRATO &&
+                chan->effect != XMIT_FX_VIBRATO_VOLUME) {
+                vibrato(player, chan);
+            }
+            break;
+        case XMIT_VOL_PAN_SLIDE_LEFT: chan->panning = (int16_t)clamp32(chan->panning - param * 4, 0, 256); break;
+        case XMIT_VOL_PAN_SLIDE_RIGHT: chan->panning = (int16_t)clamp32(chan->panning + param * 4, 0, 256); break;
+        default:
+            break;
+    }
+}
+
+static void set_speed(XmitPlayer* player, uint8_t speed) {
+    if (speed == 0) return;
+    player->speed = speed;
+    pattern_sequencer_set_speed(player->sequencer, speed);
+}
+
+static void set_tempo(XmitPlayer* player, int tempo) {
+    player->tempo = (uint8_t)clamp32(tempo, 32, 255);
+    pattern_sequencer_set_bpm(player->sequencer, player->tempo);
+    // Takes effect from the next tick, not the next buffer
+    if (player->sample_rate > 0) pattern_sequencer_update_timing(player->sequencer, player->sample_rate);
+}
+
+// Effect column on the first tick
+static void effect_row(XmitPlayer* player, uint8_t channel, uint16_t row) {
+    XmitChannel* chan = &player->channels[channel];
+    XmitVoice* voice = &player->voices[channel];
+    const XmitModule* module = &player->module;
+    uint8_t param = chan->param;
+    uint8_t x = param >> 4;
+    uint8_t y = param & 0x0F;
+
+    switch (chan->effect) {
+        case XMIT_FX_SPEED:
+            set_speed(player, param);
+            break;
+        case XMIT_FX_JUMP:
+            player->jump_order = param;
+            break;
+        case XMIT_FX_BREAK:
+            player->break_row = param;
+            break;
+        case XMIT_FX_VOLUME_SLIDE:
+        case XMIT_FX_VIBRATO_VOLUME:
+        case XMIT_FX_PORTA_VOLUME:
+            chan->volume = volume_slide(chan->volume, param, true, 64, 1);
+            break;
+        case XMIT_FX_PORTA_DOWN:
+            porta(player, chan, param, true, -1);
+            break;
+        case XMIT_FX_PORTA_UP:
+            porta(player, chan, param, true, 1);
+            break;
+        case XMIT_FX_VIBRATO:
+        case XMIT_FX_FINE_VIBRATO:
+            if (x) chan->vibrato_speed = x;
+            if (y) chan->vibrato_depth = y;
+            chan->fine_vibrato = chan->effect == XMIT_FX_FINE_VIBRATO;
+            break;
+        case XMIT_FX_TREMOLO:
+            if (x) chan->tremolo_speed = x;
+            if (y) chan->tremolo_depth = y;
+            break;
+        case XMIT_FX_PANBRELLO:
+            if (x) chan->panbrello_speed = x;
+            if (y) chan->panbrello_depth = y;
+            break;
+        case XMIT_FX_CHANNEL_VOLUME:
+            chan->channel_volume = param > 64 ? 64 : param;
+            break;
+        case XMIT_FX_CHANNEL_VOLUME_SLIDE:
+            chan->channel_volume = volume_slide(chan->channel_volume, param, true, 64, 1);
+            break;
+        case XMIT_FX_PAN_SLIDE:
+            pan_slide(player, chan, param, true);
+            break;
+        case XMIT_FX_TEMPO:
+            if (param >= 0x20) set_tempo(player, param);
+            break;
+        case XMIT_FX_GLOBAL_VOLUME:
+            player->global_volume = param > 128 ? 128 : param;
+            break;
+        case XMIT_FX_GLOBAL_VOLUME_SLIDE: {
+            int step = module->format == XMIT_FORMAT_XM ? 2 : 1;
+            player->global_volume = (uint8_t)volume_slide(player->global_volume, param, true, 128, step);
+            break;
+        }
+        case XMIT_FX_PAN:
+            chan->panning = param == 0xFF ? 256 : param;
+            break;
+        case XMIT_FX_XM_VOLUME:
+            chan->volume = param > 64 ? 64 : param;
+            break;
+        case XMIT_FX_XM_KEY_OFF:
+            if (param == 0) {
+                voice_release(player, voice);
+                if (!voice->volume_env_on) chan->volume = 0;
+            } else {
+                chan->key_off_tick = param;
+            }
+            break;
+        case XMIT_FX_XM_ENV_POSITION:
+            voice->volume_env_pos = param;
+            voice->panning_env_pos = param;
+            break;
+        case XMIT_FX_EXTENDED:
+            switch (x) {
+                case 0x3: chan->vibrato_wave = y & 3; break;
+                case 0x4: chan->tremolo_wave = y & 3; break;
+                case 0x5: chan->panbrello_wave = y & 3; break;
+                case 0x7:
+                    if (y <= 2) {
+                        // Past note cut/off/fade
+                        uint16_t count = tracker_voice_pool_get_count(player->background);
+                        for (uint16_t i = 0; i < count; i++) {
+                            XmitVoice* past = background_voice(player, i);
+                            if (past->active && past->mix.channel == channel) {
+                                voice_note_action(player, past, y == 0 ? XMIT_NNA_CUT :
+                                                  (y == 1 ? XMIT_NNA_OFF : XMIT_NNA_FADE));
+                            }
+                        }
+                    } else if (y <= 6) {
+                        chan->nna_override = y - 3;
+                    } else if (y == 7 || y == 8) {
+                        voice->volume_env_on = y == 8;
+                    } else if (y == 9 || y == 10) {
+                        voice->panning_env_on = y == 10;
+                    }
+                    break;
+                case 0x8: chan->panning = (int16_t)((y * 256 + 7) / 15); break;
+                case 0xA: chan->offset_high = y; break;
+                case 0xB:
+                    if (y == 0) {
+                        chan->loop_row = row;
+                    } else if (chan->loop_count == 0) {
+                        chan->loop_count = y;
+                        player->loop_jump_row = chan->loop_row;
+                    } else if (--chan->loop_count > 0) {
+                        player->loop_jump_row = chan->loop_row;
+                    } else if (module->format == XMIT_FORMAT_IT) {
+                        chan->loop_row = (uint16_t)(row + 1);
+                    }
+                    break;
+                case 0xC:
+                    // SC0 cuts at once in XM, on the next tick in IT/S3M
+                    chan->cut_tick = (y == 0 && module->format != XMIT_FORMAT_XM) ? 1 : y;
+                    if (chan->cut_tick == 0) chan->volume = 0;
+                    break;
+                case 0xE:
+                    pattern_sequencer_pattern_delay(player->sequencer, y);
+                    break;
+                default:
+                    break;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+// Effect column on the following ticks
+static void effect_tick(XmitPlayer* player, uint8_t channel) {
+    XmitChannel* chan = &player->channels[channel];
+    XmitVoice* voice = &player->voices[channel];
+    uint8_t param = chan->param;
+    uint16_t tick = player->tick;
+
+    switch (chan->effect) {
+        case XMIT_FX_VOLUME_SLIDE:
+            chan->volume = volume_slide(chan->volume, param, false, 64, 1);
+            break;
+        case XMIT_FX_PORTA_DOWN:
+            porta(player, chan, param, false, -1);
+            break;
+        case XMIT_FX_PORTA_UP:
+            porta(player, chan, param, false, 1);
+            break;
+        case XMIT_FX_TONE_PORTA:
+            tone_porta(player, chan, param);
+            break;
+        case XMIT_FX_PORTA_VOLUME:
+            tone_porta(player, chan, chan->mem_tone_porta);
+            chan->volume = volume_slide(chan->volume, param, false, 64, 1);
+            break;
+        case XMIT_FX_VIBRATO:
+        case XMIT_FX_FINE_VIBRATO:
+            vibrato(player, chan);
+            break;
+        case XMIT_FX_VIBRATO_VOLUME:
+            vibrato(player, chan);
+            chan->volume = volume_slide(chan->volume, param, false, 64, 1);
+            break;
+        case XMIT_FX_TREMOR: {
+            uint8_t on = param >> 4;
+            uint8_t off = param & 0x0F;
+            if (player->module.format != XMIT_FORMAT_IT || player->module.flags.old_effects) {
+                on++;
+                off++;
+            }
+            if (on == 0) on = 1;
+            if (off == 0) off = 1;
+            chan->tremor_count = (uint8_t)((chan->tremor_count + 1) % (on + off));
+            chan->tremor_off = chan->tremor_count >= on;
+            break;
+        }
+        case XMIT_FX_ARPEGGIO: {
+            uint8_t step = tick % 3;
+            chan->arpeggio = (int8_t)(step == 0 ? 0 : (step == 1 ? param >> 4 : param & 0x0F));
+            break;
+        }
+        case XMIT_FX_CHANNEL_VOLUME_SLIDE:
+            chan->channel_volume = volume_slide(chan->channel_volume, param, false, 64, 1);
+            break;
+        case XMIT_FX_PAN_SLIDE:
+            pan_slide(player, chan, param, false);
+            break;
+        case XMIT_FX_RETRIGGER: {
+            uint8_t interval = param & 0x0F;
+            if (interval && ++chan->retrigger_count >= interval) {
+                chan->retrigger_count = 0;
+                retrigger(player, channel);
+            }
+            break;
+        }
+        case XMIT_FX_TREMOLO:
+            chan->tremolo_offset = (int16_t)(wave_value(player, chan->tremolo_wave & 3, chan->tremolo_pos) *
+                                             chan->tremolo_depth / 16);
+            chan->tremolo_pos = (uint8_t)((chan->tremolo_pos + chan->tremolo_speed) & 63);
+            break;
+        case XMIT_FX_PANBRELLO:
+            chan->panbrello_offset = (int16_t)(wave_value(player, chan->panbrello_wave & 3, chan->panbrello_pos) *
+                                               chan->panbrello_depth / 8);
+            chan->panbrello_pos = (uint8_t)((chan->panbrello_pos + chan->panbrello_speed) & 63);
+            break;
+        case XMIT_FX_TEMPO:
+            if (param < 0x10) set_tempo(player, player->tempo - param);
+            else if (param < 0x20) set_tempo(player, player->tempo + (param & 0x0F));
+            break;
+        case XMIT_FX_GLOBAL_VOLUME_SLIDE: {
+            int step = player->module.format == XMIT_FORMAT_XM ? 2 : 1;
+            player->global_volume = (uint8_t)volume_slide(player->global_volume, param, false, 128, step);
+            break;
+        }
+        default:
+            break;
+    }
+
+    if (tick == chan->cut_tick) {
+        if (player->module.format == XMIT_FORMAT_XM) chan->volume = 0;
+        else voice->active = false;
+    }
+    if (tick == chan->key_off_tick) {
+        voice_release(player, voice);
+        if (!voice->volume_env_on) chan->volume = 0;
+    }
+}
+
+// Notes, instruments, volume column and first-tick effects of a cell
+static void process_cell(XmitPlayer* player, uint8_t channel, uint16_t row) {
+    XmitChannel* chan = &player->channels[channel];
+
+    process_note(player, channel, &chan->cell);
+    volume_column_row(player, chan);
+    effect_row(player, channel, row);
+}
+
+static void process_row(XmitPlayer* player, uint8_t channel, const XmitCell* cell, uint16_t row) {
+    XmitChannel* chan = &player->channels[channel];
+
+    chan->cell = *cell;
+    resolve_effect(player, chan);
+
+    // Modulation lasts only while its effect does
+    bool vibrato_row = chan->effect == XMIT_FX_VIBRATO || chan->effect == XMIT_FX_FINE_VIBRATO ||
+                       chan->effect == XMIT_FX_VIBRATO_VOLUME ||
+                       cell->volcmd == XMIT_VOL_VIBRATO_DEPTH || cell->volcmd == XMIT_VOL_VIBRATO_SPEED;
+    if (!vibrato_row) chan->vibrato_offset = 0;
+    if (chan->effect != XMIT_FX_TREMOLO) chan->tremolo_offset = 0;
+    if (chan->effect != XMIT_FX_PANBRELLO) chan->panbrello_offset = 0;
+    if (chan->effect != XMIT_FX_TREMOR) chan->tremor_off = false;
+    if (chan->effect != XMIT_FX_RETRIGGER) chan->retrigger_count = 0;
+    chan->arpeggio = 0;
+    chan->cut_tick = XMIT_NO_TICK;
+    chan->key_off_tick = XMIT_NO_TICK;
+    chan->delay_tick = XMIT_NO_TICK;
+
+    // Note delay holds back the whole cell
+    if (chan->effect == XMIT_FX_EXTENDED && (chan->param >> 4) == 0xD && (chan->param & 0x0F) > 0) {
+        chan->delay_tick = chan->param & 0x0F;
+        return;
+    }
+
+    process_cell(player, channel, row);
+}
+
+// Channel state -> its foreground voice
+static void update_channel_voice(XmitPlayer* player, uint8_t channel) {
+    XmitChannel* chan = &player->channels[channel];
+    XmitVoice* voice = &player->voices[channel];
+    if (!voice->active) return;
+
+    voice->period = clamp_period(player, chan->period + chan->vibrato_offset);
+    voice->pitch_shift = chan->arpeggio * 64;
+    voice->volume = chan->tremor_off ? 0 : (int16_t)clamp32(chan->volume + chan->tremolo_offset, 0, 64);
+    voice->channel_volume = chan->channel_volume;
+    voice->panning = (int16_t)clamp32(chan->panning + chan->panbrello_offset, 0, 256);
+}
+
+static void update_voices(XmitPlayer* player) {
+    for (uint8_t c = 0; c < player->module.num_channels; c++) {
+        update_channel_voice(player, c);
+    }
+    for (uint8_t c = 0; c < player->module.num_channels; c++) {
+        if (player->voices[c].active) voice_tick(player, &player->voices[c]);
+    }
+    uint16_t count = tracker_voice_pool_get_count(player->background);
+    for (uint16_t i = 0; i < count; i++) {
+        XmitVoice* voice = background_voice(player, i);
+        if (voice->active) voice_tick(player, voice);
+    }
+    remove_stopped_voices(player);
+}
+
+// Ticks after the first of a row
+static void run_tick(XmitPlayer* player) {
+    player->tick++;
+
+    for (uint8_t c = 0; c < player->module.num_channels; c++) {
+        XmitChannel* chan = &player->channels[c];
+
+        if (player->tick == chan->delay_tick) {
+            chan->delay_tick = XMIT_NO_TICK;
+            process_cell(player, c, player->row);
+            continue;
+        }
+        if (chan->delay_tick != XMIT_NO_TICK) continue;
+
+        volume_column_tick(player, chan);
+        effect_tick(player, c);
+    }
+}
+
+// ============================================================================
+// Sequencer callbacks
+// ============================================================================
+
+static void xmit_on_tick(void* user_data, uint8_t tick) {
+    XmitPlayer* player = (XmitPlayer*)user_data;
+    (void)tick;
+    player->tick_pending = true;
+}
+
+static void xmit_on_row(void* user_data, uint16_t pattern_index,
+                        uint16_t pattern_number, uint16_t row) {
+    XmitPlayer* player = (XmitPlayer*)user_data;
+    const XmitModule* module = &player->module;
+
+    player->row = row;
+    player->tick = 0;
+    player->row_started = true;
+    player->jump_order = -1;
+    player->break_row = -1;
+    player->loop_jump_row = -1;
+
+    const XmitPattern* pattern = pattern_number < XMIT_MAX_PATTERNS ? &module->patterns[pattern_number] : NULL;
+    XmitCell empty = { XMIT_NOTE_NONE, 0, XMIT_VOL_NONE, 0, XMIT_FX_NONE, 0 };
+
+    for (uint8_t c = 0; c < module->num_channels; c++) {
+        const XmitCell* cell = &empty;
+        if (pattern && pattern->cells && row < pattern->rows) {
+            cell = &pattern->cells[row * module->num_channels + c];
+        }
+        process_row(player, c, cell, row);
+    }
+
+    // Flow effects are applied by the sequencer right after this callback
+    if (player->loop_jump_row >= 0) {
+        pattern_sequencer_jump_to(player->sequencer, pattern_index, (uint16_t)player->loop_jump_row);
+    } else if (player->jump_order >= 0) {
+        pattern_sequencer_jump_to(player->sequencer, (uint16_t)player->jump_order,
+                                  player->break_row >= 0 ? (uint16_t)player->break_row : 0);
+    } else if (player->break_row >= 0) {
+        pattern_sequencer_pattern_break(player->sequencer, (uint16_t)player->break_row);
+    }
+
+    trigger_position_callback(player, pattern_index, pattern_number, row);
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+XmitPlayer* xmit_player_create(void) {
+    XmitPlayer* player = (XmitPlayer*)calloc(1, sizeof(XmitPlayer));
+    if (!player) return NULL;
+
+    player->sequencer = pattern_sequencer_create();
+    player->background = tracker_voice_pool_create(XMIT_VIRTUAL_VOICES, sizeof(XmitVoice));
+    if (!player->sequencer || !player->background) {
+        xmit_player_destroy(player);
+        return NULL;
+    }
+    pattern_sequencer_set_mode(player->sequencer, PS_MODE_TICK_BASED);
+
+    player->speed = 6;
+    player->tempo = 125;
+    player->global_volume = 128;
+    player->random = 1;
+    player->interpolation = TRACKER_INTERP_LINEAR;
+
+    for (int c = 0; c < XMIT_MAX_CHANNELS; c++) {
+        player->channels[c].user_volume = 1.0f;
+    }
+    for (int c = 0; c < XMIT_MAX_CHANNELS; c++) {
+        tracker_voice_init(&player->voices[c].mix.playback);
+    }
+
+    return player;
+}
+
+void xmit_player_destroy(XmitPlayer* player) {
+    if (!player) return;
+
+    if (player->sequencer) {
+        pattern_sequencer_destroy(player->sequencer);
+    }
+    tracker_voice_pool_destroy(player->background);
+    xmit_module_free(&player->module);
+    free(player);
+}
+
+XmitFormat xmit_player_detect(const uint8_t* data, size_t size) {
+    if (xmit_detect_xm(data, size)) return XMIT_FORMAT_XM;
+    if (xmit_detect_it(data, size)) return XMIT_FORMAT_IT;
+    if (xmit_detect_s3m(data, size)) return XMIT_FORMAT_S3M;
+    return XMIT_FORMAT_NONE;
+}
+
+// Song defaults for every channel and voice (user controls stay)
+static void reset_playback(XmitPlayer* player) {
+    const XmitModule* module = &player->module;
+
+    for (int c = 0; c < XMIT_MAX_CHANNELS; c++) {
+        XmitChannel* chan = &player->channels[c];
+        bool muted = chan->muted;
+        float user_volume = chan->user_volume;
+
+        memset(chan, 0, sizeof(*chan));
+        chan->muted = muted;
+        chan->user_volume = user_volume;
+        chan->panning = (int16_t)module->channel_pan[c];
+        chan->channel_volume = module->channel_volume[c];
+        chan->note = XMIT_NOTE_NONE;
+        chan->nna_override = 0xFF;
+        chan->cut_tick = chan->delay_tick = chan->key_off_tick = XMIT_NO_TICK;
+    }
+    for (int c = 0; c < XMIT_MAX_CHANNELS; c++) {
+        player->voices[c].active = false;
+    }
+    tracker_voice_pool_clear(player->background);
+
+    player->tick = 0;
+    player->global_volume = module->initial_global_volume;
+    set_speed(player, module->initial_speed);
+    player->tempo = module->initial_tempo;
+    pattern_sequencer_set_bpm(player->sequencer, player->tempo);
+}
+
+bool xmit_player_load(XmitPlayer* player, const uint8_t* data, size_t size) {
+    if (!player || !data) return false;
+
+    // Nothing may keep playing the old samples
+    xmit_player_stop(player);
+
+    bool loaded = false;
+    switch (xmit_player_detect(data, size)) {
+        case XMIT_FORMAT_XM: loaded = xmit_load_xm(&player->module, data, size); break;
+        case XMIT_FORMAT_S3M: loaded = xmit_load_s3m(&player->module, data, size); break;
+        case XMIT_FORMAT_IT: loaded = xmit_load_it(&player->module, data, size); break;
+        default: break;
+    }
+    if (!loaded || player->module.num_orders == 0 || player->module.num_channels == 0) {
+        xmit_module_free(&player->module);
+        return false;
+    }
+
+    XmitModule* module = &player->module;
+
+    player->loop_start = 0;
+    player->loop_end = module->num_orders - 1;
+
+    uint16_t rows[XMIT_MAX_PATTERNS];
+    for (int p = 0; p < XMIT_MAX_PATTERNS; p++) {
+        rows[p] = module->patterns[p].rows;
+    }
+
+    pattern_sequencer_set_song(player->sequencer, module->orders, module->num_orders, 64);
+    pattern_sequencer_set_pattern_rows(player->sequencer, rows, XMIT_MAX_PATTERNS);
+    pattern_sequencer_set_loop_range(player->sequencer, player->loop_start, player->loop_end);
+    pattern_sequencer_set_looping(player->sequencer, !player->disable_looping);
+
+    PatternSequencerCallbacks callbacks = {
+        .on_tick = xmit_on_tick,
+        .on_row = xmit_on_row,
+        .on_pattern_change = NULL,
+        .on_song_end = NULL
+    };
+    pattern_sequencer_set_callbacks(player->sequencer, &callbacks, player);
+
+    reset_playback(player);
+    return true;
+}
+
+XmitFormat xmit_player_get_format(const XmitPlayer* player) {
+    return player ? player->module.format : XMIT_FORMAT_NONE;
+}
+
+void xmit_player_start(XmitPlayer* player) {
+    if (!player || player->module.num_orders == 0) return;
+
+    reset_playback(player);
+    player->playing = true;
+    pattern_sequencer_start(player->sequencer);
+}
+
+void xmit_player_stop(XmitPlayer* player) {
+    if (!player) return;
+    player->playing = false;
+    pattern_sequencer_stop(player->sequencer);
+
+    for (int c = 0; c < XMIT_MAX_CHANNELS; c++) {
+        player->voices[c].active = false;
+    }
+    tracker_voice_pool_clear(player->background);
+}
+
+bool xmit_player_is_playing(const XmitPlayer* player) {
+    return player ? player->playing : false;
+}
+
+void xmit_player_set_loop_range(XmitPlayer* player, uint16_t start_order, uint16_t end_order) {
+    if (!player || player->module.num_orders == 0) return;
+    if (start_order >= player->module.num_orders) start_order = 0;
+    if (end_order >= player->module.num_orders) end_order = player->module.num_orders - 1;
+    if (start_order > end_order) start_order = end_order;
+
+    player->loop_start = start_order;
+    player->loop_end = end_order;
+    pattern_sequencer_set_loop_range(player->sequencer, start_order, end_order);
+}
+
+void xmit_player_set_disable_looping(XmitPlayer* player, bool disable) {
+    if (!player) return;
+    player->disable_looping = disable;
+    pattern_sequencer_set_looping(player->sequencer, !disable);
+}
+
+void xmit_player_get_position(const XmitPlayer* player, uint16_t* order, uint16_t* pattern, uint16_t* row) {
+    if (!player) return;
+
+    uint16_t o = 0, p = 0, r = 0;
+    pattern_sequencer_get_position(player->sequencer, &o, &p, &r);
+    if (order) *order = o;
+    if (pattern) *pattern = p;
+    if (row) *row = r;
+}
+
+void xmit_player_set_position_callback(XmitPlayer* player, XmitPlayerPositionCallback callback, void* user_data) {
+    if (!player) return;
+    player->position_callback = callback;
+    player->callback_user_data = user_data;
+}
+
+void xmit_player_set_position(XmitPlayer* player, uint16_t order, uint16_t row) {
+    if (!player) return;
+    if (order < player->module.num_orders && row < pattern_sequencer_get_pattern_rows(player->sequencer, order)) {
+        pattern_sequencer_set_position(player->sequencer, order, row);
+    }
+}
+
+void xmit_player_set_bpm(XmitPlayer* player, uint16_t bpm) {
+    if (!player) return;
+    player->tempo = (uint8_t)clamp32(bpm, 32, 255);
+    pattern_sequencer_set_bpm(player->sequencer, player->tempo);
+}
+
+uint16_t xmit_player_get_bpm(const XmitPlayer* player) {
+    return player ? player->tempo : 125;
+}
+
+void xmit_player_set_channel_mute(XmitPlayer* player, uint8_t channel, bool muted) {
+    if (!player || channel >= XMIT_MAX_CHANNELS) return;
+    player->channels[channel].muted = muted;
+}
+
+bool xmit_player_get_channel_mute(const XmitPlayer* player, uint8_t channel) {
+    if (!player || channel >= XMIT_MAX_CHANNELS) return false;
+    return player->channels[channel].muted;
+}
+
+void xmit_player_set_channel_volume(XmitPlayer* player, uint8_t channel, float volume) {
+    if (!player || channel >= XMIT_MAX_CHANNELS) return;
+    if (volume < 0.0f) volume = 0.0f;
+    if (volume > 1.0f) volume = 1.0f;
+    player->channels[channel].user_volume = volume;
+}
+
+float xmit_player_get_channel_volume(const XmitPlayer* player, uint8_t channel) {
+    if (!player || channel >= XMIT_MAX_CHANNELS) return 0.0f;
+    return player->channels[channel].user_volume;
+}
+
+void xmit_player_set_interpolation(XmitPlayer* player, TrackerInterpolation interp) {
+    if (!player || (unsigned)interp >= TRACKER_INTERP_NUM_MODES) return;
+    player->interpolation = interp;
+}
+
+TrackerInterpolation xmit_player_get_interpolation(const XmitPlayer* player) {
+    return player ? player->interpolation : TRACKER_INTERP_LINEAR;
+}
+
+const char* xmit_player_get_title(const XmitPlayer* player) {
+    return player ? player->module.title : "";
+}
+
+uint16_t xmit_player_get_song_length(const XmitPlayer* player) {
+    return player ? player->module.num_orders : 0;
+}
+
+uint8_t xmit_player_get_num_channels(const XmitPlayer* player) {
+    return player ? player->module.num_channels : 0;
+}
+
+struct PatternSequencer* xmit_player_get_sequencer(XmitPlayer* player) {
+    return player ? player->sequencer : NULL;
+}
+
+// ============================================================================
+// Rendering
+// ============================================================================
+
+// Render a span of frames for every voice into the stereo bus and the
+// channel outputs. With no bus (left == NULL) voices only advance.
+static void render_voices(XmitPlayer* player, float* left, float* right,
+                          float** channel_outputs, uint8_t num_channel_outputs,
+                          uint32_t offset, uint32_t frames) {
+    uint8_t num_channels = player->module.num_channels;
+    float gains[XMIT_MAX_CHANNELS];
+    for (uint8_t c = 0; c < num_channels; c++) {
+        const XmitChannel* chan = &player->channels[c];
+        bool muted = chan->muted || player->module.channel_muted[c];
+        gains[c] = muted ? 0.0f : chan->user_volume;
+    }
+
+    for (uint8_t c = 0; c < num_channels; c++) {
+        XmitVoice* voice = &player->voices[c];
+        if (!voice->active) continue;
+
+        float* channel_out = (left && channel_outputs && c < num_channel_outputs && channel_outputs[c])
+                             ? &channel_outputs[c][offset] : NULL;
+        tracker_mixer_render_voice(&voice->mix, player->interpolation,
+                                   left ? &left[offset] : NULL, right ? &right[offset] : NULL,
+                                   channel_out, gains[c], 0.5f, frames);
+
+        // One-shot samples end
+        const TrackerVoice* playback = &voice->mix.playback;
+        if (!playback->loop_enabled && playback->sample_pos >= playback->length) {
+            voice->active = false;
+        }
+    }
+
+    // Background voices remove themselves from the pool when they end
+    tracker_voice_pool_mix(player->background, player->interpolation, left, right,
+                           channel_outputs, num_channel_outputs, offset,
+                           gains, num_channels, 0.5f, frames);
+}
+
+// Advance the sequencer by up to max_frames, running any tick it passes
+static uint32_t advance(XmitPlayer* player, uint32_t max_frames) {
+    player->tick_pending = false;
+    player->row_started = false;
+
+    uint32_t span = pattern_sequencer_process_span(player->sequencer, max_frames);
+    player->playing = pattern_sequencer_is_playing(player->sequencer);
+
+    if (player->tick_pending && !player->row_started) {
+        run_tick(player);
+    }
+    if (player->tick_pending || player->row_started) {
+        update_voices(player);
+    }
+    return span;
+}
+
+static void prepare(XmitPlayer* player, uint32_t sample_rate) {
+    pattern_sequencer_update_timing(player->sequencer, sample_rate);
+
+    if (player->sample_rate != sample_rate) {
+        player->sample_rate = sample_rate;
+        for (int c = 0; c < XMIT_MAX_CHANNELS; c++) {
+            if (player->voices[c].active) voice_update_delta(player, &player->voices[c]);
+        }
+        uint16_t count = tracker_voice_pool_get_count(player->background);
+        for (uint16_t i = 0; i < count; i++) {
+            voice_update_delta(player, background_voice(player, i));
+        }
+    }
+}
+
+void xmit_player_process_channels(XmitPlayer* player,
+                                  float* left,
+                                  float* right,
+                                  float** channel_outputs,
+                                  uint8_t num_channel_outputs,
+                                  uint32_t frames,
+                                  uint32_t sample_rate) {
+    if (!player || !left || !right) return;
+
+    memset(left, 0, frames * sizeof(float));
+    memset(right, 0, frames * sizeof(float));
+    if (channel_outputs) {
+        for (uint8_t c = 0; c < num_channel_outputs; c++) {
+            if (channel_outputs[c]) memset(channel_outputs[c], 0, frames * sizeof(float));
+        }
+    }
+
+    if (!player->playing) return;
+    prepare(player, sample_rate);
+
+    // Each span starts at a tick (or the buffer start) and ends right before
+    // the next one, so every tick lands on its exact sample
+    uint32_t i = 0;
+    while (i < frames) {
+        uint32_t span = advance(player, frames - i);
+        if (!player->playing) break;
+
+        render_voices(player, left, right, channel_outputs, num_channel_outputs, i, span);
+        i += span;
+    }
+}
+
+void xmit_player_process(XmitPlayer* player, float* left, float* right, uint32_t frames, uint32_t sample_rate) {
+    xmit_player_process_channels(player, left, right, NULL, 0, frames, sample_rate);
+}
+
+uint32_t xmit_player_fast_forward(XmitPlayer* player, uint32_t rows, uint32_t sample_rate,
+                                  uint64_t* frames) {
+    if (frames) *frames = 0;
+    if (!player || !player->playing) return 0;
+
+    // Rows passed on the way are not reported
+    XmitPlayerPositionCallback callback = player->position_callback;
+    player->position_callback = NULL;
+
+    prepare(player, sample_rate);
+
+    uint32_t passed = 0;
+    while (player->playing) {
+        if (pattern_sequencer_is_at_row_start(player->sequencer)) {
+            if (passed == rows) break;
+            passed++;
+        }
+
+        // Same spans as xmit_player_process_channels(), without mixing
+        uint32_t span = advance(player, UINT32_MAX);
+        if (!player->playing) break;
+        if (frames) *frames += span;
+
+        render_voices(player, NULL, NULL, NULL, 0, 0, span);
+    }
+
+    player->position_callback = callback;
+    return passed;
+}
+
+// ============================================================================
+// Playback state snapshot
+// ============================================================================
+
+// Channels and voices refer to instruments and samples by number already;
+// only the voices' waveform pointers are dropped and rebuilt on restore.
+#define XMIT_STATE_MAGIC 0x54494D58U  // "XMIT"
+
+typedef struct {
+    uint32_t magic;
+    uint32_t size;
+    uint16_t row;
+    uint16_t tick;
+    uint8_t speed;
+    uint8_t tempo;
+    uint8_t global_volume;
+    uint32_t random;
+    PatternSequencerState sequencer;
+    XmitChannel channels[XMIT_MAX_CHANNELS];
+    XmitVoice voices[XMIT_MAX_CHANNELS];
+    uint16_t num_background;
+    XmitVoice background[XMIT_VIRTUAL_VOICES];     // Oldest first
+} XmitPlayerState;
+
+size_t xmit_player_get_state_size(const XmitPlayer* player) {
+    (void)player;
+    return sizeof(XmitPlayerState);
+}
+
+bool xmit_player_save_state(const XmitPlayer* player, void* buffer, size_t size) {
+    if (!player || !buffer || size < sizeof(XmitPlayerState)) return false;
+
+    XmitPlayerState* state = (XmitPlayerState*)buffer;
+    memset(state, 0, sizeof(*state));
+    state->magic = XMIT_STATE_MAGIC;
+    state->size = sizeof(XmitPlayerState);
+    state->row = player->row;
+    state->tick = player->tick;
+    state->speed = player->speed;
+    state->tempo = player->tempo;
+    state->global_volume = player->global_volume;
+    state->random = player->random;
+    pattern_sequencer_save_state(player->sequencer, &state->sequencer);
+
+    memcpy(state->channels, player->channels, sizeof(state->channels));
+    memcpy(state->voices, player->voices, sizeof(state->voices));
+    for (int c = 0; c < XMIT_MAX_CHANNELS; c++) {
+        state->voices[c].mix.playback.waveform = NULL;
+    }
+
+    state->num_background = tracker_voice_pool_get_count(player->background);
+    for (uint16_t i = 0; i < state->num_background; i++) {
+        state->background[i] = *background_voice(player, i);
+        state->background[i].mix.playback.waveform = NULL;
+    }
+
+    return true;
+}
+
+bool xmit_player_restore_state(XmitPlayer* player, const void* buffer, size_t size) {
+    if (!player || !buffer || size < sizeof(XmitPlayerState)) return false;
+
+    const XmitPlayerState* state = (const XmitPlayerState*)buffer;
+    if (state->magic != XMIT_STATE_MAGIC || state->size != sizeof(XmitPlayerState)) return false;
+
+    pattern_sequencer_restore_state(player->sequencer, &state->sequencer);
+    player->playing = pattern_sequencer_is_playing(player->sequencer);
+    player->row = state->row;
+    player->tick = state->tick;
+    player->speed = state->speed;
+    player->tempo = state->tempo;
+    player->global_volume = state->global_volume;
+    player->random = state->random;
+
+    for (int c = 0; c < XMIT_MAX_CHANNELS; c++) {
+        XmitChannel* chan = &player->channels[c];
+
+        // User controls stay as they are
+        bool muted = chan->muted;
+        float user_volume = chan->user_volume;
+
+        *chan = state->channels[c];
+        chan->muted = muted;
+        chan->user_volume = user_volume;
+    }
+
+    for (int c = 0; c < XMIT_MAX_CHANNELS; c++) {
+        XmitVoice* voice = &player->voices[c];
+        *voice = state->voices[c];
+
+        const XmitSample* sample = get_sample(player, voice->sample);
+        voice->mix.playback.waveform = sample ? sample->data : NULL;
+        if (!sample) voice->active = false;
+    }
+
+    // Added back in the same order, so they mix and get taken over alike
+    tracker_voice_pool_clear(player->background);
+    uint16_t count = state->num_background < XMIT_VIRTUAL_VOICES ? state->num_background : XMIT_VIRTUAL_VOICES;
+    for (uint16_t i = 0; i < count; i++) {
+        const XmitSample* sample = get_sample(player, state->background[i].sample);
+        if (!sample) continue;
+
+        XmitVoice* voice = (XmitVoice*)tracker_voice_pool_add(player->background, &state->background[i]);
+        voice->mix.playback.waveform = sample->data;
+    }
+
+    // Deltas depend on the rate of the next render
+    player->sample_rate = 0;
+    return true;
+}
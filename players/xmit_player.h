@@ -0,0 +1,213 @@
+#ifndef XMIT_PLAYER_H
+#define XMIT_PLAYER_H
+
+/**
+ * XM/S3M/IT Player - FastTracker 2, Scream Tracker 3 and Impulse Tracker
+ *
+ * One player for the three PC tracker formats, built on the same pattern
+ * sequencer and tracker voices as the MOD/MED players. Modules are loaded
+ * into a common Impulse Tracker style layout, so the formats share one set
+ * of effects:
+ * - Instruments with volume/panning envelopes, fadeout and auto-vibrato
+ * - Linear and Amiga frequency slides
+ * - New note actions (cut/continue/off/fade) and duplicate checks, with
+ *   released notes playing on in a pool of 256 virtual voices (when all are
+ *   in use, the quietest is taken over)
+ * - Per-channel outputs for every channel, background voices included
+ *
+ * Playback does not allocate. Samples are converted to signed 8/16-bit mono
+ * on load (stereo samples are mixed down), so a loaded file can be freed.
+ *
+ * Not supported: resonant filters, pitch envelopes, ping-pong sustain loops
+ * (played as forward loops), MIDI macros, AdLib instruments and XM files
+ * older than version 1.04.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "tracker_voice.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define XMIT_MAX_CHANNELS 64
+#define XMIT_TITLE_LENGTH 28
+
+typedef enum {
+    XMIT_FORMAT_NONE = 0,
+    XMIT_FORMAT_XM,
+    XMIT_FORMAT_S3M,
+    XMIT_FORMAT_IT
+} XmitFormat;
+
+typedef struct XmitPlayer XmitPlayer;
+
+/**
+ * Position change callback
+ * Called when a new row starts
+ * order: Position in the song order
+ * pattern: Pattern number being played
+ * row: Row within the pattern
+ */
+typedef void (*XmitPlayerPositionCallback)(uint16_t order, uint16_t pattern, uint16_t row, void* user_data);
+
+/**
+ * Create a new player instance
+ * Returns NULL on allocation failure
+ */
+XmitPlayer* xmit_player_create(void);
+
+/**
+ * Destroy a player instance
+ */
+void xmit_player_destroy(XmitPlayer* player);
+
+/**
+ * Check which format data is in
+ * Returns XMIT_FORMAT_NONE if it is not an XM, S3M or IT file
+ */
+XmitFormat xmit_player_detect(const uint8_t* data, size_t size);
+
+/**
+ * Load an XM, S3M or IT file from memory
+ * The data is not referenced after loading.
+ * Returns true on success, false on parse error
+ */
+bool xmit_player_load(XmitPlayer* player, const uint8_t* data, size_t size);
+
+/**
+ * Format of the loaded module
+ */
+XmitFormat xmit_player_get_format(const XmitPlayer* player);
+
+/**
+ * Start/stop playback
+ */
+void xmit_player_start(XmitPlayer* player);
+void xmit_player_stop(XmitPlayer* player);
+bool xmit_player_is_playing(const XmitPlayer* player);
+
+/**
+ * Set loop range (order indices)
+ * If start == end, only that order will loop
+ */
+void xmit_player_set_loop_range(XmitPlayer* player, uint16_t start_order, uint16_t end_order);
+
+/**
+ * Enable or disable looping
+ * @param disable If true, playback stops at end instead of looping
+ */
+void xmit_player_set_disable_looping(XmitPlayer* player, bool disable);
+
+/**
+ * Get current position
+ */
+void xmit_player_get_position(const XmitPlayer* player, uint16_t* order, uint16_t* pattern, uint16_t* row);
+
+/**
+ * Set position change callback (NULL to disable)
+ */
+void xmit_player_set_position_callback(XmitPlayer* player, XmitPlayerPositionCallback callback, void* user_data);
+
+/**
+ * Jump to an order and row
+ */
+void xmit_player_set_position(XmitPlayer* player, uint16_t order, uint16_t row);
+
+/**
+ * Tempo in BPM (32-255)
+ */
+void xmit_player_set_bpm(XmitPlayer* player, uint16_t bpm);
+uint16_t xmit_player_get_bpm(const XmitPlayer* player);
+
+/**
+ * Channel control - mute/unmute
+ * Muted channels keep playing silently, background voices included.
+ */
+void xmit_player_set_channel_mute(XmitPlayer* player, uint8_t channel, bool muted);
+bool xmit_player_get_channel_mute(const XmitPlayer* player, uint8_t channel);
+
+/**
+ * Channel control - volume (0.0 to 1.0)
+ */
+void xmit_player_set_channel_volume(XmitPlayer* player, uint8_t channel, float volume);
+float xmit_player_get_channel_volume(const XmitPlayer* player, uint8_t channel);
+
+/**
+ * Set sample interpolation (default TRACKER_INTERP_LINEAR)
+ */
+void xmit_player_set_interpolation(XmitPlayer* player, TrackerInterpolation interp);
+TrackerInterpolation xmit_player_get_interpolation(const XmitPlayer* player);
+
+/**
+ * Process stereo output
+ * left/right: Output buffers (overwritten)
+ */
+void xmit_player_process(XmitPlayer* player, float* left, float* right, uint32_t frames, uint32_t sample_rate);
+
+/**
+ * Process with per-channel outputs
+ * left/right: Mixed stereo output buffers (overwritten)
+ * channel_outputs: Mono buffers for the first num_channel_outputs channels
+ *                  (array and entries may be NULL)
+ * Each channel output holds the channel's voices at their volume, before
+ * panning.
+ */
+void xmit_player_process_channels(XmitPlayer* player,
+                                  float* left,
+                                  float* right,
+                                  float** channel_outputs,
+                                  uint8_t num_channel_outputs,
+                                  uint32_t frames,
+                                  uint32_t sample_rate);
+
+/**
+ * Song information
+ */
+const char* xmit_player_get_title(const XmitPlayer* player);
+uint16_t xmit_player_get_song_length(const XmitPlayer* player);
+uint8_t xmit_player_get_num_channels(const XmitPlayer* player);
+
+/**
+ * Get underlying PatternSequencer (for advanced control with RegrooveController)
+ * WARNING: Do not destroy the returned sequencer - it's owned by the player
+ */
+struct PatternSequencer* xmit_player_get_sequencer(XmitPlayer* player);
+
+/**
+ * Playback state snapshot
+ * Holds everything the song changes while it plays: position and timing,
+ * global volume, channel state (effect memory, modulation phases, new note
+ * action) and every voice with its envelope positions and sample position.
+ * User controls (mute, channel volume, loop range, interpolation) are not
+ * part of it.
+ * Samples and instruments are stored by number, so a snapshot can be
+ * restored into any player that has the same file loaded. The data is only
+ * valid for the same build (host byte order) and timing is in samples at
+ * the rate it was taken.
+ * buffer: At least xmit_player_get_state_size() bytes
+ * Returns false if the buffer is too small or does not hold a snapshot
+ */
+size_t xmit_player_get_state_size(const XmitPlayer* player);
+bool xmit_player_save_state(const XmitPlayer* player, void* buffer, size_t size);
+bool xmit_player_restore_state(XmitPlayer* player, const void* buffer, size_t size);
+
+/**
+ * Advance playback without rendering audio (for seeking)
+ * Runs ticks, envelopes and sample positions exactly as
+ * xmit_player_process() would and stops at a row start (right before the
+ * tick that plays the row) after passing `rows` row starts. With rows = 0 it
+ * stops at the next row start. The position callback is not called for the
+ * rows passed. frames (may be NULL) receives the number of frames advanced.
+ * Returns the number of rows passed (less than requested if the song ended)
+ */
+uint32_t xmit_player_fast_forward(XmitPlayer* player, uint32_t rows, uint32_t sample_rate,
+                                  uint64_t* frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // XMIT_PLAYER_H
@@ -7,6 +7,8 @@
 START_NAMESPACE_DISTRHO
 
 #define KS_VOICES 8
+#define KS_LOWEST_FREQ 8.0f  // MIDI note 0
+#define RENDER_CHUNK 64
 
 struct KSVoice {
     SynthKarplus* ks;
@@ -28,6 +30,7 @@ public:
 
         for (int i = 0; i < KS_VOICES; i++) {
             fVoices[i].ks = synth_karplus_create();
+            if (fVoices[i].ks) synth_karplus_prepare(fVoices[i].ks, (int)getSampleRate(), KS_LOWEST_FREQ);
             fVoices[i].active = false;
             updateVoice(i);
         }
@@ -109,18 +112,27 @@ protected:
         }
     }
 
+    void sampleRateChanged(double newSampleRate) override
+    {
+        // Resize delay lines so the lowest note fits at the new rate
+        for (int i = 0; i < KS_VOICES; i++) {
+            if (fVoices[i].ks) synth_karplus_prepare(fVoices[i].ks, (int)newSampleRate, KS_LOWEST_FREQ);
+            fVoices[i].active = false;
+        }
+        if (fVoiceManager) synth_voice_manager_reset(fVoiceManager);
+    }
+
     void run(const float**, float** outputs, uint32_t frames, const MidiEvent* midiEvents, uint32_t midiEventCount) override
     {
         float* outL = outputs[0];
         float* outR = outputs[1];
         uint32_t framePos = 0;
-        const int sampleRate = (int)getSampleRate();
 
         for (uint32_t i = 0; i < midiEventCount; ++i) {
             const MidiEvent& event = midiEvents[i];
-            while (framePos < event.frame) {
-                renderFrame(outL, outR, framePos, sampleRate);
-                framePos++;
+            if (framePos < event.frame) {
+                renderBlock(outL, outR, framePos, event.frame - framePos);
+                framePos = event.frame;
             }
             if (event.size != 3) continue;
             const uint8_t status = event.data[0] & 0xF0;
@@ -129,9 +141,8 @@ protected:
             if (status == 0x90 && velocity > 0) handleNoteOn(note, velocity);
             else if (status == 0x80 || (status == 0x90 && velocity == 0)) handleNoteOff(note);
         }
-        while (framePos < frames) {
-            renderFrame(outL, outR, framePos, sampleRate);
-            framePos++;
+        if (framePos < frames) {
+            renderBlock(outL, outR, framePos, frames - framePos);
         }
     }
 
@@ -169,41 +180,52 @@ private:
         synth_karplus_release(fVoices[voice_idx].ks);
     }
 
-    void renderFrame(float* outL, float* outR, uint32_t framePos, int sampleRate)
+    void renderBlock(float* outL, float* outR, uint32_t framePos, uint32_t count)
     {
-        float mixL = 0.0f, mixR = 0.0f;
-
-        for (int i = 0; i < KS_VOICES; i++) {
-            const VoiceMeta* meta = synth_voice_manager_get_voice(fVoiceManager, i);
-            if (!meta || meta->state == VOICE_INACTIVE) {
-                fVoices[i].active = false;
-                continue;
+        while (count > 0) {
+            const uint32_t n = count < RENDER_CHUNK ? count : RENDER_CHUNK;
+            float* mixL = outL + framePos;
+            float* mixR = outR + framePos;
+            SynthKarplus* strings[KS_VOICES];
+            int numStrings = 0;
+
+            for (int i = 0; i < KS_VOICES; i++) {
+                const VoiceMeta* meta = synth_voice_manager_get_voice(fVoiceManager, i);
+                if (!meta || meta->state == VOICE_INACTIVE) {
+                    fVoices[i].active = false;
+                    continue;
+                }
+                if (fVoices[i].active) strings[numStrings++] = fVoices[i].ks;
             }
-            if (!fVoices[i].active) continue;
 
-            float sample = synth_karplus_process(fVoices[i].ks, sampleRate);
+            // All active strings are rendered together, interleaved in lanes
+            std::memset(mixL, 0, n * sizeof(float));
+            synth_karplus_process_batch(strings, numStrings, mixL, (int)n);
 
-            if (!synth_karplus_is_active(fVoices[i].ks)) {
-                synth_voice_manager_stop_voice(fVoiceManager, i);
-                fVoices[i].active = false;
+            for (int i = 0; i < KS_VOICES; i++) {
+                if (fVoices[i].active && !synth_karplus_is_active(fVoices[i].ks)) {
+                    synth_voice_manager_stop_voice(fVoiceManager, i);
+                    fVoices[i].active = false;
+                }
             }
 
-            mixL += sample;
-            mixR += sample;
-        }
+            // Per-voice reduction for 8 voices + volume control
+            const float gain = 0.15f * fVolume;
 
-        // Per-voice reduction for 8 voices + volume control
-        mixL *= 0.15f * fVolume;
-        mixR *= 0.15f * fVolume;
+            for (uint32_t j = 0; j < n; j++) {
+                float mix = mixL[j] * gain;
 
-        // Soft clipping
-        if (mixL > 1.0f) mixL = 1.0f;
-        if (mixL < -1.0f) mixL = -1.0f;
-        if (mixR > 1.0f) mixR = 1.0f;
-        if (mixR < -1.0f) mixR = -1.0f;
+                // Soft clipping
+                if (mix > 1.0f) mix = 1.0f;
+                if (mix < -1.0f) mix = -1.0f;
 
-        outL[framePos] = mixL;
-        outR[framePos] = mixR;
+                mixL[j] = mix;
+                mixR[j] = mix;
+            }
+
+            framePos += n;
+            count -= n;
+        }
     }
 
     SynthVoiceManager* fVoiceManager;
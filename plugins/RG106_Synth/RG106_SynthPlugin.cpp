@@ -5,6 +5,7 @@
 #include "../../synth/synth_lfo.h"
 #include "../../synth/synth_voice_manager.h"
 #include "../../synth/synth_chorus.h"
+#include "../../synth/synth_mod_matrix.h"
 #include <cstring>
 #include <cmath>
 
@@ -23,6 +24,22 @@ struct Juno106Voice {
     float current_freq;
     float target_freq;
     bool sliding;
+    float env_block[SYNTH_MOD_CONTROL_BLOCK]; // Envelope for the current sub-block
+    SynthModVoice mod;
+};
+
+// Modulation routes (amounts follow the panel parameters)
+enum {
+    kRouteLFOPitch = 0,
+    kRouteWheelPitch,
+    kRouteBendPitch,
+    kRouteLFOCutoff,
+    kRouteEnvCutoff,
+    kRouteKeyCutoff,
+    kRouteAftertouchCutoff,
+    kRouteLFOPulseWidth,
+    kRouteLFOAmp,
+    kRouteCount
 };
 
 class RG106_SynthPlugin : public Plugin
@@ -75,6 +92,8 @@ public:
             fVoices[i].current_freq = 440.0f;
             fVoices[i].target_freq = 440.0f;
             fVoices[i].sliding = false;
+            std::memset(fVoices[i].env_block, 0, sizeof(fVoices[i].env_block));
+            synth_mod_voice_init(&fVoices[i].mod);
 
             if (fVoices[i].osc) {
                 synth_oscillator_set_waveform(fVoices[i].osc, SYNTH_OSC_SAW);
@@ -86,6 +105,19 @@ public:
 
         updateEnvelope();
 
+        // Routes are added in kRoute* order; amounts are set from parameters
+        synth_mod_matrix_init(&fModMatrix);
+        synth_mod_matrix_add_route(&fModMatrix, SYNTH_MOD_SRC_LFO1, SYNTH_MOD_SRC_NONE, SYNTH_MOD_DST_PITCH, 0.0f);
+        synth_mod_matrix_add_route(&fModMatrix, SYNTH_MOD_SRC_LFO1, SYNTH_MOD_SRC_MOD_WHEEL, SYNTH_MOD_DST_PITCH, 0.85f);
+        synth_mod_matrix_add_route(&fModMatrix, SYNTH_MOD_SRC_PITCH_BEND, SYNTH_MOD_SRC_NONE, SYNTH_MOD_DST_PITCH, 2.0f);
+        synth_mod_matrix_add_route(&fModMatrix, SYNTH_MOD_SRC_LFO1, SYNTH_MOD_SRC_NONE, SYNTH_MOD_DST_CUTOFF, 0.0f);
+        synth_mod_matrix_add_route(&fModMatrix, SYNTH_MOD_SRC_ENV1, SYNTH_MOD_SRC_NONE, SYNTH_MOD_DST_CUTOFF, 0.0f);
+        synth_mod_matrix_add_route(&fModMatrix, SYNTH_MOD_SRC_KEY, SYNTH_MOD_SRC_NONE, SYNTH_MOD_DST_CUTOFF, 0.0f);
+        synth_mod_matrix_add_route(&fModMatrix, SYNTH_MOD_SRC_AFTERTOUCH, SYNTH_MOD_SRC_NONE, SYNTH_MOD_DST_CUTOFF, 0.3f);
+        synth_mod_matrix_add_route(&fModMatrix, SYNTH_MOD_SRC_LFO1, SYNTH_MOD_SRC_NONE, SYNTH_MOD_DST_PULSE_WIDTH, 0.0f);
+        synth_mod_matrix_add_route(&fModMatrix, SYNTH_MOD_SRC_LFO1, SYNTH_MOD_SRC_NONE, SYNTH_MOD_DST_AMP, 0.0f);
+        updateModRoutes();
+
         if (fLFO) {
             synth_lfo_set_waveform(fLFO, SYNTH_LFO_TRIANGLE);
             synth_lfo_set_frequency(fLFO, fLFORate);
@@ -321,6 +353,12 @@ protected:
     }
 
     void setParameterValue(uint32_t index, float value) override
+    {
+        setParameterInternal(index, value);
+        updateModRoutes();
+    }
+
+    void setParameterInternal(uint32_t index, float value)
     {
         switch (index) {
         case kParameterPulseWidth: fPulseWidth = value; break;
@@ -390,16 +428,26 @@ protected:
             const MidiEvent& event = midiEvents[i];
 
             // Render audio up to this event
-            while (framePos < event.frame) {
-                renderFrame(outL, outR, framePos, sampleRate);
-                framePos++;
+            if (framePos < event.frame) {
+                renderBlock(outL, outR, framePos, event.frame - framePos, sampleRate);
+                framePos = event.frame;
             }
 
             // Handle MIDI event
-            if (event.size != 3)
+            if (event.size < 2)
                 continue;
 
             const uint8_t status = event.data[0] & 0xF0;
+
+            // Channel pressure is the only 2-byte message we use
+            if (status == 0xD0) {
+                synth_mod_matrix_set_source(&fModMatrix, SYNTH_MOD_SRC_AFTERTOUCH, event.data[1] / 127.0f);
+                continue;
+            }
+
+            if (event.size != 3)
+                continue;
+
             const uint8_t note = event.data[1];
             const uint8_t velocity = event.data[2];
 
@@ -407,17 +455,32 @@ protected:
                 handleNoteOn(note, velocity, sampleRate);
             } else if (status == 0x80 || (status == 0x90 && velocity == 0)) {
                 handleNoteOff(note);
+            } else if (status == 0xB0 && note == 1) {
+                synth_mod_matrix_set_source(&fModMatrix, SYNTH_MOD_SRC_MOD_WHEEL, velocity / 127.0f);
+            } else if (status == 0xE0) {
+                const int bend = ((velocity << 7) | note) - 8192;
+                synth_mod_matrix_set_source(&fModMatrix, SYNTH_MOD_SRC_PITCH_BEND, bend / 8192.0f);
             }
         }
 
         // Render remaining frames
-        while (framePos < frames) {
-            renderFrame(outL, outR, framePos, sampleRate);
-            framePos++;
+        if (framePos < frames) {
+            renderBlock(outL, outR, framePos, frames - framePos, sampleRate);
         }
     }
 
 private:
+    void updateModRoutes()
+    {
+        // LFO pitch depth: +/-5% max (~0.85 semitones)
+        synth_mod_matrix_set_amount(&fModMatrix, kRouteLFOPitch, fLFOPitchDepth * 0.85f);
+        synth_mod_matrix_set_amount(&fModMatrix, kRouteLFOCutoff, fLFOMod * 0.3f);
+        synth_mod_matrix_set_amount(&fModMatrix, kRouteEnvCutoff, fEnvMod);
+        synth_mod_matrix_set_amount(&fModMatrix, kRouteKeyCutoff, fKeyboardTracking * 0.5f);
+        synth_mod_matrix_set_amount(&fModMatrix, kRouteLFOPulseWidth, fPWM * 0.4f);
+        synth_mod_matrix_set_amount(&fModMatrix, kRouteLFOAmp, fLFOAmpDepth * 0.5f);
+    }
+
     void updateEnvelope()
     {
         for (int i = 0; i < JUNO_VOICES; i++) {
@@ -463,6 +526,11 @@ private:
             synth_envelope_trigger(voice->envelope);
         }
 
+        // Per-voice modulation sources; the next control block snaps to them
+        synth_mod_voice_set_source(&voice->mod, SYNTH_MOD_SRC_VELOCITY, velocity / 127.0f);
+        synth_mod_voice_set_source(&voice->mod, SYNTH_MOD_SRC_KEY, (note - 60) / 60.0f);
+        if (!voice->active) voice->mod.primed = 0;
+
         voice->active = true;
     }
 
@@ -479,21 +547,40 @@ private:
         }
     }
 
-    void renderFrame(float* outL, float* outR, uint32_t framePos, int sampleRate)
+    void renderBlock(float* outL, float* outR, uint32_t framePos, uint32_t count, int sampleRate)
     {
-        float mixL = 0.0f;
-        float mixR = 0.0f;
+        while (count > 0) {
+            const uint32_t n = count < SYNTH_MOD_CONTROL_BLOCK ? count : SYNTH_MOD_CONTROL_BLOCK;
+
+            // Control-rate sources: evaluated once per sub-block
+            const float lfo_value = fLFO ? synth_lfo_process_block(fLFO, (int)n, sampleRate) : 0.0f;
+            synth_mod_matrix_set_source(&fModMatrix, SYNTH_MOD_SRC_LFO1, lfo_value);
+
+            // The envelope runs ahead for the sub-block, so the route ramps
+            // to where the envelope ends up rather than where it was
+            for (int i = 0; i < JUNO_VOICES; i++) {
+                Juno106Voice* voice = &fVoices[i];
+                if (!voice->active) continue;
+                for (uint32_t j = 0; j < n; j++) {
+                    voice->env_block[j] = synth_envelope_process(voice->envelope, sampleRate);
+                }
+                synth_mod_voice_set_source(&voice->mod, SYNTH_MOD_SRC_ENV1, voice->env_block[n - 1]);
+                synth_mod_matrix_update_voice(&fModMatrix, &voice->mod, (int)n);
+            }
 
-        // Get LFO value
-        float lfo_value = fLFO ? synth_lfo_process(fLFO, sampleRate) : 0.0f;
+            for (uint32_t j = 0; j < n; j++) {
+                renderFrame(outL, outR, framePos + j, j, sampleRate);
+            }
 
-        // PWM
-        float pw = fPulseWidth;
-        if (fPWM > 0.0f) {
-            pw += lfo_value * fPWM * 0.4f;
-            if (pw < 0.1f) pw = 0.1f;
-            if (pw > 0.9f) pw = 0.9f;
+            framePos += n;
+            count -= n;
         }
+    }
+
+    void renderFrame(float* outL, float* outR, uint32_t framePos, uint32_t blockPos, int sampleRate)
+    {
+        float mixL = 0.0f;
+        float mixR = 0.0f;
 
         // Render all voices
         for (int i = 0; i < JUNO_VOICES; i++) {
@@ -507,6 +594,9 @@ private:
 
             Juno106Voice* voice = &fVoices[i];
 
+            // Advance modulation ramps towards the next control point
+            synth_mod_voice_tick(&voice->mod);
+
             // Handle portamento
             if (voice->sliding && fPortamento > 0.0f) {
                 float slide_time = 0.001f + fPortamento * 0.5f; // 1ms to 500ms
@@ -520,19 +610,17 @@ private:
                     voice->sliding = false;
                 }
 
-                synth_oscillator_set_frequency(voice->osc, voice->current_freq);
-                synth_oscillator_set_frequency(voice->sub_osc, voice->current_freq * 0.5f);
             }
 
-            // LFO to pitch (vibrato)
-            if (fLFOPitchDepth > 0.0f) {
-                float pitch_mod = 1.0f + (lfo_value * fLFOPitchDepth * 0.05f); // ±5% max
-                float current_freq = voice->sliding ? voice->current_freq : (440.0f * powf(2.0f, (voice->note - 69) / 12.0f));
-                synth_oscillator_set_frequency(voice->osc, current_freq * pitch_mod);
-                synth_oscillator_set_frequency(voice->sub_osc, current_freq * 0.5f * pitch_mod);
-            }
+            // Pitch modulation (vibrato, wheel, bend) as a ramped frequency ratio
+            const float freq = voice->current_freq * voice->mod.pitch_ratio;
+            synth_oscillator_set_frequency(voice->osc, freq);
+            synth_oscillator_set_frequency(voice->sub_osc, freq * 0.5f);
 
-            // Set pulse width
+            // Set pulse width (PWM)
+            float pw = fPulseWidth + voice->mod.value[SYNTH_MOD_DST_PULSE_WIDTH];
+            if (pw < 0.1f) pw = 0.1f;
+            if (pw > 0.9f) pw = 0.9f;
             synth_oscillator_set_pulse_width(voice->osc, pw);
 
             // Generate oscillators (Juno: saw + square mixed internally)
@@ -548,7 +636,7 @@ private:
             float sample = saw_sample * 0.5f + square_sample * 0.5f + sub_sample;
 
             // Envelope
-            float env_value = synth_envelope_process(voice->envelope, sampleRate);
+            const float env_value = voice->env_block[blockPos];
 
             // Check if voice finished
             if (env_value <= 0.0f && meta->state == VOICE_RELEASING) {
@@ -560,16 +648,8 @@ private:
             // Update amplitude for voice stealing
             synth_voice_manager_update_amplitude(fVoiceManager, i, env_value);
 
-            // Filter cutoff with modulation
-            float cutoff = fCutoff;
-            cutoff += fEnvMod * env_value;
-            cutoff += fLFOMod * lfo_value * 0.3f;
-
-            // Keyboard tracking
-            if (fKeyboardTracking > 0.0f) {
-                float note_offset = (meta->note - 60) / 60.0f;
-                cutoff += note_offset * fKeyboardTracking * 0.5f;
-            }
+            // Filter cutoff with modulation (envelope, LFO, keyboard tracking, aftertouch)
+            float cutoff = fCutoff + voice->mod.value[SYNTH_MOD_DST_CUTOFF];
 
             if (cutoff > 1.0f) cutoff = 1.0f;
             if (cutoff < 0.0f) cutoff = 0.0f;
@@ -583,9 +663,7 @@ private:
             sample *= env_value * fVCALevel;
 
             // LFO to amplitude (tremolo)
-            if (fLFOAmpDepth > 0.0f) {
-                sample *= 1.0f + lfo_value * fLFOAmpDepth * 0.5f;
-            }
+            sample *= 1.0f + voice->mod.value[SYNTH_MOD_DST_AMP];
 
             // Velocity sensitivity
             if (fVelocitySensitivity > 0.0f) {
@@ -630,6 +708,7 @@ private:
     // Shared components
     SynthLFO* fLFO;
     SynthChorus* fChorus;
+    SynthModMatrix fModMatrix;
 
     // Parameters
     float fPulseWidth;
@@ -11,7 +11,9 @@ extern "C" {
 
 START_NAMESPACE_DISTRHO
 
-#define PIANO_VOICES 8
+#define PIANO_VOICES 16
+#define PIANO_MODES 64
+#define RENDER_CHUNK 64
 
 struct PianoVoice {
     ModalPiano* piano;
@@ -30,6 +32,7 @@ public:
         , fLfoRate(0.3f)
         , fLfoDepth(0.2f)
         , fMidi(nullptr)
+        , fModeTable(nullptr)
     {
         // Initialize sample data structure
         fSampleData.attack_data = m1piano_onset;
@@ -42,12 +45,18 @@ public:
         // Create MIDI handler with polyphonic voice allocation
         fMidi = synth_midi_create(PIANO_VOICES, VOICE_ALLOC_POLYPHONIC);
 
+        // Per-key partials are precomputed once and shared by all voices
+        fModeTable = synth_modal_table_create((float)getSampleRate(), PIANO_MODES);
+
         // Create voices
         for (int i = 0; i < PIANO_VOICES; i++) {
             fVoices[i].piano = modal_piano_create();
 
             if (fVoices[i].piano) {
                 modal_piano_load_sample(fVoices[i].piano, &fSampleData);
+                modal_piano_set_mode_count(fVoices[i].piano, PIANO_MODES);
+                modal_piano_set_sample_rate(fVoices[i].piano, (float)getSampleRate());
+                modal_piano_set_mode_table(fVoices[i].piano, fModeTable);
                 updateVoice(i);
             }
         }
@@ -66,6 +75,8 @@ public:
                 modal_piano_destroy(fVoices[i].piano);
             }
         }
+
+        synth_modal_table_destroy(fModeTable);
     }
 
 protected:
@@ -170,6 +181,22 @@ protected:
         }
     }
 
+    void sampleRateChanged(double newSampleRate) override
+    {
+        // Rebuild the shared mode table for the new rate
+        SynthModalTable* table = synth_modal_table_create((float)newSampleRate, PIANO_MODES);
+
+        for (int i = 0; i < PIANO_VOICES; i++) {
+            if (fVoices[i].piano) {
+                modal_piano_set_sample_rate(fVoices[i].piano, (float)newSampleRate);
+                modal_piano_set_mode_table(fVoices[i].piano, table);
+            }
+        }
+
+        synth_modal_table_destroy(fModeTable);
+        fModeTable = table;
+    }
+
     void run(const float**, float** outputs, uint32_t frames,
              const MidiEvent* midiEvents, uint32_t midiEventCount) override
     {
@@ -185,9 +212,9 @@ protected:
             const MidiEvent& event = midiEvents[i];
 
             // Render frames up to this event
-            while (framePos < event.frame) {
-                renderFrame(outL, outR, framePos, sampleRate);
-                framePos++;
+            if (framePos < event.frame) {
+                renderBlock(outL, outR, framePos, event.frame - framePos, sampleRate);
+                framePos = event.frame;
             }
 
             // Parse MIDI message using tracker_midi
@@ -229,9 +256,8 @@ protected:
         }
 
         // Render remaining frames
-        while (framePos < frames) {
-            renderFrame(outL, outR, framePos, sampleRate);
-            framePos++;
+        if (framePos < frames) {
+            renderBlock(outL, outR, framePos, frames - framePos, sampleRate);
         }
     }
 
@@ -297,53 +323,62 @@ private:
         }
     }
 
-    void renderFrame(float* outL, float* outR, uint32_t framePos, int sampleRate)
+    void renderBlock(float* outL, float* outR, uint32_t framePos, uint32_t count, int sampleRate)
     {
-        float mixL = 0.0f, mixR = 0.0f;
+        float voiceBuf[RENDER_CHUNK];
 
-        for (int i = 0; i < PIANO_VOICES; i++) {
-            // Check if voice is active via MIDI handler
-            if (!fMidi || !fMidi->voices[i].active || !fVoices[i].piano) {
-                continue;
-            }
+        while (count > 0) {
+            const uint32_t n = count < RENDER_CHUNK ? count : RENDER_CHUNK;
+            float* mixL = outL + framePos;
+            float* mixR = outR + framePos;
 
-            // Process piano voice
-            float sample = modal_piano_process(fVoices[i].piano, sampleRate);
+            std::memset(mixL, 0, n * sizeof(float));
 
-            // Release voice if piano is no longer active
-            if (!modal_piano_is_active(fVoices[i].piano)) {
-                synth_midi_release_voice(fMidi, i);
-                continue;
+            for (int i = 0; i < PIANO_VOICES; i++) {
+                // Check if voice is active via MIDI handler
+                if (!fMidi || !fMidi->voices[i].active || !fVoices[i].piano) {
+                    continue;
+                }
+
+                // Process piano voice (modal bank runs a block at a time)
+                modal_piano_process_block(fVoices[i].piano, voiceBuf, n, sampleRate);
+
+                for (uint32_t j = 0; j < n; j++) {
+                    mixL[j] += voiceBuf[j];
+                }
+
+                // Release voice if piano is no longer active
+                if (!modal_piano_is_active(fVoices[i].piano)) {
+                    synth_midi_release_voice(fMidi, i);
+                }
             }
 
-            mixL += sample;
-            mixR += sample;
-        }
+            // Per-voice reduction + volume control
+            const float gain = 0.2f * fVolume;
 
-        // Per-voice reduction for 8 voices + volume control
-        mixL *= 0.2f * fVolume;
-        mixR *= 0.2f * fVolume;
+            for (uint32_t j = 0; j < n; j++) {
+                float mix = mixL[j] * gain;
 
-        // Soft clipping
-        if (mixL > 1.0f) {
-            mixL = 1.0f - expf(-(mixL - 1.0f));
-        } else if (mixL < -1.0f) {
-            mixL = -1.0f + expf(mixL + 1.0f);
-        }
+                // Soft clipping
+                if (mix > 1.0f) {
+                    mix = 1.0f - expf(-(mix - 1.0f));
+                } else if (mix < -1.0f) {
+                    mix = -1.0f + expf(mix + 1.0f);
+                }
 
-        if (mixR > 1.0f) {
-            mixR = 1.0f - expf(-(mixR - 1.0f));
-        } else if (mixR < -1.0f) {
-            mixR = -1.0f + expf(mixR + 1.0f);
-        }
+                mixL[j] = mix;
+                mixR[j] = mix;
+            }
 
-        outL[framePos] = mixL;
-        outR[framePos] = mixR;
+            framePos += n;
+            count -= n;
+        }
     }
 
     SampleData fSampleData;
     PianoVoice fVoices[PIANO_VOICES];
     SynthMidiHandler* fMidi;
+    SynthModalTable* fModeTable;
 
     float fDecay, fResonance, fBrightness, fVelocitySens, fVolume;
     float fLfoRate, fLfoDepth;
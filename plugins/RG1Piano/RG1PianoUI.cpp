@@ -99,7 +99,7 @@ private:
 
                 // Info text
                 ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.7f, 0.7f, 0.7f, 1.0f));
-                const char* info = "M1 Piano | 8-voice Polyphonic | Modal Synthesis";
+                const char* info = "M1 Piano | 16-voice Polyphonic | Modal Synthesis";
                 ImGui::SetCursorPosX((width - ImGui::CalcTextSize(info).x) * 0.5f);
                 ImGui::Text("%s", info);
                 ImGui::PopStyleColor();
@@ -10,10 +10,13 @@
 #include "../../synth/synth_modal_piano.h"
 #include "../../data/rg1piano/sample_data.h"
 
-#define MAX_VOICES 8
+#define MAX_VOICES 16
+#define MAX_MODES 64
+#define RENDER_CHUNK 128
 
 typedef struct {
     ModalPiano* voices[MAX_VOICES];
+    SynthModalTable* mode_table;  // Per-key partials shared by all voices
     SampleData sample_data;
     bool voice_active[MAX_VOICES];
     uint8_t voice_note[MAX_VOICES];
@@ -71,7 +74,6 @@ static void update_voice_params(RG1PianoWASM* synth, int voice_idx) {
 EMSCRIPTEN_KEEPALIVE
 RG1PianoWASM* regroove_synth_create(int engine, float sample_rate) {
     (void)engine;
-    (void)sample_rate;
 
     RG1PianoWASM* synth = (RG1PianoWASM*)malloc(sizeof(RG1PianoWASM));
     if (!synth) return NULL;
@@ -86,11 +88,16 @@ RG1PianoWASM* regroove_synth_create(int engine, float sample_rate) {
     synth->sample_data.sample_rate = M1PIANO_SAMPLE_RATE;
     synth->sample_data.root_note = M1PIANO_ROOT_NOTE;
 
+    synth->mode_table = synth_modal_table_create(sample_rate, MAX_MODES);
+
     // Create voices
     for (int i = 0; i < MAX_VOICES; i++) {
         synth->voices[i] = modal_piano_create();
         if (synth->voices[i]) {
             modal_piano_load_sample(synth->voices[i], &synth->sample_data);
+            modal_piano_set_mode_count(synth->voices[i], MAX_MODES);
+            modal_piano_set_sample_rate(synth->voices[i], sample_rate);
+            modal_piano_set_mode_table(synth->voices[i], synth->mode_table);
         }
         synth->voice_active[i] = false;
         synth->voice_note[i] = 0;
@@ -123,6 +130,7 @@ void regroove_synth_destroy(RG1PianoWASM* synth) {
         }
     }
 
+    synth_modal_table_destroy(synth->mode_table);
     free(synth);
 }
 
@@ -205,21 +213,29 @@ void regroove_synth_process_f32(RG1PianoWASM* synth, float* buffer, int frames,
     // Clear buffer
     memset(buffer, 0, frames * 2 * sizeof(float));
 
-    // Process each voice
+    // Process each voice a block at a time
+    float voice_buf[RENDER_CHUNK];
+    const float gain = synth->volume * 0.3f;
+
     for (int i = 0; i < MAX_VOICES; i++) {
         if (!synth->voice_active[i] || !synth->voices[i]) continue;
 
-        for (int frame = 0; frame < frames; frame++) {
-            float sample = modal_piano_process(synth->voices[i], (uint32_t)sample_rate);
+        for (int start = 0; start < frames; start += RENDER_CHUNK) {
+            int n = frames - start;
+            if (n > RENDER_CHUNK) n = RENDER_CHUNK;
 
-            // Check if voice is still active
-            if (!modal_piano_is_active(synth->voices[i])) {
-                synth->voice_active[i] = false;
-            }
+            modal_piano_process_block(synth->voices[i], voice_buf, (uint32_t)n, (uint32_t)sample_rate);
 
             // Mix to stereo interleaved buffer with volume
-            buffer[frame * 2 + 0] += sample * synth->volume * 0.3f;  // Left
-            buffer[frame * 2 + 1] += sample * synth->volume * 0.3f;  // Right
+            for (int frame = 0; frame < n; frame++) {
+                buffer[(start + frame) * 2 + 0] += voice_buf[frame] * gain;  // Left
+                buffer[(start + frame) * 2 + 1] += voice_buf[frame] * gain;  // Right
+            }
+        }
+
+        // Check if voice is still active
+        if (!modal_piano_is_active(synth->voices[i])) {
+            synth->voice_active[i] = false;
         }
     }
 
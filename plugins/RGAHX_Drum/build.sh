@@ -16,6 +16,7 @@ rgahxdrum.c
 ../../synth/ahx_plist.c
 ../../synth/ahx_waves.c
 ../../players/tracker_voice.c
+../../effects/fx_resampler.c
 ../../players/tracker_modulator.c
 "
 
@@ -11,6 +11,7 @@
 #include <stdbool.h>
 #include "../../synth/ahx_preset.h"
 #include "../../synth/ahx_instrument.h"
+#include "../../synth/ahx_waves.h"
 
 // Embedded presets
 #include "preset_kick.h"
@@ -29,6 +30,7 @@ typedef struct {
     AhxInstrumentParams* presets[MAX_PRESETS];
     int preset_count;
     RGAHXDrumVoice voices[MAX_VOICES];
+    const AhxWaves* waves;  // Reference held for the voices
     uint32_t sample_rate;
 } RGAHXDrum;
 
@@ -48,6 +50,7 @@ RGAHXDrum* rgahxdrum_create(uint32_t sample_rate) {
     if (!drum) return NULL;
 
     drum->sample_rate = sample_rate;
+    drum->waves = ahx_waves_acquire();
 
     // Copy preset pointers directly (no file loading needed!)
     drum->preset_count = PRESET_MAP_SIZE;
@@ -69,6 +72,7 @@ void rgahxdrum_destroy(RGAHXDrum* drum) {
 
     // Presets are statically embedded, no need to free them
 
+    ahx_waves_release(drum->waves);
     free(drum);
 }
 
@@ -6,6 +6,7 @@
 
 extern "C" {
 #include "../../synth/ahx_instrument.h"
+#include "../../synth/ahx_waves.h"
 #include "../../synth/synth_midi.h"
 }
 
@@ -28,6 +29,9 @@ public:
         , fMidi(nullptr)
         , fMasterVolume(0.7f)
     {
+        // Build (or share) the wave tables here, not on the first note
+        fWaves = ahx_waves_acquire();
+
         // Create MIDI handler with polyphonic voice allocation
         fMidi = synth_midi_create(MAX_VOICES, VOICE_ALLOC_POLYPHONIC);
 
@@ -48,6 +52,7 @@ public:
         if (fMidi) {
             synth_midi_destroy(fMidi);
         }
+        ahx_waves_release(fWaves);
     }
 
 protected:
@@ -570,6 +575,7 @@ private:
 
     AhxVoice fVoices[MAX_VOICES];
     SynthMidiHandler* fMidi;
+    const AhxWaves* fWaves;  // Reference held for the voices
     AhxInstrumentParams fParams;
     float fMasterVolume;
 
@@ -7,12 +7,14 @@
 #include <stdlib.h>
 #include <string.h>
 #include "synth/ahx_instrument.h"
+#include "synth/ahx_waves.h"
 
 // Simple polyphonic wrapper (max 8 voices)
 #define MAX_VOICES 8
 
 typedef struct {
     AhxInstrument voices[MAX_VOICES];
+    const AhxWaves* waves;  // Reference held for the voices
     float sample_rate;
     uint8_t voice_notes[MAX_VOICES];  // Track which note each voice is playing
 } AhxSynthInstance;
@@ -26,6 +28,7 @@ AhxSynthInstance* regroove_synth_create(int engine, float sample_rate) {
     if (!instance) return NULL;
 
     instance->sample_rate = sample_rate;
+    instance->waves = ahx_waves_acquire();
 
     // Initialize all voices
     for (int i = 0; i < MAX_VOICES; i++) {
@@ -39,6 +42,7 @@ AhxSynthInstance* regroove_synth_create(int engine, float sample_rate) {
 EMSCRIPTEN_KEEPALIVE
 void regroove_synth_destroy(AhxSynthInstance* synth) {
     if (synth) {
+        ahx_waves_release(synth->waves);
         free(synth);
     }
 }
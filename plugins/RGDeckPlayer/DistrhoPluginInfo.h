@@ -8,7 +8,7 @@
 
 // Display strings
 #define RGDECKPLAYER_DISPLAY_NAME "RGDeckPlayer - Unified Tracker Player"
-#define RGDECKPLAYER_DESCRIPTION "MOD/MED/AHX/SID File Player"
+#define RGDECKPLAYER_DESCRIPTION "MOD/MED/AHX/SID/XM/S3M/IT File Player"
 #define RGDECKPLAYER_WINDOW_TITLE "RGDeckPlayer"
 
 #define DISTRHO_PLUGIN_BRAND "Regroove"
@@ -2,14 +2,22 @@
 
 extern "C" {
 #include "../../players/deck_player.h"
+#include "../../common/mapped_file.h"
 }
 
 #include <cstring>
 #include <cmath>
 #include <cstdio>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
 
 START_NAMESPACE_DISTRHO
 
+// How far ahead the deck is rendered off the audio thread
+static constexpr uint32_t kLookaheadMs = 40;
+
 class RGDeckPlayerPlugin : public Plugin
 {
 public:
@@ -27,9 +35,16 @@ public:
         , fNativeBPM(125)
         , fCurrentOrder(0)
         , fCurrentRow(0)
+        , fNumChannels(4)
     {
-        // Create Deck player (supports MOD/MED/AHX/SID)
+        // Create Deck player (supports MOD/MED/AHX/SID/XM/S3M/IT)
         fDeckPlayer = deck_player_create();
+        fFilename[0] = '\0';
+        fPendingIndex.store(nullptr);
+
+        // Render ahead on a worker thread so run() only copies blocks out;
+        // without thread support the deck renders inside run()
+        fLookahead = deck_player_set_lookahead(fDeckPlayer, kLookaheadMs, (int)getSampleRate());
 
         // Initialize channel parameters (16 channels)
         for (int i = 0; i < 16; i++) {
@@ -51,11 +66,14 @@ public:
         // Set position callback
         deck_player_set_position_callback(fDeckPlayer, positionCallback, this);
 
-        updateChannelControls();
+        updateChannelControls(fDeckPlayer);
     }
 
     ~RGDeckPlayerPlugin() override
     {
+        waitForSeekIndex();
+        deck_seek_index_destroy(fPendingIndex.exchange(nullptr));
+
         if (fDeckPlayer) {
             deck_player_destroy(fDeckPlayer);
         }
@@ -322,34 +340,44 @@ protected:
 
     void setParameterValue(uint32_t index, float value) override
     {
+        // Loads and seek index attachment hold the deck; changes made
+        // meanwhile are only stored (a load resets the deck anyway). The
+        // position outputs come from process(), which holds the lock when
+        // the deck renders inline.
+        std::unique_lock<std::mutex> deckLock(fDeckMutex, std::defer_lock);
+        DeckPlayer* deck = nullptr;
+        if (index != kParameterCurrentOrder && index != kParameterCurrentRow && deckLock.try_lock()) {
+            deck = fDeckPlayer;
+        }
+
         switch (index) {
         case kParameterPlay:
             fPlaying = value;  // ALWAYS update state first
 
             if (value > 0.5f) {
                 // Start playback
-                if (fDeckPlayer) {
-                    deck_player_start(fDeckPlayer);
+                if (deck) {
+                    deck_player_start(deck);
                 }
             } else {
                 // Stop playback
-                if (fDeckPlayer) {
-                    deck_player_stop(fDeckPlayer);
+                if (deck) {
+                    deck_player_stop(deck);
                 }
             }
             break;
 
         case kParameterLoopPattern:
             fLoopPattern = value;
-            if (fDeckPlayer) {
+            if (deck) {
                 if (value > 0.5f) {
                     // Loop current pattern
-                    deck_player_set_loop_range(fDeckPlayer, fCurrentOrder, fCurrentOrder);
+                    deck_player_set_loop_range(deck, fCurrentOrder, fCurrentOrder);
                 } else {
                     // Loop full song
-                    uint8_t len = deck_player_get_song_length(fDeckPlayer);
+                    uint8_t len = deck_player_get_song_length(deck);
                     if (len > 0) {
-                        deck_player_set_loop_range(fDeckPlayer, 0, len - 1);
+                        deck_player_set_loop_range(deck, 0, len - 1);
                     }
                 }
             }
@@ -358,8 +386,8 @@ protected:
         case kParameterPrevPattern:
             if (value > 0.5f && fPrevPattern <= 0.5f) {
                 // Trigger: go to previous pattern
-                if (fDeckPlayer && fCurrentOrder > 0) {
-                    deck_player_set_position(fDeckPlayer, fCurrentOrder - 1, 0);
+                if (deck && fCurrentOrder > 0) {
+                    deck_player_set_position(deck, fCurrentOrder - 1, 0);
                 }
             }
             fPrevPattern = value;
@@ -368,10 +396,10 @@ protected:
         case kParameterNextPattern:
             if (value > 0.5f && fNextPattern <= 0.5f) {
                 // Trigger: go to next pattern
-                if (fDeckPlayer) {
-                    uint8_t len = deck_player_get_song_length(fDeckPlayer);
+                if (deck) {
+                    uint8_t len = deck_player_get_song_length(deck);
                     if (fCurrentOrder < len - 1) {
-                        deck_player_set_position(fDeckPlayer, fCurrentOrder + 1, 0);
+                        deck_player_set_position(deck, fCurrentOrder + 1, 0);
                     }
                 }
             }
@@ -380,24 +408,24 @@ protected:
 
         case kParameterLoopStart:
             fLoopStart = value;
-            if (fDeckPlayer) {
-                deck_player_set_loop_range(fDeckPlayer, (uint16_t)fLoopStart, (uint16_t)fLoopEnd);
+            if (deck) {
+                deck_player_set_loop_range(deck, (uint16_t)fLoopStart, (uint16_t)fLoopEnd);
             }
             break;
 
         case kParameterLoopEnd:
             fLoopEnd = value;
-            if (fDeckPlayer) {
-                deck_player_set_loop_range(fDeckPlayer, (uint16_t)fLoopStart, (uint16_t)fLoopEnd);
+            if (deck) {
+                deck_player_set_loop_range(deck, (uint16_t)fLoopStart, (uint16_t)fLoopEnd);
             }
             break;
 
         case kParameterBPM:
             fBPM = value;  // Store tempo multiplier (0.9 - 1.1)
-            if (fDeckPlayer) {
+            if (deck) {
                 // Apply multiplier to native BPM
                 uint16_t actual_bpm = (uint16_t)(fNativeBPM * fBPM);
-                deck_player_set_bpm(fDeckPlayer, actual_bpm);
+                deck_player_set_bpm(deck, actual_bpm);
             }
             break;
 
@@ -409,19 +437,19 @@ protected:
             fMasterMute = value;
             break;
 
-        case kParameterCh1Mute: fChannelMute[0] = value; updateChannelControls(); break;
+        case kParameterCh1Mute: fChannelMute[0] = value; updateChannelControls(deck); break;
         case kParameterCh1Volume: fChannelVolume[0] = value; break;
         case kParameterCh1Pan: fChannelPan[0] = value; break;
 
-        case kParameterCh2Mute: fChannelMute[1] = value; updateChannelControls(); break;
+        case kParameterCh2Mute: fChannelMute[1] = value; updateChannelControls(deck); break;
         case kParameterCh2Volume: fChannelVolume[1] = value; break;
         case kParameterCh2Pan: fChannelPan[1] = value; break;
 
-        case kParameterCh3Mute: fChannelMute[2] = value; updateChannelControls(); break;
+        case kParameterCh3Mute: fChannelMute[2] = value; updateChannelControls(deck); break;
         case kParameterCh3Volume: fChannelVolume[2] = value; break;
         case kParameterCh3Pan: fChannelPan[2] = value; break;
 
-        case kParameterCh4Mute: fChannelMute[3] = value; updateChannelControls(); break;
+        case kParameterCh4Mute: fChannelMute[3] = value; updateChannelControls(deck); break;
         case kParameterCh4Volume: fChannelVolume[3] = value; break;
         case kParameterCh4Pan: fChannelPan[3] = value; break;
         }
@@ -444,6 +472,25 @@ protected:
         }
     }
 
+    void sampleRateChanged(double newSampleRate) override
+    {
+        // Keyframes hold frame counts at the rate they were scanned at:
+        // drop them and scan again
+        waitForSeekIndex();
+        deck_seek_index_destroy(fPendingIndex.exchange(nullptr));
+        {
+            std::lock_guard<std::mutex> lock(fDeckMutex);
+            deck_player_set_seek_index(fDeckPlayer, nullptr);
+
+            // Processing is stopped here, so the worker can be restarted
+            // to render at the new rate
+            if (fLookahead) {
+                fLookahead = deck_player_set_lookahead(fDeckPlayer, kLookaheadMs, (int)newSampleRate);
+            }
+        }
+        startSeekIndex(newSampleRate);
+    }
+
     String getState(const char* key) const override
     {
         if (std::strcmp(key, "file") == 0) {
@@ -459,7 +506,13 @@ protected:
         (void)midiEvents;  // MIDI not yet implemented
         (void)midiEventCount;
 
-        if (!fDeckPlayer) {
+        // Rendering inline, a file being loaded holds the deck: output
+        // silence rather than wait for it. The look-ahead only hands out
+        // blocks rendered by its worker, which loads wait for instead.
+        std::unique_lock<std::mutex> deckLock(fDeckMutex, std::defer_lock);
+        if (!fLookahead) deckLock.try_lock();
+
+        if (!fDeckPlayer || (!fLookahead && !deckLock.owns_lock())) {
             // Clear all outputs
             for (uint32_t i = 0; i < 32; i++) {
                 std::memset(outputs[i], 0, frames * sizeof(float));
@@ -467,8 +520,18 @@ protected:
             return;
         }
 
-        // Get number of channels
-        uint8_t numChannels = deck_player_get_num_channels(fDeckPlayer);
+        // Attach a finished seek index between blocks. The deck has none
+        // at this point (loads and rate changes drop it), so nothing is
+        // freed here. With the look-ahead on, the scan thread attaches it.
+        if (!fLookahead) {
+            if (DeckSeekIndex* seekIndex = fPendingIndex.exchange(nullptr)) {
+                deck_player_set_seek_index(fDeckPlayer, seekIndex);
+            }
+        }
+
+        // Get number of channels (stored by the load, the deck may be
+        // loading another file on the control thread)
+        uint8_t numChannels = fNumChannels.load();
         if (numChannels == 0) numChannels = 4;  // Default to 4
         if (numChannels > 16) numChannels = 16;  // Cap at 16
 
@@ -570,37 +633,25 @@ private:
     uint16_t fCurrentRow;
     char fFilename[256];
 
+    std::mutex fDeckMutex;                      // Held while a file is loaded
+    std::thread fIndexThread;                   // Seek index scan of the current file
+    std::atomic<DeckSeekIndex*> fPendingIndex;  // Scanned, waiting for run() to attach it
+    std::atomic<uint8_t> fNumChannels;          // Of the loaded file, read by run()
+    bool fLookahead;                            // Deck renders on its worker thread
+
     bool loadFile(const char* filename)
     {
         if (!fDeckPlayer || !filename) return false;
 
-        // Read file
-        FILE* f = fopen(filename, "rb");
-        if (!f) return false;
-
-        fseek(f, 0, SEEK_END);
-        long size = ftell(f);
-        fseek(f, 0, SEEK_SET);
-
-        if (size <= 0 || size > 10 * 1024 * 1024) {
-            fclose(f);
-            return false;
-        }
+        // A scan of the previous file would only be rejected
+        waitForSeekIndex();
+        deck_seek_index_destroy(fPendingIndex.exchange(nullptr));
 
-        uint8_t* data = new uint8_t[size];
-        size_t read = fread(data, 1, size, f);
-        fclose(f);
+        // run() outputs silence until the new file is loaded and reset
+        std::unique_lock<std::mutex> lock(fDeckMutex);
 
-        if (read != (size_t)size) {
-            delete[] data;
-            return false;
-        }
-
-        // Try to load the file
-        bool loadSuccess = deck_player_load(fDeckPlayer, data, size);
-        delete[] data;
-
-        if (!loadSuccess) {
+        // Map and load the file (sample data is played from the mapping)
+        if (!deck_player_load_file(fDeckPlayer, filename)) {
             return false;
         }
 
@@ -608,6 +659,8 @@ private:
         std::strncpy(fFilename, filename, sizeof(fFilename) - 1);
         fFilename[sizeof(fFilename) - 1] = '\0';
 
+        fNumChannels.store(deck_player_get_num_channels(fDeckPlayer));
+
         // Get native BPM from loaded file
         fNativeBPM = deck_player_get_bpm(fDeckPlayer);
 
@@ -638,15 +691,56 @@ private:
             deck_player_set_loop_range(fDeckPlayer, 0, len - 1);
         }
 
+        lock.unlock();
+        startSeekIndex(getSampleRate());
+
         return true;
     }
 
-    void updateChannelControls()
+    // Pre-scan keyframes so pattern jumps land mid-song with the correct
+    // channel state. The scan plays the whole song, so it runs on its own
+    // thread; playback meanwhile seeks without it.
+    void startSeekIndex(double sampleRate)
+    {
+        waitForSeekIndex();
+        if (fFilename[0] == '\0') return;
+
+        const std::string path(fFilename);
+        const int rate = (int)sampleRate;
+        fIndexThread = std::thread([this, path, rate]() {
+            // Opening the file again shares the deck's mapping
+            MappedFile* file = mapped_file_open(path.c_str());
+            if (!file) return;
+
+            DeckSeekIndex* seekIndex = deck_seek_index_build(mapped_file_data(file), mapped_file_size(file),
+                                                             0, rate);
+            mapped_file_release(file);
+
+            // Loads and rate changes wait for this thread first, so the
+            // index always matches the loaded file
+            if (fLookahead) {
+                // Attaching waits for the worker: do it here, not in run()
+                std::lock_guard<std::mutex> lock(fDeckMutex);
+                deck_player_set_seek_index(fDeckPlayer, seekIndex);
+            } else {
+                fPendingIndex.store(seekIndex);
+            }
+        });
+    }
+
+    void waitForSeekIndex()
+    {
+        if (fIndexThread.joinable()) {
+            fIndexThread.join();
+        }
+    }
+
+    void updateChannelControls(DeckPlayer* deck)
     {
-        if (!fDeckPlayer) return;
+        if (!deck) return;
 
         for (int i = 0; i < 16; i++) {
-            deck_player_set_channel_mute(fDeckPlayer, i, fChannelMute[i] > 0.5f);
+            deck_player_set_channel_mute(deck, i, fChannelMute[i] > 0.5f);
         }
     }
 
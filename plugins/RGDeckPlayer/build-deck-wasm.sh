@@ -66,6 +66,8 @@ SOURCES="$SOURCES ../../players/mod_player.c"
 SOURCES="$SOURCES ../../players/mmd_player.c"
 SOURCES="$SOURCES ../../players/ahx_player.c"
 SOURCES="$SOURCES ../../players/sid_player.c"
+SOURCES="$SOURCES ../../players/xmit_player.c"
+SOURCES="$SOURCES ../../players/xmit_loader.c"
 SOURCES="$SOURCES ../../players/pattern_sequencer.c"
 
 # Shared tracker components
@@ -85,9 +87,15 @@ SOURCES="$SOURCES ../../synth/ahx_instrument.c"
 SOURCES="$SOURCES ../../synth/ahx_preset.c"
 SOURCES="$SOURCES ../../synth/ahx_plist.c"
 SOURCES="$SOURCES ../../synth/ahx_waves.c"
+SOURCES="$SOURCES ../../effects/fx_resampler.c"
+SOURCES="$SOURCES ../../effects/fx_paula_blep.c"
+
+# File loading (deck_player_load_file)
+SOURCES="$SOURCES ../../common/mapped_file.c"
 
 # CPU emulation for SID
 SOURCES="$SOURCES ../../common/cpu_6502.c"
+SOURCES="$SOURCES ../../common/c64_timing.c"
 
 # Compile
 echo "Compiling..."
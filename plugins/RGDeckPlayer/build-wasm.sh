@@ -35,6 +35,7 @@ SOURCES="$SOURCES ../../players/mmd_player.c"
 # Shared tracker components (required by players)
 SOURCES="$SOURCES ../../players/pattern_sequencer.c"
 SOURCES="$SOURCES ../../players/tracker_voice.c"
+SOURCES="$SOURCES ../../effects/fx_resampler.c"
 SOURCES="$SOURCES ../../players/tracker_mixer.c"
 
 # Build with MMD synth support
@@ -3,6 +3,7 @@
 #include "../../../players/mod_player.h"
 #include "../../../players/mmd_player.h"
 #include "../../../players/ahx_player.h"
+#include "../../../common/mapped_file.h"
 #include <thread>
 #include <atomic>
 #include <mutex>
@@ -83,6 +84,7 @@ struct RM_Deck : Module {
 	MedPlayer* medPlayer = nullptr;
 	AhxPlayer* ahxPlayer = nullptr;
 	PlayerType playerType = PlayerType::NONE;
+	MappedFile* mappedFile = nullptr;  // MOD/MED samples play from here; swapped under swapMutex
 
 	std::atomic<bool> playing{false};
 	std::atomic<bool> fileLoaded{false};
@@ -190,26 +192,27 @@ struct RM_Deck : Module {
 		if (ahxPlayer) {
 			ahx_player_destroy(ahxPlayer);
 		}
+		mapped_file_release(mappedFile);
 	}
 
 	// Helper: detect file type from content (using player detection functions)
-	PlayerType detectFileType(const std::vector<uint8_t>& fileData) {
-		if (fileData.empty()) {
+	PlayerType detectFileType(const uint8_t* data, size_t size) {
+		if (!data || size == 0) {
 			return PlayerType::NONE;
 		}
 
 		// Try MOD detection first (most common)
-		if (mod_player_detect(fileData.data(), fileData.size())) {
+		if (mod_player_detect(data, size)) {
 			return PlayerType::MOD;
 		}
 
 		// Try MMD detection
-		if (med_player_detect(fileData.data(), fileData.size())) {
+		if (med_player_detect(data, size)) {
 			return PlayerType::MED;
 		}
 
 		// Try AHX detection
-		if (ahx_player_detect(fileData.data(), fileData.size())) {
+		if (ahx_player_detect(data, size)) {
 			return PlayerType::AHX;
 		}
 
@@ -246,46 +249,33 @@ struct RM_Deck : Module {
 			}
 			std::this_thread::sleep_for(std::chrono::milliseconds(500));  // Visible delay
 
-			// Read file into memory first
-			INFO("[LOAD] About to fopen");
-			FILE* f = fopen(path.c_str(), "rb");
-			if (!f) {
-				INFO("[LOAD] ERROR: fopen failed!");
+			// Map the file (shared with any other deck playing it)
+			INFO("[LOAD] About to map file");
+			MappedFile* file = mapped_file_open(path.c_str());
+			if (!file) {
+				INFO("[LOAD] ERROR: mapping failed!");
 				currentFileName = "ERROR: Cannot open";
 				loading = false;
 				return;
 			}
-			INFO("[LOAD] fopen successful");
+			const uint8_t* fileData = mapped_file_data(file);
+			size_t fileSize = mapped_file_size(file);
+			INFO("[LOAD] File mapped: %zu bytes", fileSize);
 
 			currentFileName = "Reading file...";  // Stage 2
 			INFO("[LOAD] Stage 2: Reading file...");
 			std::this_thread::sleep_for(std::chrono::milliseconds(500));
 
-			fseek(f, 0, SEEK_END);
-			long fileSize = ftell(f);
-			fseek(f, 0, SEEK_SET);
-
-			std::vector<uint8_t> fileData(fileSize);
-			size_t bytesRead = fread(fileData.data(), 1, fileSize, f);
-			fclose(f);
-
-			if (bytesRead != (size_t)fileSize) {
-				INFO("[LOAD] ERROR: fread failed! Expected %ld, got %zu", fileSize, bytesRead);
-				currentFileName = "ERROR: Read failed";
-				loading = false;
-				return;
-			}
-			INFO("[LOAD] File read successful: %zu bytes", bytesRead);
-
 			currentFileName = "Detecting format...";  // Stage 3
 			INFO("[LOAD] Stage 3: Detecting format...");
 			std::this_thread::sleep_for(std::chrono::milliseconds(500));
 
 			// Detect file type from content
-			PlayerType detectedType = detectFileType(fileData);
+			PlayerType detectedType = detectFileType(fileData, fileSize);
 			if (detectedType == PlayerType::NONE) {
 				INFO("File type detection failed");
 				currentFileName = "ERROR: Unknown format";
+				mapped_file_release(file);
 				loading = false;
 				return;
 			}
@@ -301,7 +291,7 @@ struct RM_Deck : Module {
 						if (detectedType == PlayerType::MOD && modPlayer) {
 							currentFileName = "Loading MOD...";  // Stage 4a
 							INFO("Loading MOD file...");
-							success = mod_player_load(modPlayer, fileData.data(), fileData.size());
+							success = mod_player_load_in_place(modPlayer, fileData, fileSize);
 							if (success) {
 								currentFileName = "MOD: Set callback";  // Stage 5a
 								playerType = PlayerType::MOD;
@@ -315,9 +305,9 @@ struct RM_Deck : Module {
 							currentFileName = "Loading MED...";  // Stage 4b
 							INFO("[LOAD] Stage 4b: Loading MED...");
 							std::this_thread::sleep_for(std::chrono::milliseconds(500));
-							INFO("[LOAD] About to call med_player_load");
-							success = med_player_load(medPlayer, fileData.data(), fileData.size());
-							INFO("[LOAD] med_player_load returned: %d", success);
+							INFO("[LOAD] About to call med_player_load_in_place");
+							success = med_player_load_in_place(medPlayer, fileData, fileSize);
+							INFO("[LOAD] med_player_load_in_place returned: %d", success);
 							if (success) {
 								currentFileName = "MED: Set callback";  // Stage 5b
 								INFO("[LOAD] Stage 5b: MED loaded, setting callback...");
@@ -336,7 +326,7 @@ struct RM_Deck : Module {
 						} else if (detectedType == PlayerType::AHX && ahxPlayer) {
 							currentFileName = "Loading AHX...";  // Stage 4c
 							INFO("Loading AHX file...");
-							success = ahx_player_load(ahxPlayer, fileData.data(), fileData.size());
+							success = ahx_player_load(ahxPlayer, fileData, fileSize);
 							if (success) {
 								currentFileName = "AHX: Set callback";  // Stage 5c
 								playerType = PlayerType::AHX;
@@ -354,8 +344,14 @@ struct RM_Deck : Module {
 						success = false;
 						playerType = PlayerType::NONE;
 					}
+
+					// The old song is gone, so its mapping can go too
+					mapped_file_release(mappedFile);
+					mappedFile = file;
+					file = nullptr;
 				}
 			}
+			mapped_file_release(file);  // Cancelled before loading
 
 			INFO("[LOAD] Load success: %d", success);
 
@@ -130,6 +130,8 @@ typedef struct {
 
 /**
  * Initialize AHX instrument with default parameters
+ * The owner must hold an ahx_waves_acquire() reference while the instrument
+ * renders; without one it plays silence.
  */
 void ahx_instrument_init(AhxInstrument* inst);
 
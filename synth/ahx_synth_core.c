@@ -56,8 +56,9 @@ static const int note_to_period_table[128] = {
 
 // Generate waveform and populate VoiceBuffer based on waveform type, wave_length, and filter position
 void ahx_synth_generate_waveform(AhxSynthVoice* voice, uint8_t waveform, uint8_t wave_length, int filter_pos) {
-    // Get shared AHX waves instance (singleton, initialized on first call)
-    AhxWaves* waves = ahx_waves_get();
+    // Shared AHX waves; the instrument's owner holds the reference, so this
+    // never builds them (silence if nobody does)
+    const AhxWaves* waves = ahx_waves_get();
     if (!waves) {
         memset(voice->VoiceBuffer, 0, 0x281 * sizeof(int16_t));
         return;
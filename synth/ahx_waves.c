@@ -4,10 +4,17 @@
  * Generates and provides access to authentic AHX waveforms with filter modulation
  */
 
+#if !defined(_WIN32) && !defined(EMSCRIPTEN) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L  // sched_yield
+#endif
+
 #include "ahx_waves.h"
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#if !defined(_WIN32) && !defined(EMSCRIPTEN)
+#include <sched.h>
+#endif
 
 // White noise table (from ahx_player.c)
 static const unsigned char WhiteNoiseBig[] = {
@@ -251,23 +258,60 @@ static void waves_generate(AhxWaves* waves) {
     waves_generate_filter_waveforms(waves->Triangle04, waves->LowPasses, waves->HighPasses);
 }
 
-// Singleton instance
+// Shared instance and its reference count, guarded by a spinlock. Only
+// acquire/release take it, and they run on control threads (the lock is held
+// while the tables are generated, so waiters yield); table reads need no
+// locking since the data never changes after generation.
 static AhxWaves* g_waves = NULL;
+static int g_waves_refs = 0;
+static int g_waves_lock = 0;
+
+static void waves_lock(void) {
+    while (__atomic_exchange_n(&g_waves_lock, 1, __ATOMIC_ACQUIRE)) {
+#if !defined(_WIN32) && !defined(EMSCRIPTEN)
+        sched_yield();
+#endif
+    }
+}
 
-// Get shared waves instance
-AhxWaves* ahx_waves_get(void) {
+static void waves_unlock(void) {
+    __atomic_store_n(&g_waves_lock, 0, __ATOMIC_RELEASE);
+}
+
+const AhxWaves* ahx_waves_acquire(void) {
+    waves_lock();
     if (!g_waves) {
-        g_waves = (AhxWaves*)malloc(sizeof(AhxWaves));
-        if (g_waves) {
-            memset(g_waves, 0, sizeof(AhxWaves));
-            waves_generate(g_waves);
+        AhxWaves* waves = (AhxWaves*)calloc(1, sizeof(AhxWaves));
+        if (!waves) {
+            waves_unlock();
+            return NULL;
         }
+        waves_generate(waves);
+        __atomic_store_n(&g_waves, waves, __ATOMIC_RELEASE);
     }
-    return g_waves;
+    g_waves_refs++;
+    const AhxWaves* waves = g_waves;
+    waves_unlock();
+    return waves;
+}
+
+void ahx_waves_release(const AhxWaves* waves) {
+    if (!waves) return;
+
+    waves_lock();
+    if (waves == g_waves && g_waves_refs > 0 && --g_waves_refs == 0) {
+        __atomic_store_n(&g_waves, NULL, __ATOMIC_RELEASE);
+        free((void*)waves);
+    }
+    waves_unlock();
+}
+
+const AhxWaves* ahx_waves_get(void) {
+    return __atomic_load_n(&g_waves, __ATOMIC_ACQUIRE);
 }
 
 // Get waveform pointer based on parameters (matches ahx_player.c:1204-1215 logic)
-const int16_t* ahx_waves_get_waveform(AhxWaves* waves, uint8_t waveform, uint8_t wave_length, int filter_pos) {
+const int16_t* ahx_waves_get_waveform(const AhxWaves* waves, uint8_t waveform, uint8_t wave_length, int filter_pos) {
     if (!waves) return NULL;
 
     // Clamp filter_pos to valid range (32-63)
@@ -304,7 +348,7 @@ const int16_t* ahx_waves_get_waveform(AhxWaves* waves, uint8_t waveform, uint8_t
 }
 
 // Generate square waveform into buffer (authentic AHX algorithm from ahx_player.c:1177-1196)
-void ahx_waves_generate_square(AhxWaves* waves, int16_t* output_buffer, int square_pos,
+void ahx_waves_generate_square(const AhxWaves* waves, int16_t* output_buffer, int square_pos,
                                 uint8_t wave_length, int filter_pos, int* square_reverse) {
     if (!waves || !output_buffer) return;
 
@@ -318,7 +362,7 @@ void ahx_waves_generate_square(AhxWaves* waves, int16_t* output_buffer, int squa
     // Access squares with filter modulation
     // FilterPos 32 = raw squares, 33-63 = high-pass filtered variations (stored in HighPasses)
     // Within each 6520-sample filter block: triangles(252) + sawtooths(252) + squares(4096) + noise(1920)
-    int16_t* square_ptr;
+    const int16_t* square_ptr;
 
     if (filter_pos == 32) {
         // Use raw unfiltered squares
@@ -357,11 +401,3 @@ void ahx_waves_generate_square(AhxWaves* waves, int16_t* output_buffer, int squa
         square_ptr += delta;
     }
 }
-
-// Release shared waves instance
-void ahx_waves_release(void) {
-    if (g_waves) {
-        free(g_waves);
-        g_waves = NULL;
-    }
-}
@@ -3,6 +3,11 @@
  *
  * Pre-computed waveform tables with authentic AHX filter modulation
  * Used by both ahx_player and ahx_instrument for consistent sound
+ *
+ * The tables (~800 KB) are built once per process and shared read-only by
+ * every player and synth instance. Setup and teardown are thread-safe, but
+ * generate or free the tables: call them from constructors and destructors,
+ * never from the audio thread.
  */
 
 #ifndef AHX_WAVES_H
@@ -15,7 +20,7 @@ extern "C" {
 #endif
 
 // AHX waveform tables with 31 filtered variations
-typedef struct {
+typedef struct AhxWaves {
     int16_t LowPasses[(0xfc+0xfc+0x80*0x1f+0x80+3*0x280)*31];  // 31 lowpass filtered versions
     int16_t Triangle04[0x04], Triangle08[0x08], Triangle10[0x10], Triangle20[0x20], Triangle40[0x40], Triangle80[0x80];
     int16_t Sawtooth04[0x04], Sawtooth08[0x08], Sawtooth10[0x10], Sawtooth20[0x20], Sawtooth40[0x40], Sawtooth80[0x80];
@@ -25,10 +30,27 @@ typedef struct {
 } AhxWaves;
 
 /**
- * Get shared waves instance (singleton)
- * Automatically initializes on first call
+ * Take a reference to the shared waves (generated on the first reference)
+ * Pair every call with ahx_waves_release(); the tables are freed when the
+ * last reference goes away.
+ * @return Shared read-only tables (NULL if out of memory)
+ */
+const AhxWaves* ahx_waves_acquire(void);
+
+/**
+ * Drop a reference taken with ahx_waves_acquire()
+ * @param waves Tables returned by ahx_waves_acquire() (NULL is ignored)
+ */
+void ahx_waves_release(const AhxWaves* waves);
+
+/**
+ * Get the shared waves without managing a reference (audio thread safe)
+ * For the voice renderers: a single atomic load that never generates or
+ * waits. The owner of the voices (plugin, synth instance) must hold a
+ * reference from ahx_waves_acquire() for as long as they render.
+ * @return Shared tables, or NULL if nobody holds a reference
  */
-AhxWaves* ahx_waves_get(void);
+const AhxWaves* ahx_waves_get(void);
 
 /**
  * Get waveform pointer for playback (triangle, sawtooth, noise)
@@ -37,7 +59,7 @@ AhxWaves* ahx_waves_get(void);
  * @param filter_pos Filter position (32-63) - selects harmonic content
  * @return Pointer to waveform data (NULL if invalid parameters)
  */
-const int16_t* ahx_waves_get_waveform(AhxWaves* waves, uint8_t waveform, uint8_t wave_length, int filter_pos);
+const int16_t* ahx_waves_get_waveform(const AhxWaves* waves, uint8_t waveform, uint8_t wave_length, int filter_pos);
 
 /**
  * Generate square waveform into buffer (authentic AHX resampling)
@@ -48,14 +70,9 @@ const int16_t* ahx_waves_get_waveform(AhxWaves* waves, uint8_t waveform, uint8_t
  * @param filter_pos Filter position (32-63)
  * @param square_reverse Output parameter - set to 1 if waveform is reversed
  */
-void ahx_waves_generate_square(AhxWaves* waves, int16_t* output_buffer, int square_pos,
+void ahx_waves_generate_square(const AhxWaves* waves, int16_t* output_buffer, int square_pos,
                                 uint8_t wave_length, int filter_pos, int* square_reverse);
 
-/**
- * Release shared waves instance (call at shutdown)
- */
-void ahx_waves_release(void);
-
 #ifdef __cplusplus
 }
 #endif
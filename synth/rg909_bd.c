@@ -4,14 +4,11 @@
  */
 
 #include "rg909_bd.h"
+#include "../effects/fx_math.h"
 #include <math.h>
 #include <string.h>
 #include <stdio.h>
 
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
-
 void rg909_bd_init(RG909_BD* bd) {
     memset(bd, 0, sizeof(RG909_BD));
     
@@ -145,23 +142,23 @@ float rg909_bd_process(RG909_BD* bd, float sample_rate) {
         
         if (bd->sweep_pos < gradual_phase_end) {
             // Stage 1: Gradual squiggly rise
-            float sine_val = sinf(2.0f * M_PI * bd->phase);
+            float sine_val = fx_sin_turns(bd->phase);
             sample = sine_val;
             
             float t = bd->sweep_pos / gradual_phase_end;
-            float amp_env = 0.18f * powf(t, 0.8f);
+            float amp_env = 0.18f * fx_pow(t, 0.8f);
             sample = sample * amp_env;
         } else {
             // Stage 2: Steep rise/punch
-            float sine_val = sinf(2.0f * M_PI * bd->phase);
+            float sine_val = fx_sin_turns(bd->phase);
             sample = fabsf(sine_val);  // Full-wave rectification
             
-            sample = tanhf(sample * 1.3f);
+            sample = fx_tanh(sample * 1.3f);
             
             float rise_duration = squiggly_end - gradual_phase_end;
             float t = (bd->sweep_pos - gradual_phase_end) / rise_duration;
             
-            float amp_env = 0.18f + (0.97f - 0.18f) * powf(t, 2.5f);
+            float amp_env = 0.18f + (0.97f - 0.18f) * fx_pow(t, 2.5f);
             sample = sample * amp_env;
         }
         
@@ -187,7 +184,7 @@ float rg909_bd_process(RG909_BD* bd, float sample_rate) {
         } else if (u < 0.5f) {
             // Quarter 2: COSINE sweep DOWN
             float t_quarter = (u - saw_width) / cosine_width;
-            float c = cosf(t_quarter * M_PI);
+            float c = fx_cos_turns(t_quarter * 0.5f);
             sample = 0.5f * (0.85f + (-0.85f)) + 0.5f * (0.85f - (-0.85f)) * c;
         } else if (u < 0.5f + saw_width) {
             // Quarter 3: SAW fade (bottom)
@@ -196,7 +193,7 @@ float rg909_bd_process(RG909_BD* bd, float sample_rate) {
         } else {
             // Quarter 4: COSINE sweep UP
             float t_quarter = (u - 0.5f - saw_width) / cosine_width;
-            float c = cosf((1.0f - t_quarter) * M_PI);
+            float c = fx_cos_turns((1.0f - t_quarter) * 0.5f);
             sample = 0.5f * ((-0.80f) + 0.90f) + 0.5f * (0.90f - (-0.80f)) * c;
         }
         
@@ -225,7 +222,7 @@ float rg909_bd_process(RG909_BD* bd, float sample_rate) {
         
         // Generate triangular-sine waveform
         float triangle = 4.0f * fabsf(tri_phase - 0.5f) - 1.0f;
-        float clipped = tanhf(triangle * 1.5f);
+        float clipped = fx_tanh(triangle * 1.5f);
         sample = (triangle * 0.20f + clipped * 0.80f) * phase_invert;
         
         // Two-stage decay envelope
@@ -240,7 +237,7 @@ float rg909_bd_process(RG909_BD* bd, float sample_rate) {
             float t_decay = bd->sweep_pos - sustain_end;
             float decay_time = 0.045f + bd->decay * 0.085f;
             float k = 0.6f / decay_time;
-            amp_env = 0.88f * expf(-k * t_decay);
+            amp_env = 0.88f * fx_exp(-k * t_decay);
             
             if (amp_env < 0.0001f) {
                 bd->active = 0;
@@ -3,17 +3,10 @@
  */
 
 #include "synth_fm_opl2.h"
+#include "synth_opl.h"
 #include <stdlib.h>
 #include <math.h>
 
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
-
-#ifndef M_2PI
-#define M_2PI 6.28318530717958647692
-#endif
-
 typedef enum {
     ENV_ATTACK = 0,
     ENV_DECAY,
@@ -133,64 +126,10 @@ bool synth_fm_operator_is_active(SynthFMOperator* op)
     return op && op->env_state != ENV_OFF;
 }
 
-// Generate waveform sample
+// Generate waveform sample from the chip's log-sin/exp ROMs (no float trig)
 static float generate_waveform(OPL2Waveform wave, float phase)
 {
-    float output = 0.0f;
-
-    switch (wave) {
-    case OPL2_WAVE_SINE:
-        output = sinf(M_2PI * phase);
-        break;
-
-    case OPL2_WAVE_HALF_SINE:
-        // Half sine (positive half only)
-        if (phase < 0.5f) {
-            output = sinf(M_2PI * phase);
-        } else {
-            output = 0.0f;
-        }
-        break;
-
-    case OPL2_WAVE_ABS_SINE:
-        // Absolute value of sine
-        output = fabsf(sinf(M_2PI * phase));
-        break;
-
-    case OPL2_WAVE_QUARTER_SINE:
-        // Quarter sine (first quarter only)
-        if (phase < 0.25f) {
-            output = sinf(M_2PI * phase);
-        } else {
-            output = 0.0f;
-        }
-        break;
-
-    case OPL2_WAVE_SINE_DOUBLE_HALF:
-        // Double frequency half sine
-        if (fmodf(phase * 2.0f, 1.0f) < 0.5f) {
-            output = sinf(M_2PI * phase * 2.0f);
-        } else {
-            output = 0.0f;
-        }
-        break;
-
-    case OPL2_WAVE_ABS_SINE_DOUBLE:
-        // Double frequency absolute sine
-        output = fabsf(sinf(M_2PI * phase * 2.0f));
-        break;
-
-    case OPL2_WAVE_SQUARE:
-        output = phase < 0.5f ? 1.0f : -1.0f;
-        break;
-
-    case OPL2_WAVE_DERIVED_SQUARE:
-        // Derived square (pulse-like)
-        output = phase < 0.25f ? 1.0f : 0.0f;
-        break;
-    }
-
-    return output;
+    return synth_opl_waveform_sample((int)wave, phase);
 }
 
 float synth_fm_operator_process(SynthFMOperator* op, float base_freq,
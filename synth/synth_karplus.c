@@ -1,6 +1,9 @@
 /*
  * Regroove Karplus-Strong Synthesis
  * Physical modeling of plucked strings using delay line feedback
+ *
+ * Loop: delay line -> one-pole lowpass -> loop gain -> dispersion allpasses
+ *       -> fractional-delay allpass -> back into the delay line
  */
 
 #include "synth_karplus.h"
@@ -12,54 +15,105 @@
 #define M_PI 3.14159265358979323846
 #endif
 
-#define MAX_DELAY_SAMPLES 4096  // ~85Hz at 44.1kHz
+#define DISPERSION_STAGES 4       // Cascaded allpasses for string stiffness
+#define DEFAULT_SAMPLE_RATE 48000
+#define DEFAULT_LOWEST_FREQ 8.0f  // MIDI note 0 is ~8.18Hz
+#define REFERENCE_RATE 44100.0f   // Rate at which brightness was voiced
+#define RELEASE_TIME 0.2f         // Seconds to fade out after release
+#define SILENCE_LEVEL 0.0001f
 
 struct SynthKarplus {
-    float buffer[MAX_DELAY_SAMPLES];
-    int buffer_size;
-    int read_pos;
-    int write_pos;
+    // Delay line (power of two, sized by synth_karplus_prepare)
+    float* buffer;
+    uint32_t buffer_mask;
+    uint32_t write_pos;
+    uint32_t delay;               // Integer part of the loop delay
 
     float damping;
     float brightness;
     float stretch;
     float pick_position;
 
-    // Filter state (one-pole lowpass)
-    float filter_z1;
+    // Loop coefficients (computed at trigger)
+    float loop_gain;
+    float lp_coeff;
+    float disp_coeff;
+    float frac_coeff;
+
+    // Filter state
+    float lp_z1;
+    float disp_z1[DISPERSION_STAGES];
+    float frac_z1;
 
     // Decay envelope for release
     float decay_rate;
     float amplitude;
+    uint32_t quiet_count;         // Consecutive samples below SILENCE_LEVEL
+    int sample_rate;
     bool active;
 };
 
+// Phase delay (samples) of the one-pole lowpass y = y1 + b * (x - y1) at w
+static float lowpass_phase_delay(float b, float w)
+{
+    const float c = 1.0f - b;
+    return atan2f(c * sinf(w), 1.0f - c * cosf(w)) / w;
+}
+
+// Phase delay (samples) of the allpass H(z) = (a + z^-1) / (1 + a z^-1) at w
+static float allpass_phase_delay(float a, float w)
+{
+    const float phase = -atan2f(sinf(w), a + cosf(w)) + atan2f(a * sinf(w), 1.0f + a * cosf(w));
+    return -phase / w;
+}
+
 SynthKarplus* synth_karplus_create(void)
 {
-    SynthKarplus* ks = (SynthKarplus*)malloc(sizeof(SynthKarplus));
+    SynthKarplus* ks = (SynthKarplus*)calloc(1, sizeof(SynthKarplus));
     if (!ks) return NULL;
 
-    memset(ks->buffer, 0, sizeof(ks->buffer));
-    ks->buffer_size = 0;
-    ks->read_pos = 0;
-    ks->write_pos = 0;
-
     ks->damping = 0.5f;
     ks->brightness = 0.5f;
     ks->stretch = 0.0f;
     ks->pick_position = 0.5f;
+    ks->sample_rate = DEFAULT_SAMPLE_RATE;
 
-    ks->filter_z1 = 0.0f;
-    ks->decay_rate = 0.0f;
-    ks->amplitude = 0.0f;
-    ks->active = false;
+    if (!synth_karplus_prepare(ks, DEFAULT_SAMPLE_RATE, DEFAULT_LOWEST_FREQ)) {
+        free(ks);
+        return NULL;
+    }
 
     return ks;
 }
 
 void synth_karplus_destroy(SynthKarplus* ks)
 {
-    if (ks) free(ks);
+    if (!ks) return;
+    free(ks->buffer);
+    free(ks);
+}
+
+bool synth_karplus_prepare(SynthKarplus* ks, int sample_rate, float lowest_freq)
+{
+    if (!ks || sample_rate <= 0) return false;
+    if (lowest_freq < 1.0f) lowest_freq = 1.0f;
+
+    // Longest period plus headroom for the loop filter compensation
+    const uint32_t needed = (uint32_t)(sample_rate / lowest_freq) + 8;
+    uint32_t length = 64;
+    while (length < needed) length <<= 1;
+
+    if (!ks->buffer || ks->buffer_mask + 1 != length) {
+        float* buffer = (float*)calloc(length, sizeof(float));
+        if (!buffer) return false;
+        free(ks->buffer);
+        ks->buffer = buffer;
+        ks->buffer_mask = length - 1;
+    }
+
+    ks->sample_rate = sample_rate;
+    synth_karplus_reset(ks);
+    return true;
 }
 
 void synth_karplus_set_damping(SynthKarplus* ks, float damping)
@@ -100,41 +154,79 @@ void synth_karplus_set_pick_position(SynthKarplus* ks, float position)
 
 void synth_karplus_trigger(SynthKarplus* ks, float frequency, float velocity, int sample_rate)
 {
-    if (!ks || frequency <= 0.0f) return;
-
-    // Calculate buffer size (delay time)
-    float period = (float)sample_rate / frequency;
-
-    // Apply stretch tuning (slight inharmonicity like real strings)
-    period *= 1.0f + ks->stretch * 0.02f;
-
-    ks->buffer_size = (int)period;
-    if (ks->buffer_size < 4) ks->buffer_size = 4;
-    if (ks->buffer_size >= MAX_DELAY_SAMPLES) ks->buffer_size = MAX_DELAY_SAMPLES - 1;
-
-    // Fill buffer with noise burst (excitation)
-    for (int i = 0; i < ks->buffer_size; i++) {
+    if (!ks || !ks->buffer || frequency <= 0.0f || sample_rate <= 0) return;
+
+    const float fs = (float)sample_rate;
+    if (frequency > fs * 0.45f) frequency = fs * 0.45f;
+
+    const float period = fs / frequency;
+    const float w = 2.0f * (float)M_PI * frequency / fs;
+
+    // Brightness is a one-pole coefficient voiced at 44.1kHz; rescale it so
+    // the cutoff (and thus the tone) does not change with sample rate
+    const float b_ref = 0.1f + ks->brightness * 0.89f;  // 0.1 to 0.99
+    ks->lp_coeff = 1.0f - powf(1.0f - b_ref, REFERENCE_RATE / fs);
+
+    // Energy loss per round trip
+    ks->loop_gain = 0.9f + ks->damping * 0.09f;  // 0.9 to 0.99
+
+    // Subtract the phase delay of the loop filters from the period.
+    // Dispersion (negative allpass coefficients) makes upper partials sharp
+    // like a stiff string; it is backed off for very short loops.
+    const float pd_lp = lowpass_phase_delay(ks->lp_coeff, w);
+    float a_disp = -0.7f * ks->stretch;
+    float required;
+    for (;;) {
+        required = period - pd_lp - DISPERSION_STAGES * allpass_phase_delay(a_disp, w);
+        if (required >= 1.5f || a_disp == 0.0f) break;
+        a_disp *= 0.5f;
+        if (fabsf(a_disp) < 0.01f) a_disp = 0.0f;
+    }
+    ks->disp_coeff = a_disp;
+
+    // Integer delay plus an allpass fraction in [0.5, 1.5)
+    int n = (int)floorf(required - 0.5f);
+    if (n < 1) n = 1;
+    if (n > (int)ks->buffer_mask) n = (int)ks->buffer_mask;
+    float d = required - n;
+    if (d < 0.1f) d = 0.1f;
+    if (d > 1.5f) d = 1.5f;
+    ks->delay = (uint32_t)n;
+
+    // First-order allpass with exact phase delay d at the fundamental
+    float a_frac = sinf((1.0f - d) * w * 0.5f) / sinf((1.0f + d) * w * 0.5f);
+    if (a_frac > 0.99f) a_frac = 0.99f;
+    if (a_frac < -0.99f) a_frac = -0.99f;
+    ks->frac_coeff = a_frac;
+
+    // Fill the first loop with a noise burst (excitation)
+    memset(ks->buffer, 0, (ks->buffer_mask + 1) * sizeof(float));
+    for (int i = 0; i < n; i++) {
         // Random noise between -1 and 1
-        float noise = ((float)rand() / RAND_MAX) * 2.0f - 1.0f;
-
-        // Apply pick position (filters out harmonics)
-        // Position of 0.5 = pluck in center (removes even harmonics)
-        float pos_factor = 1.0f;
-        if (ks->pick_position > 0.01f && ks->pick_position < 0.99f) {
-            float phase = (float)i / ks->buffer_size;
-            // Simple position filtering
-            pos_factor = sinf(M_PI * phase * ks->pick_position);
-            if (pos_factor < 0.0f) pos_factor = 0.0f;
-        }
+        ks->buffer[i] = (((float)rand() / RAND_MAX) * 2.0f - 1.0f) * velocity;
+    }
 
-        ks->buffer[i] = noise * velocity * pos_factor;
+    // Pick position: comb filter x[i] - x[i - P] removes harmonics with a
+    // node at the pick point (0.5 = pluck in center, removes even harmonics)
+    if (ks->pick_position > 0.01f && ks->pick_position < 0.99f) {
+        int p = (int)(ks->pick_position * n);
+        if (p < 1) p = 1;
+        for (int i = n - 1; i >= p; i--) {
+            ks->buffer[i] = 0.5f * (ks->buffer[i] - ks->buffer[i - p]);
+        }
+        for (int i = p - 1; i >= 0; i--) {
+            ks->buffer[i] *= 0.5f;
+        }
     }
 
-    ks->read_pos = 0;
-    ks->write_pos = 0;
-    ks->filter_z1 = 0.0f;
+    ks->write_pos = (uint32_t)n;
+    ks->lp_z1 = 0.0f;
+    memset(ks->disp_z1, 0, sizeof(ks->disp_z1));
+    ks->frac_z1 = 0.0f;
     ks->amplitude = 1.0f;
     ks->decay_rate = 0.0f;
+    ks->quiet_count = 0;
+    ks->sample_rate = sample_rate;
     ks->active = true;
 }
 
@@ -142,7 +234,7 @@ void synth_karplus_release(SynthKarplus* ks)
 {
     if (!ks) return;
     // Set decay rate for gradual release
-    ks->decay_rate = 0.0001f;
+    ks->decay_rate = 1.0f / (RELEASE_TIME * ks->sample_rate);
 }
 
 bool synth_karplus_is_active(SynthKarplus* ks)
@@ -152,57 +244,166 @@ bool synth_karplus_is_active(SynthKarplus* ks)
 
 float synth_karplus_process(SynthKarplus* ks, int sample_rate)
 {
-    if (!ks || !ks->active || ks->buffer_size == 0) return 0.0f;
+    (void)sample_rate;  // Fixed at trigger time
+    if (!ks || !ks->active || !ks->buffer) return 0.0f;
+
+    const uint32_t mask = ks->buffer_mask;
 
     // Read from delay line
-    float output = ks->buffer[ks->read_pos];
+    const float output = ks->buffer[(ks->write_pos - ks->delay) & mask];
+
+    // Damping via one-pole lowpass filter, then energy loss
+    float y = ks->lp_z1 + ks->lp_coeff * (output - ks->lp_z1);
+    ks->lp_z1 = y;
+    y *= ks->loop_gain;
+
+    // Dispersion allpasses
+    for (int s = 0; s < DISPERSION_STAGES; s++) {
+        const float o = ks->disp_coeff * y + ks->disp_z1[s];
+        ks->disp_z1[s] = y - ks->disp_coeff * o;
+        y = o;
+    }
 
-    // Damping via one-pole lowpass filter
-    // brightness controls the cutoff frequency
-    float brightness_factor = 0.1f + ks->brightness * 0.89f;  // 0.1 to 0.99
+    // Fractional delay allpass
+    {
+        const float o = ks->frac_coeff * y + ks->frac_z1;
+        ks->frac_z1 = y - ks->frac_coeff * o;
+        y = o;
+    }
 
-    // Additional damping control
-    float damping_factor = 0.9f + ks->damping * 0.09f;  // 0.9 to 0.99
+    // Write back to delay line (feedback)
+    ks->buffer[ks->write_pos] = y;
+    ks->write_pos = (ks->write_pos + 1) & mask;
 
-    // One-pole lowpass: y[n] = a * x[n] + (1-a) * y[n-1]
-    float filtered = brightness_factor * output + (1.0f - brightness_factor) * ks->filter_z1;
-    ks->filter_z1 = filtered;
+    // Apply decay envelope if releasing
+    ks->amplitude -= ks->decay_rate;
+    if (ks->amplitude <= 0.0f) {
+        ks->amplitude = 0.0f;
+        ks->active = false;
+    }
+    const float out = output * ks->amplitude;
 
-    // Apply damping (energy loss)
-    filtered *= damping_factor;
+    // Inactive once a whole period has been silent
+    ks->quiet_count = (fabsf(out) < SILENCE_LEVEL) ? ks->quiet_count + 1 : 0;
+    if (ks->quiet_count > ks->delay + 8) {
+        ks->active = false;
+    }
 
-    // Write back to delay line (feedback)
-    ks->buffer[ks->write_pos] = filtered;
+    return out;
+}
 
-    // Advance positions
-    ks->read_pos = (ks->read_pos + 1) % ks->buffer_size;
-    ks->write_pos = (ks->write_pos + 1) % ks->buffer_size;
+// Render up to SYNTH_KARPLUS_BATCH strings with their filter state in lanes.
+// Only the delay line read/write is per string; the filter math runs over all
+// lanes (unused lanes carry zeros) so the compiler can vectorize it.
+static void karplus_render_group(SynthKarplus** group, int lanes, float* out, int frames)
+{
+    enum { B = SYNTH_KARPLUS_BATCH };
+    float lp_b[B] = {0}, lp_z[B] = {0}, gain[B] = {0};
+    float disp_a[B] = {0}, disp_z[DISPERSION_STAGES][B] = {{0}};
+    float frac_a[B] = {0}, frac_z[B] = {0};
+    float amp[B] = {0}, decay[B] = {0}, quiet[B] = {0};
+    float x[B] = {0}, y[B];
+    int l, s;
+
+    for (l = 0; l < lanes; l++) {
+        const SynthKarplus* ks = group[l];
+        lp_b[l] = ks->lp_coeff;
+        lp_z[l] = ks->lp_z1;
+        gain[l] = ks->loop_gain;
+        disp_a[l] = ks->disp_coeff;
+        for (s = 0; s < DISPERSION_STAGES; s++) disp_z[s][l] = ks->disp_z1[s];
+        frac_a[l] = ks->frac_coeff;
+        frac_z[l] = ks->frac_z1;
+        amp[l] = ks->amplitude;
+        decay[l] = ks->decay_rate;
+        quiet[l] = (float)ks->quiet_count;
+    }
 
-    // Apply decay envelope if releasing
-    if (ks->decay_rate > 0.0f) {
-        ks->amplitude -= ks->decay_rate;
-        if (ks->amplitude <= 0.0f) {
-            ks->amplitude = 0.0f;
-            ks->active = false;
+    for (int n = 0; n < frames; n++) {
+        // Gather delay line outputs
+        for (l = 0; l < lanes; l++) {
+            SynthKarplus* ks = group[l];
+            x[l] = ks->buffer[(ks->write_pos - ks->delay) & ks->buffer_mask];
+        }
+
+        for (l = 0; l < B; l++) {
+            const float v = lp_z[l] + lp_b[l] * (x[l] - lp_z[l]);
+            lp_z[l] = v;
+            y[l] = v * gain[l];
+        }
+        for (s = 0; s < DISPERSION_STAGES; s++) {
+            for (l = 0; l < B; l++) {
+                const float o = disp_a[l] * y[l] + disp_z[s][l];
+                disp_z[s][l] = y[l] - disp_a[l] * o;
+                y[l] = o;
+            }
+        }
+        for (l = 0; l < B; l++) {
+            const float o = frac_a[l] * y[l] + frac_z[l];
+            frac_z[l] = y[l] - frac_a[l] * o;
+            y[l] = o;
         }
-        output *= ks->amplitude;
+
+        // Scatter feedback into the delay lines
+        for (l = 0; l < lanes; l++) {
+            SynthKarplus* ks = group[l];
+            ks->buffer[ks->write_pos] = y[l];
+            ks->write_pos = (ks->write_pos + 1) & ks->buffer_mask;
+        }
+
+        float sum = 0.0f;
+        for (l = 0; l < B; l++) {
+            amp[l] = fmaxf(amp[l] - decay[l], 0.0f);
+            const float o = x[l] * amp[l];
+            quiet[l] = (fabsf(o) < SILENCE_LEVEL) ? quiet[l] + 1.0f : 0.0f;
+            sum += o;
+        }
+        out[n] += sum;
     }
 
-    // Check if string has decayed to silence
-    if (fabsf(output) < 0.0001f && fabsf(filtered) < 0.0001f) {
-        ks->active = false;
+    for (l = 0; l < lanes; l++) {
+        SynthKarplus* ks = group[l];
+        ks->lp_z1 = lp_z[l];
+        for (s = 0; s < DISPERSION_STAGES; s++) ks->disp_z1[s] = disp_z[s][l];
+        ks->frac_z1 = frac_z[l];
+        ks->amplitude = amp[l];
+        ks->quiet_count = (uint32_t)quiet[l];
+        if (amp[l] <= 0.0f || ks->quiet_count > ks->delay + 8) {
+            ks->active = false;
+        }
     }
+}
 
-    return output;
+void synth_karplus_process_batch(SynthKarplus* const* strings, int count, float* out, int frames)
+{
+    SynthKarplus* group[SYNTH_KARPLUS_BATCH];
+    int idx = 0;
+
+    if (!strings || !out || frames <= 0) return;
+
+    while (idx < count) {
+        int lanes = 0;
+        while (idx < count && lanes < SYNTH_KARPLUS_BATCH) {
+            SynthKarplus* ks = strings[idx++];
+            if (ks && ks->active && ks->buffer) group[lanes++] = ks;
+        }
+        if (lanes > 0) {
+            karplus_render_group(group, lanes, out, frames);
+        }
+    }
 }
 
 void synth_karplus_reset(SynthKarplus* ks)
 {
     if (!ks) return;
-    memset(ks->buffer, 0, sizeof(ks->buffer));
-    ks->read_pos = 0;
+    if (ks->buffer) memset(ks->buffer, 0, (ks->buffer_mask + 1) * sizeof(float));
     ks->write_pos = 0;
-    ks->filter_z1 = 0.0f;
+    ks->delay = 0;
+    ks->lp_z1 = 0.0f;
+    memset(ks->disp_z1, 0, sizeof(ks->disp_z1));
+    ks->frac_z1 = 0.0f;
     ks->amplitude = 0.0f;
+    ks->decay_rate = 0.0f;
+    ks->quiet_count = 0;
     ks->active = false;
 }
@@ -1,6 +1,10 @@
 /*
  * Regroove Karplus-Strong Synthesis
  * Physical modeling of plucked strings
+ *
+ * Tuning is exact across the keyboard: the loop delay is split into an
+ * integer delay line plus a first-order allpass (Thiran) fraction, after
+ * compensating the phase delay of the loop and dispersion filters.
  */
 
 #ifndef SYNTH_KARPLUS_H
@@ -13,16 +17,24 @@
 extern "C" {
 #endif
 
+// Strings rendered side by side by synth_karplus_process_batch()
+#define SYNTH_KARPLUS_BATCH 8
+
 typedef struct SynthKarplus SynthKarplus;
 
-// Create/destroy
+// Create/destroy (created prepared for 48kHz down to 8Hz)
 SynthKarplus* synth_karplus_create(void);
 void synth_karplus_destroy(SynthKarplus* ks);
 
+// Size the delay line for a sample rate and lowest playable frequency.
+// Allocates memory: call from prepare/activate, not from the audio thread.
+// Returns false if the allocation failed (previous buffer is kept).
+bool synth_karplus_prepare(SynthKarplus* ks, int sample_rate, float lowest_freq);
+
 // Parameters
 void synth_karplus_set_damping(SynthKarplus* ks, float damping);      // 0.0 - 1.0
 void synth_karplus_set_brightness(SynthKarplus* ks, float brightness); // 0.0 - 1.0
-void synth_karplus_set_stretch(SynthKarplus* ks, float stretch);       // 0.0 - 1.0
+void synth_karplus_set_stretch(SynthKarplus* ks, float stretch);       // 0.0 - 1.0 (dispersion)
 void synth_karplus_set_pick_position(SynthKarplus* ks, float position); // 0.0 - 1.0
 
 // Trigger new note
@@ -37,6 +49,10 @@ bool synth_karplus_is_active(SynthKarplus* ks);
 // Process one sample
 float synth_karplus_process(SynthKarplus* ks, int sample_rate);
 
+// Render several strings at once, interleaved in SIMD-friendly lanes.
+// The output of all active strings is ADDED to out (mono).
+void synth_karplus_process_batch(SynthKarplus* const* strings, int count, float* out, int frames);
+
 // Reset
 void synth_karplus_reset(SynthKarplus* ks);
 
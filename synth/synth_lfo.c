@@ -3,17 +3,10 @@
  */
 
 #include "synth_lfo.h"
+#include "../effects/fx_math.h"
 #include <stdlib.h>
 #include <math.h>
 
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
-
-#ifndef M_2PI
-#define M_2PI 6.28318530717958647692
-#endif
-
 struct SynthLFO {
     SynthLFOWaveform waveform;
     float frequency;  // Hz
@@ -70,7 +63,7 @@ float synth_lfo_process(SynthLFO* lfo, int sample_rate)
 
     switch (lfo->waveform) {
     case SYNTH_LFO_SINE:
-        output = sinf(M_2PI * lfo->phase);
+        output = fx_sin_turns_fast(lfo->phase);
         break;
 
     case SYNTH_LFO_TRIANGLE:
@@ -113,3 +106,20 @@ float synth_lfo_process(SynthLFO* lfo, int sample_rate)
 
     return output;
 }
+
+float synth_lfo_process_block(SynthLFO* lfo, int frames, int sample_rate)
+{
+    if (!lfo) return 0.0f;
+    if (frames <= 1) return synth_lfo_process(lfo, sample_rate);
+
+    // Skip to the last frame of the block and evaluate it there, so a ramp
+    // towards the result arrives with the LFO instead of a block behind
+    if (lfo->waveform == SYNTH_LFO_RANDOM) {
+        // Goes no further below zero than one block; the next sample redraws
+        lfo->random_counter -= frames - 1;
+    }
+    lfo->phase += (frames - 1) * lfo->frequency / (float)sample_rate;
+    lfo->phase -= floorf(lfo->phase);
+
+    return synth_lfo_process(lfo, sample_rate);
+}
@@ -50,6 +50,12 @@ void synth_lfo_set_frequency(SynthLFO* lfo, float freq_hz);
  */
 float synth_lfo_process(SynthLFO* lfo, int sample_rate);
 
+/**
+ * Control-rate processing: advances the LFO by 'frames' samples in one step
+ * and returns its value at the last of them (the end of the block)
+ */
+float synth_lfo_process_block(SynthLFO* lfo, int frames, int sample_rate);
+
 #ifdef __cplusplus
 }
 #endif
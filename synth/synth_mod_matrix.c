@@ -0,0 +1,97 @@
+/*
+ * Regroove Modulation Matrix Implementation
+ */
+
+#include "synth_mod_matrix.h"
+#include <string.h>
+
+void synth_mod_matrix_init(SynthModMatrix* matrix)
+{
+    if (!matrix) return;
+    memset(matrix, 0, sizeof(SynthModMatrix));
+    matrix->global_src[SYNTH_MOD_SRC_NONE] = 1.0f;
+}
+
+void synth_mod_matrix_clear_routes(SynthModMatrix* matrix)
+{
+    if (!matrix) return;
+    matrix->num_routes = 0;
+}
+
+int synth_mod_matrix_add_route(SynthModMatrix* matrix, SynthModSource source,
+                               SynthModSource via, SynthModDest dest, float amount)
+{
+    if (!matrix || matrix->num_routes >= SYNTH_MOD_MAX_ROUTES) return -1;
+    if (source >= SYNTH_MOD_SRC_COUNT || via >= SYNTH_MOD_SRC_COUNT) return -1;
+    if (dest >= SYNTH_MOD_DST_COUNT) return -1;
+
+    SynthModRoute* route = &matrix->routes[matrix->num_routes];
+    route->source = (uint8_t)source;
+    route->via = (uint8_t)via;
+    route->dest = (uint8_t)dest;
+    route->amount = amount;
+
+    return matrix->num_routes++;
+}
+
+void synth_mod_matrix_set_amount(SynthModMatrix* matrix, int route, float amount)
+{
+    if (!matrix || route < 0 || route >= matrix->num_routes) return;
+    matrix->routes[route].amount = amount;
+}
+
+void synth_mod_matrix_set_source(SynthModMatrix* matrix, SynthModSource source, float value)
+{
+    if (!matrix || source <= SYNTH_MOD_SRC_NONE || source >= SYNTH_MOD_SRC_COUNT) return;
+    matrix->global_src[source] = value;
+}
+
+void synth_mod_voice_init(SynthModVoice* voice)
+{
+    if (!voice) return;
+    memset(voice, 0, sizeof(SynthModVoice));
+    voice->pitch_ratio = 1.0f;
+}
+
+void synth_mod_voice_set_source(SynthModVoice* voice, SynthModSource source, float value)
+{
+    if (!voice || source <= SYNTH_MOD_SRC_NONE || source >= SYNTH_MOD_SRC_COUNT) return;
+    voice->src[source] = value;
+}
+
+// Per-voice sources override globals; everything else comes from the matrix
+static inline float mod_source_value(const SynthModMatrix* matrix, const SynthModVoice* voice, uint8_t src)
+{
+    switch (src) {
+    case SYNTH_MOD_SRC_NONE:
+        return 1.0f;
+    case SYNTH_MOD_SRC_ENV1:
+    case SYNTH_MOD_SRC_ENV2:
+    case SYNTH_MOD_SRC_VELOCITY:
+    case SYNTH_MOD_SRC_KEY:
+        return voice->src[src];
+    default:
+        return matrix->global_src[src];
+    }
+}
+
+void synth_mod_matrix_update_voice(const SynthModMatrix* matrix, SynthModVoice* voice, int block_len)
+{
+    if (!matrix || !voice) return;
+
+    float target[SYNTH_MOD_DST_COUNT] = {0};
+
+    // Sparse evaluation: only routes with a non-zero depth cost anything
+    for (int r = 0; r < matrix->num_routes; r++) {
+        const SynthModRoute* route = &matrix->routes[r];
+        if (route->amount == 0.0f) continue;
+
+        float v = mod_source_value(matrix, voice, route->source) * route->amount;
+        if (route->via != SYNTH_MOD_SRC_NONE) {
+            v *= mod_source_value(matrix, voice, route->via);
+        }
+        target[route->dest] += v;
+    }
+
+    synth_mod_voice_ramp_to(voice, target, block_len);
+}
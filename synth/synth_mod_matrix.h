@@ -0,0 +1,145 @@
+/*
+ * Regroove Modulation Matrix
+ *
+ * Routes modulation sources (LFOs, envelopes, velocity, key, mod wheel,
+ * aftertouch, pitch bend) to destinations through a sparse route table.
+ *
+ * Sources are sampled at control rate, once per SYNTH_MOD_CONTROL_BLOCK
+ * samples. Destination values are then ramped linearly to the next control
+ * point, so audio-rate consumers get smooth values without evaluating the
+ * matrix (or exp2 for pitch) on every sample.
+ */
+
+#ifndef SYNTH_MOD_MATRIX_H
+#define SYNTH_MOD_MATRIX_H
+
+#include <stdint.h>
+#include "../effects/fx_math.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SYNTH_MOD_MAX_ROUTES 16
+#define SYNTH_MOD_CONTROL_BLOCK 16
+
+typedef enum {
+    SYNTH_MOD_SRC_NONE = 0,     // Constant 1.0 (useful as 'via' = no scaling)
+    SYNTH_MOD_SRC_LFO1,         // -1..+1 (global)
+    SYNTH_MOD_SRC_LFO2,         // -1..+1 (global)
+    SYNTH_MOD_SRC_ENV1,         // 0..1 (per voice)
+    SYNTH_MOD_SRC_ENV2,         // 0..1 (per voice)
+    SYNTH_MOD_SRC_VELOCITY,     // 0..1 (per voice)
+    SYNTH_MOD_SRC_KEY,          // (note - 60) / 60 (per voice)
+    SYNTH_MOD_SRC_MOD_WHEEL,    // 0..1 (global)
+    SYNTH_MOD_SRC_AFTERTOUCH,   // 0..1 (global)
+    SYNTH_MOD_SRC_PITCH_BEND,   // -1..+1 (global)
+    SYNTH_MOD_SRC_COUNT
+} SynthModSource;
+
+typedef enum {
+    SYNTH_MOD_DST_PITCH = 0,    // Semitones (also available as a frequency ratio)
+    SYNTH_MOD_DST_CUTOFF,       // Normalized cutoff offset
+    SYNTH_MOD_DST_RESONANCE,    // Normalized resonance offset
+    SYNTH_MOD_DST_PULSE_WIDTH,  // Pulse width offset
+    SYNTH_MOD_DST_AMP,          // Gain offset (output *= 1 + value)
+    SYNTH_MOD_DST_PAN,          // -1..+1 offset
+    SYNTH_MOD_DST_COUNT
+} SynthModDest;
+
+typedef struct {
+    uint8_t source;   // SynthModSource
+    uint8_t via;      // SynthModSource scaling the route (NONE = 1.0)
+    uint8_t dest;     // SynthModDest
+    float amount;     // Depth in destination units; 0 disables the route
+} SynthModRoute;
+
+typedef struct {
+    SynthModRoute routes[SYNTH_MOD_MAX_ROUTES];
+    int num_routes;
+    float global_src[SYNTH_MOD_SRC_COUNT];  // Values of global sources
+} SynthModMatrix;
+
+// Per-voice modulation state
+typedef struct {
+    float src[SYNTH_MOD_SRC_COUNT];   // Per-voice source values
+    float value[SYNTH_MOD_DST_COUNT]; // Current (ramped) destination values
+    float step[SYNTH_MOD_DST_COUNT];  // Per-sample increment to next control point
+    float pitch_ratio;                // 2^(value[PITCH] / 12), ramped
+    float pitch_ratio_step;
+    int primed;                       // First update snaps instead of ramping
+} SynthModVoice;
+
+// Frequency ratio for a pitch offset in semitones (fx_exp2: < 0.001 cents)
+static inline float synth_mod_pitch_ratio(float semitones)
+{
+    return fx_exp2(semitones * (1.0f / 12.0f));
+}
+
+// Matrix setup
+void synth_mod_matrix_init(SynthModMatrix* matrix);
+void synth_mod_matrix_clear_routes(SynthModMatrix* matrix);
+
+/**
+ * Add a route: dest += source * via * amount
+ * Returns the route index (for later amount changes), or -1 if full
+ */
+int synth_mod_matrix_add_route(SynthModMatrix* matrix, SynthModSource source,
+                               SynthModSource via, SynthModDest dest, float amount);
+void synth_mod_matrix_set_amount(SynthModMatrix* matrix, int route, float amount);
+
+// Set a global source (LFOs, wheel, aftertouch, bend) for the next update
+void synth_mod_matrix_set_source(SynthModMatrix* matrix, SynthModSource source, float value);
+
+// Per-voice state
+void synth_mod_voice_init(SynthModVoice* voice);
+void synth_mod_voice_set_source(SynthModVoice* voice, SynthModSource source, float value);
+
+/**
+ * Evaluate all routes for a voice at a control point and set up ramps
+ * that reach the new values after 'block_len' calls to synth_mod_voice_tick()
+ */
+void synth_mod_matrix_update_voice(const SynthModMatrix* matrix, SynthModVoice* voice, int block_len);
+
+/**
+ * Set up those ramps toward caller-computed destination values (for synths
+ * with fixed routing and no matrix). The first call after
+ * synth_mod_voice_init() snaps instead of ramping.
+ */
+static inline void synth_mod_voice_ramp_to(SynthModVoice* voice, const float target[SYNTH_MOD_DST_COUNT],
+                                           int block_len)
+{
+    const float ratio = synth_mod_pitch_ratio(target[SYNTH_MOD_DST_PITCH]);
+
+    if (!voice->primed || block_len <= 1) {
+        for (int d = 0; d < SYNTH_MOD_DST_COUNT; d++) {
+            voice->value[d] = target[d];
+            voice->step[d] = 0.0f;
+        }
+        voice->pitch_ratio = ratio;
+        voice->pitch_ratio_step = 0.0f;
+        voice->primed = 1;
+        return;
+    }
+
+    const float inv = 1.0f / block_len;
+    for (int d = 0; d < SYNTH_MOD_DST_COUNT; d++) {
+        voice->step[d] = (target[d] - voice->value[d]) * inv;
+    }
+    voice->pitch_ratio_step = (ratio - voice->pitch_ratio) * inv;
+}
+
+// Advance ramps by one sample (audio-rate lanes)
+static inline void synth_mod_voice_tick(SynthModVoice* voice)
+{
+    for (int d = 0; d < SYNTH_MOD_DST_COUNT; d++) {
+        voice->value[d] += voice->step[d];
+    }
+    voice->pitch_ratio += voice->pitch_ratio_step;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SYNTH_MOD_MATRIX_H
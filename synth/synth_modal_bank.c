@@ -0,0 +1,295 @@
+/*
+ * Modal Resonator Bank - damped complex oscillators in SIMD-friendly lanes
+ */
+
+#include "synth_modal_bank.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define LANES SYNTH_MODAL_BANK_LANES
+#define MAX_MODES SYNTH_MODAL_BANK_MAX_MODES
+
+#define MODAL_MIN_AMP 0.0005f         // Partials quieter than this (relative) are skipped
+#define MODAL_PRUNE_LEVEL 0.0001f     // -80 dB
+#define MODAL_PRUNE_INTERVAL 256      // Samples between prune passes
+
+struct SynthModalTable {
+    float sample_rate;
+    int max_modes;
+    uint32_t offset[129];  // Key k uses modes [offset[k], offset[k+1])
+    float* c;
+    float* s;
+    float* amp;
+};
+
+int synth_modal_compute_key(uint8_t note, float sample_rate, int max_modes,
+                            float* c, float* s, float* amp)
+{
+    if (sample_rate <= 0.0f || max_modes <= 0) return 0;
+    if (max_modes > MAX_MODES) max_modes = MAX_MODES;
+
+    // Using exp(x * ln(2)) instead of powf(2, x), as in synth_midi_to_freq()
+    const float ln2 = 0.69314718056f;
+    const float f0 = 440.0f * expf((note - 69) / 12.0f * ln2);
+
+    // String stiffness grows towards the treble
+    float B = 0.00015f * expf((note - 60) / 18.0f * ln2);
+    if (B > 0.02f) B = 0.02f;
+
+    // Fundamental T60: long in the bass, short in the treble
+    float t60 = 12.0f * expf(-(note - 21) / 24.0f * ln2);
+    if (t60 < 0.4f) t60 = 0.4f;
+    if (t60 > 20.0f) t60 = 20.0f;
+
+    const float nyquist = sample_rate * 0.45f;
+    float total = 0.0f;
+    int count = 0;
+
+    for (int n = 1; count < max_modes; n++) {
+        const float fn = n * f0 * sqrtf(1.0f + B * n * n);
+        if (fn >= nyquist) break;
+
+        // 1/n partial series with a hammer-felt rolloff
+        const float felt = fn / 4000.0f;
+        const float a = (1.0f / n) / (1.0f + felt * felt);
+        if (a < MODAL_MIN_AMP) break;
+
+        // Higher partials lose energy faster
+        const float t = t60 / (1.0f + 0.08f * (n - 1) + fn * 0.0002f);
+        const float r = expf(-6.907755f / (t * sample_rate));
+        const float w = 2.0f * (float)M_PI * fn / sample_rate;
+
+        c[count] = r * cosf(w);
+        s[count] = r * sinf(w);
+        amp[count] = a;
+        total += a;
+        count++;
+    }
+
+    // Normalize so a full-strength strike peaks around unity
+    if (total > 0.0f) {
+        const float norm = 1.0f / total;
+        for (int i = 0; i < count; i++) {
+            amp[i] *= norm;
+        }
+    }
+
+    return count;
+}
+
+SynthModalTable* synth_modal_table_create(float sample_rate, int max_modes)
+{
+    if (sample_rate <= 0.0f || max_modes <= 0) return NULL;
+    if (max_modes > MAX_MODES) max_modes = MAX_MODES;
+
+    SynthModalTable* table = (SynthModalTable*)calloc(1, sizeof(SynthModalTable));
+    if (!table) return NULL;
+
+    const size_t worst = (size_t)128 * max_modes;
+    table->c = (float*)malloc(worst * sizeof(float));
+    table->s = (float*)malloc(worst * sizeof(float));
+    table->amp = (float*)malloc(worst * sizeof(float));
+    if (!table->c || !table->s || !table->amp) {
+        synth_modal_table_destroy(table);
+        return NULL;
+    }
+
+    table->sample_rate = sample_rate;
+    table->max_modes = max_modes;
+
+    uint32_t pos = 0;
+    for (int key = 0; key < 128; key++) {
+        table->offset[key] = pos;
+        pos += synth_modal_compute_key((uint8_t)key, sample_rate, max_modes,
+                                       table->c + pos, table->s + pos, table->amp + pos);
+    }
+    table->offset[128] = pos;
+
+    // Shrink to the modes that survived Nyquist/audibility pruning
+    if (pos > 0) {
+        float* p;
+        if ((p = (float*)realloc(table->c, pos * sizeof(float)))) table->c = p;
+        if ((p = (float*)realloc(table->s, pos * sizeof(float)))) table->s = p;
+        if ((p = (float*)realloc(table->amp, pos * sizeof(float)))) table->amp = p;
+    }
+
+    return table;
+}
+
+void synth_modal_table_destroy(SynthModalTable* table)
+{
+    if (!table) return;
+    free(table->c);
+    free(table->s);
+    free(table->amp);
+    free(table);
+}
+
+float synth_modal_table_get_sample_rate(const SynthModalTable* table)
+{
+    return table ? table->sample_rate : 0.0f;
+}
+
+int synth_modal_table_get_max_modes(const SynthModalTable* table)
+{
+    return table ? table->max_modes : 0;
+}
+
+void synth_modal_bank_init(SynthModalBank* bank)
+{
+    if (!bank) return;
+    memset(bank, 0, sizeof(SynthModalBank));
+    bank->prune_level = MODAL_PRUNE_LEVEL;
+    bank->prune_countdown = MODAL_PRUNE_INTERVAL;
+}
+
+void synth_modal_bank_reset(SynthModalBank* bank)
+{
+    if (!bank) return;
+    memset(bank->re, 0, sizeof(bank->re));
+    memset(bank->im, 0, sizeof(bank->im));
+    bank->num_active = 0;
+    bank->input_peak = 0.0f;
+    bank->prune_countdown = MODAL_PRUNE_INTERVAL;
+}
+
+void synth_modal_bank_load_key(SynthModalBank* bank, const SynthModalTable* table,
+                               uint8_t note, float sample_rate, int max_modes)
+{
+    if (!bank) return;
+    if (note > 127) note = 127;
+    if (max_modes > MAX_MODES) max_modes = MAX_MODES;
+    if (max_modes < 0) max_modes = 0;
+
+    int count;
+    if (table && table->sample_rate == sample_rate && max_modes <= table->max_modes) {
+        const uint32_t first = table->offset[note];
+        count = (int)(table->offset[note + 1] - first);
+        if (count > max_modes) count = max_modes;
+        memcpy(bank->c, table->c + first, count * sizeof(float));
+        memcpy(bank->s, table->s + first, count * sizeof(float));
+        memcpy(bank->amp, table->amp + first, count * sizeof(float));
+    } else {
+        count = synth_modal_compute_key(note, sample_rate, max_modes, bank->c, bank->s, bank->amp);
+    }
+
+    for (int i = 0; i < count; i++) {
+        // Input drive normalized for unity gain at resonance (see synth_resonator)
+        const float r = sqrtf(bank->c[i] * bank->c[i] + bank->s[i] * bank->s[i]);
+        bank->gain[i] = (1.0f - r) * bank->amp[i];
+        bank->re[i] = 0.0f;
+        bank->im[i] = 0.0f;
+    }
+
+    // Unused slots must stay silent: the inner loop runs over whole lane groups
+    for (int i = count; i < MAX_MODES; i++) {
+        bank->re[i] = bank->im[i] = 0.0f;
+        bank->c[i] = bank->s[i] = 0.0f;
+        bank->gain[i] = bank->amp[i] = 0.0f;
+    }
+
+    bank->num_active = count;
+    bank->input_peak = 0.0f;
+    bank->prune_countdown = MODAL_PRUNE_INTERVAL;
+}
+
+void synth_modal_bank_strike(SynthModalBank* bank, float strength)
+{
+    if (!bank) return;
+    for (int i = 0; i < bank->num_active; i++) {
+        bank->re[i] += bank->amp[i] * strength;
+    }
+}
+
+// Drop modes that are below audibility and cannot be re-excited audibly by
+// the current input. Removed modes are swapped out with the last active one.
+static void modal_bank_prune(SynthModalBank* bank)
+{
+    const float level = bank->prune_level;
+    const float level_sq = level * level;
+    int i = 0;
+
+    while (i < bank->num_active) {
+        const float energy = bank->re[i] * bank->re[i] + bank->im[i] * bank->im[i];
+        if (energy < level_sq && bank->amp[i] * bank->input_peak < level) {
+            const int last = --bank->num_active;
+            bank->re[i] = bank->re[last];
+            bank->im[i] = bank->im[last];
+            bank->c[i] = bank->c[last];
+            bank->s[i] = bank->s[last];
+            bank->gain[i] = bank->gain[last];
+            bank->amp[i] = bank->amp[last];
+
+            bank->re[last] = bank->im[last] = 0.0f;
+            bank->c[last] = bank->s[last] = 0.0f;
+            bank->gain[last] = bank->amp[last] = 0.0f;
+            continue;  // Re-check the mode moved into this slot
+        }
+        i++;
+    }
+
+    bank->input_peak = 0.0f;
+}
+
+void synth_modal_bank_process(SynthModalBank* bank, const float* in, float* out, int frames)
+{
+    if (!bank || !out || frames <= 0) return;
+
+    if (bank->num_active == 0) {
+        memset(out, 0, frames * sizeof(float));
+        return;
+    }
+
+    // Round up to whole lane groups; padding slots are zeroed and stay silent
+    const int end = (bank->num_active + LANES - 1) & ~(LANES - 1);
+    float* re = bank->re;
+    float* im = bank->im;
+    const float* c = bank->c;
+    const float* s = bank->s;
+    const float* gain = bank->gain;
+    float peak = bank->input_peak;
+
+    for (int n = 0; n < frames; n++) {
+        const float x = in ? in[n] : 0.0f;
+        float acc[LANES] = {0};
+
+        for (int m = 0; m < end; m += LANES) {
+            for (int l = 0; l < LANES; l++) {
+                const int k = m + l;
+                const float zr = re[k];
+                const float zi = im[k];
+                const float nr = c[k] * zr - s[k] * zi + gain[k] * x;
+                const float ni = s[k] * zr + c[k] * zi;
+                re[k] = nr;
+                im[k] = ni;
+                acc[l] += ni;
+            }
+        }
+
+        float y = 0.0f;
+        for (int l = 0; l < LANES; l++) {
+            y += acc[l];
+        }
+        out[n] = y;
+
+        const float ax = fabsf(x);
+        if (ax > peak) peak = ax;
+    }
+
+    bank->input_peak = peak;
+    bank->prune_countdown -= frames;
+    if (bank->prune_countdown <= 0) {
+        modal_bank_prune(bank);
+        bank->prune_countdown = MODAL_PRUNE_INTERVAL;
+    }
+}
+
+int synth_modal_bank_get_active_modes(const SynthModalBank* bank)
+{
+    return bank ? bank->num_active : 0;
+}
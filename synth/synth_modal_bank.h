@@ -0,0 +1,87 @@
+/*
+ * Modal Resonator Bank - damped complex oscillators in SIMD-friendly lanes
+ *
+ * Each mode is a one-pole complex resonator z[n] = p * z[n-1] + g * x[n]
+ * with p = r * e^(jw). State and coefficients are kept as structure-of-arrays
+ * and processed in groups of SYNTH_MODAL_BANK_LANES so the compiler can map
+ * the inner loop onto SSE/NEON/WASM SIMD lanes without intrinsics.
+ *
+ * Modes that decay below the prune level are removed from the active set,
+ * so a voice only pays for the partials that are still audible.
+ */
+
+#ifndef SYNTH_MODAL_BANK_H
+#define SYNTH_MODAL_BANK_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SYNTH_MODAL_BANK_LANES 8
+#define SYNTH_MODAL_BANK_MAX_MODES 128
+
+typedef struct {
+    // Per-mode state (real/imaginary)
+    float re[SYNTH_MODAL_BANK_MAX_MODES];
+    float im[SYNTH_MODAL_BANK_MAX_MODES];
+
+    // Per-mode coefficients: pole (r*cos w, r*sin w), input drive, amplitude
+    float c[SYNTH_MODAL_BANK_MAX_MODES];
+    float s[SYNTH_MODAL_BANK_MAX_MODES];
+    float gain[SYNTH_MODAL_BANK_MAX_MODES];
+    float amp[SYNTH_MODAL_BANK_MAX_MODES];
+
+    int num_active;         // Active modes (packed at the front)
+    float prune_level;      // Amplitude below which a mode is dropped
+    float input_peak;       // Peak input since last prune pass
+    int prune_countdown;    // Samples until next prune pass
+} SynthModalBank;
+
+/**
+ * Precomputed per-key mode data (shared, read-only after creation)
+ * One table can be shared by all voices running at the same sample rate.
+ */
+typedef struct SynthModalTable SynthModalTable;
+
+/**
+ * Compute piano-like modes for a key (stiff-string partials with
+ * inharmonicity, frequency-dependent decay and hammer rolloff).
+ * Writes up to max_modes entries to c/s/amp and returns the count.
+ * Partials above Nyquist or below audibility are skipped.
+ */
+int synth_modal_compute_key(uint8_t note, float sample_rate, int max_modes,
+                            float* c, float* s, float* amp);
+
+/**
+ * Build a table with the modes of all 128 keys
+ * Returns NULL on allocation failure
+ */
+SynthModalTable* synth_modal_table_create(float sample_rate, int max_modes);
+void synth_modal_table_destroy(SynthModalTable* table);
+float synth_modal_table_get_sample_rate(const SynthModalTable* table);
+int synth_modal_table_get_max_modes(const SynthModalTable* table);
+
+// Bank setup
+void synth_modal_bank_init(SynthModalBank* bank);
+void synth_modal_bank_reset(SynthModalBank* bank);
+
+// Load modes for a key, from a table (if non-NULL) or computed on demand
+void synth_modal_bank_load_key(SynthModalBank* bank, const SynthModalTable* table,
+                               uint8_t note, float sample_rate, int max_modes);
+
+// Excite all active modes with an impulse (e.g. hammer strike)
+void synth_modal_bank_strike(SynthModalBank* bank, float strength);
+
+// Process a block: out[n] = sum of all mode outputs driven by in[n]
+void synth_modal_bank_process(SynthModalBank* bank, const float* in, float* out, int frames);
+
+// Number of modes still being rendered
+int synth_modal_bank_get_active_modes(const SynthModalBank* bank);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SYNTH_MODAL_BANK_H
@@ -1,28 +1,22 @@
 #include "synth_modal_piano.h"
 #include "synth_sample_player.h"
+#include "synth_modal_bank.h"
 #include <stdlib.h>
 #include <math.h>
 #include <string.h>
 
-#ifndef M_PI
-#define M_PI 3.14159265358979323846f
-#endif
-
-#define NUM_RESONATORS 6
-
-// Biquad filter for modal resonators
-typedef struct {
-    float b0, b1, b2, a1, a2;  // Filter coefficients
-    float x1, x2, y1, y2;       // State variables
-} BiquadFilter;
+#define DEFAULT_MODE_COUNT 16
+#define PROCESS_CHUNK 64
 
 struct ModalPiano {
     SynthSamplePlayer* sample_player;
 
-    // Modal resonators (biquad bandpass filters)
-    BiquadFilter resonators[NUM_RESONATORS];
-    float resonator_gains[NUM_RESONATORS];
+    // Modal resonator bank (piano partials, driven by the sample and struck on trigger)
+    SynthModalBank bank;
+    const SynthModalTable* mode_table;  // Optional shared per-key mode data
+    int mode_count;
     float resonance_amount;
+    float sample_rate;
 
     // Filter envelope
     float filter_cutoff;          // Current cutoff frequency (Hz)
@@ -45,56 +39,6 @@ struct ModalPiano {
     uint8_t velocity;
 };
 
-// Initialize biquad as bandpass filter with moderate Q
-static void biquad_init_bandpass(BiquadFilter* filter, float freq, float sample_rate, float Q) {
-    float w0 = 2.0f * M_PI * freq / sample_rate;
-    float alpha = sinf(w0) / (2.0f * Q);
-    float cos_w0 = cosf(w0);
-
-    // Bandpass filter (constant 0 dB peak gain)
-    filter->b0 = alpha;
-    filter->b1 = 0.0f;
-    filter->b2 = -alpha;
-    filter->a1 = -2.0f * cos_w0;
-    filter->a2 = 1.0f - alpha;
-
-    // Normalize by a0
-    float a0 = 1.0f + alpha;
-    filter->b0 /= a0;
-    filter->b1 /= a0;
-    filter->b2 /= a0;
-    filter->a1 /= a0;
-    filter->a2 /= a0;
-
-    filter->x1 = filter->x2 = 0.0f;
-    filter->y1 = filter->y2 = 0.0f;
-}
-
-// Process one sample through biquad filter
-static inline float biquad_process(BiquadFilter* filter, float input) {
-    float output = filter->b0 * input + filter->b1 * filter->x1 + filter->b2 * filter->x2
-                   - filter->a1 * filter->y1 - filter->a2 * filter->y2;
-
-    // Clamp output to prevent extreme values
-    if (output > 10.0f) output = 10.0f;
-    if (output < -10.0f) output = -10.0f;
-    // Check for NaN (NaN != NaN is true)
-    if (output != output) output = 0.0f;
-
-    filter->x2 = filter->x1;
-    filter->x1 = input;
-    filter->y2 = filter->y1;
-    filter->y1 = output;
-
-    return output;
-}
-
-// Reset biquad filter state
-static void biquad_reset(BiquadFilter* filter) {
-    filter->x1 = filter->x2 = 0.0f;
-    filter->y1 = filter->y2 = 0.0f;
-}
-
 // Convert MIDI note to frequency
 static float midi_to_freq(uint8_t note) {
     return 440.0f * powf(2.0f, (note - 69) / 12.0f);
@@ -113,7 +57,11 @@ ModalPiano* modal_piano_create(void) {
         return NULL;
     }
 
+    synth_modal_bank_init(&piano->bank);
+
     // Default parameters
+    piano->mode_count = DEFAULT_MODE_COUNT;
+    piano->sample_rate = 48000.0f;
     piano->resonance_amount = 0.0f;      // Start with resonators off for safety
     piano->filter_attack_time = 0.01f;   // 10ms attack (not used - we skip to decay)
     piano->filter_decay_time = 0.3f;     // 300ms decay
@@ -149,31 +97,10 @@ void modal_piano_trigger(ModalPiano* piano, uint8_t note, uint8_t velocity) {
     // Trigger internal sample player
     synth_sample_player_trigger(piano->sample_player, note, velocity);
 
-    // Initialize modal resonators tuned to harmonics
-    float sample_rate = 48000.0f; // TODO: make configurable
-
-    for (int i = 0; i < NUM_RESONATORS; i++) {
-        // Tune to harmonic (1x, 2x, 3x, 4x, 5x, 6x fundamental)
-        float harmonic = (i + 1);
-        float freq = piano->fundamental_freq * harmonic;
-
-        // Clamp to Nyquist
-        if (freq > sample_rate * 0.45f) {
-            freq = sample_rate * 0.45f;
-        }
-
-        // Higher harmonics have lower Q (decay faster)
-        // Q: 12 (fundamental) down to 7 (6th harmonic) - moderate Q for stability
-        float Q = 12.0f - (harmonic - 1) * 0.8f;
-
-        biquad_init_bandpass(&piano->resonators[i], freq, sample_rate, Q);
-
-        // Explicitly reset filter state for safety
-        biquad_reset(&piano->resonators[i]);
-
-        // Higher harmonics have lower gain
-        piano->resonator_gains[i] = 1.0f / harmonic;
-    }
+    // Load the partials for this key and strike them like a hammer
+    synth_modal_bank_load_key(&piano->bank, piano->mode_table, note,
+                              piano->sample_rate, piano->mode_count);
+    synth_modal_bank_strike(&piano->bank, velocity / 127.0f);
 
     // Calculate peak brightness based on velocity
     float vel_norm = velocity / 127.0f;
@@ -236,7 +163,11 @@ void modal_piano_set_lfo(ModalPiano* piano, float rate, float depth) {
 bool modal_piano_is_active(const ModalPiano* piano) {
     if (!piano || !piano->sample_player) return false;
 
-    return synth_sample_player_is_active(piano->sample_player);
+    if (synth_sample_player_is_active(piano->sample_player)) return true;
+
+    // The resonators ring on after the sample ends, until pruned as inaudible
+    return piano->resonance_amount > 0.0f &&
+           synth_modal_bank_get_active_modes(&piano->bank) > 0;
 }
 
 void modal_piano_reset(ModalPiano* piano) {
@@ -247,24 +178,41 @@ void modal_piano_reset(ModalPiano* piano) {
     }
 
     // Reset resonator state
-    for (int i = 0; i < NUM_RESONATORS; i++) {
-        biquad_reset(&piano->resonators[i]);
-    }
+    synth_modal_bank_reset(&piano->bank);
 
     piano->filter_prev_sample = 0.0f;
     piano->filter_envelope = 0.0f;
     piano->env_state = ENV_IDLE;
 }
 
-float modal_piano_process(ModalPiano* piano, uint32_t output_sample_rate) {
-    if (!piano || !piano->sample_player) return 0.0f;
+void modal_piano_set_mode_count(ModalPiano* piano, int count) {
+    if (!piano) return;
 
-    // Get sample from sample player
-    float sample = synth_sample_player_process(piano->sample_player, output_sample_rate);
+    if (count < 1) count = 1;
+    if (count > SYNTH_MODAL_BANK_MAX_MODES) count = SYNTH_MODAL_BANK_MAX_MODES;
+    piano->mode_count = count;
+}
 
-    // Update filter envelope
-    float dt = 1.0f / output_sample_rate;
+void modal_piano_set_sample_rate(ModalPiano* piano, float sample_rate) {
+    if (!piano || sample_rate <= 0.0f) return;
 
+    piano->sample_rate = sample_rate;
+}
+
+void modal_piano_set_mode_table(ModalPiano* piano, const SynthModalTable* table) {
+    if (!piano) return;
+
+    piano->mode_table = table;
+}
+
+int modal_piano_get_active_modes(const ModalPiano* piano) {
+    if (!piano) return 0;
+
+    return synth_modal_bank_get_active_modes(&piano->bank);
+}
+
+// Advance the filter envelope by one sample
+static void modal_piano_update_envelope(ModalPiano* piano, float dt) {
     switch (piano->env_state) {
         case ENV_ATTACK:
             if (piano->filter_attack_time > 0.0f) {
@@ -319,38 +267,68 @@ float modal_piano_process(ModalPiano* piano, uint32_t output_sample_rate) {
             piano->filter_envelope = 0.0f;
             break;
     }
+}
 
-    // Apply modal resonators (ADD sympathetic resonance to signal)
-    if (piano->resonance_amount > 0.0f) {
-        float resonant_sample = 0.0f;
+void modal_piano_process_block(ModalPiano* piano, float* out, uint32_t frames, uint32_t output_sample_rate) {
+    if (!out) return;
+    if (!piano || !piano->sample_player || output_sample_rate == 0) {
+        memset(out, 0, frames * sizeof(float));
+        return;
+    }
 
-        for (int i = 0; i < NUM_RESONATORS; i++) {
-            float resonator_out = biquad_process(&piano->resonators[i], sample);
-            resonant_sample += resonator_out * piano->resonator_gains[i];
-        }
+    const float dt = 1.0f / output_sample_rate;
+    float resonant[PROCESS_CHUNK];
 
-        // Normalize resonator sum
-        // Bandpass filters with Q=7-12 need moderate scaling
-        resonant_sample *= 1.5f;
+    while (frames > 0) {
+        const uint32_t n = frames < PROCESS_CHUNK ? frames : PROCESS_CHUNK;
 
-        // ADD to dry signal (preserves volume)
-        sample = sample + resonant_sample * piano->resonance_amount;
+        // Get samples from sample player
+        for (uint32_t i = 0; i < n; i++) {
+            out[i] = synth_sample_player_process(piano->sample_player, output_sample_rate);
+        }
 
-        // Soft clip the result to prevent harsh peaks from high resonance
-        if (sample > 0.95f) {
-            sample = 0.95f + 0.05f * tanhf((sample - 0.95f) / 0.05f);
-        } else if (sample < -0.95f) {
-            sample = -0.95f + 0.05f * tanhf((sample + 0.95f) / 0.05f);
+        // Run the modal bank over the whole chunk (resonance off skips it entirely)
+        const bool resonate = piano->resonance_amount > 0.0f;
+        if (resonate) {
+            synth_modal_bank_process(&piano->bank, out, resonant, (int)n);
         }
-    }
 
-    // Apply filter envelope (one-pole low-pass with time-varying cutoff)
-    // Map envelope to cutoff: 0.2 (dark) to 1.0 (bright)
-    float brightness = piano->filter_envelope * piano->filter_peak;
-    float cutoff = 0.2f + brightness * 0.8f;
+        for (uint32_t i = 0; i < n; i++) {
+            float sample = out[i];
 
-    sample = piano->filter_prev_sample + cutoff * (sample - piano->filter_prev_sample);
-    piano->filter_prev_sample = sample;
+            modal_piano_update_envelope(piano, dt);
 
+            // Apply modal resonators (ADD sympathetic resonance to signal)
+            if (resonate) {
+                // ADD to dry signal (preserves volume)
+                sample = sample + resonant[i] * piano->resonance_amount;
+
+                // Soft clip the result to prevent harsh peaks from high resonance
+                if (sample > 0.95f) {
+                    sample = 0.95f + 0.05f * tanhf((sample - 0.95f) / 0.05f);
+                } else if (sample < -0.95f) {
+                    sample = -0.95f + 0.05f * tanhf((sample + 0.95f) / 0.05f);
+                }
+            }
+
+            // Apply filter envelope (one-pole low-pass with time-varying cutoff)
+            // Map envelope to cutoff: 0.2 (dark) to 1.0 (bright)
+            float brightness = piano->filter_envelope * piano->filter_peak;
+            float cutoff = 0.2f + brightness * 0.8f;
+
+            sample = piano->filter_prev_sample + cutoff * (sample - piano->filter_prev_sample);
+            piano->filter_prev_sample = sample;
+
+            out[i] = sample;
+        }
+
+        out += n;
+        frames -= n;
+    }
+}
+
+float modal_piano_process(ModalPiano* piano, uint32_t output_sample_rate) {
+    float sample = 0.0f;
+    modal_piano_process_block(piano, &sample, 1, output_sample_rate);
     return sample;
 }
@@ -3,7 +3,7 @@
  * Modal Piano Synthesizer - Piano-specific sample-based synthesis
  *
  * Features:
- * - Modal resonator bank for sympathetic resonance
+ * - Modal resonator bank (up to 128 inharmonic partials, pruned once inaudible)
  * - Filter envelope for dynamic brightness (velocity → brightness)
  * - Per-partial decay for realistic piano timbre
  * - Built on top of generic sample player
@@ -12,6 +12,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "synth_sample_player.h"
+#include "synth_modal_bank.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -81,8 +82,34 @@ void modal_piano_set_velocity_sensitivity(ModalPiano* piano, float amount);
  */
 void modal_piano_set_lfo(ModalPiano* piano, float rate, float depth);
 
+/**
+ * Set the number of modal partials per voice (1-128, default 16)
+ * Takes effect on the next trigger
+ */
+void modal_piano_set_mode_count(ModalPiano* piano, int count);
+
+/**
+ * Set the sample rate the partials are tuned for (default 48000)
+ * Call before triggering notes and whenever the host rate changes, together
+ * with a mode table built for the same rate; not from the audio thread.
+ */
+void modal_piano_set_sample_rate(ModalPiano* piano, float sample_rate);
+
+/**
+ * Share a precomputed per-key mode table between voices
+ * The table must outlive the piano; NULL computes modes on each trigger.
+ * Only used when its sample rate matches modal_piano_set_sample_rate().
+ */
+void modal_piano_set_mode_table(ModalPiano* piano, const SynthModalTable* table);
+
+/**
+ * Number of partials still being rendered (decayed modes are pruned)
+ */
+int modal_piano_get_active_modes(const ModalPiano* piano);
+
 /**
  * Check if the piano is currently active
+ * Stays true while the resonators ring on after the sample has ended.
  */
 bool modal_piano_is_active(const ModalPiano* piano);
 
@@ -93,6 +120,12 @@ bool modal_piano_is_active(const ModalPiano* piano);
  */
 float modal_piano_process(ModalPiano* piano, uint32_t output_sample_rate);
 
+/**
+ * Process a block of samples (mono)
+ * Preferred over modal_piano_process(): the modal bank runs a block at a time
+ */
+void modal_piano_process_block(ModalPiano* piano, float* out, uint32_t frames, uint32_t output_sample_rate);
+
 /**
  * Reset the piano to initial state
  */
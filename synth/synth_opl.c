@@ -0,0 +1,857 @@
+/*
+ * Regroove OPL2/OPL3 FM Engine Implementation
+ *
+ * Signal path per operator, as on the chip:
+ *   phase (10 bit) -> log-sin ROM (attenuation) + envelope -> exp ROM -> +/-4095
+ * Register semantics and rhythm phase tricks follow the YMF262 datasheet and
+ * the behaviour documented by the Nuked OPL3 project.
+ */
+
+#include "synth_opl.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define NUM_OPS SYNTH_OPL_OPERATORS
+#define NUM_CH SYNTH_OPL_CHANNELS
+
+#define ENV_MAX 511.0f            // Envelope attenuation, 0.1875 dB per unit
+#define LFO_CONTROL_BLOCK 64      // Tremolo/vibrato update interval
+#define WAVE_SILENT 0x1000        // Log attenuation that decodes to 0
+
+typedef enum {
+    EG_ATTACK = 0,
+    EG_DECAY,
+    EG_SUSTAIN,
+    EG_RELEASE,
+    EG_OFF
+} OplEnvState;
+
+typedef enum {
+    CH_2OP = 0,
+    CH_4OP_MASTER,
+    CH_4OP_SLAVE,
+    CH_RHYTHM
+} OplChannelType;
+
+// Quarter-wave log-sin ROM: round(-log2(sin((i + 0.5) * pi / 512)) * 256)
+static const uint16_t logsin_rom[256] = {
+    2137, 1731, 1543, 1419, 1326, 1252, 1190, 1137, 1091, 1050, 1013,  979,  949,  920,  894,  869,
+     846,  825,  804,  785,  767,  749,  732,  717,  701,  687,  672,  659,  646,  633,  621,  609,
+     598,  587,  576,  566,  556,  546,  536,  527,  518,  509,  501,  492,  484,  476,  468,  461,
+     453,  446,  439,  432,  425,  418,  411,  405,  399,  392,  386,  380,  375,  369,  363,  358,
+     352,  347,  341,  336,  331,  326,  321,  316,  311,  307,  302,  297,  293,  289,  284,  280,
+     276,  271,  267,  263,  259,  255,  251,  248,  244,  240,  236,  233,  229,  226,  222,  219,
+     215,  212,  209,  205,  202,  199,  196,  193,  190,  187,  184,  181,  178,  175,  172,  169,
+     167,  164,  161,  159,  156,  153,  151,  148,  146,  143,  141,  138,  136,  134,  131,  129,
+     127,  125,  122,  120,  118,  116,  114,  112,  110,  108,  106,  104,  102,  100,   98,   96,
+      94,   92,   91,   89,   87,   85,   83,   82,   80,   78,   77,   75,   74,   72,   70,   69,
+      67,   66,   64,   63,   62,   60,   59,   57,   56,   55,   53,   52,   51,   49,   48,   47,
+      46,   45,   43,   42,   41,   40,   39,   38,   37,   36,   35,   34,   33,   32,   31,   30,
+      29,   28,   27,   26,   25,   24,   23,   23,   22,   21,   20,   20,   19,   18,   17,   17,
+      16,   15,   15,   14,   13,   13,   12,   12,   11,   10,   10,    9,    9,    8,    8,    7,
+       7,    7,    6,    6,    5,    5,    5,    4,    4,    4,    3,    3,    3,    2,    2,    2,
+       2,    1,    1,    1,    1,    1,    1,    1,    0,    0,    0,    0,    0,    0,    0,    0,
+};
+
+// Exp ROM: round(2^((255 - i) / 256) * 1024); output = (rom << 1) >> (level >> 8)
+static const uint16_t exp_rom[256] = {
+    2042, 2037, 2031, 2026, 2020, 2015, 2010, 2004, 1999, 1993, 1988, 1983, 1977, 1972, 1967, 1962,
+    1956, 1951, 1946, 1941, 1936, 1930, 1925, 1920, 1915, 1910, 1905, 1900, 1895, 1890, 1885, 1880,
+    1875, 1870, 1865, 1860, 1855, 1850, 1845, 1840, 1836, 1831, 1826, 1821, 1816, 1812, 1807, 1802,
+    1797, 1793, 1788, 1783, 1779, 1774, 1769, 1765, 1760, 1756, 1751, 1747, 1742, 1738, 1733, 1729,
+    1724, 1720, 1715, 1711, 1706, 1702, 1698, 1693, 1689, 1685, 1680, 1676, 1672, 1667, 1663, 1659,
+    1655, 1650, 1646, 1642, 1638, 1634, 1630, 1625, 1621, 1617, 1613, 1609, 1605, 1601, 1597, 1593,
+    1589, 1585, 1581, 1577, 1573, 1569, 1565, 1561, 1557, 1554, 1550, 1546, 1542, 1538, 1534, 1531,
+    1527, 1523, 1519, 1516, 1512, 1508, 1505, 1501, 1497, 1494, 1490, 1486, 1483, 1479, 1475, 1472,
+    1468, 1465, 1461, 1458, 1454, 1451, 1447, 1444, 1440, 1437, 1433, 1430, 1427, 1423, 1420, 1416,
+    1413, 1410, 1406, 1403, 1400, 1396, 1393, 1390, 1387, 1383, 1380, 1377, 1374, 1370, 1367, 1364,
+    1361, 1358, 1355, 1351, 1348, 1345, 1342, 1339, 1336, 1333, 1330, 1327, 1324, 1321, 1318, 1315,
+    1312, 1309, 1306, 1303, 1300, 1297, 1294, 1291, 1288, 1285, 1282, 1279, 1277, 1274, 1271, 1268,
+    1265, 1262, 1260, 1257, 1254, 1251, 1248, 1246, 1243, 1240, 1237, 1235, 1232, 1229, 1227, 1224,
+    1221, 1219, 1216, 1213, 1211, 1208, 1206, 1203, 1200, 1198, 1195, 1193, 1190, 1188, 1185, 1183,
+    1180, 1178, 1175, 1173, 1170, 1168, 1165, 1163, 1160, 1158, 1155, 1153, 1151, 1148, 1146, 1143,
+    1141, 1139, 1136, 1134, 1132, 1129, 1127, 1125, 1122, 1120, 1118, 1116, 1113, 1111, 1109, 1107,
+};
+
+// Frequency multiplier x2 (MULT register)
+static const uint8_t mult_x2[16] = { 1, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 20, 24, 24, 30, 30 };
+
+// Key scale level ROM (top 4 bits of F-number)
+static const uint8_t ksl_rom[16] = { 0, 32, 40, 45, 48, 51, 53, 55, 56, 58, 59, 60, 61, 62, 63, 64 };
+static const uint8_t ksl_shift[4] = { 8, 1, 2, 0 };
+
+// Register offset (0x00-0x15) -> operator slot within a bank, -1 = unused
+static const int8_t offset_to_slot[32] = {
+     0,  1,  2,  3,  4,  5, -1, -1,  6,  7,  8,  9, 10, 11, -1, -1,
+    12, 13, 14, 15, 16, 17, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+
+// First operator slot of each channel within a bank (second is +3)
+static const uint8_t channel_slot[9] = { 0, 1, 2, 6, 7, 8, 12, 13, 14 };
+
+// Rhythm operators (bank 0 slots)
+#define OP_BD1 12
+#define OP_BD2 15
+#define OP_HH  13
+#define OP_TOM 14
+#define OP_SD  16
+#define OP_CY  17
+
+struct SynthOPL {
+    int sample_rate;
+    double rate_scale;           // Native chip rate / output rate
+
+    // Operator state (SoA)
+    uint32_t phase[NUM_OPS];
+    uint32_t phase_inc[NUM_OPS];
+    uint32_t phase_inc_vib[NUM_OPS];  // Increment with vibrato applied (per control block)
+    float env[NUM_OPS];
+    float attack_coeff[NUM_OPS];      // Exponential attack, per sample
+    float decay_inc[NUM_OPS];         // Linear-in-dB decay, units per sample
+    float release_inc[NUM_OPS];
+    float sustain_level[NUM_OPS];
+    int32_t total_att[NUM_OPS];       // TL + KSL in envelope units
+    int32_t eg_out[NUM_OPS];          // Envelope + TL + KSL + tremolo, 0-511
+    int16_t out[NUM_OPS];
+    int16_t prev_out[NUM_OPS];
+    uint8_t eg_state[NUM_OPS];
+    uint8_t key[NUM_OPS];             // Bit 0: channel key-on, bit 1: rhythm key-on
+    uint8_t waveform[NUM_OPS];
+    uint8_t op_channel[NUM_OPS];      // Channel whose F-number drives the operator
+
+    // Operator registers
+    uint8_t am[NUM_OPS], vib[NUM_OPS], egt[NUM_OPS], ksr[NUM_OPS], mult[NUM_OPS];
+    uint8_t ksl[NUM_OPS], tl[NUM_OPS], ar[NUM_OPS], dr[NUM_OPS], sl[NUM_OPS], rr[NUM_OPS], ws[NUM_OPS];
+
+    // Channel state
+    uint16_t fnum[NUM_CH];
+    uint8_t block[NUM_CH];
+    uint8_t key_on[NUM_CH];
+    uint8_t feedback[NUM_CH];
+    uint8_t connection[NUM_CH];
+    uint8_t pan_left[NUM_CH];
+    uint8_t pan_right[NUM_CH];
+    uint8_t type[NUM_CH];
+
+    // Global registers
+    uint8_t regs[512];
+    uint8_t wse;                 // OPL2 waveform select enable
+    uint8_t nts;                 // Note select (key scale rate split)
+    uint8_t newm;                // OPL3 mode
+    uint8_t four_op;             // 4-op connection enables (0x104)
+    uint8_t rhythm;              // 0xBD
+    uint32_t noise;              // Rhythm noise LFSR
+
+    // Tremolo / vibrato
+    float lfo_am_phase;
+    float lfo_vib_phase;
+    int32_t trem_value;
+    int lfo_countdown;
+
+    // Decoded waveforms: bit 15 = negative, low 13 bits = log attenuation
+    uint16_t wave_table[8][1024];
+};
+
+// ============================================================================
+// Tables
+// ============================================================================
+
+static uint16_t sine_log(uint32_t p)
+{
+    const uint16_t att = (p & 0x100) ? logsin_rom[(p & 0xFF) ^ 0xFF] : logsin_rom[p & 0xFF];
+    return (uint16_t)(att | ((p & 0x200) ? 0x8000 : 0));
+}
+
+// Chip waveform 0-7 at 10-bit phase p
+static uint16_t wave_log(int wave, uint32_t p)
+{
+    p &= 0x3FF;
+
+    switch (wave & 7) {
+    case 0: // Sine
+        return sine_log(p);
+    case 1: // Half sine
+        return (p & 0x200) ? WAVE_SILENT : sine_log(p);
+    case 2: // Absolute sine
+        return sine_log(p) & 0x7FFF;
+    case 3: // Quarter (pulse) sine
+        return (p & 0x100) ? WAVE_SILENT : (sine_log(p) & 0x7FFF);
+    case 4: // Alternating sine (double speed, first half)
+        return (p & 0x200) ? WAVE_SILENT : sine_log(p << 1);
+    case 5: // Camel sine
+        return (p & 0x200) ? WAVE_SILENT : (sine_log(p << 1) & 0x7FFF);
+    case 6: // Square
+        return (p & 0x200) ? 0x8000 : 0;
+    default: { // Derived square (log sawtooth)
+        uint32_t q = p & 0x1FF;
+        if (p & 0x200) q ^= 0x1FF;
+        return (uint16_t)((q << 3) | ((p & 0x200) ? 0x8000 : 0));
+    }
+    }
+}
+
+static inline int32_t decode_level(uint16_t w, int32_t eg)
+{
+    int32_t level = (w & 0x1FFF) + (eg << 3);
+    if (level > 0x1FFF) level = 0x1FFF;
+    const int32_t v = (exp_rom[level & 0xFF] << 1) >> (level >> 8);
+    return (w & 0x8000) ? -v : v;
+}
+
+float synth_opl_waveform_sample(int waveform, float phase)
+{
+    phase -= floorf(phase);
+    const uint32_t p = (uint32_t)(phase * 1024.0f) & 0x3FF;
+    return decode_level(wave_log(waveform, p), 0) * (1.0f / 4084.0f);
+}
+
+// ============================================================================
+// Parameter updates
+// ============================================================================
+
+static inline int op_bank(int op) { return op >= 18 ? 1 : 0; }
+
+static void op_update_rates(SynthOPL* opl, int op)
+{
+    const int ch = opl->op_channel[op];
+    const int ksv = (opl->block[ch] << 1) | ((opl->fnum[ch] >> (9 - opl->nts)) & 1);
+    const int rof = opl->ksr[op] ? ksv : (ksv >> 2);
+    const double samples_per_ms = opl->sample_rate * 0.001;
+
+    // Rates follow the datasheet timing tables: each step of the 4-bit rate
+    // halves the time, the key scale offset adds quarter steps.
+#define EFFECTIVE_RATE(r) ((r) ? ((r) * 4 + rof > 63 ? 63 : (r) * 4 + rof) : 0)
+    const int ar = EFFECTIVE_RATE(opl->ar[op]);
+    const int dr = EFFECTIVE_RATE(opl->dr[op]);
+    const int rr = EFFECTIVE_RATE(opl->rr[op]);
+#undef EFFECTIVE_RATE
+
+    if (ar == 0) {
+        opl->attack_coeff[op] = 0.0f;
+    } else if (ar >= 60) {
+        opl->attack_coeff[op] = 1.0f;   // Instant
+    } else {
+        const double ms = 2826.24 / (double)(1 << ((ar >> 2) - 1)) / (1.0 + (ar & 3) * 0.25);
+        // Exponential approach: (env + 8) falls from 519 to 8 in 'ms'
+        opl->attack_coeff[op] = (float)(4.17 / (ms * samples_per_ms));
+    }
+
+    double ms;
+    if (dr == 0) {
+        opl->decay_inc[op] = 0.0f;
+    } else {
+        ms = 39280.0 / (double)(1 << ((dr >> 2) - 1)) / (1.0 + (dr & 3) * 0.25);
+        opl->decay_inc[op] = (float)(512.0 / (ms * samples_per_ms));
+    }
+    if (rr == 0) {
+        opl->release_inc[op] = 0.0f;
+    } else {
+        ms = 39280.0 / (double)(1 << ((rr >> 2) - 1)) / (1.0 + (rr & 3) * 0.25);
+        opl->release_inc[op] = (float)(512.0 / (ms * samples_per_ms));
+    }
+
+    opl->sustain_level[op] = (float)((opl->sl[op] == 15 ? 31 : opl->sl[op]) << 4);
+}
+
+static void op_update_level(SynthOPL* opl, int op)
+{
+    const int ch = opl->op_channel[op];
+    int ksl = (ksl_rom[opl->fnum[ch] >> 6] << 2) - ((8 - opl->block[ch]) << 5);
+    if (ksl < 0) ksl = 0;
+    opl->total_att[op] = (opl->tl[op] << 2) + (ksl >> ksl_shift[opl->ksl[op]]);
+}
+
+static void op_update_freq(SynthOPL* opl, int op)
+{
+    const int ch = opl->op_channel[op];
+    // 19-bit chip phase increment, scaled to a 32-bit accumulator at our rate
+    const double inc19 = (double)((uint32_t)opl->fnum[ch] << opl->block[ch]) * mult_x2[opl->mult[op]] * 0.25;
+    // Top notes at high multipliers exceed 32 bits: convert through 64 bits and
+    // let it wrap like the accumulator does
+    opl->phase_inc[op] = (uint32_t)(uint64_t)(inc19 * 8192.0 * opl->rate_scale);
+    opl->phase_inc_vib[op] = opl->phase_inc[op];
+}
+
+static void op_update_all(SynthOPL* opl, int op)
+{
+    op_update_freq(opl, op);
+    op_update_rates(opl, op);
+    op_update_level(opl, op);
+}
+
+static void op_update_waveform(SynthOPL* opl, int op)
+{
+    const int mask = opl->newm ? 7 : (opl->wse ? 3 : 0);
+    opl->waveform[op] = opl->ws[op] & mask;
+}
+
+static void op_key(SynthOPL* opl, int op, uint8_t source, bool on)
+{
+    const uint8_t old = opl->key[op];
+    opl->key[op] = on ? (uint8_t)(old | source) : (uint8_t)(old & ~source);
+
+    if (!old && opl->key[op]) {
+        opl->phase[op] = 0;
+        if (opl->attack_coeff[op] >= 1.0f) {
+            opl->env[op] = 0.0f;
+            opl->eg_state[op] = EG_DECAY;
+        } else {
+            opl->eg_state[op] = EG_ATTACK;
+        }
+    } else if (old && !opl->key[op] && opl->eg_state[op] != EG_OFF) {
+        opl->eg_state[op] = EG_RELEASE;
+    }
+}
+
+static inline int ch_op1(int ch)
+{
+    const int bank = ch >= 9 ? 1 : 0;
+    return bank * 18 + channel_slot[ch - bank * 9];
+}
+
+// Recompute channel types and operator ownership after 0x104/0x105/0xBD
+static void update_channel_types(SynthOPL* opl)
+{
+    for (int ch = 0; ch < NUM_CH; ch++) {
+        opl->type[ch] = CH_2OP;
+    }
+
+    if (opl->newm) {
+        for (int i = 0; i < 6; i++) {
+            if (!(opl->four_op & (1 << i))) continue;
+            const int master = (i < 3) ? i : (i - 3 + 9);
+            opl->type[master] = CH_4OP_MASTER;
+            opl->type[master + 3] = CH_4OP_SLAVE;
+        }
+    }
+
+    if (opl->rhythm & 0x20) {
+        opl->type[6] = opl->type[7] = opl->type[8] = CH_RHYTHM;
+    }
+
+    for (int ch = 0; ch < NUM_CH; ch++) {
+        const int freq_ch = (opl->type[ch] == CH_4OP_SLAVE) ? ch - 3 : ch;
+        const int op1 = ch_op1(ch);
+        opl->op_channel[op1] = (uint8_t)freq_ch;
+        opl->op_channel[op1 + 3] = (uint8_t)freq_ch;
+        op_update_all(opl, op1);
+        op_update_all(opl, op1 + 3);
+    }
+}
+
+static void channel_update(SynthOPL* opl, int ch)
+{
+    const int op1 = ch_op1(ch);
+    op_update_all(opl, op1);
+    op_update_all(opl, op1 + 3);
+
+    if (opl->type[ch] == CH_4OP_MASTER) {
+        const int op3 = ch_op1(ch + 3);
+        op_update_all(opl, op3);
+        op_update_all(opl, op3 + 3);
+    }
+}
+
+static void channel_key(SynthOPL* opl, int ch, bool on)
+{
+    const int op1 = ch_op1(ch);
+    op_key(opl, op1, 1, on);
+    op_key(opl, op1 + 3, 1, on);
+
+    if (opl->type[ch] == CH_4OP_MASTER) {
+        const int op3 = ch_op1(ch + 3);
+        op_key(opl, op3, 1, on);
+        op_key(opl, op3 + 3, 1, on);
+    }
+}
+
+static void write_rhythm(SynthOPL* opl, uint8_t value)
+{
+    const uint8_t old = opl->rhythm;
+    opl->rhythm = value;
+
+    if ((old ^ value) & 0x20) {
+        update_channel_types(opl);
+    }
+
+    const bool on = (value & 0x20) != 0;
+    op_key(opl, OP_BD1, 2, on && (value & 0x10));
+    op_key(opl, OP_BD2, 2, on && (value & 0x10));
+    op_key(opl, OP_SD, 2, on && (value & 0x08));
+    op_key(opl, OP_TOM, 2, on && (value & 0x04));
+    op_key(opl, OP_CY, 2, on && (value & 0x02));
+    op_key(opl, OP_HH, 2, on && (value & 0x01));
+}
+
+// ============================================================================
+// Lifecycle
+// ============================================================================
+
+SynthOPL* synth_opl_create(int sample_rate)
+{
+    SynthOPL* opl = (SynthOPL*)malloc(sizeof(SynthOPL));
+    if (!opl) return NULL;
+
+    memset(opl, 0, sizeof(SynthOPL));
+
+    for (int w = 0; w < 8; w++) {
+        for (uint32_t p = 0; p < 1024; p++) {
+            opl->wave_table[w][p] = wave_log(w, p);
+        }
+    }
+
+    opl->sample_rate = sample_rate > 0 ? sample_rate : 48000;
+    opl->rate_scale = (double)SYNTH_OPL_NATIVE_RATE / opl->sample_rate;
+    synth_opl_reset(opl);
+
+    return opl;
+}
+
+void synth_opl_destroy(SynthOPL* opl)
+{
+    if (opl) free(opl);
+}
+
+void synth_opl_reset(SynthOPL* opl)
+{
+    if (!opl) return;
+
+    memset(opl->regs, 0, sizeof(opl->regs));
+    memset(opl->phase, 0, sizeof(opl->phase));
+    memset(opl->out, 0, sizeof(opl->out));
+    memset(opl->prev_out, 0, sizeof(opl->prev_out));
+    memset(opl->key, 0, sizeof(opl->key));
+    memset(opl->am, 0, sizeof(opl->am));
+    memset(opl->vib, 0, sizeof(opl->vib));
+    memset(opl->egt, 0, sizeof(opl->egt));
+    memset(opl->ksr, 0, sizeof(opl->ksr));
+    memset(opl->mult, 0, sizeof(opl->mult));
+    memset(opl->ksl, 0, sizeof(opl->ksl));
+    memset(opl->tl, 0, sizeof(opl->tl));
+    memset(opl->ar, 0, sizeof(opl->ar));
+    memset(opl->dr, 0, sizeof(opl->dr));
+    memset(opl->sl, 0, sizeof(opl->sl));
+    memset(opl->rr, 0, sizeof(opl->rr));
+    memset(opl->ws, 0, sizeof(opl->ws));
+    memset(opl->waveform, 0, sizeof(opl->waveform));
+
+    for (int op = 0; op < NUM_OPS; op++) {
+        opl->env[op] = ENV_MAX;
+        opl->eg_out[op] = 511;
+        opl->eg_state[op] = EG_OFF;
+    }
+
+    for (int ch = 0; ch < NUM_CH; ch++) {
+        opl->fnum[ch] = 0;
+        opl->block[ch] = 0;
+        opl->key_on[ch] = 0;
+        opl->feedback[ch] = 0;
+        opl->connection[ch] = 0;
+        opl->pan_left[ch] = 1;
+        opl->pan_right[ch] = 1;
+    }
+
+    opl->wse = 0;
+    opl->nts = 0;
+    opl->newm = 0;
+    opl->four_op = 0;
+    opl->rhythm = 0;
+    opl->noise = 1;
+    opl->lfo_am_phase = 0.0f;
+    opl->lfo_vib_phase = 0.0f;
+    opl->trem_value = 0;
+    opl->lfo_countdown = 0;
+
+    update_channel_types(opl);
+}
+
+void synth_opl_set_sample_rate(SynthOPL* opl, int sample_rate)
+{
+    if (!opl || sample_rate <= 0 || sample_rate == opl->sample_rate) return;
+
+    opl->sample_rate = sample_rate;
+    opl->rate_scale = (double)SYNTH_OPL_NATIVE_RATE / sample_rate;
+    for (int op = 0; op < NUM_OPS; op++) {
+        op_update_all(opl, op);
+    }
+}
+
+// ============================================================================
+// Register interface
+// ============================================================================
+
+void synth_opl_write(SynthOPL* opl, uint16_t reg, uint8_t value)
+{
+    if (!opl) return;
+
+    reg &= 0x1FF;
+    const int bank = reg >> 8;
+    const uint8_t r = reg & 0xFF;
+    opl->regs[reg] = value;
+
+    if ((r >= 0x20 && r < 0xA0) || r >= 0xE0) {
+        const int8_t slot = offset_to_slot[r & 0x1F];
+        if (slot < 0) return;
+        const int op = bank * 18 + slot;
+
+        switch (r & 0xE0) {
+        case 0x20:
+            opl->am[op] = (value >> 7) & 1;
+            opl->vib[op] = (value >> 6) & 1;
+            opl->egt[op] = (value >> 5) & 1;
+            opl->ksr[op] = (value >> 4) & 1;
+            opl->mult[op] = value & 0x0F;
+            op_update_freq(opl, op);
+            op_update_rates(opl, op);
+            break;
+        case 0x40:
+            opl->ksl[op] = (value >> 6) & 3;
+            opl->tl[op] = value & 0x3F;
+            op_update_level(opl, op);
+            break;
+        case 0x60:
+            opl->ar[op] = (value >> 4) & 0x0F;
+            opl->dr[op] = value & 0x0F;
+            op_update_rates(opl, op);
+            break;
+        case 0x80:
+            opl->sl[op] = (value >> 4) & 0x0F;
+            opl->rr[op] = value & 0x0F;
+            op_update_rates(opl, op);
+            break;
+        case 0xE0:
+            opl->ws[op] = value & 7;
+            op_update_waveform(opl, op);
+            break;
+        }
+        return;
+    }
+
+    if (r < 0x20) {
+        if (bank == 0 && r == 0x01) {
+            opl->wse = (value >> 5) & 1;
+            for (int op = 0; op < NUM_OPS; op++) op_update_waveform(opl, op);
+        } else if (bank == 0 && r == 0x08) {
+            opl->nts = (value >> 6) & 1;
+            for (int op = 0; op < NUM_OPS; op++) op_update_rates(opl, op);
+        } else if (bank == 1 && r == 0x04) {
+            opl->four_op = value & 0x3F;
+            update_channel_types(opl);
+        } else if (bank == 1 && r == 0x05) {
+            opl->newm = value & 1;
+            update_channel_types(opl);
+            for (int op = 0; op < NUM_OPS; op++) op_update_waveform(opl, op);
+        }
+        return;
+    }
+
+    if (bank == 0 && r == 0xBD) {
+        write_rhythm(opl, value);
+        return;
+    }
+
+    const int c = r & 0x0F;
+    if (c >= 9) return;
+    const int ch = bank * 9 + c;
+
+    switch (r & 0xF0) {
+    case 0xA0:
+        if (opl->type[ch] == CH_4OP_SLAVE) return;
+        opl->fnum[ch] = (uint16_t)((opl->fnum[ch] & 0x300) | value);
+        channel_update(opl, ch);
+        break;
+
+    case 0xB0: {
+        if (opl->type[ch] == CH_4OP_SLAVE) return;
+        opl->fnum[ch] = (uint16_t)((opl->fnum[ch] & 0xFF) | ((value & 3) << 8));
+        opl->block[ch] = (value >> 2) & 7;
+        channel_update(opl, ch);
+
+        const uint8_t kon = (value >> 5) & 1;
+        if (kon != opl->key_on[ch]) {
+            opl->key_on[ch] = kon;
+            channel_key(opl, ch, kon != 0);
+        }
+        break;
+    }
+
+    case 0xC0:
+        opl->feedback[ch] = (value >> 1) & 7;
+        opl->connection[ch] = value & 1;
+        opl->pan_left[ch] = (value >> 4) & 1;
+        opl->pan_right[ch] = (value >> 5) & 1;
+        break;
+    }
+}
+
+uint8_t synth_opl_read_reg(const SynthOPL* opl, uint16_t reg)
+{
+    return opl ? opl->regs[reg & 0x1FF] : 0;
+}
+
+// ============================================================================
+// Rendering
+// ============================================================================
+
+// Operator output at an explicit 10-bit phase
+static inline int32_t op_at(SynthOPL* opl, int op, uint32_t p)
+{
+    const int32_t v = decode_level(opl->wave_table[opl->waveform[op]][p & 0x3FF], opl->eg_out[op]);
+    opl->out[op] = (int16_t)v;
+    return v;
+}
+
+// Operator output with phase modulation
+static inline int32_t op_mod(SynthOPL* opl, int op, int32_t mod)
+{
+    return op_at(opl, op, (opl->phase[op] >> 22) + (uint32_t)mod);
+}
+
+// First operator of a channel, with self-feedback
+static inline int32_t op_feedback(SynthOPL* opl, int op, int fb)
+{
+    int32_t mod = 0;
+    if (fb) {
+        mod = ((int32_t)opl->prev_out[op] + opl->out[op]) >> (9 - fb);
+    }
+    opl->prev_out[op] = opl->out[op];
+    return op_mod(opl, op, mod);
+}
+
+// Tremolo and vibrato, evaluated once per control block
+static void update_lfo(SynthOPL* opl)
+{
+    const float dt = (float)LFO_CONTROL_BLOCK / opl->sample_rate;
+
+    opl->lfo_am_phase += 3.7f * dt;
+    opl->lfo_am_phase -= floorf(opl->lfo_am_phase);
+    opl->lfo_vib_phase += 6.07f * dt;
+    opl->lfo_vib_phase -= floorf(opl->lfo_vib_phase);
+
+    // Tremolo: triangle, 4.8 dB or 1 dB deep
+    const float tri = 1.0f - fabsf(2.0f * opl->lfo_am_phase - 1.0f);
+    const float am_depth = (opl->rhythm & 0x80) ? 25.6f : 5.33f;
+    opl->trem_value = (int32_t)(tri * am_depth);
+
+    // Vibrato: triangle, 14 or 7 cents
+    const float vtri = 2.0f * (1.0f - fabsf(2.0f * opl->lfo_vib_phase - 1.0f)) - 1.0f;
+    const float cents = (opl->rhythm & 0x40) ? 14.0f : 7.0f;
+    const float vib_factor = vtri * cents * (0.6931472f / 1200.0f);
+
+    for (int op = 0; op < NUM_OPS; op++) {
+        opl->phase_inc_vib[op] = opl->vib[op]
+            ? (uint32_t)((int64_t)opl->phase_inc[op] + (int64_t)(opl->phase_inc[op] * vib_factor))
+            : opl->phase_inc[op];
+    }
+}
+
+static inline void update_envelopes(SynthOPL* opl)
+{
+    for (int op = 0; op < NUM_OPS; op++) {
+        float env = opl->env[op];
+
+        switch (opl->eg_state[op]) {
+        case EG_ATTACK:
+            env -= (env + 8.0f) * opl->attack_coeff[op];
+            if (env <= 0.0f) {
+                env = 0.0f;
+                opl->eg_state[op] = EG_DECAY;
+            }
+            break;
+        case EG_DECAY:
+            env += opl->decay_inc[op];
+            if (env >= opl->sustain_level[op]) {
+                env = opl->sustain_level[op];
+                opl->eg_state[op] = EG_SUSTAIN;
+            }
+            break;
+        case EG_SUSTAIN:
+            // EGT clear: percussive, keeps decaying at the release rate
+            if (!opl->egt[op]) env += opl->release_inc[op];
+            break;
+        case EG_RELEASE:
+            env += opl->release_inc[op];
+            break;
+        default:
+            continue;
+        }
+
+        if (env >= ENV_MAX) {
+            env = ENV_MAX;
+            if (opl->eg_state[op] != EG_ATTACK) opl->eg_state[op] = EG_OFF;
+        }
+        opl->env[op] = env;
+
+        int32_t eg = (int32_t)env + opl->total_att[op] + (opl->am[op] ? opl->trem_value : 0);
+        opl->eg_out[op] = eg > 511 ? 511 : eg;
+    }
+}
+
+static inline bool channel_silent(const SynthOPL* opl, int ch)
+{
+    const int op1 = ch_op1(ch);
+    if (opl->eg_state[op1] != EG_OFF || opl->eg_state[op1 + 3] != EG_OFF) return false;
+    if (opl->type[ch] == CH_4OP_MASTER) {
+        const int op3 = ch_op1(ch + 3);
+        if (opl->eg_state[op3] != EG_OFF || opl->eg_state[op3 + 3] != EG_OFF) return false;
+    }
+    return true;
+}
+
+// Rhythm section (channels 6-8) for one sample
+static inline int32_t render_rhythm(SynthOPL* opl, int ch)
+{
+    const uint32_t hh = opl->phase[OP_HH] >> 22;
+    const uint32_t tc = opl->phase[OP_CY] >> 22;
+    const uint32_t noise = opl->noise & 1;
+    const uint32_t rm_xor = (((hh >> 2) ^ (hh >> 7)) | ((hh >> 3) ^ (tc >> 5)) | ((tc >> 3) ^ (tc >> 5))) & 1;
+
+    switch (ch) {
+    case 6: {
+        // Bass drum: regular 2-op voice at double level
+        int32_t m = op_feedback(opl, OP_BD1, opl->feedback[6]);
+        int32_t c = opl->connection[6] ? op_mod(opl, OP_BD2, 0) : op_mod(opl, OP_BD2, m);
+        return c * 2;
+    }
+    case 7: {
+        // Hi-hat and snare derive their phase from the hi-hat/cymbal operators
+        uint32_t p = rm_xor << 9;
+        p |= (rm_xor ^ noise) ? 0xD0 : 0x34;
+        const int32_t h = op_at(opl, OP_HH, p);
+        const uint32_t hh8 = (hh >> 8) & 1;
+        const int32_t s = op_at(opl, OP_SD, (hh8 << 9) | ((hh8 ^ noise) << 8));
+        return (h + s) * 2;
+    }
+    default: {
+        const int32_t t = op_mod(opl, OP_TOM, 0);
+        const int32_t c = op_at(opl, OP_CY, (rm_xor << 9) | 0x80);
+        return (t + c) * 2;
+    }
+    }
+}
+
+void synth_opl_render(SynthOPL* opl, float* left, float* right, int frames)
+{
+    if (!opl || !left || !right) return;
+
+    int active[NUM_CH];
+
+    int pos = 0;
+    while (pos < frames) {
+        if (opl->lfo_countdown <= 0) {
+            update_lfo(opl);
+            opl->lfo_countdown = LFO_CONTROL_BLOCK;
+        }
+
+        int span = frames - pos;
+        if (span > opl->lfo_countdown) span = opl->lfo_countdown;
+        opl->lfo_countdown -= span;
+
+        // Channels that can produce sound in this span
+        int num_active = 0;
+        for (int ch = 0; ch < NUM_CH; ch++) {
+            if (opl->type[ch] == CH_4OP_SLAVE) continue;
+            if (channel_silent(opl, ch)) continue;
+            active[num_active++] = ch;
+        }
+
+        if (num_active == 0) {
+            memset(left + pos, 0, span * sizeof(float));
+            memset(right + pos, 0, span * sizeof(float));
+            pos += span;
+            continue;
+        }
+
+        const bool rhythm = (opl->rhythm & 0x20) != 0;
+
+        for (int n = 0; n < span; n++) {
+            update_envelopes(opl);
+
+            int32_t mix_l = 0;
+            int32_t mix_r = 0;
+
+            for (int i = 0; i < num_active; i++) {
+                const int ch = active[i];
+                const int op1 = ch_op1(ch);
+                const int op2 = op1 + 3;
+                int32_t sample;
+
+                switch (opl->type[ch]) {
+                case CH_RHYTHM:
+                    sample = render_rhythm(opl, ch);
+                    break;
+
+                case CH_4OP_MASTER: {
+                    const int op3 = ch_op1(ch + 3);
+                    const int op4 = op3 + 3;
+                    const int alg = opl->connection[ch] | (opl->connection[ch + 3] << 1);
+                    const int32_t o1 = op_feedback(opl, op1, opl->feedback[ch]);
+                    switch (alg) {
+                    case 0: { // 1 -> 2 -> 3 -> 4
+                        const int32_t o2 = op_mod(opl, op2, o1);
+                        const int32_t o3 = op_mod(opl, op3, o2);
+                        sample = op_mod(opl, op4, o3);
+                        break;
+                    }
+                    case 1: { // 1 + (2 -> 3 -> 4)
+                        const int32_t o2 = op_mod(opl, op2, 0);
+                        const int32_t o3 = op_mod(opl, op3, o2);
+                        sample = o1 + op_mod(opl, op4, o3);
+                        break;
+                    }
+                    case 2: { // (1 -> 2) + (3 -> 4)
+                        const int32_t o2 = op_mod(opl, op2, o1);
+                        const int32_t o3 = op_mod(opl, op3, 0);
+                        sample = o2 + op_mod(opl, op4, o3);
+                        break;
+                    }
+                    default: { // 1 + (2 -> 3) + 4
+                        const int32_t o2 = op_mod(opl, op2, 0);
+                        sample = o1 + op_mod(opl, op3, o2) + op_mod(opl, op4, 0);
+                        break;
+                    }
+                    }
+                    break;
+                }
+
+                default: {
+                    const int32_t o1 = op_feedback(opl, op1, opl->feedback[ch]);
+                    sample = opl->connection[ch] ? o1 + op_mod(opl, op2, 0) : op_mod(opl, op2, o1);
+                    break;
+                }
+                }
+
+                if (!opl->newm || opl->pan_left[ch]) mix_l += sample;
+                if (!opl->newm || opl->pan_right[ch]) mix_r += sample;
+            }
+
+            left[pos + n] = mix_l * (1.0f / 32768.0f);
+            right[pos + n] = mix_r * (1.0f / 32768.0f);
+
+            // Advance all phases (contiguous, vectorizes)
+            for (int op = 0; op < NUM_OPS; op++) {
+                opl->phase[op] += opl->phase_inc_vib[op];
+            }
+
+            if (rhythm) {
+                const uint32_t bit = ((opl->noise >> 14) ^ opl->noise) & 1;
+                opl->noise = (opl->noise >> 1) | (bit << 22);
+            }
+        }
+
+        pos += span;
+    }
+}
+
+int synth_opl_get_active_channels(const SynthOPL* opl)
+{
+    if (!opl) return 0;
+
+    int count = 0;
+    for (int ch = 0; ch < NUM_CH; ch++) {
+        if (opl->type[ch] == CH_4OP_SLAVE) continue;
+        if (!channel_silent(opl, ch)) count++;
+    }
+    return count;
+}
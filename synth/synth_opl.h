@@ -0,0 +1,86 @@
+/*
+ * Regroove OPL2/OPL3 FM Engine
+ * Register-level Yamaha YM3812 (OPL2) / YMF262 (OPL3) voice engine
+ *
+ * - 18 channels / 36 operators (9 / 18 in OPL2 mode), 2-op and 4-op algorithms
+ * - Rhythm mode (bass drum, snare, tom, cymbal, hi-hat)
+ * - Log-sin / exp ROM lookups like the real chip, no float trig per sample
+ * - All operator state in contiguous SoA arrays, rendered in blocks
+ *
+ * The chip runs at the output sample rate; phase increments and envelope
+ * rates are scaled from the native 49716 Hz rate.
+ */
+
+#ifndef SYNTH_OPL_H
+#define SYNTH_OPL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SYNTH_OPL_CHANNELS 18
+#define SYNTH_OPL_OPERATORS 36
+#define SYNTH_OPL_NATIVE_RATE 49716
+
+typedef struct SynthOPL SynthOPL;
+
+/**
+ * Create an OPL engine (starts in OPL2-compatible mode)
+ */
+SynthOPL* synth_opl_create(int sample_rate);
+
+/**
+ * Destroy an OPL engine
+ */
+void synth_opl_destroy(SynthOPL* opl);
+
+/**
+ * Reset all registers and voices
+ */
+void synth_opl_reset(SynthOPL* opl);
+
+/**
+ * Change the output sample rate (keeps register state)
+ */
+void synth_opl_set_sample_rate(SynthOPL* opl, int sample_rate);
+
+/**
+ * Write a chip register
+ * @param reg Register address: 0x000-0x0FF (bank 0), 0x100-0x1FF (OPL3 bank 1)
+ * @param value Register value
+ */
+void synth_opl_write(SynthOPL* opl, uint16_t reg, uint8_t value);
+
+/**
+ * Read back the last value written to a register
+ */
+uint8_t synth_opl_read_reg(const SynthOPL* opl, uint16_t reg);
+
+/**
+ * Render a block of audio (overwrites the buffers)
+ * OPL2 mode outputs the same signal on both channels; OPL3 mode honours
+ * the per-channel left/right enables in 0xC0-0xC8.
+ */
+void synth_opl_render(SynthOPL* opl, float* left, float* right, int frames);
+
+/**
+ * Number of channels currently producing sound
+ */
+int synth_opl_get_active_channels(const SynthOPL* opl);
+
+/**
+ * Single chip waveform sample from the log-sin/exp ROMs
+ * @param waveform OPL waveform 0-7
+ * @param phase Phase in turns (0.0 - 1.0)
+ * @return Sample in -1.0 .. +1.0
+ */
+float synth_opl_waveform_sample(int waveform, float phase);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SYNTH_OPL_H
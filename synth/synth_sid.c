@@ -5,6 +5,8 @@
 
 #include "synth_sid.h"
 #include "synth_lfo.h"
+#include "synth_mod_matrix.h"
+#include "../effects/fx_resampler.h"
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
@@ -15,6 +17,11 @@
 
 #define SID_VOICES 3
 
+// Chip-clock mode: oscillator ticks buffered ahead of the decimation filter
+#define SID_TICK_BUFFER 1024
+#define SID_SINC_PHASES (1 << FX_RESAMPLER_SINC_PHASES_BITS)
+#define SID_SINC_HISTORY 3      // Taps before the read position (-3..+4)
+
 // ADSR envelope rates (exponential curves like real SID)
 static const float ATTACK_RATES[16] = {
     0.002f, 0.008f, 0.016f, 0.024f, 0.038f, 0.056f, 0.068f, 0.080f,
@@ -58,6 +65,7 @@ typedef struct {
 
     // LFSR for noise (25-bit like real SID)
     uint32_t noise_lfsr;
+    float noise_out;       // Noise level held between LFSR clocks (chip-clock mode)
 
     // Current note
     uint8_t note;
@@ -90,6 +98,21 @@ struct SynthSID {
     float lfo2_to_filter_depth;      // 0.0-1.0
     float lfo2_to_pw_depth;          // 0.0-1.0
     float mod_wheel_amount;          // CC 1 modulation wheel
+
+    // Control-rate modulation (evaluated every SYNTH_MOD_CONTROL_BLOCK samples,
+    // persists across calls so per-sample callers get the same rate) and
+    // ramped per sample toward the next control point
+    int mod_countdown;
+    SynthModVoice voice_mod[SID_VOICES];  // PITCH (bend + vibrato), PULSE_WIDTH
+    SynthModVoice filter_mod;             // CUTOFF (the filter is shared)
+
+    // Chip-clock rendering (see synth_sid_set_chip_clock)
+    int chip_clock;                  // 0 = render at the output rate
+    const float* sinc_table;         // Decimation filter for sinc_rate
+    int sinc_rate;                   // Output rate the table was chosen for
+    float ticks[SID_TICK_BUFFER];    // Oscillator ticks awaiting decimation
+    int tick_count;                  // Valid entries in ticks[]
+    double tick_pos;                 // Position of the next output sample in ticks[]
 };
 
 // ============================================================================
@@ -185,15 +208,11 @@ static void update_envelope(SIDVoice* voice, float delta_time) {
     }
 }
 
-// Simple biquad filter processing
-static float process_filter(SIDFilter* filter, float input) {
-    if (filter->filter_mode == SID_FILTER_OFF) {
-        return input;
-    }
-
+// Biquad coefficients {b0, b1, b2, a1, a2} for the current cutoff at a rate
+// Returns 0 when the filter is off.
+static int compute_filter_coeffs(const SIDFilter* filter, float sample_rate, float coeffs[5]) {
     // Convert normalized cutoff (0-1) to frequency (30Hz - 12kHz like real SID)
     float cutoff_freq = 30.0f + filter->filter_cutoff * 11970.0f;
-    float sample_rate = 44100.0f; // Assume standard rate
     float omega = 2.0f * M_PI * cutoff_freq / sample_rate;
     float cos_omega = cosf(omega);
     float sin_omega = sinf(omega);
@@ -237,20 +256,29 @@ static float process_filter(SIDFilter* filter, float input) {
             break;
 
         default:
-            return input;
+            return 0;
     }
 
     // Normalize coefficients
-    b0 /= a0;
-    b1 /= a0;
-    b2 /= a0;
-    a1 /= a0;
-    a2 /= a0;
+    coeffs[0] = b0 / a0;
+    coeffs[1] = b1 / a0;
+    coeffs[2] = b2 / a0;
+    coeffs[3] = a1 / a0;
+    coeffs[4] = a2 / a0;
+    return 1;
+}
+
+// Simple biquad filter processing
+static float process_filter(SIDFilter* filter, float input) {
+    float c[5];
+    if (!compute_filter_coeffs(filter, 44100.0f, c)) { // Assume standard rate
+        return input;
+    }
 
     // Apply biquad filter (Direct Form II Transposed)
     // y[n] = b0*x[n] + b1*x[n-1] + b2*x[n-2] - a1*y[n-1] - a2*y[n-2]
-    float output = b0 * input + b1 * filter->x1 + b2 * filter->x2
-                   - a1 * filter->y1 - a2 * filter->y2;
+    float output = c[0] * input + c[1] * filter->x1 + c[2] * filter->x2
+                   - c[3] * filter->y1 - c[4] * filter->y2;
 
     // Update state (input and output history)
     filter->x2 = filter->x1;
@@ -261,6 +289,23 @@ static float process_filter(SIDFilter* filter, float input) {
     return output;
 }
 
+// Empty the tick buffer, leaving the silent history the first output needs
+static void reset_decimator(SynthSID* sid) {
+    memset(sid->ticks, 0, SID_SINC_HISTORY * sizeof(float));
+    sid->tick_count = SID_SINC_HISTORY;
+    sid->tick_pos = SID_SINC_HISTORY;
+}
+
+// Unprimed lanes: the next control point snaps instead of ramping
+static void reset_modulation(SynthSID* sid) {
+    memset(sid->voice_mod, 0, sizeof(sid->voice_mod));
+    memset(&sid->filter_mod, 0, sizeof(sid->filter_mod));
+    for (int i = 0; i < SID_VOICES; i++) {
+        sid->voice_mod[i].pitch_ratio = 1.0f;
+    }
+    sid->mod_countdown = 0;
+}
+
 // ============================================================================
 // Lifecycle
 // ============================================================================
@@ -272,6 +317,7 @@ SynthSID* synth_sid_create(int sample_rate) {
     memset(sid, 0, sizeof(SynthSID));
     sid->sample_rate = sample_rate;
     sid->volume = 0.7f;
+    reset_decimator(sid);
 
     // Initialize voices
     for (int i = 0; i < SID_VOICES; i++) {
@@ -286,6 +332,7 @@ SynthSID* synth_sid_create(int sample_rate) {
         sid->voices[i].pitch_bend = 0.0f; // No bend initially
         sid->voices[i].test = 0; // TEST bit off
     }
+    reset_modulation(sid);
 
     // Initialize filter
     sid->filter.filter_mode = SID_FILTER_LP;
@@ -341,6 +388,8 @@ void synth_sid_reset(SynthSID* sid) {
 
     if (sid->lfo1) synth_lfo_reset(sid->lfo1);
     if (sid->lfo2) synth_lfo_reset(sid->lfo2);
+    reset_modulation(sid);
+    reset_decimator(sid);
 }
 
 // ============================================================================
@@ -379,20 +428,297 @@ void synth_sid_all_notes_off(SynthSID* sid) {
 // Audio Processing
 // ============================================================================
 
+// LFOs, bend and vibrato at the next control point; the lanes ramp there
+// over the following SYNTH_MOD_CONTROL_BLOCK samples (see mod_tick)
+static void update_modulation(SynthSID* sid, int sample_rate) {
+    float lfo1_value = sid->lfo1 ? synth_lfo_process_block(sid->lfo1, SYNTH_MOD_CONTROL_BLOCK, sample_rate) : 0.0f;
+    float lfo2_value = sid->lfo2 ? synth_lfo_process_block(sid->lfo2, SYNTH_MOD_CONTROL_BLOCK, sample_rate) : 0.0f;
+
+    float target[SYNTH_MOD_DST_COUNT] = {0};
+
+    // LFO pitch in semitones (scaled by depth and mod wheel)
+    float pitch_mod = sid->lfo1_to_pitch_depth * sid->mod_wheel_amount * lfo1_value;
+    target[SYNTH_MOD_DST_PULSE_WIDTH] = sid->lfo2_to_pw_depth * lfo2_value * 0.3f;
+
+    // Pitch bend: -1.0 to +1.0 maps to ±12 semitones (1 octave)
+    for (int v = 0; v < SID_VOICES; v++) {
+        target[SYNTH_MOD_DST_PITCH] = sid->voices[v].pitch_bend * 12.0f + pitch_mod;
+        synth_mod_voice_ramp_to(&sid->voice_mod[v], target, SYNTH_MOD_CONTROL_BLOCK);
+    }
+
+    float filter_target[SYNTH_MOD_DST_COUNT] = {0};
+    filter_target[SYNTH_MOD_DST_CUTOFF] = sid->lfo2_to_filter_depth * lfo2_value * 0.3f;
+    synth_mod_voice_ramp_to(&sid->filter_mod, filter_target, SYNTH_MOD_CONTROL_BLOCK);
+}
+
+// Advance the modulation ramps by 'samples' output samples
+static void mod_tick(SynthSID* sid, int samples) {
+    for (int i = 0; i < samples; i++) {
+        for (int v = 0; v < SID_VOICES; v++) {
+            synth_mod_voice_tick(&sid->voice_mod[v]);
+        }
+        synth_mod_voice_tick(&sid->filter_mod);
+    }
+}
+
+// Render oscillator ticks at chip_clock / SYNTH_SID_CLOCK_DIVIDER
+//
+// Per-voice state is unpacked into lane arrays first, so the tick loop is
+// the same straight-line arithmetic for all three voices (waveform selection
+// is a weight, not a branch) and stays in registers. Envelopes, pitch,
+// pulse width and filter coefficients are evaluated at both ends of the
+// call ('span' output samples of modulation) and ramped across the ticks.
+//
+// The voices are not packed into SSE/NEON lanes: hard sync and ring
+// modulation read the neighbouring voice within the same tick, noise only
+// shifts on the ticks where bit 19 rises, and each tick ends in a
+// horizontal sum feeding the serial biquad. That leaves one lane of four
+// idle and a shuffle per tick for about a third of the loop, which already
+// runs three instances at ~60x real time.
+static void render_ticks(SynthSID* sid, float* out, int count, float tick_rate, int span) {
+    uint32_t phase[SID_VOICES], inc[SID_VOICES], pw[SID_VOICES], ring[SID_VOICES];
+    int32_t inc_step[SID_VOICES], pw_step[SID_VOICES];
+    uint32_t lfsr[SID_VOICES];
+    int sync[SID_VOICES];
+    float w_tri[SID_VOICES], w_saw[SID_VOICES], w_pulse[SID_VOICES], w_noise[SID_VOICES];
+    float noise[SID_VOICES], env[SID_VOICES], env_step[SID_VOICES];
+    float to_filter[SID_VOICES], to_mix[SID_VOICES];
+
+    // voice->frequency is a per-output-sample increment
+    const float freq_scale = (float)sid->sample_rate / tick_rate;
+    const float inv_count = 1.0f / count;
+
+    for (int v = 0; v < SID_VOICES; v++) {
+        SIDVoice* voice = &sid->voices[v];
+
+        // TEST bit: oscillator held at zero, voice silent
+        if (voice->test) {
+            voice->phase = 0;
+            voice->noise_lfsr = 0x1FFFFFF;
+        }
+
+        phase[v] = voice->phase;
+        lfsr[v] = voice->noise_lfsr;
+        noise[v] = voice->noise_out;
+        ring[v] = voice->ring_mod ? 0x800000 : 0;
+        sync[v] = voice->sync;
+        to_filter[v] = sid->filter.filter_voice[v] ? 1.0f : 0.0f;
+        to_mix[v] = 1.0f - to_filter[v];
+
+        if (voice->test) {
+            inc[v] = 0;
+            pw[v] = 0;
+            inc_step[v] = pw_step[v] = 0;
+            w_tri[v] = w_saw[v] = w_pulse[v] = w_noise[v] = 0.0f;
+            env[v] = env_step[v] = 0.0f;
+            continue;
+        }
+
+        float env_start = voice->env_level;
+        update_envelope(voice, count / tick_rate);
+        env[v] = env_start;
+        env_step[v] = (voice->env_level - env_start) * inv_count;
+
+        const SynthModVoice* mod = &sid->voice_mod[v];
+        float ratio_end = mod->pitch_ratio + mod->pitch_ratio_step * span;
+        inc[v] = (uint32_t)(voice->frequency * mod->pitch_ratio * freq_scale);
+        inc_step[v] = (int32_t)(((int64_t)(uint32_t)(voice->frequency * ratio_end * freq_scale)
+                                 - (int64_t)inc[v]) / count);
+
+        float pw_mod = mod->value[SYNTH_MOD_DST_PULSE_WIDTH];
+        float pw_mod_end = pw_mod + mod->step[SYNTH_MOD_DST_PULSE_WIDTH] * span;
+        float modulated_pw = fminf(fmaxf(voice->pulse_width + pw_mod, 0.005f), 0.995f);
+        float modulated_pw_end = fminf(fmaxf(voice->pulse_width + pw_mod_end, 0.005f), 0.995f);
+        pw[v] = (uint32_t)(modulated_pw * 0x1000000);
+        pw_step[v] = (int32_t)((modulated_pw_end - modulated_pw) * 0x1000000 * inv_count);
+
+        // Combined waveforms are averaged, velocity folded into the weights
+        int waveform_count = 0;
+        for (int w = 0; w < 4; w++) {
+            if (voice->waveform & (1 << w)) waveform_count++;
+        }
+        float weight = waveform_count ? (voice->velocity / 127.0f) / waveform_count : 0.0f;
+        w_tri[v] = (voice->waveform & SID_WAVE_TRIANGLE) ? weight : 0.0f;
+        w_saw[v] = (voice->waveform & SID_WAVE_SAWTOOTH) ? weight : 0.0f;
+        w_pulse[v] = (voice->waveform & SID_WAVE_PULSE) ? weight : 0.0f;
+        w_noise[v] = (voice->waveform & SID_WAVE_NOISE) ? weight : 0.0f;
+    }
+
+    // Filter coefficients at the tick rate (with LFO cutoff) at both ends of
+    // the call, interpolated per tick
+    const float cutoff_mod = sid->filter_mod.value[SYNTH_MOD_DST_CUTOFF];
+    const float cutoff_mod_end = cutoff_mod + sid->filter_mod.step[SYNTH_MOD_DST_CUTOFF] * span;
+    SIDFilter modulated = sid->filter;
+    float c[5], c_end[5], c_step[5];
+    modulated.filter_cutoff = fminf(fmaxf(sid->filter.filter_cutoff + cutoff_mod, 0.0f), 1.0f);
+    int filter_on = compute_filter_coeffs(&modulated, tick_rate, c);
+    modulated.filter_cutoff = fminf(fmaxf(sid->filter.filter_cutoff + cutoff_mod_end, 0.0f), 1.0f);
+    compute_filter_coeffs(&modulated, tick_rate, c_end);
+    if (filter_on) {
+        for (int k = 0; k < 5; k++) {
+            c_step[k] = (c_end[k] - c[k]) * inv_count;
+        }
+    }
+    float x1 = sid->filter.x1, x2 = sid->filter.x2;
+    float y1 = sid->filter.y1, y2 = sid->filter.y2;
+
+    for (int t = 0; t < count; t++) {
+        uint32_t prev[SID_VOICES];
+
+        for (int v = 0; v < SID_VOICES; v++) {
+            prev[v] = phase[v];
+            phase[v] = (phase[v] + inc[v]) & 0xFFFFFF;
+        }
+
+        // Hard sync (voice 0->1, 1->2, 2->0) on accumulator overflow
+        for (int v = 0; v < SID_VOICES; v++) {
+            if (sync[v] && phase[v] < prev[v]) {
+                phase[(v + 1) % SID_VOICES] = 0;
+            }
+        }
+
+        // Noise LFSR shifts on each rising edge of accumulator bit 19
+        for (int v = 0; v < SID_VOICES; v++) {
+            if (w_noise[v] != 0.0f &&
+                ((prev[v] + inc[v] + 0x80000) >> 20) != ((prev[v] + 0x80000) >> 20)) {
+                uint32_t bit0 = ((lfsr[v] >> 22) ^ (lfsr[v] >> 17)) & 1;
+                lfsr[v] = ((lfsr[v] << 1) | bit0) & 0x1FFFFFF;
+                noise[v] = ((lfsr[v] >> 17) / 128.0f) - 1.0f;
+            }
+        }
+
+        float filtered = 0.0f;
+        float unfiltered = 0.0f;
+        for (int v = 0; v < SID_VOICES; v++) {
+            // Ring modulation: previous voice's MSB flips this one
+            uint32_t p = phase[v] ^ (phase[(v + 2) % SID_VOICES] & ring[v]);
+            uint32_t tri = (p ^ (0u - (p >> 23))) & 0x7FFFFF;
+
+            float s = ((float)tri * (2.0f / 0x800000) - 1.0f) * w_tri[v]
+                    + ((float)p * (2.0f / 0x1000000) - 1.0f) * w_saw[v]
+                    + (p < pw[v] ? w_pulse[v] : -w_pulse[v])
+                    + noise[v] * w_noise[v];
+            s *= env[v];
+            env[v] += env_step[v];
+            inc[v] += (uint32_t)inc_step[v];
+            pw[v] += (uint32_t)pw_step[v];
+
+            filtered += s * to_filter[v];
+            unfiltered += s * to_mix[v];
+        }
+
+        if (filter_on) {
+            float y = c[0] * filtered + c[1] * x1 + c[2] * x2 - c[3] * y1 - c[4] * y2;
+            x2 = x1;
+            x1 = filtered;
+            y2 = y1;
+            y1 = y;
+            filtered = y;
+            for (int k = 0; k < 5; k++) {
+                c[k] += c_step[k];
+            }
+        }
+
+        out[t] = filtered + unfiltered;
+    }
+
+    for (int v = 0; v < SID_VOICES; v++) {
+        sid->voices[v].phase = phase[v];
+        sid->voices[v].noise_lfsr = lfsr[v];
+        sid->voices[v].noise_out = noise[v];
+    }
+    sid->filter.x1 = x1;
+    sid->filter.x2 = x2;
+    sid->filter.y1 = y1;
+    sid->filter.y2 = y2;
+}
+
+// Chip-clock path: render ticks, decimate with the 8-tap polyphase sinc
+static void process_chip_clock(SynthSID* sid, float* buffer, int frames, int sample_rate) {
+    const float tick_rate = (float)sid->chip_clock / SYNTH_SID_CLOCK_DIVIDER;
+    const double step = (double)tick_rate / sample_rate;  // Ticks per output sample
+    const float gain = 0.33f * sid->volume;
+
+    // Leave room for the lookahead and history taps
+    int max_chunk = (int)((SID_TICK_BUFFER - 4 * FX_RESAMPLER_SINC_WIDTH) / step);
+    if (max_chunk < 1) max_chunk = 1;
+
+    if (sid->sinc_rate != sample_rate) {
+        sid->sinc_table = fx_resampler_get_sinc_table((float)step);
+        sid->sinc_rate = sample_rate;
+    }
+
+    int frame = 0;
+    while (frame < frames) {
+        // LFOs, bend and vibrato run at control rate
+        if (sid->mod_countdown <= 0) {
+            update_modulation(sid, sample_rate);
+            sid->mod_countdown = SYNTH_MOD_CONTROL_BLOCK;
+        }
+
+        int n = frames - frame;
+        if (n > sid->mod_countdown) n = sid->mod_countdown;
+        if (n > max_chunk) n = max_chunk;
+        sid->mod_countdown -= n;
+
+        // Render up to the lookahead taps of the sample after this chunk
+        int needed = (int)(sid->tick_pos + n * step) + FX_RESAMPLER_SINC_WIDTH - SID_SINC_HISTORY
+                     - sid->tick_count;
+        if (needed > 0) {
+            render_ticks(sid, sid->ticks + sid->tick_count, needed, tick_rate, n);
+            sid->tick_count += needed;
+        }
+        mod_tick(sid, n);
+
+        for (int i = 0; i < n; i++, frame++) {
+            int idx = (int)sid->tick_pos;
+            float fract = (float)(sid->tick_pos - idx);
+            uint32_t phase = (uint32_t)(fract * (float)SID_SINC_PHASES) & (SID_SINC_PHASES - 1);
+            const float* lut = &sid->sinc_table[phase * FX_RESAMPLER_SINC_WIDTH];
+            const float* in = &sid->ticks[idx - SID_SINC_HISTORY];
+
+            float sum = 0.0f;
+            for (int k = 0; k < FX_RESAMPLER_SINC_WIDTH; k++) {
+                sum += lut[k] * in[k];
+            }
+
+            float mix = sum * gain;
+            if (mix > 1.0f) mix = 1.0f;
+            if (mix < -1.0f) mix = -1.0f;
+
+            buffer[frame * 2] = mix;
+            buffer[frame * 2 + 1] = mix;
+            sid->tick_pos += step;
+        }
+
+        // Drop ticks no longer under the filter
+        int consumed = (int)sid->tick_pos - SID_SINC_HISTORY;
+        if (consumed > 0) {
+            memmove(sid->ticks, sid->ticks + consumed, (sid->tick_count - consumed) * sizeof(float));
+            sid->tick_count -= consumed;
+            sid->tick_pos -= consumed;
+        }
+    }
+}
+
 void synth_sid_process_f32(SynthSID* sid, float* buffer, int frames, int sample_rate) {
     if (!sid || !buffer) return;
 
+    if (sid->chip_clock > 0) {
+        process_chip_clock(sid, buffer, frames, sample_rate);
+        return;
+    }
+
     float delta_time = 1.0f / sample_rate;
 
     for (int frame = 0; frame < frames; frame++) {
-        // Process LFOs once per sample
-        float lfo1_value = sid->lfo1 ? synth_lfo_process(sid->lfo1, sample_rate) : 0.0f;
-        float lfo2_value = sid->lfo2 ? synth_lfo_process(sid->lfo2, sample_rate) : 0.0f;
+        // LFOs, bend and vibrato run at control rate
+        if (--sid->mod_countdown < 0) {
+            sid->mod_countdown = SYNTH_MOD_CONTROL_BLOCK - 1;
+            update_modulation(sid, sample_rate);
+        }
 
-        // Calculate modulation amounts
-        float pitch_mod = sid->lfo1_to_pitch_depth * sid->mod_wheel_amount * lfo1_value;
-        float filter_mod = sid->lfo2_to_filter_depth * lfo2_value * 0.3f;
-        float pw_mod = sid->lfo2_to_pw_depth * lfo2_value * 0.3f;
+        const float filter_mod = sid->filter_mod.value[SYNTH_MOD_DST_CUTOFF];
 
         // Apply filter modulation (global)
         float modulated_cutoff = sid->filter.filter_cutoff + filter_mod;
@@ -422,10 +748,7 @@ void synth_sid_process_f32(SynthSID* sid, float* buffer, int frames, int sample_
             }
 
             // Advance phase with pitch bend + LFO pitch modulation applied
-            // Pitch bend: -1.0 to +1.0 maps to ±12 semitones (1 octave)
-            // LFO pitch: pitch_mod in semitones (scaled by depth and mod wheel)
-            float pitch_multiplier = powf(2.0f, voice->pitch_bend) * powf(2.0f, pitch_mod / 12.0f);
-            uint32_t bent_frequency = (uint32_t)(voice->frequency * pitch_multiplier);
+            uint32_t bent_frequency = (uint32_t)(voice->frequency * sid->voice_mod[v].pitch_ratio);
             voice->phase += bent_frequency;
             voice->phase &= 0xFFFFFF; // 24-bit wraparound
 
@@ -459,7 +782,7 @@ void synth_sid_process_f32(SynthSID* sid, float* buffer, int frames, int sample_
             }
             if (voice->waveform & SID_WAVE_PULSE) {
                 // Apply LFO pulse width modulation
-                float modulated_pw = voice->pulse_width + pw_mod;
+                float modulated_pw = voice->pulse_width + sid->voice_mod[v].value[SYNTH_MOD_DST_PULSE_WIDTH];
                 modulated_pw = fminf(fmaxf(modulated_pw, 0.005f), 0.995f);
                 sample += generate_pulse(phase_to_use, modulated_pw);
             }
@@ -508,9 +831,21 @@ void synth_sid_process_f32(SynthSID* sid, float* buffer, int frames, int sample_
 
         // Restore original cutoff (modulation is per-sample)
         sid->filter.filter_cutoff = original_cutoff;
+        mod_tick(sid, 1);
     }
 }
 
+void synth_sid_set_chip_clock(SynthSID* sid, int clock_hz) {
+    if (!sid) return;
+    sid->chip_clock = clock_hz > 0 ? clock_hz : 0;
+    sid->sinc_rate = 0;
+    reset_decimator(sid);
+}
+
+int synth_sid_get_chip_clock(SynthSID* sid) {
+    return sid ? sid->chip_clock : 0;
+}
+
 // ============================================================================
 // Parameter Setters/Getters
 // ============================================================================
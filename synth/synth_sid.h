@@ -34,6 +34,13 @@ typedef enum {
     SID_WAVE_NOISE = 8
 } SIDWaveform;
 
+// Chip clocks for synth_sid_set_chip_clock()
+#define SYNTH_SID_CLOCK_PAL   985248
+#define SYNTH_SID_CLOCK_NTSC  1022727
+
+// Oscillators are clocked once per this many chip cycles in chip-clock mode
+#define SYNTH_SID_CLOCK_DIVIDER 8
+
 // Filter modes
 typedef enum {
     SID_FILTER_OFF = 0,
@@ -98,6 +105,20 @@ void synth_sid_all_notes_off(SynthSID* sid);
  */
 void synth_sid_process_f32(SynthSID* sid, float* buffer, int frames, int sample_rate);
 
+/**
+ * Render at a fraction of the chip clock instead of the output rate
+ *
+ * Oscillators, noise and filter run at clock_hz / SYNTH_SID_CLOCK_DIVIDER
+ * (about 123 kHz for PAL) and are decimated to the output rate with the
+ * 8-tap polyphase sinc from fx_resampler. Pulse edges, hard sync and noise
+ * then alias far less than when every output sample is a point sample.
+ * Noise is clocked by oscillator bit 19 as on the chip.
+ * @param clock_hz Chip clock (SYNTH_SID_CLOCK_PAL/NTSC), 0 = render at the
+ *                 output rate (default)
+ */
+void synth_sid_set_chip_clock(SynthSID* sid, int clock_hz);
+int synth_sid_get_chip_clock(SynthSID* sid);
+
 // ============================================================================
 // Hardware Register Interface (for sid_player integration and testing)
 // ============================================================================
@@ -7,6 +7,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "../synth/ahx_instrument.h"
+#include "../synth/ahx_waves.h"
 
 #define SAMPLE_RATE 48000
 #define BUFFER_SIZE 1024
@@ -15,6 +16,9 @@ int main(void) {
     printf("AHX Instrument Test\n");
     printf("===================\n\n");
 
+    // Voices only read the wave tables; hold them for the whole test
+    const AhxWaves* waves = ahx_waves_acquire();
+
     // Create instrument
     AhxInstrument inst;
     ahx_instrument_init(&inst);
@@ -131,5 +135,6 @@ int main(void) {
 
     printf("All tests completed successfully!\n");
 
+    ahx_waves_release(waves);
     return 0;
 }
@@ -30,6 +30,7 @@ else
         ../../synth/ahx_plist.c \
         ../../synth/ahx_synth_core.c \
         ../../players/tracker_voice.c \
+        ../../effects/fx_resampler.c \
         ../../players/tracker_modulator.c \
         -I../.. \
         -I../../synth \
@@ -76,7 +76,7 @@ int dump_all_waveforms(const char* output_dir) {
     char filepath[512];
 
     // Get waves instance
-    AhxWaves* waves = ahx_waves_get();
+    const AhxWaves* waves = ahx_waves_get();
     if (!waves) {
         printf("Error: Failed to initialize waves\n");
         return 0;
@@ -332,12 +332,7 @@ void print_usage(const char* prog) {
     printf("  %s --render chopper_03.ahxp 60 test.wav --sustain\n", prog);
 }
 
-int main(int argc, char** argv) {
-    if (argc < 2) {
-        print_usage(argv[0]);
-        return 1;
-    }
-
+static int run_command(int argc, char** argv) {
     if (strcmp(argv[1], "--dump-waves") == 0) {
         if (argc < 3) {
             printf("Error: Missing output directory\n");
@@ -367,3 +362,16 @@ int main(int argc, char** argv) {
         return 1;
     }
 }
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    // Held for the whole run: the dump and the instrument voices only read them
+    const AhxWaves* waves = ahx_waves_acquire();
+    int result = run_command(argc, argv);
+    ahx_waves_release(waves);
+    return result;
+}
@@ -0,0 +1,290 @@
+/*
+ * AHX Player Output Hash Test
+ *
+ * Usage: ./ahx_hash_test [-u]
+ *
+ * Builds a small AHX song in memory (saw bass with filter modulation, square
+ * lead with PWM, vibrato and a PList arpeggio, noise drum, all four voices
+ * playing), renders it in each output mode and compares a hash of the
+ * output with the value recorded when the mode was known to be right.
+ * Any change to the mixer, the voice renderer or the Paula model that is
+ * meant to keep the output shows up here as a mismatch.
+ *
+ * Options:
+ *   -u            Print the hashes of the current build instead of checking
+ *                 (to record them after an intended output change)
+ *
+ * Returns 0 if every mode matches.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include "../../players/ahx_player.h"
+
+#define SAMPLE_RATE 48000
+#define RENDER_FRAMES 200000   // Both positions and a bit of the restart
+#define BLOCK_SIZE 1000        // Not a multiple of the 960-sample frame
+
+// Song layout
+#define TRACK_LENGTH 16
+#define NUM_TRACKS 4           // Track 0 is left empty
+#define NUM_POSITIONS 2
+#define NUM_INSTRUMENTS 3
+
+typedef struct {
+    const char* name;
+    PaulaMode paula_mode;      // Used when paula is set
+    bool paula;
+    bool oversampling;
+    uint64_t expected;
+} TestMode;
+
+static const TestMode test_modes[] = {
+    { "fast",            PAULA_A500_OFF,   false, false, 0xa6f1f27f2f6636c8ULL },
+    { "fast linear",     PAULA_A500_OFF,   false, true,  0xa0aeac8cde08e305ULL },
+    { "paula A500",      PAULA_A500_OFF,   true,  false, 0xe128e9dde8409a0aULL },
+    { "paula A1200 LED", PAULA_A1200_ON,   true,  false, 0xe1ff1e2ac534123fULL },
+};
+
+#define NUM_TEST_MODES (int)(sizeof(test_modes) / sizeof(test_modes[0]))
+
+// A step of a track: note (1-60, 0 = none), instrument, command and parameter
+typedef struct {
+    uint8_t note;
+    uint8_t instrument;
+    uint8_t fx;
+    uint8_t param;
+} TestStep;
+
+// A PList entry: waveform (1-4, 0 = keep), note, fixed, two commands
+typedef struct {
+    uint8_t waveform;
+    uint8_t note;
+    uint8_t fixed;
+    uint8_t fx[2];
+    uint8_t param[2];
+} TestPListEntry;
+
+static uint8_t* put_step(uint8_t* p, TestStep s) {
+    p[0] = (uint8_t)((s.note << 2) | ((s.instrument >> 4) & 0x3));
+    p[1] = (uint8_t)(((s.instrument & 0xf) << 4) | (s.fx & 0xf));
+    p[2] = s.param;
+    return p + 3;
+}
+
+static uint8_t* put_plist_entry(uint8_t* p, TestPListEntry e) {
+    p[0] = (uint8_t)(((e.fx[1] & 7) << 5) | ((e.fx[0] & 7) << 2) | ((e.waveform >> 1) & 3));
+    p[1] = (uint8_t)(((e.waveform & 1) << 7) | ((e.fixed & 1) << 6) | (e.note & 0x3f));
+    p[2] = e.param[0];
+    p[3] = e.param[1];
+    return p + 4;
+}
+
+// Instrument header (22 bytes, see load_song() in ahx_player.c)
+static uint8_t* put_instrument(uint8_t* p, uint8_t volume, uint8_t wave_length,
+                               const uint8_t envelope[7], uint8_t filter_speed,
+                               uint8_t filter_lower, uint8_t filter_upper,
+                               uint8_t vibrato_delay, uint8_t vibrato_depth, uint8_t vibrato_speed,
+                               uint8_t square_lower, uint8_t square_upper, uint8_t square_speed,
+                               uint8_t plist_speed, uint8_t plist_length) {
+    memset(p, 0, 22);
+    p[0] = volume;
+    p[1] = (uint8_t)(((filter_speed & 0x1f) << 3) | (wave_length & 7));
+    memcpy(&p[2], envelope, 7);
+    p[12] = (uint8_t)((filter_lower & 0x7f) | ((filter_speed & 0x20) << 2));
+    p[13] = vibrato_delay;
+    p[14] = (uint8_t)(vibrato_depth & 0xf);
+    p[15] = vibrato_speed;
+    p[16] = square_lower;
+    p[17] = square_upper;
+    p[18] = square_speed;
+    p[19] = (uint8_t)(filter_upper & 0x3f);
+    p[20] = plist_speed;
+    p[21] = plist_length;
+    return p + 22;
+}
+
+// Build the test song; returns its size
+static size_t build_song(uint8_t* song, size_t capacity) {
+    memset(song, 0, capacity);
+    uint8_t* p = song;
+
+    // Header: revision 1, speed multiplier 1, restart at position 0
+    p[0] = 'T'; p[1] = 'H'; p[2] = 'X'; p[3] = 1;
+    p[6] = 0;
+    p[7] = NUM_POSITIONS;
+    p[10] = TRACK_LENGTH;
+    p[11] = NUM_TRACKS - 1;
+    p[12] = NUM_INSTRUMENTS;
+    p[13] = 0;
+    p += 14;
+
+    // Positions: track and transpose per voice
+    static const int8_t positions[NUM_POSITIONS][4][2] = {
+        { {1, 0}, {2, 0}, {3, 0}, {0, 0} },
+        { {1, 5}, {2, 3}, {3, 0}, {2, -12} },
+    };
+    for (int i = 0; i < NUM_POSITIONS; i++) {
+        for (int v = 0; v < 4; v++) {
+            *p++ = (uint8_t)positions[i][v][0];
+            *p++ = (uint8_t)positions[i][v][1];
+        }
+    }
+
+    // Track 0: empty
+    for (int j = 0; j < TRACK_LENGTH; j++) {
+        p = put_step(p, (TestStep){0, 0, 0, 0});
+    }
+
+    // Track 1: bass on every beat, volume slide down on the last one
+    for (int j = 0; j < TRACK_LENGTH; j++) {
+        TestStep s = {0, 0, 0, 0};
+        if (j % 4 == 0) s = (TestStep){(uint8_t)(13 + (j / 4) * 2), 1, 0, 0};
+        if (j == 13) s = (TestStep){0, 0, 0xa, 0x04};
+        p = put_step(p, s);
+    }
+
+    // Track 2: lead with a tone portamento and a volume change
+    for (int j = 0; j < TRACK_LENGTH; j++) {
+        TestStep s = {0, 0, 0, 0};
+        if (j == 0) s = (TestStep){37, 2, 0, 0};
+        if (j == 6) s = (TestStep){40, 2, 0, 0};
+        if (j == 10) s = (TestStep){44, 0, 0x3, 0x20};
+        if (j == 14) s = (TestStep){0, 0, 0xc, 0x20};
+        p = put_step(p, s);
+    }
+
+    // Track 3: drum on the off-beats
+    for (int j = 0; j < TRACK_LENGTH; j++) {
+        TestStep s = {0, 0, 0, 0};
+        if (j % 4 == 2) s = (TestStep){25, 3, 0, 0};
+        p = put_step(p, s);
+    }
+
+    // Instrument 1: sawtooth bass, filter sweep
+    static const uint8_t bass_env[7] = {1, 64, 8, 40, 20, 10, 0};
+    p = put_instrument(p, 64, 3, bass_env, 12, 10, 40, 0, 0, 0, 0, 0, 0, 1, 2);
+    p = put_plist_entry(p, (TestPListEntry){2, 0, 0, {4, 0}, {0x10, 0}});
+    p = put_plist_entry(p, (TestPListEntry){0, 0, 0, {0, 0}, {0, 0}});
+
+    // Instrument 2: square lead with PWM, vibrato and a looping arpeggio
+    static const uint8_t lead_env[7] = {2, 64, 10, 48, 30, 20, 0};
+    p = put_instrument(p, 48, 2, lead_env, 0, 0, 0, 6, 3, 20, 32, 200, 4, 2, 4);
+    p = put_plist_entry(p, (TestPListEntry){3, 0, 0, {3, 4}, {0x40, 0x01}});
+    p = put_plist_entry(p, (TestPListEntry){0, 4, 0, {0, 0}, {0, 0}});
+    p = put_plist_entry(p, (TestPListEntry){0, 7, 0, {0, 0}, {0, 0}});
+    p = put_plist_entry(p, (TestPListEntry){0, 0, 0, {5, 0}, {1, 0}});
+
+    // Instrument 3: noise hit falling into a low triangle
+    static const uint8_t drum_env[7] = {0, 64, 4, 20, 2, 6, 0};
+    p = put_instrument(p, 64, 5, drum_env, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 3);
+    p = put_plist_entry(p, (TestPListEntry){4, 30, 1, {0, 0}, {0, 0}});
+    p = put_plist_entry(p, (TestPListEntry){1, 12, 1, {2, 0}, {0x08, 0}});
+    p = put_plist_entry(p, (TestPListEntry){0, 0, 0, {0, 0}, {0, 0}});
+
+    // Names: song, then one per instrument
+    size_t name_offset = (size_t)(p - song);
+    song[4] = (uint8_t)(name_offset >> 8);
+    song[5] = (uint8_t)(name_offset & 0xff);
+    static const char* names[] = {"hash test", "bass", "lead", "drum"};
+    for (int i = 0; i < 4; i++) {
+        size_t len = strlen(names[i]) + 1;
+        memcpy(p, names[i], len);
+        p += len;
+    }
+
+    return (size_t)(p - song);
+}
+
+// 64-bit FNV-1a over the output as 16-bit PCM, so the last float bits (which
+// may differ between compilers without changing what is heard) do not count
+static uint64_t hash_frames(uint64_t hash, const float* left, const float* right, size_t frames) {
+    for (size_t i = 0; i < frames; i++) {
+        int16_t s[2] = {
+            (int16_t)lrintf(left[i] * 32767.0f),
+            (int16_t)lrintf(right[i] * 32767.0f)
+        };
+        const uint8_t* b = (const uint8_t*)s;
+        for (size_t k = 0; k < sizeof(s); k++) {
+            hash ^= b[k];
+            hash *= 0x100000001b3ULL;
+        }
+    }
+    return hash;
+}
+
+// Render the song in one mode; with channel outputs requested when
+// with_channels is set (the mix must not change)
+static bool render_hash(const uint8_t* song, size_t size, const TestMode* mode,
+                        bool with_channels, uint64_t* hash) {
+    AhxPlayer* player = ahx_player_create();
+    if (!player) return false;
+
+    if (!ahx_player_load(player, song, size)) {
+        ahx_player_destroy(player);
+        return false;
+    }
+
+    ahx_player_set_oversampling(player, mode->oversampling);
+    if (mode->paula && !ahx_player_set_paula_output(player, true, mode->paula_mode)) {
+        ahx_player_destroy(player);
+        return false;
+    }
+    ahx_player_start(player);
+
+    static float left[BLOCK_SIZE], right[BLOCK_SIZE];
+    static float channels[4][BLOCK_SIZE];
+    float* channel_outputs[4] = {channels[0], channels[1], channels[2], channels[3]};
+
+    *hash = 0xcbf29ce484222325ULL;
+    for (size_t done = 0; done < RENDER_FRAMES; done += BLOCK_SIZE) {
+        ahx_player_process_channels(player, left, right, with_channels ? channel_outputs : NULL,
+                                    BLOCK_SIZE, SAMPLE_RATE);
+        *hash = hash_frames(*hash, left, right, BLOCK_SIZE);
+    }
+
+    ahx_player_destroy(player);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    bool update = argc > 1 && strcmp(argv[1], "-u") == 0;
+
+    static uint8_t song[4096];
+    size_t size = build_song(song, sizeof(song));
+
+    int failures = 0;
+    for (int m = 0; m < NUM_TEST_MODES; m++) {
+        const TestMode* mode = &test_modes[m];
+        uint64_t hash, channels_hash;
+
+        if (!render_hash(song, size, mode, false, &hash) ||
+            !render_hash(song, size, mode, true, &channels_hash)) {
+            printf("%-16s FAILED (could not load or render the song)\n", mode->name);
+            failures++;
+            continue;
+        }
+
+        if (update) {
+            printf("%-16s 0x%016llxULL\n", mode->name, (unsigned long long)hash);
+            continue;
+        }
+
+        bool ok = hash == mode->expected && channels_hash == hash;
+        printf("%-16s %s", mode->name, ok ? "ok" : "FAILED");
+        if (hash != mode->expected) {
+            printf(" (hash 0x%016llx, expected 0x%016llx)",
+                   (unsigned long long)hash, (unsigned long long)mode->expected);
+        }
+        if (channels_hash != hash) {
+            printf(" (mix differs when channel outputs are requested)");
+        }
+        printf("\n");
+        if (!ok) failures++;
+    }
+
+    return failures == 0 ? 0 : 1;
+}
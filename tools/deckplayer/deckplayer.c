@@ -1,12 +1,13 @@
 /*
  * Deck Player Test Tool
- * Tests the unified deck player with MOD/MED/AHX file support
+ * Tests the unified deck player with MOD/MED/AHX/SID/XM/S3M/IT file support
  *
- * Usage: ./deckplayer <filename> [-o output.wav] [-t seconds]
+ * Usage: ./deckplayer <filename> [-o output.wav] [-t seconds] [-l ms]
  *
  * Options:
  *   -o <file>     Render to WAV file (use '-' for stdout)
  *   -t <seconds>  Time limit in seconds (default: play full song)
+ *   -l <ms>       Render ahead on a worker thread (interactive mode)
  *
  * Controls (interactive mode):
  *   Space - Play/Pause
@@ -230,7 +231,7 @@ void position_callback(uint8_t order, uint16_t pattern, uint16_t row, void* user
 }
 
 // Interactive player mode
-void run_interactive(DeckPlayer* player) {
+void run_interactive(DeckPlayer* player, uint32_t lookahead_ms) {
     // Setup SDL Audio
     SDL_AudioSpec want, have;
     SDL_zero(want);
@@ -261,6 +262,9 @@ void run_interactive(DeckPlayer* player) {
 
     // Start playback
     deck_player_start(player);
+    if (lookahead_ms > 0 && !deck_player_set_lookahead(player, lookahead_ms, SAMPLE_RATE)) {
+        fprintf(stderr, "Warning: Look-ahead rendering not available\n");
+    }
     SDL_PauseAudioDevice(device, 0);  // Unpause
 
     printf("Deck Player - Interactive Mode\n");
@@ -329,10 +333,11 @@ void run_interactive(DeckPlayer* player) {
 int main(int argc, char** argv) {
     if (argc < 2) {
         fprintf(stderr, "Deck Player Test Tool\n");
-        fprintf(stderr, "Usage: %s <filename> [-o output.wav] [-t seconds]\n", argv[0]);
+        fprintf(stderr, "Usage: %s <filename> [-o output.wav] [-t seconds] [-l ms]\n", argv[0]);
         fprintf(stderr, "\nOptions:\n");
         fprintf(stderr, "  -o <file>     Render to WAV file (use '-' for stdout)\n");
         fprintf(stderr, "  -t <seconds>  Time limit in seconds (default: play full song)\n");
+        fprintf(stderr, "  -l <ms>       Render ahead on a worker thread (interactive mode)\n");
         fprintf(stderr, "\nSupported formats: MOD, MED, AHX\n");
         return 1;
     }
@@ -340,6 +345,7 @@ int main(int argc, char** argv) {
     const char* filename = argv[1];
     const char* output_file = NULL;
     int time_limit = 0;
+    uint32_t lookahead_ms = 0;
 
     // Parse arguments
     for (int i = 2; i < argc; i++) {
@@ -347,6 +353,8 @@ int main(int argc, char** argv) {
             output_file = argv[++i];
         } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
             time_limit = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) {
+            lookahead_ms = (uint32_t)atoi(argv[++i]);
         }
     }
 
@@ -403,7 +411,7 @@ int main(int argc, char** argv) {
             return 1;
         }
 
-        run_interactive(player);
+        run_interactive(player, lookahead_ms);
         SDL_Quit();
     }
 
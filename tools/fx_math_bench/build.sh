@@ -0,0 +1,17 @@
+#!/bin/bash
+# Build fx_math accuracy/throughput check for Linux using CMake
+
+echo "Building fx_math bench for Linux using CMake..."
+
+# Create build directory
+mkdir -p build
+cd build
+
+# Configure
+cmake .. -DCMAKE_BUILD_TYPE=Release
+
+# Build
+make
+
+echo ""
+echo "Build complete! Run: build/fx_math_bench"
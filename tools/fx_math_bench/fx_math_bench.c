@@ -0,0 +1,203 @@
+/*
+ * fx_math accuracy and speed check
+ *
+ * Compares every fx_math function (both tiers) against libm over the input
+ * range it is used with, then times libm, scalar and block versions.
+ *
+ * Usage: fx_math_bench [--no-bench]
+ * Exit code is non-zero if any function exceeds its error budget.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "../../effects/fx_math.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define NUM_POINTS 1000000
+#define BENCH_SIZE 4096
+#define BENCH_ROUNDS 2000
+
+typedef float (*UnaryFn)(float);
+
+typedef struct {
+    const char* name;
+    UnaryFn approx;
+    double (*reference)(double);
+    float lo, hi;
+    int relative;       // 1 = relative error, 0 = absolute error
+    double budget;
+} AccuracyCase;
+
+static double ref_exp2(double x) { return exp2(x); }
+static double ref_exp(double x) { return exp(x); }
+static double ref_log2(double x) { return log2(x); }
+static double ref_sin_turns(double x) { return sin(2.0 * M_PI * x); }
+static double ref_cos_turns(double x) { return cos(2.0 * M_PI * x); }
+static double ref_sin(double x) { return sin(x); }
+static double ref_tanh(double x) { return tanh(x); }
+static double ref_db_to_lin(double x) { return pow(10.0, x / 20.0); }
+static double ref_lin_to_db(double x) { return 20.0 * log10(x); }
+
+static const AccuracyCase cases[] = {
+    { "exp2",           fx_exp2,           ref_exp2,      -24.0f, 24.0f, 1, 2e-6 },
+    { "exp2_fast",      fx_exp2_fast,      ref_exp2,      -24.0f, 24.0f, 1, 2e-4 },
+    { "exp",            fx_exp,            ref_exp,       -20.0f, 20.0f, 1, 4e-6 },
+    { "exp_fast",       fx_exp_fast,       ref_exp,       -20.0f, 20.0f, 1, 2e-4 },
+    { "log2",           fx_log2,           ref_log2,      1e-6f, 1e4f,   0, 1e-6 },
+    { "log2_fast",      fx_log2_fast,      ref_log2,      1e-6f, 1e4f,   0, 1e-4 },
+    { "sin_turns",      fx_sin_turns,      ref_sin_turns, -4.0f, 4.0f,   0, 1e-6 },
+    { "sin_turns_fast", fx_sin_turns_fast, ref_sin_turns, -4.0f, 4.0f,   0, 1e-4 },
+    { "cos_turns",      fx_cos_turns,      ref_cos_turns, -4.0f, 4.0f,   0, 1e-6 },
+    { "cos_turns_fast", fx_cos_turns_fast, ref_cos_turns, -4.0f, 4.0f,   0, 1e-4 },
+    { "sin",            fx_sin,            ref_sin,       -20.0f, 20.0f, 0, 2e-6 },
+    { "sin_fast",       fx_sin_fast,       ref_sin,       -20.0f, 20.0f, 0, 1e-4 },
+    { "tanh",           fx_tanh,           ref_tanh,      -8.0f, 8.0f,   0, 1e-6 },
+    { "tanh_fast",      fx_tanh_fast,      ref_tanh,      -8.0f, 8.0f,   0, 1e-4 },
+    { "db_to_lin",      fx_db_to_lin,      ref_db_to_lin, -120.0f, 24.0f, 1, 2e-6 },
+    { "db_to_lin_fast", fx_db_to_lin_fast, ref_db_to_lin, -120.0f, 24.0f, 1, 2e-4 },
+    { "lin_to_db",      fx_lin_to_db,      ref_lin_to_db, 1e-6f, 16.0f,  0, 1e-5 },
+    { "lin_to_db_fast", fx_lin_to_db_fast, ref_lin_to_db, 1e-6f, 16.0f,  0, 1e-3 },
+};
+
+#define NUM_CASES (int)(sizeof(cases) / sizeof(cases[0]))
+
+static int run_accuracy(void)
+{
+    int failures = 0;
+
+    printf("%-16s %14s %14s %12s  %s\n", "function", "range", "max error", "budget", "");
+    for (int c = 0; c < NUM_CASES; c++) {
+        const AccuracyCase* tc = &cases[c];
+        double max_err = 0.0;
+        float worst_x = tc->lo;
+
+        for (int i = 0; i <= NUM_POINTS; i++) {
+            const float x = tc->lo + (tc->hi - tc->lo) * ((float)i / NUM_POINTS);
+            const double ref = tc->reference((double)x);
+            const double got = (double)tc->approx(x);
+            double err = fabs(got - ref);
+            if (tc->relative) err /= fabs(ref);
+            if (err > max_err) {
+                max_err = err;
+                worst_x = x;
+            }
+        }
+
+        const int ok = max_err <= tc->budget;
+        if (!ok) failures++;
+        printf("%-16s [%5g, %5g] %12.3e %s %10.1e  %s (worst at %g)\n", tc->name, tc->lo, tc->hi,
+               max_err, tc->relative ? "rel" : "abs", tc->budget, ok ? "ok" : "FAIL", worst_x);
+    }
+
+    return failures;
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static float bench_in[BENCH_SIZE];
+static float bench_out[BENCH_SIZE];
+static volatile float bench_sink;
+
+static void fill_input(float lo, float hi)
+{
+    for (int i = 0; i < BENCH_SIZE; i++) {
+        bench_in[i] = lo + (hi - lo) * ((float)i / BENCH_SIZE);
+    }
+}
+
+static void report(const char* name, double seconds)
+{
+    const double ns = seconds * 1e9 / ((double)BENCH_SIZE * BENCH_ROUNDS);
+    printf("  %-24s %7.2f ns/value\n", name, ns);
+}
+
+#define BENCH_SCALAR(label, expr)                                   \
+    do {                                                            \
+        const double t0 = now_seconds();                            \
+        for (int r = 0; r < BENCH_ROUNDS; r++) {                    \
+            for (int i = 0; i < BENCH_SIZE; i++) {                  \
+                const float x = bench_in[i];                        \
+                bench_out[i] = (expr);                              \
+            }                                                       \
+            bench_sink = bench_out[r & (BENCH_SIZE - 1)];           \
+        }                                                           \
+        report(label, now_seconds() - t0);                          \
+    } while (0)
+
+#define BENCH_BLOCK(label, fn)                                      \
+    do {                                                            \
+        const double t0 = now_seconds();                            \
+        for (int r = 0; r < BENCH_ROUNDS; r++) {                    \
+            fn(bench_in, bench_out, BENCH_SIZE);                    \
+            bench_sink = bench_out[r & (BENCH_SIZE - 1)];           \
+        }                                                           \
+        report(label, now_seconds() - t0);                          \
+    } while (0)
+
+static void run_bench(void)
+{
+    printf("\nThroughput (%d values x %d rounds)\n", BENCH_SIZE, BENCH_ROUNDS);
+
+    fill_input(-8.0f, 8.0f);
+    BENCH_SCALAR("exp2f (libm)", exp2f(x));
+    BENCH_SCALAR("fx_exp2", fx_exp2(x));
+    BENCH_SCALAR("fx_exp2_fast", fx_exp2_fast(x));
+    BENCH_BLOCK("fx_exp2_block", fx_exp2_block);
+    BENCH_BLOCK("fx_exp2_fast_block", fx_exp2_fast_block);
+
+    fill_input(1e-3f, 100.0f);
+    BENCH_SCALAR("log10f (libm)", log10f(x));
+    BENCH_SCALAR("fx_lin_to_db", fx_lin_to_db(x));
+    BENCH_SCALAR("fx_lin_to_db_fast", fx_lin_to_db_fast(x));
+
+    fill_input(-2.0f, 2.0f);
+    BENCH_SCALAR("sinf(2*pi*x) (libm)", sinf(FX_TWO_PI * x));
+    BENCH_SCALAR("fx_sin_turns", fx_sin_turns(x));
+    BENCH_SCALAR("fx_sin_turns_fast", fx_sin_turns_fast(x));
+    BENCH_BLOCK("fx_sin_turns_block", fx_sin_turns_block);
+    BENCH_BLOCK("fx_sin_turns_fast_block", fx_sin_turns_fast_block);
+
+    fill_input(-4.0f, 4.0f);
+    BENCH_SCALAR("tanhf (libm)", tanhf(x));
+    BENCH_SCALAR("fx_tanh", fx_tanh(x));
+    BENCH_SCALAR("fx_tanh_fast", fx_tanh_fast(x));
+    BENCH_BLOCK("fx_tanh_block", fx_tanh_block);
+    BENCH_BLOCK("fx_tanh_fast_block", fx_tanh_fast_block);
+    BENCH_BLOCK("fx_softclip_block", fx_softclip_block);
+
+    fill_input(-96.0f, 12.0f);
+    BENCH_SCALAR("powf(10, x/20) (libm)", powf(10.0f, x / 20.0f));
+    BENCH_SCALAR("fx_db_to_lin", fx_db_to_lin(x));
+    BENCH_BLOCK("fx_db_to_lin_block", fx_db_to_lin_block);
+}
+
+int main(int argc, char* argv[])
+{
+    int bench = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--no-bench") == 0) bench = 0;
+    }
+
+    printf("fx_math accuracy vs libm (%d points per function)\n\n", NUM_POINTS);
+    const int failures = run_accuracy();
+
+    if (bench) run_bench();
+
+    if (failures) {
+        printf("\n%d function(s) over budget\n", failures);
+        return 1;
+    }
+    return 0;
+}
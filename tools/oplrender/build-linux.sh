@@ -0,0 +1,25 @@
+#!/bin/bash
+# Build offline OPL dump renderer for Linux using CMake
+
+set -e
+
+echo "Building OPL renderer for Linux using CMake..."
+echo
+
+# Create build directory
+mkdir -p build-linux
+cd build-linux
+
+# Configure with CMake
+cmake .. \
+    -DCMAKE_BUILD_TYPE=Release
+
+# Build
+make -j$(nproc)
+
+echo
+echo "✓ Built opl_render"
+echo "Output: $(pwd)/opl_render"
+echo
+echo "To test:"
+echo "  ./opl_render /path/to/file.dro -o output.wav"
@@ -0,0 +1,242 @@
+/*
+ * Offline OPL register dump renderer
+ *
+ * Usage: ./opl_render <file.vgm|file.dro|file.imf> [-o output.wav] [-r rate] [-i imf_rate] [-t seconds]
+ *
+ * Options:
+ *   -o <file>     Render to WAV file (use '-' for stdout); without -o the
+ *                 dump is rendered and discarded (speed test)
+ *   -r <rate>     Output sample rate (default 48000)
+ *   -i <rate>     IMF tick rate in Hz (default 560, Wolfenstein 3D uses 700)
+ *   -t <seconds>  Maximum length to render (default 600)
+ *
+ * Prints the render time and the speed relative to real time.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include "../../players/opl_dump_player.h"
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+#define DEFAULT_SAMPLE_RATE 48000
+#define RENDER_FRAMES 4096
+
+/* WAV file header structures */
+typedef struct {
+    char riff[4];           /* "RIFF" */
+    uint32_t file_size;     /* File size - 8 */
+    char wave[4];           /* "WAVE" */
+} WAVHeader;
+
+typedef struct {
+    char fmt[4];            /* "fmt " */
+    uint32_t chunk_size;    /* 16 for PCM */
+    uint16_t format;        /* 1 = PCM */
+    uint16_t channels;      /* 2 for stereo */
+    uint32_t sample_rate;
+    uint32_t byte_rate;     /* sample_rate * channels * bytes_per_sample */
+    uint16_t block_align;   /* channels * bytes_per_sample */
+    uint16_t bits_per_sample;
+} WAVFmtChunk;
+
+typedef struct {
+    char data[4];           /* "data" */
+    uint32_t data_size;     /* Size of audio data */
+} WAVDataChunk;
+
+/* Write WAV header (16-bit PCM stereo) */
+static void write_wav_header(FILE* f, uint32_t num_samples, uint32_t sample_rate) {
+    uint32_t data_size = num_samples * 2 * 2;
+
+    WAVHeader header = {
+        .riff = {'R', 'I', 'F', 'F'},
+        .file_size = 36 + data_size,
+        .wave = {'W', 'A', 'V', 'E'}
+    };
+
+    WAVFmtChunk fmt = {
+        .fmt = {'f', 'm', 't', ' '},
+        .chunk_size = 16,
+        .format = 1,
+        .channels = 2,
+        .sample_rate = sample_rate,
+        .byte_rate = sample_rate * 2 * 2,
+        .block_align = 4,
+        .bits_per_sample = 16
+    };
+
+    WAVDataChunk data = {
+        .data = {'d', 'a', 't', 'a'},
+        .data_size = data_size
+    };
+
+    fwrite(&header, sizeof(header), 1, f);
+    fwrite(&fmt, sizeof(fmt), 1, f);
+    fwrite(&data, sizeof(data), 1, f);
+}
+
+static uint8_t* load_file(const char* filename, size_t* size) {
+    FILE* f = fopen(filename, "rb");
+    if (!f) return NULL;
+
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (len <= 0) {
+        fclose(f);
+        return NULL;
+    }
+
+    uint8_t* data = (uint8_t*)malloc((size_t)len);
+    if (data && fread(data, 1, (size_t)len, f) != (size_t)len) {
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+
+    *size = (size_t)len;
+    return data;
+}
+
+static const char* format_name(OplDumpFormat format) {
+    switch (format) {
+    case OPL_DUMP_VGM: return "VGM";
+    case OPL_DUMP_DRO: return "DRO";
+    case OPL_DUMP_IMF: return "IMF";
+    default: return "unknown";
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <file.vgm|file.dro|file.imf> [-o output.wav] [-r rate] [-i imf_rate] [-t seconds]\n", argv[0]);
+        return 1;
+    }
+
+    const char* filename = argv[1];
+    const char* output_file = NULL;
+    int sample_rate = DEFAULT_SAMPLE_RATE;
+    int imf_rate = OPL_DUMP_IMF_DEFAULT_RATE;
+    int max_seconds = 600;
+
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output_file = argv[++i];
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            sample_rate = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+            imf_rate = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            max_seconds = atoi(argv[++i]);
+        }
+    }
+
+    if (sample_rate <= 0 || max_seconds <= 0) {
+        fprintf(stderr, "Error: Invalid sample rate or length\n");
+        return 1;
+    }
+
+    size_t size = 0;
+    uint8_t* data = load_file(filename, &size);
+    if (!data) {
+        fprintf(stderr, "Error: Could not read '%s'\n", filename);
+        return 1;
+    }
+
+    OplDumpPlayer* player = opl_dump_player_create();
+    if (!player) {
+        fprintf(stderr, "Error: Could not create player\n");
+        free(data);
+        return 1;
+    }
+
+    opl_dump_player_set_imf_rate(player, imf_rate);
+    bool loaded = opl_dump_player_load(player, data, size);
+    free(data);
+    if (!loaded) {
+        fprintf(stderr, "Error: '%s' is not a VGM, DRO or IMF register dump\n", filename);
+        opl_dump_player_destroy(player);
+        return 1;
+    }
+
+    fprintf(stderr, "Format: %s, length %.1f s\n",
+            format_name(opl_dump_player_get_format(player)),
+            opl_dump_player_get_duration_ms(player) / 1000.0);
+
+    FILE* f = NULL;
+    bool use_stdout = false;
+    if (output_file) {
+        use_stdout = (strcmp(output_file, "-") == 0);
+        if (use_stdout) {
+            f = stdout;
+            #ifdef _WIN32
+            _setmode(_fileno(stdout), _O_BINARY);
+            #endif
+        } else {
+            f = fopen(output_file, "wb");
+            if (!f) {
+                fprintf(stderr, "Error: Could not create output file '%s'\n", output_file);
+                opl_dump_player_destroy(player);
+                return 1;
+            }
+        }
+        write_wav_header(f, 0, (uint32_t)sample_rate);
+    }
+
+    float left[RENDER_FRAMES];
+    float right[RENDER_FRAMES];
+    int16_t output[RENDER_FRAMES * 2];
+
+    opl_dump_player_set_disable_looping(player, true);
+    opl_dump_player_start(player);
+
+    const uint32_t max_samples = (uint32_t)sample_rate * (uint32_t)max_seconds;
+    uint32_t total_samples = 0;
+    double render_seconds = 0.0;
+
+    while (opl_dump_player_is_playing(player) && total_samples < max_samples) {
+        const clock_t t0 = clock();
+        opl_dump_player_process(player, left, right, RENDER_FRAMES, sample_rate);
+        render_seconds += (double)(clock() - t0) / CLOCKS_PER_SEC;
+        total_samples += RENDER_FRAMES;
+
+        if (!f) continue;
+
+        /* Convert float to 16-bit PCM and interleave */
+        for (int i = 0; i < RENDER_FRAMES; i++) {
+            float l = left[i];
+            float r = right[i];
+            if (l > 1.0f) l = 1.0f;
+            if (l < -1.0f) l = -1.0f;
+            if (r > 1.0f) r = 1.0f;
+            if (r < -1.0f) r = -1.0f;
+
+            output[i * 2] = (int16_t)(l * 32767.0f);
+            output[i * 2 + 1] = (int16_t)(r * 32767.0f);
+        }
+        fwrite(output, sizeof(int16_t), RENDER_FRAMES * 2, f);
+    }
+
+    if (f && !use_stdout) {
+        fseek(f, 0, SEEK_SET);
+        write_wav_header(f, total_samples, (uint32_t)sample_rate);
+        fclose(f);
+    }
+
+    const double audio_seconds = (double)total_samples / sample_rate;
+    fprintf(stderr, "Rendered %.1f s of audio in %.3f s", audio_seconds, render_seconds);
+    if (render_seconds > 0.0) {
+        fprintf(stderr, " (%.0fx real time)", audio_seconds / render_seconds);
+    }
+    fprintf(stderr, "\n");
+
+    opl_dump_player_destroy(player);
+    return 0;
+}
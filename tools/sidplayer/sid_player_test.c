@@ -270,6 +270,7 @@ void run_interactive(SidPlayer* player) {
     printf("Author: %s\n", sid_player_get_author(player));
     printf("Copyright: %s\n", sid_player_get_copyright(player));
     printf("Subsongs: %d\n", sid_player_get_num_subsongs(player));
+    printf("SID chips: %d\n", sid_player_get_num_chips(player));
     printf("Current subsong: %d\n", sid_player_get_current_subsong(player));
     printf("\nControls:\n");
     printf("  Space - Play/Pause\n");
@@ -472,7 +473,8 @@ int main(int argc, char** argv) {
     bool success = false;
 
     if (output_file) {
-        /* Render mode */
+        /* Render mode: 2SID/3SID chips render on worker threads */
+        sid_player_set_render_threads(player, true);
         success = render_to_wav(player, output_file);
     } else {
         /* Interactive mode */
@@ -0,0 +1,25 @@
+#!/bin/bash
+# Build offline stem renderer for Linux using CMake
+
+set -e
+
+echo "Building stem renderer for Linux using CMake..."
+echo
+
+# Create build directory
+mkdir -p build-linux
+cd build-linux
+
+# Configure with CMake
+cmake .. \
+    -DCMAKE_BUILD_TYPE=Release
+
+# Build
+make -j$(nproc)
+
+echo
+echo "✓ Built stemrender"
+echo "Output: $(pwd)/stemrender"
+echo
+echo "To test:"
+echo "  ./stemrender /path/to/file.mod -j 4"
@@ -0,0 +1,570 @@
+/*
+ * Offline stem renderer for tracker modules
+ *
+ * Usage: ./stemrender <file.mod|file.med|file.ahx|file.xm|file.s3m|file.it> [-o base] [-m] [-f] [-j threads] [-r rate] [-t seconds]
+ *
+ * Renders every channel of a MOD/MED/AHX/XM/S3M/IT module to its own stereo
+ * WAV file: <base>_ch01.wav, <base>_ch02.wav, ...
+ * Each stem is the channel as it sits in the mix (panning included), so the
+ * stems sum back to the full mix. SID tunes are refused: their voices are
+ * only available as one mix.
+ *
+ * Options:
+ *   -o <base>     Output file name base (default: input file name without extension)
+ *   -m            Write one multichannel WAV (<base>_stems.wav) with a stereo
+ *                 pair per channel instead of one file per channel
+ *   -f            Write 32-bit float samples instead of 16-bit PCM
+ *   -j <threads>  Render threads (default: number of CPUs)
+ *   -r <rate>     Output sample rate (default 48000)
+ *   -t <seconds>  Maximum length to render (default 600)
+ *
+ * The song is played through once, silently, to build a seek index with a
+ * state keyframe every few rows (deck_seek_index_build). That also gives its
+ * length: up to the end, or up to where it jumps back to repeat itself. The
+ * stretch from each keyframe to the next is then rendered once per channel,
+ * with the other channels muted, by a thread pool where every thread has one
+ * deck and restores keyframes on it, so the song is never played through
+ * per channel and all stretches of all stems render in parallel.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "../../players/deck_player.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#define DEFAULT_SAMPLE_RATE 48000
+#define RENDER_FRAMES 4096      /* Frames per deck_player_process() call */
+#define WINDOW_SAMPLES (1 << 22) /* Samples of all stems rendered between file writes */
+#define WRITE_SAMPLES 8192      /* Interleave buffer size in samples */
+
+/* WAV file header structures */
+typedef struct {
+    char riff[4];           /* "RIFF" */
+    uint32_t file_size;     /* File size - 8 */
+    char wave[4];           /* "WAVE" */
+} WAVHeader;
+
+typedef struct {
+    char fmt[4];            /* "fmt " */
+    uint32_t chunk_size;    /* 16 */
+    uint16_t format;        /* 1 = PCM, 3 = IEEE float */
+    uint16_t channels;
+    uint32_t sample_rate;
+    uint32_t byte_rate;     /* sample_rate * channels * bytes_per_sample */
+    uint16_t block_align;   /* channels * bytes_per_sample */
+    uint16_t bits_per_sample;
+} WAVFmtChunk;
+
+typedef struct {
+    char data[4];           /* "data" */
+    uint32_t data_size;     /* Size of audio data */
+} WAVDataChunk;
+
+/* Thread pool that renders a window of keyframe segments of every stem per
+ * round. Job j of a round is keyframe first_keyframe + j / num_stems of stem
+ * j % num_stems; it restores the keyframe on the worker's deck and renders
+ * up to the next one. */
+typedef struct {
+    const DeckSeekIndex* index;
+    int num_stems;
+    int sample_rate;
+    uint64_t total_frames;
+
+    uint32_t first_keyframe;    /* Keyframes in the current window */
+    uint32_t end_keyframe;
+    uint64_t window_start;      /* Frame of first_keyframe */
+    uint64_t window_end;
+    float* buffers;             /* Left and right of every stem, window_capacity frames each */
+    size_t window_capacity;
+
+    int next_job;           /* Next job to pick up this round */
+    int num_jobs;
+    int remaining;          /* Jobs not finished this round */
+    unsigned round;         /* Bumped to start a round */
+    bool quit;
+
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t done;
+} RenderPool;
+
+/* A render thread and its deck */
+typedef struct {
+    RenderPool* pool;
+    DeckPlayer* deck;
+    int solo;               /* Channel left audible on the deck */
+    pthread_t thread;
+} Worker;
+
+/* Write WAV header */
+static void write_wav_header(FILE* f, uint32_t num_frames, uint32_t sample_rate,
+                             uint16_t channels, bool float_output) {
+    uint16_t bytes_per_sample = float_output ? 4 : 2;
+    uint32_t data_size = num_frames * channels * bytes_per_sample;
+
+    WAVHeader header = {
+        .riff = {'R', 'I', 'F', 'F'},
+        .file_size = 36 + data_size,
+        .wave = {'W', 'A', 'V', 'E'}
+    };
+
+    WAVFmtChunk fmt = {
+        .fmt = {'f', 'm', 't', ' '},
+        .chunk_size = 16,
+        .format = float_output ? 3 : 1,
+        .channels = channels,
+        .sample_rate = sample_rate,
+        .byte_rate = sample_rate * channels * bytes_per_sample,
+        .block_align = (uint16_t)(channels * bytes_per_sample),
+        .bits_per_sample = (uint16_t)(bytes_per_sample * 8)
+    };
+
+    WAVDataChunk data = {
+        .data = {'d', 'a', 't', 'a'},
+        .data_size = data_size
+    };
+
+    fwrite(&header, sizeof(header), 1, f);
+    fwrite(&fmt, sizeof(fmt), 1, f);
+    fwrite(&data, sizeof(data), 1, f);
+}
+
+/* Interleave planar channels and append them to a WAV file */
+static void write_frames(FILE* f, float* const* channels, int num_channels,
+                         uint32_t frames, bool float_output) {
+    union {
+        float f32[WRITE_SAMPLES];
+        int16_t s16[WRITE_SAMPLES];
+    } buffer;
+    uint32_t chunk = WRITE_SAMPLES / (uint32_t)num_channels;
+
+    for (uint32_t pos = 0; pos < frames; pos += chunk) {
+        uint32_t count = frames - pos;
+        if (count > chunk) count = chunk;
+
+        for (uint32_t i = 0; i < count; i++) {
+            for (int c = 0; c < num_channels; c++) {
+                float s = channels[c][pos + i];
+                if (float_output) {
+                    buffer.f32[i * num_channels + c] = s;
+                } else {
+                    if (s > 1.0f) s = 1.0f;
+                    if (s < -1.0f) s = -1.0f;
+                    buffer.s16[i * num_channels + c] = (int16_t)(s * 32767.0f);
+                }
+            }
+        }
+
+        fwrite(&buffer, float_output ? sizeof(float) : sizeof(int16_t),
+               count * (uint32_t)num_channels, f);
+    }
+}
+
+static int cpu_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#endif
+}
+
+static double wall_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Read a whole file into memory (for the seek index scan) */
+static uint8_t* read_file(const char* filename, size_t* size) {
+    FILE* f = fopen(filename, "rb");
+    if (!f) return NULL;
+
+    uint8_t* data = NULL;
+    long length = -1;
+    if (fseek(f, 0, SEEK_END) == 0) length = ftell(f);
+    if (length > 0 && fseek(f, 0, SEEK_SET) == 0) {
+        data = (uint8_t*)malloc((size_t)length);
+        if (data && fread(data, 1, (size_t)length, f) != (size_t)length) {
+            free(data);
+            data = NULL;
+        }
+    }
+    fclose(f);
+
+    *size = (size_t)length;
+    return data;
+}
+
+/* Load a deck that plays the song once with every channel audible.
+ * Every deck maps the same file, so the song's sample data is in memory once. */
+static DeckPlayer* open_deck(const char* filename) {
+    DeckPlayer* deck = deck_player_create();
+    if (!deck) return NULL;
+
+    if (!deck_player_load_file(deck, filename)) {
+        deck_player_destroy(deck);
+        return NULL;
+    }
+
+    deck_player_set_disable_looping(deck, true);
+    deck_player_start(deck);
+    return deck;
+}
+
+/* Mute every channel of the worker's deck but one */
+static void set_solo(Worker* worker, int channel, int num_channels) {
+    if (worker->solo == channel) return;
+
+    for (int c = 0; c < num_channels; c++) {
+        deck_player_set_channel_mute(worker->deck, (uint8_t)c, c != channel);
+    }
+    worker->solo = channel;
+}
+
+/* Frame a keyframe's segment ends at (the next keyframe, or the song end) */
+static uint64_t segment_end(const RenderPool* pool, uint32_t keyframe) {
+    uint64_t end = pool->total_frames;
+    if (keyframe + 1 < deck_seek_index_get_num_keyframes(pool->index)) {
+        uint64_t next = deck_seek_index_get_keyframe_frame(pool->index, keyframe + 1);
+        if (next < end) end = next;
+    }
+    return end;
+}
+
+/* Render one keyframe segment of a stem into the window */
+static void render_job(Worker* worker, int job) {
+    RenderPool* pool = worker->pool;
+    int stem = job % pool->num_stems;
+    uint32_t keyframe = pool->first_keyframe + (uint32_t)(job / pool->num_stems);
+
+    uint64_t start = deck_seek_index_get_keyframe_frame(pool->index, keyframe);
+    uint64_t end = segment_end(pool, keyframe);
+    float* left = pool->buffers + (size_t)stem * 2 * pool->window_capacity +
+                  (size_t)(start - pool->window_start);
+    float* right = left + pool->window_capacity;
+
+    set_solo(worker, stem, pool->num_stems);
+    if (!deck_player_restore_keyframe(worker->deck, pool->index, keyframe)) {
+        memset(left, 0, (size_t)(end - start) * sizeof(float));
+        memset(right, 0, (size_t)(end - start) * sizeof(float));
+        return;
+    }
+
+    uint32_t frames = (uint32_t)(end - start);
+    for (uint32_t pos = 0; pos < frames; pos += RENDER_FRAMES) {
+        uint32_t count = frames - pos;
+        if (count > RENDER_FRAMES) count = RENDER_FRAMES;
+        deck_player_process(worker->deck, left + pos, right + pos, count, pool->sample_rate);
+    }
+}
+
+static void* render_worker(void* arg) {
+    Worker* worker = (Worker*)arg;
+    RenderPool* pool = worker->pool;
+    unsigned seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->quit && pool->round == seen) {
+            pthread_cond_wait(&pool->start, &pool->lock);
+        }
+        if (pool->quit) break;
+        seen = pool->round;
+
+        while (pool->next_job < pool->num_jobs) {
+            int job = pool->next_job++;
+            pthread_mutex_unlock(&pool->lock);
+
+            render_job(worker, job);
+
+            pthread_mutex_lock(&pool->lock);
+            if (--pool->remaining == 0) {
+                pthread_cond_signal(&pool->done);
+            }
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+/* Render every stem's segments of the current window and wait for all of them */
+static void render_round(RenderPool* pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->next_job = 0;
+    pool->num_jobs = (int)(pool->end_keyframe - pool->first_keyframe) * pool->num_stems;
+    pool->remaining = pool->num_jobs;
+    pool->round++;
+    pthread_cond_broadcast(&pool->start);
+
+    while (pool->remaining > 0) {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <file.mod|file.med|file.ahx|file.xm|file.s3m|file.it> [-o base] [-m] [-f] [-j threads] [-r rate] [-t seconds]\n", argv[0]);
+        return 1;
+    }
+
+    const char* filename = argv[1];
+    const char* output_base = NULL;
+    bool multichannel = false;
+    bool float_output = false;
+    int num_threads = cpu_count();
+    int sample_rate = DEFAULT_SAMPLE_RATE;
+    int max_seconds = 600;
+
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output_base = argv[++i];
+        } else if (strcmp(argv[i], "-m") == 0) {
+            multichannel = true;
+        } else if (strcmp(argv[i], "-f") == 0) {
+            float_output = true;
+        } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            num_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            sample_rate = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            max_seconds = atoi(argv[++i]);
+        }
+    }
+
+    if (sample_rate <= 0 || max_seconds <= 0 || num_threads <= 0) {
+        fprintf(stderr, "Error: Invalid sample rate, length or thread count\n");
+        return 1;
+    }
+
+    /* Output name base defaults to the input path without its extension */
+    char base[1024];
+    if (output_base) {
+        snprintf(base, sizeof(base), "%s", output_base);
+    } else {
+        snprintf(base, sizeof(base), "%s", filename);
+        char* dot = strrchr(base, '.');
+        char* slash = strrchr(base, '/');
+        if (dot && (!slash || dot > slash)) *dot = '\0';
+    }
+
+    const double t0 = wall_seconds();
+
+    DeckPlayer* probe = open_deck(filename);
+    if (!probe) {
+        fprintf(stderr, "Error: Could not read '%s' as a MOD, MED, AHX, XM, S3M or IT file\n", filename);
+        return 1;
+    }
+    if (deck_player_get_type(probe) == DECK_PLAYER_SID) {
+        /* The SID player mixes its voices through one filter and has no state
+         * snapshots, so there is neither a per-voice output nor a keyframe */
+        fprintf(stderr, "Error: SID tunes cannot be rendered to stems\n");
+        deck_player_destroy(probe);
+        return 1;
+    }
+
+    /* Timeline scan: one silent playthrough that keeps a keyframe every few
+     * rows; the stems are rendered from those keyframes */
+    size_t size = 0;
+    uint8_t* data = read_file(filename, &size);
+    DeckSeekIndex* index = data ? deck_seek_index_build(data, size, 0, sample_rate) : NULL;
+    free(data);
+    if (!index) {
+        fprintf(stderr, "Error: Could not scan '%s'\n", filename);
+        deck_player_destroy(probe);
+        return 1;
+    }
+
+    int num_stems = deck_player_get_num_channels(probe);
+    uint32_t num_keyframes = deck_seek_index_get_num_keyframes(index);
+    uint64_t total_frames = deck_seek_index_get_length(index, NULL);
+    uint64_t max_frames = (uint64_t)sample_rate * (uint64_t)max_seconds;
+    if (total_frames > max_frames) total_frames = max_frames;
+
+    /* Keyframes past the length limit have nothing to render */
+    while (num_keyframes > 1 && deck_seek_index_get_keyframe_frame(index, num_keyframes - 1) >= total_frames) {
+        num_keyframes--;
+    }
+
+    fprintf(stderr, "Format: %s, %d channels, %u keyframes, length %.1f s\n",
+            deck_player_get_type_name(probe), num_stems, num_keyframes,
+            (double)total_frames / sample_rate);
+
+    if (num_stems == 0 || total_frames == 0) {
+        fprintf(stderr, "Error: Nothing to render\n");
+        deck_seek_index_destroy(index);
+        deck_player_destroy(probe);
+        return 1;
+    }
+
+    if (num_threads > (int)num_keyframes * num_stems) num_threads = (int)num_keyframes * num_stems;
+
+    /* One deck per thread; the probe (which also built any shared tables the
+     * players create lazily) is the first */
+    RenderPool pool = {
+        .index = index,
+        .num_stems = num_stems,
+        .sample_rate = sample_rate,
+        .total_frames = total_frames
+    };
+    Worker* workers = (Worker*)calloc((size_t)num_threads, sizeof(Worker));
+    FILE** files = (FILE**)calloc((size_t)num_stems, sizeof(FILE*));
+    float** channels = (float**)malloc((size_t)num_stems * 2 * sizeof(float*));
+    FILE* mix_file = NULL;
+    bool ok = workers && files && channels;
+
+    if (workers) {
+        workers[0].deck = probe;
+    } else {
+        deck_player_destroy(probe);
+    }
+
+    for (int i = 0; ok && i < num_threads; i++) {
+        workers[i].pool = &pool;
+        workers[i].solo = -1;
+        if (i > 0) workers[i].deck = open_deck(filename);
+        ok = workers[i].deck != NULL;
+    }
+
+    for (int s = 0; ok && !multichannel && s < num_stems; s++) {
+        char path[1100];
+        snprintf(path, sizeof(path), "%s_ch%02d.wav", base, s + 1);
+        files[s] = fopen(path, "wb");
+        if (!files[s]) {
+            fprintf(stderr, "Error: Could not create output file '%s'\n", path);
+            ok = false;
+        } else {
+            write_wav_header(files[s], (uint32_t)total_frames, (uint32_t)sample_rate, 2, float_output);
+        }
+    }
+
+    if (ok && multichannel) {
+        char path[1100];
+        snprintf(path, sizeof(path), "%s_stems.wav", base);
+        mix_file = fopen(path, "wb");
+        if (!mix_file) {
+            fprintf(stderr, "Error: Could not create output file '%s'\n", path);
+            ok = false;
+        } else {
+            write_wav_header(mix_file, (uint32_t)total_frames, (uint32_t)sample_rate,
+                             (uint16_t)(num_stems * 2), float_output);
+        }
+    }
+
+    int num_workers = 0;
+
+    if (ok) {
+        pthread_mutex_init(&pool.lock, NULL);
+        pthread_cond_init(&pool.start, NULL);
+        pthread_cond_init(&pool.done, NULL);
+
+        for (int i = 0; i < num_threads; i++) {
+            if (pthread_create(&workers[num_workers].thread, NULL, render_worker, &workers[num_workers]) == 0) {
+                num_workers++;
+            }
+        }
+        ok = num_workers > 0;
+        if (!ok) fprintf(stderr, "Error: Could not start render threads\n");
+    }
+
+    /* Windows of whole keyframe segments, WINDOW_SAMPLES long over all stems
+     * (at least one segment) */
+    uint64_t window_frames = WINDOW_SAMPLES / (2 * (uint64_t)num_stems);
+
+    for (uint32_t first = 0; ok && first < num_keyframes; first = pool.end_keyframe) {
+        /* The first window also holds the lead-in before the first row */
+        uint64_t start = first == 0 ? 0 : deck_seek_index_get_keyframe_frame(index, first);
+        uint32_t end = first + 1;
+        while (end < num_keyframes && segment_end(&pool, end) - start <= window_frames) {
+            end++;
+        }
+
+        pool.first_keyframe = first;
+        pool.end_keyframe = end;
+        pool.window_start = start;
+        pool.window_end = segment_end(&pool, end - 1);
+
+        size_t frames = (size_t)(pool.window_end - start);
+        if (frames > pool.window_capacity) {
+            float* buffers = (float*)realloc(pool.buffers, (size_t)num_stems * 2 * frames * sizeof(float));
+            if (!buffers) {
+                fprintf(stderr, "Error: Out of memory\n");
+                ok = false;
+                break;
+            }
+            pool.buffers = buffers;
+            pool.window_capacity = frames;
+        }
+
+        /* Nothing plays before the first row starts */
+        size_t lead_in = (size_t)(deck_seek_index_get_keyframe_frame(index, first) - start);
+        for (int s = 0; s < num_stems * 2; s++) {
+            memset(pool.buffers + (size_t)s * pool.window_capacity, 0, lead_in * sizeof(float));
+        }
+
+        render_round(&pool);
+
+        for (int s = 0; s < num_stems; s++) {
+            channels[s * 2] = pool.buffers + (size_t)s * 2 * pool.window_capacity;
+            channels[s * 2 + 1] = channels[s * 2] + pool.window_capacity;
+            if (files[s]) write_frames(files[s], &channels[s * 2], 2, (uint32_t)frames, float_output);
+        }
+        if (mix_file) {
+            write_frames(mix_file, channels, num_stems * 2, (uint32_t)frames, float_output);
+        }
+    }
+
+    if (num_workers > 0) {
+        pthread_mutex_lock(&pool.lock);
+        pool.quit = true;
+        pthread_cond_broadcast(&pool.start);
+        pthread_mutex_unlock(&pool.lock);
+
+        for (int i = 0; i < num_workers; i++) {
+            pthread_join(workers[i].thread, NULL);
+        }
+        pthread_mutex_destroy(&pool.lock);
+        pthread_cond_destroy(&pool.start);
+        pthread_cond_destroy(&pool.done);
+    }
+
+    const double elapsed = wall_seconds() - t0;
+    if (ok) {
+        const double audio_seconds = (double)total_frames / sample_rate;
+        fprintf(stderr, "Rendered %d stems of %.1f s on %d threads in %.3f s",
+                num_stems, audio_seconds, num_workers, elapsed);
+        if (elapsed > 0.0) {
+            fprintf(stderr, " (%.0fx real time)", audio_seconds / elapsed);
+        }
+        fprintf(stderr, "\n");
+    }
+
+    for (int i = 0; workers && i < num_threads; i++) {
+        if (workers[i].deck) deck_player_destroy(workers[i].deck);
+    }
+    for (int s = 0; files && s < num_stems; s++) {
+        if (files[s]) fclose(files[s]);
+    }
+    if (mix_file) fclose(mix_file);
+    deck_seek_index_destroy(index);
+    free(pool.buffers);
+    free(workers);
+    free(channels);
+    free(files);
+
+    return ok ? 0 : 1;
+}